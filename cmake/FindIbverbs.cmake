@@ -0,0 +1,25 @@
+# - Try to find ibverbs
+# Once done this will define
+#  Ibverbs_FOUND        - System has ibverbs
+#  Ibverbs_INCLUDE_DIRS - The ibverbs include directories
+#  Ibverbs_LIBRARIES    - The libraries needed to use ibverbs
+#
+# This script can use the following variables:
+#  Ibverbs_ROOT - Installation root to tell this module where to look. (it tries /usr and /usr/local otherwise)
+
+# find includes
+find_path(Ibverbs_INCLUDE_DIR infiniband/verbs.h
+        HINTS ${Ibverbs_ROOT} /usr/local/include /usr/include PATH_SUFFIXES "include")
+
+# find libraries
+find_library(Ibverbs_LIBRARY NAMES ibverbs HINTS /usr/local/lib /usr/lib ${Ibverbs_ROOT} PATH_SUFFIXES "lib" "lib64")
+
+set(Ibverbs_LIBRARIES ${Ibverbs_LIBRARY})
+set(Ibverbs_INCLUDE_DIRS ${Ibverbs_INCLUDE_DIR})
+
+include(FindPackageHandleStandardArgs)
+# handle the QUIETLY and REQUIRED arguments and set Ibverbs_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(Ibverbs DEFAULT_MSG Ibverbs_LIBRARY Ibverbs_INCLUDE_DIR)
+
+mark_as_advanced(Ibverbs_INCLUDE_DIR Ibverbs_LIBRARY)
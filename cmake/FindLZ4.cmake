@@ -0,0 +1,25 @@
+# - Try to find lz4
+# Once done this will define
+#  LZ4_FOUND        - System has lz4
+#  LZ4_INCLUDE_DIRS - The lz4 include directories
+#  LZ4_LIBRARIES    - The libraries needed to use lz4
+#
+# This script can use the following variables:
+#  LZ4_ROOT - Installation root to tell this module where to look. (it tries /usr and /usr/local otherwise)
+
+# find includes
+find_path(LZ4_INCLUDE_DIR lz4.h
+        HINTS ${LZ4_ROOT} /usr/local/include /usr/include PATH_SUFFIXES "include")
+
+# find libraries
+find_library(LZ4_LIBRARY NAMES lz4 HINTS /usr/local/lib /usr/lib ${LZ4_ROOT} PATH_SUFFIXES "lib" "lib64")
+
+set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+set(LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+
+include(FindPackageHandleStandardArgs)
+# handle the QUIETLY and REQUIRED arguments and set LZ4_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(LZ4 DEFAULT_MSG LZ4_LIBRARY LZ4_INCLUDE_DIR)
+
+mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARY)
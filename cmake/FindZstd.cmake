@@ -0,0 +1,25 @@
+# - Try to find zstd
+# Once done this will define
+#  Zstd_FOUND        - System has zstd
+#  Zstd_INCLUDE_DIRS - The zstd include directories
+#  Zstd_LIBRARIES    - The libraries needed to use zstd
+#
+# This script can use the following variables:
+#  Zstd_ROOT - Installation root to tell this module where to look. (it tries /usr and /usr/local otherwise)
+
+# find includes
+find_path(Zstd_INCLUDE_DIR zstd.h
+        HINTS ${Zstd_ROOT} /usr/local/include /usr/include PATH_SUFFIXES "include")
+
+# find libraries
+find_library(Zstd_LIBRARY NAMES zstd HINTS /usr/local/lib /usr/lib ${Zstd_ROOT} PATH_SUFFIXES "lib" "lib64")
+
+set(Zstd_LIBRARIES ${Zstd_LIBRARY})
+set(Zstd_INCLUDE_DIRS ${Zstd_INCLUDE_DIR})
+
+include(FindPackageHandleStandardArgs)
+# handle the QUIETLY and REQUIRED arguments and set Zstd_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(Zstd DEFAULT_MSG Zstd_LIBRARY Zstd_INCLUDE_DIR)
+
+mark_as_advanced(Zstd_INCLUDE_DIR Zstd_LIBRARY)
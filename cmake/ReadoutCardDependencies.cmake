@@ -44,6 +44,50 @@ else()
     message(WARNING "DIM not found, ReadoutCard module's ALF utilities will not be compiled")
 endif(DIM_FOUND)
 
+# ibverbs
+find_package(Ibverbs)
+if(Ibverbs_FOUND)
+    message(STATUS "ibverbs found")
+    # Add definition to enable the RDMA registration of DMA buffers
+    set(ALICEO2_READOUTCARD_IBVERBS_ENABLED TRUE)
+    add_definitions(-DALICEO2_READOUTCARD_IBVERBS_ENABLED)
+else()
+    message(STATUS "ibverbs not found, ReadoutCard module's RDMA buffer registration will not be compiled")
+endif(Ibverbs_FOUND)
+
+# CUDA
+find_package(CUDA QUIET)
+if(CUDA_FOUND)
+    message(STATUS "CUDA found")
+    # Add definition to enable the GPU registration of DMA buffers
+    set(ALICEO2_READOUTCARD_CUDA_ENABLED TRUE)
+    add_definitions(-DALICEO2_READOUTCARD_CUDA_ENABLED)
+else()
+    message(STATUS "CUDA not found, ReadoutCard module's GPU buffer registration will not be compiled")
+endif(CUDA_FOUND)
+
+# LZ4
+find_package(LZ4)
+if(LZ4_FOUND)
+    message(STATUS "LZ4 found")
+    # Add definition to enable LZ4 compression of recorded superpages
+    set(ALICEO2_READOUTCARD_LZ4_ENABLED TRUE)
+    add_definitions(-DALICEO2_READOUTCARD_LZ4_ENABLED)
+else()
+    message(STATUS "LZ4 not found, ReadoutCard module's recorder will not support LZ4 compression")
+endif(LZ4_FOUND)
+
+# zstd
+find_package(Zstd)
+if(Zstd_FOUND)
+    message(STATUS "zstd found")
+    # Add definition to enable zstd compression of recorded superpages
+    set(ALICEO2_READOUTCARD_ZSTD_ENABLED TRUE)
+    add_definitions(-DALICEO2_READOUTCARD_ZSTD_ENABLED)
+else()
+    message(STATUS "zstd not found, ReadoutCard module's recorder will not support zstd compression")
+endif(Zstd_FOUND)
+
 o2_define_bucket(
   NAME
   o2_readoutcard_bucket
@@ -57,11 +101,19 @@ o2_define_bucket(
   pthread
   ${Common_LIBRARIES}
   ${InfoLogger_LIBRARIES}
+  ${Ibverbs_LIBRARIES}
+  ${CUDA_LIBRARIES}
+  ${LZ4_LIBRARIES}
+  ${Zstd_LIBRARIES}
 
   SYSTEMINCLUDE_DIRECTORIES
   ${Boost_INCLUDE_DIR}
   ${Common_INCLUDE_DIRS}
   ${InfoLogger_INCLUDE_DIRS}
+  ${Ibverbs_INCLUDE_DIRS}
+  ${CUDA_INCLUDE_DIRS}
+  ${LZ4_INCLUDE_DIRS}
+  ${Zstd_INCLUDE_DIRS}
 )
 
 o2_define_bucket(
@@ -7,6 +7,7 @@
 #define ALICEO2_INCLUDE_READOUTCARD_BARINTERFACE_H_
 
 #include <cstdint>
+#include "ReadoutCard/BarStatistics.h"
 #include "ReadoutCard/CardType.h"
 #include "ReadoutCard/RegisterReadWriteInterface.h"
 #include "ReadoutCard/Parameters.h"
@@ -58,6 +59,10 @@ class BarInterface: public virtual RegisterReadWriteInterface
 
     virtual int32_t getLinksPerWrapper(uint32_t wrapper) = 0;
 
+    /// Gets the amount of reads, writes and cycles spent per register of this BAR.
+    /// Only collected if ReadoutCard is built with the ALICEO2_READOUTCARD_BAR_STATISTICS CMake option, otherwise empty.
+    virtual BarStatistics getBarStatistics() = 0;
+
 };
 
 } // namespace roc
@@ -0,0 +1,33 @@
+/// \file BarStatistics.h
+/// \brief Definition of the RegisterAccessStatistics struct.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_BARSTATISTICS_H_
+#define ALICEO2_INCLUDE_READOUTCARD_BARSTATISTICS_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Access counts of a single BAR register.
+/// These are only collected if ReadoutCard is built with the ALICEO2_READOUTCARD_BAR_STATISTICS CMake option, so
+/// that the default build has no overhead.
+struct RegisterAccessStatistics
+{
+    int barIndex; ///< Index of the BAR
+    uintptr_t address; ///< Byte-based address of the register
+    uint64_t reads; ///< Amount of 32-bit reads
+    uint64_t writes; ///< Amount of 32-bit writes
+    uint64_t cycles; ///< CPU timestamp counter cycles spent in the reads and writes
+};
+
+/// Access counts of the registers that were accessed, in no particular order
+using BarStatistics = std::vector<RegisterAccessStatistics>;
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_BARSTATISTICS_H_
@@ -0,0 +1,96 @@
+/// \file CacheAllocation.h
+/// \brief Definition of the CacheAllocation class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_CACHEALLOCATION_H_
+#define ALICEO2_INCLUDE_READOUTCARD_CACHEALLOCATION_H_
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <boost/optional.hpp>
+
+namespace AliceO2 {
+namespace roc {
+
+/// A resource control group of the Linux resctrl filesystem, which gives its threads a dedicated part of the last-level
+/// cache with Intel RDT cache allocation (CAT). At high rates, the card's DMA writes land in the LLC through DDIO and
+/// evict the working set of the processing, and the other way around. Giving the readout threads, and the driver thread
+/// with the DriverThreadCacheGroup parameter, ways that don't overlap with those of the processing and with the DDIO
+/// ways (see getDdioWayMask()) lets readout and processing share a socket.
+///
+/// Needs a kernel with resctrl mounted on /sys/fs/resctrl and the permissions to write to it, usually root.
+class CacheAllocation
+{
+  public:
+    /// Occupancy and memory bandwidth of a group, summed over the cache domains, from RDT monitoring (CMT and MBM).
+    /// Fields are empty if the CPU does not support them.
+    struct Monitoring
+    {
+        /// Bytes of the LLC used by the group's threads
+        boost::optional<uint64_t> llcOccupancy;
+        /// Bytes transferred between the LLC and memory by the group's threads, since the group was created
+        boost::optional<uint64_t> totalBytes;
+        /// Like totalBytes, but for the local NUMA node only
+        boost::optional<uint64_t> localBytes;
+    };
+
+    /// Default mount point of the resctrl filesystem
+    static constexpr const char* DEFAULT_RESCTRL_PATH = "/sys/fs/resctrl";
+
+    /// Creates a group, or takes over an existing one, and sets its allocation
+    /// \param name Name of the group
+    /// \param schemata Allocation in the resctrl schemata format, e.g. "L3:0=00f;1=00f" for the lowest 4 ways on cache
+    ///   domains 0 and 1
+    /// \param resctrlPath Mount point of the resctrl filesystem
+    CacheAllocation(const std::string& name, const std::string& schemata,
+        const std::string& resctrlPath = DEFAULT_RESCTRL_PATH);
+
+    /// Removes the group if it was created by this object. Its threads go back to the default group.
+    ~CacheAllocation();
+
+    CacheAllocation(const CacheAllocation&) = delete;
+    CacheAllocation& operator=(const CacheAllocation&) = delete;
+
+    /// Moves a thread into the group
+    /// \param threadId Thread ID, as returned by gettid()
+    void addThread(pid_t threadId);
+
+    /// Moves the calling thread into the group
+    void addCurrentThread();
+
+    /// Moves the calling thread into an existing group, for threads without access to its CacheAllocation object
+    static void joinGroup(const std::string& name, const std::string& resctrlPath = DEFAULT_RESCTRL_PATH);
+
+    /// Gets the occupancy and bandwidth of the group
+    Monitoring getMonitoring() const;
+
+    /// Checks if resctrl is mounted and cache allocation is supported
+    static bool isAvailable(const std::string& resctrlPath = DEFAULT_RESCTRL_PATH);
+
+    /// Gets the LLC ways DDIO writes into, from the IIO_LLC_WAYS MSR of Intel Xeon CPUs. Needs the msr kernel module
+    /// and root.
+    /// \param cpu CPU whose MSR is read, any CPU of the socket of the card
+    /// \return The way mask, or nothing if the MSR could not be read
+    static boost::optional<uint32_t> getDdioWayMask(int cpu = 0);
+
+    /// Gets the directory of the group
+    const std::string& getPath() const
+    {
+      return mPath;
+    }
+
+  private:
+    std::string mResctrlPath;
+
+    std::string mPath;
+
+    /// True if the group was created by this object, and must be removed
+    bool mCreated;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_CACHEALLOCATION_H_
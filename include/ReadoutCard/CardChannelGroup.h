@@ -0,0 +1,125 @@
+/// \file CardChannelGroup.h
+/// \brief Definition of the CardChannelGroup class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_CARDCHANNELGROUP_H_
+#define ALICEO2_INCLUDE_READOUTCARD_CARDCHANNELGROUP_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <boost/optional.hpp>
+#include "ReadoutCard/ChannelGroup.h"
+#include "ReadoutCard/HugepagePool.h"
+#include "ReadoutCard/Parameters.h"
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Drives all endpoints of one card from a single thread. A CRU appears as two PCI endpoints with the same serial
+/// number, each with its own DMA channel. This opens the channels of all of them, with their buffers carved from one
+/// HugepagePool on the card's NUMA node, and services them with a ChannelGroup, so the card needs one polling thread
+/// instead of one per endpoint.
+///
+/// The arrived superpages of all endpoints come out of poll() as one stream, tagged with the index of the endpoint they
+/// came from. The link is given by Superpage::getLinkId().
+///
+/// The group and its channels are meant to be used from a single thread.
+class CardChannelGroup
+{
+  public:
+    /// Opens the channels of all endpoints of the card
+    /// \param serial Serial number of the card
+    /// \param parameters Parameters for the channels. The card ID and buffer parameters are set per endpoint.
+    /// \param bufferSize Size of the buffer of every endpoint, rounded up to a multiple of 2 MiB
+    /// \param batchSize Maximum amount of superpages handled for one endpoint before moving on to the next
+    CardChannelGroup(int serial, const Parameters& parameters, size_t bufferSize,
+        size_t batchSize = ChannelGroup::DEFAULT_BATCH_SIZE);
+
+    ~CardChannelGroup();
+
+    /// Gets the amount of endpoints of the card
+    size_t getEndpointCount() const
+    {
+      return mEndpoints.size();
+    }
+
+    /// Gets the PCI address of an endpoint
+    /// \param endpoint Index of the endpoint, ordered by PCI address
+    const PciAddress& getPciAddress(size_t endpoint) const
+    {
+      return mEndpoints.at(endpoint).pciAddress;
+    }
+
+    /// Gets the buffer of an endpoint, which the superpages pushed into its channel must lie in
+    /// \param endpoint Index of the endpoint
+    const buffer_parameters::Memory& getBuffer(size_t endpoint) const
+    {
+      return mEndpoints.at(endpoint).buffer;
+    }
+
+    /// Gets the channel of an endpoint, for example to push superpages into it
+    /// \param endpoint Index of the endpoint
+    DmaChannelInterface& getChannel(size_t endpoint)
+    {
+      return mGroup.getChannel(endpoint);
+    }
+
+    /// Gets the NUMA node of the card, if known
+    boost::optional<int> getNumaNode() const
+    {
+      return mNumaNode;
+    }
+
+    /// Starts DMA on all endpoints
+    void startDma()
+    {
+      mGroup.startDma();
+    }
+
+    /// Prepares DMA on all endpoints. See ChannelGroup::prepareDma().
+    void prepareDma()
+    {
+      mGroup.prepareDma();
+    }
+
+    /// Stops DMA on all endpoints. See ChannelGroup::stopDma().
+    void stopDma()
+    {
+      mGroup.stopDma();
+    }
+
+    /// Drives the transfers of all endpoints and hands their arrived superpages to the handler. See ChannelGroup::poll().
+    /// \param handler Called as handler(size_t endpoint, const Superpage& superpage) for every arrived superpage. It
+    ///   may push superpages into the channels.
+    /// \return The amount of superpages handled
+    template <typename Handler>
+    size_t poll(Handler&& handler)
+    {
+      return mGroup.poll(std::forward<Handler>(handler));
+    }
+
+  private:
+    struct Endpoint
+    {
+        PciAddress pciAddress;
+        buffer_parameters::Memory buffer;
+    };
+
+    boost::optional<int> mNumaNode;
+
+    /// The buffers of the endpoints. Declared before the group, so the channels are closed before it is destroyed.
+    std::unique_ptr<HugepagePool> mPool;
+
+    std::vector<Endpoint> mEndpoints;
+
+    ChannelGroup mGroup;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_CARDCHANNELGROUP_H_
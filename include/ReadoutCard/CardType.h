@@ -19,7 +19,8 @@ struct CardType
       Unknown, ///< Unknown card type
       Crorc,   ///< C-RORC card type
       Cru,     ///< CRU card type
-      Dummy    ///< Dummy card type
+      Dummy,   ///< Dummy card type
+      Simulated ///< Dummy card simulating the links of a card, see the DummyLinkBandwidth parameter
     };
 
     /// Converts a CardType to a string
@@ -10,8 +10,10 @@
 #include "ReadoutCard/Parameters.h"
 #include <memory>
 #include <string>
+#include <vector>
 #include "ReadoutCard/DmaChannelInterface.h"
 #include "ReadoutCard/BarInterface.h"
+#include "ReadoutCard/SuperpageHandles.h"
 
 namespace AliceO2 {
 namespace roc {
@@ -27,10 +29,36 @@ class ChannelFactory
     virtual ~ChannelFactory();
 
     /// Get an object to access a DMA channel with the given serial number and channel number.
-    /// Passing 'DUMMY_SERIAL_NUMBER' as serial number returns a dummy implementation
+    /// Passing 'DUMMY_SERIAL_NUMBER' as serial number returns a dummy implementation, which simulates a card of
+    /// CardType::Simulated with the DummyLinkBandwidth parameter
     /// \param parameters Parameters for the channel
     DmaChannelSharedPtr getDmaChannel(const Parameters &parameters);
 
+    /// A DMA channel with separate handles for its push and pop sides
+    struct SplitDmaChannel
+    {
+        /// The channel, for everything besides pushing and popping, such as starting and stopping DMA
+        DmaChannelSharedPtr channel;
+        /// Push side, for one thread
+        SuperpageProducer producer;
+        /// Pop side, for one other thread
+        SuperpageConsumer consumer;
+    };
+
+    /// Get a DMA channel whose superpages can be pushed from one thread and popped from another without locking.
+    /// The channel gets a driver thread, regardless of the DriverThreadEnabled parameter.
+    /// \param parameters Parameters for the channel
+    SplitDmaChannel getSplitDmaChannel(const Parameters &parameters);
+
+    /// Get objects to access multiple DMA channels, which are opened concurrently.
+    /// Card enumeration, hugepage checks and BAR probing of the channels overlap, while the parts that must be
+    /// serialized (such as PDA buffer registration) still are. This reduces start-up time on multi-card machines.
+    /// If any channel fails to open, the exception of the first failing entry is rethrown after all others finished,
+    /// and the channels that did open are closed again.
+    /// \param parameters Parameters for each channel
+    /// \return The channels, in the same order as the given parameters
+    std::vector<DmaChannelSharedPtr> getDmaChannels(const std::vector<Parameters> &parameters);
+
     /// Get an object to access a BAR with the given card ID and channel number.
     /// Passing 'DUMMY_SERIAL_NUMBER' as serial number returns a dummy implementation
     /// \param parameters Parameters for the channel
@@ -45,6 +73,20 @@ class ChannelFactory
       return getBar(Parameters::makeParameters(cardId, channel));
     }
 
+    /// Get a read-only object to access a BAR for monitoring, which may be used next to the DMA owner of the card.
+    /// Only whitelisted status registers can be read (see the MonitorRegisters parameter), writes throw
+    /// UnsafeWriteAccess, and the reads of all monitor BARs of a card, in any process, are kept within the
+    /// MonitorBudget parameter.
+    /// \param parameters Parameters for the channel
+    BarSharedPtr getMonitorBar(const Parameters &parameters);
+
+    /// Drops the retained PDA registrations of buffers within the given memory range, see
+    /// Parameters::setBufferRegistrationRetained(). Must be called before the memory is unmapped, and after the
+    /// channels using it are closed.
+    /// \param address Start of the memory range
+    /// \param size Size of the memory range
+    static void releaseBufferRegistrations(void* address, size_t size);
+
     static int getDummySerialNumber()
     {
       return -1;
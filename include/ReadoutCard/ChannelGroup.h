@@ -0,0 +1,107 @@
+/// \file ChannelGroup.h
+/// \brief Definition of the ChannelGroup class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_CHANNELGROUP_H_
+#define ALICEO2_INCLUDE_READOUTCARD_CHANNELGROUP_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "ReadoutCard/DmaChannelInterface.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Services several DMA channels from a single thread, for example the six channels of a C-RORC, so they don't each
+/// need their own polling thread. poll() drives the transfers of all channels, then hands their arrived superpages to
+/// a handler in round-robin batches.
+///
+/// The group and its channels are meant to be used from a single thread.
+class ChannelGroup
+{
+  public:
+    /// Default maximum amount of superpages handled for one channel before moving on to the next
+    static constexpr size_t DEFAULT_BATCH_SIZE = 16;
+
+    /// \param batchSize Maximum amount of superpages handled for one channel before moving on to the next
+    explicit ChannelGroup(size_t batchSize = DEFAULT_BATCH_SIZE);
+
+    /// Adds a channel to the group
+    /// \param channel The channel
+    /// \return Index of the channel in the group, as passed to the poll() handler
+    size_t addChannel(std::shared_ptr<DmaChannelInterface> channel);
+
+    /// Gets the amount of channels in the group
+    size_t size() const
+    {
+      return mChannels.size();
+    }
+
+    /// Gets a channel of the group, for example to push superpages into it
+    /// \param index Index of the channel, as returned by addChannel()
+    DmaChannelInterface& getChannel(size_t index)
+    {
+      return *mChannels.at(index);
+    }
+
+    /// Starts DMA on all channels
+    void startDma();
+
+    /// Prepares DMA on all channels, so the next startDma() only has to enable it. See
+    /// DmaChannelInterface::prepareDma().
+    void prepareDma();
+
+    /// Stops DMA on all channels. If stopping one fails, the others are still stopped and the first exception is
+    /// rethrown afterwards.
+    void stopDma();
+
+    /// Calls fillSuperpages() on every channel, then pops the arrived superpages and hands them to the handler. At
+    /// most the batch size is handled per channel before moving on to the next, and the first channel changes every
+    /// call, so a busy channel can't starve the others.
+    /// \param handler Called as handler(size_t channelIndex, const Superpage& superpage) for every arrived superpage. It
+    ///   may push superpages into the channels.
+    /// \return The amount of superpages handled
+    template <typename Handler>
+    size_t poll(Handler&& handler)
+    {
+      // Drive the transfers of all channels first, so they all have their queues topped up before we spend time on
+      // the arrivals
+      for (const auto& channel : mChannels) {
+        channel->fillSuperpages();
+      }
+
+      const size_t count = mChannels.size();
+      size_t handled = 0;
+      size_t index = mNextChannel;
+      for (size_t i = 0; i < count; ++i) {
+        auto popped = mChannels[index]->popSuperpages(mBatch.data(), mBatch.size());
+        for (size_t j = 0; j < popped; ++j) {
+          handler(index, mBatch[j]);
+        }
+        handled += popped;
+        index = (index + 1 == count) ? 0 : index + 1;
+      }
+
+      if (count != 0) {
+        mNextChannel = (mNextChannel + 1 == count) ? 0 : mNextChannel + 1;
+      }
+      return handled;
+    }
+
+  private:
+    /// The channels of the group
+    std::vector<std::shared_ptr<DmaChannelInterface>> mChannels;
+
+    /// Buffer the superpages of one batch are popped into
+    std::vector<Superpage> mBatch;
+
+    /// Index of the channel poll() starts with
+    size_t mNextChannel = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_CHANNELGROUP_H_
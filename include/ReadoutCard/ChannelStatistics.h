@@ -0,0 +1,62 @@
+/// \file ChannelStatistics.h
+/// \brief Definition of the ChannelStatistics struct.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_CHANNELSTATISTICS_H_
+#define ALICEO2_INCLUDE_READOUTCARD_CHANNELSTATISTICS_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Statistics of a single link of a DMA channel
+struct LinkStatistics
+{
+    uint32_t linkId; ///< ID of the link
+    uint64_t superpages; ///< Amount of superpages that arrived from the link
+    uint64_t bytes; ///< Amount of bytes received from the link
+};
+
+/// Statistics of a DMA channel, counted since the channel was opened
+struct ChannelStatistics
+{
+    /// Statistics of the links of the channel
+    std::vector<LinkStatistics> links;
+
+    /// Amount of superpages in the transfer queue when it was last counted
+    uint64_t transferQueueSize;
+
+    /// Amount of superpages in the ready queue when it was last counted
+    uint64_t readyQueueSize;
+
+    /// Highest amount of superpages that were in the transfer queue at once
+    uint64_t transferQueueHighWater;
+
+    /// Highest amount of superpages that were in the ready queue at once
+    uint64_t readyQueueHighWater;
+
+    /// Amount of fillSuperpages() calls that found no new superpages
+    uint64_t emptyFills;
+
+    /// Amount of times arrived superpages could not be moved into the ready queue because it was full
+    uint64_t readyQueueFull;
+
+    /// Amount of arrived superpages that were left on the card because the ready queue was full. They are picked up
+    /// by later fillSuperpages() calls once the user pops superpages.
+    uint64_t superpagesLeftOnCard;
+
+    /// Amount of superpages given back to the card unread to make room in the full ready queue, with the DropOldest
+    /// ReadyQueueOverflow policy
+    uint64_t superpagesDropped;
+
+    /// Amount of times the channel was recovered after a DMA error, see DmaChannelInterface::recover()
+    uint64_t recoveries;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_CHANNELSTATISTICS_H_
@@ -0,0 +1,100 @@
+/// \file ChannelStatisticsTable.h
+/// \brief Definition of the ChannelStatisticsTable struct.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_CHANNELSTATISTICSTABLE_H_
+#define ALICEO2_INCLUDE_READOUTCARD_CHANNELSTATISTICSTABLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ReadoutCard/ChannelStatistics.h"
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Fixed-layout table of the statistics of a DMA channel. With the StatisticsPublishingEnabled parameter, a channel
+/// keeps its statistics in such a table in /dev/shm, at getPath(), so monitoring agents can read them at any rate
+/// without touching the card or the readout process.
+///
+/// This struct is meant to be used as an aliased type, reinterpret_casted from the mapped file. It is guarded by a
+/// sequence lock: the thread driving the channel makes the sequence odd while it updates the counters, so readers copy
+/// them and retry if the sequence was odd or changed in the meantime. The writer never waits for the readers.
+struct ChannelStatisticsTable
+{
+    /// Marks an initialized table, "ROCCHSTA"
+    static constexpr uint64_t MAGIC = 0x524f434348535441;
+    static constexpr uint32_t VERSION = 3;
+
+    /// Highest link ID that can be counted, plus one
+    static constexpr size_t MAX_LINKS = 32;
+
+    /// Gets the path of the table of a channel
+    static std::string getPath(const PciAddress& pciAddress, int channel);
+
+    /// Clears the counters and the links, and marks the table as initialized and open. Called by the writer only.
+    void reset();
+
+    /// Starts an update of the counters. Called by the writer only.
+    void beginWrite()
+    {
+      sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /// Ends an update of the counters. Called by the writer only.
+    void endWrite()
+    {
+      sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Makes a consistent snapshot of the counters. Safe to call from any thread or process, while the writer updates.
+    ChannelStatistics read() const;
+
+    /// Checks if the table was initialized by a channel, and has the layout of this version
+    bool isValid() const
+    {
+      return magic.load(std::memory_order_acquire) == MAGIC && version == VERSION;
+    }
+
+    /// Checks if the channel that writes the table is still open. A closed channel leaves its last statistics.
+    bool isOpen() const
+    {
+      return open.load(std::memory_order_relaxed) != 0;
+    }
+
+    using Counter = std::atomic<uint64_t>;
+
+    struct Link
+    {
+        Counter superpages;
+        Counter bytes;
+    };
+
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    /// 1 while the channel is open
+    std::atomic<uint32_t> open;
+    /// Odd while the writer is updating
+    std::atomic<uint64_t> sequence;
+    /// Links counted, bit N for link N
+    std::atomic<uint32_t> linkMask;
+    Link links[MAX_LINKS];
+    Counter transferQueueSize;
+    Counter readyQueueSize;
+    Counter transferQueueHighWater;
+    Counter readyQueueHighWater;
+    Counter emptyFills;
+    Counter readyQueueFull;
+    Counter superpagesLeftOnCard;
+    Counter superpagesDropped;
+    Counter recoveries;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_CHANNELSTATISTICSTABLE_H_
@@ -0,0 +1,142 @@
+/// \file ClockCorrelator.h
+/// \brief Definition of the ClockCorrelator class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_CLOCKCORRELATOR_H_
+#define ALICEO2_INCLUDE_READOUTCARD_CLOCKCORRELATOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Correlates a free-running counter of a card with the host's CLOCK_MONOTONIC, so timestamps the card puts in the
+/// data can be converted to host time, for example to measure the latency from the detector to the host per superpage.
+///
+/// A correlation sample is a read of the counter bracketed by two reads of the host clock. Of a few reads in a row,
+/// the one with the narrowest bracket is kept, since it was disturbed the least by the PCIe round trip; its midpoint is
+/// taken as the host time of the counter value. A line fitted through the samples of a sliding window gives the offset
+/// and the drift of the card clock against the host clock.
+///
+/// The samples are taken by sample(), or periodically by a background thread with start(). toHostTime() may be called
+/// from other threads at the same time.
+class ClockCorrelator
+{
+  public:
+    /// Function reading the card's counter, typically a register of its BAR
+    using ReadCounter = std::function<uint64_t()>;
+
+    struct Options
+    {
+        /// Nominal frequency of the counter in Hz, used until there are two samples to measure it
+        double frequency = 0;
+        /// Width of the counter in bits. A counter that wraps is unwrapped between samples, so it must not wrap twice
+        /// between two of them.
+        int counterBits = 32;
+        /// Interval between the samples taken by the background thread
+        std::chrono::milliseconds interval { 100 };
+        /// Amount of reads per sample, of which the narrowest bracketed one is kept
+        size_t readsPerSample = 8;
+        /// Amount of samples the line is fitted through
+        size_t window = 64;
+    };
+
+    /// A read of the counter, between two reads of the host clock
+    struct Sample
+    {
+        /// Counter value, as read
+        uint64_t counter;
+        /// CLOCK_MONOTONIC in nanoseconds before the read
+        int64_t hostBefore;
+        /// CLOCK_MONOTONIC in nanoseconds after the read
+        int64_t hostAfter;
+    };
+
+    /// \throw Exception if an option is invalid
+    ClockCorrelator(ReadCounter readCounter, const Options& options);
+
+    /// Stops the background thread
+    ~ClockCorrelator();
+
+    ClockCorrelator(const ClockCorrelator&) = delete;
+    ClockCorrelator& operator=(const ClockCorrelator&) = delete;
+
+    /// Starts the background thread taking a sample every interval
+    void start();
+
+    /// Stops the background thread
+    void stop();
+
+    /// Takes a sample now
+    void sample();
+
+    /// Adds a sample taken by the user
+    void addSample(const Sample& sample);
+
+    /// Checks if there is at least one sample, so toHostTime() can be used
+    bool isValid() const;
+
+    /// Converts a value of the counter to host time. The value may be truncated to the width of the counter, e.g. a
+    /// 32-bit timestamp from the data, in which case it's taken as the value nearest to the latest sample.
+    /// \return CLOCK_MONOTONIC in nanoseconds at which the counter had the value, 0 if there are no samples yet
+    int64_t toHostTime(uint64_t counter) const;
+
+    /// Gets the measured frequency of the counter in Hz, the nominal one until there are two samples
+    double getFrequency() const;
+
+    /// Gets the drift of the counter against the host clock, in parts per million of the nominal frequency
+    double getDriftPpm() const;
+
+    /// Gets the root mean square of the distance of the samples to the fitted line, in nanoseconds, as an estimate of
+    /// the uncertainty of toHostTime()
+    double getResidual() const;
+
+    /// Gets the amount of samples taken since construction
+    uint64_t getSampleCount() const;
+
+    /// Gets the host's CLOCK_MONOTONIC in nanoseconds, the host time of the correlation
+    static int64_t getHostTime();
+
+  private:
+    /// A sample with its counter value unwrapped
+    struct Point
+    {
+        uint64_t counter;
+        int64_t host;
+    };
+
+    /// Extends a counter value to 64 bits, nearest to the given unwrapped value. Requires mMutex.
+    uint64_t unwrap(uint64_t counter, uint64_t near) const;
+    /// Fits the line through the points. Requires mMutex.
+    void fit();
+    void sampleLoop();
+
+    ReadCounter mReadCounter;
+    Options mOptions;
+    uint64_t mCounterMask;
+
+    mutable std::mutex mMutex;
+    std::deque<Point> mPoints;
+    uint64_t mSampleCount = 0;
+    /// The fitted line: host time = mHost + (counter - mCounter) * mNanosecondsPerTick
+    uint64_t mCounter = 0;
+    int64_t mHost = 0;
+    double mNanosecondsPerTick;
+    double mResidual = 0;
+
+    std::atomic<bool> mStop { false };
+    std::thread mThread;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_CLOCKCORRELATOR_H_
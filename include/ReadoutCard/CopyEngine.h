@@ -0,0 +1,95 @@
+/// \file CopyEngine.h
+/// \brief Definition of the CopyEngine class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_COPYENGINE_H_
+#define ALICEO2_INCLUDE_READOUTCARD_COPYENGINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Copies data out of the DMA buffer, such as superpages going into time-frame buffers, with an Intel Data Streaming
+/// Accelerator (DSA) instead of the CPU, so the cores are free for processing.
+///
+/// Copies are submitted to a dedicated DSA work queue made by the idxd driver, such as /dev/dsa/wq0.0 (see the
+/// accel-config tool), and their completion is polled. If no work queue is given or it can't be opened, the CPU copies
+/// the data when the copy is submitted, so users don't need a separate code path. A copy that the DSA does not
+/// complete, for example on a page fault, is finished by the CPU.
+///
+/// Completions are returned in the order of submission. The engine is not thread-safe.
+class CopyEngine
+{
+  public:
+    /// Maximum amount of copies in flight
+    static constexpr size_t QUEUE_DEPTH = 64;
+
+    /// \param workQueuePath Path of the DSA work queue device, empty to copy with the CPU
+    explicit CopyEngine(const std::string& workQueuePath = "");
+
+    /// Waits for the copies in flight
+    ~CopyEngine();
+
+    CopyEngine(const CopyEngine&) = delete;
+    CopyEngine& operator=(const CopyEngine&) = delete;
+
+    /// Starts a copy. The memory must not be touched until poll() returned the copy's tag.
+    /// \param destination Start of the destination
+    /// \param source Start of the source, which must not overlap with the destination
+    /// \param size Amount of bytes to copy
+    /// \param tag Value returned by poll() when the copy completed
+    /// \return False if the queue is full, in which case nothing was started
+    bool submit(void* destination, const void* source, size_t size, uint64_t tag);
+
+    /// Gets the tags of completed copies, in the order the copies were submitted
+    /// \param tags Array to put the tags in
+    /// \param max Maximum amount of tags to get
+    /// \return The amount of tags put in the array
+    size_t poll(uint64_t* tags, size_t max);
+
+    /// Gets the amount of copies that were submitted but not yet returned by poll()
+    size_t getInFlight() const;
+
+    /// Checks if the copies are done by a DSA, rather than the CPU
+    bool isHardware() const;
+
+    /// Gets the amount of copies the CPU had to finish after the DSA did not
+    uint64_t getFallbackCount() const;
+
+  private:
+    /// Descriptor, completion record and copy of a queue entry, laid out as the DSA needs them
+    struct Slot;
+
+    /// Submits the descriptor of a slot to the work queue
+    void submitToDevice(Slot& slot);
+
+    /// Checks if the copy of a slot is done, finishing it with the CPU if the DSA gave up on it
+    bool isDone(Slot& slot);
+
+    /// File descriptor of the work queue, -1 when copying with the CPU
+    int mFileDescriptor;
+
+    /// Submission portal of the work queue
+    void* mPortal;
+
+    /// Ring of QUEUE_DEPTH slots
+    Slot* mSlots;
+
+    /// Amount of copies the work queue accepts at once
+    size_t mDepth;
+
+    /// Counts of submitted and returned copies, the slot of a copy is its count modulo QUEUE_DEPTH
+    uint64_t mSubmitted;
+    uint64_t mReturned;
+
+    uint64_t mFallbackCount;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_COPYENGINE_H_
@@ -0,0 +1,69 @@
+/// \file DataPattern.h
+/// \brief Definition of the DataPattern class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_DATAPATTERN_H_
+#define ALICEO2_INCLUDE_READOUTCARD_DATAPATTERN_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace AliceO2 {
+namespace roc {
+
+/// A pattern of 32-bit words as generated by the cards, with a fast way of verifying data against it.
+///
+/// Word i of the pattern is `(start + (i >> shift) * increment) & mask[i % 4]`, which covers the C-RORC patterns and
+/// the CRU's internal and DDG patterns. findMismatch() uses AVX-512 or AVX2 if the CPU supports it, which is detected
+/// once at runtime, and falls back to a scalar loop otherwise.
+class DataPattern
+{
+  public:
+    /// Words counting up by one from the given value
+    static DataPattern makeIncremental(uint32_t first);
+
+    /// Words of one value, such as the alternating (0xa5a5a5a5) and constant (0x12345678) patterns
+    static DataPattern makeConstant(uint32_t value);
+
+    /// CRU internal pattern: 256-bit words of 8 copies of a counter, which increments by one every 256-bit word
+    static DataPattern makeCruInternal(uint32_t counter);
+
+    /// CRU DDG pattern: 128-bit words of the counter, the counter, its 16 LSBs and 0, where the counter increments by
+    /// one every 128-bit word
+    static DataPattern makeCruDdg(uint32_t counter);
+
+    /// Gets the expected value of the word at the given index
+    uint32_t getExpected(size_t index) const
+    {
+      return (mStart + uint32_t(index >> mShift) * mIncrement) & mMask[index % 4];
+    }
+
+    /// Finds the first word that does not match the pattern. The data is read once by this call, so it can be used on
+    /// DMA buffers without going through volatile accesses word by word.
+    /// \param data Start of the data, where the pattern's word 0 is expected
+    /// \param begin Index of the first word to check
+    /// \param end Index one past the last word to check
+    /// \return Index of the first mismatching word, or end if all words in [begin, end) match
+    size_t findMismatch(const void* data, size_t begin, size_t end) const;
+
+    /// Gets the name of the implementation findMismatch() uses on this CPU: "avx512", "avx2" or "scalar"
+    static const char* getImplementation();
+
+  private:
+    DataPattern(uint32_t start, uint32_t shift, uint32_t increment, std::array<uint32_t, 4> mask)
+        : mStart(start), mShift(shift), mIncrement(increment), mMask(mask)
+    {
+    }
+
+    uint32_t mStart;
+    uint32_t mShift;
+    uint32_t mIncrement;
+    std::array<uint32_t, 4> mMask;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_DATAPATTERN_H_
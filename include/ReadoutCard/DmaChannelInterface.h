@@ -6,11 +6,15 @@
 #ifndef ALICEO2_INCLUDE_READOUTCARD_DMACHANNELINTERFACE_H_
 #define ALICEO2_INCLUDE_READOUTCARD_DMACHANNELINTERFACE_H_
 
+#include <chrono>
 #include <cstdint>
+#include <iosfwd>
 #include <boost/optional.hpp>
 #include <InfoLogger/InfoLogger.hxx>
+#include "ReadoutCard/BarStatistics.h"
 #include "ReadoutCard/Parameters.h"
 #include "ReadoutCard/CardType.h"
+#include "ReadoutCard/ChannelStatistics.h"
 #include "ReadoutCard/ParameterTypes/ResetLevel.h"
 #include "ReadoutCard/RegisterReadWriteInterface.h"
 #include "ReadoutCard/Superpage.h"
@@ -28,8 +32,15 @@ class DmaChannelInterface
 
     /// Starts DMA for the given channel
     /// Call this before pushing pages. May become unneeded in the future.
+    /// If the DMA was prepared with prepareDma(), this only enables the DMA engine.
     virtual void startDma() = 0;
 
+    /// Does all the work of startDma() up to enabling the DMA engine ahead of time: configuring the links and the data
+    /// source, and the resets with their waits. The channel is then "armed", and the next startDma() takes no more
+    /// than a register write, so a channel that is kept open between runs can start a run with little latency.
+    /// Superpages are pushed after startDma() as usual. stopDma() also disarms a prepared channel.
+    virtual void prepareDma() = 0;
+
     /// Resets the channel. Requires the DMA to be stopped.
     /// \param resetLevel The depth of the reset
     virtual void resetChannel(ResetLevel::type resetLevel) = 0;
@@ -57,6 +68,46 @@ class DmaChannelInterface
     /// \param superpage Superpage to push
     virtual void pushSuperpage(Superpage superpage) = 0;
 
+    /// Adds multiple superpages to the "transfer queue" in one call.
+    /// Behaves like calling pushSuperpage() for each superpage in order, but allows the driver to amortize the
+    /// per-superpage overhead of checking and queueing.
+    /// All superpages are checked before any of them is pushed. If the transfer queue does not have room for all of
+    /// them, or one of them is invalid, none are pushed and an exception is thrown.
+    ///
+    /// \param superpages Array of superpages to push
+    /// \param count Amount of superpages in the array
+    virtual void pushSuperpages(const Superpage* superpages, size_t count) = 0;
+
+    /// Like pushSuperpage(), but returns false instead of throwing if the "transfer queue" is full, so the hot path
+    /// needs neither a getTransferQueueAvailable() call nor exception handling. Invalid superpages still throw.
+    /// \param superpage Superpage to push
+    /// \return True if the superpage was pushed, false if the transfer queue was full
+    virtual bool tryPushSuperpage(const Superpage& superpage) = 0;
+
+    /// Like tryPushSuperpage(), but the superpage goes to the given link instead of the one the driver would pick, so
+    /// the data of a link lands in memory chosen by the user.
+    /// Cards with one link per channel, such as the C-RORC, only accept link 0.
+    /// \param superpage Superpage to push
+    /// \param linkId ID of the link, which must be enabled in the channel
+    /// \return True if the superpage was pushed, false if the queue of the link was full
+    virtual bool tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId) = 0;
+
+    /// Checks a superpage the way pushing it does, without pushing it. The push methods check their superpages
+    /// themselves; this is for code that pushes them later, such as a driver thread queueing them first.
+    /// \param superpage Superpage to check
+    /// \param linkId Link the superpage would be pushed to with tryPushSuperpageToLink(), or none for the one the
+    ///   driver picks
+    /// \throw Exception if the superpage is invalid, InvalidLinkId if the link is not enabled in the channel
+    virtual void validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId) = 0;
+
+    /// Gives a superpage popped from this channel back to the "transfer queue", for superpages that are recycled as
+    /// they are after processing, without going through a free queue of the user.
+    /// If the superpage was not changed since the driver checked it (see Superpage::isChecked()), the checks of
+    /// pushSuperpage() are skipped, and where the card has links, it goes back to the link it came from. Its received
+    /// size and ready flag are reset.
+    /// \param superpage Superpage popped from this channel
+    virtual void releaseSuperpage(Superpage superpage) = 0;
+
     /// Gets the superpage at the front of the "ready queue". Does not pop it.
     /// Note that it returns a copy of the Superpage's values.
     virtual Superpage getSuperpage() = 0;
@@ -64,9 +115,52 @@ class DmaChannelInterface
     /// Pops and returns the superpage at the front of the "ready queue".
     virtual Superpage popSuperpage() = 0;
 
+    /// Like popSuperpage(), but returns false instead of throwing if the "ready queue" is empty, so the hot path needs
+    /// neither a getReadyQueueSize() call nor exception handling.
+    /// \param superpage Receives a copy of the popped superpage. Left untouched if there was none.
+    /// \return True if a superpage was popped, false if the ready queue was empty
+    virtual bool tryPopSuperpage(Superpage& superpage) = 0;
+
+    /// Pops superpages from the front of the "ready queue" into the given array, up to the given maximum.
+    /// This is the bulk equivalent of checking getReadyQueueSize() and calling popSuperpage() repeatedly.
+    /// \param superpages Array to receive copies of the popped superpages. Must have room for at least `max` elements.
+    /// \param max Maximum amount of superpages to pop
+    /// \return The amount of superpages popped, may be 0
+    virtual size_t popSuperpages(Superpage* superpages, size_t max) = 0;
+
     /// Handles internal driver business. Call in a loop. May be replaced by internal driver thread at some point.
     virtual void fillSuperpages() = 0;
 
+    /// Gets the superpages that are still being filled but already received some data, for streaming the data of
+    /// large superpages before they are complete. The received size of each returned superpage is a watermark: the data
+    /// from its offset up to getReceived() is final and may be read, while the rest must not be touched. The superpages
+    /// stay owned by the driver, and still arrive in the "ready queue" as usual once they are filled.
+    /// The watermarks are updated by fillSuperpages(), which should be called first.
+    /// Backends that can't follow a transfer in progress (or a CRU channel without the status page, see
+    /// Parameters::setStatusPageEnabled()) return none.
+    /// \param superpages Array to receive copies of the partially filled superpages. Must have room for at least `max`
+    ///   elements. For backends with multiple links, getLinkId() tells them apart.
+    /// \param max Maximum amount of superpages to get
+    /// \return The amount of superpages written to the array, may be 0
+    virtual size_t getPartialSuperpages(Superpage* superpages, size_t max) = 0;
+
+    /// Waits until there is at least one superpage in the "ready queue", or until the timeout expires.
+    /// Handles internal driver business while waiting, like fillSuperpages() does.
+    /// The driver first busy-polls for a short time (see Parameters::setWaitSpinTime()) to keep latency low, then backs
+    /// off to sleeping so that an idle channel does not occupy a whole core.
+    /// \param timeout Maximum time to wait
+    /// \return True if a superpage is ready, false if the timeout expired
+    virtual bool waitForReadySuperpage(std::chrono::nanoseconds timeout) = 0;
+
+    /// Gets a file descriptor that becomes readable when superpages may have arrived, for integration into a
+    /// poll(), select() or epoll loop. When it becomes readable, call fillSuperpages(), which also clears it. The user
+    /// must not read from it.
+    /// Only available when the interrupt mode (see Parameters::setInterruptEnabled()) or the driver thread is enabled.
+    /// Since the card may coalesce or miss interrupts, the poll should use a timeout, after which fillSuperpages()
+    /// is called anyway.
+    /// \return The file descriptor, or -1 if not available
+    virtual int getReadyFileDescriptor() = 0;
+
     /// Gets the amount of superpages that can still be pushed into the "transfer queue" using pushSuperpage()
     virtual int getTransferQueueAvailable() = 0;
 
@@ -79,6 +173,31 @@ class DmaChannelInterface
     /// This moves any remaining superpages to the "ready queue", even if they are not filled.
     virtual void stopDma() = 0;
 
+    /// Recovers a started channel from a DMA error, such as a FIFO overflow or a superpage counter inconsistency,
+    /// without closing it. This stops the DMA, moves the superpages given to the card to the "ready queue" with the
+    /// data they received up to then, resets only the DMA engine, and restarts the DMA. The channel keeps its buffers
+    /// and its lock, so this takes milliseconds instead of the seconds of reopening the channel.
+    /// The ready queue must have room for the superpages given to the card, otherwise an exception is thrown and
+    /// nothing is changed: pop superpages and try again.
+    virtual void recover() = 0;
+
+    /// Ends the current run and starts the next one, without waiting for the user to pop the superpages of the
+    /// current run. Like stopDma(), this moves the superpages given to the card to the "ready queue" with the data they
+    /// received, but the ready queue is kept, the card is configured again for the next run, with the links enabled at
+    /// this point, and the DMA restarts right away. Superpages pushed from then on are filled with the data of the next
+    /// run while the user still pops those of the current one. Every superpage carries the epoch of the run it was
+    /// given to the card in, see Superpage::getRunEpoch(), so the user can tell the runs apart.
+    /// This skips reopening the channel, not the card reset: since superpages are normally still on the card, the CRU
+    /// resets the card as startDma() does.
+    /// The ready queue must have room for the superpages given to the card, otherwise an exception is thrown and
+    /// nothing is changed: pop superpages and try again.
+    /// \return The epoch of the new run
+    virtual uint16_t startNextRun() = 0;
+
+    /// Gets the epoch of the current run, which superpages pushed now will carry. It starts at 0 when the channel is
+    /// opened and is incremented by startNextRun().
+    virtual uint16_t getRunEpoch() = 0;
+
     /// Returns the type of the card this DmaChannelInterface is controlling
     /// \return The card type
     virtual CardType::type getCardType() = 0;
@@ -95,8 +214,38 @@ class DmaChannelInterface
     /// Note: dummy card will always return 0
     virtual int getNumaNode() = 0;
 
+    /// Gets the DMA page size of the channel in bytes, by which the data in the superpages is to be walked, e.g. with
+    /// Cru::SuperpageView or LinkIntegrityMonitor. This is the DmaPageSize parameter if it was given, otherwise what
+    /// the channel chose: the C-RORC follows the GeneratorDataSize parameter, and the CRU uses 8 KiB, or with a
+    /// DmaPageSize of 0 the largest page size its firmware supports.
+    virtual size_t getDmaPageSize() = 0;
+
     // Optional features
 
+    /// Registers an additional DMA buffer with the channel, so memory can be added without reopening it. This may be
+    /// done while DMA is running. Superpages in the buffer are pushed with Superpage::setBufferId() set to the returned
+    /// ID, and with their offset relative to the start of the buffer. The buffer must stay mapped until the channel is
+    /// closed.
+    /// Currently only supported by the C-RORC and CRU backends.
+    /// \param buffer The buffer
+    /// \return ID of the buffer. The buffer given with Parameters::setBufferParameters() has ID 0.
+    virtual int addBuffer(const buffer_parameters::Memory& buffer) = 0;
+
+    /// Adds a link to the running channel, or enables one that was disabled with disableLink(), without restarting the
+    /// DMA. The link gets its share of the pushed superpages from then on, and the transfer queue grows by the capacity
+    /// of a link. A link that is already enabled is left alone.
+    /// Currently only supported by the CRU backend.
+    /// \param linkId ID of the link
+    virtual void enableLink(uint32_t linkId) = 0;
+
+    /// Takes a link out of the running channel without restarting the DMA, for example one whose detector side went
+    /// down. The card stops writing for the link, and its superpages go to the "ready queue" with the data they
+    /// received, so the ready queue must have room for them, otherwise an exception is thrown and nothing is changed.
+    /// Superpages are no longer pushed to the link, and the transfer queue shrinks by the capacity of a link.
+    /// Currently only supported by the CRU backend.
+    /// \param linkId ID of the link
+    virtual void disableLink(uint32_t linkId) = 0;
+
     /// Request injection of an error into the data stream
     /// Currently, only the CRU backend supports this when using the internal data generator
     /// \return True if successful, false if no error was injected
@@ -117,6 +266,20 @@ class DmaChannelInterface
     /// Gets card unique ID, such as an FPGA chip ID in the case of the CRU
     /// \return A string containing the unique ID
     virtual boost::optional<std::string> getCardId() = 0;
+
+    /// Gets the amount of reads, writes and cycles spent per register, for the BARs used by this channel.
+    /// Only collected if ReadoutCard is built with the ALICEO2_READOUTCARD_BAR_STATISTICS CMake option, otherwise empty.
+    virtual BarStatistics getBarStatistics() = 0;
+
+    /// Gets statistics of the channel: the superpages and bytes received per link, the queue high-water marks, and
+    /// counters showing back-pressure inside the driver. They are counted on the hot path with relaxed atomics, so this
+    /// may be called from another thread than the one driving the channel.
+    virtual ChannelStatistics getStatistics() = 0;
+
+    /// Writes the most recent DMA events of the channel (DMA start/stop, resets, superpages pushed, arrived and
+    /// popped) with their timestamp counter timestamps to the stream. Meant for debugging: the trace is dumped
+    /// automatically when the driver detects an inconsistency, and can be dumped on demand.
+    virtual void dumpTrace(std::ostream& stream) = 0;
 };
 
 } // namespace roc
@@ -0,0 +1,62 @@
+/// \file GpuBufferRegistration.h
+/// \brief Definition of the GpuBufferRegistration class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_GPUBUFFERREGISTRATION_H_
+#define ALICEO2_INCLUDE_READOUTCARD_GPUBUFFERREGISTRATION_H_
+
+#include <cstddef>
+#include <map>
+#include "ReadoutCard/Superpage.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Registers the DMA buffers of a channel as pinned host memory with CUDA, so GPU kernels can read superpages in place
+/// over PCIe, without staging them into device memory with an extra copy. This works best with the GPU on the same
+/// PCIe root complex as the card.
+///
+/// As with RdmaBufferRegistration, the buffers are registered under the IDs the channel uses for them, and superpages
+/// are looked up through their Superpage::getBufferId(). The memory of a buffer must stay mapped as long as it is
+/// registered.
+///
+/// Only available when the library is built with CUDA (ALICEO2_READOUTCARD_CUDA_ENABLED).
+class GpuBufferRegistration
+{
+  public:
+    GpuBufferRegistration() = default;
+    ~GpuBufferRegistration();
+
+    GpuBufferRegistration(const GpuBufferRegistration&) = delete;
+    GpuBufferRegistration& operator=(const GpuBufferRegistration&) = delete;
+
+    /// Registers a buffer with the current CUDA device's context, mapped into the device's address space
+    /// \param bufferId ID the channel uses for the buffer
+    /// \param address Userspace address of the buffer, as given to the channel
+    /// \param size Size of the buffer
+    void registerBuffer(int bufferId, void* address, size_t size);
+
+    /// Deregisters a buffer
+    void deregisterBuffer(int bufferId);
+
+    /// Gets the device pointer kernels use to access the superpage
+    void* getDevicePointer(const Superpage& superpage) const;
+
+  private:
+    struct Buffer
+    {
+        void* address;
+        void* devicePointer;
+    };
+
+    const Buffer& getBuffer(int bufferId) const;
+
+    /// Registered buffers by buffer ID
+    std::map<int, Buffer> mBuffers;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_GPUBUFFERREGISTRATION_H_
@@ -0,0 +1,93 @@
+/// \file HugepageMemfd.h
+/// \brief Definition of the HugepageMemfd class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_HUGEPAGEMEMFD_H_
+#define ALICEO2_INCLUDE_READOUTCARD_HUGEPAGEMEMFD_H_
+
+#include <cstddef>
+#include <string>
+#include <boost/optional.hpp>
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Anonymous hugepage memory made with memfd_create(), to be used as DMA buffer. Unlike the buffer files in the
+/// hugetlbfs, it needs no hugetlbfs mounts, and no file is left behind when the process dies. Other processes, such as
+/// the consumers of the data, get access to it by receiving its file descriptor over a Unix domain socket.
+///
+/// The memory is mapped and faulted in on construction, and unmapped and closed on destruction.
+class HugepageMemfd
+{
+  public:
+    /// Allocates the memory, using 1 GiB hugepages if the size allows it and they're available, and 2 MiB hugepages
+    /// otherwise.
+    /// \param size Size of the memory. Must be a multiple of 2 MiB.
+    /// \param name Name of the memory, only used for debugging, as shown in /proc/[pid]/fd
+    /// \param numaNode If given, the hugepages are allocated on this NUMA node, typically the one of the card writing
+    ///        into the buffer. Throws if that is not possible.
+    HugepageMemfd(size_t size, const std::string& name, boost::optional<int> numaNode = boost::none);
+
+    /// Maps memory made by another HugepageMemfd, for example in another process. The descriptor is duplicated, so the
+    /// caller keeps ownership of it.
+    /// \param fileDescriptor File descriptor of the memory
+    /// \param size Size of the memory
+    HugepageMemfd(int fileDescriptor, size_t size);
+
+    ~HugepageMemfd();
+
+    HugepageMemfd(const HugepageMemfd&) = delete;
+    HugepageMemfd& operator=(const HugepageMemfd&) = delete;
+
+    void* getAddress() const
+    {
+      return mAddress;
+    }
+
+    size_t getSize() const
+    {
+      return mSize;
+    }
+
+    int getFileDescriptor() const
+    {
+      return mFileDescriptor;
+    }
+
+    /// Gets the size of the pages backing the memory
+    size_t getPageSize() const
+    {
+      return mPageSize;
+    }
+
+    /// Gets the buffer parameters to open a channel on the memory with Parameters::setBufferParameters()
+    buffer_parameters::FileDescriptor getBufferParameters() const
+    {
+      return {mFileDescriptor, mSize};
+    }
+
+    /// Sends a file descriptor and the size of its memory over a connected Unix domain socket
+    static void sendFileDescriptor(int socket, int fileDescriptor, size_t size);
+
+    /// Receives a file descriptor and the size of its memory sent with sendFileDescriptor(). The caller owns the
+    /// received descriptor.
+    /// \param socket Connected Unix domain socket
+    /// \param size Set to the size of the memory
+    /// \return The file descriptor
+    static int receiveFileDescriptor(int socket, size_t& size);
+
+  private:
+    void map(size_t size);
+
+    int mFileDescriptor = -1;
+    void* mAddress = nullptr;
+    size_t mSize = 0;
+    size_t mPageSize = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_HUGEPAGEMEMFD_H_
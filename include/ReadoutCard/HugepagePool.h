@@ -0,0 +1,99 @@
+/// \file HugepagePool.h
+/// \brief Definition of the HugepagePool class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_HUGEPAGEPOOL_H_
+#define ALICEO2_INCLUDE_READOUTCARD_HUGEPAGEPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <boost/optional.hpp>
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// One large hugepage-backed region, reserved once, that hands out slices to be used as the DMA buffers of channels.
+/// This keeps the hugepage pool from fragmenting when many channels are opened, and avoids resizing and faulting in a
+/// buffer file for every channel.
+///
+/// The PDA registration of a channel's slice is kept when the channel is closed, so reopening the channel on the same
+/// slice does not need to register it again. The registrations are dropped when the pool is destroyed, so the pool
+/// must outlive the channels using it.
+///
+/// Typically, a process creates one pool per NUMA node with cards on it.
+class HugepagePool
+{
+  public:
+    /// Alignment and granularity of the slices, the smallest hugepage size
+    static constexpr size_t SLICE_ALIGNMENT = 2 * 1024 * 1024;
+
+    /// Reserves a region in the hugetlbfs, using 1 GiB hugepages if the size allows it and they're available, and
+    /// 2 MiB hugepages otherwise. The pages are faulted in right away. The backing file is deleted when the pool is
+    /// destroyed.
+    /// \param size Size of the region. Must be a multiple of 2 MiB.
+    /// \param name Name of the backing file
+    /// \param numaNode If given, the hugepages are allocated on this NUMA node, typically the one of the cards using the
+    ///        pool (see DmaChannelInterface::getNumaNode()). Throws if that is not possible.
+    HugepagePool(size_t size, const std::string& name, boost::optional<int> numaNode = boost::none);
+
+    /// Uses an already mapped region, which must stay mapped for the lifetime of the pool
+    /// \param address Start of the region. Must be aligned to 2 MiB.
+    /// \param size Size of the region. Must be a multiple of 2 MiB.
+    HugepagePool(void* address, size_t size);
+
+    ~HugepagePool();
+
+    /// Hands out a slice of the pool, to be passed to a channel with Parameters::setBufferParameters()
+    /// \param size Size of the slice, rounded up to a multiple of 2 MiB
+    /// \return Address and size of the slice
+    buffer_parameters::Memory allocate(size_t size);
+
+    /// Returns a slice to the pool
+    /// \param slice A slice returned by allocate()
+    void release(const buffer_parameters::Memory& slice);
+
+    /// Gets the start of the region
+    void* getAddress() const
+    {
+      return reinterpret_cast<void*>(mAddress);
+    }
+
+    /// Gets the size of the region
+    size_t getSize() const
+    {
+      return mSize;
+    }
+
+    /// Gets the amount of bytes that are not handed out
+    size_t getAvailable() const;
+
+    /// Checks if the memory lies within a pool that is alive
+    static bool isPoolMemory(const void* address, size_t size);
+
+  private:
+    void init();
+
+    /// Backing file, if the pool reserved the region itself
+    std::unique_ptr<MemoryMappedFile> mFile;
+
+    uintptr_t mAddress;
+    size_t mSize;
+
+    /// Free ranges, as offset to size. Neighbouring ranges are merged.
+    std::map<size_t, size_t> mFree;
+
+    /// Guards mFree
+    mutable std::mutex mMutex;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_HUGEPAGEPOOL_H_
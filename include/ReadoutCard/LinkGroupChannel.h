@@ -0,0 +1,76 @@
+/// \file LinkGroupChannel.h
+/// \brief Definition of the LinkGroupChannel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_LINKGROUPCHANNEL_H_
+#define ALICEO2_INCLUDE_READOUTCARD_LINKGROUPCHANNEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "ReadoutCard/SuperpageRing.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Reads out a group of links of a channel owned by another process, see LinkGroupMaster.
+/// Superpages are pushed for one of the group's links, and only the superpages that arrived on the group's links are
+/// popped. Their offsets are relative to the shared buffer, which is mapped at getAddress().
+///
+/// Meant to be used from one thread, by one process per group.
+class LinkGroupChannel
+{
+  public:
+    /// Attaches to a group
+    /// \param name Name given to the LinkGroupMaster
+    /// \param group Index of the group
+    LinkGroupChannel(const std::string& name, size_t group);
+
+    ~LinkGroupChannel();
+
+    /// Gets the start of the shared buffer in this process
+    void* getAddress() const;
+
+    /// Gets the size of the shared buffer
+    size_t getSize() const;
+
+    /// Gets the IDs of the links of the group
+    const std::vector<uint32_t>& getLinks() const
+    {
+      return mLinks;
+    }
+
+    /// Pushes a superpage for a link of the group. The master pushes it on its next poll.
+    /// The user data and page lengths pointers are not passed on, since they're only valid in this process.
+    /// \return False if the push ring was full
+    bool tryPushSuperpage(const Superpage& superpage, uint32_t linkId);
+
+    /// Pops a superpage that arrived on a link of the group. A pushed superpage the master could not push comes back
+    /// here too, not ready and without data.
+    /// \return False if none arrived
+    bool tryPopSuperpage(Superpage& superpage);
+
+  private:
+    /// Mapping of the DMA buffer
+    std::unique_ptr<MemoryMappedFile> mBufferFile;
+
+    /// Mapping of the segment holding the rings
+    std::unique_ptr<MemoryMappedFile> mSegmentFile;
+
+    std::unique_ptr<SuperpageRing> mPushRing;
+    std::unique_ptr<SuperpageRing> mReadyRing;
+
+    /// Links of the group, bit N for link N
+    uint64_t mLinkMask;
+
+    std::vector<uint32_t> mLinks;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_LINKGROUPCHANNEL_H_
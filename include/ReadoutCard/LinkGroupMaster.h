@@ -0,0 +1,118 @@
+/// \file LinkGroupMaster.h
+/// \brief Definition of the LinkGroupMaster class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_LINKGROUPMASTER_H_
+#define ALICEO2_INCLUDE_READOUTCARD_LINKGROUPMASTER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+#include "ReadoutCard/SuperpageRing.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Lets several processes each read out their own links of one DMA channel, such as independent detector subsystems
+/// sharing a CRU endpoint, without a central copy stage.
+///
+/// The master process creates a shared DMA buffer and a segment in /dev/shm with a push ring and a ready ring for every
+/// group of links, and opens the channel on the buffer with getBufferParameters(). The other processes attach to a
+/// group with a LinkGroupChannel. They push superpages for their links through their push ring, and poll() pushes them
+/// to those links with DmaChannelInterface::tryPushSuperpageToLink(), then hands every arrived superpage to the ready
+/// ring of the group owning its link.
+///
+/// poll() is meant to be called from one thread, and each group to be used by one process. The files are removed when
+/// the master is destroyed.
+class LinkGroupMaster
+{
+  public:
+    /// Creates the groups with a buffer in the hugetlbfs, see Utilities::tryMapFile()
+    /// \param name Name of the groups, used by the other processes to attach
+    /// \param bufferSize Size of the DMA buffer. Must be a multiple of 2 MiB.
+    /// \param groups Link IDs of every group. A link can be in one group only.
+    /// \param ringCapacity Amount of superpage descriptors each ring holds
+    /// \param numaNode If given, the buffer's hugepages are allocated on this NUMA node
+    LinkGroupMaster(const std::string& name, size_t bufferSize, const std::vector<std::vector<uint32_t>>& groups,
+        size_t ringCapacity, boost::optional<int> numaNode = boost::none);
+
+    /// Creates the groups with a buffer backed by the given file
+    LinkGroupMaster(const std::string& name, const std::string& bufferPath, size_t bufferSize,
+        const std::vector<std::vector<uint32_t>>& groups, size_t ringCapacity);
+
+    ~LinkGroupMaster();
+
+    /// Gets the buffer parameters to open the channel on the shared buffer with Parameters::setBufferParameters()
+    buffer_parameters::Memory getBufferParameters() const;
+
+    /// Pushes the superpages of the groups to their links, drives the transfers of the channel, and hands the arrived
+    /// superpages to the groups of their links. Superpages that don't fit in a full link queue or ready ring are
+    /// kept and retried on the next call. A group's superpage that is not for one of its links, or that the channel
+    /// rejects, goes back to the group's ready ring without data instead of being pushed.
+    /// \param channel The channel opened on the shared buffer
+    /// \return The amount of superpages pushed and handed out
+    /// \throw InvalidLinkId if superpages arrived on a link without group, after the others were handed out. They are
+    ///   kept for takeUnroutedSuperpages().
+    size_t poll(DmaChannelInterface& channel);
+
+    /// Takes the superpages poll() could not hand to a group because they arrived on a link without one
+    std::vector<Superpage> takeUnroutedSuperpages();
+
+    /// Gets the amount of groups
+    size_t getGroupCount() const
+    {
+      return mGroups.size();
+    }
+
+  private:
+    struct Group
+    {
+        std::unique_ptr<SuperpageRing> pushRing;
+        std::unique_ptr<SuperpageRing> readyRing;
+        /// Superpages read from the push ring whose link was full
+        std::deque<Superpage> pendingPushes;
+        /// Arrived superpages that did not fit in the ready ring
+        std::deque<Superpage> pendingReady;
+    };
+
+    void init(const std::string& name, const std::vector<std::vector<uint32_t>>& groups, size_t ringCapacity);
+
+    /// Checks a superpage read from a group's push ring: the ring is written by another process, so its link must be
+    /// checked against the group, and the channel's checks must not throw in the middle of poll()
+    bool isPushable(DmaChannelInterface& channel, size_t group, const Superpage& superpage) const;
+
+    /// Writes a superpage to the group's ready ring, or keeps it if the ring is full or others are waiting
+    /// \return True if it was written
+    bool handOut(Group& group, const Superpage& superpage);
+
+    /// Mapping of the DMA buffer
+    std::unique_ptr<MemoryMappedFile> mBufferFile;
+
+    /// Mapping of the segment holding the rings
+    std::unique_ptr<MemoryMappedFile> mSegmentFile;
+
+    std::vector<Group> mGroups;
+
+    /// Index of the group owning a link, by link ID, -1 for links without one
+    std::array<int, 64> mGroupByLink;
+
+    /// Buffer arrived superpages are popped into
+    std::vector<Superpage> mBatch;
+
+    /// Arrived superpages whose link has no group
+    std::vector<Superpage> mUnrouted;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_LINKGROUPMASTER_H_
@@ -0,0 +1,129 @@
+/// \file LinkIntegrityMonitor.h
+/// \brief Definition of the LinkIntegrityMonitor class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_LINKINTEGRITYMONITOR_H_
+#define ALICEO2_INCLUDE_READOUTCARD_LINKINTEGRITYMONITOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Integrity counters of a single link, counted since the monitor was created or reset
+struct LinkIntegrityStatistics
+{
+    uint32_t linkId; ///< ID of the link
+    uint64_t packets; ///< Amount of packets checked, one per DMA page unless they are packed
+    uint64_t bytes; ///< Amount of RDH and payload bytes in the pages with a valid size
+    uint64_t counterGaps; ///< Amount of pages whose packet counter did not follow the previous one
+    uint64_t dropped; ///< Amount of packets missing in the gaps. Since the counter is 8 bits, this is a lower bound.
+    uint64_t sizeErrors; ///< Amount of packets whose RDH memory size was smaller than the RDH or larger than the page
+                         ///< (packed: larger than the offset to the next packet, or that offset was out of range)
+};
+
+/// Checks the integrity of the data of CRU links while it is read out, at the cost of decoding one RDH per DMA page.
+///
+/// For every DMA page, the memory size of the RDH is checked to be within the page, and the 8-bit packet counter is
+/// checked to follow the previous one of its link. The payload is not read. The monitor is not thread-safe, every
+/// readout thread should use its own.
+///
+/// With packed packets, the packets follow each other through the superpage instead of starting a DMA page each, and
+/// the monitor steps from one to the next by the RDH's offset to the next packet. A packet's memory size must then fit
+/// within that offset, and the offset within the superpage. After a packet with a size error, the rest of the
+/// superpage cannot be walked, and is not checked.
+class LinkIntegrityMonitor
+{
+  public:
+    /// Amount of links whose counters are tracked, the link ID is 8 bits
+    static constexpr size_t MAX_LINKS = 256;
+
+    /// Default size of CRU DMA pages
+    static constexpr size_t DMA_PAGE_SIZE = 8 * 1024;
+
+    /// Result of checking a DMA page
+    enum class Status
+    {
+      Ok,
+      CounterGap, ///< The packet counter did not follow the previous one of the link
+      SizeError, ///< The RDH memory size is out of range. The packet counter is not used.
+    };
+
+    /// \param pageSize Size of the DMA pages
+    /// \param packed True if the packets are packed, false if every DMA page holds one
+    explicit LinkIntegrityMonitor(size_t pageSize = DMA_PAGE_SIZE, bool packed = false);
+
+    /// Checks the complete DMA pages of a received superpage, or with packed packets, the packets within the received
+    /// bytes
+    /// \param address Start of the superpage in the DMA buffer
+    /// \param received Amount of bytes received in the superpage
+    /// \return The amount of packets with an error
+    size_t checkSuperpage(const void* address, size_t received);
+
+    /// Checks the complete DMA pages of a received superpage, and computes their checksums for later stages to verify
+    /// the data with, see PageChecksum
+    /// \param address Start of the superpage in the DMA buffer
+    /// \param received Amount of bytes received in the superpage
+    /// \param checksums Array to put the CRC32C of every complete DMA page in, also with packed packets
+    /// \return The amount of packets with an error
+    size_t checkSuperpage(const void* address, size_t received, uint32_t* checksums);
+
+    /// Checks a single DMA page
+    /// \param page Start of the DMA page, where the RDH is
+    Status checkPage(const void* page);
+
+    /// Checks a single packet
+    /// \param packet Start of the packet, where the RDH is
+    /// \param available Amount of bytes from the packet to the end of the superpage. Only used with packed packets,
+    ///   otherwise the packet must fit in a DMA page.
+    Status checkPacket(const void* packet, size_t available);
+
+    /// Forgets the packet counter of a link, so its next page starts a new sequence. For when the caller lost data of
+    /// the link on purpose, or found an error the monitor does not check for.
+    void resync(uint32_t linkId);
+
+    /// Forgets the packet counters and clears the statistics of all links
+    void reset();
+
+    /// Gets the packet counter of the last page of a link with a valid size
+    /// \return The counter, or -1 if the link has no sequence yet
+    int getLastPacketCounter(uint32_t linkId) const;
+
+    /// Gets the counters of a link
+    LinkIntegrityStatistics getLinkStatistics(uint32_t linkId) const;
+
+    /// Gets the counters of the links that had at least one page checked
+    std::vector<LinkIntegrityStatistics> getStatistics() const;
+
+    /// Gets the sum of the error counters (counter gaps and size errors) of all links
+    uint64_t getErrorCount() const;
+
+  private:
+    struct Link
+    {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        uint64_t counterGaps = 0;
+        uint64_t dropped = 0;
+        uint64_t sizeErrors = 0;
+    };
+
+    static constexpr uint16_t UNKNOWN = 0xffff;
+
+    size_t mPageSize;
+    bool mPacked;
+
+    /// Expected next packet counter of every link
+    std::array<uint16_t, MAX_LINKS> mExpected;
+
+    std::array<Link, MAX_LINKS> mLinks;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_LINKINTEGRITYMONITOR_H_
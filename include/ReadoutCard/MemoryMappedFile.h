@@ -30,6 +30,15 @@ class MemoryMappedFile
 
     std::string getFileName() const;
 
+    /// Faults in all pages of the mapping, so the first DMA transfers and the registration of the buffer with PDA
+    /// don't have to. The contents are not modified.
+    void prefault();
+
+    /// Locks the pages of the mapping in memory with mlock(), which also faults them in. Hugepages can't be swapped
+    /// out anyway, so this is mostly useful for buffers that are not hugepage-backed. The pages are unlocked when the
+    /// file is unmapped.
+    void lock();
+
   private:
     void map(const std::string& fileName, size_t fileSize);
 
@@ -0,0 +1,54 @@
+/// \file PageChecksum.h
+/// \brief Definition of the PageChecksum class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_PAGECHECKSUM_H_
+#define ALICEO2_INCLUDE_READOUTCARD_PAGECHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AliceO2 {
+namespace roc {
+
+/// CRC32C (Castagnoli) checksums of DMA pages, for integrity checks of data long after it was read out.
+///
+/// The readout computes a checksum per DMA page with computePages(), or LinkIntegrityMonitor::checkSuperpage() while it
+/// checks the pages, into an array the user keeps with the superpage, for example in its SuperpageContexts slot.
+/// Later stages check the data against it with findMismatch() instead of checking the data itself again.
+/// The SSE4.2 crc32 instruction is used on three interleaved streams if the CPU supports it, which is detected once at
+/// runtime, and a table-driven loop otherwise.
+class PageChecksum
+{
+  public:
+    /// Computes the CRC32C of the data
+    /// \param data Start of the data
+    /// \param size Amount of bytes
+    /// \param crc Checksum of the preceding data, to checksum data in pieces. 0 to start a new checksum.
+    static uint32_t compute(const void* data, size_t size, uint32_t crc = 0);
+
+    /// Computes the checksum of every complete page of a superpage
+    /// \param address Start of the superpage
+    /// \param received Amount of bytes received in the superpage
+    /// \param pageSize Size of the DMA pages
+    /// \param checksums Array to put the checksums in, with an entry for every complete page
+    /// \return The amount of checksums put in the array
+    static size_t computePages(const void* address, size_t received, size_t pageSize, uint32_t* checksums);
+
+    /// Finds the first complete page of a superpage that does not match its checksum
+    /// \param address Start of the superpage
+    /// \param received Amount of bytes received in the superpage
+    /// \param pageSize Size of the DMA pages
+    /// \param checksums Checksums from computePages()
+    /// \return Index of the first mismatching page, or the amount of complete pages if all match
+    static size_t findMismatch(const void* address, size_t received, size_t pageSize, const uint32_t* checksums);
+
+    /// Gets the name of the implementation compute() uses on this CPU: "sse4.2" or "scalar"
+    static const char* getImplementation();
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_PAGECHECKSUM_H_
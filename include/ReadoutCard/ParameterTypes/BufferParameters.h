@@ -26,6 +26,14 @@ struct File
     size_t size; ///< Size of shared memory file
 };
 
+/// Buffer parameters for user-provided DMA buffer passed by file descriptor, such as the one of a HugepageMemfd, or
+/// one received from another process
+struct FileDescriptor
+{
+    int fileDescriptor; ///< File descriptor of the memory to be memory-mapped. It is not closed by the channel.
+    size_t size; ///< Size of the memory
+};
+
 /// Buffer parameters to instantiate DmaChannel without data transfer, e.g. for testing purposes.
 struct Null
 {
@@ -0,0 +1,34 @@
+/// \file LinkScheduling.h
+/// \brief Definition of the LinkScheduling enum and supporting functions.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_LINKSCHEDULING_H_
+#define ALICEO2_INCLUDE_READOUTCARD_LINKSCHEDULING_H_
+
+#include <string>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Namespace for the link scheduling policy enum, and supporting functions
+struct LinkScheduling
+{
+    /// Policy for distributing pushed superpages over the links of a channel
+    enum type
+    {
+      ShortestQueue, ///< Push to the link with the fewest queued superpages
+      Throughput, ///< Keep the amount of queued superpages per link proportional to the link's observed throughput
+    };
+
+    /// Converts a LinkScheduling to a string
+    static std::string toString(const LinkScheduling::type& scheduling);
+
+    /// Converts a string to a LinkScheduling
+    static LinkScheduling::type fromString(const std::string& string);
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_LINKSCHEDULING_H_
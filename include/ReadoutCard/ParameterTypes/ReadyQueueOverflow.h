@@ -0,0 +1,35 @@
+/// \file ReadyQueueOverflow.h
+/// \brief Definition of the ReadyQueueOverflow enum and supporting functions.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_READYQUEUEOVERFLOW_H_
+#define ALICEO2_INCLUDE_READOUTCARD_READYQUEUEOVERFLOW_H_
+
+#include <string>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Namespace for the ready queue overflow policy enum, and supporting functions
+struct ReadyQueueOverflow
+{
+    /// Policy for superpages that arrive while the ready queue is full
+    enum type
+    {
+      Block, ///< Leave them on the card until the user pops superpages, which holds back the links
+      Grow, ///< Double the capacity of the ready queue
+      DropOldest, ///< Give the oldest superpage of the ready queue back to the card without handing it to the user
+    };
+
+    /// Converts a ReadyQueueOverflow to a string
+    static std::string toString(const ReadyQueueOverflow::type& overflow);
+
+    /// Converts a string to a ReadyQueueOverflow
+    static ReadyQueueOverflow::type fromString(const std::string& string);
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_READYQUEUEOVERFLOW_H_
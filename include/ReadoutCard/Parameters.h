@@ -6,6 +6,7 @@
 #ifndef ALICEO2_INCLUDE_READOUTCARD_PARAMETERS_H_
 #define ALICEO2_INCLUDE_READOUTCARD_PARAMETERS_H_
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <set>
@@ -14,9 +15,11 @@
 #include <boost/variant.hpp>
 #include "ReadoutCard/ParameterTypes/BufferParameters.h"
 #include "ReadoutCard/ParameterTypes/GeneratorPattern.h"
+#include "ReadoutCard/ParameterTypes/LinkScheduling.h"
 #include "ReadoutCard/ParameterTypes/LoopbackMode.h"
 #include "ReadoutCard/ParameterTypes/PciAddress.h"
 #include "ReadoutCard/ParameterTypes/ReadoutMode.h"
+#include "ReadoutCard/ParameterTypes/ReadyQueueOverflow.h"
 
 namespace AliceO2 {
 namespace roc {
@@ -44,7 +47,7 @@ class Parameters
 
     /// Type for buffer parameters. It can hold Memory, File or Null buffer parameters.
     using BufferParametersType = boost::variant<buffer_parameters::Memory, buffer_parameters::File,
-        buffer_parameters::Null>;
+        buffer_parameters::Null, buffer_parameters::FileDescriptor>;
 
     /// Type for the CardId parameter. It can hold either a serial number or PciAddress.
     using CardIdType = boost::variant<int, ::AliceO2::roc::PciAddress>;
@@ -77,6 +80,96 @@ class Parameters
     using LinkMaskType = std::set<uint32_t>;
 
 
+    /// Type for the driver thread enabled parameter
+    using DriverThreadEnabledType = bool;
+
+    /// Type for the driver thread CPU parameter
+    using DriverThreadCpuType = int32_t;
+
+    /// Type for the DriverThreadCacheGroup parameter
+    using DriverThreadCacheGroupType = std::string;
+
+    /// Type for the wait spin time parameter
+    using WaitSpinTimeType = std::chrono::nanoseconds;
+
+    /// Type for the InterruptEnabled parameter
+    using InterruptEnabledType = bool;
+
+    /// Type for the StatusPageEnabled parameter
+    using StatusPageEnabledType = bool;
+
+    /// Type for the LinkScheduling parameter
+    using LinkSchedulingType = LinkScheduling::type;
+
+    /// Type for the WarmRestartEnabled parameter
+    using WarmRestartEnabledType = bool;
+
+    /// Type for the WriteCombiningEnabled parameter
+    using WriteCombiningEnabledType = bool;
+
+    /// Type for the FirmwareCapabilitiesEnabled parameter
+    using FirmwareCapabilitiesEnabledType = bool;
+
+    /// Type for the RegisterShadowingEnabled parameter
+    using RegisterShadowingEnabledType = bool;
+
+    /// Type for the SdhEventSizeEnabled parameter
+    using SdhEventSizeEnabledType = bool;
+
+    /// Type for the ReadyFifoInBuffer parameter
+    using ReadyFifoInBufferType = bool;
+
+    /// Type for the SuperpageQueueCapacity parameter
+    using SuperpageQueueCapacityType = size_t;
+
+    /// Type for the BufferRegistrationRetained parameter
+    using BufferRegistrationRetainedType = bool;
+
+    /// Type for the BufferDumpExcluded parameter
+    using BufferDumpExcludedType = bool;
+
+    /// Type for the ReplayFile parameter
+    using ReplayFileType = std::string;
+
+    /// Type for the ReplayRate parameter
+    using ReplayRateType = size_t;
+
+    /// Type for the DummyLinkBandwidth parameter
+    using DummyLinkBandwidthType = size_t;
+
+    /// Type for the SuperpageFlushTimeout parameter
+    using SuperpageFlushTimeoutType = std::chrono::nanoseconds;
+
+    /// Type for the PackedPacketsEnabled parameter
+    using PackedPacketsEnabledType = bool;
+
+    /// Type for the AsyncLoggingEnabled parameter
+    using AsyncLoggingEnabledType = bool;
+
+    /// Type for the StatisticsPublishingEnabled parameter
+    using StatisticsPublishingEnabledType = bool;
+
+    /// Type for the DummyBarReadLatency parameter
+    using DummyBarReadLatencyType = std::chrono::nanoseconds;
+
+    /// Type for the DummyBarWriteLatency parameter
+    using DummyBarWriteLatencyType = std::chrono::nanoseconds;
+
+    /// Type for the ReadyQueueCapacity parameter
+    using ReadyQueueCapacityType = size_t;
+
+    /// Type for the ReadyQueueOverflow parameter
+    using ReadyQueueOverflowType = ReadyQueueOverflow::type;
+
+    /// Type for the SynchronizedStartChannels parameter
+    using SynchronizedStartChannelsType = std::set<uint32_t>;
+
+    /// Type for the MonitorRegisters parameter
+    using MonitorRegistersType = std::set<uint32_t>;
+
+    /// Type for the MonitorBudget parameter
+    using MonitorBudgetType = size_t;
+
     // Setters
 
     /// Sets the CardId parameter
@@ -105,13 +198,18 @@ class Parameters
     /// Sets the DmaPageSize parameter
     ///
     /// Supported values:
-    /// * C-RORC: ??? (it seems to be very flexible)
-    /// * CRU: 8 KiB
+    /// * C-RORC: powers of two of at least 2 KiB. Superpages must then be a multiple of 128 pages. Small pages suit small
+    ///   events, so memory and bandwidth aren't wasted on mostly empty pages.
+    /// * CRU: 8 KiB, or powers of two up to the largest page size the firmware reports in its capabilities (see
+    ///   FirmwareCapabilitiesEnabled). Superpages must then be a multiple of the page size. 0 selects the largest page
+    ///   size the firmware supports.
     ///
-    /// If not set, the card's driver will select a sensible default
+    /// If not set, the card's driver will select a sensible default. For the C-RORC, that's the smallest page that
+    /// fits the GeneratorDataSize if given, or 8 KiB. For the CRU, it's 8 KiB, since larger pages change the layout of
+    /// the data for its readers. DmaChannelInterface::getDmaPageSize() gives the page size chosen.
     ///
     /// NOTE: Will probably be removed. In which case for the C-RORC this will be set per superpage to the superpage
-    ///   size. For the CRU, it is non-configurable anyway.
+    ///   size.
     ///
     /// \param value The value to set
     /// \return Reference to this object for chaining calls
@@ -187,7 +285,8 @@ class Parameters
     /// physically contiguous.
     ///
     /// It is recommended to use hugepages for the buffer to increase contiguousness, for example by opening a
-    /// MemoryMappedFile in a hugetlbfs filesystem.
+    /// MemoryMappedFile in a hugetlbfs filesystem, or a HugepageMemfd, which needs no hugetlbfs mounts and is passed with
+    /// BufferParameters::FileDescriptor.
     /// See the README.md file for more information about hugepages.
     ///
     /// There is also a BufferParameters::Null option, which can be used to instantiate the DmaChannel without
@@ -223,6 +322,357 @@ class Parameters
     auto setLinkMask(LinkMaskType value) -> Parameters&;
 
 
+    /// Sets the DriverThreadEnabled parameter
+    ///
+    /// If enabled, the DMA channel starts an internal driver thread on startDma(). This thread takes care of pushing
+    /// superpages to the card and checking for arrivals, so the user no longer has to call fillSuperpages() in a loop.
+    /// Superpages are passed between the user and the driver thread through lock-free queues. Note that the channel is
+    /// then meant to be used by a single user thread.
+    ///
+    /// If not set, the driver thread is disabled.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setDriverThreadEnabled(DriverThreadEnabledType value) -> Parameters&;
+
+    /// Sets the DriverThreadCpu parameter
+    ///
+    /// The CPU the internal driver thread is pinned to (see setDriverThreadEnabled()).
+    /// If not set, the thread is pinned to the CPUs local to the card's NUMA node.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setDriverThreadCpu(DriverThreadCpuType value) -> Parameters&;
+
+    /// Sets the DriverThreadCacheGroup parameter
+    ///
+    /// The resctrl group the internal driver thread is moved into (see setDriverThreadEnabled()), for example one made
+    /// with a CacheAllocation to give the thread its own part of the last-level cache.
+    /// If not set, the thread stays in the group of the process.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setDriverThreadCacheGroup(DriverThreadCacheGroupType value) -> Parameters&;
+
+    /// Sets the WaitSpinTime parameter
+    ///
+    /// Controls how long waitForReadySuperpage() busy-polls the card before it backs off to sleeping.
+    /// A longer spin time gives lower latency when data is flowing, at the cost of CPU time.
+    ///
+    /// If not set, the driver will default to 20 microseconds.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setWaitSpinTime(WaitSpinTimeType value) -> Parameters&;
+
+    /// Sets the InterruptEnabled parameter
+    ///
+    /// If enabled, the card's MSI/MSI-X interrupt is used to find out when superpages arrived, so fillSuperpages() only
+    /// checks the card for arrivals after an interrupt (or after a fallback interval, in case an interrupt is missed).
+    /// The interrupt descriptor is available through DmaChannelInterface::getReadyFileDescriptor().
+    /// Supported by the CRU and C-RORC. If not set, the default is false, except on CRU firmware that reports interrupt
+    /// support in its capabilities, see FirmwareCapabilitiesEnabled.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setInterruptEnabled(InterruptEnabledType value) -> Parameters&;
+
+    /// Sets the StatusPageEnabled parameter
+    ///
+    /// If enabled, the CRU writes its per-link superpage completion counters into a status page in host memory, and the
+    /// driver polls that page instead of reading the counters from the BAR. Requires firmware support, and since the
+    /// registers for it are not in the firmware register map yet, the firmware must report it in its capabilities;
+    /// otherwise the counters are read from the BAR, with a warning.
+    /// If not set, the default is true if the firmware reports status page support in its capabilities (see
+    /// FirmwareCapabilitiesEnabled), else false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setStatusPageEnabled(StatusPageEnabledType value) -> Parameters&;
+
+    /// Sets the LinkScheduling parameter
+    ///
+    /// Policy for distributing pushed superpages over the links of the channel. Only used by the CRU.
+    /// If not set, the default is LinkScheduling::ShortestQueue.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setLinkScheduling(LinkSchedulingType value) -> Parameters&;
+
+    /// Sets the WarmRestartEnabled parameter
+    ///
+    /// If enabled, startDma() skips the full card reset when DMA was stopped cleanly before, and only re-arms the DMA
+    /// engine. For the CRU, a stop is clean if all pushed superpages had arrived; otherwise the firmware may still hold
+    /// descriptors, and the card is reset anyway. For the C-RORC, the reset according to the ResetLevel parameter and the
+    /// DIU version detection are only done on the first start.
+    /// If not set, the default is false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setWarmRestartEnabled(WarmRestartEnabledType value) -> Parameters&;
+
+    /// Sets the WriteCombiningEnabled parameter
+    ///
+    /// If enabled, the CRU maps its superpage descriptor registers a second time with write-combining, so the two
+    /// 32-bit address writes of a descriptor can be posted to the card as a single PCIe write. The size write, which
+    /// signals the push, is fenced after them. This needs the BAR to be prefetchable, so the kernel offers a
+    /// resource0_wc file for it. If it's not available, the regular mapping is used.
+    /// If not set, the default is true if the firmware reports descriptor burst support in its capabilities (see
+    /// FirmwareCapabilitiesEnabled), else false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setWriteCombiningEnabled(WriteCombiningEnabledType value) -> Parameters&;
+
+    /// Sets the FirmwareCapabilitiesEnabled parameter
+    ///
+    /// If enabled, the CRU reads the performance capabilities of the firmware from its FIRMWARE_CAPABILITIES register.
+    /// They are the defaults of the StatusPageEnabled, InterruptEnabled and WriteCombiningEnabled parameters, and give
+    /// the largest DmaPageSize, which is set through the DMA_PAGE_SIZE_SELECT register. These registers are not in the
+    /// firmware register map yet, so this should only be enabled with firmware known to have them.
+    /// If not set, the default is false, and the firmware is taken to support none of the capabilities.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setFirmwareCapabilitiesEnabled(FirmwareCapabilitiesEnabledType value) -> Parameters&;
+
+    /// Sets the RegisterShadowingEnabled parameter
+    ///
+    /// If enabled, the CRU keeps a copy of the control registers it read-modify-writes, such as the data generator
+    /// control, so configuring them is write-only instead of costing a PCIe read each. The copies are dropped when the
+    /// card is reset. Only use it when no other process writes these registers while the BAR is open.
+    /// If not set, the default is false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setRegisterShadowingEnabled(RegisterShadowingEnabledType value) -> Parameters&;
+
+    /// Sets the SdhEventSizeEnabled parameter
+    ///
+    /// If enabled, the C-RORC backend writes the length of every arrived DMA page into the event size word of the page's
+    /// SDH. This means the driver writes into every page of received data. When disabled, consumers can get the page lengths
+    /// out-of-band through Superpage::setPageLengths() instead.
+    /// If not set, the default is true.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setSdhEventSizeEnabled(SdhEventSizeEnabledType value) -> Parameters&;
+
+    /// Sets the ReadyFifoInBuffer parameter
+    ///
+    /// If enabled, the C-RORC backend places its ReadyFIFO in the last 4 KiB of the channel's DMA buffer, instead of in a
+    /// separate file with its own PDA registration. The FIFO the CPU polls is then in the same (hugepage, NUMA-local) memory
+    /// as the data. Superpages must not overlap these last 4 KiB.
+    /// If not set, the default is false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setReadyFifoInBuffer(ReadyFifoInBufferType value) -> Parameters&;
+
+    /// Sets the SuperpageQueueCapacity parameter
+    ///
+    /// The maximum amount of superpages the C-RORC backend keeps in its transfer and ready queues, which is what
+    /// getTransferQueueAvailable() reports on an empty channel. With small superpages, a larger queue covers longer gaps
+    /// in the user's polling. The queue is allocated once, when the channel is created.
+    /// If not set, the default is 32.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setSuperpageQueueCapacity(SuperpageQueueCapacityType value) -> Parameters&;
+
+    /// Sets the BufferRegistrationRetained parameter
+    ///
+    /// If enabled, the PDA registration of a buffer_parameters::Memory buffer is kept when the channel is closed, and reused
+    /// when a channel is opened again with the same card, channel and memory range. Registering pins every page of the
+    /// buffer, which takes seconds for a buffer of several GiB, so this makes restarting a run nearly instant.
+    /// The pages stay pinned until ChannelFactory::releaseBufferRegistrations() is called, which must be done before the
+    /// memory is unmapped. Buffers from a HugepagePool are always retained, and released by the pool.
+    /// If not set, the default is false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setBufferRegistrationRetained(BufferRegistrationRetainedType value) -> Parameters&;
+
+    /// Sets the BufferDumpExcluded parameter
+    ///
+    /// If enabled, the channel's DMA buffers are excluded from core dumps and from child processes with madvise()
+    /// MADV_DONTDUMP and MADV_DONTFORK. Otherwise a crashing readout process dumps its buffer of several GiB, which
+    /// stalls the node for minutes before the process can be restarted, and a forked helper process would share the
+    /// mapping, or have it copied, which also breaks the pinning of retained registrations (see
+    /// setBufferRegistrationRetained()). The advice applies to the whole mapping of the memory range, for every user of
+    /// it, and is not undone when the channel closes. A child process must not access the buffer.
+    /// If not set, the default is true.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setBufferDumpExcluded(BufferDumpExcludedType value) -> Parameters&;
+
+    /// Sets the ReplayFile parameter
+    ///
+    /// Makes the dummy card serve the data of a file recorded with `roc-bench-dma --to-file-bin`: the file is memory mapped
+    /// and, when a superpage arrives, the next part of the file is copied into it. At the end of the file it starts over.
+    /// With the DummyLinkBandwidth parameter, the file must be a stream of CRU packets, and every simulated link
+    /// replays the packets of the file with its link ID instead.
+    /// Only used by the dummy card.
+    /// If not set, the dummy card does not write any data.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setReplayFile(ReplayFileType value) -> Parameters&;
+
+    /// Sets the ReplayRate parameter
+    ///
+    /// Rate in bytes per second at which the dummy card completes superpages. Only used by the dummy card.
+    /// If not set, superpages complete as fast as fillSuperpages() is called.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setReplayRate(ReplayRateType value) -> Parameters&;
+
+    /// Sets the DummyLinkBandwidth parameter
+    ///
+    /// Puts the dummy card in simulated-card mode, where every link of the LinkMask parameter has a queue of
+    /// Cru::MAX_SUPERPAGE_DESCRIPTORS superpages, and a background thread completes them at this rate in bytes per second
+    /// per link. Unless the generator is disabled or a ReplayFile is given, the pages are filled with the CRU's RDH and DDG
+    /// pattern. The channel then reports CardType::Simulated. Only used by the dummy card.
+    /// If not set, superpages are completed by fillSuperpages(), as fast as it is called or at the ReplayRate.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setDummyLinkBandwidth(DummyLinkBandwidthType value) -> Parameters&;
+
+    /// Sets the SuperpageFlushTimeout parameter
+    ///
+    /// If a superpage that received data gets no new pages for this long, the received part is split off and handed
+    /// to the ready queue as a superpage of its own, with the same user data, marked by Superpage::isSplit(). It does
+    /// not free a slot of the transfer queue. The rest stays in the transfer queue, and arrives later as a superpage
+    /// with the offset and size of the remainder; the pushed superpage is complete, and its slot free again, when the
+    /// piece that ends at its end arrives. This bounds the latency of low-rate links without shrinking the
+    /// superpages. Since the idle time is measured between fillSuperpages() calls, the flush may come later than the
+    /// timeout if the calls are far apart.
+    /// Supported by the C-RORC, and by the CRU with the StatusPageEnabled parameter. If not set, superpages are only
+    /// handed over when they are filled, or by stopDma().
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setSuperpageFlushTimeout(SuperpageFlushTimeoutType value) -> Parameters&;
+
+    /// Sets the PackedPacketsEnabled parameter
+    ///
+    /// If enabled, the packets of a link are packed back to back in the superpages, instead of starting a DMA page
+    /// each, and the offset to the next packet of every RDH points to the next packet. Readers must then step through
+    /// the superpages by those offsets, see LinkIntegrityMonitor. With small events, this saves most of the DMA and
+    /// memory bandwidth that one packet per page wastes.
+    /// Only used by the dummy card in simulated-card mode (see DummyLinkBandwidth); the CRU's packing is set by its
+    /// firmware.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setPackedPacketsEnabled(PackedPacketsEnabledType value) -> Parameters&;
+
+    /// Sets the AsyncLoggingEnabled parameter
+    ///
+    /// If enabled, the channel's log messages are put in a lock-free ring and written to InfoLogger by a background
+    /// thread, so the thread driving the DMA never waits for the logging I/O. A message that finds the ring full is
+    /// dropped and counted, and the amount dropped is logged later. Messages may appear up to a few milliseconds late.
+    /// Default is false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setAsyncLoggingEnabled(AsyncLoggingEnabledType value) -> Parameters&;
+
+    /// Sets the StatisticsPublishingEnabled parameter
+    ///
+    /// If enabled, the channel keeps its statistics (see DmaChannelInterface::getStatistics()) in a ChannelStatisticsTable
+    /// in /dev/shm, which monitoring agents can read at any rate without touching the card or the readout process. The
+    /// updates cost the thread driving the DMA two extra stores each, readers never make it wait.
+    /// Default is false.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setStatisticsPublishingEnabled(StatisticsPublishingEnabledType value) -> Parameters&;
+
+    /// Sets the DummyBarReadLatency parameter
+    ///
+    /// Time a register read of the dummy BAR takes, to emulate the round trip to a card. A block read takes it once.
+    /// The dummy BAR keeps the values written to it, and emulates the SCA and SWT cores, see DummyRegisterModel.
+    /// Only used by the dummy card. Default is no latency.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setDummyBarReadLatency(DummyBarReadLatencyType value) -> Parameters&;
+
+    /// Sets the DummyBarWriteLatency parameter
+    ///
+    /// Time a register write of the dummy BAR takes, to emulate the cost of issuing a posted write. A block write takes
+    /// it once. Only used by the dummy card. Default is no latency.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setDummyBarWriteLatency(DummyBarWriteLatencyType value) -> Parameters&;
+
+    /// Sets the ReadyQueueCapacity parameter
+    ///
+    /// The maximum amount of superpages the CRU backend keeps in its ready queue, waiting to be popped. It bounds the
+    /// superpages that can arrive between the user's pops; what happens to superpages arriving beyond it is set by the
+    /// ReadyQueueOverflow parameter. The queue is allocated once, when the channel is created. stopDma() grows it if the
+    /// superpages left on the links don't fit, so that none are lost.
+    /// If not set, the default is the capacity of all link queues together, 128 superpages per link for 32 links.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setReadyQueueCapacity(ReadyQueueCapacityType value) -> Parameters&;
+
+    /// Sets the ReadyQueueOverflow parameter
+    ///
+    /// Policy for superpages that arrive while the ready queue is full. Only used by the CRU.
+    /// * Block leaves them on the card, so the links stall once their superpages are used up. Every time it happens,
+    ///   the readyQueueFull and superpagesLeftOnCard statistics are counted and a rate-limited warning is logged.
+    /// * Grow doubles the ready queue, which allocates while DMA runs. Use it when latency matters more than memory.
+    /// * DropOldest gives the oldest superpage of the ready queue back to the card to be filled again, so its data is
+    ///   lost to the user and counted in the superpagesDropped statistic. The superpages keep flowing, with the
+    ///   newest data. Pieces of superpages flushed after the SuperpageFlushTimeout are skipped and always handed to
+    ///   the user, since only the whole superpage can go back to the card.
+    ///
+    /// If not set, the default is ReadyQueueOverflow::Block.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setReadyQueueOverflow(ReadyQueueOverflowType value) -> Parameters&;
+
+    /// Sets the SynchronizedStartChannels parameter
+    ///
+    /// Channels of a C-RORC whose continuous readout starts together. The card is configured for continuous readout
+    /// once, every channel arms itself when its first superpage is pushed, and the last one to be armed opens the
+    /// readout gate of the card for all of them, so their data is aligned from the first page. All channels of the set
+    /// must be opened with the same set, in the same process, and the channel's own number must be in it. Only used by
+    /// the C-RORC with ReadoutMode::Continuous. If not set, every channel starts its readout on its own.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setSynchronizedStartChannels(SynchronizedStartChannelsType value) -> Parameters&;
+
+    /// Sets the MonitorRegisters parameter
+    ///
+    /// Indexes of the registers that a monitor BAR may read, besides the status registers it allows by default. Only
+    /// used by ChannelFactory::getMonitorBar(). Only add registers whose reads have no side effects.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setMonitorRegisters(MonitorRegistersType value) -> Parameters&;
+
+    /// Sets the MonitorBudget parameter
+    ///
+    /// PCIe budget in bytes per second of the monitor BARs of a card, shared by all processes that monitor it. A
+    /// register read is counted as 52 bytes, the approximate size of its request and completion on the link. Monitors
+    /// of the same card should use the same budget. Only used by ChannelFactory::getMonitorBar().
+    ///
+    /// If not set, the default is 256 KiB/s, about 5000 register reads per second.
+    ///
+    /// \param value The value to set
+    /// \return Reference to this object for chaining calls
+    auto setMonitorBudget(MonitorBudgetType value) -> Parameters&;
+
     // Non-throwing getters
 
     /// Gets the CardId parameter
@@ -270,6 +720,126 @@ class Parameters
     auto getLinkMask() const -> boost::optional<LinkMaskType>;
 
 
+    /// Gets the DriverThreadEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getDriverThreadEnabled() const -> boost::optional<DriverThreadEnabledType>;
+
+    /// Gets the DriverThreadCpu parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getDriverThreadCpu() const -> boost::optional<DriverThreadCpuType>;
+
+    /// Gets the DriverThreadCacheGroup parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getDriverThreadCacheGroup() const -> boost::optional<DriverThreadCacheGroupType>;
+
+    /// Gets the WaitSpinTime parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getWaitSpinTime() const -> boost::optional<WaitSpinTimeType>;
+
+    /// Gets the InterruptEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getInterruptEnabled() const -> boost::optional<InterruptEnabledType>;
+
+    /// Gets the StatusPageEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getStatusPageEnabled() const -> boost::optional<StatusPageEnabledType>;
+
+    /// Gets the LinkScheduling parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getLinkScheduling() const -> boost::optional<LinkSchedulingType>;
+
+    /// Gets the WarmRestartEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getWarmRestartEnabled() const -> boost::optional<WarmRestartEnabledType>;
+
+    /// Gets the WriteCombiningEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getWriteCombiningEnabled() const -> boost::optional<WriteCombiningEnabledType>;
+
+    /// Gets the FirmwareCapabilitiesEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getFirmwareCapabilitiesEnabled() const -> boost::optional<FirmwareCapabilitiesEnabledType>;
+
+    /// Gets the RegisterShadowingEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getRegisterShadowingEnabled() const -> boost::optional<RegisterShadowingEnabledType>;
+
+    /// Gets the SdhEventSizeEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getSdhEventSizeEnabled() const -> boost::optional<SdhEventSizeEnabledType>;
+
+    /// Gets the ReadyFifoInBuffer parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getReadyFifoInBuffer() const -> boost::optional<ReadyFifoInBufferType>;
+
+    /// Gets the SuperpageQueueCapacity parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getSuperpageQueueCapacity() const -> boost::optional<SuperpageQueueCapacityType>;
+
+    /// Gets the BufferRegistrationRetained parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getBufferRegistrationRetained() const -> boost::optional<BufferRegistrationRetainedType>;
+
+    /// Gets the BufferDumpExcluded parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getBufferDumpExcluded() const -> boost::optional<BufferDumpExcludedType>;
+
+    /// Gets the ReplayFile parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getReplayFile() const -> boost::optional<ReplayFileType>;
+
+    /// Gets the ReplayRate parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getReplayRate() const -> boost::optional<ReplayRateType>;
+
+    /// Gets the DummyLinkBandwidth parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getDummyLinkBandwidth() const -> boost::optional<DummyLinkBandwidthType>;
+
+    /// Gets the SuperpageFlushTimeout parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getSuperpageFlushTimeout() const -> boost::optional<SuperpageFlushTimeoutType>;
+
+    /// Gets the PackedPacketsEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getPackedPacketsEnabled() const -> boost::optional<PackedPacketsEnabledType>;
+
+    /// Gets the AsyncLoggingEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getAsyncLoggingEnabled() const -> boost::optional<AsyncLoggingEnabledType>;
+
+    /// Gets the StatisticsPublishingEnabled parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getStatisticsPublishingEnabled() const -> boost::optional<StatisticsPublishingEnabledType>;
+
+    /// Gets the DummyBarReadLatency parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getDummyBarReadLatency() const -> boost::optional<DummyBarReadLatencyType>;
+
+    /// Gets the DummyBarWriteLatency parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getDummyBarWriteLatency() const -> boost::optional<DummyBarWriteLatencyType>;
+
+    /// Gets the ReadyQueueCapacity parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getReadyQueueCapacity() const -> boost::optional<ReadyQueueCapacityType>;
+
+    /// Gets the ReadyQueueOverflow parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getReadyQueueOverflow() const -> boost::optional<ReadyQueueOverflowType>;
+
+    /// Gets the SynchronizedStartChannels parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getSynchronizedStartChannels() const -> boost::optional<SynchronizedStartChannelsType>;
+
+    /// Gets the MonitorRegisters parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getMonitorRegisters() const -> boost::optional<MonitorRegistersType>;
+
+    /// Gets the MonitorBudget parameter
+    /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+    auto getMonitorBudget() const -> boost::optional<MonitorBudgetType>;
+
     // Throwing getters
 
     /// Gets the CardId parameter
@@ -328,6 +898,156 @@ class Parameters
     auto getLinkMaskRequired() const -> LinkMaskType;
 
 
+    /// Gets the DriverThreadEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getDriverThreadEnabledRequired() const -> DriverThreadEnabledType;
+
+    /// Gets the DriverThreadCpu parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getDriverThreadCpuRequired() const -> DriverThreadCpuType;
+
+    /// Gets the DriverThreadCacheGroup parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getDriverThreadCacheGroupRequired() const -> DriverThreadCacheGroupType;
+
+    /// Gets the WaitSpinTime parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getWaitSpinTimeRequired() const -> WaitSpinTimeType;
+
+    /// Gets the InterruptEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getInterruptEnabledRequired() const -> InterruptEnabledType;
+
+    /// Gets the StatusPageEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getStatusPageEnabledRequired() const -> StatusPageEnabledType;
+
+    /// Gets the LinkScheduling parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getLinkSchedulingRequired() const -> LinkSchedulingType;
+
+    /// Gets the WarmRestartEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getWarmRestartEnabledRequired() const -> WarmRestartEnabledType;
+
+    /// Gets the WriteCombiningEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getWriteCombiningEnabledRequired() const -> WriteCombiningEnabledType;
+
+    /// Gets the FirmwareCapabilitiesEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getFirmwareCapabilitiesEnabledRequired() const -> FirmwareCapabilitiesEnabledType;
+
+    /// Gets the RegisterShadowingEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getRegisterShadowingEnabledRequired() const -> RegisterShadowingEnabledType;
+
+    /// Gets the SdhEventSizeEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getSdhEventSizeEnabledRequired() const -> SdhEventSizeEnabledType;
+
+    /// Gets the ReadyFifoInBuffer parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getReadyFifoInBufferRequired() const -> ReadyFifoInBufferType;
+
+    /// Gets the SuperpageQueueCapacity parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getSuperpageQueueCapacityRequired() const -> SuperpageQueueCapacityType;
+
+    /// Gets the BufferRegistrationRetained parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getBufferRegistrationRetainedRequired() const -> BufferRegistrationRetainedType;
+
+    /// Gets the BufferDumpExcluded parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getBufferDumpExcludedRequired() const -> BufferDumpExcludedType;
+
+    /// Gets the ReplayFile parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getReplayFileRequired() const -> ReplayFileType;
+
+    /// Gets the ReplayRate parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getReplayRateRequired() const -> ReplayRateType;
+
+    /// Gets the DummyLinkBandwidth parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getDummyLinkBandwidthRequired() const -> DummyLinkBandwidthType;
+
+    /// Gets the SuperpageFlushTimeout parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getSuperpageFlushTimeoutRequired() const -> SuperpageFlushTimeoutType;
+
+    /// Gets the PackedPacketsEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getPackedPacketsEnabledRequired() const -> PackedPacketsEnabledType;
+
+    /// Gets the AsyncLoggingEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getAsyncLoggingEnabledRequired() const -> AsyncLoggingEnabledType;
+
+    /// Gets the StatisticsPublishingEnabled parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getStatisticsPublishingEnabledRequired() const -> StatisticsPublishingEnabledType;
+
+    /// Gets the DummyBarReadLatency parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getDummyBarReadLatencyRequired() const -> DummyBarReadLatencyType;
+
+    /// Gets the DummyBarWriteLatency parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getDummyBarWriteLatencyRequired() const -> DummyBarWriteLatencyType;
+
+    /// Gets the ReadyQueueCapacity parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getReadyQueueCapacityRequired() const -> ReadyQueueCapacityType;
+
+    /// Gets the ReadyQueueOverflow parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getReadyQueueOverflowRequired() const -> ReadyQueueOverflowType;
+
+    /// Gets the SynchronizedStartChannels parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getSynchronizedStartChannelsRequired() const -> SynchronizedStartChannelsType;
+
+    /// Gets the MonitorRegisters parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getMonitorRegistersRequired() const -> MonitorRegistersType;
+
+    /// Gets the MonitorBudget parameter
+    /// \exception ParameterException The parameter was not present
+    /// \return The value
+    auto getMonitorBudgetRequired() const -> MonitorBudgetType;
+
     // Helper functions
 
     /// Convenience function to make a Parameters object with card ID and channel number, since these are the most
@@ -0,0 +1,72 @@
+/// \file RdmaBufferRegistration.h
+/// \brief Definition of the RdmaBufferRegistration class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_RDMABUFFERREGISTRATION_H_
+#define ALICEO2_INCLUDE_READOUTCARD_RDMABUFFERREGISTRATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include "ReadoutCard/Superpage.h"
+
+struct ibv_pd;
+struct ibv_mr;
+
+namespace AliceO2 {
+namespace roc {
+
+/// Registers the DMA buffers of a channel with an ibverbs protection domain, so superpages can be RDMA-written straight
+/// from the memory the card wrote them to, instead of being copied into separately registered memory first.
+///
+/// The buffers are registered under the IDs the channel uses for them: 0 for the buffer given by the channel's
+/// parameters, and the IDs returned by DmaChannelInterface::addBuffer() for the others. The keys and address of a
+/// superpage are then looked up through its Superpage::getBufferId().
+/// The memory of a buffer must stay mapped as long as it is registered, and the registration must be dropped before
+/// the protection domain is deallocated.
+///
+/// Only available when the library is built with ibverbs (ALICEO2_READOUTCARD_IBVERBS_ENABLED).
+class RdmaBufferRegistration
+{
+  public:
+    /// \param protectionDomain Protection domain to register the buffers with. It is not owned by this object.
+    explicit RdmaBufferRegistration(ibv_pd* protectionDomain);
+    ~RdmaBufferRegistration();
+
+    RdmaBufferRegistration(const RdmaBufferRegistration&) = delete;
+    RdmaBufferRegistration& operator=(const RdmaBufferRegistration&) = delete;
+
+    /// Registers a buffer
+    /// \param bufferId ID the channel uses for the buffer
+    /// \param address Userspace address of the buffer, as given to the channel
+    /// \param size Size of the buffer
+    /// \param access ibv_access_flags of the registration. By default, local write and remote read and write.
+    void registerBuffer(int bufferId, void* address, size_t size, int access = -1);
+
+    /// Deregisters a buffer
+    void deregisterBuffer(int bufferId);
+
+    /// Gets the local key for work requests on the superpage
+    uint32_t getLocalKey(const Superpage& superpage) const;
+
+    /// Gets the remote key a peer uses to access the superpage
+    uint32_t getRemoteKey(const Superpage& superpage) const;
+
+    /// Gets the address of the superpage for scatter-gather elements of work requests
+    uint64_t getAddress(const Superpage& superpage) const;
+
+    /// Gets the memory region of a buffer
+    ibv_mr* getMemoryRegion(int bufferId) const;
+
+  private:
+    ibv_pd* mProtectionDomain;
+
+    /// Memory regions by buffer ID
+    std::map<int, ibv_mr*> mMemoryRegions;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_RDMABUFFERREGISTRATION_H_
@@ -6,6 +6,7 @@
 #include "ReadoutCard/BarInterface.h"
 #include "ReadoutCard/CardType.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/ChannelGroup.h"
 #include "ReadoutCard/DmaChannelInterface.h"
 #include "ReadoutCard/Exception.h"
 #include "ReadoutCard/Parameters.h"
@@ -6,6 +6,7 @@
 #ifndef ALICEO2_INCLUDE_READOUTCARD_REGISTERREADWRITEINTERFACE_H_
 #define ALICEO2_INCLUDE_READOUTCARD_REGISTERREADWRITEINTERFACE_H_
 
+#include <cstddef>
 #include <cstdint>
 
 namespace AliceO2 {
@@ -29,6 +30,44 @@ class RegisterReadWriteInterface
     /// \param value The value to be written into the register
     /// \throw May throw an UnsafeWriteAccess exception
     virtual void writeRegister(int index, uint32_t value) = 0;
+
+    /// Reads a range of consecutive BAR registers. Implementations may use wide loads and check the range once for
+    /// the whole call; the default implementation reads them one by one.
+    /// \param startIndex The index of the first register
+    /// \param values Array to store the register values, must hold at least 'count' values
+    /// \param count The amount of registers to read
+    /// \throw May throw an UnsafeReadAccess exception
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count)
+    {
+      for (size_t i = 0; i < count; ++i) {
+        values[i] = readRegister(startIndex + i);
+      }
+    }
+
+    /// Writes a range of consecutive BAR registers, in order of increasing index. The default implementation writes
+    /// them one by one.
+    /// \param startIndex The index of the first register
+    /// \param values Array of the values to write, must hold at least 'count' values
+    /// \param count The amount of registers to write
+    /// \throw May throw an UnsafeWriteAccess exception
+    virtual void writeRegisters(int startIndex, const uint32_t* values, size_t count)
+    {
+      for (size_t i = 0; i < count; ++i) {
+        writeRegister(startIndex + i, values[i]);
+      }
+    }
+
+    /// Writes a range of consecutive BAR registers with stores as wide as the alignment allows, up to 128 bits, so
+    /// they go out in fewer PCIe write requests. Only for registers the firmware treats as plain memory, since the
+    /// registers of a store are written at once. The default implementation writes them one by one.
+    /// \param startIndex The index of the first register
+    /// \param values Array of the values to write, must hold at least 'count' values
+    /// \param count The amount of registers to write
+    /// \throw May throw an UnsafeWriteAccess exception
+    virtual void writeRegistersWide(int startIndex, const uint32_t* values, size_t count)
+    {
+      writeRegisters(startIndex, values, count);
+    }
 };
 
 } // namespace roc
@@ -0,0 +1,139 @@
+/// \file SharedMemoryBuffer.h
+/// \brief Definition of the SharedMemoryBuffer class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SHAREDMEMORYBUFFER_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SHAREDMEMORYBUFFER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <boost/optional.hpp>
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+#include "ReadoutCard/Superpage.h"
+#include "ReadoutCard/SuperpageRing.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// A DMA buffer that other processes can map, so they can consume the data without copying it out of the driver
+/// process. Next to the buffer, a small segment in /dev/shm holds two SuperpageRing instances:
+/// - the ready ring, through which the driver process publishes superpages that arrived
+/// - the free ring, through which the consumer process returns superpages it is done with
+///
+/// The driver process creates the buffer, opens the channel on it with getBufferParameters(), pushes the superpages
+/// it pops from the channel with pushReady(), and gives the ones it gets back from popFree() to the channel again. The
+/// consumer process attaches by name, and uses popReady() and pushFree().
+///
+/// A driver process that outlives its consumers, such as roc-channeld, lets a consumer start a session with attach(),
+/// and accepts it with acceptAttach(). The rings are then emptied, and the driver takes back the superpages the previous
+/// consumer did not return, so a consumer that crashed can be restarted without restarting the channel. One consumer
+/// is attached at a time.
+///
+/// Each side is meant to be used from one thread. The files are removed when the creating object is destroyed, mappings
+/// of attached processes stay valid until they are destroyed as well.
+class SharedMemoryBuffer
+{
+  public:
+    /// Creates a shared buffer in the hugetlbfs, see Utilities::tryMapFile()
+    /// \param name Name of the shared buffer, used by consumers to attach to it
+    /// \param bufferSize Size of the DMA buffer. Must be a multiple of 2 MiB.
+    /// \param ringCapacity Amount of superpage descriptors each ring holds. Typically the amount of superpages in the
+    ///        buffer, so the rings can't be full.
+    /// \param numaNode If given, the buffer's hugepages are allocated on this NUMA node
+    SharedMemoryBuffer(const std::string& name, size_t bufferSize, size_t ringCapacity,
+        boost::optional<int> numaNode = boost::none);
+
+    /// Creates a shared buffer backed by the given file
+    /// \param name Name of the shared buffer, used by consumers to attach to it
+    /// \param bufferPath Path of the file backing the DMA buffer
+    /// \param bufferSize Size of the DMA buffer
+    /// \param ringCapacity Amount of superpage descriptors each ring holds
+    SharedMemoryBuffer(const std::string& name, const std::string& bufferPath, size_t bufferSize, size_t ringCapacity);
+
+    /// Attaches to a shared buffer created by another process, or by another object in this one
+    /// \param name Name of the shared buffer
+    explicit SharedMemoryBuffer(const std::string& name);
+
+    ~SharedMemoryBuffer();
+
+    /// Gets the start of the buffer in this process
+    void* getAddress() const;
+
+    /// Gets the size of the buffer
+    size_t getSize() const;
+
+    /// Gets the amount of superpage descriptors each ring holds
+    size_t getRingCapacity() const;
+
+    /// Gets the buffer parameters to open a channel on the buffer with Parameters::setBufferParameters()
+    buffer_parameters::Memory getBufferParameters() const;
+
+    /// Publishes an arrived superpage to the consumer. Driver side.
+    /// The user data and page lengths pointers are not passed on, since they're only valid in this process.
+    /// \return False if the ready ring was full
+    bool pushReady(const Superpage& superpage);
+
+    /// Takes a superpage returned by the consumer. Driver side.
+    /// \return False if the free ring was empty
+    bool popFree(Superpage& superpage);
+
+    /// Takes a superpage published by the driver. Consumer side.
+    /// \return False if the ready ring was empty
+    bool popReady(Superpage& superpage);
+
+    /// Returns a superpage to the driver. Consumer side.
+    /// \return False if the free ring was full
+    bool pushFree(const Superpage& superpage);
+
+    /// Starts a new consumer session, replacing the previous consumer, which must have stopped. Consumer side.
+    /// Waits for the driver to accept the session with acceptAttach(). A request that times out may still be accepted
+    /// later, so the consumer should not use the rings then.
+    /// \param timeout Maximum time to wait for the driver
+    /// \return True if the driver accepted the session, false if the timeout expired
+    bool attach(std::chrono::milliseconds timeout);
+
+    /// Accepts the session of a consumer that called attach(), if there is one. Driver side. The rings are emptied,
+    /// so the driver must take back the superpages it published that were not returned.
+    /// \return True if a consumer attached
+    bool acceptAttach();
+
+    /// Gets the path of the segment holding the rings of the shared buffer with the given name
+    static std::string getRingPath(const std::string& name);
+
+  private:
+    struct Header;
+
+    /// Maps the ring segment and, when attaching, the buffer it refers to
+    void init(const std::string& name, size_t ringCapacity, bool create);
+
+    /// Creates the ring objects on the ring segment
+    /// \param initialize True to initialize the rings as empty
+    void mapRings(bool initialize);
+
+    /// Gets the offset of the first ring in the segment
+    static size_t getRingOffset();
+
+    /// Mapping of the DMA buffer
+    std::unique_ptr<MemoryMappedFile> mBufferFile;
+
+    /// Mapping of the segment holding the rings
+    std::unique_ptr<MemoryMappedFile> mRingFile;
+
+    /// The header at the start of the ring segment
+    Header* mHeader = nullptr;
+
+    /// Superpages published by the driver
+    std::unique_ptr<SuperpageRing> mReadyRing;
+
+    /// Superpages returned by the consumer
+    std::unique_ptr<SuperpageRing> mFreeRing;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SHAREDMEMORYBUFFER_H_
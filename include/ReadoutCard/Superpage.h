@@ -8,18 +8,21 @@
 #define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGE_H_
 
 #include <cstddef>
+#include <cstdint>
 
 namespace AliceO2 {
 namespace roc {
 
-/// Simple struct for holding basic info about a superpage
+/// Simple struct for holding basic info about a superpage.
+/// It is copied through the queues of the driver on every push and pop, so it is kept to one cache line, and the
+/// driver's queues store it aligned to cache lines.
 struct Superpage
 {
   public:
     Superpage() = default;
 
     Superpage(size_t offset, size_t size, void* userData = nullptr)
-        : mOffset(offset), mSize(size), mUserData(userData)
+        : mOffset(offset), mSize(size), mUserData(reinterpret_cast<uintptr_t>(userData))
     {
     }
 
@@ -27,7 +30,22 @@ struct Superpage
     /// superpage is filled.
     bool isReady() const
     {
-      return mReady;
+      return mFlags & FLAG_READY;
+    }
+
+    /// Returns true if the driver checked the superpage when it was pushed, and its offset, size and buffer ID were not
+    /// changed since. DmaChannelInterface::releaseSuperpage() skips the checks for such superpages.
+    bool isChecked() const
+    {
+      return mFlags & FLAG_CHECKED;
+    }
+
+    /// Returns true if the superpage is the received part the driver split off a pushed superpage after the
+    /// SuperpageFlushTimeout. The rest of the pushed superpage arrives later, and only that piece frees its slot in
+    /// the transfer queue.
+    bool isSplit() const
+    {
+      return mFlags & FLAG_SPLIT;
     }
 
     /// Returns true if the superpage is completely filled
@@ -42,6 +60,13 @@ struct Superpage
       return mOffset;
     }
 
+    /// ID of the DMA buffer the superpage lies in, see DmaChannelInterface::addBuffer(). 0 is the channel's buffer given
+    /// by its parameters.
+    uint16_t getBufferId() const
+    {
+      return mBufferId;
+    }
+
     /// Size of the superpage in bytes
     size_t getSize() const
     {
@@ -57,13 +82,66 @@ struct Superpage
     /// Get the user data pointer
     void* getUserData() const
     {
-      return mUserData;
+      return reinterpret_cast<void*>(mUserData);
+    }
+
+    /// Get the index of the superpage's context, see setContextIndex()
+    uint32_t getContextIndex() const
+    {
+      return uint32_t(mUserData);
+    }
+
+    /// ID of the link the superpage's data came from. Only set by backends with multiple links per channel (CRU),
+    /// so the data can be dispatched without inspecting the payload.
+    uint32_t getLinkId() const
+    {
+      return mLinkId;
+    }
+
+    /// Epoch of the run the superpage was given to the card in, see DmaChannelInterface::startNextRun(). It wraps
+    /// around after 65535, so epochs should only be compared for equality.
+    uint16_t getRunEpoch() const
+    {
+      return mRunEpoch;
+    }
+
+    /// Time the superpage was marked as ready by the driver, in CPU timestamp counter ticks. 0 if not ready yet.
+    /// It is taken when the driver finds the superpage arrived, so the time until the user pops it is the queueing
+    /// delay in the driver. Only differences between timestamps from the same machine are meaningful.
+    uint64_t getTimestamp() const
+    {
+      return mTimestamp;
+    }
+
+    /// Time the superpage was given to the card by the driver, in the same ticks as getTimestamp(). 0 if the backend
+    /// does not record it.
+    uint64_t getPushTimestamp() const
+    {
+      return mPushTimestamp;
+    }
+
+    /// Get the array the lengths of the received DMA pages are written to, see setPageLengths()
+    uint32_t* getPageLengths() const
+    {
+      return mPageLengths;
     }
 
     /// Set the ready flag
     void setReady(bool ready)
     {
-      mReady = ready;
+      setFlag(FLAG_READY, ready);
+    }
+
+    /// Marks the superpage as checked. Used by the driver.
+    void setChecked(bool checked)
+    {
+      setFlag(FLAG_CHECKED, checked);
+    }
+
+    /// Marks the superpage as split off a pushed superpage, see isSplit(). Used by the driver.
+    void setSplit(bool split)
+    {
+      setFlag(FLAG_SPLIT, split);
     }
 
     /// Set the size of the received data in bytes
@@ -76,28 +154,94 @@ struct Superpage
     void setOffset(size_t offset)
     {
       mOffset = offset;
+      setFlag(FLAG_CHECKED, false);
+    }
+
+    /// Set the ID of the DMA buffer the superpage lies in
+    void setBufferId(uint16_t bufferId)
+    {
+      mBufferId = bufferId;
+      setFlag(FLAG_CHECKED, false);
     }
 
     /// Set the size of the Superpage in bytes
     void setSize(size_t size)
     {
       mSize = size;
+      setFlag(FLAG_CHECKED, false);
     }
 
-    /// Get the user data pointer
+    /// Set the user data pointer
     void setUserData(void* userData)
     {
-      mUserData = userData;
+      mUserData = reinterpret_cast<uintptr_t>(userData);
+    }
+
+    /// Set the index of the superpage's context in a SuperpageContexts table, so the context is found with an array
+    /// index when the superpage is popped. It is kept in the same field as the user data pointer, so a superpage has
+    /// either of the two.
+    void setContextIndex(uint32_t index)
+    {
+      mUserData = index;
+    }
+
+    /// Set the ID of the link the superpage's data came from
+    void setLinkId(uint32_t linkId)
+    {
+      mLinkId = uint16_t(linkId);
+    }
+
+    /// Set the epoch of the run the superpage was given to the card in. Used by the driver.
+    void setRunEpoch(uint16_t epoch)
+    {
+      mRunEpoch = epoch;
+    }
+
+    /// Set the time the superpage was marked as ready, see getTimestamp()
+    void setTimestamp(uint64_t timestamp)
+    {
+      mTimestamp = timestamp;
+    }
+
+    /// Set the time the superpage was pushed, see getPushTimestamp()
+    void setPushTimestamp(uint64_t timestamp)
+    {
+      mPushTimestamp = timestamp;
+    }
+
+    /// Set an array for the driver to write the length in bytes of each received DMA page to, so consumers don't need to
+    /// find it in the page itself. It must hold an entry for every DMA page of the superpage. Currently only filled by
+    /// the C-RORC backend.
+    void setPageLengths(uint32_t* pageLengths)
+    {
+      mPageLengths = pageLengths;
     }
 
   private:
+    static constexpr uint8_t FLAG_READY = 1 << 0;
+    static constexpr uint8_t FLAG_CHECKED = 1 << 1;
+    static constexpr uint8_t FLAG_SPLIT = 1 << 2;
+
+    void setFlag(uint8_t flag, bool value)
+    {
+      mFlags = value ? uint8_t(mFlags | flag) : uint8_t(mFlags & ~flag);
+    }
+
     size_t mOffset = 0; ///< Offset from the start of the DMA buffer to the start of the superpage
     size_t mSize = 0; ///< Size of the superpage in bytes
-    void* mUserData = nullptr; ///< Pointer that users can use for whatever, e.g. to associate data with the superpage
+    uintptr_t mUserData = 0; ///< User data pointer or context index, to associate data with the superpage
     size_t mReceived = 0; ///< Size of the received data in bytes
-    bool mReady = false; ///< Indicates this superpage is ready
+    uint32_t* mPageLengths = nullptr; ///< Array the lengths of the received DMA pages are written to
+    uint64_t mTimestamp = 0; ///< Time the superpage was marked as ready
+    uint64_t mPushTimestamp = 0; ///< Time the superpage was pushed
+    uint16_t mLinkId = 0; ///< ID of the link the data came from
+    uint16_t mRunEpoch = 0; ///< Epoch of the run the superpage was given to the card in
+    uint16_t mBufferId = 0; ///< ID of the DMA buffer the superpage lies in
+    uint8_t mFlags = 0; ///< Ready, checked and split flags
 };
 
+static_assert(sizeof(Superpage) == 64, "Superpage must fit in a cache line");
+
 } // namespace roc
 } // namespace AliceO2
 
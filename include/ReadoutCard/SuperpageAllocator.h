@@ -0,0 +1,90 @@
+/// \file SuperpageAllocator.h
+/// \brief Definition of the SuperpageAllocator class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEALLOCATOR_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+#include "ReadoutCard/Superpage.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Hands out superpages of different sizes from a region of a channel's buffer, so links with different superpage
+/// sizes (see SuperpageSizeTuner) can share one buffer without slicing it up front.
+///
+/// It is a buddy allocator: sizes are rounded up to a power-of-two multiple of 32 KiB, the granularity the channels
+/// accept, and every superpage is aligned to its size within the buffer. With the IOMMU off, a maximum size of at most
+/// the buffer's hugepage size therefore keeps every superpage within one hugepage, as the card requires.
+///
+/// The allocator is not thread-safe.
+class SuperpageAllocator
+{
+  public:
+    /// Smallest superpage size and granularity of the sizes
+    static constexpr size_t MIN_SUPERPAGE_SIZE = 32 * 1024;
+
+    /// \param regionOffset Offset of the region in the buffer. Rounded up to a multiple of MIN_SUPERPAGE_SIZE.
+    /// \param regionSize Size of the region
+    /// \param maxSuperpageSize Largest size handed out. Must be a power-of-two multiple of MIN_SUPERPAGE_SIZE, and at
+    ///   most the hugepage size of the buffer if the IOMMU is off.
+    /// \param bufferId ID of the buffer of the region, see DmaChannelInterface::addBuffer()
+    SuperpageAllocator(size_t regionOffset, size_t regionSize, size_t maxSuperpageSize, uint16_t bufferId = 0);
+
+    /// Allocates a superpage
+    /// \param size Size needed. The superpage gets the size rounded up to a power-of-two multiple of 32 KiB.
+    /// \param superpage Set to the superpage, with its offset, size and buffer ID
+    /// \return False if there was no free space large enough
+    bool tryAllocate(size_t size, Superpage& superpage);
+
+    /// Gives a superpage back, merging it with its free neighbours
+    /// \param superpage Superpage from tryAllocate(), with its offset unchanged
+    void release(const Superpage& superpage);
+
+    /// Gets the amount of free bytes
+    size_t getAvailable() const
+    {
+      return mAvailable;
+    }
+
+    /// Gets the largest size that can be allocated right now, or 0 if none
+    size_t getLargestAvailable() const;
+
+    size_t getMaxSuperpageSize() const
+    {
+      return MIN_SUPERPAGE_SIZE << mMaxOrder;
+    }
+
+  private:
+    /// Gets the size of blocks of the given order
+    static size_t getBlockSize(int order)
+    {
+      return MIN_SUPERPAGE_SIZE << order;
+    }
+
+    /// Frees a block, merging it with its buddy as long as that is free too
+    void free(size_t offset, int order);
+
+    int mMaxOrder;
+
+    uint16_t mBufferId;
+
+    size_t mAvailable = 0;
+
+    /// Offsets of the free blocks of every order, the lowest ones are handed out first
+    std::vector<std::set<size_t>> mFree;
+
+    /// Allocated blocks, as offset to order
+    std::map<size_t, int> mAllocated;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEALLOCATOR_H_
@@ -0,0 +1,146 @@
+/// \file SuperpageAutopilot.h
+/// \brief Definition of the SuperpageAutopilot class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEAUTOPILOT_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEAUTOPILOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ReadoutCard/DmaChannelInterface.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Keeps the transfer queue of a channel full from a region of its buffer, so applications only consume arrived
+/// superpages and release them, instead of each writing their own push loop.
+///
+/// The region is sliced into superpages of one size up front. Every poll() pushes free superpages until the transfer
+/// queue is full, and released superpages go straight back to the card with DmaChannelInterface::releaseSuperpage()
+/// when it has room. The channel may have a driver thread, in which case the queues are also serviced between polls.
+///
+/// In link-affine mode, the region is instead partitioned into one contiguous arena per link, sized by the link's
+/// expected rate, and the superpages of an arena are only pushed to its link with
+/// DmaChannelInterface::tryPushSuperpageToLink(). The data of a link then stays together in the buffer, which is easier
+/// on the TLB and prefetchers of a per-link consumer, and the buffer use of a link is simply that of its arena.
+///
+/// The autopilot is meant to be used from a single thread, and the channel should not be pushed into otherwise.
+class SuperpageAutopilot
+{
+  public:
+    /// Expected rate of a link, for sizing its arena
+    struct LinkRate
+    {
+        uint32_t linkId;
+        /// In any unit, only the ratios between the links matter
+        double rate;
+    };
+
+    /// Part of the region belonging to a link in link-affine mode
+    struct Arena
+    {
+        uint32_t linkId;
+        size_t offset;
+        size_t superpageCount;
+    };
+
+    /// \param channel Channel to drive. DMA is not started or stopped by the autopilot.
+    /// \param regionOffset Offset of the region in the buffer
+    /// \param regionSize Size of the region. Bytes after the last whole superpage are not used.
+    /// \param superpageSize Size of the superpages
+    /// \param bufferId ID of the buffer of the region, see DmaChannelInterface::addBuffer()
+    SuperpageAutopilot(std::shared_ptr<DmaChannelInterface> channel, size_t regionOffset, size_t regionSize,
+        size_t superpageSize, uint16_t bufferId = 0);
+
+    /// Creates an autopilot in link-affine mode. Every link gets a share of the superpages proportional to its rate,
+    /// and at least one.
+    /// \param links Links to push to, with their expected rates. A link must appear once.
+    SuperpageAutopilot(std::shared_ptr<DmaChannelInterface> channel, size_t regionOffset, size_t regionSize,
+        size_t superpageSize, const std::vector<LinkRate>& links, uint16_t bufferId = 0);
+
+    /// Pushes free superpages until the transfer queue is full, and drives the transfers of the channel
+    void fill();
+
+    /// Fills, then pops an arrived superpage
+    /// \param superpage Set to the superpage if one arrived
+    /// \return True if a superpage arrived
+    bool tryGetSuperpage(Superpage& superpage);
+
+    /// Fills, then hands the arrived superpages to a handler
+    /// \param handler Called as handler(const Superpage& superpage) for every arrived superpage. It must release the
+    ///   superpages with release(), now or later.
+    /// \return The amount of superpages handled
+    template <typename Handler>
+    size_t poll(Handler&& handler)
+    {
+      fill();
+      auto popped = mChannel->popSuperpages(mBatch.data(), mBatch.size());
+      for (size_t i = 0; i < popped; ++i) {
+        handler(mBatch[i]);
+      }
+      return popped;
+    }
+
+    /// Gives a consumed superpage back. It goes back to the card right away if the transfer queue has room, in
+    /// link-affine mode to the link of its arena.
+    void release(const Superpage& superpage);
+
+    /// Gets the amount of superpages the region was sliced into
+    size_t getSuperpageCount() const
+    {
+      return mSuperpageCount;
+    }
+
+    /// Gets the amount of superpages waiting for room in the transfer queue
+    size_t getFreeCount() const;
+
+    /// Gets the arenas of the links, ordered by offset. Empty if not in link-affine mode.
+    std::vector<Arena> getArenas() const;
+
+    /// Gets the amount of superpages of a link's arena waiting for room in its queue
+    size_t getLinkFreeCount(uint32_t linkId) const;
+
+    DmaChannelInterface& getChannel()
+    {
+      return *mChannel;
+    }
+
+  private:
+    struct Pool
+    {
+        Arena arena;
+        /// Superpages not in the channel, used as a stack so the most recently used memory is pushed first
+        std::vector<Superpage> free;
+    };
+
+    void addPool(uint32_t linkId, size_t offset, size_t superpageCount, size_t superpageSize, uint16_t bufferId);
+
+    /// Gets the pool a superpage belongs to
+    Pool& getPool(const Superpage& superpage);
+
+    /// Gives a superpage of a pool to the channel
+    /// \return False if there was no room
+    bool give(Pool& pool, const Superpage& superpage);
+
+    std::shared_ptr<DmaChannelInterface> mChannel;
+
+    size_t mSuperpageCount;
+
+    size_t mSuperpageSize;
+
+    /// One per link in link-affine mode, else one for the whole region. Ordered by offset.
+    std::vector<Pool> mPools;
+
+    bool mLinkAffine;
+
+    /// Buffer the superpages of a poll() are popped into
+    std::vector<Superpage> mBatch;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEAUTOPILOT_H_
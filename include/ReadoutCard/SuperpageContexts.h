@@ -0,0 +1,129 @@
+/// \file SuperpageContexts.h
+/// \brief Definition of the SuperpageContexts class template.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGECONTEXTS_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGECONTEXTS_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ReadoutCard/Superpage.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Table of per-superpage contexts of a channel, so the bookkeeping of a popped superpage is an array index instead of
+/// a lookup by offset in a map.
+///
+/// The table is allocated once, with a slot for every superpage that can be in flight, typically the channel's
+/// getTransferQueueAvailable() plus the superpages the user holds on to. Before pushing a superpage, the user acquires
+/// a slot, fills its context and puts the slot's dense index in the superpage with attach(). The driver carries the
+/// index through its queues unchanged, so after the pop, get() finds the context again. Acquiring and releasing slots
+/// is O(1) and does not allocate.
+///
+/// The pieces of a superpage split by the SuperpageFlushTimeout parameter all carry its index, so the slot should be
+/// released when the piece that ends at the end of the superpage arrives.
+///
+/// Not thread-safe: the slots are meant to be acquired and released by the thread running the DMA loop.
+template <typename Context>
+class SuperpageContexts
+{
+  public:
+    /// \param capacity Amount of slots
+    explicit SuperpageContexts(size_t capacity) : mContexts(capacity), mAcquired(capacity, false)
+    {
+      mFree.reserve(capacity);
+      // Handed out from the lowest index
+      for (size_t i = capacity; i > 0; --i) {
+        mFree.push_back(uint32_t(i - 1));
+      }
+    }
+
+    /// Gets the amount of slots
+    size_t getCapacity() const
+    {
+      return mContexts.size();
+    }
+
+    /// Gets the amount of free slots
+    size_t getAvailable() const
+    {
+      return mFree.size();
+    }
+
+    /// Acquires a free slot
+    /// \param index Set to the index of the slot
+    /// \return False if all slots are in use
+    bool acquire(uint32_t& index)
+    {
+      if (mFree.empty()) {
+        return false;
+      }
+      index = mFree.back();
+      mFree.pop_back();
+      mAcquired[index] = true;
+      return true;
+    }
+
+    /// Acquires a free slot and puts its index in the superpage
+    /// \return The context of the slot, nullptr if all slots are in use
+    Context* attach(Superpage& superpage)
+    {
+      uint32_t index;
+      if (!acquire(index)) {
+        return nullptr;
+      }
+      superpage.setContextIndex(index);
+      return &mContexts[index];
+    }
+
+    /// Releases an acquired slot, so it can be acquired again. The context keeps its value until then.
+    void release(uint32_t index)
+    {
+      assert(index < mContexts.size() && mAcquired[index]);
+      mAcquired[index] = false;
+      mFree.push_back(index);
+    }
+
+    /// Releases the slot of a superpage, see release()
+    void release(const Superpage& superpage)
+    {
+      release(superpage.getContextIndex());
+    }
+
+    /// Gets the context of a slot. The index is not checked.
+    Context& operator[](uint32_t index)
+    {
+      return mContexts[index];
+    }
+
+    const Context& operator[](uint32_t index) const
+    {
+      return mContexts[index];
+    }
+
+    /// Gets the context of a superpage, by the index attach() put in it. The index is not checked.
+    Context& get(const Superpage& superpage)
+    {
+      return mContexts[superpage.getContextIndex()];
+    }
+
+    const Context& get(const Superpage& superpage) const
+    {
+      return mContexts[superpage.getContextIndex()];
+    }
+
+  private:
+    std::vector<Context> mContexts;
+    std::vector<bool> mAcquired;
+    /// Indexes of the free slots, used as a stack
+    std::vector<uint32_t> mFree;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGECONTEXTS_H_
@@ -0,0 +1,98 @@
+/// \file SuperpageHandles.h
+/// \brief Definition of the SuperpageProducer and SuperpageConsumer classes.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEHANDLES_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEHANDLES_H_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include "ReadoutCard/DmaChannelInterface.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Push side of a channel, to refill it from one thread while another thread consumes it with a SuperpageConsumer.
+///
+/// Only channels with a driver thread (the DriverThreadEnabled parameter) can be split like this: their transfer and
+/// ready queues are single-producer single-consumer queues, with the driver thread on the other end of both. The
+/// handles are only safe to use concurrently while DMA is running. Before startDma() and after stopDma(), calls go to
+/// the card's channel directly, which is single-threaded.
+/// Get the handles of a channel with ChannelFactory::getSplitDmaChannel().
+class SuperpageProducer
+{
+  public:
+    explicit SuperpageProducer(std::shared_ptr<DmaChannelInterface> channel) : mChannel(std::move(channel))
+    {
+    }
+
+    /// See DmaChannelInterface::pushSuperpage()
+    void push(const Superpage& superpage)
+    {
+      mChannel->pushSuperpage(superpage);
+    }
+
+    /// See DmaChannelInterface::tryPushSuperpage()
+    bool tryPush(const Superpage& superpage)
+    {
+      return mChannel->tryPushSuperpage(superpage);
+    }
+
+    /// See DmaChannelInterface::releaseSuperpage()
+    void release(const Superpage& superpage)
+    {
+      mChannel->releaseSuperpage(superpage);
+    }
+
+    /// See DmaChannelInterface::getTransferQueueAvailable()
+    int getTransferQueueAvailable()
+    {
+      return mChannel->getTransferQueueAvailable();
+    }
+
+  private:
+    std::shared_ptr<DmaChannelInterface> mChannel;
+};
+
+/// Pop side of a channel, see SuperpageProducer
+class SuperpageConsumer
+{
+  public:
+    explicit SuperpageConsumer(std::shared_ptr<DmaChannelInterface> channel) : mChannel(std::move(channel))
+    {
+    }
+
+    /// See DmaChannelInterface::tryPopSuperpage()
+    bool tryPop(Superpage& superpage)
+    {
+      return mChannel->tryPopSuperpage(superpage);
+    }
+
+    /// See DmaChannelInterface::popSuperpages()
+    size_t pop(Superpage* superpages, size_t max)
+    {
+      return mChannel->popSuperpages(superpages, max);
+    }
+
+    /// See DmaChannelInterface::waitForReadySuperpage()
+    bool waitForReady(std::chrono::nanoseconds timeout)
+    {
+      return mChannel->waitForReadySuperpage(timeout);
+    }
+
+    /// See DmaChannelInterface::getReadyQueueSize()
+    int getReadyQueueSize()
+    {
+      return mChannel->getReadyQueueSize();
+    }
+
+  private:
+    std::shared_ptr<DmaChannelInterface> mChannel;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGEHANDLES_H_
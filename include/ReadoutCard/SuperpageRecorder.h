@@ -0,0 +1,219 @@
+/// \file SuperpageRecorder.h
+/// \brief Definition of the SuperpageRecorder and SuperpageRecording classes.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGERECORDER_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGERECORDER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ReadoutCard/Superpage.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Records superpages at high rates by striping them round-robin across several files, typically one per NVMe device,
+/// optionally compressing them on a pool of worker threads first. Superpage n goes to stripe n modulo the amount of
+/// stripes. Every stripe has its own writer thread.
+///
+/// Next to the stripes, an index file lists every superpage in the order it was given, with its stripe, offset, sizes
+/// and compression, so SuperpageRecording can replay the recording. With a single stripe and no compression, the
+/// stripe holds the superpages back to back, like a plain recording.
+///
+/// The stripes are opened with O_DIRECT where the file system supports it. Data that is aligned to DIRECT_ALIGNMENT
+/// in address and size, such as superpages in a hugepage buffer, is written straight from the DMA buffer; other data
+/// and compressed data is padded to the alignment in the stripe.
+///
+/// The interface is for a single thread: it gives superpages with write(), and gets them back with reap() when they
+/// were recorded, in the order they were given. A superpage's data must not be touched until then.
+class SuperpageRecorder
+{
+  public:
+    /// Alignment of the data's address and size required by O_DIRECT
+    static constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+    enum class Compression : uint32_t
+    {
+      None = 0,
+      Lz4 = 1,
+      Zstd = 2,
+    };
+
+    /// Parses "none", "lz4" or "zstd"
+    /// \throw ParseException if the string is none of those
+    static Compression compressionFromString(const std::string& string);
+
+    /// Checks if the library was built with support for the compression
+    static bool isCompressionAvailable(Compression compression);
+
+    /// An entry of the index file, one per superpage
+    struct IndexEntry
+    {
+        uint64_t offset; ///< Offset of the data in the stripe
+        uint64_t storedSize; ///< Size of the data in the stripe, without padding
+        uint64_t size; ///< Size of the data before compression
+        uint32_t stripe; ///< Index of the stripe
+        Compression compression; ///< Compression of the data, None if compressing didn't make it smaller
+    };
+
+    struct Options
+    {
+        /// Paths of the stripe files, which are truncated
+        std::vector<std::string> stripePaths;
+        /// Path of the index file. If empty, the path of the first stripe with ".index" appended.
+        std::string indexPath;
+        Compression compression = Compression::None;
+        /// Level for Zstd, acceleration for Lz4
+        int compressionLevel = 1;
+        /// Amount of compression worker threads, ignored without compression
+        size_t compressionThreads = 4;
+        /// Maximum amount of superpages given and not yet reaped
+        size_t queueDepth = 16;
+    };
+
+    /// Opens the stripes and the index, and starts the threads
+    /// \throw Exception if an option is invalid, the compression is not available, or a file could not be opened
+    explicit SuperpageRecorder(const Options& options);
+
+    /// Waits for the superpages in flight, stops the threads and closes the files
+    ~SuperpageRecorder();
+
+    SuperpageRecorder(const SuperpageRecorder&) = delete;
+    SuperpageRecorder& operator=(const SuperpageRecorder&) = delete;
+
+    /// Starts recording data of a superpage
+    /// \param superpage The superpage, returned by reap() when it is recorded
+    /// \param data Start of the data
+    /// \param size Size of the data
+    /// \return False if the queue is full, in which case nothing was started
+    bool write(const Superpage& superpage, const void* data, size_t size);
+
+    /// Gets superpages that were recorded, in the order they were given, and adds them to the index
+    /// \param superpages Array to put the superpages in
+    /// \param max Maximum amount of superpages to get
+    /// \param wait If true and superpages are in flight, blocks until at least one is recorded
+    /// \return The amount of superpages put in the array
+    /// \throw Exception if a compression or write failed
+    size_t reap(Superpage* superpages, size_t max, bool wait);
+
+    /// Gets the amount of superpages given and not yet reaped
+    size_t getInFlight() const
+    {
+      return size_t(mSubmitted - mReaped);
+    }
+
+    size_t getQueueDepth() const
+    {
+      return mOptions.queueDepth;
+    }
+
+    /// Returns true if all stripes were opened with O_DIRECT
+    bool isDirect() const;
+
+    /// Gets the amount of bytes of reaped superpages before compression
+    uint64_t getBytesRecorded() const
+    {
+      return mBytesRecorded;
+    }
+
+    /// Gets the amount of bytes of reaped superpages in the stripes, without padding
+    uint64_t getBytesStored() const
+    {
+      return mBytesStored;
+    }
+
+    const std::string& getIndexPath() const
+    {
+      return mOptions.indexPath;
+    }
+
+  private:
+    /// A superpage in flight
+    struct Slot;
+    /// A stripe file with its writer thread
+    struct Stripe;
+
+    void compressLoop();
+    void writeLoop(Stripe& stripe);
+    /// Hands a slot to its stripe's writer
+    void queueWrite(Slot& slot);
+    /// Marks a slot as done, with the error that stopped it, if any
+    void finish(Slot& slot, std::exception_ptr error);
+
+    Options mOptions;
+    std::vector<std::unique_ptr<Slot>> mSlots;
+    std::vector<std::unique_ptr<Stripe>> mStripes;
+    std::ofstream mIndex;
+
+    /// Protects the queues and the state of the slots
+    std::mutex mMutex;
+    /// Signals a finished slot to reap()
+    std::condition_variable mFinished;
+    /// Signals a slot to compress to the workers
+    std::condition_variable mCompressWork;
+    /// Slots to compress
+    std::deque<Slot*> mCompressQueue;
+    bool mStop = false;
+    std::vector<std::thread> mCompressThreads;
+
+    /// Counts of given and reaped superpages. The slot of a superpage is its count modulo the queue depth.
+    uint64_t mSubmitted = 0;
+    uint64_t mReaped = 0;
+    uint64_t mBytesRecorded = 0;
+    uint64_t mBytesStored = 0;
+};
+
+/// Reads a recording made by SuperpageRecorder, through its index file
+class SuperpageRecording
+{
+  public:
+    /// Reads the index and opens the stripes it names
+    /// \throw Exception if a file could not be opened or the index is malformed
+    explicit SuperpageRecording(const std::string& indexPath);
+
+    ~SuperpageRecording();
+
+    SuperpageRecording(const SuperpageRecording&) = delete;
+    SuperpageRecording& operator=(const SuperpageRecording&) = delete;
+
+    /// Gets the superpages of the recording, in the order they were recorded
+    const std::vector<SuperpageRecorder::IndexEntry>& getEntries() const
+    {
+      return mEntries;
+    }
+
+    const std::vector<std::string>& getStripePaths() const
+    {
+      return mStripePaths;
+    }
+
+    /// Reads the data of a superpage, decompressed
+    /// \param index Index of the superpage in getEntries()
+    /// \param destination Where to put the data, which must have room for the entry's size
+    /// \param capacity Size of the destination
+    /// \return The size of the data
+    /// \throw Exception if the destination is too small, or the data could not be read or decompressed
+    size_t read(size_t index, void* destination, size_t capacity);
+
+  private:
+    std::vector<std::string> mStripePaths;
+    std::vector<int> mFileDescriptors;
+    std::vector<SuperpageRecorder::IndexEntry> mEntries;
+    /// Compressed data of the last read
+    std::vector<char> mCompressed;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGERECORDER_H_
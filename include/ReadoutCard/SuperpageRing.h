@@ -0,0 +1,103 @@
+/// \file SuperpageRing.h
+/// \brief Definition of the SuperpageRing class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGERING_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGERING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ReadoutCard/Superpage.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Lock-free single-producer single-consumer ring of superpages, for passing superpages between the thread driving a
+/// channel and the threads or processes consuming the data.
+///
+/// The ring either owns its memory, for use between threads, or lives in memory given by the user, such as shared
+/// memory mapped by two processes (see SharedMemoryBuffer). The indices of the producer and consumer are on separate
+/// cache lines, as is every entry, and each side caches the other side's index so it only reads it when the ring looks
+/// full or empty.
+///
+/// All Superpage fields are carried. Note that the user data and page lengths pointers are only meaningful within one
+/// process.
+class SuperpageRing
+{
+  public:
+    /// Size of a cache line, to which the indices and entries are aligned
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    /// Creates a ring that owns its memory
+    /// \param capacity Amount of superpages the ring can hold
+    explicit SuperpageRing(size_t capacity);
+
+    /// Creates a ring in the given memory, which must stay mapped for the lifetime of the ring. In shared memory, the
+    /// creating side initializes it and the other side attaches to it.
+    /// \param memory Start of the memory, aligned to a cache line. Must be at least getRequiredSize() bytes.
+    /// \param capacity Amount of superpages the ring can hold. Must be the same on both sides.
+    /// \param initialize True to initialize the memory as an empty ring, false to attach to an initialized ring
+    SuperpageRing(void* memory, size_t capacity, bool initialize);
+
+    ~SuperpageRing();
+
+    SuperpageRing(const SuperpageRing&) = delete;
+    SuperpageRing& operator=(const SuperpageRing&) = delete;
+
+    /// Gets the amount of memory a ring of the given capacity needs
+    static size_t getRequiredSize(size_t capacity);
+
+    /// Writes a superpage. Producer side.
+    /// \return False if the ring was full
+    bool write(const Superpage& superpage);
+
+    /// Writes as many of the given superpages as fit. Producer side.
+    /// \return The amount of superpages written
+    size_t write(const Superpage* superpages, size_t count);
+
+    /// Reads a superpage. Consumer side.
+    /// \return False if the ring was empty
+    bool read(Superpage& superpage);
+
+    /// Reads up to the given amount of superpages. Consumer side.
+    /// \return The amount of superpages read
+    size_t read(Superpage* superpages, size_t max);
+
+    /// Gets the amount of superpages in the ring. May be outdated by the time it returns if the other side is active.
+    size_t sizeGuess() const;
+
+    /// Gets the amount of superpages the ring can hold
+    size_t getCapacity() const
+    {
+      return mCapacity;
+    }
+
+  private:
+    struct Control;
+    struct Entry;
+
+    /// Memory of rings that own it
+    std::unique_ptr<void, void(*)(void*)> mOwnedMemory;
+
+    /// Indices in the ring's memory
+    Control* mControl;
+
+    /// Entries in the ring's memory
+    Entry* mEntries;
+
+    const size_t mCapacity;
+
+    /// The consumer's index as last seen by the producer. Only used by the producer.
+    alignas(CACHE_LINE_SIZE) uint64_t mCachedReadIndex = 0;
+
+    /// The producer's index as last seen by the consumer. Only used by the consumer.
+    alignas(CACHE_LINE_SIZE) uint64_t mCachedWriteIndex = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGERING_H_
@@ -0,0 +1,77 @@
+/// \file SuperpageSizeTuner.h
+/// \brief Definition of the SuperpageSizeTuner class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGESIZETUNER_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGESIZETUNER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "ReadoutCard/ChannelStatistics.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Picks the size of the superpages to push for every link from its arrival rate, so a superpage fills within a latency
+/// target while being as large as possible to amortize the per-superpage overhead.
+///
+/// The rates are measured from the per-link byte counts of DmaChannelInterface::getStatistics(), which the user
+/// passes to update() periodically, for example once per second. The candidate sizes are given up front, typically
+/// the sizes the user's buffer is carved into, such as slices of a HugepagePool. For every link, the largest candidate
+/// that fills within the target at the measured rate is used. Links without a measured rate get the smallest one.
+///
+/// The tuner is not thread-safe.
+class SuperpageSizeTuner
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// \param sizes Candidate superpage sizes. Must not be empty or contain 0.
+    /// \param latencyTarget Longest time a superpage should take to fill
+    SuperpageSizeTuner(std::vector<size_t> sizes, std::chrono::nanoseconds latencyTarget);
+
+    /// Measures the link rates from the byte counts since the previous update. The rates are averaged over updates, so
+    /// short bursts don't make the sizes jump back and forth.
+    /// \param statistics Statistics of the channel
+    /// \param now Time the statistics were taken
+    void update(const ChannelStatistics& statistics, Clock::time_point now = Clock::now());
+
+    /// Gets the size to use for the next superpages of a link
+    size_t getSuperpageSize(uint32_t linkId) const;
+
+    /// Gets the measured rate of a link in bytes per second, or 0 if there is none yet
+    double getRate(uint32_t linkId) const;
+
+    /// Gets the candidate sizes, from small to large
+    const std::vector<size_t>& getSizes() const
+    {
+      return mSizes;
+    }
+
+  private:
+    struct Link
+    {
+        /// Bytes received by the link at the previous update
+        uint64_t bytes = 0;
+        /// Time of the previous update
+        Clock::time_point time;
+        /// Averaged rate in bytes per second, negative if not measured yet
+        double rate = -1;
+    };
+
+    /// Candidate sizes, sorted
+    std::vector<size_t> mSizes;
+
+    std::chrono::nanoseconds mLatencyTarget;
+
+    std::map<uint32_t, Link> mLinks;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGESIZETUNER_H_
@@ -0,0 +1,195 @@
+/// \file SuperpageTap.h
+/// \brief Definition of the SuperpageTap class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGETAP_H_
+#define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGETAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include "ReadoutCard/Superpage.h"
+#include "ReadoutCard/SuperpageRing.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Samples superpages of the readout and streams them over TCP, so the data of a running system can be inspected from
+/// another host without disturbing the readout.
+///
+/// The readout offers every superpage it reads out with offer(). The tap copies one in every N of them, optionally
+/// only those of some links, into a bounded ring of slots, and a background thread sends the slots to the connected
+/// client with MSG_ZEROCOPY, reusing a slot once the kernel reports it sent. offer() never blocks and makes no system
+/// calls: when the ring is full because the network is slow, the sample is dropped and counted. Without a client,
+/// nothing is copied.
+///
+/// The tap listens on a TCP port and serves one client at a time. Every sample is sent as a SampleHeader followed by
+/// its data, in host byte order.
+///
+/// offer() must be called from a single thread.
+class SuperpageTap
+{
+  public:
+    /// Value of SampleHeader::magic
+    static constexpr uint32_t SAMPLE_MAGIC = 0x50415452; // "RTAP"
+
+    /// Precedes the data of every sample in the stream
+    struct SampleHeader
+    {
+        uint32_t magic;
+        /// Link of the superpage
+        uint32_t linkId;
+        /// Index of the superpage among all superpages offered
+        uint64_t sequence;
+        /// Amount of data following the header
+        uint64_t size;
+        /// Amount of data of the superpage, more than size if the sample was truncated
+        uint64_t received;
+        /// Amount of samples dropped before this one
+        uint64_t dropped;
+    };
+
+    struct Options
+    {
+        /// IPv4 address to listen on
+        std::string address = "0.0.0.0";
+        /// Port to listen on, 0 for any free port (see getPort())
+        uint16_t port = 0;
+        /// Sample one in this many superpages of the links
+        uint64_t sampleEvery = 100;
+        /// Links to sample, all if empty. Link IDs must be below 64.
+        std::set<uint32_t> links;
+        /// Amount of slots of the ring
+        size_t slots = 16;
+        /// Maximum size of a sample, larger superpages are truncated
+        size_t maxSampleSize = 1024 * 1024;
+    };
+
+    /// Starts listening and the sending thread
+    /// \throw Exception if an option is invalid or the socket could not be set up
+    explicit SuperpageTap(const Options& options);
+
+    /// Stops the sending thread and closes the sockets
+    ~SuperpageTap();
+
+    SuperpageTap(const SuperpageTap&) = delete;
+    SuperpageTap& operator=(const SuperpageTap&) = delete;
+
+    /// Offers a superpage that was read out. Never blocks.
+    /// \param superpage The superpage, for its link ID
+    /// \param data Start of its data, which is copied before returning
+    /// \param size Size of its data
+    /// \return True if the superpage was sampled
+    bool offer(const Superpage& superpage, const void* data, size_t size);
+
+    /// Gets the port the tap listens on
+    uint16_t getPort() const
+    {
+      return mPort;
+    }
+
+    bool isClientConnected() const
+    {
+      return mConnected.load(std::memory_order_relaxed);
+    }
+
+    /// Checks if sends are done with MSG_ZEROCOPY. False before the first client, if the kernel does not support it,
+    /// or if the kernel had to copy the data anyway, as it does on the loopback device.
+    bool isZeroCopy() const
+    {
+      return mZeroCopy.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getOfferedCount() const
+    {
+      return mOffered.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getSampledCount() const
+    {
+      return mSampled.load(std::memory_order_relaxed);
+    }
+
+    /// Gets the amount of samples dropped because the ring was full
+    uint64_t getDroppedCount() const
+    {
+      return mDropped.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getSentCount() const
+    {
+      return mSent.load(std::memory_order_relaxed);
+    }
+
+    /// Gets the amount of samples discarded because their client disconnected before they were sent
+    uint64_t getDiscardedCount() const
+    {
+      return mDiscarded.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// A slot whose data the kernel may still be reading
+    struct PendingSlot
+    {
+        Superpage slot;
+        /// Counter of the last zero-copy send of the slot's data
+        uint32_t lastSend;
+    };
+
+    void sendLoop();
+    void acceptClient();
+    void disconnectClient();
+    /// Gives back the slots of samples that were offered but won't be sent
+    void discardFilled();
+    /// Sends a slot, returns false if the client is gone
+    bool sendSlot(const Superpage& slot);
+    /// Gives back the slots whose zero-copy sends completed
+    void reapCompletions();
+    char* getSlotAddress(const Superpage& slot) const
+    {
+      return mMemory.get() + slot.getOffset();
+    }
+
+    Options mOptions;
+    uint64_t mLinkMask = 0;
+    size_t mSlotSize;
+    std::unique_ptr<char[]> mMemory;
+    /// Free slots, from the sending thread to offer()
+    SuperpageRing mFree;
+    /// Filled slots, from offer() to the sending thread
+    SuperpageRing mFilled;
+
+    int mListenSocket = -1;
+    uint16_t mPort = 0;
+    /// Socket of the client, -1 if none. Only the sending thread uses it.
+    int mClientSocket = -1;
+    /// Counter of zero-copy sends to the client, 0 if they are not supported. Only the sending thread uses it.
+    uint32_t mZeroCopySends = 0;
+    bool mZeroCopySupported = false;
+    /// Slots sent with MSG_ZEROCOPY and not yet reported complete. Only the sending thread uses it.
+    std::deque<PendingSlot> mPending;
+
+    /// Count of superpages of the sampled links, only used by offer()
+    uint64_t mMatching = 0;
+    std::atomic<bool> mConnected { false };
+    std::atomic<bool> mZeroCopy { false };
+    std::atomic<uint64_t> mOffered { 0 };
+    std::atomic<uint64_t> mSampled { 0 };
+    std::atomic<uint64_t> mDropped { 0 };
+    std::atomic<uint64_t> mSent { 0 };
+    std::atomic<uint64_t> mDiscarded { 0 };
+
+    std::atomic<bool> mStop { false };
+    std::thread mThread;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_SUPERPAGETAP_H_
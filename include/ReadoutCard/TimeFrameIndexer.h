@@ -0,0 +1,97 @@
+/// \file TimeFrameIndexer.h
+/// \brief Definition of the TimeFrameIndexer class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_TIMEFRAMEINDEXER_H_
+#define ALICEO2_INCLUDE_READOUTCARD_TIMEFRAMEINDEXER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ReadoutCard/Superpage.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// A run of consecutive packets of a superpage that belong to the same time frame
+struct TimeFrameSlice
+{
+    uint32_t timeFrame; ///< Heartbeat orbit of the packets divided by the time frame length
+    uint32_t firstOrbit; ///< Heartbeat orbit of the first packet
+    uint32_t lastOrbit; ///< Heartbeat orbit of the last packet
+    uint32_t linkId; ///< Link ID of the first packet
+    size_t firstPacket; ///< Index of the first packet in the superpage, the DMA page unless the packets are packed
+    size_t packets; ///< Amount of packets
+    size_t offset; ///< Offset of the first packet from the start of the superpage in bytes
+    size_t size; ///< Size in bytes, up to the next slice or the end of the received data
+    bool continued; ///< True if the time frame started in an earlier superpage of the link
+};
+
+/// Indexes received CRU superpages by time frame, so a consumer that assembles time frames does not have to walk the
+/// RDHs again to find the superpages that straddle a time frame boundary.
+///
+/// A time frame is a fixed amount of heartbeat orbits, and a packet belongs to the time frame of the heartbeat orbit
+/// in its RDH. The indexer walks the packets of a superpage like LinkIntegrityMonitor, and cuts the superpage where
+/// the time frame changes. A packet with an RDH size error stays in the slice of the packet before it, since its
+/// orbit can't be trusted either. The indexer remembers the last time frame of every link, to mark slices that
+/// continue a time frame of an earlier superpage. It is not thread-safe, every readout thread should use its own.
+class TimeFrameIndexer
+{
+  public:
+    /// Amount of links whose time frames are tracked, the link ID is 8 bits
+    static constexpr size_t MAX_LINKS = 256;
+
+    /// Default size of CRU DMA pages
+    static constexpr size_t DMA_PAGE_SIZE = 8 * 1024;
+
+    /// Default time frame length in heartbeat orbits
+    static constexpr uint32_t DEFAULT_TIME_FRAME_LENGTH = 256;
+
+    /// \param timeFrameLength Amount of heartbeat orbits per time frame, at least 1
+    /// \param pageSize Size of the DMA pages
+    /// \param packed True if the packets are packed, false if every DMA page holds one
+    explicit TimeFrameIndexer(uint32_t timeFrameLength = DEFAULT_TIME_FRAME_LENGTH, size_t pageSize = DMA_PAGE_SIZE,
+        bool packed = false);
+
+    /// Indexes the complete DMA pages of a received superpage, or with packed packets, the packets within the received
+    /// bytes
+    /// \param address Start of the superpage in the DMA buffer
+    /// \param received Amount of bytes received in the superpage
+    /// \param slices Vector the slices are put in, in the order of the data. It is cleared first, so the caller can
+    ///   reuse it without allocating for every superpage.
+    /// \return The amount of slices, more than one if the superpage straddles a time frame boundary
+    size_t indexSuperpage(const void* address, size_t received, std::vector<TimeFrameSlice>& slices);
+
+    /// Splits a superpage at the boundaries of its slices. Every piece covers the bytes of a slice, is ready and filled,
+    /// and keeps the link ID, timestamps and user data of the superpage, but not its page lengths. The pieces are views
+    /// for the consumer: it is still the whole superpage that goes back to the driver.
+    /// \param superpage Superpage that was indexed
+    /// \param slices Slices of the superpage from indexSuperpage()
+    static std::vector<Superpage> split(const Superpage& superpage, const std::vector<TimeFrameSlice>& slices);
+
+    /// Gets the time frame of a heartbeat orbit
+    uint32_t getTimeFrame(uint32_t orbit) const
+    {
+      return orbit / mTimeFrameLength;
+    }
+
+    /// Forgets the last time frames of all links, so the next slice of every link starts a time frame
+    void reset();
+
+  private:
+    static constexpr uint64_t UNKNOWN = ~uint64_t(0);
+
+    uint32_t mTimeFrameLength;
+    size_t mPageSize;
+    bool mPacked;
+
+    /// Time frame of the last slice of every link
+    std::array<uint64_t, MAX_LINKS> mLastTimeFrame;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_TIMEFRAMEINDEXER_H_
@@ -0,0 +1,72 @@
+/// \file TransparentHugepageBuffer.h
+/// \brief Definition of the TransparentHugepageBuffer class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_TRANSPARENTHUGEPAGEBUFFER_H_
+#define ALICEO2_INCLUDE_READOUTCARD_TRANSPARENTHUGEPAGEBUFFER_H_
+
+#include <cstddef>
+#include <boost/optional.hpp>
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Anonymous memory backed by transparent hugepages (THP), to be used as DMA buffer on systems with the IOMMU enabled.
+/// Unlike the hugetlbfs and HugepageMemfd, it needs no hugepages reserved in advance: the kernel assembles 2 MiB pages
+/// when the memory is faulted in. Without the IOMMU the card needs physically contiguous hugepages, which THP doesn't
+/// guarantee, so the DMA channel refuses such a buffer.
+///
+/// The kernel may fall back to 4 KiB pages for part of the memory, for example when memory is fragmented. The buffer
+/// reports how much of it got hugepages, so the user can tell the consumers' TLB reach.
+///
+/// The memory is mapped, advised and faulted in on construction, and unmapped on destruction.
+class TransparentHugepageBuffer
+{
+  public:
+    /// Allocates the memory, 2 MiB aligned, with madvise(MADV_HUGEPAGE)
+    /// \param size Size of the memory. Must be a multiple of 2 MiB.
+    /// \param numaNode If given, the memory is allocated on this NUMA node, typically the one of the card writing into
+    ///        the buffer
+    /// \throw MemoryMapException if THP is disabled ("never" in /sys/kernel/mm/transparent_hugepage/enabled), or the
+    ///        memory could not be mapped
+    TransparentHugepageBuffer(size_t size, boost::optional<int> numaNode = boost::none);
+
+    ~TransparentHugepageBuffer();
+
+    TransparentHugepageBuffer(const TransparentHugepageBuffer&) = delete;
+    TransparentHugepageBuffer& operator=(const TransparentHugepageBuffer&) = delete;
+
+    void* getAddress() const
+    {
+      return mAddress;
+    }
+
+    size_t getSize() const
+    {
+      return mSize;
+    }
+
+    /// Gets the amount of the memory backed by hugepages. It is read from /proc/self/smaps on every call, because
+    /// khugepaged may promote the rest later.
+    size_t getHugepageBytes() const;
+
+    /// Gets the effective size of the pages backing the memory: 2 MiB if hugepages back all of it, 4 KiB otherwise
+    size_t getPageSize() const;
+
+    /// Gets the buffer parameters to open a channel on the memory with Parameters::setBufferParameters()
+    buffer_parameters::Memory getBufferParameters() const
+    {
+      return {mAddress, mSize};
+    }
+
+  private:
+    void* mAddress = nullptr;
+    size_t mSize = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_TRANSPARENTHUGEPAGEBUFFER_H_
@@ -0,0 +1,113 @@
+/// \file AsyncLogger.cxx
+/// \brief Implementation of the AsyncLogger class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "AsyncLogger.h"
+#include <cstring>
+
+namespace AliceO2 {
+namespace roc {
+
+static_assert((AsyncLogger::CAPACITY & (AsyncLogger::CAPACITY - 1)) == 0, "Capacity must be a power of 2");
+
+constexpr size_t AsyncLogger::CAPACITY;
+constexpr size_t AsyncLogger::MAX_MESSAGE_SIZE;
+constexpr std::chrono::milliseconds AsyncLogger::DEFAULT_FLUSH_INTERVAL;
+
+AsyncLogger::AsyncLogger(Sink sink, std::chrono::milliseconds flushInterval) : mSink(std::move(sink))
+{
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    mSlots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  mFlusher = std::thread([this, flushInterval] { runFlusher(flushInterval); });
+}
+
+AsyncLogger::~AsyncLogger()
+{
+  {
+    std::lock_guard<std::mutex> lock(mStopMutex);
+    mStop = true;
+  }
+  mStopCondition.notify_one();
+  mFlusher.join();
+  flush();
+}
+
+bool AsyncLogger::post(Severity severity, const std::string& message)
+{
+  for (size_t offset = MAX_MESSAGE_SIZE; offset < message.size(); offset += MAX_MESSAGE_SIZE) {
+    if (!postPart(severity, message.data() + offset - MAX_MESSAGE_SIZE, MAX_MESSAGE_SIZE)) {
+      return false;
+    }
+  }
+  const size_t last = message.empty() ? 0 : ((message.size() - 1) / MAX_MESSAGE_SIZE) * MAX_MESSAGE_SIZE;
+  return postPart(severity, message.data() + last, message.size() - last);
+}
+
+bool AsyncLogger::postPart(Severity severity, const char* text, size_t size)
+{
+  // Bounded multi-producer queue: a producer claims a position by moving the head, and publishes the message by
+  // advancing the sequence of the position's slot
+  auto position = mHead.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &mSlots[position & (CAPACITY - 1)];
+    const auto sequence = slot->sequence.load(std::memory_order_acquire);
+    const auto difference = int64_t(sequence) - int64_t(position);
+    if (difference == 0) {
+      if (mHead.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      // The slot still holds the message of the previous lap
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = mHead.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->severity = severity;
+  slot->size = uint32_t(size);
+  std::memcpy(slot->text, text, size);
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+void AsyncLogger::flush()
+{
+  std::lock_guard<std::mutex> lock(mFlushMutex);
+  while (true) {
+    auto& slot = mSlots[mTail & (CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != mTail + 1) {
+      break;
+    }
+    const auto severity = slot.severity;
+    std::string message(slot.text, slot.size);
+    slot.sequence.store(mTail + CAPACITY, std::memory_order_release);
+    mTail++;
+    mSink(severity, message);
+  }
+
+  const auto dropped = mDropped.load(std::memory_order_relaxed);
+  if (dropped != mDroppedReported) {
+    mSink(InfoLogger::InfoLogger::Warning, std::to_string(dropped - mDroppedReported)
+        + " log messages dropped, the asynchronous log ring was full");
+    mDroppedReported = dropped;
+  }
+}
+
+void AsyncLogger::runFlusher(std::chrono::milliseconds flushInterval)
+{
+  std::unique_lock<std::mutex> lock(mStopMutex);
+  while (!mStop) {
+    mStopCondition.wait_for(lock, flushInterval);
+    lock.unlock();
+    flush();
+    lock.lock();
+  }
+}
+
+} // namespace roc
+} // namespace AliceO2
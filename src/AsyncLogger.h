@@ -0,0 +1,162 @@
+/// \file AsyncLogger.h
+/// \brief Definition of the AsyncLogger and LogRateLimit classes.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_ASYNCLOGGER_H_
+#define ALICEO2_SRC_READOUTCARD_ASYNCLOGGER_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <InfoLogger/InfoLogger.hxx>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Takes log messages off the hot path: posting a message copies it into a slot of a lock-free ring, and a background
+/// thread hands the messages to the sink, in the order they were posted.
+///
+/// Any thread may post. Posting never blocks and never allocates: a message that finds the ring full is dropped and
+/// counted, and the next flush reports the amount dropped, so a flood of messages costs a copy per message and no I/O
+/// on the posting thread. A message longer than MAX_MESSAGE_SIZE takes several slots, and is written as several
+/// messages; if the ring fills up in between, its end is dropped.
+class AsyncLogger
+{
+  public:
+    using Severity = InfoLogger::InfoLogger::Severity;
+
+    /// Writes a message, called from the flusher thread only
+    using Sink = std::function<void(Severity severity, const std::string& message)>;
+
+    /// Amount of messages the ring holds. Must be a power of 2.
+    static constexpr size_t CAPACITY = 256;
+
+    /// Size of the text of a slot in bytes, longer messages are split
+    static constexpr size_t MAX_MESSAGE_SIZE = 500;
+
+    /// Default time between flushes
+    static constexpr std::chrono::milliseconds DEFAULT_FLUSH_INTERVAL {10};
+
+    /// Starts the flusher thread
+    /// \param sink Function the messages are written with
+    /// \param flushInterval Time between flushes, which is how late a message may appear
+    explicit AsyncLogger(Sink sink, std::chrono::milliseconds flushInterval = DEFAULT_FLUSH_INTERVAL);
+
+    /// Stops the flusher thread, and writes the messages still in the ring
+    ~AsyncLogger();
+
+    /// Posts a message
+    /// \return False if the ring was full and the message was dropped
+    bool post(Severity severity, const std::string& message);
+
+    /// Writes the messages in the ring to the sink from the calling thread, without waiting for the flusher
+    void flush();
+
+    /// Gets the amount of messages dropped since the logger was created
+    uint64_t getDropped() const
+    {
+      return mDropped.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Slot
+    {
+        /// Position the slot is free for, or that position + 1 once the message is written
+        std::atomic<uint64_t> sequence;
+        Severity severity;
+        uint32_t size;
+        char text[MAX_MESSAGE_SIZE];
+    };
+
+    /// Posts a part of a message that fits in a slot
+    bool postPart(Severity severity, const char* text, size_t size);
+
+    void runFlusher(std::chrono::milliseconds flushInterval);
+
+    Sink mSink;
+
+    std::array<Slot, CAPACITY> mSlots;
+
+    /// Position of the next message to post
+    std::atomic<uint64_t> mHead {0};
+
+    /// Position of the next message to flush. Guarded by mFlushMutex.
+    uint64_t mTail = 0;
+
+    /// Messages dropped since the logger was created
+    std::atomic<uint64_t> mDropped {0};
+
+    /// Messages dropped that were already reported. Guarded by mFlushMutex.
+    uint64_t mDroppedReported = 0;
+
+    /// Serializes the flushes of the flusher thread and flush()
+    std::mutex mFlushMutex;
+
+    /// Guards mStop
+    std::mutex mStopMutex;
+
+    /// Wakes the flusher thread when it must stop
+    std::condition_variable mStopCondition;
+
+    bool mStop = false;
+
+    std::thread mFlusher;
+};
+
+/// Limits the messages of a log site to a burst per interval, so a misbehaving link can't flood the log. Allowing a
+/// message is a clock read and a few relaxed atomic operations; when the burst is used up near the end of an interval,
+/// a few more may get through.
+class LogRateLimit
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// \param burst Amount of messages allowed per interval
+    /// \param interval Length of the interval
+    explicit LogRateLimit(uint32_t burst = 10, std::chrono::nanoseconds interval = std::chrono::seconds(1))
+        : mBurst(burst), mInterval(interval.count())
+    {
+    }
+
+    /// Checks if the site may log now, and counts the message as suppressed if not
+    bool allow(Clock::time_point now = Clock::now())
+    {
+      const int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+      auto start = mIntervalStart.load(std::memory_order_relaxed);
+      if (time - start >= mInterval && mIntervalStart.compare_exchange_strong(start, time, std::memory_order_relaxed)) {
+        mCount.store(0, std::memory_order_relaxed);
+      }
+      if (mCount.fetch_add(1, std::memory_order_relaxed) < mBurst) {
+        return true;
+      }
+      mSuppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    /// Gets the amount of messages suppressed since the last call, to mention them in the next message that is allowed
+    uint64_t takeSuppressed()
+    {
+      return mSuppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+  private:
+    const uint32_t mBurst;
+    const int64_t mInterval;
+    std::atomic<int64_t> mIntervalStart {std::numeric_limits<int64_t>::min() / 2};
+    std::atomic<uint32_t> mCount {0};
+    std::atomic<uint64_t> mSuppressed {0};
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_ASYNCLOGGER_H_
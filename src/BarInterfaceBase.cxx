@@ -5,6 +5,7 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 #include "BarInterfaceBase.h"
+#include "Pda/PdaBarCache.h"
 #include "Utilities/SmartPointer.h"
 
 namespace AliceO2 {
@@ -19,7 +20,7 @@ BarInterfaceBase::BarInterfaceBase(const Parameters& parameters)
   } else if (auto address = boost::get<PciAddress>(&id)) {
     Utilities::resetSmartPtr(mRocPciDevice, *address);
   }
-  Utilities::resetSmartPtr(mPdaBar, mRocPciDevice->getPciDevice(), mBarIndex);
+  mPdaBar = Pda::PdaBarCache::getBar(mRocPciDevice->getPciDevice(), mRocPciDevice->getPciAddress(), mBarIndex);
 }
 
 BarInterfaceBase::BarInterfaceBase(std::shared_ptr<Pda::PdaBar> bar)
@@ -44,5 +45,23 @@ void BarInterfaceBase::writeRegister(int index, uint32_t value)
   mPdaBar->writeRegister(index, value);
 }
 
+void BarInterfaceBase::readRegisters(int startIndex, uint32_t* values, size_t count)
+{
+  // TODO Access restriction
+  mPdaBar->readRegisterBlock(startIndex, values, count);
+}
+
+void BarInterfaceBase::writeRegisters(int startIndex, const uint32_t* values, size_t count)
+{
+  // TODO Access restriction
+  mPdaBar->writeRegisterBlock(startIndex, values, count);
+}
+
+void BarInterfaceBase::writeRegistersWide(int startIndex, const uint32_t* values, size_t count)
+{
+  // TODO Access restriction
+  mPdaBar->writeRegisterBlockWide(startIndex, values, count);
+}
+
 } // namespace roc
 } // namespace AliceO2
@@ -27,6 +27,9 @@ class BarInterfaceBase: public BarInterface
 
     virtual uint32_t readRegister(int index) override;
     virtual void writeRegister(int index, uint32_t value) override;
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count) override;
+    virtual void writeRegisters(int startIndex, const uint32_t* values, size_t count) override;
+    virtual void writeRegistersWide(int startIndex, const uint32_t* values, size_t count) override;
 
     virtual int getIndex() const override
     {
@@ -91,6 +94,11 @@ class BarInterfaceBase: public BarInterface
       return 0;
     }
 
+    virtual BarStatistics getBarStatistics() override
+    {
+      return mPdaBar->getBarStatistics();
+    }
+
 
 
 
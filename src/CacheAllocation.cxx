@@ -0,0 +1,163 @@
+/// \file CacheAllocation.cxx
+/// \brief Implementation of the CacheAllocation class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/CacheAllocation.h"
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+namespace bfs = boost::filesystem;
+
+/// Register holding the LLC ways DDIO may allocate into
+constexpr off_t IIO_LLC_WAYS_MSR = 0xc8b;
+
+/// Gets the reason of the last failed resctrl write, which the kernel does not give through errno
+std::string getLastCommandStatus(const std::string& resctrlPath)
+{
+  std::ifstream stream(resctrlPath + "/info/last_cmd_status");
+  std::string status;
+  std::getline(stream, status);
+  return status;
+}
+
+/// Writes a string to a resctrl file, in one write as resctrl expects
+void writeResctrlFile(const std::string& resctrlPath, const std::string& path, const std::string& value)
+{
+  std::ofstream stream(path);
+  stream << value << std::flush;
+  if (!stream.good()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not write to resctrl file: "
+        + getLastCommandStatus(resctrlPath))
+        << ErrorInfo::Filename(path));
+  }
+}
+
+/// Adds the value of a monitoring file of every cache domain
+boost::optional<uint64_t> sumMonitoringFiles(const std::string& groupPath, const std::string& fileName)
+{
+  const bfs::path monitoringPath(groupPath + "/mon_data");
+  if (!bfs::is_directory(monitoringPath)) {
+    return {};
+  }
+  boost::optional<uint64_t> sum;
+  for (const auto& domain : bfs::directory_iterator(monitoringPath)) {
+    // Domains without the counter, or without a free monitoring ID, contain "Unavailable"
+    std::ifstream stream((domain.path() / fileName).string());
+    uint64_t value;
+    if (stream >> value) {
+      sum = sum.value_or(0) + value;
+    }
+  }
+  return sum;
+}
+
+} // Anonymous namespace
+
+constexpr const char* CacheAllocation::DEFAULT_RESCTRL_PATH;
+
+CacheAllocation::CacheAllocation(const std::string& name, const std::string& schemata, const std::string& resctrlPath)
+    : mResctrlPath(resctrlPath), mPath(resctrlPath + "/" + name), mCreated(false)
+{
+  if (!isAvailable(resctrlPath)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Cache allocation is not available")
+        << ErrorInfo::Filename(resctrlPath)
+        << ErrorInfo::PossibleCauses({"resctrl is not mounted, mount it with 'mount -t resctrl resctrl "
+            + resctrlPath + "'", "CPU does not support cache allocation (RDT CAT)"}));
+  }
+  if (name.empty() || name.find('/') != std::string::npos) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Invalid cache allocation group name '" + name
+        + "'"));
+  }
+
+  if (!bfs::exists(mPath)) {
+    boost::system::error_code error;
+    bfs::create_directory(mPath, error);
+    if (error) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not create cache allocation group: "
+          + error.message())
+          << ErrorInfo::Filename(mPath)
+          << ErrorInfo::PossibleCauses({"Not running as root", "No free class of service left"}));
+    }
+    mCreated = true;
+  }
+
+  try {
+    writeResctrlFile(resctrlPath, mPath + "/schemata", schemata + "\n");
+  } catch (const Exception&) {
+    if (mCreated) {
+      boost::system::error_code ignored;
+      bfs::remove(mPath, ignored);
+    }
+    throw;
+  }
+}
+
+CacheAllocation::~CacheAllocation()
+{
+  if (mCreated) {
+    // A resctrl group is removed with rmdir, even though it contains files
+    rmdir(mPath.c_str());
+  }
+}
+
+void CacheAllocation::addThread(pid_t threadId)
+{
+  writeResctrlFile(mResctrlPath, mPath + "/tasks", std::to_string(threadId) + "\n");
+}
+
+void CacheAllocation::addCurrentThread()
+{
+  addThread(syscall(SYS_gettid));
+}
+
+void CacheAllocation::joinGroup(const std::string& name, const std::string& resctrlPath)
+{
+  const auto path = resctrlPath + "/" + name;
+  if (!bfs::is_directory(path)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Cache allocation group does not exist")
+        << ErrorInfo::Filename(path));
+  }
+  writeResctrlFile(resctrlPath, path + "/tasks", std::to_string(syscall(SYS_gettid)) + "\n");
+}
+
+auto CacheAllocation::getMonitoring() const -> Monitoring
+{
+  Monitoring monitoring;
+  monitoring.llcOccupancy = sumMonitoringFiles(mPath, "llc_occupancy");
+  monitoring.totalBytes = sumMonitoringFiles(mPath, "mbm_total_bytes");
+  monitoring.localBytes = sumMonitoringFiles(mPath, "mbm_local_bytes");
+  return monitoring;
+}
+
+bool CacheAllocation::isAvailable(const std::string& resctrlPath)
+{
+  return bfs::exists(resctrlPath + "/schemata") && bfs::is_directory(resctrlPath + "/info/L3");
+}
+
+boost::optional<uint32_t> CacheAllocation::getDdioWayMask(int cpu)
+{
+  const auto path = "/dev/cpu/" + std::to_string(cpu) + "/msr";
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return {};
+  }
+  uint64_t value = 0;
+  const bool read = pread(fd, &value, sizeof(value), IIO_LLC_WAYS_MSR) == sizeof(value);
+  close(fd);
+  if (!read) {
+    return {};
+  }
+  return uint32_t(value);
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,55 @@
+/// \file CardChannelGroup.cxx
+/// \brief Implementation of the CardChannelGroup class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/CardChannelGroup.h"
+#include <algorithm>
+#include <string>
+#include "ExceptionInternal.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "RocPciDevice.h"
+
+namespace AliceO2 {
+namespace roc {
+
+CardChannelGroup::CardChannelGroup(int serial, const Parameters& parameters, size_t bufferSize, size_t batchSize)
+    : mGroup(batchSize)
+{
+  auto cards = RocPciDevice::findSystemDevices(serial);
+  if (cards.empty()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not find card") << ErrorInfo::SerialNumber(serial));
+  }
+  std::sort(cards.begin(), cards.end(), [](const CardDescriptor& a, const CardDescriptor& b) {
+    return a.pciAddress.toString() < b.pciAddress.toString();
+  });
+  if (cards.front().numaNode >= 0) {
+    mNumaNode = cards.front().numaNode;
+  }
+
+  const size_t sliceSize = ((bufferSize + HugepagePool::SLICE_ALIGNMENT - 1) / HugepagePool::SLICE_ALIGNMENT)
+      * HugepagePool::SLICE_ALIGNMENT;
+  mPool = std::make_unique<HugepagePool>(sliceSize * cards.size(), "roc-card-group_serial_" + std::to_string(serial),
+      mNumaNode);
+
+  std::vector<Parameters> endpointParameters;
+  for (const auto& card : cards) {
+    auto buffer = mPool->allocate(sliceSize);
+    mEndpoints.push_back({card.pciAddress, buffer});
+    auto endpoint = parameters;
+    endpoint.setCardId(card.pciAddress);
+    endpoint.setBufferParameters(buffer);
+    endpointParameters.push_back(endpoint);
+  }
+
+  for (auto& channel : ChannelFactory().getDmaChannels(endpointParameters)) {
+    mGroup.addChannel(std::move(channel));
+  }
+}
+
+CardChannelGroup::~CardChannelGroup()
+{
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -15,6 +15,7 @@ static const auto converter = Utilities::makeEnumConverter<CardType::type>("Card
   { CardType::Crorc,   "CRORC" },
   { CardType::Cru,     "CRU" },
   { CardType::Dummy,   "DUMMY" },
+  { CardType::Simulated, "SIMULATED" },
 });
 
 } // Anonymous namespace
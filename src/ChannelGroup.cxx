@@ -0,0 +1,65 @@
+/// \file ChannelGroup.cxx
+/// \brief Implementation of the ChannelGroup class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/ChannelGroup.h"
+#include <exception>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+
+constexpr size_t ChannelGroup::DEFAULT_BATCH_SIZE;
+
+ChannelGroup::ChannelGroup(size_t batchSize)
+    : mBatch(batchSize)
+{
+  if (batchSize == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Channel group batch size must be larger than 0"));
+  }
+}
+
+size_t ChannelGroup::addChannel(std::shared_ptr<DmaChannelInterface> channel)
+{
+  if (!channel) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not add channel to group, channel was null"));
+  }
+  mChannels.push_back(std::move(channel));
+  return mChannels.size() - 1;
+}
+
+void ChannelGroup::startDma()
+{
+  for (const auto& channel : mChannels) {
+    channel->startDma();
+  }
+}
+
+void ChannelGroup::prepareDma()
+{
+  for (const auto& channel : mChannels) {
+    channel->prepareDma();
+  }
+}
+
+void ChannelGroup::stopDma()
+{
+  std::exception_ptr exception;
+  for (const auto& channel : mChannels) {
+    try {
+      channel->stopDma();
+    }
+    catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+} // namespace roc
+} // namespace AliceO2
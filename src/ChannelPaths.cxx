@@ -34,6 +34,11 @@ std::string ChannelPaths::fifo() const
   return makePath("_fifo", DIR_SHAREDMEM);
 }
 
+std::string ChannelPaths::statistics() const
+{
+  return makePath("_statistics", DIR_SHAREDMEM);
+}
+
 std::string ChannelPaths::namedMutex() const
 {
   return b::str(b::format("AliceO2_RoC_%s_Channel_%i_Mutex") % mPciAddress.toString() % mChannel);
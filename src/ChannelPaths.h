@@ -30,6 +30,10 @@ class ChannelPaths
     /// \return The path
     std::string fifo() const;
 
+    /// Generates a path for the channel's shared-memory statistics table, see ChannelStatisticsTable
+    /// \return The path
+    std::string statistics() const;
+
     /// Generates a name for the channel's mutex
     /// \return The name
     std::string namedMutex() const;
@@ -0,0 +1,152 @@
+/// \file ChannelStatisticsCounters.h
+/// \brief Definition of the ChannelStatisticsCounters class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_CHANNELSTATISTICSCOUNTERS_H_
+#define ALICEO2_SRC_READOUTCARD_CHANNELSTATISTICSCOUNTERS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "ReadoutCard/ChannelStatistics.h"
+#include "ReadoutCard/ChannelStatisticsTable.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Counters behind DmaChannelInterface::getStatistics().
+/// They are updated by the thread driving the channel with relaxed atomic operations, so they are cheap enough for
+/// the hot path, and can be read from any other thread. They live in a ChannelStatisticsTable, either its own or one
+/// in shared memory that other processes read, and every update is a write of the table's sequence lock, so a snapshot
+/// never has the superpages of a link without their bytes.
+class ChannelStatisticsCounters
+{
+  public:
+    /// Highest link ID that can be counted, plus one
+    static constexpr size_t MAX_LINKS = ChannelStatisticsTable::MAX_LINKS;
+
+    /// \param table Table to keep the counters in, which is reset, or nullptr to keep them in a table of its own
+    explicit ChannelStatisticsCounters(ChannelStatisticsTable* table = nullptr)
+        : mTable(table ? table : &mOwnTable)
+    {
+      if (!table) {
+        mOwnTable.sequence.store(0, std::memory_order_relaxed);
+      }
+      mTable->reset();
+    }
+
+    /// Marks a shared table as closed, its last values stay readable
+    ~ChannelStatisticsCounters()
+    {
+      mTable->open.store(0, std::memory_order_relaxed);
+    }
+
+    ChannelStatisticsCounters(const ChannelStatisticsCounters&) = delete;
+    ChannelStatisticsCounters& operator=(const ChannelStatisticsCounters&) = delete;
+
+    /// Registers a link, so it is included in the statistics
+    void addLink(uint32_t linkId)
+    {
+      if (linkId >= MAX_LINKS) {
+        throw std::out_of_range("Link ID too high for the channel statistics");
+      }
+      mTable->beginWrite();
+      mTable->linkMask.store(mTable->linkMask.load(std::memory_order_relaxed) | (uint32_t(1) << linkId),
+          std::memory_order_relaxed);
+      mTable->endWrite();
+    }
+
+    /// Counts an arrived superpage
+    void superpageArrived(uint32_t linkId, size_t bytes)
+    {
+      auto& link = mTable->links[linkId];
+      mTable->beginWrite();
+      increment(link.superpages, 1);
+      increment(link.bytes, bytes);
+      mTable->endWrite();
+    }
+
+    /// Updates the transfer queue size and high-water mark
+    void transferQueueSize(size_t size)
+    {
+      mTable->beginWrite();
+      mTable->transferQueueSize.store(size, std::memory_order_relaxed);
+      updateMaximum(mTable->transferQueueHighWater, size);
+      mTable->endWrite();
+    }
+
+    /// Updates the ready queue size and high-water mark
+    void readyQueueSize(size_t size)
+    {
+      mTable->beginWrite();
+      mTable->readyQueueSize.store(size, std::memory_order_relaxed);
+      updateMaximum(mTable->readyQueueHighWater, size);
+      mTable->endWrite();
+    }
+
+    /// Counts a fillSuperpages() call that found no new superpages
+    void emptyFill()
+    {
+      mTable->beginWrite();
+      increment(mTable->emptyFills, 1);
+      mTable->endWrite();
+    }
+
+    /// Counts a full ready queue
+    /// \param superpagesLeft Amount of arrived superpages that had to be left on the card because of it
+    void readyQueueFull(size_t superpagesLeft)
+    {
+      mTable->beginWrite();
+      increment(mTable->readyQueueFull, 1);
+      increment(mTable->superpagesLeftOnCard, superpagesLeft);
+      mTable->endWrite();
+    }
+
+    /// Counts a superpage given back to the card unread to make room in the ready queue
+    void superpageDropped()
+    {
+      mTable->beginWrite();
+      increment(mTable->superpagesDropped, 1);
+      mTable->endWrite();
+    }
+
+    /// Counts a recovery of the channel
+    void recovered()
+    {
+      mTable->beginWrite();
+      increment(mTable->recoveries, 1);
+      mTable->endWrite();
+    }
+
+    /// Makes a snapshot of the counters
+    ChannelStatistics get() const
+    {
+      return mTable->read();
+    }
+
+  private:
+    using Counter = ChannelStatisticsTable::Counter;
+
+    /// There is a single writer, so a load and store is enough, and cheaper than a locked read-modify-write
+    static void increment(Counter& counter, uint64_t amount)
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void updateMaximum(Counter& counter, uint64_t value)
+    {
+      if (value > counter.load(std::memory_order_relaxed)) {
+        counter.store(value, std::memory_order_relaxed);
+      }
+    }
+
+    ChannelStatisticsTable mOwnTable;
+    ChannelStatisticsTable* mTable;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_CHANNELSTATISTICSCOUNTERS_H_
@@ -0,0 +1,72 @@
+/// \file ChannelStatisticsTable.cxx
+/// \brief Implementation of the ChannelStatisticsTable struct.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/ChannelStatisticsTable.h"
+#include "ChannelPaths.h"
+
+namespace AliceO2 {
+namespace roc {
+
+constexpr uint64_t ChannelStatisticsTable::MAGIC;
+constexpr uint32_t ChannelStatisticsTable::VERSION;
+constexpr size_t ChannelStatisticsTable::MAX_LINKS;
+
+std::string ChannelStatisticsTable::getPath(const PciAddress& pciAddress, int channel)
+{
+  return ChannelPaths(pciAddress, channel).statistics();
+}
+
+void ChannelStatisticsTable::reset()
+{
+  // A table left by an earlier channel keeps its sequence, so its readers don't mistake the reset for a stable copy
+  beginWrite();
+  version = VERSION;
+  linkMask.store(0, std::memory_order_relaxed);
+  for (auto& link : links) {
+    link.superpages.store(0, std::memory_order_relaxed);
+    link.bytes.store(0, std::memory_order_relaxed);
+  }
+  for (auto counter : {&transferQueueSize, &readyQueueSize, &transferQueueHighWater, &readyQueueHighWater,
+      &emptyFills, &readyQueueFull, &superpagesLeftOnCard, &superpagesDropped, &recoveries}) {
+    counter->store(0, std::memory_order_relaxed);
+  }
+  open.store(1, std::memory_order_relaxed);
+  endWrite();
+  magic.store(MAGIC, std::memory_order_release);
+}
+
+ChannelStatistics ChannelStatisticsTable::read() const
+{
+  ChannelStatistics statistics;
+  while (true) {
+    auto before = sequence.load(std::memory_order_acquire);
+    if (before % 2 == 0) {
+      statistics.links.clear();
+      const auto mask = linkMask.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < MAX_LINKS; ++i) {
+        if (mask & (uint32_t(1) << i)) {
+          statistics.links.push_back({uint32_t(i), links[i].superpages.load(std::memory_order_relaxed),
+              links[i].bytes.load(std::memory_order_relaxed)});
+        }
+      }
+      statistics.transferQueueSize = transferQueueSize.load(std::memory_order_relaxed);
+      statistics.readyQueueSize = readyQueueSize.load(std::memory_order_relaxed);
+      statistics.transferQueueHighWater = transferQueueHighWater.load(std::memory_order_relaxed);
+      statistics.readyQueueHighWater = readyQueueHighWater.load(std::memory_order_relaxed);
+      statistics.emptyFills = emptyFills.load(std::memory_order_relaxed);
+      statistics.readyQueueFull = readyQueueFull.load(std::memory_order_relaxed);
+      statistics.superpagesLeftOnCard = superpagesLeftOnCard.load(std::memory_order_relaxed);
+      statistics.superpagesDropped = superpagesDropped.load(std::memory_order_relaxed);
+      statistics.recoveries = recoveries.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        return statistics;
+      }
+    }
+  }
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,202 @@
+/// \file ClockCorrelator.cxx
+/// \brief Implementation of the ClockCorrelator class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/ClockCorrelator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <time.h>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Longest the background thread sleeps before checking if it must stop
+constexpr auto STOP_CHECK_INTERVAL = std::chrono::milliseconds(10);
+
+} // Anonymous namespace
+
+ClockCorrelator::ClockCorrelator(ReadCounter readCounter, const Options& options)
+    : mReadCounter(std::move(readCounter)), mOptions(options)
+{
+  if (!(mOptions.frequency > 0)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Clock frequency must be positive"));
+  }
+  if (mOptions.counterBits < 1 || mOptions.counterBits > 64) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Clock counter width must be 1 to 64 bits"));
+  }
+  if (mOptions.readsPerSample == 0 || mOptions.window == 0) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Clock reads per sample and sample window must be greater than 0"));
+  }
+  mCounterMask = mOptions.counterBits == 64 ? ~uint64_t(0) : (uint64_t(1) << mOptions.counterBits) - 1;
+  mNanosecondsPerTick = 1e9 / mOptions.frequency;
+}
+
+ClockCorrelator::~ClockCorrelator()
+{
+  stop();
+}
+
+void ClockCorrelator::start()
+{
+  if (mThread.joinable()) {
+    return;
+  }
+  mStop = false;
+  mThread = std::thread([this]{ sampleLoop(); });
+}
+
+void ClockCorrelator::stop()
+{
+  mStop = true;
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+}
+
+void ClockCorrelator::sampleLoop()
+{
+  while (!mStop.load(std::memory_order_relaxed)) {
+    sample();
+    auto wakeUp = std::chrono::steady_clock::now() + mOptions.interval;
+    while (!mStop.load(std::memory_order_relaxed) && std::chrono::steady_clock::now() < wakeUp) {
+      std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(STOP_CHECK_INTERVAL,
+          wakeUp - std::chrono::steady_clock::now()));
+    }
+  }
+}
+
+void ClockCorrelator::sample()
+{
+  Sample best = {0, 0, std::numeric_limits<int64_t>::max()};
+  for (size_t i = 0; i < mOptions.readsPerSample; ++i) {
+    Sample sample;
+    sample.hostBefore = getHostTime();
+    sample.counter = mReadCounter();
+    sample.hostAfter = getHostTime();
+    if (i == 0 || (sample.hostAfter - sample.hostBefore) < (best.hostAfter - best.hostBefore)) {
+      best = sample;
+    }
+  }
+  addSample(best);
+}
+
+void ClockCorrelator::addSample(const Sample& sample)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  Point point;
+  point.counter = mPoints.empty() ? (sample.counter & mCounterMask)
+      : unwrap(sample.counter & mCounterMask, mPoints.back().counter);
+  point.host = sample.hostBefore + (sample.hostAfter - sample.hostBefore) / 2;
+  mPoints.push_back(point);
+  while (mPoints.size() > mOptions.window) {
+    mPoints.pop_front();
+  }
+  mSampleCount++;
+  fit();
+}
+
+uint64_t ClockCorrelator::unwrap(uint64_t counter, uint64_t near) const
+{
+  if (mOptions.counterBits == 64) {
+    return counter;
+  }
+  const uint64_t range = mCounterMask + 1;
+  uint64_t difference = (counter - near) & mCounterMask;
+  if (difference >= range / 2) {
+    // Before the value it's near
+    return near - (range - difference);
+  }
+  return near + difference;
+}
+
+void ClockCorrelator::fit()
+{
+  // The line goes through the latest point's counter value, so the conversion of recent timestamps is exact in double
+  const auto& last = mPoints.back();
+  const double n = double(mPoints.size());
+  double sumX = 0;
+  double sumY = 0;
+  for (const auto& point : mPoints) {
+    sumX += double(int64_t(point.counter - last.counter));
+    sumY += double(point.host - last.host);
+  }
+  const double meanX = sumX / n;
+  const double meanY = sumY / n;
+  double covariance = 0;
+  double variance = 0;
+  for (const auto& point : mPoints) {
+    const double x = double(int64_t(point.counter - last.counter)) - meanX;
+    const double y = double(point.host - last.host) - meanY;
+    covariance += x * y;
+    variance += x * x;
+  }
+
+  // Until the counter has moved, the nominal frequency is all there is
+  const double slope = (variance > 0 && covariance > 0) ? covariance / variance : 1e9 / mOptions.frequency;
+  const double intercept = meanY - slope * meanX;
+  double squares = 0;
+  for (const auto& point : mPoints) {
+    const double x = double(int64_t(point.counter - last.counter));
+    const double residual = double(point.host - last.host) - (intercept + slope * x);
+    squares += residual * residual;
+  }
+
+  mCounter = last.counter;
+  mHost = last.host + int64_t(std::llround(intercept));
+  mNanosecondsPerTick = slope;
+  mResidual = std::sqrt(squares / n);
+}
+
+bool ClockCorrelator::isValid() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return !mPoints.empty();
+}
+
+int64_t ClockCorrelator::toHostTime(uint64_t counter) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mPoints.empty()) {
+    return 0;
+  }
+  const auto ticks = int64_t(unwrap(counter & mCounterMask, mCounter) - mCounter);
+  return mHost + int64_t(std::llround(double(ticks) * mNanosecondsPerTick));
+}
+
+double ClockCorrelator::getFrequency() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return 1e9 / mNanosecondsPerTick;
+}
+
+double ClockCorrelator::getDriftPpm() const
+{
+  return (getFrequency() / mOptions.frequency - 1.0) * 1e6;
+}
+
+double ClockCorrelator::getResidual() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mResidual;
+}
+
+uint64_t ClockCorrelator::getSampleCount() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mSampleCount;
+}
+
+int64_t ClockCorrelator::getHostTime()
+{
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return int64_t(time.tv_sec) * 1000 * 1000 * 1000 + time.tv_nsec;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -7,7 +7,9 @@
 #define ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_H
 
 #include <string>
+#include <sstream>
 #include <functional>
+#include <vector>
 #include <dim/dim.hxx>
 #include <dim/dis.hxx>
 #include <dim/dic.hxx>
@@ -16,6 +18,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/format.hpp>
 #include "AlfException.h"
+#include "BinaryRpc.h"
 #include "Sca.h"
 
 namespace AliceO2 {
@@ -131,6 +134,24 @@ class DimRpcInfoWrapper
       return string;
     }
 
+    void setBlob(std::vector<char>& buffer)
+    {
+      setDataBuffer(buffer, getDimRpcInfo());
+    }
+
+    /// Gets the response of a binary RPC
+    /// \param allowScaError Return the response of an SCA sequence that stopped at an SCA error instead of throwing
+    template <typename T>
+    BinaryRpc::Response<T> getBinaryResponse(bool allowScaError = false)
+    {
+      auto response = BinaryRpc::parseResponse<T>(mRpcInfo->getData(), mRpcInfo->getSize());
+      if (response.status != BinaryRpc::SUCCESS && !(allowScaError && response.status == BinaryRpc::SCA_ERROR)) {
+        BOOST_THROW_EXCEPTION(
+          AlfException() << ErrorInfo::Message("ALF server failure: " + response.message));
+      }
+      return response;
+    }
+
     template <typename T>
     std::vector<T> getBlob()
     {
@@ -162,7 +183,7 @@ class PublishRegistersStartRpc : DimRpcInfoWrapper
       auto sep = argumentSeparator();
       stream << dnsName << sep << interval;
       for (size_t i = 0; i < addresses.size(); ++i) {
-        stream << sep << addresses[i];
+        stream << sep << "0x" << std::hex << addresses[i] << std::dec;
       }
       printf("Publish: %s\n", stream.str().c_str());
       setString(stream.str());
@@ -192,6 +213,25 @@ class PublishScaSequenceStartRpc : DimRpcInfoWrapper
     }
 };
 
+class PublishChannelStatisticsStartRpc : DimRpcInfoWrapper
+{
+  public:
+    PublishChannelStatisticsStartRpc(const std::string& serviceName)
+      : DimRpcInfoWrapper(serviceName)
+    {
+    }
+
+    void publish(std::string dnsName, double interval, int dmaChannel)
+    {
+      std::ostringstream stream;
+      auto sep = argumentSeparator();
+      stream << dnsName << sep << interval << sep << dmaChannel;
+      printf("Publish channel statistics: %s\n", stream.str().c_str());
+      setString(stream.str());
+      getString();
+    }
+};
+
 class PublishRegistersStopRpc: DimRpcInfoWrapper
 {
   public:
@@ -222,6 +262,21 @@ class PublishScaSequenceStopRpc: DimRpcInfoWrapper
     }
 };
 
+class PublishChannelStatisticsStopRpc: DimRpcInfoWrapper
+{
+  public:
+    PublishChannelStatisticsStopRpc(const std::string &serviceName)
+      : DimRpcInfoWrapper(serviceName)
+    {
+    }
+
+    void stop(std::string dnsName)
+    {
+      setString(dnsName);
+      getString();
+    }
+};
+
 class RegisterReadRpc: DimRpcInfoWrapper
 {
   public:
@@ -237,6 +292,81 @@ class RegisterReadRpc: DimRpcInfoWrapper
     }
 };
 
+class RegisterReadBlockRpc: DimRpcInfoWrapper
+{
+  public:
+    RegisterReadBlockRpc(const std::string& serviceName)
+        : DimRpcInfoWrapper(serviceName)
+    {
+    }
+
+    /// Reads a list of registers in one call
+    std::vector<uint32_t> readRegisters(const std::vector<uint64_t>& registerAddresses)
+    {
+      std::ostringstream stream;
+      for (size_t i = 0; i < registerAddresses.size(); ++i) {
+        stream << (i == 0 ? "" : argumentSeparator()) << "0x" << std::hex << registerAddresses[i];
+      }
+      setString(stream.str());
+      return parseValues(stripPrefix(getString()));
+    }
+
+    /// Reads a range of consecutive registers in one call
+    std::vector<uint32_t> readRegisterRange(uint64_t startAddress, size_t count)
+    {
+      setString((boost::format("0x%x%s%d") % startAddress % scaPairSeparator() % count).str());
+      return parseValues(stripPrefix(getString()));
+    }
+
+  private:
+    static std::vector<uint32_t> parseValues(const std::string& string)
+    {
+      std::vector<uint32_t> values;
+      std::istringstream stream(string);
+      std::string line;
+      while (std::getline(stream, line)) {
+        if (!line.empty()) {
+          values.push_back(convertHexString(line));
+        }
+      }
+      return values;
+    }
+};
+
+/// Binary variant of RegisterReadBlockRpc, see BinaryRpc.h
+class RegisterReadBinaryRpc: DimRpcInfoWrapper
+{
+  public:
+    RegisterReadBinaryRpc(const std::string& serviceName)
+        : DimRpcInfoWrapper(serviceName)
+    {
+    }
+
+    std::vector<uint32_t> readRegisters(const std::vector<uint32_t>& registerAddresses)
+    {
+      auto request = BinaryRpc::makeRequest(registerAddresses);
+      setBlob(request);
+      return getBinaryResponse<uint32_t>().entries;
+    }
+};
+
+/// Binary variant of RegisterWriteRpc, which writes several registers in one call, see BinaryRpc.h
+class RegisterWriteBinaryRpc: DimRpcInfoWrapper
+{
+  public:
+    RegisterWriteBinaryRpc(const std::string& serviceName)
+        : DimRpcInfoWrapper(serviceName)
+    {
+    }
+
+    void writeRegisters(const std::vector<BinaryRpc::RegisterWrite>& writes)
+    {
+      auto request = BinaryRpc::makeRequest(writes);
+      setBlob(request);
+      getBinaryResponse<uint32_t>();
+    }
+};
+
 class RegisterWriteRpc: DimRpcInfoWrapper
 {
   public:
@@ -339,6 +469,29 @@ class ScaWriteSequence: DimRpcInfoWrapper
     }
 };
 
+/// Binary variant of ScaWriteSequence, see BinaryRpc.h
+class ScaSequenceBinaryRpc: DimRpcInfoWrapper
+{
+  public:
+    ScaSequenceBinaryRpc(const std::string& serviceName)
+      : DimRpcInfoWrapper(serviceName)
+    {
+    }
+
+    /// Executes the sequence. If it stopped at an SCA error, the results go up to it and the error is set.
+    Sca::SequenceResult write(const std::vector<Sca::CommandData>& sequence)
+    {
+      auto request = BinaryRpc::makeRequest(sequence);
+      setBlob(request);
+      auto response = getBinaryResponse<Sca::ReadResult>(true);
+      Sca::SequenceResult result;
+      result.results = std::move(response.entries);
+      if (response.status == BinaryRpc::SCA_ERROR) {
+        result.error = response.message;
+      }
+      return result;
+    }
+};
 
 } // namespace Alf
 } // namespace CommandLineUtilities
@@ -0,0 +1,316 @@
+/// \file AsyncClient.h
+/// \brief Definition of the asynchronous ALICE Lowlevel Frontend (ALF) client
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_ASYNCCLIENT_H
+#define ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_ASYNCCLIENT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <dim/dic.hxx>
+#include "AliceLowlevelFrontend.h"
+#include "BinaryRpc.h"
+#include "Sca.h"
+#include "ServiceNames.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace Alf {
+
+/// Client that keeps many RPCs in flight, so configuring many links is bounded by the server and the cards instead of
+/// the round-trip time of every RPC.
+///
+/// A DIM RPC object has one call in flight at a time, so the client keeps up to a maximum of them per service, and
+/// queues the calls beyond that. The answers arrive on the DIM thread, which completes the futures and sends the next
+/// queued call. Register reads and writes are batched per link: they are held until flush(), and then sent as one
+/// binary RPC per link, see BinaryRpc.h. SCA sequences are sent right away; the server runs the sequences of different
+/// links in parallel, and those of a link in order.
+class AsyncClient
+{
+  public:
+    /// Called with the response data and size. Runs on the DIM thread, so it must not block.
+    using Callback = std::function<void(const void* data, size_t size)>;
+
+    static constexpr size_t DEFAULT_MAX_IN_FLIGHT = 8;
+
+    /// \param maxInFlight Maximum amount of calls in flight per service
+    explicit AsyncClient(size_t maxInFlight = DEFAULT_MAX_IN_FLIGHT) : mMaxInFlight(maxInFlight)
+    {
+    }
+
+    /// Waits for the calls in flight, the queued ones are not sent
+    ~AsyncClient()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto& kv : mServices) {
+          mOutstanding -= kv.second.queue.size();
+          kv.second.queue.clear();
+        }
+      }
+      waitAll();
+    }
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    /// Calls a string RPC
+    /// \return Future of the return value without the success prefix. It holds an AlfException if the call failed.
+    std::future<std::string> call(const std::string& serviceName, const std::string& parameter)
+    {
+      auto promise = std::make_shared<std::promise<std::string>>();
+      auto buffer = toCharBuffer(parameter);
+      send(serviceName, std::move(buffer), [promise](const void* data, size_t size) {
+        try {
+          std::string string(static_cast<const char*>(data), strnlen(static_cast<const char*>(data), size));
+          if (!isSuccess(string)) {
+            BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("ALF server failure: " + string));
+          }
+          promise->set_value(stripPrefix(string));
+        } catch (...) {
+          promise->set_exception(std::current_exception());
+        }
+      });
+      return promise->get_future();
+    }
+
+    /// Calls an RPC with a raw request, for the binary RPCs
+    void send(const std::string& serviceName, std::vector<char> request, Callback callback)
+    {
+      Slot* slot = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mOutstanding++;
+        auto& service = mServices[serviceName];
+        if (!service.idle.empty()) {
+          slot = service.idle.back();
+          service.idle.pop_back();
+        } else if (service.slots.size() < mMaxInFlight) {
+          service.slots.push_back(std::make_unique<Slot>(*this, serviceName));
+          slot = service.slots.back().get();
+        } else {
+          service.queue.push_back({std::move(request), std::move(callback)});
+          return;
+        }
+      }
+      slot->start({std::move(request), std::move(callback)});
+    }
+
+    /// Reads a register. It is sent with the other register reads of the link by the next flush().
+    std::future<uint32_t> readRegister(int serial, int link, uint32_t address)
+    {
+      auto promise = std::make_shared<std::promise<uint32_t>>();
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto& batch = mReadBatches[ServiceNames(serial, link).registerReadBinaryRpc()];
+      batch.addresses.push_back(address);
+      batch.promises.push_back(promise);
+      return promise->get_future();
+    }
+
+    /// Writes a register. It is sent with the other register writes of the link by the next flush(), in order.
+    std::future<void> writeRegister(int serial, int link, uint32_t address, uint32_t value)
+    {
+      auto promise = std::make_shared<std::promise<void>>();
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto& batch = mWriteBatches[ServiceNames(serial, link).registerWriteBinaryRpc()];
+      batch.writes.push_back({address, value});
+      batch.promises.push_back(promise);
+      return promise->get_future();
+    }
+
+    /// Executes an SCA sequence
+    /// \return Future of the results, up to the SCA error if there was one
+    std::future<Sca::SequenceResult> scaSequence(int serial, int link, const std::vector<Sca::CommandData>& sequence)
+    {
+      auto promise = std::make_shared<std::promise<Sca::SequenceResult>>();
+      send(ServiceNames(serial, link).scaSequenceBinary(), BinaryRpc::makeRequest(sequence),
+        [promise](const void* data, size_t size) {
+          try {
+            auto response = BinaryRpc::parseResponse<Sca::ReadResult>(data, size);
+            throwOnFailure(response, true);
+            Sca::SequenceResult result;
+            result.results = std::move(response.entries);
+            if (response.status == BinaryRpc::SCA_ERROR) {
+              result.error = response.message;
+            }
+            promise->set_value(std::move(result));
+          } catch (...) {
+            promise->set_exception(std::current_exception());
+          }
+        });
+      return promise->get_future();
+    }
+
+    /// Sends the batched register reads and writes. A link's writes are sent before its reads.
+    void flush()
+    {
+      std::map<std::string, WriteBatch> writeBatches;
+      std::map<std::string, ReadBatch> readBatches;
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        writeBatches.swap(mWriteBatches);
+        readBatches.swap(mReadBatches);
+      }
+
+      for (auto& kv : writeBatches) {
+        auto promises = std::move(kv.second.promises);
+        send(kv.first, BinaryRpc::makeRequest(kv.second.writes), [promises](const void* data, size_t size) {
+          try {
+            throwOnFailure(BinaryRpc::parseResponse<uint32_t>(data, size));
+            for (auto& promise : promises) {
+              promise->set_value();
+            }
+          } catch (...) {
+            for (auto& promise : promises) {
+              promise->set_exception(std::current_exception());
+            }
+          }
+        });
+      }
+
+      for (auto& kv : readBatches) {
+        auto promises = std::move(kv.second.promises);
+        send(kv.first, BinaryRpc::makeRequest(kv.second.addresses), [promises](const void* data, size_t size) {
+          try {
+            auto response = BinaryRpc::parseResponse<uint32_t>(data, size);
+            throwOnFailure(response);
+            if (response.entries.size() != promises.size()) {
+              BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("ALF server returned wrong amount of values"));
+            }
+            for (size_t i = 0; i < promises.size(); ++i) {
+              promises[i]->set_value(response.entries[i]);
+            }
+          } catch (...) {
+            for (auto& promise : promises) {
+              promise->set_exception(std::current_exception());
+            }
+          }
+        });
+      }
+    }
+
+    /// Flushes, and waits until every call was answered
+    void waitAll()
+    {
+      flush();
+      std::unique_lock<std::mutex> lock(mMutex);
+      mDone.wait(lock, [&]{ return mOutstanding == 0; });
+    }
+
+  private:
+    struct Request
+    {
+        std::vector<char> data;
+        Callback callback;
+    };
+
+    /// An RPC object with at most one call in flight
+    class Slot: public DimRpcInfo
+    {
+      public:
+        Slot(AsyncClient& client, const std::string& serviceName)
+          : DimRpcInfo(serviceName.c_str(), toCharBuffer("").data()), mClient(client), mServiceName(serviceName)
+        {
+        }
+
+        void start(Request request)
+        {
+          mRequest = std::move(request);
+          setData(mRequest.data.data(), mRequest.data.size());
+        }
+
+      private:
+        /// Called by DIM with the answer, or with the no-link value if the server is gone
+        void rpcInfoHandler() override
+        {
+          auto data = static_cast<const char*>(getData());
+          std::vector<char> response(data, data + getSize());
+          auto callback = std::move(mRequest.callback);
+          mClient.next(*this);
+          callback(response.data(), response.size());
+          mClient.finished();
+        }
+
+        AsyncClient& mClient;
+        std::string mServiceName;
+        Request mRequest;
+        friend class AsyncClient;
+    };
+
+    struct Service
+    {
+        std::vector<std::unique_ptr<Slot>> slots;
+        std::vector<Slot*> idle;
+        std::deque<Request> queue;
+    };
+
+    struct ReadBatch
+    {
+        std::vector<uint32_t> addresses;
+        std::vector<std::shared_ptr<std::promise<uint32_t>>> promises;
+    };
+
+    struct WriteBatch
+    {
+        std::vector<BinaryRpc::RegisterWrite> writes;
+        std::vector<std::shared_ptr<std::promise<void>>> promises;
+    };
+
+    template <typename T>
+    static void throwOnFailure(const BinaryRpc::Response<T>& response, bool allowScaError = false)
+    {
+      if (response.status != BinaryRpc::SUCCESS && !(allowScaError && response.status == BinaryRpc::SCA_ERROR)) {
+        BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("ALF server failure: " + response.message));
+      }
+    }
+
+    /// Gives a slot whose call was answered the next queued call of its service, or makes it idle
+    void next(Slot& slot)
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      auto& service = mServices[slot.mServiceName];
+      if (service.queue.empty()) {
+        service.idle.push_back(&slot);
+        return;
+      }
+      auto request = std::move(service.queue.front());
+      service.queue.pop_front();
+      lock.unlock();
+      slot.start(std::move(request));
+    }
+
+    void finished()
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (--mOutstanding == 0) {
+        mDone.notify_all();
+      }
+    }
+
+    const size_t mMaxInFlight;
+    std::mutex mMutex;
+    std::condition_variable mDone;
+    /// Calls sent or queued, and not yet answered
+    size_t mOutstanding = 0;
+    std::map<std::string, Service> mServices;
+    std::map<std::string, ReadBatch> mReadBatches;
+    std::map<std::string, WriteBatch> mWriteBatches;
+};
+
+} // namespace Alf
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_ASYNCCLIENT_H
@@ -0,0 +1,139 @@
+/// \file BinaryRpc.h
+/// \brief Definition of the fixed-layout payloads of the binary ALICE Lowlevel Frontend (ALF) RPCs
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_BINARYRPC_H
+#define ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_BINARYRPC_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "AlfException.h"
+#include "Sca.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace Alf {
+
+/// The binary RPCs take an array of fixed-size entries, and return a ResponseHeader followed by an array of entries and
+/// a message. Everything is made of 32-bit words (DIM format "I"), so nothing is parsed or formatted per call.
+namespace BinaryRpc {
+
+enum Status : uint32_t
+{
+  SUCCESS = 0,
+  /// The request failed, the message says why
+  FAILURE = 1,
+  /// An SCA sequence stopped at an SCA error: the entries are the results up to it, the message is the error
+  SCA_ERROR = 2,
+};
+
+/// Leads every response
+struct ResponseHeader
+{
+    uint32_t status;
+    /// Amount of entries following the header
+    uint32_t count;
+    /// Size of the message following the entries in bytes, without padding to a word
+    uint32_t messageSize;
+};
+
+/// Entry of a REGISTER_WRITE_BINARY request
+struct RegisterWrite
+{
+    uint32_t address;
+    uint32_t value;
+};
+
+static_assert(sizeof(Sca::CommandData) == 8 && sizeof(Sca::ReadResult) == 8, "SCA entries must be two words");
+
+inline size_t roundUpToWord(size_t size)
+{
+  return (size + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+}
+
+/// Gets the entries of a request
+template <typename T>
+std::vector<T> parseRequest(const void* data, size_t size)
+{
+  if (size % sizeof(T) != 0) {
+    BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("Binary RPC request is not a whole number of entries"));
+  }
+  std::vector<T> entries(size / sizeof(T));
+  if (size > 0) {
+    std::memcpy(entries.data(), data, size);
+  }
+  return entries;
+}
+
+/// Makes a request of entries
+template <typename T>
+std::vector<char> makeRequest(const std::vector<T>& entries)
+{
+  std::vector<char> buffer(entries.size() * sizeof(T));
+  if (!buffer.empty()) {
+    std::memcpy(buffer.data(), entries.data(), buffer.size());
+  }
+  return buffer;
+}
+
+/// Makes a response of entries and a message
+template <typename T>
+std::vector<char> makeResponse(Status status, const std::vector<T>& entries, const std::string& message = "")
+{
+  ResponseHeader header {status, uint32_t(entries.size()), uint32_t(message.size())};
+  const size_t entriesSize = entries.size() * sizeof(T);
+  std::vector<char> buffer(sizeof(header) + entriesSize + roundUpToWord(message.size()), '\0');
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  if (entriesSize > 0) {
+    std::memcpy(buffer.data() + sizeof(header), entries.data(), entriesSize);
+  }
+  message.copy(buffer.data() + sizeof(header) + entriesSize, message.size());
+  return buffer;
+}
+
+/// Makes a failure response
+inline std::vector<char> makeFailResponse(const std::string& message)
+{
+  return makeResponse(FAILURE, std::vector<uint32_t>(), message);
+}
+
+template <typename T>
+struct Response
+{
+    Status status;
+    std::vector<T> entries;
+    std::string message;
+};
+
+/// Gets the entries and message of a response
+template <typename T>
+Response<T> parseResponse(const void* data, size_t size)
+{
+  ResponseHeader header;
+  if (size < sizeof(header)) {
+    BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("Binary RPC response too short, no ALF server?"));
+  }
+  std::memcpy(&header, data, sizeof(header));
+  const size_t entriesSize = size_t(header.count) * sizeof(T);
+  if (size < sizeof(header) + entriesSize + header.messageSize) {
+    BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("Binary RPC response shorter than its header says"));
+  }
+  auto bytes = static_cast<const char*>(data) + sizeof(header);
+  Response<T> response;
+  response.status = Status(header.status);
+  response.entries = parseRequest<T>(bytes, entriesSize);
+  response.message.assign(bytes + entriesSize, header.messageSize);
+  return response;
+}
+
+} // namespace BinaryRpc
+} // namespace Alf
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_BINARYRPC_H
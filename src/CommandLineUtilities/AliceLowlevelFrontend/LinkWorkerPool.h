@@ -0,0 +1,154 @@
+/// \file LinkWorkerPool.h
+/// \brief Definition of the LinkWorkerPool class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_READOUTCARD_UTILITIES_ALF_LINKWORKERPOOL_H
+#define ALICEO2_READOUTCARD_UTILITIES_ALF_LINKWORKERPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace Alf {
+
+/// Runs tasks on worker threads keyed by card and link. Every key has its own thread, made when the first task for it
+/// comes in, which runs the key's tasks in order. So tasks for different links run concurrently, while the operations
+/// on one link, such as SCA transactions, stay serialized.
+class LinkWorkerPool
+{
+  public:
+    /// Serial number of the card and link number
+    using Key = std::pair<int, int>;
+
+    LinkWorkerPool() = default;
+    LinkWorkerPool(const LinkWorkerPool&) = delete;
+    LinkWorkerPool& operator=(const LinkWorkerPool&) = delete;
+
+    ~LinkWorkerPool()
+    {
+      stop();
+    }
+
+    /// Stops the workers, waiting for the running tasks. Tasks that did not start yet are discarded, and tasks
+    /// submitted afterwards are refused.
+    void stop()
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopped = true;
+      for (auto& kv : mWorkers) {
+        auto& worker = *kv.second;
+        {
+          std::lock_guard<std::mutex> workerLock(worker.mutex);
+          worker.stop = true;
+        }
+        worker.condition.notify_one();
+      }
+      for (auto& kv : mWorkers) {
+        if (kv.second->thread.joinable()) {
+          kv.second->thread.join();
+        }
+      }
+    }
+
+    /// Queues a task on the worker of a key. The task must not throw, since there is no one to report to.
+    /// \throw std::runtime_error if the pool was stopped
+    void submit(Key key, std::function<void()> task)
+    {
+      auto& worker = getWorker(key);
+      {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+      }
+      worker.condition.notify_one();
+    }
+
+    /// Runs a function on the worker of a key, after the tasks queued before it, and waits for its result. Exceptions
+    /// of the function are rethrown.
+    template <typename Function>
+    auto execute(Key key, Function function) -> decltype(function())
+    {
+      auto task = std::make_shared<std::packaged_task<decltype(function())()>>(std::move(function));
+      auto future = task->get_future();
+      submit(key, [task]{ (*task)(); });
+      return future.get();
+    }
+
+    /// Gets the amount of tasks waiting for the worker of a key, not counting the running one
+    size_t getQueueSize(Key key)
+    {
+      auto& worker = getWorker(key);
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      return worker.tasks.size();
+    }
+
+  private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::function<void()>> tasks;
+        bool stop = false;
+        std::thread thread;
+    };
+
+    Worker& getWorker(Key key)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mStopped) {
+        throw std::runtime_error("Link worker pool was stopped");
+      }
+      auto& worker = mWorkers[key];
+      if (!worker) {
+        worker = std::make_unique<Worker>();
+        auto pointer = worker.get();
+        worker->thread = std::thread([pointer]{ run(*pointer); });
+      }
+      return *worker;
+    }
+
+    static void run(Worker& worker)
+    {
+      while (true) {
+        std::function<void()> task;
+        {
+          std::unique_lock<std::mutex> lock(worker.mutex);
+          worker.condition.wait(lock, [&]{ return worker.stop || !worker.tasks.empty(); });
+          if (worker.stop) {
+            // Discarding the tasks breaks their promises, so callers of execute() don't wait forever
+            worker.tasks.clear();
+            return;
+          }
+          task = std::move(worker.tasks.front());
+          worker.tasks.pop_front();
+        }
+        try {
+          task();
+        } catch (...) {
+          // Keep the worker alive for the next tasks
+        }
+      }
+    }
+
+    /// Protects mWorkers
+    std::mutex mMutex;
+    std::map<Key, std::unique_ptr<Worker>> mWorkers;
+    bool mStopped = false;
+};
+
+} // namespace Alf
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_UTILITIES_ALF_LINKWORKERPOOL_H
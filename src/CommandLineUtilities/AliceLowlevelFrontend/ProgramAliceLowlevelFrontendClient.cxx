@@ -5,11 +5,14 @@
 
 #include "CommandLineUtilities/Program.h"
 #include "Common/GuardFunction.h"
+#include <chrono>
+#include <future>
 #include <iostream>
 #include <thread>
 #include <dim/dic.hxx>
 #include "AliceLowlevelFrontend.h"
 #include "AlfException.h"
+#include "AsyncClient.h"
 #include "ServiceNames.h"
 
 using std::cout;
@@ -68,6 +71,7 @@ class ProgramAliceLowlevelFrontendClient: public Program
       Alf::ServiceNames names(mSerialNumber, mLink);
       TemperatureInfo alfTestInt(names.temperature());
       Alf::RegisterReadRpc readRpc(names.registerReadRpc());
+      Alf::RegisterReadBlockRpc readBlockRpc(names.registerReadBlockRpc());
       Alf::RegisterWriteRpc writeRpc(names.registerWriteRpc());
       Alf::ScaReadRpc scaReadRpc(names.scaRead());
       Alf::ScaWriteRpc scaWriteRpc(names.scaWrite());
@@ -114,6 +118,34 @@ class ProgramAliceLowlevelFrontendClient: public Program
         cout << "Done!" << endl;
       }
 
+      {
+        cout << "Block read of 0x1e8 to 0x1fc..." << endl;
+        auto values = readBlockRpc.readRegisterRange(0x1e8, 6);
+        for (size_t i = 0; i < values.size(); ++i) {
+          cout << "  " << Common::makeRegisterString(0x1e8 + i * 4, values[i]) << '\n';
+        }
+        cout << "Done!" << endl;
+      }
+
+      {
+        constexpr int PIPELINED_READS = 100;
+        cout << "Pipelined reads of 0x1fc..." << endl;
+        auto start = std::chrono::steady_clock::now();
+        Alf::AsyncClient asyncClient;
+        std::vector<std::future<uint32_t>> values;
+        for (int i = 0; i < PIPELINED_READS; ++i) {
+          values.push_back(asyncClient.readRegister(mSerialNumber, mLink, 0x1fc));
+        }
+        auto sequence = asyncClient.scaSequence(mSerialNumber, mLink, {{0xabcdab00, 0x1}, {0xabcdab02, 0x3}});
+        asyncClient.flush();
+        for (auto& value : values) {
+          value.get();
+        }
+        cout << "  SCA sequence results: " << sequence.get().results.size() << endl;
+        cout << "Done in " << std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start).count() << " us" << endl;
+      }
+
       {
         size_t numInts = 4;
         cout << "Writing blob of " << numInts << " pairs of 32-bit ints..." << endl;
@@ -10,6 +10,9 @@
 ///      the mCommandQueue. The main thread of ProgramAliceLowlevelFrontendServer periodically takes commands from this
 ///      queue and handles them by starting or stopping a publish service.
 ///
+/// The services are updated on a LinkWorkerPool, which has a thread per card and link, so the services of different
+/// links update concurrently. The SCA RPCs run on the same threads, so all SCA operations of a link stay in order.
+///
 /// Decoupling the DIM thread from the main thread was necessary to prevent strange DIM locking issues on exit.
 ///
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
@@ -19,7 +22,9 @@
 
 #include "Common/Program.h"
 #include "CommandLineUtilities/Common.h"
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <functional>
 #include <map>
@@ -33,6 +38,10 @@
 #include <ReadoutCard/Exception.h>
 #include "AliceLowlevelFrontend.h"
 #include "AlfException.h"
+#include "BinaryRpc.h"
+#include "CommandLineUtilities/ChannelStatisticsReader.h"
+#include "LinkWorkerPool.h"
+#include "RegisterSnapshot.h"
 #include "folly/ProducerConsumerQueue.h"
 #include "Utilities/Util.h"
 #include "ReadoutCard/ChannelFactory.h"
@@ -87,6 +96,39 @@ class StringRpcServer: public DimRpc
     std::string mServiceName;
 };
 
+/// RPC server for the binary RPCs, see BinaryRpc.h
+class BinaryRpcServer: public DimRpc
+{
+  public:
+    /// Takes the request data and size, returns the response
+    using Callback = std::function<std::vector<char>(const void*, size_t)>;
+
+    BinaryRpcServer(const std::string& serviceName, Callback callback)
+      : DimRpc(serviceName.c_str(), "I", "I"), mCallback(callback), mServiceName(serviceName)
+    {
+    }
+
+    BinaryRpcServer(const BinaryRpcServer& b) = delete;
+    BinaryRpcServer(BinaryRpcServer&& b) = delete;
+
+  private:
+    void rpcHandler() override
+    {
+      try {
+        mResponse = mCallback(getData(), getSize());
+      } catch (const std::exception& e) {
+        getLogger() << InfoLogger::InfoLogger::Error << mServiceName << ": " << boost::diagnostic_information(e, true)
+          << endm;
+        mResponse = BinaryRpc::makeFailResponse(e.what());
+      }
+      setData(mResponse.data(), mResponse.size());
+    }
+
+    Callback mCallback;
+    std::string mServiceName;
+    std::vector<char> mResponse; ///< Kept until the next call, because DIM may send it after rpcHandler() returns
+};
+
 /// Splits a string
 static std::vector<std::string> split(const std::string& string, std::string separators)
 {
@@ -116,6 +158,9 @@ size_t strlenMax(char* string, size_t max)
   return max;
 }
 
+/// Link number of the worker pool keys for work on a whole card, like the register snapshots
+constexpr int CARD_WORKER_LINK = -1;
+
 struct LinkInfo
 {
     int serial;
@@ -129,6 +174,8 @@ struct ServiceDescription
     struct Register
     {
         std::vector<uintptr_t> addresses;
+        /// Publish the values as an array of 32-bit integers instead of a string
+        bool binary;
     };
 
     /// Struct for SCA sequence service
@@ -137,9 +184,15 @@ struct ServiceDescription
         std::vector<Sca::CommandData> commandDataPairs;
     };
 
+    /// Struct for DMA channel statistics service
+    struct ChannelStatistics
+    {
+        int dmaChannel;
+    };
+
     std::string dnsName;
     std::chrono::milliseconds interval;
-    boost::variant<Register, ScaSequence> type;
+    boost::variant<Register, ScaSequence, ChannelStatistics> type;
     LinkInfo linkInfo;
 };
 
@@ -156,6 +209,8 @@ struct Service
     std::chrono::steady_clock::time_point nextUpdate;
     std::unique_ptr<DimService> dimService;
     std::vector<char> buffer; ///< Needed for DIM
+    std::unique_ptr<ChannelStatisticsReader> statisticsReader; ///< For channel statistics services
+    std::atomic<bool> updating {false}; ///< True while an update is queued or running on the worker pool
 };
 
 /// Thread-safe queue for commands
@@ -185,7 +240,8 @@ class CommandQueue
 class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
 {
   public:
-    ProgramAliceLowlevelFrontendServer() : mCommandQueue(std::make_shared<CommandQueue>()), mRpcServers(), mBars(), mServices()
+    ProgramAliceLowlevelFrontendServer() : mCommandQueue(std::make_shared<CommandQueue>()),
+      mWorkerPool(std::make_shared<LinkWorkerPool>()), mRpcServers(), mBars(), mServices()
     {
     }
 
@@ -235,6 +291,7 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
         BarSharedPtr bar2 = ChannelFactory().getBar(Parameters::makeParameters(serial, 2));
         mBars[serial][0] = bar0;
         mBars[serial][2] = bar2;
+        mPciAddresses.insert({serial, card.pciAddress});
 
         std::vector<int> links;
         if (card.cardType == CardType::Cru) {
@@ -257,42 +314,64 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
             getLogger() << "Starting RPC server '" << name << "'" << endm;
             return std::make_unique<Alf::StringRpcServer>(name, callback);
           };
+          auto makeBinaryServer = [&](std::string name, auto callback) {
+            getLogger() << "Starting binary RPC server '" << name << "'" << endm;
+            return std::make_unique<Alf::BinaryRpcServer>(name, callback);
+          };
 
           // Start RPC servers
           // Note that we capture the bar0, bar2, and mCommandQueue objects by value, so the shared_ptrs can do their
           // job
           auto& servers = mRpcServers[serial][link];
+          auto& binaryServers = mBinaryRpcServers[serial][link];
           auto commandQueue = mCommandQueue; // Copy for lambda capture
+          auto pool = mWorkerPool; // Copy for lambda capture
+          LinkWorkerPool::Key key {serial, link};
 
           // Register RPCs
           servers.push_back(makeServer(names.registerReadRpc(),
             [bar0](auto parameter){
               return registerRead(parameter, bar0);}));
+          servers.push_back(makeServer(names.registerReadBlockRpc(),
+            [bar0](auto parameter){
+              return registerReadBlock(parameter, bar0);}));
           servers.push_back(makeServer(names.registerWriteRpc(),
             [bar0](auto parameter){
               return registerWrite(parameter, bar0);}));
+          binaryServers.push_back(makeBinaryServer(names.registerReadBinaryRpc(),
+            [bar0](auto data, auto size){
+              return registerReadBinary(data, size, bar0);}));
+          binaryServers.push_back(makeBinaryServer(names.registerWriteBinaryRpc(),
+            [bar0](auto data, auto size){
+              return registerWriteBinary(data, size, bar0);}));
 
           // SCA RPCs
           servers.push_back(makeServer(names.scaRead(),
-            [bar2, linkInfo](auto parameter){
-              return scaRead(parameter, bar2, linkInfo);}));
+            [bar2, linkInfo, pool, key](auto parameter){
+              return pool->execute(key, [&]{ return scaRead(parameter, bar2, linkInfo); });}));
           servers.push_back(makeServer(names.scaWrite(),
-            [bar2, linkInfo](auto parameter){
-              return scaWrite(parameter, bar2, linkInfo);}));
+            [bar2, linkInfo, pool, key](auto parameter){
+              return pool->execute(key, [&]{ return scaWrite(parameter, bar2, linkInfo); });}));
           servers.push_back(makeServer(names.scaSequence(),
-            [bar2, linkInfo](auto parameter){
-              return scaBlobWrite(parameter, bar2, linkInfo);}));
+            [bar2, linkInfo, pool, key](auto parameter){
+              return pool->execute(key, [&]{ return scaBlobWrite(parameter, bar2, linkInfo); });}));
+          binaryServers.push_back(makeBinaryServer(names.scaSequenceBinary(),
+            [bar2, linkInfo, pool, key](auto data, auto size){
+              return pool->execute(key, [&]{ return scaSequenceBinary(data, size, bar2, linkInfo); });}));
           servers.push_back(makeServer(names.scaGpioRead(),
-            [bar2, linkInfo](auto parameter){
-              return scaGpioRead(parameter, bar2, linkInfo);}));
+            [bar2, linkInfo, pool, key](auto parameter){
+              return pool->execute(key, [&]{ return scaGpioRead(parameter, bar2, linkInfo); });}));
           servers.push_back(makeServer(names.scaGpioWrite(),
-            [bar2, linkInfo](auto parameter){
-              return scaGpioWrite(parameter, bar2, linkInfo);}));
+            [bar2, linkInfo, pool, key](auto parameter){
+              return pool->execute(key, [&]{ return scaGpioWrite(parameter, bar2, linkInfo); });}));
 
           // Publish registers RPCs
           servers.push_back(makeServer(names.publishRegistersStart(),
             [commandQueue, linkInfo](auto parameter){
-              return publishRegistersStart(parameter, commandQueue, linkInfo);}));
+              return publishRegistersStart(parameter, commandQueue, linkInfo, false);}));
+          servers.push_back(makeServer(names.publishRegistersBinaryStart(),
+            [commandQueue, linkInfo](auto parameter){
+              return publishRegistersStart(parameter, commandQueue, linkInfo, true);}));
           servers.push_back(makeServer(names.publishRegistersStop(),
             [commandQueue, linkInfo](auto parameter){
               return publishRegistersStop(parameter, commandQueue, linkInfo);}));
@@ -304,6 +383,14 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
           servers.push_back(makeServer(names.publishScaSequenceStop(),
             [commandQueue, linkInfo](auto parameter){
               return publishScaSequenceStop(parameter, commandQueue, linkInfo);}));
+
+          // Publish channel statistics RPCs
+          servers.push_back(makeServer(names.publishChannelStatisticsStart(),
+            [commandQueue, linkInfo](auto parameter){
+              return publishChannelStatisticsStart(parameter, commandQueue, linkInfo);}));
+          servers.push_back(makeServer(names.publishChannelStatisticsStop(),
+            [commandQueue, linkInfo](auto parameter){
+              return publishChannelStatisticsStop(parameter, commandQueue, linkInfo);}));
         }
       }
 
@@ -324,16 +411,43 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
         // Update service(s) and sleep until next update is needed
         auto now = std::chrono::steady_clock::now();
         std::chrono::steady_clock::time_point next = now + std::chrono::seconds(1); // We wait a max of 1 second
+        // Register services that are due, per card serial. They are updated together from one snapshot.
+        std::map<int, std::vector<std::shared_ptr<Service>>> dueRegisterServices;
         for (auto& kv: mServices) {
           auto& service = *kv.second;
           if (service.nextUpdate < now) {
-            serviceUpdate(service);
+            // If the previous update is still going, this one is skipped instead of piling up behind it
+            if (!service.updating.exchange(true)) {
+              auto servicePointer = kv.second;
+              if (isRegisterService(service)) {
+                dueRegisterServices[service.description.linkInfo.serial].push_back(servicePointer);
+              } else {
+                mWorkerPool->submit(getKey(service), [this, servicePointer]{
+                  try {
+                    serviceUpdate(*servicePointer);
+                  } catch (const std::exception& e) {
+                    getLogger() << InfoLogger::InfoLogger::Error << "Failed to update '"
+                      << servicePointer->description.dnsName << "': " << e.what() << endm;
+                  }
+                  servicePointer->updating = false;
+                });
+              }
+            }
             service.advanceUpdateTime();
-            next = std::min(next, service.nextUpdate);
           }
+          next = std::min(next, service.nextUpdate);
+        }
+        for (auto& kv : dueRegisterServices) {
+          auto serial = kv.first;
+          auto services = std::move(kv.second);
+          mWorkerPool->submit({serial, CARD_WORKER_LINK}, [this, serial, services]{
+            registerServicesUpdate(serial, services);
+          });
         }
         std::this_thread::sleep_until(next);
       }
+
+      mWorkerPool->stop();
     }
 
   private:
@@ -345,15 +459,16 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
         serviceRemove(serviceDescription.dnsName);
       }
 
-      auto service = std::make_unique<Service>();
+      auto service = std::make_shared<Service>();
       service->description = serviceDescription;
       service->nextUpdate = std::chrono::steady_clock::now();
       Visitor::apply(service->description.type,
         [&](const ServiceDescription::Register& type){
           // Estimate max needed size. I'm not sure DIM can handle reallocations of this buffer, so we avoid that...
-          service->buffer.resize(type.addresses.size()*20 + 512);
-          getLogger() << "Starting register publisher '" << service->description.dnsName << "' with "
-            << type.addresses.size() << " address(es) at interval "
+          service->buffer.resize(type.binary ? type.addresses.size() * sizeof(uint32_t)
+            : type.addresses.size()*20 + 512);
+          getLogger() << "Starting " << (type.binary ? "binary " : "") << "register publisher '"
+            << service->description.dnsName << "' with " << type.addresses.size() << " address(es) at interval "
             << service->description.interval.count() << "ms" << endm;
         },
         [&](const ServiceDescription::ScaSequence& type){
@@ -362,12 +477,26 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
           getLogger() << "Starting SCA publisher '" << service->description.dnsName << "' with "
             << type.commandDataPairs.size() << " commands(s) at interval "
             << service->description.interval.count() << "ms" << endm;
+        },
+        [&](const ServiceDescription::ChannelStatistics& type){
+          // The counters and one line per link
+          service->buffer.resize(ChannelStatisticsTable::MAX_LINKS * 64 + 512);
+          service->statisticsReader = std::make_unique<ChannelStatisticsReader>(
+            mPciAddresses.at(service->description.linkInfo.serial), type.dmaChannel);
+          getLogger() << "Starting channel statistics publisher '" << service->description.dnsName
+            << "' for DMA channel " << type.dmaChannel << " at interval " << service->description.interval.count()
+            << "ms" << endm;
         }
       );
 
       std::fill(service->buffer.begin(), service->buffer.end(), '\0');
-      service->dimService = std::make_unique<DimService>(service->description.dnsName.c_str(), "C",
-        service->buffer.data(), strlenMax(service->buffer.data(), service->buffer.size()));
+      if (isBinaryService(*service)) {
+        service->dimService = std::make_unique<DimService>(service->description.dnsName.c_str(), "I",
+          service->buffer.data(), service->buffer.size());
+      } else {
+        service->dimService = std::make_unique<DimService>(service->description.dnsName.c_str(), "C",
+          service->buffer.data(), strlenMax(service->buffer.data(), service->buffer.size()));
+      }
       mServices.insert(std::make_pair(serviceDescription.dnsName, std::move(service)));
     }
 
@@ -375,40 +504,146 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
     void serviceRemove(std::string dnsName)
     {
       getLogger() << "Removing publisher '" << dnsName << endm;
-      mServices.erase(dnsName);
+      auto iterator = mServices.find(dnsName);
+      if (iterator == mServices.end()) {
+        return;
+      }
+      // Wait for a queued or running update, so the DIM service is gone before a new one with the same name is made
+      mWorkerPool->execute(getKey(*iterator->second), []{});
+      mServices.erase(iterator);
     }
 
-    /// Publish updated values
-    void serviceUpdate(Service& service)
+    /// Updates the register services of a card that are due. The registers of all of them are read in one snapshot,
+    /// so registers published by several services are read only once.
+    void registerServicesUpdate(int serial, const std::vector<std::shared_ptr<Service>>& services)
     {
-      getLogger() << "Updating '" << service.description.dnsName << "'" << endm;
+      try {
+        std::vector<uintptr_t> addresses;
+        for (const auto& service : services) {
+          const auto& type = b::get<ServiceDescription::Register>(service->description.type);
+          addresses.insert(addresses.end(), type.addresses.begin(), type.addresses.end());
+        }
+        const RegisterSnapshot snapshot(*(mBars.at(serial).at(0)), std::move(addresses));
+
+        for (const auto& service : services) {
+          try {
+            publishSnapshot(*service, snapshot);
+          } catch (const std::exception& e) {
+            getLogger() << InfoLogger::InfoLogger::Error << "Failed to update '" << service->description.dnsName
+              << "': " << e.what() << endm;
+          }
+        }
+      } catch (const std::exception& e) {
+        getLogger() << InfoLogger::InfoLogger::Error << "Failed to read registers of card " << serial << ": "
+          << e.what() << endm;
+      }
+      for (const auto& service : services) {
+        service->updating = false;
+      }
+    }
 
-      std::string result;
+    /// Publishes the values of a register service from a snapshot
+    static void publishSnapshot(Service& service, const RegisterSnapshot& snapshot)
+    {
+      getLogger() << "Updating '" << service.description.dnsName << "'" << endm;
+      const auto& type = b::get<ServiceDescription::Register>(service.description.type);
+      auto values = snapshot.getValues(type.addresses);
+
+      if (type.binary) {
+        // The buffer was sized for the values when the service was made
+        std::memcpy(service.buffer.data(), values.data(), values.size() * sizeof(uint32_t));
+        service.dimService->updateService(service.buffer.data(), values.size() * sizeof(uint32_t));
+      } else {
+        std::ostringstream stream;
+        for (auto value : values) {
+          stream << std::hex << value << '\n';
+        }
+        updateStringService(service, stream.str());
+      }
+    }
 
+    /// Publish updated values
+    void serviceUpdate(Service& service)
+    {
       Visitor::apply(service.description.type,
         [&](const ServiceDescription::Register& type){
-          std::stringstream ss;
-          auto& bar0 = *(mBars.at(service.description.linkInfo.serial).at(0));
-          for (size_t i = 0; i < type.addresses.size(); ++i) {
-            auto index = type.addresses[i] / 4;
-            auto value = bar0.readRegister(index);
-            ss << std::hex << value << '\n';
-          }
-          result = ss.str();
+          publishSnapshot(service,
+            RegisterSnapshot(*(mBars.at(service.description.linkInfo.serial).at(0)), type.addresses));
         },
         [&](const ServiceDescription::ScaSequence& type){
+          getLogger() << "Updating '" << service.description.dnsName << "'" << endm;
           auto& bar2 = *(mBars.at(service.description.linkInfo.serial).at(2));
           auto sca = Sca(bar2, bar2.getCardType(), service.description.linkInfo.link);
-          result = writeScaSequence(type.commandDataPairs, sca, service.description.linkInfo);
+          updateStringService(service, writeScaSequence(type.commandDataPairs, sca, service.description.linkInfo));
+        },
+        [&](const ServiceDescription::ChannelStatistics&){
+          updateStringService(service, formatChannelStatistics(service.statisticsReader->read()));
         }
       );
+    }
+
+    /// Formats a channel statistics sample as lines of a name and a value, and a line per link with its ID,
+    /// superpages and bytes. A channel that does not publish its statistics gives "published 0" only.
+    static std::string formatChannelStatistics(const boost::optional<ChannelStatisticsReader::Sample>& sample)
+    {
+      std::ostringstream stream;
+      stream << "published " << (sample ? 1 : 0) << '\n';
+      if (!sample) {
+        return stream.str();
+      }
+      const auto& statistics = sample->statistics;
+      stream << "open " << (sample->open ? 1 : 0) << '\n'
+        << "throughput_gbps " << (b::format("%.3f") % sample->throughput) << '\n'
+        << "bytes " << sample->bytes << '\n'
+        << "transfer_queue " << statistics.transferQueueSize << '\n'
+        << "ready_queue " << statistics.readyQueueSize << '\n'
+        << "transfer_queue_high_water " << statistics.transferQueueHighWater << '\n'
+        << "ready_queue_high_water " << statistics.readyQueueHighWater << '\n'
+        << "empty_fills " << statistics.emptyFills << '\n'
+        << "ready_queue_full " << statistics.readyQueueFull << '\n'
+        << "superpages_left_on_card " << statistics.superpagesLeftOnCard << '\n'
+        << "superpages_dropped " << statistics.superpagesDropped << '\n'
+        << "recoveries " << statistics.recoveries << '\n';
+      for (const auto& link : statistics.links) {
+        stream << "link " << link.linkId << ' ' << link.superpages << ' ' << link.bytes << '\n';
+      }
+      return stream.str();
+    }
 
+    /// Publishes a string on a service
+    static void updateStringService(Service& service, const std::string& result)
+    {
       // Reset and copy into the persistent buffer because I don't trust DIM with the non-persistent std::string
       std::fill(service.buffer.begin(), service.buffer.end(), '\0');
       std::copy(result.begin(), result.end(), service.buffer.begin());
       service.dimService->updateService(service.buffer.data(), result.size() + 1);
     }
 
+    static bool isRegisterService(const Service& service)
+    {
+      return b::get<ServiceDescription::Register>(&service.description.type) != nullptr;
+    }
+
+    static bool isBinaryService(const Service& service)
+    {
+      auto type = b::get<ServiceDescription::Register>(&service.description.type);
+      return type && type->binary;
+    }
+
+    static LinkWorkerPool::Key getKey(const LinkInfo& linkInfo)
+    {
+      return {linkInfo.serial, linkInfo.link};
+    }
+
+    /// Gets the worker that updates a service. Register services are updated per card, SCA services per link.
+    static LinkWorkerPool::Key getKey(const Service& service)
+    {
+      if (isRegisterService(service)) {
+        return {service.description.linkInfo.serial, CARD_WORKER_LINK};
+      }
+      return getKey(service.description.linkInfo);
+    }
+
     /// Checks if the address is in range
     static void checkAddress(uint64_t address)
     {
@@ -465,23 +700,25 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
     static std::string writeScaSequence(const std::vector<Sca::CommandData>& commandDataPairs, Sca& sca,
       LinkInfo linkInfo)
     {
+      auto sequenceResult = sca.executeSequence(commandDataPairs);
+
       std::stringstream resultBuffer;
-      for (const auto& commandData : commandDataPairs) {
-        try {
-          sca.write(commandData);
-          auto result = sca.read();
-          getLogger() << (b::format("cmd=0x%x data=0x%x result=0x%x") % commandData.command % commandData.data %
-            result.data).str() << endm;
-          resultBuffer << std::hex << commandData.command << ',' << result.data << '\n';
-        } catch (const ScaException &e) {
-          // If an SCA error occurs, we stop executing the sequence of commands and return the results as far as we got
-          // them, plus the error message.
-          getLogger() << InfoLogger::InfoLogger::Error
-            << (b::format("SCA_SEQUENCE cmd=0x%x data=0x%x serial=%d link=%d error='%s'") % commandData.command
-              % commandData.data % linkInfo.serial % linkInfo.link % e.what()).str() << endm;
-          resultBuffer << e.what();
-          break;
-        }
+      for (size_t i = 0; i < sequenceResult.results.size(); ++i) {
+        const auto& commandData = commandDataPairs[i];
+        const auto& result = sequenceResult.results[i];
+        getLogger() << (b::format("cmd=0x%x data=0x%x result=0x%x") % commandData.command % commandData.data %
+          result.data).str() << endm;
+        resultBuffer << std::hex << commandData.command << ',' << result.data << '\n';
+      }
+
+      if (sequenceResult.error) {
+        // If an SCA error occurs, the sequence of commands stops, and we return the results as far as we got them,
+        // plus the error message.
+        const auto& commandData = commandDataPairs[sequenceResult.results.size()];
+        getLogger() << InfoLogger::InfoLogger::Error
+          << (b::format("SCA_SEQUENCE cmd=0x%x data=0x%x serial=%d link=%d error='%s'") % commandData.command
+            % commandData.data % linkInfo.serial % linkInfo.link % *sequenceResult.error).str() << endm;
+        resultBuffer << *sequenceResult.error;
       }
       return resultBuffer.str();
     }
@@ -497,6 +734,66 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
       return (b::format("0x%x") % value).str();
     }
 
+    /// Parses the addresses of a block read: one address per line, or a line "[start address],[count]" for a range
+    /// of consecutive registers
+    static std::vector<uint32_t> parseBlockAddresses(const std::string& parameter)
+    {
+      std::vector<uint32_t> addresses;
+      for (const auto& line : split(parameter, argumentSeparator())) {
+        if (line.empty()) {
+          continue;
+        }
+        auto range = split(line, scaPairSeparator().c_str());
+        if (range.size() == 1) {
+          addresses.push_back(convertHexString(range[0]));
+        } else if (range.size() == 2) {
+          auto start = convertHexString(range[0]);
+          auto count = boost::lexical_cast<size_t>(range[1]);
+          for (size_t i = 0; i < count; ++i) {
+            addresses.push_back(start + i * 4);
+          }
+        } else {
+          BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("Block read address not formatted correctly"));
+        }
+      }
+      if (addresses.empty()) {
+        BOOST_THROW_EXCEPTION(AlfException() << ErrorInfo::Message("Block read RPC call had no addresses"));
+      }
+      for (auto address : addresses) {
+        checkAddress(address);
+      }
+      return addresses;
+    }
+
+    /// Reads registers, with one bulk BAR access per run of consecutive addresses
+    static std::vector<uint32_t> readRegisterBlock(const std::vector<uint32_t>& addresses, BarInterface& bar)
+    {
+      std::vector<uint32_t> values(addresses.size());
+      size_t runStart = 0;
+      for (size_t i = 1; i <= addresses.size(); ++i) {
+        if (i == addresses.size() || addresses[i] != addresses[i - 1] + 4) {
+          bar.readRegisters(addresses[runStart] / 4, &values[runStart], i - runStart);
+          runStart = i;
+        }
+      }
+      return values;
+    }
+
+    /// RPC handler for block register reads. Runs of consecutive addresses are read with one bulk BAR access, and the
+    /// values are returned in one string, one per line, in the order of the addresses.
+    static std::string registerReadBlock(const std::string& parameter, BarSharedPtr channel)
+    {
+      auto addresses = parseBlockAddresses(parameter);
+      auto values = readRegisterBlock(addresses, *channel);
+
+      std::ostringstream stream;
+      for (size_t i = 0; i < addresses.size(); ++i) {
+        getLogger() << "READ   " << Common::makeRegisterString(addresses[i], values[i]) << endm;
+        stream << (i == 0 ? "" : argumentSeparator()) << (b::format("0x%x") % values[i]);
+      }
+      return stream.str();
+    }
+
     /// RPC handler for register writes
     static std::string registerWrite(const std::string& parameter, BarSharedPtr channel)
     {
@@ -515,11 +812,51 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
       return "";
     }
 
+    /// Binary RPC handler for register reads. The request is an array of addresses, the response has their values in
+    /// the same order.
+    static std::vector<char> registerReadBinary(const void* data, size_t size, BarSharedPtr channel)
+    {
+      auto addresses = BinaryRpc::parseRequest<uint32_t>(data, size);
+      for (auto address : addresses) {
+        checkAddress(address);
+      }
+      return BinaryRpc::makeResponse(BinaryRpc::SUCCESS, readRegisterBlock(addresses, *channel));
+    }
+
+    /// Binary RPC handler for register writes. The request is an array of BinaryRpc::RegisterWrite, written in order.
+    /// The addresses are all checked before anything is written.
+    static std::vector<char> registerWriteBinary(const void* data, size_t size, BarSharedPtr channel)
+    {
+      auto writes = BinaryRpc::parseRequest<BinaryRpc::RegisterWrite>(data, size);
+      for (const auto& write : writes) {
+        checkAddress(write.address);
+      }
+      for (const auto& write : writes) {
+        channel->writeRegister(write.address / 4, write.value);
+      }
+      return BinaryRpc::makeResponse(BinaryRpc::SUCCESS, std::vector<uint32_t>());
+    }
+
+    /// Binary RPC handler for SCA sequences. The request is an array of Sca::CommandData, the response has the
+    /// Sca::ReadResult of every command executed, and the error if the sequence stopped at an SCA error.
+    static std::vector<char> scaSequenceBinary(const void* data, size_t size, BarSharedPtr bar2, LinkInfo linkInfo)
+    {
+      auto commandDataPairs = BinaryRpc::parseRequest<Sca::CommandData>(data, size);
+      auto result = Sca(*bar2, bar2->getCardType(), linkInfo.link).executeSequence(commandDataPairs);
+      if (result.error) {
+        getLogger() << InfoLogger::InfoLogger::Error << (b::format("SCA_SEQUENCE_BINARY serial=%d link=%d error='%s'")
+          % linkInfo.serial % linkInfo.link % *result.error).str() << endm;
+        return BinaryRpc::makeResponse(BinaryRpc::SCA_ERROR, result.results, *result.error);
+      }
+      return BinaryRpc::makeResponse(BinaryRpc::SUCCESS, result.results);
+    }
+
     /// RPC handler for publish commands
     static std::string publishRegistersStart(const std::string& parameter, std::shared_ptr<CommandQueue> queue,
-      LinkInfo linkInfo)
+      LinkInfo linkInfo, bool binary)
     {
-      getLogger() << "PUBLISH_REGISTERS_START: '" << parameter << "'" << endm;
+      getLogger() << (binary ? "PUBLISH_REGISTERS_BINARY_START: '" : "PUBLISH_REGISTERS_START: '") << parameter << "'"
+        << endm;
 
       auto params = split(parameter, argumentSeparator());
       auto dnsName = params.at(0);
@@ -534,14 +871,14 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
       size_t skip = 2; // First two arguments don't go in the array
       std::vector<uintptr_t> registers;
       for (size_t i = 0; (i + skip) < params.size(); ++i) {
-        registers.push_back(b::lexical_cast<uintptr_t >(i + skip));
+        registers.push_back(convertHexString(params[i + skip]));
       }
 
       auto command = std::make_unique<CommandQueue::Command>();
       command->start = true;
       command->description.dnsName = ServiceNames(linkInfo.serial, linkInfo.link).publishRegistersSubdir(dnsName);
       command->description.interval = std::chrono::milliseconds(int64_t(b::lexical_cast<double>(interval) * 1000.0));
-      command->description.type = ServiceDescription::Register{std::move(registers)};
+      command->description.type = ServiceDescription::Register{std::move(registers), binary};
       command->description.linkInfo = linkInfo;
 
       tryAddToQueue(*queue, std::move(command));
@@ -579,6 +916,48 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
       return "";
     }
 
+    /// RPC handler for channel statistics publish commands
+    static std::string publishChannelStatisticsStart(const std::string& parameter, std::shared_ptr<CommandQueue> queue,
+      LinkInfo linkInfo)
+    {
+      getLogger() << "PUBLISH_CHANNEL_STATISTICS_START: '" << parameter << "'" << endm;
+
+      auto params = split(parameter, argumentSeparator());
+      if (params.size() != 3) {
+        BOOST_THROW_EXCEPTION(AlfException()
+          << ErrorInfo::Message("Channel statistics publish RPC call did not have 3 parameters"));
+      }
+
+      auto command = std::make_unique<CommandQueue::Command>();
+      command->start = true;
+      command->description.type = ServiceDescription::ChannelStatistics{b::lexical_cast<int>(params[2])};
+      command->description.dnsName = ServiceNames(linkInfo.serial, linkInfo.link).publishChannelStatisticsSubdir(
+        params[0]);
+      command->description.interval = std::chrono::milliseconds(int64_t(b::lexical_cast<double>(params[1]) * 1000.0));
+      command->description.linkInfo = linkInfo;
+
+      tryAddToQueue(*queue, std::move(command));
+      return "";
+    }
+
+    /// RPC handler for channel statistics publish stop commands
+    static std::string publishChannelStatisticsStop(const std::string& parameter, std::shared_ptr<CommandQueue> queue,
+      LinkInfo linkInfo)
+    {
+      getLogger() << "PUBLISH_CHANNEL_STATISTICS_STOP: '" << parameter << "'" << endm;
+
+      auto command = std::make_unique<CommandQueue::Command>();
+      command->start = false;
+      command->description.type = ServiceDescription::ChannelStatistics();
+      command->description.dnsName = ServiceNames(linkInfo.serial, linkInfo.link).publishChannelStatisticsSubdir(
+        parameter);
+      command->description.interval = std::chrono::milliseconds(0);
+      command->description.linkInfo = linkInfo;
+
+      tryAddToQueue(*queue, std::move(command));
+      return "";
+    }
+
     /// RPC handler for publish stop commands
     static std::string publishRegistersStop(const std::string& parameter, std::shared_ptr<CommandQueue> queue,
       LinkInfo linkInfo)
@@ -663,12 +1042,18 @@ class ProgramAliceLowlevelFrontendServer: public AliceO2::Common::Program
 
     /// Command queue for passing commands from DIM RPC calls (which are in separate threads) to the main program loop
     std::shared_ptr<CommandQueue> mCommandQueue;
+    /// Threads per card and link for the service updates and SCA RPCs
+    std::shared_ptr<LinkWorkerPool> mWorkerPool;
     /// serial -> link -> vector of RPC servers
     std::map<int, std::map<int, std::vector<std::unique_ptr<Alf::StringRpcServer>>>> mRpcServers;
+    /// serial -> link -> vector of binary RPC servers
+    std::map<int, std::map<int, std::vector<std::unique_ptr<Alf::BinaryRpcServer>>>> mBinaryRpcServers;
     /// serial -> BAR number -> BAR
     std::map<int, std::map<int, BarSharedPtr>> mBars;
-    /// Object representing a publishing DIM service
-    std::map<std::string, std::unique_ptr<Service>> mServices;
+    /// serial -> PCI address, to find the channel statistics tables
+    std::map<int, PciAddress> mPciAddresses;
+    /// Object representing a publishing DIM service. A running update holds a reference too.
+    std::map<std::string, std::shared_ptr<Service>> mServices;
 };
 } // Anonymous namespace
 } // namespace Alf
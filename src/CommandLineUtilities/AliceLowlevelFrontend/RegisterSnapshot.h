@@ -0,0 +1,90 @@
+/// \file RegisterSnapshot.h
+/// \brief Definition of the RegisterSnapshot class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_READOUTCARD_UTILITIES_ALF_REGISTERSNAPSHOT_H
+#define ALICEO2_READOUTCARD_UTILITIES_ALF_REGISTERSNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "ReadoutCard/RegisterReadWriteInterface.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace Alf {
+
+/// Values of a set of registers, read at one point in time. The register publishing services of a card that are due
+/// at the same time merge their addresses into one snapshot, so every register is read once per interval no matter
+/// how many services publish it. After construction it is only read, so it can be shared between threads.
+class RegisterSnapshot
+{
+  public:
+    /// Reads the registers. Duplicate addresses are read once, and every run of consecutive addresses is read with one
+    /// bulk read.
+    /// \param bar BAR to read from
+    /// \param addresses Byte addresses of the registers, in any order
+    RegisterSnapshot(RegisterReadWriteInterface& bar, std::vector<uintptr_t> addresses)
+      : mAddresses(std::move(addresses))
+    {
+      std::sort(mAddresses.begin(), mAddresses.end());
+      mAddresses.erase(std::unique(mAddresses.begin(), mAddresses.end()), mAddresses.end());
+      mValues.resize(mAddresses.size());
+
+      for (size_t i = 0; i < mAddresses.size();) {
+        size_t count = 1;
+        while ((i + count) < mAddresses.size()
+            && mAddresses[i + count] == (mAddresses[i] + count * sizeof(uint32_t))) {
+          ++count;
+        }
+        bar.readRegisters(mAddresses[i] / 4, &mValues[i], count);
+        mReadCount++;
+        i += count;
+      }
+    }
+
+    /// Gets the value of a register of the snapshot
+    /// \param address Byte address of the register, must be one of the addresses given to the constructor
+    uint32_t getValue(uintptr_t address) const
+    {
+      auto iterator = std::lower_bound(mAddresses.begin(), mAddresses.end(), address);
+      if (iterator == mAddresses.end() || *iterator != address) {
+        throw std::out_of_range("Register address not in snapshot");
+      }
+      return mValues[iterator - mAddresses.begin()];
+    }
+
+    /// Gets the values of a list of registers of the snapshot, in the order of the list
+    std::vector<uint32_t> getValues(const std::vector<uintptr_t>& addresses) const
+    {
+      std::vector<uint32_t> values;
+      values.reserve(addresses.size());
+      for (auto address : addresses) {
+        values.push_back(getValue(address));
+      }
+      return values;
+    }
+
+    /// Gets the amount of bulk reads done to take the snapshot
+    size_t getReadCount() const
+    {
+      return mReadCount;
+    }
+
+  private:
+    /// Sorted addresses without duplicates
+    std::vector<uintptr_t> mAddresses;
+    /// Values of the registers, in the order of mAddresses
+    std::vector<uint32_t> mValues;
+    size_t mReadCount = 0;
+};
+
+} // namespace Alf
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_UTILITIES_ALF_REGISTERSNAPSHOT_H
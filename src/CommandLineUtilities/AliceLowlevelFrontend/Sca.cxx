@@ -5,10 +5,12 @@
 
 #include "Sca.h"
 #include <chrono>
+#include <future>
 #include <vector>
 #include "AlfException.h"
 #include "Register.h"
 #include "Utilities/Util.h"
+#include "Utilities/Wait.h"
 
 // TODO Sort out magic numbers
 
@@ -36,6 +38,11 @@ constexpr int READ_TIME = 0x3c / 4;
 constexpr auto BUSY_TIMEOUT = std::chrono::milliseconds(10);
 constexpr auto CHANNEL_BUSY_TIMEOUT = std::chrono::milliseconds(10);
 
+/// Intervals of the busy flag polling. An SCA transaction takes some microseconds, so there's no point in polling
+/// more often than that.
+constexpr auto POLL_MIN_INTERVAL = std::chrono::nanoseconds(500);
+constexpr auto POLL_MAX_INTERVAL = std::chrono::microseconds(20);
+
 Sca::Sca(RegisterReadWriteInterface &bar2, CardType::type cardType, int link) : mBar2(bar2)
 {
   auto setOffset = [&](auto base, auto offset, auto maxLinks) {
@@ -77,11 +84,16 @@ void Sca::write(uint32_t command, uint32_t data)
 {
   barWrite(Registers::WRITE_DATA, data);
   barWrite(Registers::WRITE_COMMAND, command);
+  checkTransactionId(command);
+  executeCommand();
+}
+
+void Sca::checkTransactionId(uint32_t command)
+{
   auto transactionId = (command >> 16) & 0xff;
   if (transactionId == 0x0 || transactionId == 0xff) {
     BOOST_THROW_EXCEPTION(ScaException() << ErrorInfo::Message("Invalid transaction ID"));
   }
-  executeCommand();
 }
 
 auto Sca::read() -> ReadResult
@@ -90,14 +102,69 @@ auto Sca::read() -> ReadResult
   auto command = barRead(Registers::READ_COMMAND);
 //  printf("Sca::read   DATA=0x%x   CH=0x%x   TR=0x%x   CMD=0x%x\n", data, command >> 24, (command >> 16) & 0xff, command & 0xff);
 
-  auto endTime = std::chrono::steady_clock::now() + CHANNEL_BUSY_TIMEOUT;
-  while (std::chrono::steady_clock::now() < endTime){
-    if (!isChannelBusy(barRead(Registers::READ_COMMAND))) {
-      checkError(command);
-      return { command, data };
+  if (!Utilities::pollWithBackoff([&]{ return !isChannelBusy(barRead(Registers::READ_COMMAND)); },
+      CHANNEL_BUSY_TIMEOUT, POLL_MIN_INTERVAL, POLL_MAX_INTERVAL)) {
+    BOOST_THROW_EXCEPTION(ScaException() << ErrorInfo::Message("Exceeded timeout on channel busy wait"));
+  }
+  checkError(command);
+  return { command, data };
+}
+
+auto Sca::executeSequence(const std::vector<CommandData>& commands) -> SequenceResult
+{
+  static_assert(Registers::WRITE_COMMAND == Registers::WRITE_DATA + 1, "SCA write registers not consecutive");
+  static_assert(Registers::READ_COMMAND == Registers::READ_DATA + 1, "SCA read registers not consecutive");
+
+  SequenceResult sequenceResult;
+  sequenceResult.results.reserve(commands.size());
+  for (const auto& commandData : commands) {
+    try {
+      checkTransactionId(commandData.command);
+      const uint32_t block[] = {commandData.data, commandData.command};
+      mBar2.writeRegisters(Registers::WRITE_DATA + mOffset, block, 2);
+      executeCommand();
+
+      // Data and command of the result in one read, repeated while the channel is busy
+      uint32_t result[2];
+      if (!Utilities::pollWithBackoff([&]{
+            mBar2.readRegisters(Registers::READ_DATA + mOffset, result, 2);
+            return !isChannelBusy(result[1]);
+          }, CHANNEL_BUSY_TIMEOUT, POLL_MIN_INTERVAL, POLL_MAX_INTERVAL)) {
+        BOOST_THROW_EXCEPTION(ScaException() << ErrorInfo::Message("Exceeded timeout on channel busy wait"));
+      }
+      checkError(result[1]);
+      sequenceResult.results.push_back({result[1], result[0]});
+    } catch (const ScaException& e) {
+      sequenceResult.error = std::string(e.what());
+      break;
     }
   }
-  BOOST_THROW_EXCEPTION(ScaException() << ErrorInfo::Message("Exceeded timeout on channel busy wait"));
+  return sequenceResult;
+}
+
+auto Sca::executeSequences(RegisterReadWriteInterface& bar2, CardType::type cardType,
+    const std::map<int, std::vector<CommandData>>& sequences) -> std::map<int, SequenceResult>
+{
+  // Constructing an Sca checks the link, so that's done before starting any thread
+  std::map<int, Sca> scas;
+  for (const auto& sequence : sequences) {
+    scas.emplace(sequence.first, Sca(bar2, cardType, sequence.first));
+  }
+
+  std::map<int, std::future<SequenceResult>> futures;
+  for (const auto& sequence : sequences) {
+    auto& sca = scas.at(sequence.first);
+    const auto& commands = sequence.second;
+    futures[sequence.first] = std::async(std::launch::async, [&sca, &commands]{
+      return sca.executeSequence(commands);
+    });
+  }
+
+  std::map<int, SequenceResult> results;
+  for (auto& future : futures) {
+    results[future.first] = future.second.get();
+  }
+  return results;
 }
 
 bool Sca::isChannelBusy(uint32_t command)
@@ -212,13 +279,10 @@ void Sca::executeCommand()
 
 void Sca::waitOnBusyClear()
 {
-  auto endTime = std::chrono::steady_clock::now() + BUSY_TIMEOUT;
-  while (std::chrono::steady_clock::now() < endTime){
-    if ((((barRead(Registers::READ_BUSY)) >> 31) & 0x1) == 0) {
-      return;
-    }
+  if (!Utilities::pollWithBackoff([&]{ return (((barRead(Registers::READ_BUSY)) >> 31) & 0x1) == 0; },
+      BUSY_TIMEOUT, POLL_MIN_INTERVAL, POLL_MAX_INTERVAL)) {
+    BOOST_THROW_EXCEPTION(ScaException() << ErrorInfo::Message("Exceeded timeout on busy wait"));
   }
-  BOOST_THROW_EXCEPTION(ScaException() << ErrorInfo::Message("Exceeded timeout on busy wait"));
 }
 
 
@@ -6,7 +6,10 @@
 #ifndef ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_SCA_H
 #define ALICEO2_READOUTCARD_UTILITIES_ALF_ALICELOWLEVELFRONTEND_SCA_H
 
+#include <map>
 #include <string>
+#include <vector>
+#include <boost/optional.hpp>
 #include "ReadoutCard/CardType.h"
 #include "ReadoutCard/RegisterReadWriteInterface.h"
 
@@ -46,6 +49,31 @@ class Sca
     ReadResult gpioRead();
     ReadResult gpioWrite(uint32_t data);
 
+    /// Result of a sequence of commands
+    struct SequenceResult
+    {
+        /// Results of the commands that were executed, in order
+        std::vector<ReadResult> results;
+        /// Error message of the command that failed, after which the sequence stopped. None if all succeeded.
+        boost::optional<std::string> error;
+    };
+
+    /// Executes a sequence of commands, each followed by a read of its result. The command and data of a command are
+    /// written as one block, the result is read as one block, and the busy flags are polled with exponential backoff
+    /// instead of continuously, so the commands follow each other as closely as the firmware allows without
+    /// hammering the BAR. An SCA error stops the sequence.
+    /// \param commands Commands to execute, in order
+    SequenceResult executeSequence(const std::vector<CommandData>& commands);
+
+    /// Executes sequences of commands on several links in parallel, one thread per link. This is possible because
+    /// every link has its own block of SCA registers.
+    /// \param bar2 SCA is on BAR 2
+    /// \param cardType Needed to get offset for SCA registers
+    /// \param sequences Commands per link
+    /// \return Results per link
+    static std::map<int, SequenceResult> executeSequences(RegisterReadWriteInterface& bar2, CardType::type cardType,
+        const std::map<int, std::vector<CommandData>>& sequences);
+
   private:
     void init();
     void gpioEnable();
@@ -55,6 +83,7 @@ class Sca
     void waitOnBusyClear();
     void checkError(uint32_t command);
     bool isChannelBusy(uint32_t command);
+    void checkTransactionId(uint32_t command);
 
     /// Interface for BAR 2
     RegisterReadWriteInterface& mBar2;
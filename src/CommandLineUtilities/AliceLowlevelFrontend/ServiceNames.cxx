@@ -18,14 +18,21 @@ std::string ServiceNames::_function() const \
 }
 
 DEFSERVICENAME(registerReadRpc, "REGISTER_READ")
+DEFSERVICENAME(registerReadBlockRpc, "REGISTER_READ_BLOCK")
 DEFSERVICENAME(registerWriteRpc, "REGISTER_WRITE")
+DEFSERVICENAME(registerReadBinaryRpc, "REGISTER_READ_BINARY")
+DEFSERVICENAME(registerWriteBinaryRpc, "REGISTER_WRITE_BINARY")
 DEFSERVICENAME(publishRegistersStart, "PUBLISH_REGISTERS_START")
+DEFSERVICENAME(publishRegistersBinaryStart, "PUBLISH_REGISTERS_BINARY_START")
 DEFSERVICENAME(publishRegistersStop, "PUBLISH_REGISTERS_STOP")
 DEFSERVICENAME(publishScaSequenceStart, "PUBLISH_SCA_SEQUENCE_START")
 DEFSERVICENAME(publishScaSequenceStop, "PUBLISH_SCA_SEQUENCE_STOP")
+DEFSERVICENAME(publishChannelStatisticsStart, "PUBLISH_CHANNEL_STATISTICS_START")
+DEFSERVICENAME(publishChannelStatisticsStop, "PUBLISH_CHANNEL_STATISTICS_STOP")
 DEFSERVICENAME(scaRead, "SCA_READ")
 DEFSERVICENAME(scaWrite, "SCA_WRITE")
 DEFSERVICENAME(scaSequence, "SCA_SEQUENCE")
+DEFSERVICENAME(scaSequenceBinary, "SCA_SEQUENCE_BINARY")
 DEFSERVICENAME(scaGpioWrite, "SCA_GPIO_WRITE")
 DEFSERVICENAME(scaGpioRead, "SCA_GPIO_READ")
 DEFSERVICENAME(temperature, "TEMPERATURE")
@@ -45,6 +52,11 @@ std::string ServiceNames::publishScaSequenceSubdir(std::string name) const
   return format("PUBLISH_SCA_SEQUENCE/") + name;
 }
 
+std::string ServiceNames::publishChannelStatisticsSubdir(std::string name) const
+{
+  return format("PUBLISH_CHANNEL_STATISTICS/") + name;
+}
+
 
 } // namespace Alf
 } // namespace CommandLineUtilities
@@ -22,19 +22,27 @@ class ServiceNames
     }
 
     std::string registerReadRpc() const;
+    std::string registerReadBlockRpc() const;
     std::string registerWriteRpc() const;
+    std::string registerReadBinaryRpc() const;
+    std::string registerWriteBinaryRpc() const;
     std::string scaWrite() const;
     std::string scaSequence() const;
+    std::string scaSequenceBinary() const;
     std::string scaRead() const;
     std::string scaGpioWrite() const;
     std::string scaGpioRead() const;
     std::string temperature() const;
     std::string publishRegistersStart() const;
+    std::string publishRegistersBinaryStart() const;
     std::string publishRegistersStop() const;
     std::string publishScaSequenceStart() const;
     std::string publishScaSequenceStop() const;
+    std::string publishChannelStatisticsStart() const;
+    std::string publishChannelStatisticsStop() const;
     std::string publishRegistersSubdir(std::string name) const;
     std::string publishScaSequenceSubdir(std::string name) const;
+    std::string publishChannelStatisticsSubdir(std::string name) const;
 
   private:
     std::string format(std::string name) const;
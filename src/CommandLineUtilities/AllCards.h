@@ -0,0 +1,140 @@
+/// \file AllCards.h
+/// \brief Definition of helpers for running an operation on every card, for the utilities' --all mode.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_ALLCARDS_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_ALLCARDS_H_
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/format.hpp>
+#include "CardDescriptor.h"
+#include "ExceptionInternal.h"
+#include "ReadoutCard/CardType.h"
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+#include "RocPciDevice.h"
+#endif
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace AllCards {
+
+/// Outcome of the operation on a card
+struct Result
+{
+    CardDescriptor card;
+    /// Empty if the operation succeeded, the error otherwise
+    std::string error;
+    double seconds;
+};
+
+/// Finds the cards of the system. The enumeration is done once and cached, so the channels opened on the cards
+/// afterwards find them without enumerating again.
+inline std::vector<CardDescriptor> findCards()
+{
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+  return RocPciDevice::findSystemDevices();
+#else
+  return {};
+#endif
+}
+
+/// Calls a function for every element, concurrently, one thread per element, for work that is mostly waiting for the
+/// cards, such as mapping their BARs and reading their registers. If calls throw, the exception of the first element
+/// that failed is rethrown after all calls finished.
+template <typename Container, typename Function>
+void forEach(Container& elements, Function function)
+{
+  std::vector<std::future<void>> futures;
+  for (auto& element : elements) {
+    futures.push_back(std::async(std::launch::async, [&function, &element]{ function(element); }));
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+/// Runs an operation on every card, concurrently, one thread per card. An exception fails the operation of its card
+/// only.
+/// \return The results, in the order of the cards
+inline std::vector<Result> run(const std::vector<CardDescriptor>& cards,
+    std::function<void(const CardDescriptor&)> operation)
+{
+  std::vector<std::future<Result>> futures;
+  for (const auto& card : cards) {
+    futures.push_back(std::async(std::launch::async, [&operation, card]{
+      Result result {card, "", 0};
+      const auto start = std::chrono::steady_clock::now();
+      try {
+        operation(card);
+      } catch (const boost::exception& e) {
+        result.error = boost::diagnostic_information(e);
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+      result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return result;
+    }));
+  }
+
+  std::vector<Result> results;
+  for (auto& future : futures) {
+    results.push_back(future.get());
+  }
+  return results;
+}
+
+/// Prints a line per card, followed by the errors of the cards that failed
+/// \return The amount of cards that failed
+inline size_t printReport(std::ostream& stream, const std::vector<Result>& results)
+{
+  auto format = "  %-6s %-10s %-8s %-8s %-8s\n";
+  stream << boost::format(format) % "Type" % "PCI Addr" % "Serial" % "Seconds" % "Result";
+  size_t failures = 0;
+  for (const auto& result : results) {
+    stream << boost::format(format) % CardType::toString(result.card.cardType) % result.card.pciAddress.toString()
+        % (result.card.serialNumber ? std::to_string(*result.card.serialNumber) : "n/a")
+        % (boost::format("%.3f") % result.seconds) % (result.error.empty() ? "ok" : "FAILED");
+    if (!result.error.empty()) {
+      failures++;
+    }
+  }
+  for (const auto& result : results) {
+    if (!result.error.empty()) {
+      stream << "\nCard " << result.card.pciAddress.toString() << " failed:\n" << result.error << '\n';
+    }
+  }
+  return failures;
+}
+
+/// Finds the cards, runs an operation on every one of them and prints the report
+/// \throw Exception if no card was found, or if the operation failed on any card
+inline void runAndReport(std::ostream& stream, std::function<void(const CardDescriptor&)> operation)
+{
+  auto cards = findCards();
+  if (cards.empty()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("No cards found"));
+  }
+  auto failures = printReport(stream, run(cards, operation));
+  if (failures > 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed on " + std::to_string(failures) + " of "
+        + std::to_string(cards.size()) + " cards"));
+  }
+}
+
+} // namespace AllCards
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_ALLCARDS_H_
@@ -6,50 +6,159 @@
 #ifndef ALICEO2_READOUTCARD_BARHAMMER_H
 #define ALICEO2_READOUTCARD_BARHAMMER_H
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <vector>
 #include "Common/BasicThread.h"
 #include "Cru/Constants.h"
+#include "LatencyHistogram.h"
 #include "ReadoutCard/BarInterface.h"
+#include "Utilities/Affinity.h"
+#include "Utilities/Timestamp.h"
 
 namespace AliceO2 {
 namespace roc {
 namespace CommandLineUtilities {
 
-/// This class is for benchmarking the BAR. It "hammers" the BAR with repeated writes.
-/// It will store the amount of writes since the start, which can be used to calculate "throughput".
+/// This class is for benchmarking the BAR. It "hammers" the BAR with repeated accesses from a thread.
+/// It stores the amount of accesses since the start, which can be used to calculate "throughput", and the latency of
+/// every access in a histogram. Several can run at once, to hammer from several cores.
 class BarHammer : public AliceO2::Common::BasicThread
 {
   public:
+    enum class Mode
+    {
+      Write, ///< Posted writes, the latency is the time the CPU takes to issue a write
+      Read, ///< Reads, the latency is the round trip to the card
+      ReadAfterWrite ///< A write followed by a read of the same register, which waits for the write to land
+    };
+
+    struct Options
+    {
+        Mode mode = Mode::Write;
+        /// Width of the accesses in bits: 32, 64 or 128. Wider writes cover the following registers.
+        int width = 32;
+        /// Index of the (first) register
+        int index = Cru::Registers::DEBUG_READ_WRITE.index;
+        /// CPUs to pin the thread to, any if empty
+        std::vector<int> cpus;
+    };
+
     void start(const std::shared_ptr<BarInterface>& channelIn)
+    {
+      start(channelIn, Options());
+    }
+
+    void start(const std::shared_ptr<BarInterface>& channelIn, const Options& options)
     {
       mChannel = channelIn;
+      mOptions = options;
       BasicThread::start([&](std::atomic<bool>* stopFlag) {
         auto channel = mChannel;
         if (!channel) {
           return;
         }
+        if (!mOptions.cpus.empty()) {
+          try {
+            Utilities::setThreadAffinity(mOptions.cpus);
+          } catch (const std::exception&) {
+            // Runs unpinned, the program can check isPinFailed()
+            mPinFailed = true;
+          }
+        }
 
+        auto startTime = std::chrono::steady_clock::now();
+        auto startTicks = Utilities::getTimestampCounter();
         int64_t hammerCount = 0;
         uint32_t writeCounter = 0;
+        std::array<uint32_t, 4> values;
+        const size_t words = mOptions.width / 32;
         while (!stopFlag->load(std::memory_order_relaxed)) {
           for (int i = 0; i < MULTIPLIER; ++i) {
-            channel->writeRegister(Cru::Registers::DEBUG_READ_WRITE.index, writeCounter);
+            auto before = Utilities::getTimestampCounter();
+            switch (mOptions.mode) {
+              case Mode::Write:
+                if (words == 1) {
+                  channel->writeRegister(mOptions.index, writeCounter);
+                } else {
+                  values.fill(writeCounter);
+                  channel->writeRegistersWide(mOptions.index, values.data(), words);
+                }
+                break;
+              case Mode::Read:
+                channel->readRegister(mOptions.index);
+                break;
+              case Mode::ReadAfterWrite:
+                channel->writeRegister(mOptions.index, writeCounter);
+                // Only the lower 8 bits of the debug register can be read back
+                if ((channel->readRegister(mOptions.index) ^ writeCounter) & 0xff) {
+                  mMismatches++;
+                }
+                break;
+            }
+            mLatencies.record(Utilities::getTimestampCounter() - before);
             writeCounter++;
           }
           hammerCount++;
+          mHammerCount.store(hammerCount, std::memory_order_relaxed);
         }
-        mHammerCount.store(hammerCount, std::memory_order_relaxed);
+        mSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        mTicks = Utilities::getTimestampCounter() - startTicks;
       });
     }
 
-    double getCount()
+    /// Gets the amount of accesses. A write or read of the ReadAfterWrite mode counts as one access.
+    double getCount() const
     {
       return double(mHammerCount.load(std::memory_order_relaxed)) * double(MULTIPLIER);
     }
 
+    /// Gets the amount of bytes written or read per access
+    size_t getAccessSize() const
+    {
+      return mOptions.width / 8;
+    }
+
+    /// Gets the latencies of the accesses in timestamp counter ticks. Only valid after join().
+    const LatencyHistogram& getLatencies() const
+    {
+      return mLatencies;
+    }
+
+    /// Gets the amount of timestamp counter ticks per nanosecond. Only valid after join().
+    double getTicksPerNanosecond() const
+    {
+      return mSeconds > 0 ? double(mTicks) / (mSeconds * 1e9) : 0;
+    }
+
+    /// Gets the run time of the thread in seconds. Only valid after join().
+    double getSeconds() const
+    {
+      return mSeconds;
+    }
+
+    /// Gets the amount of ReadAfterWrite reads that did not return the written value. Only valid after join().
+    int64_t getMismatches() const
+    {
+      return mMismatches;
+    }
+
+    /// Checks if the thread could not be pinned to the CPUs of the options. Only valid after join().
+    bool isPinFailed() const
+    {
+      return mPinFailed;
+    }
+
   private:
     std::shared_ptr<BarInterface> mChannel;
-    std::atomic<int64_t> mHammerCount;
+    Options mOptions;
+    std::atomic<int64_t> mHammerCount {0};
+    LatencyHistogram mLatencies;
+    int64_t mMismatches = 0;
+    bool mPinFailed = false;
+    double mSeconds = 0;
+    uint64_t mTicks = 0;
     static constexpr int64_t MULTIPLIER {10000};
 };
 
@@ -57,4 +166,4 @@ class BarHammer : public AliceO2::Common::BasicThread
 } // namespace roc
 } // namespace AliceO2
 
-#endif // ALICEO2_READOUTCARD_BARHAMMER_H
\ No newline at end of file
+#endif // ALICEO2_READOUTCARD_BARHAMMER_H
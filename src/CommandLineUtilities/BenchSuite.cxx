@@ -0,0 +1,172 @@
+/// \file BenchSuite.cxx
+/// \brief Implementation of the configuration matrix and result comparison of roc-bench-suite.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/BenchSuite.h"
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <boost/format.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include "CommandLineUtilities/BenchmarkOutput.h"
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace BenchSuite {
+namespace pt = boost::property_tree;
+namespace {
+
+Result readResult(const pt::ptree& tree)
+{
+  Result result;
+  result.name = tree.get<std::string>("name", "");
+  result.completed = tree.get<bool>("completed", true);
+  result.gbps = tree.get<double>("gbps", 0);
+  // A null is read as the string "null", which does not convert
+  result.errors = tree.get_optional<int64_t>("errors");
+  result.tolerance = tree.get_optional<double>("tolerance");
+  return result;
+}
+
+} // Anonymous namespace
+
+std::vector<Configuration> makeConfigurations(const Matrix& matrix)
+{
+  std::vector<Configuration> configurations;
+  for (const auto& superpageSize : matrix.superpageSizes) {
+    for (auto links : matrix.linkCounts) {
+      if (links < 1) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Link count must be at least 1"));
+      }
+      for (const auto& generatorSize : matrix.generatorSizes) {
+        for (auto errorCheck : matrix.errorChecks) {
+          for (const auto& pinning : matrix.pinnings) {
+            Configuration configuration;
+            configuration.name = (boost::format("sp=%s,links=%d,size=%s,check=%s,pin=%s") % superpageSize % links
+                % generatorSize % (errorCheck ? "on" : "off") % pinning).str();
+            configuration.errorCheck = errorCheck;
+            auto& arguments = configuration.arguments;
+            arguments.push_back("--superpage-size=" + superpageSize);
+            arguments.push_back(links == 1 ? std::string("--links=0")
+                : (boost::format("--links=0-%d") % (links - 1)).str());
+            if (generatorSize == "random") {
+              arguments.push_back("--generator-random-size");
+            } else if (generatorSize != "default") {
+              arguments.push_back("--generator-size=" + generatorSize);
+            }
+            if (!errorCheck) {
+              arguments.push_back("--no-errorcheck");
+            }
+            if (pinning == "numa") {
+              arguments.push_back("--numa-pin");
+            } else if (pinning != "none") {
+              BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Pinning must be 'none' or 'numa'")
+                  << ErrorInfo::String(pinning));
+            }
+            configurations.push_back(std::move(configuration));
+          }
+        }
+      }
+    }
+  }
+  return configurations;
+}
+
+boost::optional<Result> readBenchmarkSummary(const std::string& path)
+{
+  std::ifstream stream(path);
+  std::string line;
+  boost::optional<Result> summary;
+  while (std::getline(stream, line)) {
+    if (line.find("\"type\":\"summary\"") == std::string::npos) {
+      continue;
+    }
+    pt::ptree tree;
+    std::istringstream lineStream(line);
+    try {
+      pt::read_json(lineStream, tree);
+    } catch (const pt::json_parser_error&) {
+      continue;
+    }
+    summary = readResult(tree);
+  }
+  return summary;
+}
+
+void writeResults(const std::string& path, const std::vector<Result>& results)
+{
+  std::ofstream stream(path);
+  if (!stream.is_open()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open results file")
+        << ErrorInfo::Filename(path));
+  }
+  stream << "{\"results\":[\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& result = results[i];
+    stream << "  {\"name\":\"" << BenchmarkOutput::escapeJson(result.name) << '"'
+        << ",\"completed\":" << (result.completed ? "true" : "false")
+        << ",\"gbps\":" << boost::format("%.3f") % result.gbps
+        << ",\"errors\":" << (result.errors ? std::to_string(*result.errors) : std::string("null"));
+    if (result.tolerance) {
+      stream << ",\"tolerance\":" << *result.tolerance;
+    }
+    stream << '}' << (i + 1 < results.size() ? "," : "") << '\n';
+  }
+  stream << "]}\n";
+}
+
+std::vector<Result> readResults(const std::string& path)
+{
+  pt::ptree tree;
+  try {
+    pt::read_json(path, tree);
+  } catch (const pt::json_parser_error& e) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to read results file: " + e.message())
+        << ErrorInfo::Filename(path));
+  }
+  std::vector<Result> results;
+  for (const auto& child : tree.get_child("results", pt::ptree())) {
+    results.push_back(readResult(child.second));
+  }
+  return results;
+}
+
+std::vector<std::string> compare(const std::vector<Result>& results, const std::vector<Result>& baseline,
+    double tolerance)
+{
+  std::map<std::string, const Result*> baselineByName;
+  for (const auto& result : baseline) {
+    baselineByName[result.name] = &result;
+  }
+
+  std::vector<std::string> regressions;
+  for (const auto& result : results) {
+    auto found = baselineByName.find(result.name);
+    if (found == baselineByName.end()) {
+      continue;
+    }
+    const auto& base = *found->second;
+    if (!result.completed) {
+      regressions.push_back(result.name + ": did not complete");
+      continue;
+    }
+    if (result.errors && *result.errors > 0) {
+      regressions.push_back((boost::format("%s: %d errors") % result.name % *result.errors).str());
+    }
+    const double allowed = base.gbps * (1.0 - base.tolerance.value_or(tolerance));
+    if (result.gbps < allowed) {
+      regressions.push_back((boost::format("%s: %.3f Gb/s, baseline %.3f Gb/s (at least %.3f Gb/s allowed)")
+          % result.name % result.gbps % base.gbps % allowed).str());
+    }
+  }
+  return regressions;
+}
+
+} // namespace BenchSuite
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,89 @@
+/// \file BenchSuite.h
+/// \brief Definition of the configuration matrix and result comparison of roc-bench-suite.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_BENCHSUITE_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_BENCHSUITE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// roc-bench-suite runs roc-bench-dma on every configuration of a matrix, and compares the throughput of every
+/// configuration with that of a baseline file, so regressions of the firmware or the software are caught before they
+/// reach production.
+namespace BenchSuite {
+
+/// Dimensions of the matrix. Every combination of their values is a configuration.
+struct Matrix
+{
+    /// Superpage sizes, as given to roc-bench-dma, e.g. "1Mi"
+    std::vector<std::string> superpageSizes;
+    /// Amounts of links, opened from link 0 up
+    std::vector<int> linkCounts;
+    /// Generator data sizes as given to roc-bench-dma, "default" for the driver's default, or "random" for random
+    /// sizes up to the DMA page size
+    std::vector<std::string> generatorSizes;
+    /// Error checking on or off
+    std::vector<bool> errorChecks;
+    /// Thread pinning: "none", or "numa" for the CPUs local to the card
+    std::vector<std::string> pinnings;
+};
+
+/// A configuration of the matrix
+struct Configuration
+{
+    /// Unique name, which identifies the configuration in the results and the baseline
+    std::string name;
+    /// Arguments for roc-bench-dma
+    std::vector<std::string> arguments;
+    bool errorCheck;
+};
+
+/// Result of a configuration
+struct Result
+{
+    std::string name;
+    /// Set if roc-bench-dma ran to the end. The other counters are only meaningful if it did.
+    bool completed = false;
+    /// Average throughput
+    double gbps = 0;
+    /// Amount of errors, none if error checking was off
+    boost::optional<int64_t> errors;
+    /// Allowed relative drop of the throughput, only read from the baseline. Overrides the suite's tolerance.
+    boost::optional<double> tolerance;
+};
+
+/// Makes the configurations of the matrix, in a fixed order
+std::vector<Configuration> makeConfigurations(const Matrix& matrix);
+
+/// Reads the summary of a file written by roc-bench-dma --output-json
+/// \return The result, without a name, or none if the file has no summary
+boost::optional<Result> readBenchmarkSummary(const std::string& path);
+
+/// Writes results as a JSON file, which can later be used as the baseline
+void writeResults(const std::string& path, const std::vector<Result>& results);
+
+/// Reads results written by writeResults()
+std::vector<Result> readResults(const std::string& path);
+
+/// Compares results with a baseline. A configuration regressed if it did not complete, found errors, or its
+/// throughput dropped more than the tolerance below the baseline's. Configurations that are not in the baseline are
+/// not compared.
+/// \param tolerance Allowed relative drop of the throughput, e.g. 0.05 for 5%
+/// \return Descriptions of the regressions, empty if there are none
+std::vector<std::string> compare(const std::vector<Result>& results, const std::vector<Result>& baseline,
+    double tolerance);
+
+} // namespace BenchSuite
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_BENCHSUITE_H_
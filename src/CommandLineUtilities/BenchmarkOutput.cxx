@@ -0,0 +1,160 @@
+/// \file BenchmarkOutput.cxx
+/// \brief Implementation of the BenchmarkOutput class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/BenchmarkOutput.h"
+#include <algorithm>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace {
+
+double getGbps(uint64_t bytes, double seconds)
+{
+  return seconds > 0 ? (double(bytes) * 8 / (1000.0 * 1000.0 * 1000.0)) / seconds : 0;
+}
+
+template <typename T>
+std::string optionalToString(const boost::optional<T>& value, const char* format, const char* none)
+{
+  return value ? (boost::format(format) % *value).str() : none;
+}
+
+} // Anonymous namespace
+
+BenchmarkOutput::BenchmarkOutput(const std::string& path, Format format, Configuration configuration)
+    : mStream(path), mFormat(format), mConfiguration(std::move(configuration))
+{
+  if (!mStream.is_open()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open benchmark output file")
+        << ErrorInfo::Filename(path));
+  }
+
+  if (mFormat == Format::Csv) {
+    for (const auto& entry : mConfiguration) {
+      // A value can't span lines in a comment
+      auto value = entry.second;
+      std::replace(value.begin(), value.end(), '\n', ' ');
+      mStream << "# " << entry.first << '=' << value << '\n';
+    }
+  }
+}
+
+void BenchmarkOutput::writeSample(const Sample& sample)
+{
+  write("sample", sample, getGbps(sample.bytes - mPrevious.bytes, sample.seconds - mPrevious.seconds), false);
+  mPrevious = sample;
+}
+
+void BenchmarkOutput::writeSummary(const Sample& sample)
+{
+  write("summary", sample, getGbps(sample.bytes, sample.seconds), true);
+}
+
+void BenchmarkOutput::write(const char* type, const Sample& sample, double gbps, bool withConfiguration)
+{
+  if (mFormat == Format::Json) {
+    writeJson(type, sample, gbps, withConfiguration);
+  } else {
+    writeCsv(type, sample, gbps);
+  }
+  mStream.flush();
+}
+
+void BenchmarkOutput::writeJson(const char* type, const Sample& sample, double gbps, bool withConfiguration)
+{
+  mStream << "{\"type\":\"" << type << '"'
+      << ",\"seconds\":" << boost::format("%.3f") % sample.seconds
+      << ",\"pushed\":" << sample.pushed
+      << ",\"read\":" << sample.read
+      << ",\"bytes\":" << sample.bytes
+      << ",\"payload_bytes\":" << optionalToString(sample.payloadBytes, "%d", "null")
+      << ",\"gbps\":" << boost::format("%.3f") % gbps
+      << ",\"errors\":" << optionalToString(sample.errors, "%d", "null")
+      << ",\"temperature\":" << optionalToString(sample.temperature, "%.1f", "null")
+      << ",\"queues\":{\"driver\":" << sample.driverQueue << ",\"readout\":" << sample.readoutQueue
+      << ",\"free\":" << sample.freeQueue << '}';
+
+  mStream << ",\"links\":[";
+  for (size_t i = 0; i < sample.links.size(); ++i) {
+    const auto& link = sample.links[i];
+    mStream << (i ? "," : "") << "{\"id\":" << link.linkId << ",\"superpages\":" << link.superpages << ",\"bytes\":"
+        << link.bytes << '}';
+  }
+  mStream << ']';
+
+  if (withConfiguration) {
+    mStream << ",\"configuration\":{";
+    for (size_t i = 0; i < mConfiguration.size(); ++i) {
+      mStream << (i ? "," : "") << '"' << escapeJson(mConfiguration[i].first) << "\":\""
+          << escapeJson(mConfiguration[i].second) << '"';
+    }
+    mStream << '}';
+  }
+  mStream << "}\n";
+}
+
+void BenchmarkOutput::writeCsv(const char* type, const Sample& sample, double gbps)
+{
+  if (!mCsvLinks) {
+    mCsvLinks = std::vector<uint32_t>();
+    mStream << "type,seconds,pushed,read,bytes,payload_bytes,gbps,errors,temperature,driver_queue,readout_queue,free_queue";
+    for (const auto& link : sample.links) {
+      mCsvLinks->push_back(link.linkId);
+      mStream << ",link" << link.linkId << "_bytes";
+    }
+    mStream << '\n';
+  }
+
+  mStream << type
+      << ',' << boost::format("%.3f") % sample.seconds
+      << ',' << sample.pushed
+      << ',' << sample.read
+      << ',' << sample.bytes
+      << ',' << optionalToString(sample.payloadBytes, "%d", "")
+      << ',' << boost::format("%.3f") % gbps
+      << ',' << optionalToString(sample.errors, "%d", "")
+      << ',' << optionalToString(sample.temperature, "%.1f", "")
+      << ',' << sample.driverQueue
+      << ',' << sample.readoutQueue
+      << ',' << sample.freeQueue;
+  for (auto id : *mCsvLinks) {
+    mStream << ',';
+    for (const auto& link : sample.links) {
+      if (link.linkId == id) {
+        mStream << link.bytes;
+        break;
+      }
+    }
+  }
+  mStream << '\n';
+}
+
+std::string BenchmarkOutput::escapeJson(const std::string& string)
+{
+  std::string escaped;
+  for (unsigned char c : string) {
+    switch (c) {
+      case '"': escaped += "\\\""; break;
+      case '\\': escaped += "\\\\"; break;
+      case '\n': escaped += "\\n"; break;
+      case '\r': escaped += "\\r"; break;
+      case '\t': escaped += "\\t"; break;
+      default:
+        if (c < 0x20) {
+          escaped += (boost::format("\\u%04x") % int(c)).str();
+        } else {
+          escaped += char(c);
+        }
+    }
+  }
+  return escaped;
+}
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,105 @@
+/// \file BenchmarkOutput.h
+/// \brief Definition of the BenchmarkOutput class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_BENCHMARKOUTPUT_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_BENCHMARKOUTPUT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
+#include "ReadoutCard/ChannelStatistics.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Writes benchmark results in a machine-readable format, as periodic samples followed by a summary.
+///
+/// - Json: one JSON object per line (JSON Lines). Samples have `"type":"sample"`, the last line has
+///   `"type":"summary"` and the configuration in `"configuration"`.
+/// - Csv: the configuration as `# key=value` comment lines, a header line, then one line per sample and a last line
+///   with the summary, told apart by the `type` column. The links' columns are those of the first sample.
+///
+/// The counters of a sample are totals since the start of the benchmark, so any interval can be computed from two
+/// samples. The throughput of a sample is the one since the previous sample, that of the summary is the average.
+class BenchmarkOutput
+{
+  public:
+    enum class Format
+    {
+      Json,
+      Csv
+    };
+
+    /// Names and values of the configuration of the benchmark
+    using Configuration = std::vector<std::pair<std::string, std::string>>;
+
+    /// State of the benchmark at a point in time
+    struct Sample
+    {
+        /// Seconds since the start of the benchmark
+        double seconds = 0;
+        /// Amount of superpages that arrived
+        uint64_t pushed = 0;
+        /// Amount of superpages that were read out
+        uint64_t read = 0;
+        /// Amount of bytes that were read out
+        uint64_t bytes = 0;
+        /// Amount of payload bytes in the pages that were read out, if the data format tells
+        boost::optional<uint64_t> payloadBytes;
+        /// Statistics of the links, with the bytes received per link
+        std::vector<LinkStatistics> links;
+        /// Amount of errors found, none if error checking is disabled
+        boost::optional<int64_t> errors;
+        /// Card temperature in °C, if available
+        boost::optional<float> temperature;
+        /// Amount of superpages given to the driver that did not come back yet
+        size_t driverQueue = 0;
+        /// Amount of superpages that arrived and wait for the readout
+        size_t readoutQueue = 0;
+        /// Amount of superpages that are free to be given to the driver
+        size_t freeQueue = 0;
+    };
+
+    /// \param path Path of the file, which is truncated
+    /// \param format Format to write in
+    /// \param configuration Configuration of the benchmark. It is written right away for CSV, and with the summary
+    ///        for JSON.
+    BenchmarkOutput(const std::string& path, Format format, Configuration configuration);
+
+    /// Writes a sample, and flushes it so the file can be followed while the benchmark runs
+    void writeSample(const Sample& sample);
+
+    /// Writes the summary, the last record of the file
+    void writeSummary(const Sample& sample);
+
+    /// Escapes a string for a JSON string literal, without the quotes
+    static std::string escapeJson(const std::string& string);
+
+  private:
+    void write(const char* type, const Sample& sample, double gbps, bool withConfiguration);
+    void writeJson(const char* type, const Sample& sample, double gbps, bool withConfiguration);
+    void writeCsv(const char* type, const Sample& sample, double gbps);
+
+    std::ofstream mStream;
+    Format mFormat;
+    Configuration mConfiguration;
+
+    /// Link IDs of the CSV columns, set by the first record
+    boost::optional<std::vector<uint32_t>> mCsvLinks;
+
+    /// Previous sample, for the throughput of the interval
+    Sample mPrevious;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_BENCHMARKOUTPUT_H_
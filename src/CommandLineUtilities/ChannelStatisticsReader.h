@@ -0,0 +1,89 @@
+/// \file ChannelStatisticsReader.h
+/// \brief Definition of the ChannelStatisticsReader class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_CHANNELSTATISTICSREADER_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_CHANNELSTATISTICSREADER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include "ReadoutCard/ChannelStatisticsTable.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Reads the ChannelStatisticsTable a DMA channel publishes, for the monitoring utilities. The table is mapped once it
+/// appears and stays mapped, so a sample is a copy of the table. The throughput is derived from the bytes received
+/// since the previous sample.
+class ChannelStatisticsReader
+{
+  public:
+    struct Sample
+    {
+        ChannelStatistics statistics;
+        /// False if the channel was closed, the statistics are its last ones
+        bool open;
+        /// Bytes received on all links
+        uint64_t bytes;
+        /// Throughput since the previous sample in Gb/s, 0 for the first sample and after a reset of the channel
+        double throughput;
+    };
+
+    ChannelStatisticsReader(const PciAddress& pciAddress, int channel)
+        : mPath(ChannelStatisticsTable::getPath(pciAddress, channel))
+    {
+    }
+
+    /// Takes a sample
+    /// \return The sample, or none if the channel did not publish its statistics
+    boost::optional<Sample> read()
+    {
+      if (!mFile) {
+        // Mapping a table that does not exist would create it
+        if (!boost::filesystem::exists(mPath) || boost::filesystem::file_size(mPath) < sizeof(ChannelStatisticsTable)) {
+          return boost::none;
+        }
+        mFile = std::make_unique<MemoryMappedFile>(mPath, sizeof(ChannelStatisticsTable));
+      }
+      auto table = reinterpret_cast<const ChannelStatisticsTable*>(mFile->getAddress());
+      if (!table->isValid()) {
+        return boost::none;
+      }
+
+      Sample sample;
+      sample.statistics = table->read();
+      sample.open = table->isOpen();
+      sample.bytes = 0;
+      for (const auto& link : sample.statistics.links) {
+        sample.bytes += link.bytes;
+      }
+      const auto now = std::chrono::steady_clock::now();
+      sample.throughput = 0;
+      if (mPrevious && sample.bytes >= mPreviousBytes) {
+        sample.throughput = double(sample.bytes - mPreviousBytes) * 8
+            / std::chrono::duration<double, std::nano>(now - *mPrevious).count();
+      }
+      mPrevious = now;
+      mPreviousBytes = sample.bytes;
+      return sample;
+    }
+
+  private:
+    std::string mPath;
+    std::unique_ptr<MemoryMappedFile> mFile;
+    boost::optional<std::chrono::steady_clock::time_point> mPrevious;
+    uint64_t mPreviousBytes = 0;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_CHANNELSTATISTICSREADER_H_
@@ -0,0 +1,171 @@
+/// \file ConsumerModel.cxx
+/// \brief Implementation of the ConsumerModel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/ConsumerModel.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace {
+
+constexpr int NEXT_PAUSE_MIN = 10; ///< Minimum random pause interval in milliseconds
+constexpr int NEXT_PAUSE_MAX = 2000; ///< Maximum random pause interval in milliseconds
+constexpr int PAUSE_LENGTH_MIN = 1; ///< Minimum random pause in milliseconds
+constexpr int PAUSE_LENGTH_MAX = 500; ///< Maximum random pause in milliseconds
+
+void throwModelError(const std::string& model, const std::string& message)
+{
+  BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Invalid consumer model: " + message)
+      << ErrorInfo::String(model));
+}
+
+} // Anonymous namespace
+
+constexpr std::chrono::seconds ConsumerModel::MAX_PARETO_DELAY;
+
+ConsumerModel::ConsumerModel(const std::string& model, uint64_t seed) : mRandom(seed)
+{
+  const auto colon = model.find(':');
+  const auto name = model.substr(0, colon);
+  std::vector<std::string> parameters;
+  if (colon != std::string::npos) {
+    boost::split(parameters, model.substr(colon + 1), [](char c) { return c == ','; });
+  }
+  auto expectParameters = [&](size_t count) {
+    if (parameters.size() != count) {
+      throwModelError(model, (boost::format("'%s' takes %d parameters") % name % count).str());
+    }
+  };
+
+  if (name == "none") {
+    expectParameters(0);
+    mType = Type::None;
+  } else if (name == "random") {
+    expectParameters(0);
+    mType = Type::RandomPause;
+  } else if (name == "constant") {
+    expectParameters(1);
+    mType = Type::Constant;
+    mTime = parseDuration(parameters[0]);
+  } else if (name == "stall") {
+    expectParameters(2);
+    mType = Type::Stall;
+    mTime = parseDuration(parameters[0]);
+    mLength = parseDuration(parameters[1]);
+    if (mTime.count() <= 0) {
+      throwModelError(model, "stall interval must be positive");
+    }
+  } else if (name == "pareto") {
+    expectParameters(2);
+    mType = Type::Pareto;
+    mTime = parseDuration(parameters[0]);
+    try {
+      mShape = std::stod(parameters[1]);
+    } catch (const std::exception&) {
+      throwModelError(model, "shape is not a number");
+    }
+    if (!(mShape > 0)) {
+      throwModelError(model, "shape must be positive");
+    }
+  } else {
+    throwModelError(model, "unknown model '" + name + "'");
+  }
+}
+
+std::chrono::nanoseconds ConsumerModel::getDelay(Clock::time_point now, size_t pages)
+{
+  switch (mType) {
+    case Type::None:
+      return std::chrono::nanoseconds(0);
+    case Type::RandomPause: {
+      if (mNext && now < *mNext) {
+        return std::chrono::nanoseconds(0);
+      }
+      auto random = [&](int min, int max) { return std::uniform_int_distribution<int>(min, max)(mRandom); };
+      std::chrono::nanoseconds length(0);
+      if (mNext) {
+        length = std::chrono::milliseconds(random(PAUSE_LENGTH_MIN, PAUSE_LENGTH_MAX));
+      }
+      mNext = now + length + std::chrono::milliseconds(random(NEXT_PAUSE_MIN, NEXT_PAUSE_MAX));
+      return length;
+    }
+    case Type::Constant:
+      return mTime * pages;
+    case Type::Stall:
+      if (!mNext) {
+        mNext = now + mTime;
+      }
+      if (now < *mNext) {
+        return std::chrono::nanoseconds(0);
+      }
+      // Stalls missed while the consumer was busy are not made up for
+      while (*mNext <= now) {
+        *mNext += mTime;
+      }
+      return mLength;
+    case Type::Pareto: {
+      // Inverse transform sampling, with the uniform number in (0, 1]
+      const double uniform = 1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(mRandom);
+      const double delay = double(mTime.count()) / std::pow(uniform, 1.0 / mShape);
+      const double max = std::chrono::duration_cast<std::chrono::nanoseconds>(MAX_PARETO_DELAY).count();
+      return std::chrono::nanoseconds(int64_t(std::min(delay, max)));
+    }
+  }
+  return std::chrono::nanoseconds(0);
+}
+
+std::chrono::nanoseconds ConsumerModel::consume(size_t pages)
+{
+  const auto now = Clock::now();
+  const auto delay = getDelay(now, pages);
+  if (delay.count() > 0) {
+    if (mType == Type::Constant) {
+      const auto end = now + delay;
+      while (Clock::now() < end) {
+      }
+    } else {
+      std::this_thread::sleep_for(delay);
+    }
+  }
+  return delay;
+}
+
+std::chrono::nanoseconds ConsumerModel::parseDuration(const std::string& string)
+{
+  size_t end = 0;
+  double value = 0;
+  try {
+    value = std::stod(string, &end);
+  } catch (const std::exception&) {
+    end = 0;
+  }
+  const auto unit = string.substr(end);
+  double factor = 0;
+  if (unit == "ns") {
+    factor = 1;
+  } else if (unit == "us") {
+    factor = 1e3;
+  } else if (unit == "ms") {
+    factor = 1e6;
+  } else if (unit == "s") {
+    factor = 1e9;
+  }
+  if (end == 0 || factor == 0 || value < 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(
+        "Malformed duration, expected a number with the unit ns, us, ms or s") << ErrorInfo::String(string));
+  }
+  return std::chrono::nanoseconds(int64_t(value * factor));
+}
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
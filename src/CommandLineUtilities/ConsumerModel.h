@@ -0,0 +1,88 @@
+/// \file ConsumerModel.h
+/// \brief Definition of the ConsumerModel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_CONSUMERMODEL_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_CONSUMERMODEL_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <boost/optional.hpp>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Models the time a consumer of the data takes for a superpage, so a benchmark can hold back its readout like a real
+/// one would, and show how the buffer and the card's queues cope with it.
+///
+/// Models are given as strings:
+///  - "none": no delays
+///  - "random": pauses of 1 to 500 ms every 10 to 2000 ms, regardless of the data
+///  - "constant:COST": a processing cost per DMA page, e.g. "constant:2us"
+///  - "stall:INTERVAL,LENGTH": a stall of LENGTH every INTERVAL, e.g. "stall:1s,200ms"
+///  - "pareto:SCALE,SHAPE": a delay per superpage drawn from a Pareto distribution with minimum SCALE, e.g.
+///    "pareto:50us,1.5". The lower the shape, the heavier the tail, so the delays come in rare but long bursts. A delay
+///    is at most MAX_PARETO_DELAY.
+/// Durations take the units ns, us, ms and s.
+/// An object is not thread safe, so every consumer thread needs its own.
+class ConsumerModel
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Type
+    {
+      None,
+      RandomPause,
+      Constant,
+      Stall,
+      Pareto,
+    };
+
+    /// Upper limit of a Pareto delay, which has no upper bound and, for a shape of 1 or less, not even a mean
+    static constexpr std::chrono::seconds MAX_PARETO_DELAY {1};
+
+    /// Parses the model
+    /// \param seed Seed of the random delays
+    explicit ConsumerModel(const std::string& model = "none", uint64_t seed = std::random_device()());
+
+    Type getType() const
+    {
+      return mType;
+    }
+
+    /// Gets the delay before the consumer processes a superpage
+    /// \param now Current time, which the pauses and stalls are scheduled by
+    /// \param pages Amount of DMA pages in the superpage
+    std::chrono::nanoseconds getDelay(Clock::time_point now, size_t pages);
+
+    /// Waits for the delay of a superpage. A constant cost busy-waits, since it stands for work on the CPU; the other
+    /// delays sleep.
+    /// \return The delay
+    std::chrono::nanoseconds consume(size_t pages);
+
+    /// Parses a duration with a unit, e.g. "200ms"
+    static std::chrono::nanoseconds parseDuration(const std::string& string);
+
+  private:
+    Type mType = Type::None;
+    /// Cost per page with Constant, interval with Stall, scale with Pareto
+    std::chrono::nanoseconds mTime {0};
+    /// Stall length with Stall
+    std::chrono::nanoseconds mLength {0};
+    /// Shape with Pareto
+    double mShape = 0;
+    /// Next pause or stall, unset until the first call
+    boost::optional<Clock::time_point> mNext;
+    std::mt19937_64 mRandom;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_CONSUMERMODEL_H_
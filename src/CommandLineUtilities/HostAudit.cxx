@@ -0,0 +1,248 @@
+/// \file HostAudit.cxx
+/// \brief Implementation of the HostAudit class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/HostAudit.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include "Utilities/Affinity.h"
+#include "Utilities/Hugetlbfs.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace b = boost;
+namespace bfs = boost::filesystem;
+namespace {
+
+/// Idle states with a longer exit latency than this delay the DMA completion handling noticeably
+constexpr int MAX_IDLE_LATENCY_US = 10;
+
+/// Hugepage sizes, as named in sysfs, with the hugetlbfs directories the library uses for them
+const std::vector<std::pair<std::string, Utilities::HugepageType>> HUGEPAGE_SIZES {
+    {"hugepages-2048kB", Utilities::HugepageType::Size2MiB},
+    {"hugepages-1048576kB", Utilities::HugepageType::Size1GiB}};
+
+/// Reads the first line of a file, false if it can't be read
+bool readLine(const std::string& path, std::string& line)
+{
+  std::ifstream stream(path);
+  return bool(std::getline(stream, line));
+}
+
+/// Reads a number from a file, 0 if it can't be read
+long readNumber(const std::string& path)
+{
+  std::ifstream stream(path);
+  long number = 0;
+  stream >> number;
+  return stream ? number : 0;
+}
+
+/// Formats CPUs in the sysfs list format, e.g. "0-3,8"
+std::string formatCpuList(std::vector<int> cpus)
+{
+  std::sort(cpus.begin(), cpus.end());
+  std::ostringstream stream;
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    size_t end = i;
+    while (end + 1 < cpus.size() && cpus[end + 1] == cpus[end] + 1) {
+      end++;
+    }
+    stream << (i ? "," : "") << cpus[i];
+    if (end > i) {
+      stream << '-' << cpus[end];
+    }
+    i = end;
+  }
+  return stream.str();
+}
+
+std::string removeTrailingSlash(std::string path)
+{
+  while (path.size() > 1 && path.back() == '/') {
+    path.pop_back();
+  }
+  return path;
+}
+
+} // Anonymous namespace
+
+std::vector<std::string> HostAudit::auditHost(bool iommuEnabled) const
+{
+  std::vector<std::string> warnings;
+
+  // The mount points of the hugetlbfs filesystems, from /proc/mounts
+  std::set<std::string> mounts;
+  {
+    std::ifstream stream(mPaths.proc + "/mounts");
+    std::string device, mountPoint, type, rest;
+    while (stream >> device >> mountPoint >> type && std::getline(stream, rest)) {
+      if (type == "hugetlbfs") {
+        mounts.insert(removeTrailingSlash(mountPoint));
+      }
+    }
+  }
+  for (const auto& size : HUGEPAGE_SIZES) {
+    auto directory = removeTrailingSlash(Utilities::getDirectory(size.second));
+    auto pages = readNumber(mPaths.sys + "/kernel/mm/hugepages/" + size.first + "/nr_hugepages");
+    // Without 2 MiB pages nothing works, the 1 GiB mount only matters when such pages are allocated
+    if (!mounts.count(directory) && (size.second == Utilities::HugepageType::Size2MiB || pages > 0)) {
+      warnings.push_back((b::format("hugetlbfs is not mounted at %s, buffers can't use its hugepages: run "
+          "'hugeadm --create-global-mounts' or roc-setup-hugetlbfs") % directory).str());
+    }
+  }
+
+  if (iommuEnabled) {
+    std::string commandLine;
+    readLine(mPaths.proc + "/cmdline", commandLine);
+    std::istringstream words(commandLine);
+    auto arguments = std::vector<std::string>(std::istream_iterator<std::string>(words),
+        std::istream_iterator<std::string>());
+    if (std::find(arguments.begin(), arguments.end(), "iommu=pt") == arguments.end()) {
+      warnings.push_back("The IOMMU translates the DMA addresses of the cards, which costs throughput: boot with "
+          "'iommu=pt' on the kernel command line");
+    }
+  }
+  return warnings;
+}
+
+std::vector<std::string> HostAudit::auditCard(const PciAddress& pciAddress, int numaNode) const
+{
+  auto warnings = auditHugepages(numaNode);
+
+  std::vector<int> cpus;
+  std::string cpuList;
+  if (readLine(getDeviceDirectory(pciAddress) + "/local_cpulist", cpuList)) {
+    cpus = Utilities::parseCpuList(cpuList);
+  }
+  if (cpus.empty()) {
+    warnings.push_back("The local CPUs of the card are unknown, their settings and the interrupts are not checked");
+    return warnings;
+  }
+
+  for (auto& warning : auditCpus(cpus)) {
+    warnings.push_back(std::move(warning));
+  }
+  for (auto& warning : auditInterrupts(pciAddress, cpus)) {
+    warnings.push_back(std::move(warning));
+  }
+  return warnings;
+}
+
+std::vector<std::string> HostAudit::auditHugepages(int numaNode) const
+{
+  // Without NUMA, the hugepages of the whole system are the card's
+  auto directory = numaNode >= 0
+      ? (b::format("%s/devices/system/node/node%d/hugepages/") % mPaths.sys % numaNode).str()
+      : mPaths.sys + "/kernel/mm/hugepages/";
+  const auto node = numaNode >= 0 ? (b::format("NUMA node %d") % numaNode).str() : std::string("the system");
+
+  long total = 0;
+  long free = 0;
+  for (const auto& size : HUGEPAGE_SIZES) {
+    total += readNumber(directory + size.first + "/nr_hugepages");
+    free += readNumber(directory + size.first + "/free_hugepages");
+  }
+
+  std::vector<std::string> warnings;
+  if (total == 0) {
+    warnings.push_back((b::format("No hugepages are allocated on %s of the card, its DMA buffers will be remote or "
+        "fail: write the amount to %shugepages-2048kB/nr_hugepages") % node % directory).str());
+  } else if (free == 0) {
+    warnings.push_back((b::format("All %d hugepages of %s of the card are in use: check for stale buffer files with "
+        "roc-channel-cleanup") % total % node).str());
+  }
+  return warnings;
+}
+
+std::vector<std::string> HostAudit::auditCpus(const std::vector<int>& cpus) const
+{
+  std::map<std::string, std::vector<int>> governors;
+  std::map<std::string, std::vector<int>> idleStates;
+  for (int cpu : cpus) {
+    auto directory = (b::format("%s/devices/system/cpu/cpu%d/") % mPaths.sys % cpu).str();
+
+    std::string governor;
+    if (readLine(directory + "cpufreq/scaling_governor", governor) && governor != "performance") {
+      governors[governor].push_back(cpu);
+    }
+
+    for (int state = 0; bfs::exists(directory + "cpuidle/state" + std::to_string(state)); ++state) {
+      auto stateDirectory = directory + "cpuidle/state" + std::to_string(state) + "/";
+      std::string name;
+      readLine(stateDirectory + "name", name);
+      if (readNumber(stateDirectory + "latency") > MAX_IDLE_LATENCY_US
+          && readNumber(stateDirectory + "disable") == 0) {
+        idleStates[name].push_back(cpu);
+      }
+    }
+  }
+
+  std::vector<std::string> warnings;
+  for (const auto& governor : governors) {
+    auto list = formatCpuList(governor.second);
+    warnings.push_back((b::format("CPUs %s use the '%s' frequency governor: run 'cpupower -c %s frequency-set -g "
+        "performance'") % list % governor.first % list).str());
+  }
+  for (const auto& state : idleStates) {
+    auto list = formatCpuList(state.second);
+    warnings.push_back((b::format("CPUs %s can enter the idle state %s, which takes over %d us to leave: run "
+        "'cpupower -c %s idle-set -D %d'") % list % state.first % MAX_IDLE_LATENCY_US % list
+        % MAX_IDLE_LATENCY_US).str());
+  }
+  return warnings;
+}
+
+std::vector<std::string> HostAudit::auditInterrupts(const PciAddress& pciAddress, const std::vector<int>& cpus) const
+{
+  // The MSI interrupts are the names of the files in msi_irqs, the legacy interrupt is in irq
+  std::vector<int> interrupts;
+  auto msiDirectory = getDeviceDirectory(pciAddress) + "/msi_irqs";
+  b::system::error_code error;
+  for (bfs::directory_iterator it(msiDirectory, error), end; !error && it != end; it.increment(error)) {
+    try {
+      interrupts.push_back(std::stoi(it->path().filename().string()));
+    } catch (const std::exception&) {
+    }
+  }
+  if (interrupts.empty()) {
+    auto interrupt = readNumber(getDeviceDirectory(pciAddress) + "/irq");
+    if (interrupt > 0) {
+      interrupts.push_back(interrupt);
+    }
+  }
+  std::sort(interrupts.begin(), interrupts.end());
+
+  const std::set<int> local(cpus.begin(), cpus.end());
+  std::vector<std::string> warnings;
+  for (int interrupt : interrupts) {
+    auto path = (b::format("%s/irq/%d/smp_affinity_list") % mPaths.proc % interrupt).str();
+    std::string affinity;
+    if (!readLine(path, affinity)) {
+      continue;
+    }
+    auto affinityCpus = Utilities::parseCpuList(affinity);
+    if (std::any_of(affinityCpus.begin(), affinityCpus.end(), [&](int cpu) { return !local.count(cpu); })) {
+      warnings.push_back((b::format("Interrupt %d can be handled by CPUs %s, not all local to the card: run "
+          "'echo %s > %s'") % interrupt % formatCpuList(affinityCpus) % formatCpuList(cpus) % path).str());
+    }
+  }
+  return warnings;
+}
+
+std::string HostAudit::getDeviceDirectory(const PciAddress& pciAddress) const
+{
+  return (b::format("%s/bus/pci/devices/0000:%s") % mPaths.sys % pciAddress.toString()).str();
+}
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
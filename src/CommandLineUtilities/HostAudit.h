@@ -0,0 +1,65 @@
+/// \file HostAudit.h
+/// \brief Definition of the HostAudit class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_HOSTAUDIT_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_HOSTAUDIT_H_
+
+#include <string>
+#include <vector>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Checks the host settings that reduce DMA performance, from sysfs and procfs. Every check returns a warning per
+/// problem, with the command that fixes it, and nothing if the setting is fine. Settings the kernel doesn't expose,
+/// for example the governor of a CPU without cpufreq, are not checked.
+class HostAudit
+{
+  public:
+    /// Roots of the filesystems the audit reads, so it can be pointed at a copy
+    struct Paths
+    {
+        std::string sys;
+        std::string proc;
+    };
+
+    /// Audits the host's /sys and /proc
+    HostAudit()
+        : HostAudit(Paths{"/sys", "/proc"})
+    {
+    }
+
+    explicit HostAudit(Paths paths)
+        : mPaths(paths)
+    {
+    }
+
+    /// Checks the settings of the host: the hugetlbfs mounts the library creates its buffers in, and the IOMMU
+    /// \param iommuEnabled Whether the IOMMU is enabled, see Common::Iommu::isEnabled()
+    std::vector<std::string> auditHost(bool iommuEnabled) const;
+
+    /// Checks the settings that matter to a card: the hugepages of its NUMA node, the frequency governor and idle
+    /// states of its local CPUs, and the affinity of its interrupts
+    /// \param pciAddress The card
+    /// \param numaNode NUMA node of the card, negative if the host has none
+    std::vector<std::string> auditCard(const PciAddress& pciAddress, int numaNode) const;
+
+  private:
+    std::vector<std::string> auditHugepages(int numaNode) const;
+    std::vector<std::string> auditCpus(const std::vector<int>& cpus) const;
+    std::vector<std::string> auditInterrupts(const PciAddress& pciAddress, const std::vector<int>& cpus) const;
+
+    std::string getDeviceDirectory(const PciAddress& pciAddress) const;
+
+    Paths mPaths;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_HOSTAUDIT_H_
@@ -0,0 +1,113 @@
+/// \file HugepageProvisioner.cxx
+/// \brief Implementation of the HugepageProvisioner class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/HugepageProvisioner.h"
+#include <algorithm>
+#include <fstream>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace b = boost;
+namespace {
+constexpr size_t SIZE_2MiB = 2*1024*1024;
+constexpr size_t SIZE_1GiB = 1*1024*1024*1024;
+
+/// Reads an amount of hugepages, 0 if the file doesn't exist, as for 1 GiB pages on CPUs that don't support them
+size_t readPages(const std::string& path)
+{
+  std::ifstream stream(path);
+  size_t pages = 0;
+  if (stream.is_open() && !(stream >> pages)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to read hugepages") << ErrorInfo::Filename(path));
+  }
+  return pages;
+}
+
+void writePages(const std::string& path, size_t pages)
+{
+  std::ofstream stream(path);
+  stream << pages << std::flush;
+  if (!stream) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to allocate hugepages")
+        << ErrorInfo::Filename(path)
+        << ErrorInfo::PossibleCauses({"Not running as root"}));
+  }
+}
+
+std::string nodeName(int numaNode)
+{
+  return numaNode >= 0 ? (b::format("NUMA node %d") % numaNode).str() : std::string("the system");
+}
+} // Anonymous namespace
+
+auto HugepageProvisioner::makePlan(const std::vector<int>& cardNumaNodes, int channelsPerCard, size_t bufferSize)
+    -> Plan
+{
+  if (bufferSize == 0 || bufferSize % SIZE_2MiB != 0) {
+    BOOST_THROW_EXCEPTION(InvalidOptionValueException()
+        << ErrorInfo::Message("Buffer size not a multiple of 2 MiB"));
+  }
+  Plan plan;
+  for (int numaNode : cardNumaNodes) {
+    auto& pages = plan.emplace(numaNode, Pages{0, 0}).first->second;
+    if (bufferSize % SIZE_1GiB == 0) {
+      pages.pages1GiB += channelsPerCard * (bufferSize / SIZE_1GiB);
+    } else {
+      pages.pages2MiB += channelsPerCard * (bufferSize / SIZE_2MiB);
+    }
+  }
+  return plan;
+}
+
+auto HugepageProvisioner::getAllocated(int numaNode) const -> Pages
+{
+  return {readPages(getFile(numaNode, false)), readPages(getFile(numaNode, true))};
+}
+
+void HugepageProvisioner::allocate(const Plan& plan) const
+{
+  for (const auto& node : plan) {
+    auto allocated = getAllocated(node.first);
+    if (node.second.pages1GiB > allocated.pages1GiB) {
+      writePages(getFile(node.first, true), node.second.pages1GiB);
+    }
+    if (node.second.pages2MiB > allocated.pages2MiB) {
+      writePages(getFile(node.first, false), node.second.pages2MiB);
+    }
+  }
+}
+
+std::vector<std::string> HugepageProvisioner::verify(const Plan& plan) const
+{
+  std::vector<std::string> messages;
+  for (const auto& node : plan) {
+    auto allocated = getAllocated(node.first);
+    auto check = [&](size_t required, size_t pages, const char* size) {
+      if (pages < required) {
+        messages.push_back((b::format("%s has %d hugepages of %s, %d are needed") % nodeName(node.first) % pages % size
+            % required).str());
+      }
+    };
+    check(node.second.pages2MiB, allocated.pages2MiB, "2 MiB");
+    check(node.second.pages1GiB, allocated.pages1GiB, "1 GiB");
+  }
+  return messages;
+}
+
+std::string HugepageProvisioner::getFile(int numaNode, bool size1GiB) const
+{
+  // Without NUMA, the pages are allocated system-wide
+  auto directory = numaNode >= 0
+      ? (b::format("%s/devices/system/node/node%d/hugepages/") % mSysPath % numaNode).str()
+      : mSysPath + "/kernel/mm/hugepages/";
+  return directory + (size1GiB ? "hugepages-1048576kB" : "hugepages-2048kB") + "/nr_hugepages";
+}
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
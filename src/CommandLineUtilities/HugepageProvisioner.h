@@ -0,0 +1,70 @@
+/// \file HugepageProvisioner.h
+/// \brief Definition of the HugepageProvisioner class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_HUGEPAGEPROVISIONER_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_HUGEPAGEPROVISIONER_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Allocates the hugepages the DMA buffers of the cards need on the NUMA nodes of the cards, through the per-node
+/// sysfs files, so the buffers mapped with Utilities::tryMapFile() on the card's node find their pages there.
+class HugepageProvisioner
+{
+  public:
+    /// Amounts of hugepages of each size
+    struct Pages
+    {
+        size_t pages2MiB;
+        size_t pages1GiB;
+    };
+
+    /// Hugepages needed per NUMA node, negative for a host without NUMA
+    using Plan = std::map<int, Pages>;
+
+    /// Computes the hugepages the buffers need. Like Utilities::tryMapFile(), a buffer that is a multiple of 1 GiB
+    /// uses 1 GiB pages, another one 2 MiB pages.
+    /// \param cardNumaNodes The NUMA node of every card
+    /// \param channelsPerCard Amount of channels with a buffer on every card
+    /// \param bufferSize Size of the buffer of a channel
+    /// \throw InvalidOptionValueException if the buffer size is not a multiple of 2 MiB
+    static Plan makePlan(const std::vector<int>& cardNumaNodes, int channelsPerCard, size_t bufferSize);
+
+    /// \param sysPath Root of the sysfs filesystem
+    explicit HugepageProvisioner(std::string sysPath = "/sys")
+        : mSysPath(sysPath)
+    {
+    }
+
+    /// Gets the hugepages allocated on a NUMA node, free or not
+    Pages getAllocated(int numaNode) const;
+
+    /// Raises the hugepages allocated on every node of the plan to what it needs. Allocations are never lowered, the
+    /// pages may be in use.
+    /// \throw Exception if the sysfs files could not be written, usually because the caller is not root
+    void allocate(const Plan& plan) const;
+
+    /// Compares the allocated hugepages with the plan. The kernel allocates fewer pages than asked for when the node's
+    /// memory is too fragmented or too small.
+    /// \return A message per node and size that is short of pages, empty if none is
+    std::vector<std::string> verify(const Plan& plan) const;
+
+  private:
+    std::string getFile(int numaNode, bool size1GiB) const;
+
+    std::string mSysPath;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_HUGEPAGEPROVISIONER_H_
@@ -0,0 +1,181 @@
+/// \file MemoryBandwidth.cxx
+/// \brief Implementation of functions to measure the host memory bandwidth.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/MemoryBandwidth.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <thread>
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+#include "Utilities/AlignedAllocator.h"
+#include "Utilities/Affinity.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace MemoryBandwidth {
+namespace {
+/// Amount of bytes a thread processes between checks of the stop flag
+constexpr size_t CHUNK_SIZE = 1024 * 1024;
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream stream(path);
+  if (!stream.is_open()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open file") << ErrorInfo::Filename(path));
+  }
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  return buffer.str();
+}
+
+/// Rounds down to a multiple of the cache line size, so every slice and chunk starts on a cache line
+size_t alignDown(size_t size)
+{
+  return size & ~(Utilities::CACHE_LINE_SIZE - 1);
+}
+} // Anonymous namespace
+
+uint64_t read(const void* address, size_t size)
+{
+  // Independent sums, so the loads are not serialized by the additions
+  auto words = static_cast<const uint64_t*>(address);
+  const size_t count = size / sizeof(uint64_t);
+  uint64_t sums[4] = {0, 0, 0, 0};
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    sums[0] += words[i];
+    sums[1] += words[i + 1];
+    sums[2] += words[i + 2];
+    sums[3] += words[i + 3];
+  }
+  for (; i < count; ++i) {
+    sums[0] += words[i];
+  }
+  return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+void writeNonTemporal(void* address, size_t size, uint32_t value)
+{
+#if defined(__SSE2__)
+  const __m128i vector = _mm_set1_epi32(int(value));
+  auto destination = static_cast<__m128i*>(address);
+  for (size_t i = 0; i < size / sizeof(__m128i); ++i) {
+    _mm_stream_si128(destination + i, vector);
+  }
+  _mm_sfence();
+#else
+  std::fill_n(static_cast<uint32_t*>(address), size / sizeof(uint32_t), value);
+#endif
+}
+
+void copy(void* destination, const void* source, size_t size)
+{
+#if defined(__SSE2__)
+  auto from = static_cast<const __m128i*>(source);
+  auto to = static_cast<__m128i*>(destination);
+  for (size_t i = 0; i < size / sizeof(__m128i); ++i) {
+    _mm_stream_si128(to + i, _mm_loadu_si128(from + i));
+  }
+  _mm_sfence();
+#else
+  std::memcpy(destination, source, size);
+#endif
+}
+
+double measure(Operation operation, void* address, size_t size, const std::vector<int>& cpus,
+    std::chrono::milliseconds duration)
+{
+  const size_t threads = std::max<size_t>(cpus.size(), 1);
+  // For a copy, every thread copies its slice of the first half into its slice of the second half
+  const size_t regionSize = operation == Operation::Copy ? size / 2 : size;
+  const size_t sliceSize = alignDown(regionSize / threads);
+  if (sliceSize == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Region too small for the amount of threads"));
+  }
+
+  std::atomic<bool> go(false);
+  std::atomic<bool> stop(false);
+  std::vector<std::future<uint64_t>> futures;
+  for (size_t t = 0; t < threads; ++t) {
+    futures.push_back(std::async(std::launch::async, [&, t]{
+      if (!cpus.empty()) {
+        Utilities::setThreadAffinity(std::vector<int>{cpus[t]});
+      }
+      auto slice = static_cast<char*>(address) + t * sliceSize;
+      uint64_t bytes = 0;
+      uint64_t sum = 0;
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (size_t offset = 0; offset < sliceSize && !stop.load(std::memory_order_relaxed); offset += CHUNK_SIZE) {
+          const size_t chunk = std::min(CHUNK_SIZE, sliceSize - offset);
+          switch (operation) {
+            case Operation::Read:
+              sum += read(slice + offset, chunk);
+              break;
+            case Operation::NonTemporalWrite:
+              writeNonTemporal(slice + offset, chunk, uint32_t(bytes));
+              break;
+            case Operation::Copy:
+              copy(slice + regionSize + offset, slice + offset, chunk);
+              break;
+          }
+          bytes += chunk;
+        }
+      }
+      // Keeps the reads from being optimized away
+      volatile uint64_t sink = sum;
+      (void) sink;
+      return bytes;
+    }));
+  }
+
+  // The threads run until the duration is up, then finish their chunk. Those last chunks count, so the time does too.
+  const auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  uint64_t bytes = 0;
+  std::exception_ptr error;
+  for (auto& future : futures) {
+    try {
+      bytes += future.get();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return seconds > 0 ? double(bytes) / seconds : 0;
+}
+
+std::map<int, std::vector<int>> getNumaNodeCpus(const std::string& sysPath)
+{
+  std::map<int, std::vector<int>> nodes;
+  const auto directory = sysPath + "/devices/system/node/";
+  if (!boost::filesystem::exists(directory + "online")) {
+    return nodes;
+  }
+  for (int node : Utilities::parseCpuList(readFile(directory + "online"))) {
+    nodes[node] = Utilities::parseCpuList(readFile(directory + "node" + std::to_string(node) + "/cpulist"));
+  }
+  return nodes;
+}
+
+} // namespace MemoryBandwidth
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,69 @@
+/// \file MemoryBandwidth.h
+/// \brief Definition of functions to measure the host memory bandwidth.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_MEMORYBANDWIDTH_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_MEMORYBANDWIDTH_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace MemoryBandwidth {
+
+/// The memory access patterns of readout processing
+enum class Operation
+{
+  /// Sequential reads, as done by a consumer scanning a superpage
+  Read,
+  /// Non-temporal writes, as done when poisoning pages or producing output that is not read back soon
+  NonTemporalWrite,
+  /// Sequential reads with non-temporal writes to another region, as done when copying superpages out of the DMA buffer
+  Copy,
+};
+
+/// Reads a region sequentially
+/// \return The sum of its 64-bit words, so the reads are not optimized away
+uint64_t read(const void* address, size_t size);
+
+/// Fills a region with a 32-bit value using non-temporal stores, which bypass the caches
+/// \param address Start of the region, 16 byte aligned
+/// \param size Size of the region, a multiple of 16 bytes
+void writeNonTemporal(void* address, size_t size, uint32_t value);
+
+/// Copies a region using regular loads and non-temporal stores
+/// \param destination Start of the destination, 16 byte aligned
+/// \param size Size of the region, a multiple of 16 bytes
+void copy(void* destination, const void* source, size_t size);
+
+/// Measures the bandwidth of an operation on a region, with one thread per CPU, each pinned to its CPU and working on
+/// its own slice of the region. For Copy, the first half of the region is copied into the second half.
+/// \param operation The operation
+/// \param address Start of the region, 64 byte aligned
+/// \param size Size of the region
+/// \param cpus CPUs to run the threads on. If empty, a single unpinned thread is used.
+/// \param duration How long the threads repeat the operation
+/// \return The bandwidth in bytes per second. For Copy, the bytes copied, not the bytes read plus written.
+double measure(Operation operation, void* address, size_t size, const std::vector<int>& cpus,
+    std::chrono::milliseconds duration);
+
+/// Gets the NUMA nodes of the system and their CPUs, from the `devices/system/node` sysfs directory. Nodes with
+/// memory but no CPUs are included with an empty list.
+/// \param sysPath Root of the sysfs filesystem
+/// \return The CPUs per node, empty on a system without NUMA
+/// \throw Exception if a CPU list could not be read or parsed
+std::map<int, std::vector<int>> getNumaNodeCpus(const std::string& sysPath = "/sys");
+
+} // namespace MemoryBandwidth
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_MEMORYBANDWIDTH_H_
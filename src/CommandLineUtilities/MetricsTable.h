@@ -0,0 +1,97 @@
+/// \file MetricsTable.h
+/// \brief Definition of the MetricsTable struct, the shared-memory table of roc-metrics.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_METRICSTABLE_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_METRICSTABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Table of card metrics that `roc-metrics --shm=[name]` keeps up to date in /dev/shm, so monitoring agents can read
+/// the latest sample without touching the cards.
+/// This struct is meant to be used as an aliased type, reinterpret_casted from the mapped file. It is guarded by a
+/// sequence lock: the writer makes the sequence odd while it writes, so readers copy the table and retry if the
+/// sequence was odd or changed in the meantime.
+struct MetricsTable
+{
+    static constexpr uint64_t MAGIC = 0x524f434d45545243;
+    static constexpr uint32_t VERSION = 1;
+    static constexpr int MAX_CARDS = 32;
+
+    /// Gets the path of the table with the given name
+    static std::string getPath(const std::string& name)
+    {
+      return "/dev/shm/AliceO2_RoC_Metrics_" + name;
+    }
+
+    struct Entry
+    {
+        char pciAddress[16]; ///< Null-terminated
+        char cardType[8]; ///< Null-terminated
+        float temperature; ///< In degrees Celsius
+        int32_t droppedPackets;
+        float ctpClock; ///< In MHz
+        float localClock; ///< In MHz
+        int32_t links;
+        int32_t linksWrapper0;
+        int32_t linksWrapper1;
+    };
+
+    /// Starts a write of the samples
+    void beginWrite()
+    {
+      sequence.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /// Ends a write of the samples
+    void endWrite()
+    {
+      sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    /// Copies the table consistently
+    /// \param copy Table to copy into. Its sequence is not used.
+    void read(MetricsTable& copy) const
+    {
+      while (true) {
+        auto before = sequence.load(std::memory_order_acquire);
+        if (before % 2 == 0) {
+          copy.magic = magic;
+          copy.version = version;
+          copy.cardCount = cardCount;
+          copy.timestamp = timestamp;
+          for (int i = 0; i < MAX_CARDS; ++i) {
+            copy.entries[i] = entries[i];
+          }
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (sequence.load(std::memory_order_relaxed) == before) {
+            return;
+          }
+        }
+      }
+    }
+
+    uint64_t magic;
+    uint32_t version;
+    /// Amount of valid entries
+    uint32_t cardCount;
+    /// Odd while the writer is writing
+    std::atomic<uint64_t> sequence;
+    /// Time of the sample, in nanoseconds since the epoch
+    uint64_t timestamp;
+    Entry entries[MAX_CARDS];
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_METRICSTABLE_H_
@@ -94,6 +94,12 @@ void addOptionCardId(po::options_description& options)
   addOption(option::cardId, options);
 }
 
+void addOptionAllCards(po::options_description& options)
+{
+  options.add_options()("all", po::bool_switch(),
+      "Act on every card of the system, concurrently, instead of the card of the --id");
+}
+
 void addOptionRegisterAddress(po::options_description& options)
 {
   addOption(option::registerAddress, options);
@@ -207,6 +213,11 @@ std::string getOptionCardIdString(const po::variables_map& map)
   return getOption(option::cardId, map);
 }
 
+bool getOptionAllCards(const po::variables_map& map)
+{
+  return map.count("all") && map.at("all").as<bool>();
+}
+
 } // namespace Options
 } // namespace Util
 } // namespace roc
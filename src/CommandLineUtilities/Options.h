@@ -26,6 +26,7 @@ void addOptionRegisterRange(boost::program_options::options_description& options
 void addOptionChannel(boost::program_options::options_description& options);
 void addOptionResetLevel(boost::program_options::options_description& options);
 void addOptionCardId(boost::program_options::options_description& options);
+void addOptionAllCards(boost::program_options::options_description& options);
 
 int getOptionRegisterAddress(const boost::program_options::variables_map& map);
 int getOptionRegisterValue(const boost::program_options::variables_map& map);
@@ -33,6 +34,7 @@ int getOptionChannel(const boost::program_options::variables_map& map);
 ResetLevel::type getOptionResetLevel(const boost::program_options::variables_map& map);
 Parameters::CardIdType getOptionCardId(const boost::program_options::variables_map& map);
 std::string getOptionCardIdString(const boost::program_options::variables_map& map);
+bool getOptionAllCards(const boost::program_options::variables_map& map);
 int getOptionRegisterRange(const boost::program_options::variables_map& map);
 
 } // namespace Options
@@ -0,0 +1,117 @@
+/// \file PerfCounters.cxx
+/// \brief Implementation of the PerfCounters class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace {
+
+struct Event
+{
+    uint32_t type;
+    uint64_t config;
+};
+
+/// The events, in the order of PerfCounters::Counts
+constexpr Event EVENT_TYPES[] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+int openEvent(const Event& event, bool userOnly)
+{
+  perf_event_attr attributes;
+  std::memset(&attributes, 0, sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.type = event.type;
+  attributes.config = event.config;
+  attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attributes.exclude_kernel = userOnly;
+  attributes.exclude_hv = 1;
+  // The calling thread, on any CPU
+  return int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+boost::optional<uint64_t> readEvent(int fileDescriptor)
+{
+  if (fileDescriptor == -1) {
+    return boost::none;
+  }
+  uint64_t values[3]; // Value, time enabled, time running
+  if (::read(fileDescriptor, values, sizeof(values)) != sizeof(values)) {
+    return boost::none;
+  }
+  if (values[2] == 0 || values[2] == values[1]) {
+    return values[0];
+  }
+  return uint64_t(double(values[0]) * double(values[1]) / double(values[2]));
+}
+
+void add(boost::optional<uint64_t>& sum, const boost::optional<uint64_t>& value)
+{
+  if (value) {
+    sum = sum.value_or(0) + *value;
+  }
+}
+
+} // Anonymous namespace
+
+PerfCounters::Counts& PerfCounters::Counts::operator+=(const Counts& other)
+{
+  add(cycles, other.cycles);
+  add(instructions, other.instructions);
+  add(llcMisses, other.llcMisses);
+  add(contextSwitches, other.contextSwitches);
+  return *this;
+}
+
+PerfCounters::PerfCounters()
+{
+  for (int i = 0; i < EVENTS; ++i) {
+    mFileDescriptors[i] = openEvent(EVENT_TYPES[i], mUserOnly);
+    if (mFileDescriptors[i] == -1 && (errno == EACCES || errno == EPERM) && !mUserOnly) {
+      // Not allowed to count the kernel, so all events count user space only to be comparable
+      mUserOnly = true;
+      for (int j = 0; j < i; ++j) {
+        if (mFileDescriptors[j] != -1) {
+          close(mFileDescriptors[j]);
+        }
+      }
+      i = -1;
+    }
+  }
+}
+
+PerfCounters::~PerfCounters()
+{
+  for (auto fileDescriptor : mFileDescriptors) {
+    if (fileDescriptor != -1) {
+      close(fileDescriptor);
+    }
+  }
+}
+
+PerfCounters::Counts PerfCounters::read() const
+{
+  Counts counts;
+  counts.cycles = readEvent(mFileDescriptors[0]);
+  counts.instructions = readEvent(mFileDescriptors[1]);
+  counts.llcMisses = readEvent(mFileDescriptors[2]);
+  counts.contextSwitches = readEvent(mFileDescriptors[3]);
+  return counts;
+}
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,69 @@
+/// \file PerfCounters.h
+/// \brief Definition of the PerfCounters class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_PERFCOUNTERS_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_PERFCOUNTERS_H_
+
+#include <array>
+#include <cstdint>
+#include <boost/optional.hpp>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Counts PMU events of the thread that created it with perf_event_open(), so a benchmark can tell how much CPU work
+/// each of its threads spends on the data.
+///
+/// Events the CPU or the kernel does not offer, e.g. hardware events in a virtual machine, are not counted. If the
+/// kernel does not allow counting in the kernel (see /proc/sys/kernel/perf_event_paranoid), only user space is counted.
+/// When the PMU has fewer counters than there are events, the kernel multiplexes them and the counts are scaled up.
+class PerfCounters
+{
+  public:
+    /// Counts since the counters were opened, unset if the event is not counted
+    struct Counts
+    {
+        boost::optional<uint64_t> cycles;
+        boost::optional<uint64_t> instructions;
+        /// Cache misses, which most CPUs count at the last-level cache
+        boost::optional<uint64_t> llcMisses;
+        boost::optional<uint64_t> contextSwitches;
+
+        /// Adds the counts of another thread. An event stays unset if neither counted it.
+        Counts& operator+=(const Counts& other);
+    };
+
+    /// Opens the counters of the calling thread and starts counting
+    PerfCounters();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// Reads the counts. Can be called from any thread.
+    Counts read() const;
+
+    /// Checks if the kernel only counts user space
+    bool isUserOnly() const
+    {
+      return mUserOnly;
+    }
+
+  private:
+    static constexpr int EVENTS = 4;
+
+    /// File descriptors of the events, in the order of Counts, -1 for the events not counted
+    std::array<int, EVENTS> mFileDescriptors;
+
+    bool mUserOnly = false;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_PERFCOUNTERS_H_
@@ -7,9 +7,15 @@
 #include <iomanip>
 #include <cstdint>
 #include <chrono>
+#include <map>
+#include <mutex>
 #include <thread>
 #include <cstddef>
+#include <vector>
+#include <boost/format.hpp>
 #include "Cru/Constants.h"
+#include "ExceptionInternal.h"
+#include "LatencyHistogram.h"
 #include "ReadoutCard/ChannelFactory.h"
 #include "Swt/Swt.h"
 #include "CommandLineUtilities/Options.h"
@@ -27,7 +33,8 @@ class ProgramBarStress: public Program
   virtual Description getDescription()
   {
     return {"Bar Stress", "Stress the Bar Accessor", 
-      "roc-bar-stress --pci-address 42:00.0 --gbt-link 0 --cycles 100000 --print-freq 10000 --errorcheck"};
+      "roc-bar-stress --pci-address 42:00.0 --gbt-link 0 --cycles 100000 --print-freq 10000 --errorcheck\n"
+      "roc-bar-stress --pci-address 42:00.0 --links 0-3 --cycles 100000 --errorcheck"};
   }
 
   virtual void addOptions(boost::program_options::options_description& options)
@@ -39,6 +46,10 @@ class ProgramBarStress: public Program
       ("gbt-link",
        po::value<uint32_t>(&mOptions.gbtLink)->default_value(0),
        "GBT link over which the bar writes will be performed. CRU is 0-17")
+      ("links",
+       po::value<std::string>(&mOptions.links),
+       "GBT links to stress concurrently, one thread per link, instead of the --gbt-link. A comma separated list of "
+       "integers or ranges, e.g. '0,2,5-10'")
       ("cycles",
        po::value<long long>(&mOptions.cycles)->default_value(100),
        "Cycles of SWT writes(/reads) to perform")
@@ -50,7 +61,19 @@ class ProgramBarStress: public Program
        "Perform data validation");
   }
 
-  int stress(Swt *swt, long long cycles, long long printFrequency, bool errorCheck) 
+  /// Latencies of the operations on a link, in nanoseconds
+  struct LinkLatencies
+  {
+    LatencyHistogram write;
+    LatencyHistogram read;
+    /// A write, the read of the word back, and the comparison
+    LatencyHistogram verify;
+  };
+
+  /// Stresses a link. With several links, every link has a thread, and they share the SWT core through the mutex: an
+  /// operation takes it and switches the core to its link, and the latencies include the wait for it.
+  int stress(Swt *swt, uint32_t link, std::mutex* mutex, long long cycles, long long printFrequency,
+      bool errorCheck, LinkLatencies& latencies)
   {
 
     SwtWord swtWordWr = SwtWord(0x0, 0x0, 0x0);
@@ -59,6 +82,22 @@ class ProgramBarStress: public Program
     /* swtWordCheck for testing */
     // SwtWord swtWordCheck = SwtWord(0x42, 0x42, 0x42);
 
+    // Only a single link reports its progress, the threads of several links would interleave their lines
+    const bool report = mutex == nullptr;
+
+    auto timed = [&](LatencyHistogram& histogram, auto operation) {
+      auto before = std::chrono::steady_clock::now();
+      std::unique_lock<std::mutex> lock;
+      if (mutex) {
+        lock = std::unique_lock<std::mutex>(*mutex);
+        swt->setChannel(link);
+      }
+      auto mon = operation();
+      histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - before)
+          .count());
+      return mon;
+    };
+
     std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
     std::chrono::high_resolution_clock::time_point finish = std::chrono::high_resolution_clock::now();
 
@@ -67,24 +106,35 @@ class ProgramBarStress: public Program
       swtWordWr.setMed((0x2 + i)%0xffffffff); 
       swtWordWr.setHigh((0x3 + i)%0xffff);
       
-      uint32_t mon = swt->write(swtWordWr);
-      if (isVerbose())
+      auto cycleStart = std::chrono::steady_clock::now();
+      uint32_t mon = timed(latencies.write, [&]{ return swt->write(swtWordWr); });
+      if (isVerbose() && report)
         getLogger() << "WR MON: 0x" << std::setfill('0') << std::hex << mon << InfoLogger::endm;
      
       if (errorCheck){
-        uint32_t mon = swt->read(swtWordRd);
+        uint32_t mon = timed(latencies.read, [&]{ return swt->read(swtWordRd); });
         if (swtWordRd != swtWordWr){
-          getLogger() << "SWT validation failed" << InfoLogger::endm;
+          std::lock_guard<std::mutex> lock(mLogMutex);
+          getLogger() << "SWT validation failed on link " << link << InfoLogger::endm;
           getLogger() << "Read: " << swtWordRd << " | Expected: " << swtWordWr << InfoLogger::endm;
           return -1;
         }
+        latencies.verify.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - cycleStart).count());
         
-        if (isVerbose()){
+        if (isVerbose() && report){
           getLogger() << "RD MON: 0x" << std::setfill('0') << std::hex << mon << InfoLogger::endm;
           getLogger() << "Read swtWord: " << swtWordRd << InfoLogger::endm;
         }
       }
 
+      if (!report) {
+        if (i + 1 == cycles || isSigInt()) {
+          return i + 1;
+        }
+        continue;
+      }
+
       if (i && (i%printFrequency == 0)){
         finish = std::chrono::high_resolution_clock::now();
         getLogger() << "loops [" << i-printFrequency+1 << " - " << i  << "]: " <<
@@ -104,6 +154,39 @@ class ProgramBarStress: public Program
     }
   }
 
+  /// Prints the latency distributions per link, and of all links if there are several
+  void printLatencies(const std::map<uint32_t, LinkLatencies>& latencies, double seconds)
+  {
+    auto format = boost::format("  %-6s  %-8s  %-12d  %-10.0f  %-10d  %-10d  %-10d\n");
+    std::cout << '\n' << boost::format("  %-6s  %-8s  %-12s  %-10s  %-10s  %-10s  %-10s\n") % "Link" % "SWT (ns)"
+        % "Operations" % "Ops/s" % "p50" % "p99" % "Max";
+
+    auto put = [&](const std::string& link, const LinkLatencies& linkLatencies) {
+      auto row = [&](const char* operation, const LatencyHistogram& histogram) {
+        if (histogram.getCount() == 0) {
+          return;
+        }
+        std::cout << format % link % operation % histogram.getCount()
+            % (seconds > 0 ? double(histogram.getCount()) / seconds : 0) % histogram.getPercentile(50)
+            % histogram.getPercentile(99) % histogram.getMax();
+      };
+      row("write", linkLatencies.write);
+      row("read", linkLatencies.read);
+      row("verify", linkLatencies.verify);
+    };
+
+    LinkLatencies total;
+    for (const auto& kv : latencies) {
+      put(std::to_string(kv.first), kv.second);
+      total.write.merge(kv.second.write);
+      total.read.merge(kv.second.read);
+      total.verify.merge(kv.second.verify);
+    }
+    if (latencies.size() > 1) {
+      put("all", total);
+    }
+  }
+
   virtual void run(const boost::program_options::variables_map& map) 
   {
 
@@ -131,30 +214,65 @@ class ProgramBarStress: public Program
       getLogger() << "Resetting card..." << InfoLogger::endm;
     bar0->writeRegister(Cru::Registers::RESET_CONTROL.index, 0x1);
 
+    auto links = mOptions.links.empty() ? Parameters::LinkMaskType{mOptions.gbtLink}
+        : Parameters::linkMaskFromString(mOptions.links);
+    if (links.empty()) {
+      BOOST_THROW_EXCEPTION(InvalidOptionValueException() << ErrorInfo::Message("No links given"));
+    }
+
     if(isVerbose())
       getLogger() << "Initializing SWT..." << InfoLogger::endm;
-    auto swt = Swt(*bar2, mOptions.gbtLink);
+    auto swt = Swt(*bar2, *links.begin());
 
     if(isVerbose())
       getLogger() << "Running operations..." << InfoLogger::endm;
   
+    std::map<uint32_t, LinkLatencies> latencies;
+    std::map<uint32_t, long long> cyclesRun;
     auto start = std::chrono::high_resolution_clock::now();
-    long long cycles_run = stress(&swt, mOptions.cycles, mOptions.printFrequency, mOptions.errorCheck);
+    if (links.size() == 1) {
+      cyclesRun[*links.begin()] = stress(&swt, *links.begin(), nullptr, mOptions.cycles, mOptions.printFrequency,
+          mOptions.errorCheck, latencies[*links.begin()]);
+    } else {
+      std::mutex swtMutex;
+      std::vector<std::thread> threads;
+      for (auto link : links) {
+        // References to map elements stay valid while the map grows
+        auto& linkLatencies = latencies[link];
+        auto& linkCycles = cyclesRun[link];
+        threads.emplace_back([&, link]{
+          linkCycles = stress(&swt, link, &swtMutex, mOptions.cycles, mOptions.printFrequency, mOptions.errorCheck,
+              linkLatencies);
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
     auto finish = std::chrono::high_resolution_clock::now();
     
-    if (!cycles_run)
-      getLogger() << "Execution terminated because of error..." << InfoLogger::endm;
+    long long cycles_run = 0;
+    for (const auto& kv : cyclesRun) {
+      if (kv.second <= 0) {
+        getLogger() << "Execution terminated because of error on link " << kv.first << "..." << InfoLogger::endm;
+      } else {
+        cycles_run += kv.second;
+      }
+    }
     
     getLogger() << "Total duration: " << std::chrono::duration_cast<std::chrono::seconds> (finish-start).count() << "s" << InfoLogger::endm;
     getLogger() << "Total bar operations: " << barOps * (cycles_run/mOptions.printFrequency) << InfoLogger::endm;
     getLogger() << "Total bar writes " << barWrites * (cycles_run/mOptions.printFrequency) << InfoLogger::endm;
     getLogger() << "Total bar reads: " << barReads * (cycles_run/mOptions.printFrequency) << InfoLogger::endm;
+
+    printLatencies(latencies, std::chrono::duration<double>(finish - start).count());
   }
 
   struct OptionsStruct 
   {
     std::string pciAddress = "-1";
     uint32_t gbtLink = 0;
+    std::string links;
     long long cycles = 100;
     long long printFrequency = 10;
     bool errorCheck = true;
@@ -165,6 +283,8 @@ class ProgramBarStress: public Program
   long long barReads = 0;
 
   private:
+    /// Serializes the validation failure reports of the link threads
+    std::mutex mLogMutex;
 };
 
 int main(int argc, char** argv)
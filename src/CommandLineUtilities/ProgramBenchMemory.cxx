@@ -0,0 +1,251 @@
+/// \file ProgramBenchMemory.cxx
+/// \brief Utility that measures the host memory bandwidth, as a reference for the DMA throughput of the cards
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/algorithm/string/join.hpp>
+#include <boost/format.hpp>
+#include "CommandLineUtilities/AllCards.h"
+#include "CommandLineUtilities/MemoryBandwidth.h"
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "Common/SuffixOption.h"
+#include "ExceptionInternal.h"
+#include "InfoLogger/InfoLogger.hxx"
+#include "ReadoutCard/CardType.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "Utilities/Hugetlbfs.h"
+#include "Utilities/PciLink.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+using AliceO2::Common::SuffixOption;
+using std::cout;
+namespace b = boost;
+namespace po = boost::program_options;
+
+namespace {
+/// End InfoLogger message alias
+constexpr auto endm = InfoLogger::endm;
+/// Node number used for a system without NUMA
+constexpr int NO_NUMA = -1;
+
+double toGbps(double bytesPerSecond)
+{
+  return bytesPerSecond * 8 / (1000.0 * 1000.0 * 1000.0);
+}
+
+std::string nodeString(int node)
+{
+  return node == NO_NUMA ? std::string("-") : std::to_string(node);
+}
+
+/// Bandwidths of the operations, in Gb/s, for a buffer on one node and threads on one node
+struct Bandwidths
+{
+    double read;
+    double nonTemporalWrite;
+    double copy;
+};
+
+/// Measures the sequential read, non-temporal write and copy bandwidth of host memory, from threads on the NUMA node of
+/// the buffer and on the other nodes. The buffers are mapped with Utilities::tryMapFile() like the DMA buffers of the
+/// other utilities, so they are backed by the same kind of hugepages. For every card, the results are shown next to its
+/// PCIe DMA bandwidth: where the memory bandwidth is below it, processing of the readout data is memory-bound.
+class ProgramBenchMemory: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {
+        "Memory Benchmark",
+        "Measure the host memory bandwidth, as a reference for the DMA throughput of the cards\n"
+          "Sequential read, non-temporal write and copy are measured on a hugepage buffer on every NUMA node that has "
+          "a card, or on every node if there are no cards, with threads on the buffer's node and on the other nodes. "
+          "The results are compared with the PCIe DMA bandwidth of the cards.",
+        "roc-bench-memory --threads=8 --time=2000"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      options.add_options()
+          ("buffer-size",
+              SuffixOption<size_t>::make(&mOptions.bufferSize)->default_value("1Gi"),
+              "Buffer size in bytes, per NUMA node")
+          ("threads",
+              po::value<size_t>(&mOptions.threads)->default_value(4),
+              "Amount of threads per measurement, each pinned to its own CPU of the node")
+          ("time",
+              po::value<int64_t>(&mOptions.milliseconds)->default_value(1000),
+              "Duration of every measurement in milliseconds");
+    }
+
+    virtual void run(const po::variables_map&)
+    {
+      if (mOptions.threads == 0) {
+        throw ParameterException() << ErrorInfo::Message("Amount of threads must be at least 1");
+      }
+      if (mOptions.milliseconds <= 0) {
+        throw ParameterException() << ErrorInfo::Message("Time must be positive");
+      }
+
+      auto nodeCpus = MemoryBandwidth::getNumaNodeCpus();
+      if (nodeCpus.empty()) {
+        auto& cpus = nodeCpus[NO_NUMA];
+        for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+          cpus.push_back(cpu);
+        }
+      }
+
+      // The buffers go on the nodes of the cards, where the DMA buffers would be
+      auto cards = AllCards::findCards();
+      std::vector<int> bufferNodes;
+      for (const auto& card : cards) {
+        bufferNodes.push_back(toNode(card.numaNode, nodeCpus));
+      }
+      if (bufferNodes.empty()) {
+        for (const auto& node : nodeCpus) {
+          bufferNodes.push_back(node.first);
+        }
+      }
+      std::sort(bufferNodes.begin(), bufferNodes.end());
+      bufferNodes.erase(std::unique(bufferNodes.begin(), bufferNodes.end()), bufferNodes.end());
+
+      // Results per buffer node and CPU node
+      std::map<std::pair<int, int>, Bandwidths> results;
+      for (int bufferNode : bufferNodes) {
+        auto bufferName = (b::format("roc-bench-memory_node=%s_%d") % nodeString(bufferNode) % time(0)).str();
+        auto buffer = Utilities::tryMapFile(mOptions.bufferSize, bufferName, true, nullptr,
+            bufferNode == NO_NUMA ? b::optional<int>() : b::optional<int>(bufferNode));
+        for (const auto& node : nodeCpus) {
+          if (node.second.empty() || isSigInt()) {
+            continue;
+          }
+          auto cpus = node.second;
+          if (cpus.size() > mOptions.threads) {
+            cpus.resize(mOptions.threads);
+          } else if (cpus.size() < mOptions.threads) {
+            getLogger() << "Node " << nodeString(node.first) << " has only " << cpus.size() << " CPUs"
+                << endm;
+          }
+          results[{bufferNode, node.first}] = measure(*buffer, cpus);
+        }
+      }
+
+      printMemoryTable(results);
+      printCardTable(cards, nodeCpus, results);
+    }
+
+  private:
+    /// Maps a card's NUMA node to a node of the system, for cards that report none
+    static int toNode(int numaNode, const std::map<int, std::vector<int>>& nodeCpus)
+    {
+      return nodeCpus.count(numaNode) ? numaNode : nodeCpus.begin()->first;
+    }
+
+    Bandwidths measure(MemoryMappedFile& buffer, const std::vector<int>& cpus)
+    {
+      auto run = [&](MemoryBandwidth::Operation operation) {
+        return toGbps(MemoryBandwidth::measure(operation, buffer.getAddress(), buffer.getSize(), cpus,
+            std::chrono::milliseconds(mOptions.milliseconds)));
+      };
+      // The write comes first, so the reads see the pages faulted in and initialized
+      Bandwidths bandwidths;
+      bandwidths.nonTemporalWrite = run(MemoryBandwidth::Operation::NonTemporalWrite);
+      bandwidths.read = run(MemoryBandwidth::Operation::Read);
+      bandwidths.copy = run(MemoryBandwidth::Operation::Copy);
+      return bandwidths;
+    }
+
+    void printMemoryTable(const std::map<std::pair<int, int>, Bandwidths>& results)
+    {
+      auto format = "  %-12s %-10s %-12s %-14s %-12s\n";
+      cout << b::format("Memory bandwidth, %d threads, %d MiB buffer\n") % mOptions.threads
+          % (mOptions.bufferSize / (1024 * 1024));
+      cout << b::format(format) % "Buffer node" % "CPU node" % "Read Gb/s" % "NT write Gb/s" % "Copy Gb/s";
+      for (const auto& result : results) {
+        cout << b::format(format) % nodeString(result.first.first) % nodeString(result.first.second)
+            % (b::format("%.1f") % result.second.read)
+            % (b::format("%.1f") % result.second.nonTemporalWrite)
+            % (b::format("%.1f") % result.second.copy);
+      }
+    }
+
+    /// Prints every card's DMA bandwidth next to the memory bandwidth of its node, from local and remote CPUs, with the
+    /// operations that can't keep up with the DMA
+    void printCardTable(const std::vector<CardDescriptor>& cards, const std::map<int, std::vector<int>>& nodeCpus,
+        const std::map<std::pair<int, int>, Bandwidths>& results)
+    {
+      if (cards.empty()) {
+        cout << "\nNo cards found, no DMA bandwidth to compare with\n";
+        return;
+      }
+
+      auto format = "  %-6s %-10s %-9s %-10s %-12s %-12s\n";
+      cout << "\nPCIe DMA bandwidth compared with the memory bandwidth of the card's node\n";
+      cout << b::format(format) % "Type" % "PCI Addr" % "DMA Gb/s" % "CPU node" % "Slack Gb/s" % "Memory-bound";
+      for (const auto& card : cards) {
+        const int bufferNode = toNode(card.numaNode, nodeCpus);
+        b::optional<double> dmaBandwidth;
+        try {
+          auto status = Utilities::getPciLinkStatus(card.pciAddress);
+          dmaBandwidth = Utilities::getPciLinkBandwidth(status.currentSpeed, status.currentWidth)
+              * Utilities::getPciPayloadEfficiency(status.maxPayloadSize);
+        } catch (const std::exception& e) {
+          getLogger() << InfoLogger::Warning << "Could not get PCIe link of "
+              << card.pciAddress.toString() << ": " << e.what() << endm;
+        }
+
+        for (const auto& node : nodeCpus) {
+          auto result = results.find({bufferNode, node.first});
+          if (result == results.end()) {
+            continue;
+          }
+          const auto& bandwidths = result->second;
+          std::string cpuNode = nodeString(node.first) + (node.first == bufferNode ? " (local)" : "");
+          std::string slack = "-";
+          std::string bound = "-";
+          if (dmaBandwidth) {
+            // Processing that touches every byte the card writes must at least read at the DMA rate
+            std::vector<std::string> operations;
+            auto check = [&](double bandwidth, const char* name) {
+              if (bandwidth < *dmaBandwidth) {
+                operations.push_back(name);
+              }
+            };
+            check(bandwidths.read, "read");
+            check(bandwidths.nonTemporalWrite, "write");
+            check(bandwidths.copy, "copy");
+            slack = (b::format("%.1f") % (std::min({bandwidths.read, bandwidths.nonTemporalWrite, bandwidths.copy})
+                - *dmaBandwidth)).str();
+            bound = operations.empty() ? std::string("no") : b::algorithm::join(operations, ",");
+          }
+          cout << b::format(format) % CardType::toString(card.cardType) % card.pciAddress.toString()
+              % (dmaBandwidth ? (b::format("%.1f") % *dmaBandwidth).str() : std::string("-")) % cpuNode % slack
+              % bound;
+        }
+      }
+    }
+
+    struct OptionsStruct
+    {
+        size_t bufferSize = 0;
+        size_t threads = 0;
+        int64_t milliseconds = 0;
+    } mOptions;
+};
+} // Anonymous namespace
+
+int main(int argc, char** argv)
+{
+  return ProgramBenchMemory().execute(argc, argv);
+}
@@ -0,0 +1,281 @@
+/// \file ProgramBenchSuite.cxx
+/// \brief Utility that runs roc-bench-dma on a matrix of configurations and compares the results with a baseline
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include "CommandLineUtilities/BenchSuite.h"
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "ExceptionInternal.h"
+#include "InfoLogger/InfoLogger.hxx"
+
+extern char** environ;
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+namespace b = boost;
+namespace po = boost::program_options;
+
+namespace {
+/// End InfoLogger message alias
+constexpr auto endm = InfoLogger::endm;
+
+/// Splits a comma separated list
+std::vector<std::string> splitList(const std::string& string)
+{
+  std::vector<std::string> items;
+  b::split(items, string, [](char c) { return c == ','; });
+  for (auto& item : items) {
+    b::trim(item);
+  }
+  items.erase(std::remove(items.begin(), items.end(), std::string()), items.end());
+  return items;
+}
+} // Anonymous namespace
+
+/// Runs roc-bench-dma for every configuration of a matrix of superpage sizes, link counts, generator sizes, error
+/// checking and thread pinning, one after the other, and writes the average throughput and error count of every
+/// configuration to a JSON file. Given a baseline, which is such a file from an earlier run, it reports the
+/// configurations whose throughput dropped more than the tolerance, and fails if there are any.
+class ProgramBenchSuite: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {
+        "DMA Benchmark Suite",
+        "Run roc-bench-dma on a matrix of configurations and compare the throughput with a baseline\n"
+          "Every combination of the given superpage sizes, link counts, generator sizes, error checking and pinning is "
+          "run for the given time. The results are written to a JSON file, which can be the baseline of a later run. "
+          "The output of the runs is appended to a log file next to the results. Use '--id=-1' to run on the "
+          "simulated dummy card.",
+        "roc-bench-suite --id=42:0.0 --link-counts=1,12 --baseline=baseline.json"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      options.add_options()
+          ("baseline",
+              po::value<std::string>(&mOptions.baseline),
+              "Results of an earlier run to compare with")
+          ("bench-args",
+              po::value<std::string>(&mOptions.benchArguments),
+              "Additional arguments for every roc-bench-dma run, separated by spaces, e.g. '--buffer-size=2Gi'")
+          ("bench-dma",
+              po::value<std::string>(&mOptions.benchDma),
+              "Path of roc-bench-dma. By default, the one next to this program.")
+          ("dummy-link-bandwidth",
+              po::value<std::string>(&mOptions.dummyLinkBandwidth)->default_value("1G"),
+              "Bandwidth per link of the simulated dummy card")
+          ("error-checks",
+              po::value<std::string>(&mOptions.errorChecks)->default_value("on,off"),
+              "Error checking settings to run: 'on', 'off' or both")
+          ("generator-sizes",
+              po::value<std::string>(&mOptions.generatorSizes)->default_value("default,random"),
+              "Comma separated generator data sizes, 'default' for the driver's default, 'random' for random sizes")
+          ("id",
+              po::value<std::string>(&mOptions.cardId)->default_value("-1"),
+              "Card ID (PCI address or serial number), or -1 for the simulated dummy card")
+          ("link-counts",
+              po::value<std::string>(&mOptions.linkCounts)->default_value("1,12"),
+              "Comma separated amounts of links, opened from link 0 up")
+          ("output",
+              po::value<std::string>(&mOptions.output)->default_value("roc-bench-suite.json"),
+              "File to write the results to. The output of the runs goes to the same path with '.log' appended.")
+          ("pinnings",
+              po::value<std::string>(&mOptions.pinnings)->default_value("none,numa"),
+              "Thread pinnings to run: 'none', 'numa' (the CPUs local to the card) or both")
+          ("superpage-sizes",
+              po::value<std::string>(&mOptions.superpageSizes)->default_value("256Ki,1Mi,2Mi"),
+              "Comma separated superpage sizes")
+          ("time",
+              po::value<std::string>(&mOptions.time)->default_value("10s"),
+              "Run time of every configuration, see roc-bench-dma --time")
+          ("tolerance",
+              po::value<double>(&mOptions.tolerance)->default_value(0.05),
+              "Allowed relative drop of the throughput below the baseline, unless the baseline gives its own");
+    }
+
+    virtual void run(const po::variables_map&)
+    {
+      BenchSuite::Matrix matrix;
+      matrix.superpageSizes = splitList(mOptions.superpageSizes);
+      for (const auto& count : splitList(mOptions.linkCounts)) {
+        matrix.linkCounts.push_back(b::lexical_cast<int>(count));
+      }
+      matrix.generatorSizes = splitList(mOptions.generatorSizes);
+      for (const auto& check : splitList(mOptions.errorChecks)) {
+        if (check != "on" && check != "off") {
+          BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Error checks must be 'on' or 'off'")
+              << ErrorInfo::String(check));
+        }
+        matrix.errorChecks.push_back(check == "on");
+      }
+      matrix.pinnings = splitList(mOptions.pinnings);
+      const auto configurations = BenchSuite::makeConfigurations(matrix);
+
+      std::vector<BenchSuite::Result> baseline;
+      if (!mOptions.baseline.empty()) {
+        baseline = BenchSuite::readResults(mOptions.baseline);
+      }
+
+      const auto benchDma = getBenchDmaPath();
+      const auto logPath = mOptions.output + ".log";
+      const auto summaryPath = (b::format("/tmp/roc-bench-suite-%d.json") % getpid()).str();
+      getLogger() << "Running " << configurations.size() << " configurations with " << benchDma << endm;
+
+      std::vector<BenchSuite::Result> results;
+      for (size_t i = 0; i < configurations.size() && !isSigInt(); ++i) {
+        const auto& configuration = configurations[i];
+        getLogger() << (b::format("[%d/%d] %s") % (i + 1) % configurations.size() % configuration.name).str() << endm;
+
+        auto arguments = getCommonArguments();
+        arguments.push_back("--output-json=" + summaryPath);
+        arguments.insert(arguments.end(), configuration.arguments.begin(), configuration.arguments.end());
+        const int status = runBenchmark(benchDma, arguments, logPath, configuration.name);
+
+        BenchSuite::Result result;
+        auto summary = BenchSuite::readBenchmarkSummary(summaryPath);
+        if (status == 0 && summary) {
+          result = *summary;
+        }
+        result.name = configuration.name;
+        result.completed = (status == 0 && summary);
+        std::remove(summaryPath.c_str());
+
+        if (result.completed) {
+          getLogger() << (b::format("  %.3f Gb/s, %s errors") % result.gbps
+              % (result.errors ? std::to_string(*result.errors) : std::string("n/a"))).str() << endm;
+        } else {
+          getLogger() << InfoLogger::Error << "  Failed, see " << logPath << endm;
+        }
+        results.push_back(result);
+      }
+
+      BenchSuite::writeResults(mOptions.output, results);
+      getLogger() << "Results written to " << mOptions.output << endm;
+
+      if (!mOptions.baseline.empty()) {
+        auto regressions = BenchSuite::compare(results, baseline, mOptions.tolerance);
+        for (const auto& regression : regressions) {
+          getLogger() << InfoLogger::Error << "Regression: " << regression << endm;
+        }
+        if (!regressions.empty()) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message((b::format("%d regressions against the baseline")
+              % regressions.size()).str()));
+        }
+        getLogger() << "No regressions against the baseline" << endm;
+      }
+    }
+
+  private:
+    /// Gets the path of roc-bench-dma, by default the one in the directory of this program
+    std::string getBenchDmaPath() const
+    {
+      if (!mOptions.benchDma.empty()) {
+        return mOptions.benchDma;
+      }
+      return (b::filesystem::read_symlink("/proc/self/exe").parent_path() / "roc-bench-dma").string();
+    }
+
+    /// Gets the arguments of every roc-bench-dma run
+    std::vector<std::string> getCommonArguments() const
+    {
+      std::vector<std::string> arguments {"--id=" + mOptions.cardId, "--time=" + mOptions.time, "--no-display"};
+      if (mOptions.cardId == "-1") {
+        // The simulated card generates the DDG pattern, which is not looped back
+        arguments.push_back("--dummy-link-bandwidth=" + mOptions.dummyLinkBandwidth);
+        arguments.push_back("--loopback=NONE");
+      }
+      std::vector<std::string> extra;
+      b::split(extra, mOptions.benchArguments, [](char c) { return c == ' '; }, b::token_compress_on);
+      for (const auto& argument : extra) {
+        if (!argument.empty()) {
+          arguments.push_back(argument);
+        }
+      }
+      return arguments;
+    }
+
+    /// Runs roc-bench-dma with its output appended to the log file
+    /// \return The exit status, or -1 if it did not exit normally
+    int runBenchmark(const std::string& path, const std::vector<std::string>& arguments, const std::string& logPath,
+        const std::string& name)
+    {
+      int log = open(logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+      if (log == -1) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open log file")
+            << ErrorInfo::Filename(logPath));
+      }
+      auto header = "\n=== " + name + " ===\n";
+      if (write(log, header.data(), header.size()) == -1) {
+        getLogger() << InfoLogger::Warning << "Could not write to the log file" << endm;
+      }
+
+      std::vector<char*> argv;
+      argv.push_back(const_cast<char*>(path.c_str()));
+      for (const auto& argument : arguments) {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+      }
+      argv.push_back(nullptr);
+
+      posix_spawn_file_actions_t actions;
+      posix_spawn_file_actions_init(&actions);
+      posix_spawn_file_actions_adddup2(&actions, log, STDOUT_FILENO);
+      posix_spawn_file_actions_adddup2(&actions, log, STDERR_FILENO);
+      pid_t pid;
+      int error = posix_spawn(&pid, path.c_str(), &actions, nullptr, argv.data(), environ);
+      posix_spawn_file_actions_destroy(&actions);
+      close(log);
+      if (error != 0) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to start roc-bench-dma")
+            << ErrorInfo::Filename(path));
+      }
+
+      int status;
+      while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+          return -1;
+        }
+      }
+      return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    struct OptionsStruct
+    {
+        std::string baseline;
+        std::string benchArguments;
+        std::string benchDma;
+        std::string cardId;
+        std::string dummyLinkBandwidth;
+        std::string errorChecks;
+        std::string generatorSizes;
+        std::string linkCounts;
+        std::string output;
+        std::string pinnings;
+        std::string superpageSizes;
+        std::string time;
+        double tolerance = 0.05;
+    } mOptions;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramBenchSuite().execute(argc, argv);
+}
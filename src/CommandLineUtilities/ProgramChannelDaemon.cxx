@@ -0,0 +1,210 @@
+/// \file ProgramChannelDaemon.cxx
+/// \brief Utility that keeps a DMA channel and its buffer open, and serves the data to consumer processes
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/format.hpp>
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "Common/SuffixOption.h"
+#include "ExceptionInternal.h"
+#include "InfoLogger/InfoLogger.hxx"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/Parameters.h"
+#include "ReadoutCard/SharedMemoryBuffer.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+using AliceO2::Common::SuffixOption;
+namespace b = boost;
+namespace po = boost::program_options;
+
+namespace {
+/// End InfoLogger message alias
+constexpr auto endm = InfoLogger::endm;
+/// Time to wait for arrivals when there is nothing else to do
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(1);
+/// Interval between status messages
+constexpr auto STATUS_INTERVAL = std::chrono::seconds(10);
+} // Anonymous namespace
+
+/// Keeps a DMA channel and its buffer open across runs of the consumer, so a consumer that starts, crashes or is
+/// reconfigured does not pay for opening the channel, and does not reset the card.
+///
+/// The buffer is a SharedMemoryBuffer, which consumers attach to by name: they call attach(), pop the superpages that
+/// arrived with popReady(), and give them back with pushFree(). The daemon drives the channel: it gives the returned
+/// superpages to the card, and publishes the arrived ones. When a new consumer attaches, the superpages the previous
+/// one had are taken back. A DMA error is handled with DmaChannelInterface::recover() instead of reopening the channel.
+class ProgramChannelDaemon: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {
+        "Channel Daemon",
+        "Keep a DMA channel and its buffer open, and serve the data to consumer processes\n"
+          "Consumers attach to the shared buffer with SharedMemoryBuffer, by the name given with --name. A consumer "
+          "that is restarted attaches again, without restarting the channel. Stop with Ctrl-C.",
+        "roc-channeld --id=42:0.0 --channel=0 --name=readout0"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      Options::addOptionCardId(options);
+      Options::addOptionChannel(options);
+      options.add_options()
+          ("buffer-size",
+              SuffixOption<size_t>::make(&mOptions.bufferSize)->default_value("1Gi"),
+              "Buffer size in bytes, a multiple of 2 MiB")
+          ("dummy-link-bandwidth",
+              SuffixOption<size_t>::make(&mOptions.dummyLinkBandwidth)->default_value("0"),
+              "With the dummy card, simulate the links at this bandwidth in bytes per second")
+          ("generator",
+              po::value<bool>(&mOptions.generatorEnabled)->default_value(true),
+              "Enable data generator")
+          ("links",
+              po::value<std::string>(&mOptions.links)->default_value("0"),
+              "Links to open. A comma separated list of integers or ranges, e.g. '0,2,5-10'")
+          ("loopback",
+              po::value<std::string>(&mOptions.loopbackModeString)->default_value("INTERNAL"),
+              "Generator loopback mode [NONE, INTERNAL, DIU, SIU]")
+          ("name",
+              po::value<std::string>(&mOptions.name)->required(),
+              "Name of the shared buffer, which consumers attach to")
+          ("page-size",
+              SuffixOption<size_t>::make(&mOptions.dmaPageSize)->default_value("8Ki"),
+              "Card DMA page size")
+          ("superpage-size",
+              SuffixOption<size_t>::make(&mOptions.superpageSize)->default_value("1Mi"),
+              "Superpage size in bytes");
+    }
+
+    virtual void run(const po::variables_map& map)
+    {
+      if (mOptions.superpageSize == 0 || mOptions.bufferSize < mOptions.superpageSize) {
+        throw ParameterException() << ErrorInfo::Message("Buffer size smaller than superpage size");
+      }
+
+      const auto cardId = Options::getOptionCardId(map);
+      const auto dmaChannel = Options::getOptionChannel(map);
+      const size_t superpages = mOptions.bufferSize / mOptions.superpageSize;
+
+      // The rings hold every superpage, so publishing and returning never fails
+      SharedMemoryBuffer buffer(mOptions.name, mOptions.bufferSize, superpages);
+      auto parameters = Parameters::makeParameters(cardId, dmaChannel)
+          .setDmaPageSize(mOptions.dmaPageSize)
+          .setGeneratorEnabled(mOptions.generatorEnabled)
+          .setGeneratorDataSize(mOptions.dmaPageSize)
+          .setGeneratorLoopback(LoopbackMode::fromString(mOptions.loopbackModeString))
+          .setLinkMask(Parameters::linkMaskFromString(mOptions.links))
+          .setBufferParameters(buffer.getBufferParameters());
+      if (mOptions.dummyLinkBandwidth > 0) {
+        parameters.setDummyLinkBandwidth(mOptions.dummyLinkBandwidth);
+      }
+      auto channel = ChannelFactory().getDmaChannel(parameters);
+
+      // Superpages the daemon holds, and whether the consumer holds a superpage, by index in the buffer
+      std::vector<Superpage> free;
+      std::vector<bool> published(superpages, false);
+      for (size_t i = 0; i < superpages; ++i) {
+        free.push_back(Superpage(i * mOptions.superpageSize, mOptions.superpageSize));
+      }
+      auto getIndex = [&](const Superpage& superpage) { return superpage.getOffset() / mOptions.superpageSize; };
+
+      channel->startDma();
+      getLogger() << (b::format("Serving channel %d as '%s', %d superpages of %d bytes") % dmaChannel % mOptions.name
+          % superpages % mOptions.superpageSize).str() << endm;
+
+      uint64_t attaches = 0;
+      uint64_t recoveries = 0;
+      uint64_t bytes = 0;
+      auto nextStatus = std::chrono::steady_clock::now() + STATUS_INTERVAL;
+      while (!isSigInt()) {
+        if (buffer.acceptAttach()) {
+          // The previous consumer is gone, along with the superpages it did not give back
+          size_t reclaimed = 0;
+          for (size_t i = 0; i < superpages; ++i) {
+            if (published[i]) {
+              published[i] = false;
+              free.push_back(Superpage(i * mOptions.superpageSize, mOptions.superpageSize));
+              reclaimed++;
+            }
+          }
+          attaches++;
+          getLogger() << (b::format("Consumer attached, took back %d superpages") % reclaimed).str() << endm;
+        }
+
+        bool idle = true;
+        Superpage superpage;
+        while (buffer.popFree(superpage)) {
+          // A superpage the consumer did not get from us, or gave back twice, would be given to the card twice
+          auto index = getIndex(superpage);
+          if (index >= superpages || !published[index]) {
+            getLogger() << InfoLogger::Warning << "Ignoring superpage returned by the consumer at offset "
+                << superpage.getOffset() << endm;
+            continue;
+          }
+          published[index] = false;
+          free.push_back(Superpage(index * mOptions.superpageSize, mOptions.superpageSize));
+        }
+
+        try {
+          while (!free.empty() && channel->tryPushSuperpage(free.back())) {
+            free.pop_back();
+            idle = false;
+          }
+          channel->fillSuperpages();
+          while (channel->tryPopSuperpage(superpage)) {
+            buffer.pushReady(superpage);
+            published[getIndex(superpage)] = true;
+            bytes += superpage.getReceived();
+            idle = false;
+          }
+        } catch (const Exception& e) {
+          getLogger() << InfoLogger::Error << "DMA error, recovering the channel: " << b::diagnostic_information(e)
+              << endm;
+          channel->recover();
+          recoveries++;
+          continue;
+        }
+
+        if (idle) {
+          channel->waitForReadySuperpage(IDLE_WAIT);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextStatus) {
+          nextStatus = now + STATUS_INTERVAL;
+          getLogger() << (b::format("%d bytes served, %d consumers attached, %d recoveries") % bytes % attaches
+              % recoveries).str() << endm;
+        }
+      }
+
+      channel->stopDma();
+      getLogger() << "Stopped" << endm;
+    }
+
+  private:
+    struct OptionsStruct
+    {
+        size_t bufferSize = 0;
+        size_t dmaPageSize = 0;
+        size_t dummyLinkBandwidth = 0;
+        bool generatorEnabled = true;
+        std::string links;
+        std::string loopbackModeString;
+        std::string name;
+        size_t superpageSize = 0;
+    } mOptions;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramChannelDaemon().execute(argc, argv);
+}
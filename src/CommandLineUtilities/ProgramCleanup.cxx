@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include "ReadoutCard/ChannelFactory.h"
+#include "CommandLineUtilities/AllCards.h"
 #include "CommandLineUtilities/Common.h"
 #include "CommandLineUtilities/Options.h"
 #include "CommandLineUtilities/Program.h"
@@ -23,12 +24,14 @@ class ProgramCleanup: public Program
 
     virtual Description getDescription()
     {
-      return {"Cleanup", "Cleans up ReadoutCard state", "roc-cleanup --id=12345 --channel=0"};
+      return {"Cleanup", "Cleans up ReadoutCard state, of a card or of every card with --all",
+          "roc-cleanup --id=12345 --channel=0\nroc-cleanup --all --channel=0"};
     }
 
     virtual void addOptions(po::options_description& options)
     {
       Options::addOptionCardId(options);
+      Options::addOptionAllCards(options);
       Options::addOptionChannel(options);
       //options.add_options()("force",po::bool_switch(&mForceCleanup),
        //   "Force cleanup of shared state files if normal cleanup fails");
@@ -36,16 +39,23 @@ class ProgramCleanup: public Program
 
     virtual void run(const boost::program_options::variables_map& map)
     {
-      auto cardId = Options::getOptionCardId(map);
       auto channelNumber = Options::getOptionChannel(map);
 
       // This non-forced cleanup asks the DmaChannel to clean up itself.
       // It will not succeed if the channel was not initialized properly before the running of this program.
+      auto cleanup = [&](const Parameters::CardIdType& cardId) {
+        auto params = AliceO2::roc::Parameters::makeParameters(cardId, channelNumber);
+        //params.setForcedUnlockEnabled(mForceCleanup);
+        params.setBufferParameters(buffer_parameters::Null());
+        auto channel = ChannelFactory().getDmaChannel(params);
+      };
+
       cout << "### Attempting cleanup...\n";
-      auto params = AliceO2::roc::Parameters::makeParameters(cardId, channelNumber);
-      //params.setForcedUnlockEnabled(mForceCleanup);
-      params.setBufferParameters(buffer_parameters::Null());
-      auto channel = ChannelFactory().getDmaChannel(params);
+      if (Options::getOptionAllCards(map)) {
+        AllCards::runAndReport(cout, [&](const CardDescriptor& card) { cleanup(card.pciAddress); });
+      } else {
+        cleanup(Options::getOptionCardId(map));
+      }
       cout << "### Done!\n";
     }
 
@@ -5,40 +5,70 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <future>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <random>
 #include <queue>
 #include <sstream>
 #include <stdexcept>
 #include <thread>
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
 #include <boost/circular_buffer.hpp>
 #include <boost/exception/diagnostic_information.hpp>
 #include <boost/interprocess/sync/named_mutex.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/lexical_cast/try_lexical_convert.hpp>
 #include <boost/tokenizer.hpp>
 #include "BarHammer.h"
+#include "CommandLineUtilities/BenchmarkOutput.h"
 #include "CommandLineUtilities/Common.h"
+#include "CommandLineUtilities/ConsumerModel.h"
 #include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/PerfCounters.h"
 #include "CommandLineUtilities/Program.h"
 #include "Common/Iommu.h"
 #include "Common/SuffixOption.h"
 #include "Cru/DataFormat.h"
+#include "Cru/SuperpageView.h"
 #include "ExceptionInternal.h"
 #include "InfoLogger/InfoLogger.hxx"
-#include "folly/ProducerConsumerQueue.h"
+#include "LatencyHistogram.h"
+#include "ReadoutCard/CacheAllocation.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/ClockCorrelator.h"
+#include "ReadoutCard/CopyEngine.h"
+#include "ReadoutCard/DataPattern.h"
+#include "ReadoutCard/LinkIntegrityMonitor.h"
 #include "ReadoutCard/MemoryMappedFile.h"
 #include "ReadoutCard/Parameters.h"
 #include "ReadoutCard/ReadoutCard.h"
+#include "ReadoutCard/SuperpageRecorder.h"
+#include "ReadoutCard/SuperpageTap.h"
+#include "ReadoutCard/SuperpageRing.h"
+#include "ReadoutCard/TimeFrameIndexer.h"
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+# include "RocPciDevice.h"
+#endif
 #include "time.h"
+#include "Utilities/Affinity.h"
+#include "Utilities/AlignedAllocator.h"
+#define ALICEO2_READOUTCARD_ALLOCATION_HOOK
+#include "Utilities/AllocationCounter.h"
 #include "Utilities/Hugetlbfs.h"
+#include "Utilities/Numa.h"
 #include "Utilities/SmartPointer.h"
+#include "Utilities/Timestamp.h"
 #include "Utilities/Util.h"
 
 using namespace AliceO2::roc::CommandLineUtilities;
@@ -54,14 +84,14 @@ namespace po = boost::program_options;
 namespace {
 /// Initial value for link counters
 constexpr auto DATA_COUNTER_INITIAL_VALUE = std::numeric_limits<uint32_t>::max();
-/// Initial value for link packet counters
-constexpr auto PACKET_COUNTER_INITIAL_VALUE = std::numeric_limits<uint32_t>::max();
 /// Maximum supported links
 constexpr auto MAX_LINKS = 32;
 /// Interval for low priority thread (display updates, etc)
 constexpr auto LOW_PRIORITY_INTERVAL = 10ms;
 /// Buffer value to reset to
 constexpr uint32_t BUFFER_DEFAULT_VALUE = 0xCcccCccc;
+/// Frequency of the LHC orbits in Hz, the 40.079 MHz bunch crossing clock divided by 3564 bunches
+constexpr double LHC_ORBIT_FREQUENCY = 40.0789e6 / 3564;
 /// Fields: Time(hour:minute:second), Pages pushed, Pages read, Errors, °C
 const std::string PROGRESS_FORMAT_HEADER("  %-8s   %-12s  %-12s %-18s  %-12s  %-5.1f");
 /// Fields: Time(hour:minute:second), Pages pushed, Pages read, Errors, °C
@@ -80,6 +110,57 @@ struct TimeLimit {
     uint64_t minutes = 0;
     uint64_t hours = 0;
 };
+/// Error counter and log of one readout thread. Only that thread writes them, they are merged for the display and
+/// when the benchmark completes.
+struct ReadoutErrors {
+    /// \param timeFrameLength Orbits per time frame to index the superpages by, 0 to not index them
+    ReadoutErrors(size_t pageSize, bool packed, uint32_t timeFrameLength) : integrity(pageSize, packed)
+    {
+      if (timeFrameLength != 0) {
+        timeFrameIndexer = std::make_unique<TimeFrameIndexer>(timeFrameLength, pageSize, packed);
+      }
+    }
+
+    /// Counts an error
+    /// \return True if the error should still be recorded in the stream
+    bool add()
+    {
+      auto value = count.load(std::memory_order_relaxed) + 1;
+      count.store(value, std::memory_order_relaxed);
+      return value < MAX_RECORDED_ERRORS;
+    }
+
+    std::atomic<int64_t> count {0};
+    std::ostringstream stream;
+
+    /// RDH checks of the links this thread reads out. A link is always read out by the same thread.
+    LinkIntegrityMonitor integrity;
+
+    /// Memory size of the first page of every link with fixed generator sizes, which the later pages must match.
+    /// Indexed by link ID, 0 until the first page.
+    std::array<uint32_t, MAX_LINKS> memorySizes {};
+
+    /// Payload bytes of the CRU pages read out by this thread, without their RDH
+    std::atomic<uint64_t> payloadBytes {0};
+
+    /// Time frame index of the links this thread reads out, with --time-frame-length
+    std::unique_ptr<TimeFrameIndexer> timeFrameIndexer;
+
+    /// Slices of the last indexed superpage, reused for every superpage
+    std::vector<TimeFrameSlice> timeFrameSlices;
+
+    /// Time frames started in the superpages read out by this thread
+    std::atomic<uint64_t> timeFrames {0};
+
+    /// Superpages read out by this thread that straddle a time frame boundary
+    std::atomic<uint64_t> straddlingSuperpages {0};
+
+    /// Time from the heartbeat orbit of the first packet of a superpage to its readout, per link, in nanoseconds.
+    /// Only recorded with --clock-register.
+    std::map<uint32_t, LatencyHistogram> orbitLatencies;
+};
+/// Latency histograms of each link, indexed by link ID. In timestamp counter ticks.
+using LinkLatencies = std::map<uint32_t, LatencyHistogram>;
 } // Anonymous namespace
 
 
@@ -109,27 +190,108 @@ class ProgramDmaBench: public Program
     virtual void addOptions(po::options_description& options)
     {
       options.add_options()
+          ("async-logging",
+              po::bool_switch(&mOptions.asyncLogging),
+              "Let the channel log through an asynchronous ring written by a background thread, so the DMA never waits "
+              "for the logging")
           ("bar-hammer",
               po::bool_switch(&mOptions.barHammer),
-              "Stress the BAR with repeated writes and measure performance")
+              "Stress the BAR with repeated accesses during the DMA and measure their throughput and latency")
+          ("bar-hammer-address",
+              po::value<std::string>(&mOptions.barHammerAddress),
+              "Byte address of the register to hammer on BAR 0, by default the debug register 0x410. Accesses wider "
+              "than 32 bits also write the following registers.")
+          ("bar-hammer-baseline",
+              po::value<uint64_t>(&mOptions.barHammerBaseline)->default_value(1000),
+              "Milliseconds to hammer the BAR before the DMA starts, as a baseline without contention. 0 to skip.")
+          ("bar-hammer-cpu",
+              po::value<std::string>(&mOptions.barHammerCpus),
+              "CPUs of the BAR hammer threads, e.g. '4-7'. Each thread gets one CPU of the list.")
+          ("bar-hammer-mode",
+              po::value<std::string>(&mOptions.barHammerModeString)->default_value("write"),
+              "BAR hammer accesses: 'write' (posted writes), 'read' or 'raw' (read after write)")
+          ("bar-hammer-threads",
+              po::value<int>(&mOptions.barHammerThreads)->default_value(1),
+              "Amount of threads hammering the BAR at once")
+          ("bar-hammer-width",
+              po::value<int>(&mOptions.barHammerWidth)->default_value(32),
+              "Width in bits of the BAR hammer writes: 32, 64 or 128")
           ("bytes",
               SuffixOption<uint64_t>::make(&mOptions.maxBytes)->default_value("0"),
               "Limit of bytes to transfer. Give 0 for infinite.")
+          ("buffer-dump",
+              po::bool_switch(&mOptions.bufferDump),
+              "Keep the DMA buffer in core dumps and in forked processes, instead of excluding it")
           ("buffer-size",
               SuffixOption<size_t>::make(&mBufferSize)->default_value("1Gi"),
               "Buffer size in bytes. Rounded down to 2 MiB multiple. Minimum of 2 MiB. Use 2 MiB hugepage by default; |"
               "if buffer size is a multiple of 1 GiB, will try to use GiB hugepages")
+          ("check-copies",
+              po::value<size_t>(&mOptions.checkCopies)->default_value(0),
+              "Check copies of the superpages on the readout threads, so the superpages go back to the card right "
+              "away. At most this many copies are in flight, superpages that find none free are not checked. "
+              "Give 0 to check the superpages themselves.")
+          ("clock-frequency",
+              po::value<double>(&mOptions.clockFrequency)->default_value(LHC_ORBIT_FREQUENCY),
+              "Nominal frequency of the --clock-register counter in Hz, by default that of the LHC orbits")
+          ("clock-register",
+              po::value<std::string>(&mOptions.clockRegister),
+              "Address of a free-running 32-bit orbit counter of the card on BAR 2. Given, the counter is correlated "
+              "with the host clock during the run, and the latency from the heartbeat orbit of the first packet of "
+              "every superpage to its readout is reported per link. CRU only.")
+          ("consumer-model",
+              po::value<std::string>(&mOptions.consumerModel)->default_value("none"),
+              "Delays of the readout threads before they read out a superpage, to see how the buffer and the card's "
+              "queue cope with a slow consumer: 'none', 'random' (as --random-pause), 'constant:COST' per DMA page, "
+              "'stall:INTERVAL,LENGTH', or 'pareto:SCALE,SHAPE' per superpage. Durations take the units ns, us, ms "
+              "and s, e.g. 'constant:2us', 'stall:1s,200ms' or 'pareto:50us,1.5'.")
           ("dma-channel",
               po::value<int>(&mOptions.dmaChannel)->default_value(0),
               "DMA channel selection (note: C-RORC has channels 0 to 5, CRU only 0)")
+          ("driver-thread",
+              po::bool_switch(&mOptions.driverThread),
+              "Let an internal driver thread handle the channel instead of calling fillSuperpages() in the push thread")
+          ("driver-thread-cpu",
+              po::value<int>(&mOptions.driverThreadCpu)->default_value(-1),
+              "CPU to pin the driver thread to. Give -1 to use the CPUs local to the card.")
+          ("dummy-link-bandwidth",
+              SuffixOption<size_t>::make(&mOptions.dummyLinkBandwidth)->default_value("0"),
+              "Dummy card only: simulate a card whose links (see --links) each transfer this many bytes per second, "
+              "with the CRU's queues and generator data. Give 0 to not simulate.")
+          ("file-queue-depth",
+              po::value<size_t>(&mOptions.fileQueueDepth)->default_value(8),
+              "Maximum amount of superpages being recorded at once for --to-file-bin")
+          ("file-compression",
+              po::value<std::string>(&mOptions.fileCompression)->default_value("none"),
+              "Compression of the superpages recorded with --to-file-bin [none, lz4, zstd]")
+          ("file-compression-level",
+              po::value<int>(&mOptions.fileCompressionLevel)->default_value(1),
+              "Level of --file-compression for zstd, acceleration for lz4")
+          ("file-compression-threads",
+              po::value<size_t>(&mOptions.fileCompressionThreads)->default_value(4),
+              "Amount of threads compressing the superpages recorded with --to-file-bin")
           ("generator",
               po::value<bool>(&mOptions.generatorEnabled)->default_value(true),
               "Enable data generator")
           ("generator-size",
               SuffixOption<size_t>::make(&mOptions.dataGeneratorSize)->default_value("0"),
-              "Data generator data size. 0 will use internal driver default.");
+              "Data generator data size. 0 will use internal driver default.")
+          ("generator-random-size",
+              po::bool_switch(&mOptions.generatorRandomSize),
+              "Make the data generator write a random amount of data per page, up to the generator data size")
+          ("size-profile",
+              po::value<std::string>(&mOptions.sizeProfile),
+              "Data generator size profile, instead of --generator-size and --generator-random-size: 'full' or "
+              "'half' pages, 'small' (1 KiB) events, or 'uniform' or 'uniform-small' for random sizes up to the page "
+              "size or 1 KiB");
       Options::addOptionCardId(options);
       options.add_options()
+          ("interrupt",
+              po::bool_switch(&mOptions.interrupt),
+              "Only check the card for arrivals after it raised an interrupt")
+          ("link-scheduling",
+              po::value<std::string>(&mOptions.linkSchedulingString),
+              "Set link scheduling policy for the CRU [SHORTEST_QUEUE, THROUGHPUT]")
           ("links",
               po::value<std::string>(&mOptions.links)->default_value("0"),
               "Links to open. A comma separated list of integers or ranges, e.g. '0,2,5-10'")
@@ -139,6 +301,13 @@ class ProgramDmaBench: public Program
           ("no-errorcheck",
               po::bool_switch(&mOptions.noErrorCheck),
               "Skip error checking")
+          ("errorcheck-sample",
+              po::value<size_t>(&mOptions.errorCheckSample)->default_value(1),
+              "Only check 1 in N superpages of every link. The counters of a link are moved past the superpages that "
+              "are not checked, or resynced when the data does not allow that.")
+          ("mlock",
+              po::bool_switch(&mOptions.lockBuffer),
+              "Lock the buffer's pages in memory before opening the channel")
           ("no-display",
               po::bool_switch(&mOptions.noDisplay),
               "Disable command-line display")
@@ -151,40 +320,145 @@ class ProgramDmaBench: public Program
           ("no-temperature",
               po::bool_switch(&mOptions.noTemperature),
               "No temperature readout")
+          ("numa-bind",
+              po::bool_switch(&mOptions.numaBind),
+              "Allocate the buffer's hugepages on the card's NUMA node, and fail if that is not possible")
+          ("output-csv",
+              po::value<std::string>(&mOptions.outputCsvPath),
+              "Write periodic samples and a summary with the configuration to the given file in CSV format")
+          ("output-interval",
+              po::value<uint64_t>(&mOptions.outputInterval)->default_value(1000),
+              "Interval in milliseconds between the samples of --output-json and --output-csv")
+          ("output-json",
+              po::value<std::string>(&mOptions.outputJsonPath),
+              "Write periodic samples and a summary with the configuration to the given file in JSON Lines format")
+          ("numa-pin",
+              po::bool_switch(&mOptions.numaPin),
+              "Pin the push, readout and display threads to the CPUs local to the card's NUMA node, unless "
+              "--push-cpu or --readout-cpu say otherwise")
+          ("packed",
+              po::bool_switch(&mOptions.packed),
+              "Read out CRU data with the packets packed back to back, following the RDH offsets to the next packet "
+              "instead of taking a packet per DMA page. The simulated dummy card then packs its packets.")
           ("page-reset",
               po::bool_switch(&mOptions.pageReset),
-              "Reset page to default values after readout (slow)")
+              "Poison the first and last cache line of every page after readout, so stale pages fail the checks")
           ("page-size",
               SuffixOption<size_t>::make(&mOptions.dmaPageSize)->default_value("8Ki"),
-              "Card DMA page size")
+              "Card DMA page size. Give 0 to use the largest the CRU firmware supports, with --firmware-capabilities.")
           ("pattern",
               po::value<std::string>(&mOptions.generatorPatternString)->default_value("INCREMENTAL"),
               "Error check with given pattern [INCREMENTAL, ALTERNATING, CONSTANT, RANDOM]")
           ("pause-push",
               po::value<uint64_t>(&mOptions.pausePush)->default_value(1),
-              "Push thread pause time in microseconds if no work can be done")
+              "Push thread maximum wait time in microseconds for a ready superpage if no work can be done")
           ("pause-read",
               po::value<uint64_t>(&mOptions.pauseRead)->default_value(10),
               "Readout thread pause time in microseconds if no work can be done")
+          ("prepare-dma",
+              po::bool_switch(&mOptions.prepareDma),
+              "Prepare the DMA before the benchmark starts, so starting it only enables the DMA engine, and report how "
+              "long the start took")
+          ("publish-statistics",
+              po::bool_switch(&mOptions.publishStatistics),
+              "Publish the channel statistics in shared memory, for 'roc-metrics --channels'")
+          ("prefault",
+              po::bool_switch(&mOptions.prefaultBuffer),
+              "Fault in the buffer's pages before opening the channel")
+          ("cache-allocation",
+              po::value<std::string>(&mOptions.cacheAllocation),
+              "Give the readout and driver threads their own part of the last-level cache, in the resctrl schemata "
+              "format, e.g. 'L3:0=00f'. Needs resctrl mounted on /sys/fs/resctrl.")
+          ("copy-engine",
+              po::value<std::string>(&mOptions.copyEngine),
+              "DSA work queue to copy with for --check-copies, e.g. /dev/dsa/wq0.0. The CPU copies if not given or the "
+              "queue can't be used.")
+          ("count-allocations",
+              po::bool_switch(&mOptions.countAllocations),
+              "Count the heap allocations of the push thread's push, fill and pop loop once every superpage of the "
+              "buffer went around, and fail if there were any. With --driver-thread, the driver thread isn't counted.")
+          ("perf-counters",
+              po::bool_switch(&mOptions.perfCounters),
+              "Count the cycles, instructions, LLC misses and context switches of the push, readout and low priority "
+              "threads with perf_event_open(), and report them per GB and per superpage")
+          ("prefetch-distance",
+              po::value<size_t>(&mOptions.prefetchDistance)->default_value(0),
+              "Prefetch the DMA page this many pages ahead of the one being read out, 0 to not prefetch")
           ("random-pause",
               po::bool_switch(&mOptions.randomPause),
-              "Randomly pause readout")
+              "Randomly pause the push and readout threads. Same as --consumer-model=random, and also pauses pushing.")
+          ("push-cpu",
+              po::value<std::string>(&mOptions.pushCpus),
+              "CPUs to pin the push thread to, as a list such as '2' or '2-3,8'")
+          ("readout-cpu",
+              po::value<std::string>(&mOptions.readoutCpus),
+              "CPUs to pin the readout thread to, as a list such as '3' or '4-7'. With --readout-threads, readout "
+              "thread i is pinned to the i-th CPU of the list.")
+          ("readout-threads",
+              po::value<int>(&mOptions.readoutThreads)->default_value(1),
+              "Amount of threads reading out and checking superpages. With error checking, a link's superpages are "
+              "always checked by the same thread.")
           ("readout-mode",
               po::value<std::string>(&mOptions.readoutModeString),
               "Set readout mode [CONTINUOUS]")
+          ("ready-queue-overflow",
+              po::value<std::string>(&mOptions.readyQueueOverflowString),
+              "Set what the CRU does with superpages arriving while the ready queue is full [BLOCK, GROW, DROP_OLDEST]")
+          ("replay-file",
+              po::value<std::string>(&mOptions.replayFile),
+              "Dummy card only: fill the superpages with the data of a file recorded with --to-file-bin to a single file "
+              "without compression. With --dummy-link-bandwidth, every link replays the packets of its link ID.")
+          ("replay-rate",
+              SuffixOption<size_t>::make(&mOptions.replayRate)->default_value("0"),
+              "Dummy card only: rate in bytes per second at which superpages arrive. Give 0 for as fast as possible.")
           ("superpage-size",
               SuffixOption<size_t>::make(&mSuperpageSize)->default_value("1Mi"),
               "Superpage size in bytes. Note that it can't be larger than the buffer. If the IOMMU is not enabled, the "
               "hugepage size must be a multiple of the superpage size")
+          ("tap-every",
+              po::value<uint64_t>(&mOptions.tapEvery)->default_value(100),
+              "Send one in this many superpages of the --tap-links to the --tap-port client")
+          ("tap-links",
+              po::value<std::string>(&mOptions.tapLinks),
+              "Links whose superpages are sent to the --tap-port client, all if not given. Same syntax as --links.")
+          ("tap-port",
+              po::value<uint16_t>(&mOptions.tapPort)->default_value(0),
+              "Listen on this TCP port and stream a sample of the superpages read out to the connected client, as a "
+              "header followed by the data of each. Give 0 to not listen. Requires a single readout thread.")
           ("time",
               po::value<std::string>(&mOptions.timeLimitString),
               "Time limit for benchmark. Any combination of [n]h, [n]m, & [n]s. For example: '5h30m', '10s', '1s2h3m'.")
+          ("time-frame-index",
+              po::value<std::string>(&mOptions.timeFrameIndexPath),
+              "Write the time frame index of every superpage to the given file, a line per slice of a superpage: the "
+              "superpage, link, time frame, first and last heartbeat orbit, first packet, packets, offset, size, and "
+              "whether the time frame continues from an earlier superpage. Requires --time-frame-length.")
+          ("time-frame-length",
+              po::value<uint32_t>(&mOptions.timeFrameLength)->default_value(0),
+              "Index the CRU superpages by time frames of the given amount of heartbeat orbits, from the RDH orbits, "
+              "and count the superpages that straddle a time frame boundary. 0 to not index them.")
           ("to-file-ascii",
               po::value<std::string>(&mOptions.fileOutputPathAscii),
               "Read out to given file in ASCII format")
           ("to-file-bin",
               po::value<std::string>(&mOptions.fileOutputPathBin),
-              "Read out to given file in binary format (only contains raw data from pages)");
+              "Read out to given file in binary format (only contains raw data from pages). Give a comma separated list "
+              "of files, e.g. on different NVMe devices, to stripe the superpages across them. Whole superpages are "
+              "written by background threads with O_DIRECT, and only reused when they were recorded. An index of the "
+              "superpages is written next to the first file, with '.index' appended.")
+          ("trace-file",
+              po::value<std::string>(&mOptions.traceFilePath),
+              "Write the trace of the channel's most recent DMA events to the given file at the end, for roc-trace")
+          ("write-combining",
+              po::bool_switch(&mOptions.writeCombining),
+              "Write CRU superpage descriptors through a write-combining mapping")
+          ("firmware-capabilities",
+              po::bool_switch(&mOptions.firmwareCapabilities),
+              "Read the performance capabilities of the CRU firmware, to use them by default. Only for firmware known "
+              "to have the capabilities register.")
+          ("register-shadowing",
+              po::bool_switch(&mOptions.registerShadowing),
+              "Shadow the CRU control registers that are read-modify-written, so configuring them needs no reads");
     }
 
     virtual void run(const po::variables_map& map)
@@ -193,10 +467,31 @@ class ProgramDmaBench: public Program
         i = DATA_COUNTER_INITIAL_VALUE;
       }
 
-      for (auto&i : mPacketCounters) {
-        i = PACKET_COUNTER_INITIAL_VALUE;
+      if (mOptions.readoutThreads < 1) {
+        throw ParameterException() << ErrorInfo::Message("Amount of readout threads must be at least 1");
+      }
+      if (mOptions.randomPause) {
+        if (mOptions.consumerModel != "none" && mOptions.consumerModel != "random") {
+          throw ParameterException() << ErrorInfo::Message("--random-pause conflicts with --consumer-model");
+        }
+        mOptions.consumerModel = "random";
+      }
+      // Checks the model before the DMA starts, the readout threads make their own
+      ConsumerModel(mOptions.consumerModel);
+      if (!mOptions.timeFrameIndexPath.empty()) {
+        if (mOptions.timeFrameLength == 0) {
+          throw ParameterException() << ErrorInfo::Message("Time frame index requires --time-frame-length");
+        }
+        mTimeFrameIndexStream.open(mOptions.timeFrameIndexPath);
+        mTimeFrameIndexStream << "# superpage link time_frame first_orbit last_orbit first_packet packets offset size "
+            "continued\n";
+      }
+      if (mOptions.errorCheckSample < 1) {
+        throw ParameterException() << ErrorInfo::Message("Error check sample must be at least 1");
+      }
+      if (mOptions.checkCopies > 0 && (mOptions.noErrorCheck || mOptions.pageReset)) {
+        throw ParameterException() << ErrorInfo::Message("Checking copies requires error checking without page reset");
       }
-
       getLogger() << "DMA channel: " << mOptions.dmaChannel << endm;
 
       auto cardId = Options::getOptionCardId(map);
@@ -205,7 +500,8 @@ class ProgramDmaBench: public Program
       params.setGeneratorEnabled(mOptions.generatorEnabled);
       if (!mOptions.generatorEnabled) // if generator is not enabled, force loopbackMode=NONE for proper errorchecking
         mOptions.loopbackModeString = "NONE";
-      params.setGeneratorLoopback(LoopbackMode::fromString(mOptions.loopbackModeString));
+      mLoopbackMode = LoopbackMode::fromString(mOptions.loopbackModeString);
+      params.setGeneratorLoopback(mLoopbackMode);
 
       // Handle file output options
       {
@@ -214,16 +510,45 @@ class ProgramDmaBench: public Program
 
         if (mOptions.fileOutputAscii && mOptions.fileOutputBin) {
           throw ParameterException() << ErrorInfo::Message("File output can't be both ASCII and binary");
+        } else if ((mOptions.fileOutputAscii || mOptions.fileOutputBin)
+            && (mOptions.readoutThreads > 1 || mOptions.checkCopies > 0)) {
+          throw ParameterException() << ErrorInfo::Message("File output requires a single readout thread");
         } else {
           if (mOptions.fileOutputAscii) {
             mReadoutStream.open(mOptions.fileOutputPathAscii);
           }
           if (mOptions.fileOutputBin) {
-            mReadoutStream.open(mOptions.fileOutputPathBin, std::ios::binary);
+            SuperpageRecorder::Options recorderOptions;
+            b::split(recorderOptions.stripePaths, mOptions.fileOutputPathBin, [](char c) { return c == ','; });
+            recorderOptions.compression = SuperpageRecorder::compressionFromString(mOptions.fileCompression);
+            recorderOptions.compressionLevel = mOptions.fileCompressionLevel;
+            recorderOptions.compressionThreads = mOptions.fileCompressionThreads;
+            recorderOptions.queueDepth = mOptions.fileQueueDepth;
+            mRecorder = std::make_unique<SuperpageRecorder>(recorderOptions);
+            mRecorderCompleted.resize(mRecorder->getQueueDepth());
+            getLogger() << "Recording to " << mOptions.fileOutputPathBin
+              << (mRecorder->isDirect() ? " with" : " without") << " O_DIRECT, index " << mRecorder->getIndexPath()
+              << endm;
           }
         }
       }
 
+      // Handle tap options
+      if (mOptions.tapPort != 0) {
+        if (mOptions.readoutThreads > 1 || mOptions.checkCopies > 0) {
+          throw ParameterException() << ErrorInfo::Message("Tap requires a single readout thread");
+        }
+        SuperpageTap::Options tapOptions;
+        tapOptions.port = mOptions.tapPort;
+        tapOptions.sampleEvery = mOptions.tapEvery;
+        if (!mOptions.tapLinks.empty()) {
+          tapOptions.links = Parameters::linkMaskFromString(mOptions.tapLinks);
+        }
+        tapOptions.maxSampleSize = mSuperpageSize;
+        mTap = std::make_unique<SuperpageTap>(tapOptions);
+        getLogger() << "Tap listening on port " << mTap->getPort() << endm;
+      }
+
       // Handle generator pattern option
       if (!mOptions.generatorPatternString.empty()) {
         mOptions.generatorPattern = GeneratorPattern::fromString(mOptions.generatorPatternString);
@@ -236,6 +561,7 @@ class ProgramDmaBench: public Program
 
       // Log IOMMU status
       getLogger() << "IOMMU " << (AliceO2::Common::Iommu::isEnabled() ? "enabled" : "not enabled") << endm;
+      getLogger() << "Data pattern check implementation: " << DataPattern::getImplementation() << endm;
 
       // Create channel buffer
       {
@@ -249,49 +575,149 @@ class ProgramDmaBench: public Program
             % mOptions.dmaChannel
             % time(0)).str();
 
+        b::optional<int> numaNode;
+        if (mOptions.numaBind) {
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+          auto cardNumaNode = RocPciDevice(cardId).getCardDescriptor().numaNode;
+          if (cardNumaNode >= 0) {
+            numaNode = cardNumaNode;
+            getLogger() << "Binding buffer to NUMA node " << cardNumaNode << endm;
+          } else {
+            getLogger() << "Card has no NUMA node, not binding buffer" << endm;
+          }
+#else
+          getLogger() << "NUMA binding requires PDA, not binding buffer" << endm;
+#endif
+        }
+
         Utilities::HugepageType hugepageType;
-        mMemoryMappedFile = Utilities::tryMapFile(mBufferSize, bufferName, !mOptions.noRemovePagesFile, &hugepageType);
+        mMemoryMappedFile = Utilities::tryMapFile(mBufferSize, bufferName, !mOptions.noRemovePagesFile, &hugepageType,
+            numaNode);
 
         mBufferBaseAddress = reinterpret_cast<uintptr_t>(mMemoryMappedFile->getAddress());
         getLogger() << "Using buffer file path: " << mMemoryMappedFile->getFileName() << endm;
+
+        if (mOptions.prefaultBuffer || mOptions.lockBuffer) {
+          auto start = std::chrono::steady_clock::now();
+          if (mOptions.prefaultBuffer) {
+            mMemoryMappedFile->prefault();
+          }
+          if (mOptions.lockBuffer) {
+            mMemoryMappedFile->lock();
+          }
+          getLogger() << "Buffer pages faulted in " << std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - start).count() << " ms" << endm;
+        }
       }
 
       // Set up channel parameters
       mPageSize = params.getDmaPageSize().get();
       params.setCardId(cardId);
       params.setChannelNumber(mOptions.dmaChannel);
-      params.setGeneratorDataSize(mPageSize);
+      if (mPageSize != 0) {
+        params.setGeneratorDataSize(mPageSize);
+      }
       params.setGeneratorPattern(mOptions.generatorPattern);
       params.setBufferParameters(buffer_parameters::Memory { mMemoryMappedFile->getAddress(),
           mMemoryMappedFile->getSize() });
       params.setLinkMask(Parameters::linkMaskFromString(mOptions.links));
 
       mInfinitePages = (mOptions.maxBytes <= 0);
-      mMaxPages = mOptions.maxBytes / mPageSize;
 
       if (mOptions.readoutMode) {
         params.setReadoutMode(*mOptions.readoutMode);
       }
 
-      if (!Utilities::isMultiple(mSuperpageSize, mPageSize)) {
+      if (mOptions.interrupt) {
+        params.setInterruptEnabled(true);
+      }
+
+      if (mOptions.writeCombining) {
+        params.setWriteCombiningEnabled(true);
+      }
+
+      if (mOptions.firmwareCapabilities) {
+        params.setFirmwareCapabilitiesEnabled(true);
+      }
+
+      if (mOptions.bufferDump) {
+        params.setBufferDumpExcluded(false);
+      }
+
+      if (mOptions.registerShadowing) {
+        params.setRegisterShadowingEnabled(true);
+      }
+
+      if (!mOptions.replayFile.empty()) {
+        params.setReplayFile(mOptions.replayFile);
+      }
+
+      if (mOptions.replayRate != 0) {
+        params.setReplayRate(mOptions.replayRate);
+      }
+
+      if (mOptions.dummyLinkBandwidth != 0) {
+        params.setDummyLinkBandwidth(mOptions.dummyLinkBandwidth);
+      }
+
+      if (!mOptions.linkSchedulingString.empty()) {
+        params.setLinkScheduling(LinkScheduling::fromString(mOptions.linkSchedulingString));
+      }
+
+      if (!mOptions.readyQueueOverflowString.empty()) {
+        params.setReadyQueueOverflow(ReadyQueueOverflow::fromString(mOptions.readyQueueOverflowString));
+      }
+
+      if (!mOptions.cacheAllocation.empty()) {
+        const auto group = "roc-bench-dma-" + std::to_string(getpid());
+        mCacheAllocation = std::make_unique<CacheAllocation>(group, mOptions.cacheAllocation);
+        getLogger() << "Cache allocation group: " << mCacheAllocation->getPath() << endm;
+        if (mOptions.driverThread) {
+          params.setDriverThreadCacheGroup(group);
+        }
+      }
+
+      if (mOptions.asyncLogging) {
+        params.setAsyncLoggingEnabled(true);
+      }
+      if (mOptions.publishStatistics) {
+        params.setStatisticsPublishingEnabled(true);
+      }
+      if (mOptions.driverThread) {
+        params.setDriverThreadEnabled(true);
+        if (mOptions.driverThreadCpu >= 0) {
+          params.setDriverThreadCpu(mOptions.driverThreadCpu);
+        }
+      }
+
+      if (mPageSize != 0 && !Utilities::isMultiple(mSuperpageSize, mPageSize)) {
         throw ParameterException() << ErrorInfo::Message("Superpage size not a multiple of page size");
       }
 
       mMaxSuperpages = mBufferSize / mSuperpageSize;
-      mPagesPerSuperpage = mSuperpageSize / mPageSize;
       getLogger() << "Buffer size: " << mBufferSize << endm;
       getLogger() << "Superpage size: " << mSuperpageSize << endm;
       getLogger() << "Superpages in buffer: " << mMaxSuperpages << endm;
-      getLogger() << "Page size: " << mPageSize << endm;
-      getLogger() << "Page limit: " << mMaxPages << endm;
-      getLogger() << "Pages per superpage: " << mPagesPerSuperpage << endm;
 
+      if (!mOptions.sizeProfile.empty()) {
+        if (mPageSize == 0) {
+          throw ParameterException() << ErrorInfo::Message("Size profile requires an explicit page size");
+        }
+        applySizeProfile(mOptions.sizeProfile);
+      }
       if (mOptions.dataGeneratorSize != 0) {
         params.setGeneratorDataSize(mOptions.dataGeneratorSize);
         getLogger() << "Generator data size: " << mOptions.dataGeneratorSize << endm;
       } else {
         getLogger() << "Generator data size: <internal default>"  << endm;
       }
+      if (mOptions.generatorRandomSize) {
+        params.setGeneratorRandomSizeEnabled(true);
+        getLogger() << "Generator data size: random" << endm;
+      }
+      if (mOptions.packed) {
+        params.setPackedPacketsEnabled(true);
+      }
 
       // Get DMA channel object
       try {
@@ -304,21 +730,86 @@ class ProgramDmaBench: public Program
       }
 
       mCardType = mChannel->getCardType();
+      // The simulated card generates or replays CRU data, so it is checked like a CRU's
+      mDataFormat = (mCardType == CardType::Simulated) ? CardType::Cru : mCardType;
+      if (mOptions.packed && mDataFormat != CardType::Cru) {
+        throw ParameterException() << ErrorInfo::Message("Packed packets are only supported with CRU data");
+      }
+      if (mOptions.timeFrameLength != 0 && mDataFormat != CardType::Cru) {
+        throw ParameterException() << ErrorInfo::Message("Time frame indexing is only supported with CRU data");
+      }
       getLogger() << "Card type: " << CardType::toString(mChannel->getCardType()) << endm;
       getLogger() << "Card PCI address: " << mChannel->getPciAddress().toString() << endm;
       getLogger() << "Card NUMA node: " << mChannel->getNumaNode() << endm;
       getLogger() << "Card firmware info: " << mChannel->getFirmwareInfo().value_or("unknown") << endm;
 
-      getLogger() << "Starting benchmark" << endm;
-      mChannel->startDma();
+      // The page size the channel settled on, which the page walkers and checks follow
+      mPageSize = mChannel->getDmaPageSize();
+      if (!Utilities::isMultiple(mSuperpageSize, mPageSize)) {
+        throw ParameterException() << ErrorInfo::Message("Superpage size not a multiple of page size");
+      }
+      mMaxPages = mOptions.maxBytes / mPageSize;
+      mPagesPerSuperpage = mSuperpageSize / mPageSize;
+      getLogger() << "Page size: " << mPageSize << endm;
+      getLogger() << "Page limit: " << mMaxPages << endm;
+      getLogger() << "Pages per superpage: " << mPagesPerSuperpage << endm;
+      for (int i = 0; i < mOptions.readoutThreads; ++i) {
+        mReadoutErrors.push_back(std::make_unique<ReadoutErrors>(mPageSize, mOptions.packed,
+            mOptions.timeFrameLength));
+        mReadoutLatencies.push_back(std::make_unique<LinkLatencies>());
+      }
+
+      setupAffinity();
 
+      if (!mOptions.outputJsonPath.empty() || !mOptions.outputCsvPath.empty()) {
+        if (mOptions.outputInterval == 0) {
+          throw ParameterException() << ErrorInfo::Message("Output interval must be greater than 0");
+        }
+        auto configuration = getConfiguration(map);
+        if (!mOptions.outputJsonPath.empty()) {
+          mResultOutputs.push_back(std::make_unique<BenchmarkOutput>(mOptions.outputJsonPath,
+              BenchmarkOutput::Format::Json, configuration));
+        }
+        if (!mOptions.outputCsvPath.empty()) {
+          mResultOutputs.push_back(std::make_unique<BenchmarkOutput>(mOptions.outputCsvPath,
+              BenchmarkOutput::Format::Csv, configuration));
+        }
+      }
+
+      if (mOptions.prepareDma) {
+        getLogger() << "Preparing DMA" << endm;
+        mChannel->prepareDma();
+      }
+
+      std::shared_ptr<BarInterface> hammerBar;
       if (mOptions.barHammer) {
         if (mChannel->getCardType() != CardType::Cru) {
           BOOST_THROW_EXCEPTION(ParameterException()
               << ErrorInfo::Message("BarHammer option currently only supported for CRU"));
         }
-        Utilities::resetSmartPtr(mBarHammer);
-        mBarHammer->start(ChannelFactory().getBar(Parameters::makeParameters(cardId, 0)));
+        hammerBar = ChannelFactory().getBar(Parameters::makeParameters(cardId, 0));
+        if (mOptions.barHammerBaseline > 0) {
+          getLogger() << "Hammering the BAR for a baseline without DMA" << endm;
+          startBarHammers(hammerBar, mBarHammersIdle);
+          std::this_thread::sleep_for(std::chrono::milliseconds(mOptions.barHammerBaseline));
+          joinBarHammers(mBarHammersIdle);
+        }
+      }
+
+      if (!mOptions.clockRegister.empty()) {
+        startClockCorrelator(cardId);
+      }
+
+      getLogger() << "Starting benchmark" << endm;
+      const auto dmaStart = std::chrono::steady_clock::now();
+      mChannel->startDma();
+      if (mOptions.prepareDma) {
+        getLogger() << (b::format("DMA started in %.1f us") % std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - dmaStart).count()).str() << endm;
+      }
+
+      if (hammerBar) {
+        startBarHammers(hammerBar, mBarHammers);
       }
 
       if (!mOptions.timeLimitString.empty()) {
@@ -330,11 +821,17 @@ class ProgramDmaBench: public Program
       }
 
       mRunTime.start = std::chrono::steady_clock::now();
+      mRunTime.startTicks = Utilities::getTimestampCounter();
       dmaLoop();
       mRunTime.end = std::chrono::steady_clock::now();
-
-      if (mBarHammer) {
-        mBarHammer->join();
+      mRunTime.endTicks = Utilities::getTimestampCounter();
+
+      joinBarHammers(mBarHammers);
+      if (mClockCorrelator) {
+        mClockCorrelator->stop();
+        getLogger() << (b::format("Card clock correlated with %d samples, drift %.2f ppm, residual %.0f ns")
+            % mClockCorrelator->getSampleCount() % mClockCorrelator->getDriftPpm()
+            % mClockCorrelator->getResidual()).str() << endm;
       }
 
       std::cout << "\n\n";
@@ -342,8 +839,45 @@ class ProgramDmaBench: public Program
       int popped = freeExcessPages(10ms);
       getLogger() << "Popped " << popped << " remaining superpages" << endm;
 
+      if (!mOptions.traceFilePath.empty()) {
+        std::ofstream traceFile(mOptions.traceFilePath);
+        mChannel->dumpTrace(traceFile);
+        getLogger() << "Wrote trace to " << mOptions.traceFilePath << ", convert it with roc-trace" << endm;
+      }
+
+      if (mRecorder) {
+        while (mRecorder->getInFlight() > 0) {
+          reapRecorder(nullptr, true);
+        }
+        getLogger() << "Recorded " << mRecorder->getBytesRecorded() << " bytes, stored in "
+            << mRecorder->getBytesStored() << " bytes" << endm;
+      }
+      if (mTap) {
+        getLogger() << "Tap sampled " << mTap->getSampledCount() << " of " << mTap->getOfferedCount()
+            << " superpages, sent " << mTap->getSentCount() << ", dropped " << mTap->getDroppedCount()
+            << (mTap->isZeroCopy() ? " (zero-copy)" : "") << endm;
+        mTap.reset();
+      }
+
       outputErrors();
       outputStats();
+      if (!mResultOutputs.empty()) {
+        auto sample = makeSample(mRunTime.end, 0, 0);
+        for (auto& output : mResultOutputs) {
+          output->writeSummary(sample);
+        }
+      }
+      if (mOptions.countAllocations) {
+        if (mPushAllocationSuperpages == 0) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(
+              "Run too short to count allocations, every superpage must go around at least once"));
+        }
+        if (mPushAllocations != 0) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Push thread allocated in the steady state: "
+              + std::to_string(mPushAllocations) + " allocations in " + std::to_string(mPushAllocationSuperpages)
+              + " superpages"));
+        }
+      }
       getLogger() << "Benchmark complete" << endm;
     }
 
@@ -355,16 +889,15 @@ class ProgramDmaBench: public Program
         throw std::runtime_error("Buffer too small");
       }
 
-      // Lock-free queues. Usable size is (size-1), so we add 1
-      /// Queue for passing filled superpages from the push thread to the readout thread
-      folly::ProducerConsumerQueue<size_t> readoutQueue {static_cast<uint32_t>(mMaxSuperpages) + 1};
-      /// Queue for free superpages. This starts out as full, then the readout thread consumes them. When superpages
-      /// arrive, they are passed via the readoutQueue to the readout thread. When the readout thread is done with it,
-      /// it is put back in the freeQueue.
-      folly::ProducerConsumerQueue<size_t> freeQueue {static_cast<uint32_t>(mMaxSuperpages) + 1};
+      // Lock-free rings. Both have room for every superpage, so they can't fill up.
+      /// Ring for passing filled superpages from the push thread to the readout thread
+      SuperpageRing readoutRing(mMaxSuperpages);
+      /// Ring for free superpages. This starts out as full, then the push thread consumes them. When superpages
+      /// arrive, they are passed via the readoutRing to the readout thread. When the readout thread is done with it,
+      /// it is put back in the freeRing.
+      SuperpageRing freeRing(mMaxSuperpages);
       for (size_t i = 0; i < mMaxSuperpages; ++i) {
-        size_t offset = i * mSuperpageSize;
-        if (!freeQueue.write(offset)) {
+        if (!freeRing.write(Superpage(i * mSuperpageSize, mSuperpageSize))) {
           BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
         }
       }
@@ -375,7 +908,10 @@ class ProgramDmaBench: public Program
       // Thread for low priority tasks
       auto lowPriorityFuture = std::async(std::launch::async, [&]{
         try {
+          pinThread(mLowPriorityCpus, "display");
+          ThreadPerfCounters perfCounters(*this, PerfRole::LowPriority);
           auto next = std::chrono::steady_clock::now();
+          auto nextSample = next + std::chrono::milliseconds(mOptions.outputInterval);
           while (!isStopDma()) {
             // Handle a SIGINT abort
             if (isSigInt()) {
@@ -398,6 +934,15 @@ class ProgramDmaBench: public Program
             if (!mOptions.noDisplay && mPushCount.load(std::memory_order_relaxed) != 0) {
               updateStatusDisplay();
             }
+
+            // Machine-readable samples
+            if (!mResultOutputs.empty() && next >= nextSample) {
+              auto sample = makeSample(std::chrono::steady_clock::now(), readoutRing.sizeGuess(), freeRing.sizeGuess());
+              for (auto& output : mResultOutputs) {
+                output->writeSample(sample);
+              }
+              nextSample += std::chrono::milliseconds(mOptions.outputInterval);
+            }
             next += LOW_PRIORITY_INTERVAL;
             std::this_thread::sleep_until(next);
           }
@@ -411,69 +956,71 @@ class ProgramDmaBench: public Program
       // Thread for pushing & checking arrivals
       auto pushFuture = std::async(std::launch::async, [&]{
         try {
-          RandomPauses pauses;
-          int currentPagesCounted = 0;
+          pinThread(mPushCpus, "push");
+          ThreadPerfCounters perfCounters(*this, PerfRole::Push);
+          ConsumerModel pauses(mOptions.randomPause ? "random" : "none");
+          std::vector<Superpage> superpages(mMaxSuperpages);
+          // The steady state starts when every superpage of the buffer went around once
+          boost::optional<Utilities::AllocationScope> allocations;
+          size_t allocationsPopped = 0;
 
           while (!isStopDma()) {
+            if (mOptions.countAllocations && !allocations
+                && mSuperpagesPopped.load(std::memory_order_relaxed) >= mMaxSuperpages) {
+              allocations.emplace();
+              allocationsPopped = mSuperpagesPopped.load(std::memory_order_relaxed);
+            }
+
             // Check if we need to stop in the case of a page limit
-            if (!mInfinitePages && mPushCount.load(std::memory_order_relaxed) >= mMaxPages
-                && (currentPagesCounted == 0)) {
+            if (!mInfinitePages && mPushCount.load(std::memory_order_relaxed) >= mMaxPages) {
               break;
             }
-            if (mOptions.randomPause) {
-              pauses.pauseIfNeeded();
-            }
+            pauses.consume(0);
 
             // Keep the driver's queue filled
+            auto fillStart = Utilities::getTimestampCounter();
             mChannel->fillSuperpages();
+            mFillLatency.record(Utilities::getTimestampCounter() - fillStart);
 
             auto shouldRest = false;
 
             // Give free superpages to the driver
-            if (mChannel->getTransferQueueAvailable() != 0) {
-              while (mChannel->getTransferQueueAvailable() != 0) {
-                Superpage superpage;
-                size_t offsetRead;
-                if (freeQueue.read(offsetRead)) {
-                  superpage.setSize(mSuperpageSize);
-                  superpage.setOffset(offsetRead);
-                  mChannel->pushSuperpage(superpage);
-                } else {
-                  // No free pages available, so take a little break
-                  shouldRest = true;
-                  break;
-                }
+            if (auto available = mChannel->getTransferQueueAvailable()) {
+              auto count = freeRing.read(superpages.data(), std::min(size_t(available), superpages.size()));
+              if (count > 0) {
+                mSuperpagesPushed.fetch_add(count, std::memory_order_relaxed);
+                mChannel->pushSuperpages(superpages.data(), count);
+              }
+              if (count < size_t(available)) {
+                // Not enough free pages available, so take a little break
+                shouldRest = true;
               }
             } else {
               // No transfer queue slots available on the card
               shouldRest = true;
             }
 
-            // Check for filled superpages
-            while (mChannel->getReadyQueueSize() != 0) {
-              auto superpage = mChannel->getSuperpage();
-              // We do partial updates of the mPushCount because we can have very large superpages, which would otherwise
-              // cause hiccups in the display
-              int pages = superpage.getReceived() / mPageSize;
-              int pagesToCount = pages - currentPagesCounted;
-              mPushCount.fetch_add(pagesToCount, std::memory_order_relaxed);
-              currentPagesCounted += pagesToCount;
-
-              if (superpage.isReady() && readoutQueue.write(superpage.getOffset())) {
-                // Move full superpage to readout queue
-                currentPagesCounted = 0;
-                mChannel->popSuperpage();
-              } else {
-                // Readout is backed up, so rest a while
-                shouldRest = true;
-                break;
-              }
+            // Move filled superpages to the readout ring
+            auto popped = mChannel->popSuperpages(superpages.data(), superpages.size());
+            mSuperpagesPopped.fetch_add(popped, std::memory_order_relaxed);
+            for (size_t i = 0; i < popped; ++i) {
+              mPushCount.fetch_add(superpages[i].getReceived() / mPageSize, std::memory_order_relaxed);
+              recordArrivalLatency(superpages[i]);
+            }
+            if (readoutRing.write(superpages.data(), popped) != popped) {
+              BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
             }
+            trackOccupancy(freeRing.sizeGuess());
 
             if (shouldRest) {
-              std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pausePush));
+              // Wait for the card to fill a superpage instead of sleeping blindly
+              mChannel->waitForReadySuperpage(std::chrono::microseconds(mOptions.pausePush));
             }
           }
+          if (allocations) {
+            mPushAllocations = allocations->get();
+            mPushAllocationSuperpages = mSuperpagesPopped.load(std::memory_order_relaxed) - allocationsPopped;
+          }
         }
         catch (std::exception& e) {
           mDmaLoopBreak = true;
@@ -481,323 +1028,1105 @@ class ProgramDmaBench: public Program
         }
       });
 
-      // Readout thread (main thread)
-      {
-        RandomPauses pauses;
+      if (mOptions.readoutThreads == 1 && mOptions.checkCopies == 0) {
+        // Readout thread (main thread)
+        pinThread(mReadoutCpus, "readout");
+        joinCacheAllocation();
+        ThreadPerfCounters perfCounters(*this, PerfRole::Readout);
+        ConsumerModel consumer(mOptions.consumerModel);
 
         while (!isStopDma()) {
-          if (!mInfinitePages && mReadoutCount.load(std::memory_order_relaxed) >= mMaxPages) {
+          if (isPageLimitReached()) {
             mDmaLoopBreak = true;
             break;
           }
-          if (mOptions.randomPause) {
-            pauses.pauseIfNeeded();
-          }
 
-          size_t offset;
-          if (readoutQueue.read(offset)) {
-            // Read out pages
-            int pages = mSuperpageSize / mPageSize;
-            for (int i = 0; i < pages; ++i) {
-              auto readoutCount = fetchAddReadoutCount();
-              readoutPage(mBufferBaseAddress + offset + i * mPageSize, mPageSize, readoutCount);
+          Superpage superpage;
+          if (readoutRing.read(superpage)) {
+            consume(consumer, superpage.getReceived() / mPageSize);
+            readoutSuperpage(superpage, *mReadoutErrors[0], *mReadoutLatencies[0]);
+            if (mTap) {
+              mTap->offer(superpage, reinterpret_cast<const void*>(mBufferBaseAddress + superpage.getOffset()),
+                  superpage.getReceived());
             }
 
             // Page has been read out
-            // Add superpage back to free queue
-            if (!freeQueue.write(offset)) {
+            if (mRecorder) {
+              // The recorder adds it back to the free ring when it's written
+              recordSuperpage(superpage, &freeRing);
+            } else if (!freeRing.write(Superpage(superpage.getOffset(), mSuperpageSize))) {
+              // Add superpage back to free ring
               BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
             }
+          } else if (mRecorder && mRecorder->getInFlight() > 0) {
+            reapRecorder(&freeRing, false);
           } else {
             // No superpages available to read out, so have a nap
             std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pauseRead));
           }
         }
+      } else {
+        readoutParallel(readoutRing, freeRing, mDmaLoopBreak);
       }
 
       pushFuture.get();
       lowPriorityFuture.get();
     }
 
-    /// Atomically fetch and increment the readout count. We do this because it is accessed by multiple threads.
-    /// Although there is currently only one writer at a time and a regular increment probably would be OK.
-    uint64_t fetchAddReadoutCount()
+    /// Sets the generator size options of a --size-profile. The generator can only make fixed sizes, or uniformly
+    /// random multiples of 256 bits up to its data size, so the profiles are combinations of those.
+    void applySizeProfile(const std::string& profile)
     {
-      return mReadoutCount.fetch_add(1, std::memory_order_relaxed);
+      if (mOptions.dataGeneratorSize != 0 || mOptions.generatorRandomSize) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(
+            "--size-profile conflicts with --generator-size and --generator-random-size"));
+      }
+      constexpr size_t SMALL_EVENT_SIZE = 1024;
+      if (profile == "full") {
+        mOptions.dataGeneratorSize = mPageSize;
+      } else if (profile == "half") {
+        mOptions.dataGeneratorSize = mPageSize / 2;
+      } else if (profile == "small") {
+        mOptions.dataGeneratorSize = SMALL_EVENT_SIZE;
+      } else if (profile == "uniform") {
+        mOptions.dataGeneratorSize = mPageSize;
+        mOptions.generatorRandomSize = true;
+      } else if (profile == "uniform-small") {
+        mOptions.dataGeneratorSize = SMALL_EVENT_SIZE;
+        mOptions.generatorRandomSize = true;
+      } else {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Unknown size profile")
+            << ErrorInfo::String(profile));
+      }
+      getLogger() << "Size profile: " << profile << endm;
     }
 
-    /// Free the pages that remain after stopping DMA (these may not be filled)
-    int freeExcessPages(std::chrono::milliseconds timeout)
+    /// Delays a readout thread as its consumer model says before it reads out a superpage
+    void consume(ConsumerModel& consumer, size_t pages)
     {
-      auto start = std::chrono::steady_clock::now();
-      int popped = 0;
-      while ((std::chrono::steady_clock::now() - start) < timeout) {
-        auto size = mChannel->getReadyQueueSize();
-        for (int i = 0; i < size; ++i) {
-          auto superpage = mChannel->popSuperpage();
-          if (mOptions.loopbackModeString == "NONE") { //if it's ddg
-            int pages = mSuperpageSize / mPageSize;
-            for (int i = 0; i < pages; ++i) {
-              auto readoutCount = fetchAddReadoutCount();
-              readoutPage(mBufferBaseAddress + superpage.getOffset() + i * mPageSize, mPageSize, readoutCount);
-            }
-          }
-          std::cout << "[popped superpage " << i << " ], size= " << superpage.getSize() << " received= " << superpage.getReceived() << " isFilled=" << superpage.isFilled() << " isReady=" << 
-            superpage.isReady() << std::endl;
-        }
-        popped += size;
+      auto delay = consumer.consume(pages);
+      if (delay.count() > 0) {
+        mConsumerDelay.fetch_add(delay.count(), std::memory_order_relaxed);
       }
-      return popped;
     }
 
-    uint32_t get32bitFromPage(uintptr_t pageAddress, size_t index)
+    /// Tracks how many superpages are queued for the card, and how many wait for the readout, given the amount in the
+    /// free ring. When the card has none, the firmware has nowhere to put its data, and would overflow with real
+    /// detector data. Push thread only.
+    void trackOccupancy(size_t free)
     {
-      auto page = reinterpret_cast<void*>(pageAddress + index*4);
-      uint32_t value = 0;
-      memcpy(&value, page, sizeof(value));
-      return value;
+      // The card's queue starts out empty, so it is only tracked from the first arrival on
+      auto popped = mSuperpagesPopped.load(std::memory_order_relaxed);
+      if (popped == 0) {
+        return;
+      }
+      auto pushed = mSuperpagesPushed.load(std::memory_order_relaxed);
+      size_t card = pushed > popped ? pushed - popped : 0;
+      mCardQueueLowWater = std::min(mCardQueueLowWater, card);
+      if (card == 0 && !mCardQueueWasEmpty) {
+        mCardQueueEmpty++;
+      }
+      mCardQueueWasEmpty = (card == 0);
+      size_t waiting = mMaxSuperpages - std::min(mMaxSuperpages, free + card);
+      mBufferHighWater = std::max(mBufferHighWater, waiting);
     }
 
-    uint32_t getDataGeneratorCounterFromPage(uintptr_t pageAddress, size_t headerSize)
+    /// Threads whose PMU events are counted separately with --perf-counters
+    enum class PerfRole
     {
-      switch (mCardType) {
-        case CardType::Crorc:
-          return get32bitFromPage(pageAddress, 0);
-        case CardType::Cru: {
-          // Grab the first payload word as the counter's beginning
-          auto payload = reinterpret_cast<const volatile uint32_t *>(pageAddress + headerSize);
-          return payload[0];
-        }
-        default: throw std::runtime_error("Error checking unsupported for this card type");
-      }
+      Push,
+      Readout, ///< The readout threads, and the main thread dispatching to them
+      LowPriority,
     };
 
-    void readoutPage(uintptr_t pageAddress, size_t pageSize, int64_t readoutCount)
+    /// Counts the PMU events of the calling thread while it exists, and adds them to those of its role, with
+    /// --perf-counters
+    class ThreadPerfCounters
     {
-      // Read out to file
-      printToFile(pageAddress, pageSize, readoutCount);
-
-      // Data error checking
-      if (!mOptions.noErrorCheck) {
-
-        // Get link ID if needed
-        uint32_t linkId = 0; // Use 0 for non-CRU cards
-        if (mCardType == CardType::Cru) {
-          linkId = Cru::DataFormat::getLinkId(reinterpret_cast<const char*>(pageAddress));
-          if (linkId >= mDataGeneratorCounters.size()) {
-            BOOST_THROW_EXCEPTION(Exception()
-              << ErrorInfo::Message("Link ID from superpage out of range")
-              << ErrorInfo::Index(linkId));
+      public:
+        ThreadPerfCounters(ProgramDmaBench& bench, PerfRole role) : mBench(bench), mRole(role)
+        {
+          if (bench.mOptions.perfCounters) {
+            mCounters = std::make_unique<PerfCounters>();
           }
         }
 
-        // Check for errors
-        bool hasError = true;
-        switch (mCardType) {
-          case CardType::Crorc:
-            hasError = checkErrorsCrorc(pageAddress, pageSize, readoutCount, linkId);
-            break;
-          case CardType::Cru:
-            hasError = checkErrorsCru(pageAddress, pageSize, readoutCount, linkId, mOptions.loopbackModeString);
-            break;
-          default:
-            throw std::runtime_error("Error checking unsupported for this card type");
+        ~ThreadPerfCounters()
+        {
+          if (mCounters) {
+            std::lock_guard<std::mutex> lock(mBench.mPerfMutex);
+            mBench.mPerfCounts[size_t(mRole)] += mCounters->read();
+            mBench.mPerfUserOnly = mBench.mPerfUserOnly || mCounters->isUserOnly();
+          }
         }
 
-        if (hasError && !mOptions.noResyncCounter) {
-          // There was an error, so we resync the counter on the next page
-          mDataGeneratorCounters[linkId] = DATA_COUNTER_INITIAL_VALUE;
-          mPacketCounters[linkId] = PACKET_COUNTER_INITIAL_VALUE;
+      private:
+        ProgramDmaBench& mBench;
+        PerfRole mRole;
+        std::unique_ptr<PerfCounters> mCounters;
+    };
+
+    /// Rings between the dispatching main thread and one of the readout threads
+    struct ReadoutWorker
+    {
+        explicit ReadoutWorker(size_t capacity) : input(capacity), output(capacity)
+        {
         }
-      }
 
-      if (mOptions.pageReset) {
-        // Set the buffer to the default value after the readout
-        resetPage(pageAddress, pageSize);
-      }
-    }
+        /// Superpages to read out
+        SuperpageRing input;
+        /// Superpages that were read out
+        SuperpageRing output;
+    };
 
-    bool checkErrorsCru(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId, std::string loopbackMode)
+    /// A copy of a superpage for the readout threads to check, with --check-copies
+    struct CheckCopy
     {
-      if (loopbackMode == "NONE")
-        return checkErrorsCruDdg(pageAddress, pageSize, eventNumber, linkId);
-      else if (loopbackMode == "INTERNAL")
-        return checkErrorsCruInternal(pageAddress, pageSize, eventNumber, linkId);
-      else
-        throw std::runtime_error("Loopback Mode not supported");
-    }
- 
-    bool checkErrorsCruInternal(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId)
+        /// Readout count of the superpage's first page
+        uint64_t readoutCount;
+        /// Amount of superpages of the link that were not checked before this one
+        uint64_t skipped;
+    };
+
+    /// Reads out with multiple threads. The main thread hands the superpages from the readout ring to the readout
+    /// threads, and collects the ones they are done with into the free ring, so every ring keeps a single producer and
+    /// a single consumer.
+    /// The error checks follow the counters of a link from page to page, so with error checking a link's superpages
+    /// are always given to the same thread. Without it, a superpage is given to the thread with the least work queued.
+    /// With --check-copies, the main thread copies a superpage, with the CPU or the --copy-engine, and puts it in the
+    /// free ring once the copy is done, and the readout threads check the copy. If all copies are in flight, the
+    /// superpage is not checked, so the checks never hold back the DMA.
+    void readoutParallel(SuperpageRing& readoutRing, SuperpageRing& freeRing, std::atomic<bool>& dmaLoopBreak)
     {
-      // pcie internal pattern
-      // Every 256-bit word is built as follows:
-      // 32 bits counter + 32 bits counter + 32-bit counter + 32 bit counter
-      // 32 bits counter + 32 bits counter + 32-bit counter + 32 bit counter
-      
-      // Get dataCounter value only if page is valid...
-      if (mDataGeneratorCounters[linkId] == DATA_COUNTER_INITIAL_VALUE) {
-        auto dataCounter = getDataGeneratorCounterFromPage(pageAddress, 0x0); // no header!
-        mErrorStream << b::format("resync dataCounter for e:%d l:%d cnt:%x\n") % eventNumber % linkId % dataCounter;
-        mDataGeneratorCounters[linkId] = dataCounter;
+      auto isStopDma = [&]{ return dmaLoopBreak.load(std::memory_order_relaxed); };
+      ThreadPerfCounters perfCounters(*this, PerfRole::Readout);
+      const size_t threads = mOptions.readoutThreads;
+      const size_t copies = mOptions.checkCopies;
+      const size_t capacity = std::max(mMaxSuperpages, copies);
+
+      std::vector<std::unique_ptr<ReadoutWorker>> workers;
+      for (size_t i = 0; i < threads; ++i) {
+        workers.push_back(std::make_unique<ReadoutWorker>(capacity));
       }
-      
-      const uint32_t dataCounter = mDataGeneratorCounters[linkId];
 
-      bool foundError = false;
-      auto checkValue = [&](uint32_t i, uint32_t expectedValue, uint32_t actualValue) {
-        if (expectedValue != actualValue) {
-          foundError = true;
-          addError(eventNumber, linkId, i, dataCounter, expectedValue, actualValue, pageSize);
+      // The copies are indexed by their offset in the copy buffer. Only the main thread uses the free list and the
+      // skipped flags.
+      std::vector<char, Utilities::AlignedAllocator<char, Utilities::CACHE_LINE_SIZE>> copyBuffer(
+          copies * mSuperpageSize);
+      const auto copyBufferAddress = reinterpret_cast<uintptr_t>(copyBuffer.data());
+      std::vector<CheckCopy> copyInfo(copies);
+      std::vector<size_t> freeCopies;
+      for (size_t i = 0; i < copies; ++i) {
+        freeCopies.push_back(copies - 1 - i);
+      }
+      // Destroyed before the copy buffer, so the copies in flight are waited for
+      CopyEngine copyEngine(mOptions.copyEngine);
+      if (copies > 0) {
+        getLogger() << "Copy engine: " << (copyEngine.isHardware() ? mOptions.copyEngine : std::string("CPU")) << endm;
+      }
+      std::vector<Superpage> copySources(copies);
+      std::vector<Superpage> released;
+      std::array<uint64_t, MAX_LINKS> linkSkipped {};
+      uint64_t notChecked = 0;
+
+      std::vector<std::future<void>> futures;
+      for (size_t i = 0; i < threads; ++i) {
+        futures.push_back(std::async(std::launch::async, [&, i]{
+          try {
+            pinThread(getReadoutThreadCpus(i), "readout");
+            joinCacheAllocation();
+            ThreadPerfCounters perfCounters(*this, PerfRole::Readout);
+            ConsumerModel consumer(mOptions.consumerModel);
+            auto& worker = *workers[i];
+            while (!isStopDma()) {
+              Superpage superpage;
+              if (worker.input.read(superpage)) {
+                // A copy holds a whole superpage
+                consume(consumer, copies > 0 ? mPagesPerSuperpage : superpage.getReceived() / mPageSize);
+                if (copies > 0) {
+                  const auto& info = copyInfo[superpage.getOffset() / mSuperpageSize];
+                  skipSuperpages(superpage.getLinkId(), info.skipped, *mReadoutErrors[i]);
+                  readoutPages(copyBufferAddress + superpage.getOffset(), info.readoutCount, true,
+                      *mReadoutErrors[i]);
+                } else {
+                  readoutSuperpage(superpage, *mReadoutErrors[i], *mReadoutLatencies[i]);
+                }
+                if (!worker.output.write(Superpage(superpage.getOffset(), mSuperpageSize))) {
+                  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
+                }
+              } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pauseRead));
+              }
+            }
+          }
+          catch (std::exception& e) {
+            dmaLoopBreak = true;
+            throw;
+          }
+        }));
+      }
+
+      auto selectWorker = [&](const Superpage& superpage) {
+        if (!mOptions.noErrorCheck) {
+          return size_t(superpage.getLinkId()) % threads;
+        }
+        size_t selected = 0;
+        for (size_t i = 1; i < threads; ++i) {
+          if (workers[i]->input.sizeGuess() < workers[selected]->input.sizeGuess()) {
+            selected = i;
+          }
         }
+        return selected;
       };
 
-      const auto payload = reinterpret_cast<const volatile uint32_t*> (pageAddress);
-
-      // Check iterating through 256-bit words
-      uint32_t offset = (dataCounter % (0x100000000)); // mod 0xffffffff + 1
-      uint32_t i = 0;
+      // Starts a copy of the superpage, if a copy is free
+      // Returns false if no copy was started, in which case the superpage can be freed right away
+      auto dispatchCopy = [&](const Superpage& superpage) {
+        const auto readoutCount = fetchAddReadoutCount();
+        auto& skipped = linkSkipped.at(superpage.getLinkId());
+        if (skipped + 1 < mOptions.errorCheckSample) {
+          skipped++;
+          return false;
+        }
+        if (freeCopies.empty() || !copyEngine.submit(&copyBuffer[freeCopies.back() * mSuperpageSize],
+            reinterpret_cast<const void*>(mBufferBaseAddress + superpage.getOffset()), mSuperpageSize,
+            freeCopies.back())) {
+          skipped++;
+          notChecked++;
+          return false;
+        }
+        const auto index = freeCopies.back();
+        freeCopies.pop_back();
+        copyInfo[index] = CheckCopy{readoutCount, skipped};
+        copySources[index] = superpage;
+        skipped = 0;
+        return true;
+      };
 
-      while ((i*4) < pageSize) { //this is indexing, it has nothing to do with iterating step
-        uint32_t word32 = i; // 32-bit word pointer
+      // Gives the finished copies to their readout threads, and their sources to the free ring
+      auto completeCopies = [&]() {
+        uint64_t indices[CopyEngine::QUEUE_DEPTH];
+        const auto count = copyEngine.poll(indices, CopyEngine::QUEUE_DEPTH);
+        for (size_t i = 0; i < count; ++i) {
+          const auto& source = copySources[indices[i]];
+          released.push_back(Superpage(source.getOffset(), mSuperpageSize));
+          Superpage copy(indices[i] * mSuperpageSize, mSuperpageSize);
+          copy.setLinkId(source.getLinkId());
+          if (!workers[selectWorker(source)]->input.write(copy)) {
+            BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
+          }
+        }
+      };
 
-        checkValue(word32 + 0, offset, payload[word32 + 0]); //32-bit counter
-        checkValue(word32 + 1, offset, payload[word32 + 1]); //32-bit counter
-        checkValue(word32 + 2, offset, payload[word32 + 2]); //32-bit counter 
-        checkValue(word32 + 3, offset, payload[word32 + 3]); //32-bit counter
-        checkValue(word32 + 4, offset, payload[word32 + 4]); //32-bit counter
-        checkValue(word32 + 5, offset, payload[word32 + 5]); //32-bit counter
-        checkValue(word32 + 6, offset, payload[word32 + 6]); //32-bit counter 
-        checkValue(word32 + 7, offset, payload[word32 + 7]); //32-bit counter 
+      try {
+        std::vector<Superpage> superpages(capacity);
+        while (!isStopDma()) {
+          if (isPageLimitReached()) {
+            dmaLoopBreak = true;
+            break;
+          }
 
-        offset = (offset+1) % (0x100000000); //Increase dataCounter by 1 - mod 0xffffffff + 1
-        i += 8; // 8 = expected 2*sizeof(uint32_t);
-      }
-      
-      mDataGeneratorCounters[linkId] = offset;
-      return foundError;
-    }
+          auto count = readoutRing.read(superpages.data(), superpages.size());
+          released.clear();
+          for (size_t i = 0; i < count; ++i) {
+            if (copies > 0) {
+              if (!dispatchCopy(superpages[i])) {
+                released.push_back(Superpage(superpages[i].getOffset(), mSuperpageSize));
+              }
+            } else if (!workers[selectWorker(superpages[i])]->input.write(superpages[i])) {
+              BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
+            }
+          }
+          if (copies > 0) {
+            completeCopies();
+            if (freeRing.write(released.data(), released.size()) != released.size()) {
+              BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
+            }
+          }
 
-    bool checkErrorsCruDdg(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId)
-    {
-      // Get memsize from the header
-      const auto memBytes = Cru::DataFormat::getEventSize(reinterpret_cast<const char*>(pageAddress)); // Memory size [RDH, Payload]
+          size_t returned = 0;
+          for (auto& worker : workers) {
+            auto done = worker->output.read(superpages.data(), superpages.size());
+            if (copies > 0) {
+              for (size_t i = 0; i < done; ++i) {
+                freeCopies.push_back(superpages[i].getOffset() / mSuperpageSize);
+              }
+            } else if (freeRing.write(superpages.data(), done) != done) {
+              BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
+            }
+            returned += done;
+          }
 
-      if (memBytes < 40 || memBytes > pageSize) {
-        // Report RDH error
-        mErrorCount++;
-        if (mErrorCount < MAX_RECORDED_ERRORS) {
-          mErrorStream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% words out of range\n") % eventNumber
-            % linkId % memBytes % pageSize;
+          if (count == 0 && returned == 0 && released.empty()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pauseRead));
+          }
         }
-        return true;
       }
-
-      // check link's packet counter here
-      const auto packetCounter = Cru::DataFormat::getPacketCounter(reinterpret_cast<const char*>(pageAddress));
-
-      if (mPacketCounters[linkId] == PACKET_COUNTER_INITIAL_VALUE) {
-        mErrorStream << b::format("resync packet counter for e:%d l:%d packet_cnt:%x mpacket_cnt:%x\n") % eventNumber % linkId % packetCounter % 
-          mPacketCounters[linkId];
-        mPacketCounters[linkId] = packetCounter;
-      } else if (((mPacketCounters[linkId] + 1) % 0x100) != packetCounter) { //packetCounter is 8bits long
-        // log packet counter error
-        mErrorCount++;
-        if (mErrorCount < MAX_RECORDED_ERRORS) {
-          mErrorStream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% packet_cnt:%5% mpacket_cnt:%6% unexpected packet counter\n")
-            % eventNumber % linkId % memBytes % pageSize % packetCounter % mPacketCounters[linkId];
+      catch (std::exception& e) {
+        dmaLoopBreak = true;
+        for (auto& future : futures) {
+          future.wait();
         }
-        return true;
-      } else {
-        //mErrorStream << b::format("packet_cnt:%x mpacket_cnt:%x\n") % packetCounter % mPacketCounters[linkId];
-        mPacketCounters[linkId] = packetCounter; // same as = (mPacketCounters + 1) % 0x100
+        throw;
       }
 
-      // Get counter value only if page is valid...
-      const auto dataCounter = getDataGeneratorCounterFromPage(pageAddress, Cru::DataFormat::getHeaderSize());
-      if (mDataGeneratorCounters[linkId] == DATA_COUNTER_INITIAL_VALUE) {
-        mErrorStream << b::format("resync counter for e:%d l:%d cnt:%x\n") % eventNumber % linkId % dataCounter;
-        mDataGeneratorCounters[linkId] = dataCounter;
+      for (auto& future : futures) {
+        future.get();
       }
-      //const uint32_t dataCounter = mDataGeneratorCounters[linkId];
 
-      //skip the header -> address + 0x40
-      const auto payload = reinterpret_cast<const volatile uint32_t*>(pageAddress + Cru::DataFormat::getHeaderSize()); 
-      const auto payloadBytes = memBytes - Cru::DataFormat::getHeaderSize();
-      
-      bool foundError = false;
-      auto checkValue = [&](uint32_t i, uint32_t expectedValue, uint32_t actualValue) {
-        if (expectedValue != actualValue) {
-          foundError = true;
-          addError(eventNumber, linkId, i, dataCounter, expectedValue, actualValue, payloadBytes);
+      if (copies > 0) {
+        getLogger() << notChecked << " superpages were not checked, since all copies were in flight" << endm;
+        if (copyEngine.getFallbackCount() > 0) {
+          getLogger() << copyEngine.getFallbackCount() << " copies were finished by the CPU" << endm;
+        }
+      }
+    }
+
+    /// Determines the CPUs of the benchmark's threads from the --push-cpu, --readout-cpu and --numa-pin options
+    void setupAffinity()
+    {
+      std::vector<int> localCpus;
+      if (mOptions.numaPin) {
+        try {
+          localCpus = Utilities::getLocalCpus(mChannel->getPciAddress());
+        } catch (const Exception&) {
+          getLogger() << InfoLogger::Warning << "Could not get the card's local CPUs, not pinning to them" << endm;
         }
+      }
+      mPushCpus = mOptions.pushCpus.empty() ? localCpus : Utilities::parseCpuList(mOptions.pushCpus);
+      mReadoutCpus = mOptions.readoutCpus.empty() ? localCpus : Utilities::parseCpuList(mOptions.readoutCpus);
+      mLowPriorityCpus = localCpus;
+
+      auto toString = [](const std::vector<int>& cpus) {
+        std::string string;
+        for (auto cpu : cpus) {
+          string += (string.empty() ? "" : ",") + std::to_string(cpu);
+        }
+        return string.empty() ? std::string("any") : string;
       };
+      getLogger() << "Push thread CPUs: " << toString(mPushCpus) << endm;
+      getLogger() << "Readout thread CPUs: " << toString(mReadoutCpus) << endm;
+
+      if (mCacheAllocation) {
+        // The cache allocation should not overlap with the ways the card's writes go to
+        if (auto ways = CacheAllocation::getDdioWayMask(mReadoutCpus.empty() ? 0 : mReadoutCpus.front())) {
+          getLogger() << (b::format("DDIO LLC ways: 0x%x") % *ways).str() << endm;
+        } else {
+          getLogger() << "DDIO LLC ways: unknown, the MSR could not be read" << endm;
+        }
+      }
+    }
 
-      // Check iterating through 256-bit words
-      uint32_t offset = (dataCounter % (0x100000000)); // mod 0xffffffff + 1
-      uint32_t i = 0;
+    /// Gets the CPUs of a readout thread of readoutParallel(). An explicit --readout-cpu list gives each thread its
+    /// own CPU, the card's local CPUs are shared.
+    std::vector<int> getReadoutThreadCpus(size_t thread)
+    {
+      if (mOptions.readoutCpus.empty() || mReadoutCpus.empty()) {
+        return mReadoutCpus;
+      }
+      return {mReadoutCpus[thread % mReadoutCpus.size()]};
+    }
 
-      // ddg pattern
+    /// Moves the calling thread into the --cache-allocation group. Does nothing if there is none.
+    void joinCacheAllocation()
+    {
+      if (!mCacheAllocation) {
+        return;
+      }
+      try {
+        mCacheAllocation->addCurrentThread();
+      } catch (const Exception&) {
+        getLogger() << InfoLogger::Warning << "Could not move a readout thread into the cache allocation group" << endm;
+      }
+    }
+
+    /// Pins the calling thread to the given CPUs. Does nothing if there are none.
+    void pinThread(const std::vector<int>& cpus, const char* name)
+    {
+      if (cpus.empty()) {
+        return;
+      }
+      try {
+        Utilities::setThreadAffinity(cpus);
+      } catch (const Exception&) {
+        getLogger() << InfoLogger::Warning << "Could not set the affinity of the " << name << " thread" << endm;
+      }
+    }
+
+    /// Parses the --bar-hammer-* options
+    BarHammer::Options getBarHammerOptions()
+    {
+      BarHammer::Options options;
+      if (mOptions.barHammerModeString == "write") {
+        options.mode = BarHammer::Mode::Write;
+      } else if (mOptions.barHammerModeString == "read") {
+        options.mode = BarHammer::Mode::Read;
+      } else if (mOptions.barHammerModeString == "raw") {
+        options.mode = BarHammer::Mode::ReadAfterWrite;
+      } else {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Invalid BAR hammer mode, must be 'write', "
+            "'read' or 'raw'") << ErrorInfo::String(mOptions.barHammerModeString));
+      }
+
+      if (mOptions.barHammerWidth != 32 && mOptions.barHammerWidth != 64 && mOptions.barHammerWidth != 128) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("BAR hammer width must be 32, 64 or 128"));
+      }
+      if (mOptions.barHammerWidth != 32 && options.mode != BarHammer::Mode::Write) {
+        BOOST_THROW_EXCEPTION(ParameterException()
+            << ErrorInfo::Message("BAR hammer widths above 32 bits are only supported for writes"));
+      }
+      options.width = mOptions.barHammerWidth;
+
+      if (!mOptions.barHammerAddress.empty()) {
+        size_t address = 0;
+        try {
+          address = std::stoul(mOptions.barHammerAddress, nullptr, 0);
+        } catch (const std::exception&) {
+          BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Invalid BAR hammer address")
+              << ErrorInfo::String(mOptions.barHammerAddress));
+        }
+        if (address % (options.width / 8) != 0) {
+          BOOST_THROW_EXCEPTION(ParameterException()
+              << ErrorInfo::Message("BAR hammer address must be aligned to the access width")
+              << ErrorInfo::Address(address));
+        }
+        options.index = address / sizeof(uint32_t);
+      } else if (options.width != 32) {
+        getLogger() << InfoLogger::Warning << "BAR hammer writes wider than 32 bits also write the registers after "
+            "the debug register, give a scratch area with --bar-hammer-address" << endm;
+      }
+
+      if (mOptions.barHammerThreads < 1) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("BAR hammer threads must be at least 1"));
+      }
+      return options;
+    }
+
+    /// Starts the BAR hammer threads, each on its own CPU of --bar-hammer-cpu if given
+    void startBarHammers(const std::shared_ptr<BarInterface>& bar, std::vector<std::unique_ptr<BarHammer>>& hammers)
+    {
+      auto options = getBarHammerOptions();
+      auto cpus = mOptions.barHammerCpus.empty() ? std::vector<int>() : Utilities::parseCpuList(mOptions.barHammerCpus);
+      for (int i = 0; i < mOptions.barHammerThreads; ++i) {
+        if (!cpus.empty()) {
+          options.cpus = {cpus[i % cpus.size()]};
+        }
+        hammers.push_back(std::make_unique<BarHammer>());
+        hammers.back()->start(bar, options);
+      }
+    }
+
+    void joinBarHammers(std::vector<std::unique_ptr<BarHammer>>& hammers)
+    {
+      for (auto& hammer : hammers) {
+        hammer->join();
+        if (hammer->isPinFailed()) {
+          getLogger() << InfoLogger::Warning << "Could not set the affinity of a BAR hammer thread" << endm;
+        }
+      }
+    }
+
+    /// Prints the throughput and latencies of the BAR hammer threads, without and with DMA running
+    void outputBarHammers()
+    {
+      if (mBarHammers.empty()) {
+        return;
+      }
+
+      auto format = b::format("  %-12s  %-6s  %-12.3f  %-10.1f  %-10.1f  %-10.1f  %-10.1f  %-10s\n");
+      cout << '\n' << b::format("  %-12s  %-6s  %-12s  %-10s  %-10s  %-10s  %-10s  %-10s\n") % "BAR (ns)"
+          % "Thread" % "M accesses/s" % "p50" % "p99" % "p99.9" % "Max" % "Mismatches";
+
+      auto put = [&](const char* label, const std::vector<std::unique_ptr<BarHammer>>& hammers) {
+        LatencyHistogram total;
+        double accessesPerSecond = 0;
+        double ticksPerNanosecond = 0;
+        int64_t mismatches = 0;
+        auto row = [&](const std::string& thread, double rate, const LatencyHistogram& histogram, double ticks,
+            int64_t mismatchCount) {
+          if (ticks <= 0) {
+            return;
+          }
+          auto ns = [&](uint64_t value) { return double(value) / ticks; };
+          cout << format % label % thread % (rate / 1e6) % ns(histogram.getPercentile(50))
+              % ns(histogram.getPercentile(99)) % ns(histogram.getPercentile(99.9)) % ns(histogram.getMax())
+              % mismatchCount;
+        };
+        for (size_t i = 0; i < hammers.size(); ++i) {
+          const auto& hammer = *hammers[i];
+          double rate = hammer.getSeconds() > 0 ? hammer.getCount() / hammer.getSeconds() : 0;
+          if (hammers.size() > 1) {
+            row(std::to_string(i), rate, hammer.getLatencies(), hammer.getTicksPerNanosecond(), hammer.getMismatches());
+          }
+          total.merge(hammer.getLatencies());
+          accessesPerSecond += rate;
+          ticksPerNanosecond = std::max(ticksPerNanosecond, hammer.getTicksPerNanosecond());
+          mismatches += hammer.getMismatches();
+        }
+        row("all", accessesPerSecond, total, ticksPerNanosecond, mismatches);
+      };
+
+      put("Without DMA", mBarHammersIdle);
+      put("During DMA", mBarHammers);
+    }
+
+    bool isPageLimitReached()
+    {
+      return !mInfinitePages && mReadoutCount.load(std::memory_order_relaxed) >= mMaxPages;
+    }
+
+    /// Records the time from pushing a superpage to its arrival. Push thread only.
+    void recordArrivalLatency(const Superpage& superpage)
+    {
+      auto pushed = superpage.getPushTimestamp();
+      // Backends that don't timestamp leave it at 0
+      if (pushed != 0 && superpage.getTimestamp() != 0 && superpage.getTimestamp() >= pushed) {
+        mArrivalLatencies[superpage.getLinkId()].record(superpage.getTimestamp() - pushed);
+      }
+    }
+
+    /// Correlates the --clock-register counter with the host clock in the background during the run
+    void startClockCorrelator(const Parameters::CardIdType& cardId)
+    {
+      if (mCardType != CardType::Cru) {
+        BOOST_THROW_EXCEPTION(ParameterException()
+            << ErrorInfo::Message("Clock correlation currently only supported for CRU"));
+      }
+      size_t address = 0;
+      try {
+        address = std::stoul(mOptions.clockRegister, nullptr, 0);
+      } catch (const std::exception&) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Invalid clock register address")
+            << ErrorInfo::String(mOptions.clockRegister));
+      }
+      if (address % 4 != 0) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Clock register address must be aligned to 4")
+            << ErrorInfo::Address(address));
+      }
+
+      std::shared_ptr<BarInterface> bar = ChannelFactory().getBar(Parameters::makeParameters(cardId, 2));
+      ClockCorrelator::Options options;
+      options.frequency = mOptions.clockFrequency;
+      options.counterBits = 32;
+      const auto index = address / 4;
+      mClockCorrelator = std::make_unique<ClockCorrelator>([bar, index]{ return bar->readRegister(index); }, options);
+      // The first sample is taken before the DMA starts, so every superpage can be converted
+      mClockCorrelator->sample();
+      mClockCorrelator->start();
+    }
+
+    /// Reads out the pages of a superpage
+    /// \param latencies Histograms of the calling thread, for the time the superpage waited since its arrival
+    void readoutSuperpage(const Superpage& superpage, ReadoutErrors& errors, LinkLatencies& latencies)
+    {
+      auto now = Utilities::getTimestampCounter();
+      if (superpage.getTimestamp() != 0 && now >= superpage.getTimestamp()) {
+        latencies[superpage.getLinkId()].record(now - superpage.getTimestamp());
+      }
+
+      if (mClockCorrelator && superpage.getReceived() >= Cru::DataFormat::getHeaderSize()) {
+        // The orbit counter of the card puts the heartbeat orbit of the data on the host clock
+        auto rdh = Cru::decodeRdh(reinterpret_cast<const char*>(mBufferBaseAddress + superpage.getOffset()));
+        auto orbitTime = mClockCorrelator->toHostTime(rdh.heartbeatOrbit);
+        auto readoutTime = ClockCorrelator::getHostTime();
+        if (readoutTime >= orbitTime) {
+          errors.orbitLatencies[superpage.getLinkId()].record(uint64_t(readoutTime - orbitTime));
+        }
+      }
+
+      const bool check = !mOptions.noErrorCheck && sampleSuperpage(superpage.getLinkId(), errors);
+      const auto readoutCount = fetchAddReadoutCount();
+      if (errors.timeFrameIndexer) {
+        indexTimeFrames(superpage, readoutCount / mPagesPerSuperpage, errors);
+      }
+      readoutPages(mBufferBaseAddress + superpage.getOffset(), readoutCount, check, errors);
+    }
+
+    /// Indexes a superpage by time frame, before the page reset overwrites the RDHs, and writes the index to the
+    /// --time-frame-index file
+    void indexTimeFrames(const Superpage& superpage, uint64_t superpageNumber, ReadoutErrors& errors)
+    {
+      auto& slices = errors.timeFrameSlices;
+      errors.timeFrameIndexer->indexSuperpage(reinterpret_cast<const void*>(mBufferBaseAddress + superpage.getOffset()),
+          mSuperpageSize, slices);
+      uint64_t started = 0;
+      for (const auto& slice : slices) {
+        started += slice.continued ? 0 : 1;
+      }
+      errors.timeFrames.fetch_add(started, std::memory_order_relaxed);
+      if (slices.size() > 1) {
+        errors.straddlingSuperpages.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      if (mTimeFrameIndexStream.is_open()) {
+        std::lock_guard<std::mutex> lock(mTimeFrameIndexMutex);
+        for (const auto& slice : slices) {
+          mTimeFrameIndexStream << superpageNumber << ' ' << slice.linkId << ' ' << slice.timeFrame << ' '
+              << slice.firstOrbit << ' ' << slice.lastOrbit << ' ' << slice.firstPacket << ' ' << slice.packets << ' '
+              << slice.offset << ' ' << slice.size << ' ' << slice.continued << '\n';
+        }
+      }
+    }
+
+    /// Decides if a superpage of the link is checked, with --errorcheck-sample. Before a checked superpage, the link's
+    /// counters are moved past the superpages that were not.
+    bool sampleSuperpage(uint32_t linkId, ReadoutErrors& errors)
+    {
+      auto& skipped = mSampleSkipped.at(linkId);
+      if (skipped + 1 < mOptions.errorCheckSample) {
+        skipped++;
+        return false;
+      }
+      skipSuperpages(linkId, skipped, errors);
+      skipped = 0;
+      return true;
+    }
+
+    /// Moves the counters of a link past superpages that were not checked
+    void skipSuperpages(uint32_t linkId, uint64_t superpages, ReadoutErrors& errors)
+    {
+      if (superpages == 0) {
+        return;
+      }
+      if (mCardType == CardType::Crorc && mDataGeneratorCounters[linkId] != DATA_COUNTER_INITIAL_VALUE) {
+        // The C-RORC counter increments by one every page, so it can be predicted
+        mDataGeneratorCounters[linkId] += uint32_t(superpages * mPagesPerSuperpage);
+      } else {
+        resyncCounters(linkId, errors);
+      }
+    }
+
+    /// Reads out the pages of a superpage
+    /// \param address Address of the superpage's data, in the DMA buffer or a copy of it
+    /// \param readoutCount Readout count of the superpage's first page
+    /// \param check Check the pages for errors
+    void readoutPages(uintptr_t address, uint64_t readoutCount, bool check, ReadoutErrors& errors)
+    {
+      if (mOptions.packed) {
+        return readoutPackets(address, readoutCount, check, errors);
+      }
+      // The card type is resolved once per superpage, so the page loop is instantiated per card type
+      switch (mDataFormat) {
+        case CardType::Crorc:
+          return readoutPages(CardTypeTag::CrorcTag, address, readoutCount, check, errors);
+        case CardType::Cru:
+          return readoutPages(CardTypeTag::CruTag, address, readoutCount, check, errors);
+        default:
+          return readoutPages(CardTypeTag::UnknownTag, address, readoutCount, check, errors);
+      }
+    }
+
+    template <class CardTag>
+    void readoutPages(CardTag tag, uintptr_t address, uint64_t readoutCount, bool check, ReadoutErrors& errors)
+    {
+      const size_t distance = mOptions.prefetchDistance;
+      for (size_t i = 1; i < std::min(distance, mPagesPerSuperpage); ++i) {
+        Utilities::prefetchRange(reinterpret_cast<const void*>(address + i * mPageSize), mPageSize);
+      }
+      uint64_t payloadBytes = 0;
+      for (size_t i = 0; i < mPagesPerSuperpage; ++i) {
+        if (distance != 0 && (i + distance) < mPagesPerSuperpage) {
+          Utilities::prefetchRange(reinterpret_cast<const void*>(address + (i + distance) * mPageSize), mPageSize);
+        }
+        payloadBytes += getPayloadSize(tag, address + i * mPageSize);
+        readoutPage(tag, address + i * mPageSize, mPageSize, readoutCount + i, check, errors);
+      }
+      errors.payloadBytes.fetch_add(payloadBytes, std::memory_order_relaxed);
+    }
+
+    /// Reads out a superpage of packed CRU packets, stepping from one packet to the next by their RDH offsets. The
+    /// readout count still counts DMA pages, the packets are numbered from it for the error messages.
+    void readoutPackets(uintptr_t address, uint64_t readoutCount, bool check, ReadoutErrors& errors)
+    {
+      uint64_t payloadBytes = 0;
+      int64_t packetNumber = readoutCount;
+      const auto end = address + mSuperpageSize;
+      for (const auto& packet : Cru::SuperpageView(reinterpret_cast<const void*>(address), mSuperpageSize, mPageSize,
+          mOptions.prefetchDistance, true, true)) {
+        const auto packetAddress = reinterpret_cast<uintptr_t>(packet.page);
+        // An invalid packet's offset can't be trusted, the walk ends with it
+        const size_t packetSize = packet.valid ? packet.rdh.offsetNextPacket : end - packetAddress;
+        payloadBytes += packet.payloadSize;
+        printToFile(packetAddress, packetSize, packetNumber);
+        if (check) {
+          const uint32_t linkId = getLinkIdFromPage(CardTypeTag::CruTag, packetAddress);
+          if (checkErrorsCruDdg(packetAddress, packetSize, packetNumber, linkId, errors) && !mOptions.noResyncCounter) {
+            resyncCounters(linkId, errors);
+          }
+        }
+        packetNumber++;
+      }
+      errors.payloadBytes.fetch_add(payloadBytes, std::memory_order_relaxed);
+
+      if (mOptions.pageReset && !mRecorder) {
+        // The packets don't line up with the pages, so they are reset together
+        resetPage(address, mSuperpageSize);
+      }
+    }
+
+    /// Gets the payload size of a page. Only the CRU data format gives it, the pages of the others count as full.
+    template <class CardTag>
+    size_t getPayloadSize(CardTag, uintptr_t)
+    {
+      return mPageSize;
+    }
+
+    size_t getPayloadSize(CardTypeTag::CruTag_, uintptr_t pageAddress)
+    {
+      const size_t memorySize = Cru::decodeRdh(reinterpret_cast<const char*>(pageAddress)).memorySize;
+      const auto headerSize = Cru::DataFormat::getHeaderSize();
+      return (memorySize > headerSize && memorySize <= mPageSize) ? memorySize - headerSize : 0;
+    }
+
+    /// Checks if the payload throughput is known, which needs the sizes of all pages read out
+    bool isPayloadCounted() const
+    {
+      return mDataFormat == CardType::Cru && mOptions.checkCopies == 0;
+    }
+
+    uint64_t getPayloadBytes() const
+    {
+      uint64_t bytes = 0;
+      for (const auto& errors : mReadoutErrors) {
+        bytes += errors->payloadBytes.load(std::memory_order_relaxed);
+      }
+      return bytes;
+    }
+
+    /// Starts recording a superpage. If the recorder's queue is full, waits for a superpage to be recorded.
+    /// \param freeRing Ring to add the completed superpages back to, or nullptr if they are not reused
+    void recordSuperpage(const Superpage& superpage, SuperpageRing* freeRing)
+    {
+      auto address = reinterpret_cast<const void*>(mBufferBaseAddress + superpage.getOffset());
+      while (!mRecorder->write(Superpage(superpage.getOffset(), mSuperpageSize), address, mSuperpageSize)) {
+        reapRecorder(freeRing, true);
+      }
+    }
+
+    /// Collects the superpages that were recorded. Page reset is done here, since the pages must not be touched while
+    /// they are recorded.
+    /// \param freeRing Ring to add the superpages back to, or nullptr if they are not reused
+    /// \param wait Wait for at least one superpage to be recorded
+    void reapRecorder(SuperpageRing* freeRing, bool wait)
+    {
+      auto count = mRecorder->reap(mRecorderCompleted.data(), mRecorderCompleted.size(), wait);
+      if (mOptions.pageReset) {
+        for (size_t i = 0; i < count; ++i) {
+          resetPage(mBufferBaseAddress + mRecorderCompleted[i].getOffset(), mSuperpageSize);
+        }
+      }
+      if (freeRing && (freeRing->write(mRecorderCompleted.data(), count) != count)) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
+      }
+    }
+
+    /// Atomically fetch and add the pages of a superpage to the readout count. We do this because it is accessed by
+    /// multiple threads, and with --readout-threads there are multiple writers.
+    /// \return The readout count of the superpage's first page
+    uint64_t fetchAddReadoutCount()
+    {
+      return mReadoutCount.fetch_add(mPagesPerSuperpage, std::memory_order_relaxed);
+    }
+
+    /// Gets the total amount of errors of all readout threads
+    int64_t getErrorCount() const
+    {
+      int64_t count = 0;
+      for (const auto& errors : mReadoutErrors) {
+        count += errors->count.load(std::memory_order_relaxed);
+      }
+      return count;
+    }
+
+    /// Free the pages that remain after stopping DMA (these may not be filled)
+    int freeExcessPages(std::chrono::milliseconds timeout)
+    {
+      auto start = std::chrono::steady_clock::now();
+      int popped = 0;
+      while ((std::chrono::steady_clock::now() - start) < timeout) {
+        auto size = mChannel->getReadyQueueSize();
+        for (int i = 0; i < size; ++i) {
+          auto superpage = mChannel->popSuperpage();
+          if (mLoopbackMode == LoopbackMode::None) { //if it's ddg
+            // The readout threads have stopped, so one of their error records can be used
+            readoutSuperpage(superpage, *mReadoutErrors[0], *mReadoutLatencies[0]);
+            if (mRecorder) {
+              recordSuperpage(superpage, nullptr);
+            }
+          }
+          std::cout << "[popped superpage " << i << " ], size= " << superpage.getSize() << " received= " << superpage.getReceived() << " isFilled=" << superpage.isFilled() << " isReady=" << 
+            superpage.isReady() << std::endl;
+        }
+        popped += size;
+      }
+      return popped;
+    }
+
+    uint32_t get32bitFromPage(uintptr_t pageAddress, size_t index)
+    {
+      auto page = reinterpret_cast<void*>(pageAddress + index*4);
+      uint32_t value = 0;
+      memcpy(&value, page, sizeof(value));
+      return value;
+    }
+
+    uint32_t getDataGeneratorCounterFromPage(CardTypeTag::CrorcTag_, uintptr_t pageAddress, size_t)
+    {
+      return get32bitFromPage(pageAddress, 0);
+    }
+
+    uint32_t getDataGeneratorCounterFromPage(CardTypeTag::CruTag_, uintptr_t pageAddress, size_t headerSize)
+    {
+      // Grab the first payload word as the counter's beginning
+      auto payload = reinterpret_cast<const uint32_t*>(pageAddress + headerSize);
+      return payload[0];
+    }
+
+    /// Gets the link ID of a page. Only the CRU puts it in the data, the other cards use 0.
+    template <class CardTag>
+    uint32_t getLinkIdFromPage(CardTag, uintptr_t)
+    {
+      return 0;
+    }
+
+    uint32_t getLinkIdFromPage(CardTypeTag::CruTag_, uintptr_t pageAddress)
+    {
+      auto linkId = Cru::DataFormat::getLinkId(reinterpret_cast<const char*>(pageAddress));
+      if (linkId >= mDataGeneratorCounters.size()) {
+        BOOST_THROW_EXCEPTION(Exception()
+          << ErrorInfo::Message("Link ID from superpage out of range")
+          << ErrorInfo::Index(linkId));
+      }
+      return linkId;
+    }
+
+    template <class CardTag>
+    bool checkErrors(CardTag, uintptr_t, size_t, int64_t, int, ReadoutErrors&)
+    {
+      throw std::runtime_error("Error checking unsupported for this card type");
+    }
+
+    bool checkErrors(CardTypeTag::CrorcTag_, uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId,
+        ReadoutErrors& errors)
+    {
+      return checkErrorsCrorc(pageAddress, pageSize, eventNumber, linkId, errors);
+    }
+
+    bool checkErrors(CardTypeTag::CruTag_, uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId,
+        ReadoutErrors& errors)
+    {
+      return checkErrorsCru(pageAddress, pageSize, eventNumber, linkId, errors);
+    }
+
+    template <class CardTag>
+    void readoutPage(CardTag tag, uintptr_t pageAddress, size_t pageSize, int64_t readoutCount, bool check,
+        ReadoutErrors& errors)
+    {
+      // Read out to file
+      printToFile(pageAddress, pageSize, readoutCount);
+
+      // Data error checking
+      if (check) {
+        uint32_t linkId = getLinkIdFromPage(tag, pageAddress);
+        bool hasError = checkErrors(tag, pageAddress, pageSize, readoutCount, linkId, errors);
+
+        if (hasError && !mOptions.noResyncCounter) {
+          // There was an error, so we resync the counter on the next page
+          resyncCounters(linkId, errors);
+        }
+      }
+
+      if (mOptions.pageReset && !mRecorder) {
+        // Set the buffer to the default value after the readout
+        resetPage(pageAddress, pageSize);
+      }
+    }
+
+    /// With --errorcheck-sample, the counters resync on most checked superpages, so that is not logged
+    bool isResyncLogged() const
+    {
+      return mOptions.errorCheckSample == 1;
+    }
+
+    /// Makes the next page of the link start the sequence of its data generator and packet counters
+    void resyncCounters(uint32_t linkId, ReadoutErrors& errors)
+    {
+      mDataGeneratorCounters[linkId] = DATA_COUNTER_INITIAL_VALUE;
+      errors.integrity.resync(linkId);
+    }
+
+    bool checkErrorsCru(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId, ReadoutErrors& errors)
+    {
+      switch (mLoopbackMode) {
+        case LoopbackMode::None:
+          return checkErrorsCruDdg(pageAddress, pageSize, eventNumber, linkId, errors);
+        case LoopbackMode::Internal:
+          return checkErrorsCruInternal(pageAddress, pageSize, eventNumber, linkId, errors);
+        default:
+          throw std::runtime_error("Loopback Mode not supported");
+      }
+    }
+ 
+    bool checkErrorsCruInternal(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId,
+        ReadoutErrors& errors)
+    {
+      // pcie internal pattern
       // Every 256-bit word is built as follows:
-      // 32 bits counter       + 32 bits counter       + 16 lsb counter       + 32 bit 0
-      // 32 bits (counter + 1) + 32 bits (counter + 1) + 16 lsb (counter + 1) + 32 bit 0
+      // 32 bits counter + 32 bits counter + 32-bit counter + 32 bit counter
+      // 32 bits counter + 32 bits counter + 32-bit counter + 32 bit counter
+      
+      // Get dataCounter value only if page is valid...
+      if (mDataGeneratorCounters[linkId] == DATA_COUNTER_INITIAL_VALUE) {
+        auto dataCounter = getDataGeneratorCounterFromPage(CardTypeTag::CruTag, pageAddress, 0x0); // no header!
+        if (isResyncLogged()) {
+          errors.stream << b::format("resync dataCounter for e:%d l:%d cnt:%x\n") % eventNumber % linkId % dataCounter;
+        }
+        mDataGeneratorCounters[linkId] = dataCounter;
+      }
+      
+      const uint32_t dataCounter = mDataGeneratorCounters[linkId];
 
-      while ((i*4) < payloadBytes) {
-        uint32_t word32 = i; // 32-bit word pointer
+      // Check the 256-bit words, the counter increments by 1 every word
+      const size_t words256 = (pageSize + 31) / 32;
+      bool foundError = checkPattern(DataPattern::makeCruInternal(dataCounter), pageAddress, 0, words256 * 8, errors,
+          eventNumber, linkId, dataCounter, pageSize);
 
-        checkValue(word32 + 0, offset         , payload[word32 + 0]); //32-bit counter
-        checkValue(word32 + 1, offset         , payload[word32 + 1]); //32-bit counter
-        checkValue(word32 + 2, offset & 0xffff, payload[word32 + 2]); //16-lsb truncated counter 
-        checkValue(word32 + 3, 0x0            , payload[word32 + 3]); //32-bit 0-padding word
+      mDataGeneratorCounters[linkId] = dataCounter + words256;
+      return foundError;
+    }
 
-        offset = (offset+1) % (0x100000000); //Increase counter by 1 - mod 0xffffffff + 1
-        i += 4; // 4 = expected sizeof(uint32_t);
+    bool checkErrorsCruDdg(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId,
+        ReadoutErrors& errors)
+    {
+      // Check the RDH memory size and the link's packet counter
+      const auto rdh = Cru::decodeRdh(reinterpret_cast<const char*>(pageAddress));
+      const auto memBytes = rdh.memorySize; // Memory size [RDH, Payload]
+      const uint32_t packetCounter = rdh.packetCounter;
+      const auto lastPacketCounter = errors.integrity.getLastPacketCounter(linkId);
+
+      switch (errors.integrity.checkPacket(reinterpret_cast<const void*>(pageAddress), pageSize)) {
+        case LinkIntegrityMonitor::Status::SizeError:
+          if (errors.add()) {
+            errors.stream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% words out of range\n")
+              % eventNumber % linkId % memBytes % pageSize;
+          }
+          return true;
+        case LinkIntegrityMonitor::Status::CounterGap:
+          if (errors.add()) {
+            errors.stream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% packet_cnt:%5% mpacket_cnt:%6% unexpected packet counter\n")
+              % eventNumber % linkId % memBytes % pageSize % packetCounter % lastPacketCounter;
+          }
+          return true;
+        case LinkIntegrityMonitor::Status::Ok:
+          if (lastPacketCounter == -1 && isResyncLogged()) {
+            errors.stream << b::format("resync packet counter for e:%d l:%d packet_cnt:%x\n") % eventNumber % linkId
+              % packetCounter;
+          }
+          break;
       }
-      mDataGeneratorCounters[linkId] = offset;
+
+      // The generator writes whole 256-bit words, and with a fixed size, the same amount on every page
+      if (mOptions.generatorRandomSize) {
+        if (memBytes % 32 != 0) {
+          if (errors.add()) {
+            errors.stream << b::format("[SIZEERR]\tevent:%1% l:%2% payloadBytes:%3% not a multiple of 256 bits\n")
+              % eventNumber % linkId % memBytes;
+          }
+          return true;
+        }
+      } else {
+        auto& expected = errors.memorySizes.at(linkId);
+        if (expected == 0) {
+          expected = memBytes;
+        } else if (memBytes != expected) {
+          if (errors.add()) {
+            errors.stream << b::format("[SIZEERR]\tevent:%1% l:%2% payloadBytes:%3% expected:%4% size changed\n")
+              % eventNumber % linkId % memBytes % expected;
+          }
+          return true;
+        }
+      }
+
+      // Get counter value only if page is valid...
+      const auto dataCounter = getDataGeneratorCounterFromPage(CardTypeTag::CruTag, pageAddress, Cru::DataFormat::getHeaderSize());
+      if (mDataGeneratorCounters[linkId] == DATA_COUNTER_INITIAL_VALUE) {
+        if (isResyncLogged()) {
+          errors.stream << b::format("resync counter for e:%d l:%d cnt:%x\n") % eventNumber % linkId % dataCounter;
+        }
+        mDataGeneratorCounters[linkId] = dataCounter;
+      }
+      //const uint32_t dataCounter = mDataGeneratorCounters[linkId];
+
+      //skip the header -> address + 0x40
+      const auto payloadAddress = pageAddress + Cru::DataFormat::getHeaderSize();
+      const auto payloadBytes = memBytes - Cru::DataFormat::getHeaderSize();
+
+      // ddg pattern
+      // Every 256-bit word is built as follows:
+      // 32 bits counter       + 32 bits counter       + 16 lsb counter       + 32 bit 0
+      // 32 bits (counter + 1) + 32 bits (counter + 1) + 16 lsb (counter + 1) + 32 bit 0
+      const size_t words128 = (payloadBytes + 15) / 16;
+      bool foundError = checkPattern(DataPattern::makeCruDdg(dataCounter), payloadAddress, 0, words128 * 4, errors,
+          eventNumber, linkId, dataCounter, payloadBytes);
+
+      mDataGeneratorCounters[linkId] = dataCounter + words128;
       return foundError;
     }
 
-    void addError(int64_t eventNumber, int linkId, int index, uint32_t generatorCounter, uint32_t expectedValue,
-        uint32_t actualValue, uint32_t payloadBytes)
+    void addError(ReadoutErrors& errors, int64_t eventNumber, int linkId, int index, uint32_t generatorCounter,
+        uint32_t expectedValue, uint32_t actualValue, uint32_t payloadBytes)
     {
-      mErrorCount++;
-       if (mErrorCount < MAX_RECORDED_ERRORS) {
-         mErrorStream << b::format("[ERROR]\tevent:%d link:%d cnt:%x payloadBytes:%d i:%d exp:%x val:%x\n")
+       if (errors.add()) {
+         errors.stream << b::format("[ERROR]\tevent:%d link:%d cnt:%x payloadBytes:%d i:%d exp:%x val:%x\n")
              % eventNumber % linkId % generatorCounter % payloadBytes % index % expectedValue % actualValue;
        }
     }
 
-    bool checkErrorsCrorc(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId)
+    /// Reports every word in [begin, end) that does not match the pattern
+    /// \return True if there was a mismatch
+    bool checkPattern(const DataPattern& pattern, uintptr_t address, size_t begin, size_t end, ReadoutErrors& errors,
+        int64_t eventNumber, int linkId, uint32_t generatorCounter, uint32_t payloadBytes)
+    {
+      auto data = reinterpret_cast<const void*>(address);
+      auto words = reinterpret_cast<const uint32_t*>(address);
+      bool foundError = false;
+      for (auto i = pattern.findMismatch(data, begin, end); i < end; i = pattern.findMismatch(data, i + 1, end)) {
+        foundError = true;
+        addError(errors, eventNumber, linkId, i, generatorCounter, pattern.getExpected(i), words[i], payloadBytes);
+      }
+      return foundError;
+    }
+
+    bool checkErrorsCrorc(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId,
+        ReadoutErrors& errors)
     {
       uint64_t counter = mDataGeneratorCounters[linkId];
       mDataGeneratorCounters[linkId]++;
 
-      auto check = [&](auto patternFunction) {
-        auto page = reinterpret_cast<const volatile uint32_t*>(pageAddress);
+      auto check = [&](const DataPattern& pattern) {
+        auto page = reinterpret_cast<const uint32_t*>(pageAddress);
         auto pageSize32 = pageSize / sizeof(int32_t);
 
         if (page[0] != counter) {
-          addError(eventNumber, linkId, 0, counter, counter, page[0], 0);
+          addError(errors, eventNumber, linkId, 0, counter, counter, page[0], 0);
         }
 
-        // We skip the SDH
-        for (uint32_t i = 8; i < pageSize32; ++i) {
-          uint32_t expectedValue = patternFunction(i);
-          uint32_t actualValue = page[i];
-          if (actualValue != expectedValue) {
-            addError(eventNumber, linkId, i, counter, expectedValue, actualValue, 0);
-            return true;
-          }
+        // We skip the SDH, and only report the first mismatch
+        auto i = pattern.findMismatch(reinterpret_cast<const void*>(pageAddress), 8, pageSize32);
+        if (i < pageSize32) {
+          addError(errors, eventNumber, linkId, i, counter, pattern.getExpected(i), page[i], 0);
+          return true;
         }
         return false;
       };
 
       switch (mOptions.generatorPattern) {
         case GeneratorPattern::Incremental:
-          return check([&](uint32_t i) {return i - 1;});
+          return check(DataPattern::makeIncremental(-1)); // Word i is i - 1
         case GeneratorPattern::Alternating:
-          return check([&](uint32_t) {return 0xa5a5a5a5;});
+          return check(DataPattern::makeConstant(0xa5a5a5a5));
         case GeneratorPattern::Constant:
-          return check([&](uint32_t) {return 0x12345678;});
+          return check(DataPattern::makeConstant(0x12345678));
         default: ;
       }
 
@@ -806,13 +2135,37 @@ class ProgramDmaBench: public Program
           << ErrorInfo::GeneratorPattern(mOptions.generatorPattern));
     }
 
-    void resetPage(uintptr_t pageAddress, size_t pageSize)
+    /// Poisons the first and the last cache line of every DMA page in the range with BUFFER_DEFAULT_VALUE. The first
+    /// holds the RDH or the C-RORC counter, and the last the end of the data, so a page the card did not write again
+    /// fails the checks, without rewriting the whole page.
+    /// The lines are written with non-temporal stores where possible, since the CPU does not read them before the card
+    /// writes them again.
+    void resetPage(uintptr_t address, size_t size)
     {
-      auto page = reinterpret_cast<volatile uint32_t*>(pageAddress);
-      auto pageSize32 = pageSize / sizeof(uint32_t);
-      for (size_t i = 0; i < pageSize32; i++) {
-        page[i] = BUFFER_DEFAULT_VALUE;
+      constexpr size_t LINE = Utilities::CACHE_LINE_SIZE;
+      auto poison = [](uintptr_t line) {
+#if defined(__SSE2__)
+        const __m128i value = _mm_set1_epi32(int(BUFFER_DEFAULT_VALUE));
+        for (size_t i = 0; i < LINE; i += sizeof(__m128i)) {
+          _mm_stream_si128(reinterpret_cast<__m128i*>(line + i), value);
+        }
+#else
+        std::fill_n(reinterpret_cast<uint32_t*>(line), LINE / sizeof(uint32_t), BUFFER_DEFAULT_VALUE);
+#endif
+      };
+
+      for (uintptr_t page = address; page < address + size; page += mPageSize) {
+        if (mPageSize <= 2 * LINE || (mPageSize % LINE) != 0) {
+          std::fill_n(reinterpret_cast<uint32_t*>(page), mPageSize / sizeof(uint32_t), BUFFER_DEFAULT_VALUE);
+        } else {
+          poison(page);
+          poison(page + mPageSize - LINE);
+        }
       }
+#if defined(__SSE2__)
+      // The non-temporal stores must be visible before the page is given back to the card
+      _mm_sfence();
+#endif
     }
 
     void updateStatusDisplay()
@@ -839,7 +2192,7 @@ class ProgramDmaBench: public Program
        double Gbps = Gb / runTime;
        format % Gbps;
        
-       mOptions.noErrorCheck ? format % "n/a" : format % mErrorCount; // Errors
+       mOptions.noErrorCheck ? format % "n/a" : format % getErrorCount(); // Errors
 
        if (mOptions.noTemperature) {
          format % "n/a";
@@ -900,41 +2253,282 @@ class ProgramDmaBench: public Program
          if (mOptions.noErrorCheck) {
            put("Errors", "n/a");
          } else {
-           put("Errors", mErrorCount);
+           put("Errors", getErrorCount());
+         }
+         // The rates above count whole DMA pages, these only the data in them
+         if (isPayloadCounted()) {
+           double payloadBytes = getPayloadBytes();
+           put("Payload bytes", payloadBytes);
+           put("Payload Gb/s", payloadBytes * 8 / (1000 * 1000 * 1000) / runTime);
+           put("Page fill", (b::format("%.1f%%") % (100.0 * payloadBytes / bytes)).str());
          }
+         if (mOptions.timeFrameLength != 0) {
+           uint64_t timeFrames = 0;
+           uint64_t straddling = 0;
+           for (const auto& errors : mReadoutErrors) {
+             timeFrames += errors->timeFrames.load(std::memory_order_relaxed);
+             straddling += errors->straddlingSuperpages.load(std::memory_order_relaxed);
+           }
+           put("Time frames", timeFrames);
+           put("Straddling superpages", straddling);
+         }
+       }
+
+       if (mOptions.countAllocations && mPushAllocationSuperpages > 0) {
+         put("Allocations per superpage", double(mPushAllocations) / mPushAllocationSuperpages);
        }
 
-       if (mOptions.barHammer) {
-         size_t writeSize = sizeof(uint32_t);
-         double hammerCount = mBarHammer->getCount();
-         double bytes = hammerCount * writeSize;
+       if (!mBarHammers.empty()) {
+         size_t accessSize = mBarHammers.front()->getAccessSize();
+         double hammerCount = 0;
+         for (const auto& hammer : mBarHammers) {
+           hammerCount += hammer->getCount();
+         }
+         double bytes = hammerCount * accessSize;
          double MB = bytes / (1000 * 1000);
          double MBs = MB / runTime;
-         put("BAR writes", hammerCount);
-         put("BAR write size (bytes)", writeSize);
+         put("BAR accesses", hammerCount);
+         put("BAR access size (bytes)", accessSize);
          put("BAR MB", MB);
          put("BAR MB/s", MBs);
        }
 
+       auto statistics = mChannel->getStatistics();
+       for (const auto& link : statistics.links) {
+         put((b::format("Link %d") % link.linkId).str(), (b::format("%d superpages, %d bytes") % link.superpages
+             % link.bytes).str());
+       }
+       put("Transfer queue high-water", statistics.transferQueueHighWater);
+       put("Ready queue high-water", statistics.readyQueueHighWater);
+       put("Empty fills", statistics.emptyFills);
+       put("Ready queue full", statistics.readyQueueFull);
+       put("Superpages left on card", statistics.superpagesLeftOnCard);
+       put("Superpages dropped", statistics.superpagesDropped);
+       put("Card queue low-water", mCardQueueLowWater == std::numeric_limits<size_t>::max() ? std::string("n/a")
+           : std::to_string(mCardQueueLowWater));
+       put("Card queue ran empty", mCardQueueEmpty);
+       put("Buffer high-water", (b::format("%d superpages (%.1f%%)") % mBufferHighWater
+           % (100.0 * mBufferHighWater / std::max<size_t>(1, mMaxSuperpages))).str());
+       if (mOptions.consumerModel != "none") {
+         put("Consumer delay (s)", double(mConsumerDelay.load()) / 1e9);
+       }
+
+       if (mCacheAllocation) {
+         auto monitoring = mCacheAllocation->getMonitoring();
+         auto optionalPut = [&](auto label, const b::optional<uint64_t>& value) {
+           put(label, value ? std::to_string(*value) : std::string("n/a"));
+         };
+         optionalPut("LLC occupancy (bytes)", monitoring.llcOccupancy);
+         optionalPut("Memory traffic (bytes)", monitoring.totalBytes);
+         optionalPut("Local memory traffic (bytes)", monitoring.localBytes);
+       }
+
+       if (mOptions.perfCounters) {
+         outputPerfCounters(GB, double(mReadoutCount.load()) / mPagesPerSuperpage);
+       }
+
+       outputLatencies();
+       outputBarHammers();
+
+       // Only available when built with ALICEO2_READOUTCARD_BAR_STATISTICS
+       auto barStatistics = mChannel->getBarStatistics();
+       if (!barStatistics.empty()) {
+         std::sort(barStatistics.begin(), barStatistics.end(), [](const auto& a, const auto& b) {
+           return (a.reads + a.writes) > (b.reads + b.writes);
+         });
+         auto format = b::format("  %-4s  %-10s  %-12s  %-12s  %-14s\n");
+         cout << '\n' << format % "BAR" % "Address" % "Reads/s" % "Writes/s" % "Cycles/access";
+         for (const auto& reg : barStatistics) {
+           cout << format % reg.barIndex % (b::format("0x%x") % reg.address)
+               % uint64_t(reg.reads / runTime) % uint64_t(reg.writes / runTime)
+               % (reg.cycles / std::max<uint64_t>(1, reg.reads + reg.writes));
+         }
+       }
+
        cout << '\n';
      }
 
+     /// Outputs the PMU events of the threads in total, per GB read out and per superpage read out
+     void outputPerfCounters(double GB, double superpages)
+     {
+       const char* roles[] = {"Push", "Readout", "Low priority"};
+       auto format = b::format("  %-12s  %-16s  %-16s  %-14s  %-14s\n");
+       auto ratio = [](uint64_t value, double amount) {
+         return amount > 0 ? (b::format("%.2f") % (double(value) / amount)).str() : std::string("n/a");
+       };
+       cout << '\n' << format % "Thread" % "Event" % "Total" % "Per GB" % "Per superpage";
+       for (size_t i = 0; i < mPerfCounts.size(); ++i) {
+         auto put = [&](const char* event, const b::optional<uint64_t>& value) {
+           if (value) {
+             cout << format % roles[i] % event % *value % ratio(*value, GB) % ratio(*value, superpages);
+           } else {
+             cout << format % roles[i] % event % "n/a" % "n/a" % "n/a";
+           }
+         };
+         put("Cycles", mPerfCounts[i].cycles);
+         put("Instructions", mPerfCounts[i].instructions);
+         put("LLC misses", mPerfCounts[i].llcMisses);
+         put("Context switches", mPerfCounts[i].contextSwitches);
+       }
+       if (mPerfUserOnly) {
+         cout << "  The kernel only allowed counting user space\n";
+       }
+     }
+
+     /// Makes a sample of the counters for the machine-readable output
+     /// \param readoutQueue Amount of superpages waiting for readout
+     /// \param freeQueue Amount of free superpages
+     BenchmarkOutput::Sample makeSample(TimePoint now, size_t readoutQueue, size_t freeQueue)
+     {
+       BenchmarkOutput::Sample sample;
+       sample.seconds = std::chrono::duration<double>(now - mRunTime.start).count();
+       sample.pushed = mPushCount.load(std::memory_order_relaxed) / mPagesPerSuperpage;
+       sample.read = mReadoutCount.load(std::memory_order_relaxed) / mPagesPerSuperpage;
+       sample.bytes = mReadoutCount.load(std::memory_order_relaxed) * mPageSize;
+       if (isPayloadCounted()) {
+         sample.payloadBytes = getPayloadBytes();
+       }
+       sample.links = mChannel->getStatistics().links;
+       if (!mOptions.noErrorCheck) {
+         sample.errors = getErrorCount();
+       }
+       if (!mOptions.noTemperature) {
+         sample.temperature = mChannel->getTemperature();
+       }
+       // The counters are loaded separately, so popped may be seen ahead of pushed
+       auto popped = mSuperpagesPopped.load(std::memory_order_relaxed);
+       auto pushed = mSuperpagesPushed.load(std::memory_order_relaxed);
+       sample.driverQueue = pushed > popped ? pushed - popped : 0;
+       sample.readoutQueue = readoutQueue;
+       sample.freeQueue = freeQueue;
+       return sample;
+     }
+
+     /// Gets the configuration for the machine-readable output: the program options as given or defaulted, and what
+     /// was resolved from them and the card
+     BenchmarkOutput::Configuration getConfiguration(const po::variables_map& map)
+     {
+       BenchmarkOutput::Configuration configuration;
+       for (const auto& option : map) {
+         const auto& value = option.second.value();
+         std::string string;
+         if (auto v = b::any_cast<std::string>(&value)) {
+           string = *v;
+         } else if (auto v = b::any_cast<bool>(&value)) {
+           string = *v ? "true" : "false";
+         } else if (auto v = b::any_cast<int>(&value)) {
+           string = std::to_string(*v);
+         } else if (auto v = b::any_cast<uint64_t>(&value)) {
+           string = std::to_string(*v);
+         } else if (auto v = b::any_cast<int64_t>(&value)) {
+           string = std::to_string(*v);
+         } else if (auto v = b::any_cast<uint32_t>(&value)) {
+           string = std::to_string(*v);
+         } else if (auto v = b::any_cast<double>(&value)) {
+           string = std::to_string(*v);
+         } else if (auto v = b::any_cast<std::vector<std::string>>(&value)) {
+           string = b::algorithm::join(*v, ",");
+         } else {
+           continue;
+         }
+         configuration.emplace_back(option.first, string);
+       }
+
+       configuration.emplace_back("card-type", CardType::toString(mCardType));
+       configuration.emplace_back("card-pci-address", mChannel->getPciAddress().toString());
+       configuration.emplace_back("card-numa-node", std::to_string(mChannel->getNumaNode()));
+       configuration.emplace_back("card-serial", mChannel->getSerial() ? std::to_string(*mChannel->getSerial()) : "");
+       configuration.emplace_back("card-id", mChannel->getCardId().value_or(""));
+       configuration.emplace_back("firmware", mChannel->getFirmwareInfo().value_or(""));
+       configuration.emplace_back("resolved-buffer-size", std::to_string(mBufferSize));
+       configuration.emplace_back("resolved-superpage-size", std::to_string(mSuperpageSize));
+       configuration.emplace_back("resolved-dma-page-size", std::to_string(mPageSize));
+       configuration.emplace_back("iommu", AliceO2::Common::Iommu::isEnabled() ? "true" : "false");
+       configuration.emplace_back("data-pattern-implementation", DataPattern::getImplementation());
+       return configuration;
+     }
+
+     /// Prints the percentiles of the latency histograms in microseconds. The timestamp counter ticks are converted
+     /// with the tick rate measured over the run.
+     void outputLatencies()
+     {
+       double runTime = std::chrono::duration<double>(mRunTime.end - mRunTime.start).count();
+       double ticks = double(mRunTime.endTicks - mRunTime.startTicks);
+       if (runTime <= 0 || ticks <= 0) {
+         return;
+       }
+       double ticksPerMicrosecond = ticks / (runTime * 1e6);
+
+       auto format = b::format("  %-20s  %-4s  %-10s  %-10.1f  %-10.1f  %-10.1f  %-10.1f\n");
+       auto put = [&](const std::string& label, const std::string& link, const LatencyHistogram& histogram,
+           double perMicrosecond) {
+         if (histogram.getCount() == 0) {
+           return;
+         }
+         auto us = [&](uint64_t value) { return double(value) / perMicrosecond; };
+         cout << format % label % link % histogram.getCount() % us(histogram.getPercentile(50))
+             % us(histogram.getPercentile(99)) % us(histogram.getPercentile(99.9)) % us(histogram.getMax());
+       };
+
+       // Each readout thread has its own histograms
+       LinkLatencies readoutLatencies;
+       for (const auto& latencies : mReadoutLatencies) {
+         for (const auto& link : *latencies) {
+           readoutLatencies[link.first].merge(link.second);
+         }
+       }
+       LinkLatencies orbitLatencies;
+       for (const auto& errors : mReadoutErrors) {
+         for (const auto& link : errors->orbitLatencies) {
+           orbitLatencies[link.first].merge(link.second);
+         }
+       }
+
+       cout << '\n' << b::format("  %-20s  %-4s  %-10s  %-10s  %-10s  %-10s  %-10s\n") % "Latency (us)" % "Link"
+           % "Count" % "p50" % "p99" % "p99.9" % "Max";
+       for (const auto& link : mArrivalLatencies) {
+         put("Push to arrival", std::to_string(link.first), link.second, ticksPerMicrosecond);
+       }
+       for (const auto& link : readoutLatencies) {
+         put("Arrival to readout", std::to_string(link.first), link.second, ticksPerMicrosecond);
+       }
+       // Recorded in nanoseconds of the host clock
+       for (const auto& link : orbitLatencies) {
+         put("Orbit to readout", std::to_string(link.first), link.second, 1000.0);
+       }
+       put("fillSuperpages()", "-", mFillLatency, ticksPerMicrosecond);
+     }
+
     void outputErrors()
     {
-      auto errorStr = mErrorStream.str();
+      std::string errorStr;
+      int64_t recorded = 0;
+      for (const auto& errors : mReadoutErrors) {
+        errorStr += errors->stream.str();
+        recorded += std::min(errors->count.load(), MAX_RECORDED_ERRORS);
+      }
 
       if (!errorStr.empty()) {
-        getLogger() << "Outputting " << std::min(mErrorCount, MAX_RECORDED_ERRORS) << " errors to '"
-          << READOUT_ERRORS_PATH << "'" << endm;
+        getLogger() << "Outputting " << recorded << " errors to '" << READOUT_ERRORS_PATH << "'" << endm;
         std::ofstream stream(READOUT_ERRORS_PATH);
         stream << errorStr;
       }
+
+      // The packet counter and RDH size checks of the links, for the links that had errors
+      for (const auto& errors : mReadoutErrors) {
+        for (const auto& link : errors->integrity.getStatistics()) {
+          if (link.counterGaps != 0 || link.sizeErrors != 0) {
+            getLogger() << "Link " << link.linkId << ": " << link.counterGaps << " packet counter gaps, "
+                << link.dropped << " packets dropped, " << link.sizeErrors << " RDH size errors" << endm;
+          }
+        }
+      }
     }
 
-    /// Prints the page to a file in ASCII or binary format if such output is enabled
+    /// Prints the page to a file in ASCII format if such output is enabled. Binary output goes through the recorder.
     void printToFile(uintptr_t pageAddress, size_t pageSize, int64_t pageNumber)
     {
-      auto page = reinterpret_cast<const volatile uint32_t*>(pageAddress);
+      auto page = reinterpret_cast<const uint32_t*>(pageAddress);
       auto pageSize32 = pageSize / sizeof(uint32_t);
 
       if (mOptions.fileOutputAscii) {
@@ -948,9 +2542,6 @@ class ProgramDmaBench: public Program
           mReadoutStream << '\n';
         }
         mReadoutStream << '\n';
-      } else if (mOptions.fileOutputBin) {
-        // TODO Is there a more elegant way to write from volatile memory?
-        mReadoutStream.write(reinterpret_cast<const char*>(pageAddress), pageSize);
       }
     }
 
@@ -989,28 +2580,6 @@ class ProgramDmaBench: public Program
       return limit;
     }
 
-    struct RandomPauses
-    {
-        static constexpr int NEXT_PAUSE_MIN = 10; ///< Minimum random pause interval in milliseconds
-        static constexpr int NEXT_PAUSE_MAX = 2000; ///< Maximum random pause interval in milliseconds
-        static constexpr int PAUSE_LENGTH_MIN = 1; ///< Minimum random pause in milliseconds
-        static constexpr int PAUSE_LENGTH_MAX = 500; ///< Maximum random pause in milliseconds
-        TimePoint next; ///< Next pause at this time
-        std::chrono::milliseconds length; ///< Next pause has this length
-
-        void pauseIfNeeded()
-        {
-          auto now = std::chrono::steady_clock::now();
-          if (now >= next) {
-            std::this_thread::sleep_for(length);
-            // Schedule next pause
-            auto now = std::chrono::steady_clock::now();
-            next = now + std::chrono::milliseconds(Utilities::getRandRange(NEXT_PAUSE_MIN, NEXT_PAUSE_MAX));
-            length = std::chrono::milliseconds(Utilities::getRandRange(PAUSE_LENGTH_MIN, PAUSE_LENGTH_MAX));
-          }
-        }
-    };
-
     /// Program options
     struct OptionsStruct {
         uint64_t maxBytes = 0; ///< Limit of bytes to push
@@ -1019,25 +2588,79 @@ class ProgramDmaBench: public Program
         bool fileOutputBin = false;
         bool resetChannel = false;
         bool randomPause = false;
+        std::string consumerModel;
         bool noErrorCheck = false;
         bool noTemperature = false;
         bool noDisplay = false;
         bool pageReset = false;
         bool noResyncCounter = false;
         bool barHammer = false;
+        std::string barHammerAddress;
+        uint64_t barHammerBaseline = 1000;
+        std::string barHammerCpus;
+        std::string barHammerModeString;
+        int barHammerThreads = 1;
+        int barHammerWidth = 32;
         bool noRemovePagesFile = false;
+        bool numaBind = false;
+        bool prefaultBuffer = false;
+        std::string cacheAllocation;
+        std::string copyEngine;
+        bool perfCounters = false;
+        bool countAllocations = false;
+        size_t prefetchDistance = 0;
+        bool lockBuffer = false;
+        bool bufferDump = false;
+        bool asyncLogging = false;
+        bool prepareDma = false;
+        bool publishStatistics = false;
+        bool driverThread = false;
+        int driverThreadCpu = -1;
+        int readoutThreads = 1;
+        size_t checkCopies = 0;
+        size_t errorCheckSample = 1;
+        std::string pushCpus;
+        std::string readoutCpus;
+        bool numaPin = false;
+        std::string outputJsonPath;
+        std::string outputCsvPath;
+        uint64_t outputInterval = 1000;
+        size_t fileQueueDepth = 8;
+        std::string fileCompression;
+        int fileCompressionLevel = 1;
+        size_t fileCompressionThreads = 4;
+        uint16_t tapPort = 0;
+        uint64_t tapEvery = 100;
+        std::string tapLinks;
+        bool interrupt = false;
+        bool writeCombining = false;
+        bool firmwareCapabilities = false;
+        bool registerShadowing = false;
         std::string generatorPatternString;
         std::string readoutModeString;
+        std::string linkSchedulingString;
+        std::string readyQueueOverflowString;
         std::string fileOutputPathBin;
         std::string fileOutputPathAscii;
+        std::string replayFile;
+        size_t replayRate = 0;
+        size_t dummyLinkBandwidth = 0;
         GeneratorPattern::type generatorPattern = GeneratorPattern::Incremental;
         b::optional<ReadoutMode::type> readoutMode;
         std::string links;
         bool generatorEnabled = false;
         size_t dataGeneratorSize;
+        bool generatorRandomSize = false;
+        bool packed = false;
+        std::string sizeProfile;
         size_t dmaPageSize;
         std::string loopbackModeString;
         std::string timeLimitString;
+        std::string timeFrameIndexPath;
+        std::string traceFilePath;
+        std::string clockRegister;
+        double clockFrequency = LHC_ORBIT_FREQUENCY;
+        uint32_t timeFrameLength = 0;
         uint64_t pausePush;
         uint64_t pauseRead;
     } mOptions;
@@ -1048,11 +2671,18 @@ class ProgramDmaBench: public Program
     /// The type of the card we're using
     CardType::type mCardType;
 
+    /// Card type whose data format the readout checks
+    CardType::type mDataFormat;
+
+    /// Loopback mode of the data generator, which tells the CRU error check what pattern to expect
+    LoopbackMode::type mLoopbackMode = LoopbackMode::None;
+
     /// Page counters per link. Indexed by link ID.
     std::array<std::atomic<uint32_t>, MAX_LINKS> mDataGeneratorCounters;
 
-    // Packet counter per link
-    std::array<std::atomic<uint32_t>, MAX_LINKS> mPacketCounters;
+    /// Superpages per link that were not checked since the link's last checked one, with --errorcheck-sample.
+    /// Indexed by link ID.
+    std::array<uint64_t, MAX_LINKS> mSampleSkipped {};
 
     // Keep these as DMA page counters for better granularity
     /// Amount of DMA pages pushed
@@ -1061,8 +2691,40 @@ class ProgramDmaBench: public Program
     // Amount of DMA pages read out
     std::atomic<uint64_t> mReadoutCount { 0 };
 
-    /// Total amount of errors encountered
-    int64_t mErrorCount = 0;
+    /// Errors encountered, one record per readout thread
+    std::vector<std::unique_ptr<ReadoutErrors>> mReadoutErrors;
+
+    /// Time superpages waited for their readout since they arrived, one set of histograms per readout thread
+    std::vector<std::unique_ptr<LinkLatencies>> mReadoutLatencies;
+
+    /// Time superpages took to arrive since they were pushed. Push thread only.
+    LinkLatencies mArrivalLatencies;
+
+    /// Duration of the fillSuperpages() calls. Push thread only.
+    LatencyHistogram mFillLatency;
+
+    /// Heap allocations of the push thread in the steady state, and the superpages popped meanwhile, with
+    /// --count-allocations. Written by the push thread when it ends.
+    uint64_t mPushAllocations = 0;
+    uint64_t mPushAllocationSuperpages = 0;
+
+    /// CPUs the push thread is pinned to, empty if it isn't
+    std::vector<int> mPushCpus;
+
+    /// CPUs the readout threads are pinned to, empty if they aren't
+    std::vector<int> mReadoutCpus;
+
+    /// CPUs the low priority thread is pinned to, empty if it isn't
+    std::vector<int> mLowPriorityCpus;
+
+    /// Amount of superpages given to the driver. Push thread only.
+    std::atomic<uint64_t> mSuperpagesPushed { 0 };
+
+    /// Amount of superpages popped from the driver. Push thread only.
+    std::atomic<uint64_t> mSuperpagesPopped { 0 };
+
+    /// Writers of the --output-json and --output-csv files
+    std::vector<std::unique_ptr<BenchmarkOutput>> mResultOutputs;
 
     /// Keep on pushing until we're explicitly stopped
     bool mInfinitePages = false;
@@ -1092,13 +2754,59 @@ class ProgramDmaBench: public Program
     std::unique_ptr<MemoryMappedFile> mMemoryMappedFile;
 
     /// Object for BAR throughput testing
-    std::unique_ptr<BarHammer> mBarHammer;
+    /// BAR hammer threads running during the DMA
+    std::vector<std::unique_ptr<BarHammer>> mBarHammers;
+
+    /// BAR hammer threads of the baseline before the DMA
+    std::vector<std::unique_ptr<BarHammer>> mBarHammersIdle;
 
-    /// Stream for file readout, only opened if enabled by the --file program options
+    /// Stream for file readout, only opened if enabled by the --to-file-ascii program option
     std::ofstream mReadoutStream;
 
-    /// Stream for error output
-    std::ostringstream mErrorStream;
+    /// Stream for the time frame index, only opened if enabled by the --time-frame-index program option
+    std::ofstream mTimeFrameIndexStream;
+
+    /// Guards mTimeFrameIndexStream, which all readout threads write to
+    std::mutex mTimeFrameIndexMutex;
+
+    /// Group of the readout and driver threads, only created if enabled by the --cache-allocation program option
+    std::unique_ptr<CacheAllocation> mCacheAllocation;
+
+    /// PMU events of the threads of every PerfRole, with --perf-counters
+    std::array<PerfCounters::Counts, 3> mPerfCounts;
+
+    /// Set if the PMU events were only counted in user space
+    bool mPerfUserOnly = false;
+
+    /// Guards mPerfCounts and mPerfUserOnly
+    std::mutex mPerfMutex;
+
+    /// Total time the readout threads were delayed by the --consumer-model, in nanoseconds
+    std::atomic<uint64_t> mConsumerDelay { 0 };
+
+    /// Lowest amount of superpages queued for the card since the first arrival. Push thread only.
+    size_t mCardQueueLowWater = std::numeric_limits<size_t>::max();
+
+    /// Amount of times the card's queue ran empty. Push thread only.
+    uint64_t mCardQueueEmpty = 0;
+
+    /// Whether the card's queue was empty at the last check. Push thread only.
+    bool mCardQueueWasEmpty = false;
+
+    /// Highest amount of superpages that waited for the readout or were read out at once. Push thread only.
+    size_t mBufferHighWater = 0;
+
+    /// Recorder for file readout, only created if enabled by the --to-file-bin program option
+    std::unique_ptr<SuperpageRecorder> mRecorder;
+
+    /// Correlation of the card's orbit counter with the host clock, only created with the --clock-register option
+    std::unique_ptr<ClockCorrelator> mClockCorrelator;
+
+    /// Tap streaming a sample of the superpages, only created if enabled by the --tap-port program option
+    std::unique_ptr<SuperpageTap> mTap;
+
+    /// Superpages that were recorded
+    std::vector<Superpage> mRecorderCompleted;
 
     /// Was the header printed?
     bool mHeaderPrinted = false;
@@ -1113,6 +2821,8 @@ class ProgramDmaBench: public Program
     {
         TimePoint start; ///< Start of run time
         TimePoint end; ///< End of run time
+        uint64_t startTicks = 0; ///< Timestamp counter at the start of run time
+        uint64_t endTicks = 0; ///< Timestamp counter at the end of run time
     } mRunTime;
 };
 
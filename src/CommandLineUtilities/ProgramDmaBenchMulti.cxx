@@ -0,0 +1,481 @@
+/// \file ProgramDmaBenchMulti.cxx
+/// \brief Utility that benchmarks the aggregate DMA throughput of several cards and endpoints at once
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast/try_lexical_convert.hpp>
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "Common/SuffixOption.h"
+#include "ExceptionInternal.h"
+#include "InfoLogger/InfoLogger.hxx"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "ReadoutCard/Parameters.h"
+#include "ReadoutCard/SuperpageRing.h"
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+# include "RocPciDevice.h"
+#endif
+#include "Utilities/Affinity.h"
+#include "Utilities/Hugetlbfs.h"
+#include "Utilities/Numa.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+using AliceO2::Common::SuffixOption;
+using std::cout;
+namespace b = boost;
+namespace po = boost::program_options;
+
+namespace {
+/// End InfoLogger message alias
+constexpr auto endm = InfoLogger::endm;
+/// Interval between status display updates
+constexpr auto DISPLAY_INTERVAL = std::chrono::seconds(1);
+
+/// One DMA channel of the benchmark, with its buffer, rings and threads
+struct BenchChannel
+{
+    /// Card ID as given on the command line
+    std::string cardIdString;
+    int dmaChannel = 0;
+    /// NUMA node of the card, if known
+    b::optional<int> numaNode;
+    /// Key of the physical card. The endpoints of a CRU appear as separate PCI devices with the same serial.
+    std::string card;
+    /// CPUs the push and readout threads are pinned to, if any
+    b::optional<int> pushCpu;
+    b::optional<int> readoutCpu;
+
+    std::unique_ptr<MemoryMappedFile> buffer;
+    std::shared_ptr<DmaChannelInterface> channel;
+    /// Superpages that arrived, from the push thread to the readout thread
+    std::unique_ptr<SuperpageRing> readoutRing;
+    /// Superpages that were read out, from the readout thread back to the push thread
+    std::unique_ptr<SuperpageRing> freeRing;
+
+    std::future<void> pushFuture;
+    std::future<void> readoutFuture;
+
+    /// Amount of superpages and bytes read out. Only the readout thread writes them.
+    std::atomic<uint64_t> superpages { 0 };
+    std::atomic<uint64_t> bytes { 0 };
+};
+
+double toGbps(uint64_t bytes, double seconds)
+{
+  return seconds > 0 ? (double(bytes) * 8 / (1000.0 * 1000.0 * 1000.0)) / seconds : 0;
+}
+
+/// Pins the calling thread to a CPU, if one was assigned
+void pinThread(const b::optional<int>& cpu)
+{
+  if (cpu) {
+    Utilities::setThreadAffinity(std::vector<int>{*cpu});
+  }
+}
+} // Anonymous namespace
+
+/// Drives several DMA channels at once, on one or more cards, to measure how the aggregate throughput of a host scales.
+/// Every channel gets a buffer on its card's NUMA node, and a push and a readout thread pinned to distinct CPUs local
+/// to the card. All channels are started before the threads begin, so they run for the same period.
+/// Unlike roc-bench-dma, the data is not checked: the readout only counts the superpages and gives them back.
+class ProgramDmaBenchMulti: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {
+        "DMA Benchmark (multiple channels)",
+        "Test the aggregate DMA throughput of several cards and endpoints at once\n"
+          "Each channel gets a NUMA-local buffer and pinned push and readout threads. The throughput is reported per "
+          "channel, per card, per NUMA node and in total. The data is not checked, use roc-bench-dma for that.",
+        "roc-bench-dma-multi --ids=42:0.0,43:0.0,3b:0.0/0 --time=60"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      options.add_options()
+          ("buffer-size",
+              SuffixOption<size_t>::make(&mOptions.bufferSize)->default_value("1Gi"),
+              "Buffer size in bytes of each channel")
+          ("generator",
+              po::value<bool>(&mOptions.generatorEnabled)->default_value(true),
+              "Enable data generator")
+          ("ids",
+              po::value<std::string>(&mOptions.ids)->required(),
+              "Comma separated list of card IDs (PCI address or serial number), each optionally followed by "
+              "'/[DMA channel]', e.g. '42:0.0,43:0.0/0'")
+          ("links",
+              po::value<std::string>(&mOptions.links)->default_value("0"),
+              "Links to open on every channel. A comma separated list of integers or ranges, e.g. '0,2,5-10'")
+          ("loopback",
+              po::value<std::string>(&mOptions.loopbackModeString)->default_value("INTERNAL"),
+              "Generator loopback mode [NONE, INTERNAL, DIU, SIU]")
+          ("no-display",
+              po::bool_switch(&mOptions.noDisplay),
+              "Disable the periodic throughput display")
+          ("no-pin",
+              po::bool_switch(&mOptions.noPin),
+              "Do not pin the push and readout threads to CPUs")
+          ("page-size",
+              SuffixOption<size_t>::make(&mOptions.dmaPageSize)->default_value("8Ki"),
+              "Card DMA page size")
+          ("superpage-size",
+              SuffixOption<size_t>::make(&mOptions.superpageSize)->default_value("1Mi"),
+              "Superpage size in bytes")
+          ("time",
+              po::value<uint64_t>(&mOptions.seconds)->default_value(10),
+              "Duration of the benchmark in seconds");
+    }
+
+    virtual void run(const po::variables_map&)
+    {
+      if (mOptions.superpageSize == 0 || mOptions.bufferSize < mOptions.superpageSize) {
+        throw ParameterException() << ErrorInfo::Message("Buffer size smaller than superpage size");
+      }
+
+      for (const auto& entry : parseIds(mOptions.ids)) {
+        mChannels.push_back(openChannel(entry.first, entry.second));
+      }
+      if (!mOptions.noPin) {
+        assignCpus();
+      }
+      for (const auto& bench : mChannels) {
+        getLogger() << (b::format("Channel %s/%d: card %s, NUMA node %s, push CPU %s, readout CPU %s")
+            % bench->cardIdString % bench->dmaChannel % bench->card % optionalToString(bench->numaNode)
+            % optionalToString(bench->pushCpu) % optionalToString(bench->readoutCpu)).str() << endm;
+      }
+
+      // Start all channels first, so their threads begin together
+      for (auto& bench : mChannels) {
+        bench->channel->startDma();
+      }
+      for (auto& bench : mChannels) {
+        startThreads(*bench);
+      }
+      mStart = std::chrono::steady_clock::now();
+      mGo = true;
+      getLogger() << "Started " << mChannels.size() << " channels" << endm;
+
+      monitor();
+      mStop = true;
+      mEnd = std::chrono::steady_clock::now();
+
+      // Collect all threads before throwing an error of one of them
+      std::exception_ptr error;
+      for (auto& bench : mChannels) {
+        for (auto future : {&bench->pushFuture, &bench->readoutFuture}) {
+          try {
+            future->get();
+          } catch (...) {
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
+        }
+      }
+      for (auto& bench : mChannels) {
+        bench->channel->stopDma();
+      }
+      if (error) {
+        std::rethrow_exception(error);
+      }
+
+      outputStats();
+    }
+
+  private:
+    /// Parses the list of card IDs, with their optional DMA channel
+    static std::vector<std::pair<std::string, int>> parseIds(const std::string& string)
+    {
+      std::vector<std::string> items;
+      b::split(items, string, [](char c) { return c == ','; });
+      std::vector<std::pair<std::string, int>> ids;
+      for (auto item : items) {
+        b::trim(item);
+        if (item.empty()) {
+          continue;
+        }
+        int dmaChannel = 0;
+        auto slash = item.find('/');
+        if (slash != std::string::npos) {
+          if (!b::conversion::try_lexical_convert(item.substr(slash + 1), dmaChannel)) {
+            throw ParameterException() << ErrorInfo::Message("Invalid DMA channel in card ID list: " + item);
+          }
+          item = item.substr(0, slash);
+        }
+        ids.emplace_back(item, dmaChannel);
+      }
+      if (ids.empty()) {
+        throw ParameterException() << ErrorInfo::Message("No card IDs given");
+      }
+      return ids;
+    }
+
+    /// Maps a NUMA-local buffer for the channel and opens it
+    std::unique_ptr<BenchChannel> openChannel(const std::string& cardIdString, int dmaChannel)
+    {
+      auto bench = std::make_unique<BenchChannel>();
+      bench->cardIdString = cardIdString;
+      bench->dmaChannel = dmaChannel;
+      auto cardId = Parameters::cardIdFromString(cardIdString);
+
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+      auto cardSerial = b::get<int>(&cardId);
+      if (!(cardSerial && *cardSerial == ChannelFactory::getDummySerialNumber())) {
+        auto numaNode = RocPciDevice(cardId).getCardDescriptor().numaNode;
+        if (numaNode >= 0) {
+          bench->numaNode = numaNode;
+        }
+      }
+#endif
+
+      auto bufferName = (b::format("roc-bench-dma-multi_id=%s_chan=%d_%d_pages") % cardIdString % dmaChannel
+          % time(0)).str();
+      bench->buffer = Utilities::tryMapFile(mOptions.bufferSize, bufferName, true, nullptr, bench->numaNode);
+
+      auto params = Parameters::makeParameters(cardId, dmaChannel)
+          .setDmaPageSize(mOptions.dmaPageSize)
+          .setGeneratorEnabled(mOptions.generatorEnabled)
+          .setGeneratorDataSize(mOptions.dmaPageSize)
+          .setGeneratorLoopback(LoopbackMode::fromString(mOptions.loopbackModeString))
+          .setLinkMask(Parameters::linkMaskFromString(mOptions.links))
+          .setBufferParameters(buffer_parameters::Memory{bench->buffer->getAddress(), bench->buffer->getSize()});
+      bench->channel = ChannelFactory().getDmaChannel(params);
+
+      // The endpoints of a card share its serial, other cards are told apart by their address
+      auto serial = bench->channel->getSerial();
+      bench->card = serial ? std::to_string(*serial) : bench->channel->getPciAddress().toString();
+
+      auto superpages = bench->buffer->getSize() / mOptions.superpageSize;
+      bench->readoutRing = std::make_unique<SuperpageRing>(superpages);
+      bench->freeRing = std::make_unique<SuperpageRing>(superpages);
+      for (size_t i = 0; i < superpages; ++i) {
+        bench->freeRing->write(Superpage(i * mOptions.superpageSize, mOptions.superpageSize));
+      }
+      return bench;
+    }
+
+    /// Gives every channel two CPUs local to its card, so no two threads share a CPU until a node runs out of them
+    void assignCpus()
+    {
+      std::map<std::string, size_t> nextCpu; // Index into each distinct CPU list
+      for (auto& bench : mChannels) {
+        std::vector<int> cpus;
+        try {
+          cpus = Utilities::getLocalCpus(bench->channel->getPciAddress());
+        } catch (const Exception&) {
+          getLogger() << InfoLogger::Warning << "Could not get local CPUs of " << bench->cardIdString
+              << ", not pinning its threads" << endm;
+          continue;
+        }
+        std::string key;
+        for (auto cpu : cpus) {
+          key += std::to_string(cpu) + ",";
+        }
+        auto& next = nextCpu[key];
+        if ((next + 2) > cpus.size()) {
+          getLogger() << InfoLogger::Warning << "Not enough local CPUs for " << bench->cardIdString
+              << ", threads will share CPUs" << endm;
+        }
+        bench->pushCpu = cpus[next++ % cpus.size()];
+        bench->readoutCpu = cpus[next++ % cpus.size()];
+      }
+    }
+
+    void startThreads(BenchChannel& bench)
+    {
+      const size_t superpages = bench.buffer->getSize() / mOptions.superpageSize;
+
+      // Gives free superpages to the card and passes the arrived ones to the readout thread
+      bench.pushFuture = std::async(std::launch::async, [&, superpages]{
+        try {
+          pinThread(bench.pushCpu);
+          waitForGo();
+          std::vector<Superpage> buffer(superpages);
+          auto& channel = *bench.channel;
+          while (!mStop.load(std::memory_order_relaxed)) {
+            channel.fillSuperpages();
+            size_t pushed = 0;
+            if (auto available = channel.getTransferQueueAvailable()) {
+              pushed = bench.freeRing->read(buffer.data(), std::min(size_t(available), buffer.size()));
+              if (pushed > 0) {
+                channel.pushSuperpages(buffer.data(), pushed);
+              }
+            }
+            auto popped = channel.popSuperpages(buffer.data(), buffer.size());
+            if (bench.readoutRing->write(buffer.data(), popped) != popped) {
+              BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Readout ring full"));
+            }
+            if (pushed == 0 && popped == 0) {
+              channel.waitForReadySuperpage(std::chrono::microseconds(100));
+            }
+          }
+        } catch (...) {
+          mStop = true;
+          throw;
+        }
+      });
+
+      // Counts the arrived superpages and gives them back
+      bench.readoutFuture = std::async(std::launch::async, [&, superpages]{
+        try {
+          pinThread(bench.readoutCpu);
+          waitForGo();
+          std::vector<Superpage> buffer(superpages);
+          while (!mStop.load(std::memory_order_relaxed)) {
+            auto count = bench.readoutRing->read(buffer.data(), buffer.size());
+            if (count == 0) {
+              std::this_thread::sleep_for(std::chrono::microseconds(10));
+              continue;
+            }
+            uint64_t bytes = 0;
+            for (size_t i = 0; i < count; ++i) {
+              bytes += buffer[i].getReceived();
+              buffer[i] = Superpage(buffer[i].getOffset(), mOptions.superpageSize);
+            }
+            bench.bytes.store(bench.bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+            bench.superpages.store(bench.superpages.load(std::memory_order_relaxed) + count,
+                std::memory_order_relaxed);
+            if (bench.freeRing->write(buffer.data(), count) != count) {
+              BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Free ring full"));
+            }
+          }
+        } catch (...) {
+          mStop = true;
+          throw;
+        }
+      });
+    }
+
+    void waitForGo()
+    {
+      while (!mGo.load(std::memory_order_acquire) && !mStop.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+
+    /// Displays the total throughput until the time is up, a thread failed or SIGINT was given
+    void monitor()
+    {
+      const auto end = mStart + std::chrono::seconds(mOptions.seconds);
+      auto next = mStart + DISPLAY_INTERVAL;
+      uint64_t previousBytes = 0;
+      if (!mOptions.noDisplay) {
+        cout << b::format("  %-8s  %-12s  %-12s\n") % "Seconds" % "Total Gb/s" % "Average Gb/s";
+      }
+      while (!mStop.load(std::memory_order_relaxed) && !isSigInt()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= end) {
+          break;
+        }
+        if (now >= next) {
+          uint64_t bytes = 0;
+          for (const auto& bench : mChannels) {
+            bytes += bench->bytes.load(std::memory_order_relaxed);
+          }
+          double seconds = std::chrono::duration<double>(now - mStart).count();
+          if (!mOptions.noDisplay) {
+            cout << b::format("  %-8.0f  %-12.2f  %-12.2f\n") % seconds
+                % toGbps(bytes - previousBytes, std::chrono::duration<double>(DISPLAY_INTERVAL).count())
+                % toGbps(bytes, seconds);
+          }
+          previousBytes = bytes;
+          next += DISPLAY_INTERVAL;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+
+    void outputStats()
+    {
+      double seconds = std::chrono::duration<double>(mEnd - mStart).count();
+
+      // Totals per card and per NUMA node
+      struct Total
+      {
+          int channels = 0;
+          uint64_t bytes = 0;
+      };
+      std::map<std::string, Total> cards;
+      std::map<std::string, Total> nodes;
+      Total total;
+      auto add = [](Total& total, uint64_t bytes) {
+        total.channels++;
+        total.bytes += bytes;
+      };
+
+      auto format = b::format("  %-16s  %-7s  %-4s  %-8s  %-11s  %-12s  %-10s\n");
+      cout << '\n' << format % "ID" % "Channel" % "NUMA" % "Push CPU" % "Readout CPU" % "Superpages" % "Gb/s";
+      for (const auto& bench : mChannels) {
+        auto bytes = bench->bytes.load();
+        cout << format % bench->cardIdString % bench->dmaChannel % optionalToString(bench->numaNode)
+            % optionalToString(bench->pushCpu) % optionalToString(bench->readoutCpu) % bench->superpages.load()
+            % (b::format("%.2f") % toGbps(bytes, seconds)).str();
+        add(cards[bench->card], bytes);
+        add(nodes[optionalToString(bench->numaNode)], bytes);
+        add(total, bytes);
+      }
+
+      auto totalFormat = b::format("  %-16s  %-8s  %-10.2f\n");
+      cout << '\n' << b::format("  %-16s  %-8s  %-10s\n") % "Card" % "Channels" % "Gb/s";
+      for (const auto& card : cards) {
+        cout << totalFormat % card.first % card.second.channels % toGbps(card.second.bytes, seconds);
+      }
+      cout << '\n' << b::format("  %-16s  %-8s  %-10s\n") % "NUMA node" % "Channels" % "Gb/s";
+      for (const auto& node : nodes) {
+        cout << totalFormat % node.first % node.second.channels % toGbps(node.second.bytes, seconds);
+      }
+      cout << '\n' << totalFormat % "Total" % total.channels % toGbps(total.bytes, seconds);
+      cout << b::format("  %-16s  %-8.1f\n") % "Seconds" % seconds << '\n';
+    }
+
+    static std::string optionalToString(const b::optional<int>& value)
+    {
+      return value ? std::to_string(*value) : "-";
+    }
+
+    struct OptionsStruct
+    {
+        std::string ids;
+        std::string links;
+        std::string loopbackModeString;
+        size_t bufferSize = 0;
+        size_t superpageSize = 0;
+        size_t dmaPageSize = 0;
+        uint64_t seconds = 0;
+        bool generatorEnabled = true;
+        bool noDisplay = false;
+        bool noPin = false;
+    } mOptions;
+
+    std::vector<std::unique_ptr<BenchChannel>> mChannels;
+
+    /// Set when all channels are started, to release their threads at once
+    std::atomic<bool> mGo { false };
+
+    /// Set to stop the threads, when the time is up or one of them failed
+    std::atomic<bool> mStop { false };
+
+    std::chrono::steady_clock::time_point mStart;
+    std::chrono::steady_clock::time_point mEnd;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramDmaBenchMulti().execute(argc, argv);
+}
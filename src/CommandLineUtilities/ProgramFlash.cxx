@@ -4,8 +4,12 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "CommandLineUtilities/Program.h"
+#include <future>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
 #include "ReadoutCard/ChannelFactory.h"
 #include "Crorc/Crorc.h"
 #include "ExceptionInternal.h"
@@ -22,7 +26,10 @@ class ProgramCrorcFlash: public Program
 
     virtual Description getDescription()
     {
-      return {"Flash", "Programs the card's flash memory", "roc-flash --id=12345 --file=/dir/my_file"};
+      return {"Flash", "Programs the card's flash memory. Several cards can be flashed in parallel by giving a "
+        "comma-separated list of card IDs.",
+        "roc-flash --id=12345 --file=/dir/my_file\n"
+        "roc-flash --id=12345,12346,12347 --file=/dir/my_file"};
     }
 
     virtual void addOptions(po::options_description& options)
@@ -32,10 +39,51 @@ class ProgramCrorcFlash: public Program
     }
 
     virtual void run(const boost::program_options::variables_map& map)
+    {
+      std::vector<std::string> cardIds;
+      auto idString = Options::getOptionCardIdString(map);
+      boost::split(cardIds, idString, boost::is_any_of(","));
+
+      if (cardIds.size() == 1) {
+        flash(cardIds.at(0), std::cout);
+        return;
+      }
+
+      // Every card gets its own thread. Their output is buffered, so the progress lines don't get mixed up.
+      std::vector<std::ostringstream> outputs(cardIds.size());
+      std::vector<std::future<void>> futures;
+      for (size_t i = 0; i < cardIds.size(); ++i) {
+        cout << "Flashing card " << cardIds[i] << endl;
+        futures.push_back(std::async(std::launch::async, [&, i]{ flash(cardIds[i], outputs[i]); }));
+      }
+
+      bool failed = false;
+      for (size_t i = 0; i < cardIds.size(); ++i) {
+        bool cardFailed = false;
+        try {
+          futures[i].get();
+          cout << "Card " << cardIds[i] << " done" << endl;
+        } catch (const std::exception& e) {
+          cout << "Card " << cardIds[i] << " failed: " << boost::diagnostic_information(e) << endl;
+          cardFailed = true;
+          failed = true;
+        }
+        if (cardFailed || isVerbose()) {
+          cout << outputs[i].str() << '\n';
+        }
+      }
+
+      if (failed) {
+        BOOST_THROW_EXCEPTION(AliceO2::roc::Exception() << AliceO2::roc::ErrorInfo::Message("Flashing failed"));
+      }
+    }
+
+  private:
+    void flash(const std::string& cardIdString, std::ostream& out)
     {
       using namespace AliceO2::roc;
 
-      auto cardId = Options::getOptionCardId(map);
+      auto cardId = Parameters::cardIdFromString(cardIdString);
       auto channelNumber = 0;
       auto params = AliceO2::roc::Parameters::makeParameters(cardId, channelNumber);
       auto channel = AliceO2::roc::ChannelFactory().getBar(params);
@@ -44,7 +92,7 @@ class ProgramCrorcFlash: public Program
         BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Only C-RORC supported for now"));
       }
 
-      Crorc::programFlash(*(channel.get()), mFilePath, 0, std::cout, &Program::getInterruptFlag());
+      Crorc::programFlash(*(channel.get()), mFilePath, 0, out, &Program::getInterruptFlag());
     }
 
     std::string mFilePath;
@@ -4,8 +4,12 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "CommandLineUtilities/Program.h"
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <boost/format.hpp>
 #include "ReadoutCard/ChannelFactory.h"
 #include "Crorc/Crorc.h"
 #include "ExceptionInternal.h"
@@ -22,8 +26,11 @@ class ProgramCrorcFlash: public Program
 
     virtual Description getDescription()
     {
-      return {"Flash Read", "Reads card flash memory",
-        "roc-flash-read --id=12345 --address=0 --words=32"};
+      return {"Flash Read", "Reads card flash memory. The words are printed as text, dumped to a binary file with "
+        "--binary-file, or compared with a flash data file with --verify.",
+        "roc-flash-read --id=12345 --address=0 --words=32\n"
+        "roc-flash-read --id=12345 --words=4616222 --binary-file=/dir/dump.bin\n"
+        "roc-flash-read --id=12345 --verify=/dir/my_file"};
     }
 
     virtual void addOptions(po::options_description& options)
@@ -31,7 +38,11 @@ class ProgramCrorcFlash: public Program
       Options::addOptionCardId(options);
       options.add_options()
           ("address", po::value<uint64_t>(&mAddress)->default_value(0), "Starting address to read")
-          ("words", po::value<uint64_t>(&mWords)->required(), "Amount of 32-bit words to read");
+          ("words", po::value<uint64_t>(&mWords), "Amount of 32-bit words to read, not needed with --verify")
+          ("binary-file", po::value<std::string>(&mBinaryFile),
+              "Dump the 16-bit flash words into this file, in host byte order, instead of printing them")
+          ("verify", po::value<std::string>(&mVerifyFile),
+              "Compare the flash with this data file, in the format roc-flash takes, and report the first difference");
     }
 
     virtual void run(const boost::program_options::variables_map& map)
@@ -47,11 +58,58 @@ class ProgramCrorcFlash: public Program
         BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Only C-RORC supported for now"));
       }
 
-      Crorc::readFlashRange(*channel.get(), mAddress, mWords, std::cout);
+      if (!mVerifyFile.empty()) {
+        verify(*channel);
+      } else if (mWords == 0) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("The option 'words' is required but missing"));
+      } else if (!mBinaryFile.empty()) {
+        dumpBinary(*channel);
+      } else {
+        Crorc::readFlashRange(*channel.get(), mAddress, mWords, std::cout);
+      }
+    }
+
+  private:
+    void dumpBinary(AliceO2::roc::BarInterface& bar)
+    {
+      using namespace AliceO2::roc;
+
+      std::ofstream stream(mBinaryFile, std::ios::binary | std::ios::trunc);
+      if (!stream.is_open()) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open file")
+          << ErrorInfo::FileName(mBinaryFile));
+      }
+
+      // Read in chunks, so it can be interrupted
+      constexpr uint64_t CHUNK_WORDS = 4096;
+      std::vector<uint16_t> buffer(CHUNK_WORDS);
+      uint64_t written = 0;
+      while (written < mWords && !isSigInt()) {
+        auto count = std::min(CHUNK_WORDS, mWords - written);
+        Crorc::readFlashWords(bar, mAddress + written, buffer.data(), count);
+        stream.write(reinterpret_cast<const char*>(buffer.data()), count * sizeof(uint16_t));
+        written += count;
+      }
+      cout << "Wrote " << written << " words to " << mBinaryFile << endl;
+    }
+
+    void verify(AliceO2::roc::BarInterface& bar)
+    {
+      using namespace AliceO2::roc;
+
+      auto mismatch = Crorc::verifyFlash(bar, mVerifyFile, mAddress, &getInterruptFlag());
+      if (mismatch) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message((boost::format(
+          "Flash differs from file at word %d: expected 0x%04x, got 0x%04x") % mismatch->offset
+            % mismatch->expected % mismatch->actual).str()));
+      }
+      cout << "Flash matches " << mVerifyFile << endl;
     }
 
     uint64_t mAddress = 0;
     uint64_t mWords = 0;
+    std::string mBinaryFile;
+    std::string mVerifyFile;
 };
 } // Anonymous namespace
 
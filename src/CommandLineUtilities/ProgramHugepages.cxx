@@ -0,0 +1,118 @@
+/// \file ProgramHugepages.cxx
+/// \brief Utility that allocates the hugepages of the DMA buffers on the NUMA nodes of the cards
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <algorithm>
+#include <iostream>
+#include <boost/format.hpp>
+#include "Common/SuffixOption.h"
+#include "CommandLineUtilities/AllCards.h"
+#include "CommandLineUtilities/HostAudit.h"
+#include "CommandLineUtilities/HugepageProvisioner.h"
+#include "CommandLineUtilities/Program.h"
+#include "ExceptionInternal.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using AliceO2::Common::SuffixOption;
+using std::cout;
+namespace po = boost::program_options;
+
+namespace {
+
+class ProgramHugepages: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {"Hugepages", "Allocates the hugepages the DMA buffers of every card need, on the NUMA node of the card, "
+          "and verifies the kernel allocated them. Buffers that are a multiple of 1 GiB get 1 GiB pages, others 2 MiB "
+          "pages. Allocations are only raised, never lowered. The hugetlbfs mounts are set up by "
+          "roc-setup-hugetlbfs.",
+          "roc-hugepages --channels=1 --buffer-size=8Gi\nroc-hugepages --channels=2 --buffer-size=512Mi --dry-run"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      options.add_options()
+          ("channels",
+              po::value<int>(&mChannels)->default_value(1),
+              "Amount of channels with a buffer on every card")
+          ("buffer-size",
+              SuffixOption<size_t>::make(&mBufferSize)->default_value("1Gi"),
+              "Size of the buffer of a channel, a multiple of 2 MiB")
+          ("dry-run",
+              po::bool_switch(&mDryRun),
+              "Only print the hugepages needed and allocated");
+    }
+
+    virtual void run(const boost::program_options::variables_map&)
+    {
+      if (mChannels < 1) {
+        BOOST_THROW_EXCEPTION(InvalidOptionValueException() << ErrorInfo::Message("Channels must be at least 1"));
+      }
+
+      auto cards = AllCards::findCards();
+      if (cards.empty()) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("No cards found"));
+      }
+      std::vector<int> numaNodes;
+      for (const auto& card : cards) {
+        numaNodes.push_back(card.numaNode);
+      }
+
+      HugepageProvisioner provisioner;
+      auto plan = HugepageProvisioner::makePlan(numaNodes, mChannels, mBufferSize);
+      printPlan(provisioner, plan, cards);
+      if (mDryRun) {
+        return;
+      }
+
+      provisioner.allocate(plan);
+      cout << "\nAfter allocation\n";
+      printPlan(provisioner, plan, cards);
+
+      for (const auto& warning : HostAudit().auditHost(false)) {
+        cout << "Warning: " << warning << '\n';
+      }
+      auto shortages = provisioner.verify(plan);
+      if (!shortages.empty()) {
+        for (const auto& shortage : shortages) {
+          cout << "Error: " << shortage << '\n';
+        }
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Not all hugepages could be allocated")
+            << ErrorInfo::PossibleCauses({"Memory of the node too fragmented, allocate the pages at boot with the "
+                "hugepages kernel parameters", "Not enough memory on the node"}));
+      }
+    }
+
+  private:
+
+    void printPlan(const HugepageProvisioner& provisioner, const HugepageProvisioner::Plan& plan,
+        const std::vector<CardDescriptor>& cards)
+    {
+      auto format = "  %-6s %-6s %-16s %-16s\n";
+      cout << boost::format(format) % "Node" % "Cards" % "2 MiB needed/has" % "1 GiB needed/has";
+      for (const auto& node : plan) {
+        auto allocated = provisioner.getAllocated(node.first);
+        auto cardCount = std::count_if(cards.begin(), cards.end(), [&](const CardDescriptor& card) {
+          return card.numaNode == node.first;
+        });
+        cout << boost::format(format) % (node.first >= 0 ? std::to_string(node.first) : "none") % cardCount
+            % (boost::format("%d/%d") % node.second.pages2MiB % allocated.pages2MiB)
+            % (boost::format("%d/%d") % node.second.pages1GiB % allocated.pages1GiB);
+      }
+    }
+
+    int mChannels;
+    size_t mBufferSize;
+    bool mDryRun = false;
+};
+} // Anonymous namespace
+
+int main(int argc, char** argv)
+{
+  return ProgramHugepages().execute(argc, argv);
+}
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <sstream>
+#include "CommandLineUtilities/AllCards.h"
 #include "CommandLineUtilities/Options.h"
 #include "CommandLineUtilities/Program.h"
 #include "RocPciDevice.h"
@@ -47,23 +48,40 @@ class ProgramListCards: public Program
 
       table << lineFat << header << lineThin;
 
-      int i = 0;
+      // Reading the firmware info maps BAR 2 of the card, so the cards are read concurrently
+      struct CardInfo
+      {
+          CardDescriptor card;
+          std::string firmware;
+          std::string cardId;
+          std::string error;
+      };
+      const std::string na = "n/a";
+      std::vector<CardInfo> infos;
       for (const auto& card : cardsFound) {
-        // Try to figure out the firmware version
-        const std::string na = "n/a";
-        std::string firmware = na;
-        std::string cardId = na;
-        std::string numaNode = std::to_string(card.numaNode);
+        infos.push_back({card, na, na, ""});
+      }
+      AllCards::forEach(infos, [&](CardInfo& info) {
         try {
-          Parameters params = Parameters::makeParameters(card.pciAddress, 2);
+          Parameters params = Parameters::makeParameters(info.card.pciAddress, 2);
           params.setBufferParameters(buffer_parameters::Null());
-          firmware = ChannelFactory().getBar(params)->getFirmwareInfo().value_or(na);
-          cardId = ChannelFactory().getBar(params)->getCardId().value_or(na);
+          auto bar = ChannelFactory().getBar(params);
+          info.firmware = bar->getFirmwareInfo().value_or(na);
+          info.cardId = bar->getCardId().value_or(na);
         }
         catch (const Exception& e) {
-          if (isVerbose()) {
-            cout << "Could not get firmware version string:\n" << boost::diagnostic_information(e) << '\n';
-          }
+          info.error = boost::diagnostic_information(e);
+        }
+      });
+
+      int i = 0;
+      for (const auto& info : infos) {
+        const auto& card = info.card;
+        const auto& firmware = info.firmware;
+        const auto& cardId = info.cardId;
+        std::string numaNode = std::to_string(card.numaNode);
+        if (!info.error.empty() && isVerbose()) {
+          cout << "Could not get firmware version string:\n" << info.error << '\n';
         }
 
         auto format = boost::format(formatRow) % i % CardType::toString(card.cardType) % card.pciAddress.toString()
@@ -3,9 +3,18 @@
 ///
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
 #include "Cru/Constants.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "CommandLineUtilities/AllCards.h"
+#include "CommandLineUtilities/ChannelStatisticsReader.h"
+#include "CommandLineUtilities/MetricsTable.h"
 #include "CommandLineUtilities/Options.h"
 #include "CommandLineUtilities/Program.h"
 #include "RocPciDevice.h"
@@ -25,7 +34,9 @@ class ProgramMetrics: public Program
   {
     return {"Metrics", "Return current RoC parameters", 
       "roc-metrics\n"
-      "roc-metrics --pci-address 42:00.0\n"};
+      "roc-metrics --pci-address 42:00.0\n"
+      "roc-metrics --interval=1000 --shm=monitoring\n"
+      "roc-metrics --interval=1000 --channels\n"};
   }
 
   virtual void addOptions(boost::program_options::options_description& options)
@@ -33,7 +44,18 @@ class ProgramMetrics: public Program
     options.add_options()
       ("pci-address",
        po::value<std::string>(&mOptions.pciAddress)->default_value("-1"),
-       "Card's PCI Address");
+       "Card's PCI Address")
+      ("interval",
+       po::value<int>(&mOptions.interval)->default_value(0),
+       "Keep running and sample the cards every [interval] milliseconds, until interrupted. 0 samples once.")
+      ("shm",
+       po::value<std::string>(&mOptions.shmName),
+       "Publish the samples in the shared-memory table /dev/shm/AliceO2_RoC_Metrics_[name] (see MetricsTable.h) "
+       "instead of printing them")
+      ("channels",
+       po::bool_switch(&mOptions.channels),
+       "Also print the statistics the DMA channels of the cards publish (see the StatisticsPublishingEnabled "
+       "parameter), with the throughput since the previous sample");
   }
 
   virtual void run(const boost::program_options::variables_map& map) 
@@ -44,8 +66,107 @@ class ProgramMetrics: public Program
       cardsFound = AliceO2::roc::RocPciDevice::findSystemDevices(mOptions.pciAddress);
     else
       cardsFound = AliceO2::roc::RocPciDevice::findSystemDevices();
-      
 
+    if (mOptions.interval < 0) {
+      throw std::runtime_error("Interval must not be negative");
+    }
+
+    // The BARs stay mapped between samples, so a sample is only the register reads. They are mapped, and the cards
+    // read, concurrently, so a sample takes the time of the slowest card instead of the sum of all. They're monitor
+    // BARs, so the reads stay within the card's PCIe budget next to a running readout.
+    for (const auto& card : cardsFound) {
+      mCards.push_back({card, nullptr, {}});
+    }
+    AllCards::forEach(mCards, [](Card& card) {
+      card.bar2 = ChannelFactory().getMonitorBar(Parameters::makeParameters(card.descriptor.pciAddress, 2));
+    });
+
+    if (!mOptions.shmName.empty()) {
+      if (mCards.size() > size_t(MetricsTable::MAX_CARDS)) {
+        throw std::runtime_error("Too many cards for the metrics table");
+      }
+      mTableFile = std::make_unique<MemoryMappedFile>(MetricsTable::getPath(mOptions.shmName), sizeof(MetricsTable),
+          true);
+      mTable = reinterpret_cast<MetricsTable*>(mTableFile->getAddress());
+      mTable->sequence.store(0);
+      mTable->cardCount = 0;
+      mTable->version = MetricsTable::VERSION;
+      mTable->magic = MetricsTable::MAGIC;
+      getLogger() << "Publishing metrics in " << MetricsTable::getPath(mOptions.shmName) << InfoLogger::endm;
+    }
+
+    auto next = std::chrono::steady_clock::now();
+    do {
+      sample();
+      if (mTable) {
+        publish();
+      } else {
+        print();
+      }
+      if (mOptions.channels) {
+        printChannels();
+      }
+      next += std::chrono::milliseconds(mOptions.interval);
+      while (mOptions.interval > 0 && !isSigInt() && std::chrono::steady_clock::now() < next) {
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(next - std::chrono::steady_clock::now(),
+            std::chrono::milliseconds(100)));
+      }
+    } while (mOptions.interval > 0 && !isSigInt());
+  }
+
+  struct OptionsStruct 
+  {
+    std::string pciAddress = "-1";
+    int interval = 0;
+    std::string shmName;
+    bool channels = false;
+  }mOptions;
+
+  private:
+
+  struct Card
+  {
+    CardDescriptor descriptor;
+    std::shared_ptr<BarInterface> bar2;
+    MetricsTable::Entry metrics;
+  };
+
+  /// Highest channel number a card may have, plus one
+  static constexpr int MAX_CHANNELS = 8;
+
+  void sample()
+  {
+    AllCards::forEach(mCards, [](Card& card) {
+      auto& metrics = card.metrics;
+      auto& bar2 = card.bar2;
+      metrics = MetricsTable::Entry();
+      copyString(card.descriptor.pciAddress.toString(), metrics.pciAddress);
+      copyString(CardType::toString(card.descriptor.cardType), metrics.cardType);
+      metrics.temperature = bar2->getTemperature().value_or(0);
+      metrics.droppedPackets = bar2->getDroppedPackets();
+      metrics.ctpClock = bar2->getCTPClock()/1e6;
+      metrics.localClock = bar2->getLocalClock()/1e6;
+      metrics.links = bar2->getLinks();
+      metrics.linksWrapper0 = bar2->getLinksPerWrapper(0);
+      metrics.linksWrapper1 = bar2->getLinksPerWrapper(1);
+    });
+  }
+
+  void publish()
+  {
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    mTable->beginWrite();
+    mTable->timestamp = timestamp;
+    mTable->cardCount = mCards.size();
+    for (size_t i = 0; i < mCards.size(); ++i) {
+      mTable->entries[i] = mCards[i].metrics;
+    }
+    mTable->endWrite();
+  }
+
+  void print()
+  {
     std::ostringstream table;
 
     auto formatHeader = "  %-3s %-6s %-10s %-10s %-19s %-20s %-19s %-8s %-17s %-17s\n";
@@ -59,20 +180,11 @@ class ProgramMetrics: public Program
     table << lineFat << header << lineThin;
 
     int i = 0;
-    for (const auto& card : cardsFound) {
-      Parameters params = Parameters::makeParameters(card.pciAddress, 2);
-      auto bar2 = ChannelFactory().getBar(params);
-
-      float temperature = bar2->getTemperature().value_or(0);
-      int32_t dropped = bar2->getDroppedPackets();
-      float ctp_clock = bar2->getCTPClock()/1e6;
-      float local_clock = bar2->getLocalClock()/1e6;
-      int32_t links = bar2->getLinks();
-      uint32_t links0 = bar2->getLinksPerWrapper(0);
-      uint32_t links1 = bar2->getLinksPerWrapper(1);
-
-      auto format = boost::format(formatRow) % i % CardType::toString(card.cardType) % card.pciAddress.toString()
-        % temperature % dropped % ctp_clock % local_clock % links % links0 % links1;
+    for (const auto& card : mCards) {
+      const auto& metrics = card.metrics;
+      auto format = boost::format(formatRow) % i % metrics.cardType % metrics.pciAddress
+        % metrics.temperature % metrics.droppedPackets % metrics.ctpClock % metrics.localClock % metrics.links
+        % metrics.linksWrapper0 % metrics.linksWrapper1;
 
       table << format;
       i++;
@@ -81,20 +193,51 @@ class ProgramMetrics: public Program
     table << lineFat;
     std::cout << table.str();
   }
-  
-  struct OptionsStruct 
+
+  void printChannels()
   {
-    std::string pciAddress = "-1";
-  }mOptions;
+    std::ostringstream table;
+    auto format = "  %-10s %-7s %-6s %-6s %-18s %-12s %-15s %-15s\n";
+    auto header = (boost::format(format) % "PCI Addr" % "Channel" % "Open" % "Links" % "Bytes" % "Rate (Gb/s)"
+        % "Transfer queue" % "Ready queue").str();
+    table << std::string(header.length(), '=') << '\n' << header << std::string(header.length(), '-') << '\n';
+
+    for (const auto& card : mCards) {
+      for (int channel = 0; channel < MAX_CHANNELS; ++channel) {
+        auto key = std::make_pair(card.descriptor.pciAddress.toString(), channel);
+        auto reader = mChannelReaders.find(key);
+        if (reader == mChannelReaders.end()) {
+          reader = mChannelReaders.emplace(key, ChannelStatisticsReader(card.descriptor.pciAddress, channel)).first;
+        }
+        auto sample = reader->second.read();
+        if (!sample) {
+          continue;
+        }
+
+        table << boost::format(format) % card.descriptor.pciAddress.toString() % channel
+            % (sample->open ? "yes" : "no") % sample->statistics.links.size() % sample->bytes
+            % (boost::format("%.3f") % sample->throughput) % sample->statistics.transferQueueSize
+            % sample->statistics.readyQueueSize;
+      }
+    }
 
-  private:
+    table << std::string(header.length(), '=') << '\n';
+    std::cout << table.str();
+  }
+
+  template <size_t Size>
+  static void copyString(const std::string& string, char (&destination)[Size])
+  {
+    string.copy(destination, Size - 1);
+  }
+
+  std::vector<Card> mCards;
+  std::map<std::pair<std::string, int>, ChannelStatisticsReader> mChannelReaders;
+  std::unique_ptr<MemoryMappedFile> mTableFile;
+  MetricsTable* mTable = nullptr;
 };
 
 int main(int argc, char** argv)
 {
-  if (argc > 2){
-    std::cout << "Too many arguments" << std::endl;
-    return -1;
-  }
   return ProgramMetrics().execute(argc, argv);
 }
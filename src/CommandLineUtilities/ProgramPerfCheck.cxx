@@ -0,0 +1,70 @@
+/// \file ProgramPerfCheck.cxx
+/// \brief Utility that checks the host settings that reduce DMA performance
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <iostream>
+#include "Common/Iommu.h"
+#include "CommandLineUtilities/AllCards.h"
+#include "CommandLineUtilities/HostAudit.h"
+#include "CommandLineUtilities/Program.h"
+#include "ExceptionInternal.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using std::cout;
+namespace po = boost::program_options;
+
+namespace {
+
+class ProgramPerfCheck: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {"Performance Check", "Checks the host settings that reduce DMA performance: the hugetlbfs mounts, the "
+          "IOMMU, and for every card the hugepages of its NUMA node, the frequency governor and idle states of its "
+          "local CPUs, and the affinity of its interrupts. Fails if any setting needs attention.",
+          "roc-perf-check"};
+    }
+
+    virtual void addOptions(po::options_description&)
+    {
+    }
+
+    virtual void run(const boost::program_options::variables_map&)
+    {
+      HostAudit audit;
+      size_t warnings = 0;
+      auto print = [&](const std::string& subject, const std::vector<std::string>& messages) {
+        cout << subject << (messages.empty() ? ": ok\n" : "\n");
+        for (const auto& message : messages) {
+          cout << "  Warning: " << message << '\n';
+        }
+        warnings += messages.size();
+      };
+
+      print("Host", audit.auditHost(AliceO2::Common::Iommu::isEnabled()));
+
+      auto cards = AllCards::findCards();
+      for (const auto& card : cards) {
+        print((boost::format("%s %s (NUMA node %d)") % CardType::toString(card.cardType) % card.pciAddress.toString()
+            % card.numaNode).str(), audit.auditCard(card.pciAddress, card.numaNode));
+      }
+      if (cards.empty()) {
+        cout << "No cards found\n";
+      }
+
+      if (warnings > 0) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(std::to_string(warnings)
+            + " settings reduce DMA performance"));
+      }
+    }
+};
+} // Anonymous namespace
+
+int main(int argc, char** argv)
+{
+  return ProgramPerfCheck().execute(argc, argv);
+}
@@ -0,0 +1,88 @@
+/// \file ProgramRegisterBatch.cxx
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+///
+/// \brief Utility that executes a script of register operations on a card
+
+#include "CommandLineUtilities/Program.h"
+#include "CommandLineUtilities/RegisterScript.h"
+#include "ExceptionInternal.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+namespace po = boost::program_options;
+
+namespace {
+class ProgramRegisterBatch: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {"Register Batch", "Execute a script of register reads, writes, masked writes and waits. See "
+          "RegisterScript.h or the README for the script format.",
+          "roc-reg-batch --id=12345 --channel=0 --script=config.txt\n"
+          "echo 'read 0x600 4' | roc-reg-batch --id=12345 --channel=0 --format=binary > values.bin"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      Options::addOptionChannel(options);
+      Options::addOptionCardId(options);
+      options.add_options()
+          ("script",
+              po::value<std::string>(&mScript)->default_value("-"),
+              "Script file, '-' for stdin")
+          ("format",
+              po::value<std::string>(&mFormat)->default_value("json"),
+              "Output of the reads: 'json' for a JSON object per read, 'binary' for the raw 32-bit values");
+    }
+
+    virtual void run(const boost::program_options::variables_map& map)
+    {
+      if (mFormat != "json" && mFormat != "binary") {
+        BOOST_THROW_EXCEPTION(InvalidOptionValueException()
+            << ErrorInfo::Message("Format must be 'json' or 'binary'") << ErrorInfo::String(mFormat));
+      }
+
+      // The script is parsed before the card is touched
+      auto script = [&]{
+        if (mScript == "-") {
+          return RegisterScript::parse(std::cin);
+        }
+        std::ifstream stream(mScript);
+        if (!stream) {
+          BOOST_THROW_EXCEPTION(InvalidOptionValueException() << ErrorInfo::Message("Failed to open script")
+              << ErrorInfo::Filename(mScript));
+        }
+        return RegisterScript::parse(stream);
+      }();
+
+      auto cardId = Options::getOptionCardId(map);
+      int channelNumber = Options::getOptionChannel(map);
+      auto params = Parameters::makeParameters(cardId, channelNumber);
+      auto channel = ChannelFactory().getBar(params);
+
+      auto results = script.execute(*channel);
+      if (mFormat == "json") {
+        RegisterScript::writeJson(std::cout, results);
+      } else {
+        RegisterScript::writeBinary(std::cout, results);
+      }
+      std::cout.flush();
+    }
+
+  private:
+
+    std::string mScript;
+    std::string mFormat;
+};
+} // Anonymous namespace
+
+int main(int argc, char** argv)
+{
+  return ProgramRegisterBatch().execute(argc, argv);
+}
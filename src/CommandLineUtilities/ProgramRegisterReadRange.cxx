@@ -46,9 +46,7 @@ class ProgramRegisterReadRange: public Program
       // Registers are indexed by 32 bits (4 bytes)
       int baseIndex = baseAddress / 4;
 
-      for (int i = 0; i < range; ++i) {
-        values[i] = channel->readRegister(baseIndex + i);
-      }
+      channel->readRegisters(baseIndex, values.data(), values.size());
 
       if (mFile.empty()) {
         for (int i = 0; i < range; ++i) {
@@ -3,6 +3,7 @@
 ///
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
+#include "CommandLineUtilities/AllCards.h"
 #include "CommandLineUtilities/Program.h"
 #include <iostream>
 #include "ReadoutCard/ChannelFactory.h"
@@ -17,7 +18,9 @@ class ProgramReset: public Program
 
     virtual Description getDescription()
     {
-      return {"Reset", "Resets a channel", "roc-reset --id=12345 --channel=0 --reset=INTERNAL_DIU_SIU"};
+      return {"Reset", "Resets a channel, or the channel of every card with --all",
+          "roc-reset --id=12345 --channel=0 --reset=INTERNAL_DIU_SIU\n"
+          "roc-reset --all --channel=0 --reset=INTERNAL"};
     }
 
     virtual void addOptions(boost::program_options::options_description& options)
@@ -25,19 +28,28 @@ class ProgramReset: public Program
       Options::addOptionRegisterAddress(options);
       Options::addOptionChannel(options);
       Options::addOptionCardId(options);
+      Options::addOptionAllCards(options);
       Options::addOptionResetLevel(options);
     }
 
     virtual void run(const boost::program_options::variables_map& map)
     {
       auto resetLevel = Options::getOptionResetLevel(map);
-      auto cardId = Options::getOptionCardId(map);
       int channelNumber = Options::getOptionChannel(map);
 
-      auto params = AliceO2::roc::Parameters::makeParameters(cardId, channelNumber);
-      params.setBufferParameters(AliceO2::roc::buffer_parameters::Null());
-      auto channel = AliceO2::roc::ChannelFactory().getDmaChannel(params);
-      channel->resetChannel(resetLevel);
+      auto reset = [&](const AliceO2::roc::Parameters::CardIdType& cardId) {
+        auto params = AliceO2::roc::Parameters::makeParameters(cardId, channelNumber);
+        params.setBufferParameters(AliceO2::roc::buffer_parameters::Null());
+        auto channel = AliceO2::roc::ChannelFactory().getDmaChannel(params);
+        channel->resetChannel(resetLevel);
+      };
+
+      if (Options::getOptionAllCards(map)) {
+        // The resets wait for the cards, so they are done in parallel
+        AllCards::runAndReport(std::cout, [&](const AliceO2::roc::CardDescriptor& card) { reset(card.pciAddress); });
+      } else {
+        reset(Options::getOptionCardId(map));
+      }
     }
 };
 } // Anonymous namespace
@@ -9,7 +9,10 @@
 #include "ReadoutCard/CardType.h"
 #include "ReadoutCard/Exception.h"
 #include <boost/format.hpp>
+#include "CommandLineUtilities/AllCards.h"
 #include "CommandLineUtilities/Program.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "Utilities/PciLink.h"
 
 using namespace AliceO2::roc::CommandLineUtilities;
 using namespace AliceO2::roc;
@@ -19,6 +22,9 @@ using std::endl;
 namespace b = boost;
 
 namespace {
+/// Line rate of a CRU GBT link, in Gb/s
+constexpr double GBT_LINK_RATE = 4.8;
+
 class ProgramSanityCheck: public Program
 {
   public:
@@ -26,22 +32,30 @@ class ProgramSanityCheck: public Program
     virtual Description getDescription()
     {
       return {"Sanity Check", "Does some basic sanity checks on the card",
-          "roc-sanity-check --id=12345 --channel=0"};
+          "roc-sanity-check --id=12345 --channel=0\nroc-sanity-check --all --channel=0"};
     }
 
     virtual void addOptions(boost::program_options::options_description& options)
     {
-      Options::addOptionSerialNumber(options);
       Options::addOptionChannel(options);
       Options::addOptionCardId(options);
+      Options::addOptionAllCards(options);
+      options.add_options()
+          ("pcie-only",
+              b::program_options::bool_switch(&mPcieOnly),
+              "Only audit the PCIe links of the cards, which is read-only and can't crash the host");
     }
 
     virtual void run(const boost::program_options::variables_map& map)
     {
-      auto cardId = Options::getOptionCardId(map);
       const int channelNumber = Options::getOptionChannel(map);
 
-      cout << "Warning: if the card is in a bad state, this program may result in a crash and reboot of the host\n";
+      auditPcie();
+      if (mPcieOnly) {
+        return;
+      }
+
+      cout << "\nWarning: if the card is in a bad state, this program may result in a crash and reboot of the host\n";
       cout << "  To proceed, type 'y'\n";
       cout << "  To abort, type anything else or give SIGINT (usually Ctrl-c)\n";
       int c = getchar();
@@ -49,10 +63,75 @@ class ProgramSanityCheck: public Program
         return;
       }
 
-      auto params = AliceO2::roc::Parameters::makeParameters(cardId, channelNumber);
-      //auto channel = AliceO2::roc::ChannelUtilityFactory().getUtility(params);
-      //channel->utilitySanityCheck(cout);
+      auto check = [&](const Parameters::CardIdType& cardId) {
+        auto params = AliceO2::roc::Parameters::makeParameters(cardId, channelNumber);
+        //auto channel = AliceO2::roc::ChannelUtilityFactory().getUtility(params);
+        //channel->utilitySanityCheck(cout);
+      };
+
+      if (Options::getOptionAllCards(map)) {
+        AllCards::runAndReport(cout, [&](const CardDescriptor& card) { check(card.pciAddress); });
+      } else {
+        check(Options::getOptionCardId(map));
+      }
     }
+
+  private:
+
+    /// Prints the PCIe link of every card of the system, and the settings that cap its DMA throughput
+    void auditPcie()
+    {
+      auto cards = AllCards::findCards();
+      auto format = "  %-6s %-10s %-14s %-10s %-9s %-10s %-10s\n";
+      cout << "PCIe links\n";
+      cout << b::format(format) % "Type" % "PCI Addr" % "Speed (GT/s)" % "Width" % "MPS" % "MRRS" % "DMA Gb/s";
+
+      std::vector<std::string> problems;
+      for (const auto& card : cards) {
+        auto name = CardType::toString(card.cardType) + " " + card.pciAddress.toString();
+        Utilities::PciLinkStatus status;
+        try {
+          status = Utilities::getPciLinkStatus(card.pciAddress);
+        } catch (const std::exception& e) {
+          problems.push_back(name + ": " + e.what());
+          continue;
+        }
+
+        const double dmaBandwidth = Utilities::getPciLinkBandwidth(status.currentSpeed, status.currentWidth)
+            * Utilities::getPciPayloadEfficiency(status.maxPayloadSize);
+        cout << b::format(format) % CardType::toString(card.cardType) % card.pciAddress.toString()
+            % (b::format("%g/%g") % status.currentSpeed % status.maxSpeed)
+            % (b::format("x%d/x%d") % status.currentWidth % status.maxWidth)
+            % (b::format("%d/%d") % status.maxPayloadSize % status.maxPayloadSizeSupported)
+            % status.maxReadRequestSize % (b::format("%.1f") % dmaBandwidth);
+
+        for (const auto& message : Utilities::auditPciLink(status, getLinksBandwidth(card))) {
+          problems.push_back(name + ": " + message);
+        }
+      }
+
+      if (cards.empty()) {
+        cout << "  No cards found\n";
+      }
+      for (const auto& problem : problems) {
+        cout << "  Warning: " << problem << '\n';
+      }
+    }
+
+    /// Total line rate of the enabled links of a card, in Gb/s, or 0 if unknown
+    double getLinksBandwidth(const CardDescriptor& card)
+    {
+      if (card.cardType != CardType::Cru) {
+        return 0;
+      }
+      try {
+        return ChannelFactory().getBar(card.pciAddress, 2)->getLinks() * GBT_LINK_RATE;
+      } catch (const std::exception&) {
+        return 0;
+      }
+    }
+
+    bool mPcieOnly = false;
 };
 } // Anonymous namespace
 
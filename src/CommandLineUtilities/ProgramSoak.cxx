@@ -0,0 +1,551 @@
+/// \file ProgramSoak.cxx
+/// \brief Utility that runs the DMA pipeline for a long time under stress, and checks that no data goes astray
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/format.hpp>
+#include "CommandLineUtilities/BarHammer.h"
+#include "CommandLineUtilities/ConsumerModel.h"
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "CommandLineUtilities/SoakLedger.h"
+#include "Common/SuffixOption.h"
+#include "ExceptionInternal.h"
+#include "InfoLogger/InfoLogger.hxx"
+#include "LatencyHistogram.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/LinkIntegrityMonitor.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "ReadoutCard/Parameters.h"
+#include "ReadoutCard/SuperpageRing.h"
+#include "Utilities/Hugetlbfs.h"
+#include "Utilities/Timestamp.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+using AliceO2::Common::SuffixOption;
+using std::cout;
+namespace b = boost;
+namespace po = boost::program_options;
+
+namespace {
+/// End InfoLogger message alias
+constexpr auto endm = InfoLogger::endm;
+/// Interval of the throughput samples
+constexpr auto SAMPLE_INTERVAL = std::chrono::seconds(1);
+
+double toGbps(uint64_t bytes, double seconds)
+{
+  return seconds > 0 ? (double(bytes) * 8 / (1000.0 * 1000.0 * 1000.0)) / seconds : 0;
+}
+
+/// Mean, spread and extremes of the throughput samples, accumulated with Welford's method so a run of days needs no
+/// storage per sample
+struct ThroughputStability
+{
+    uint64_t samples = 0;
+    double mean = 0;
+    double squares = 0;
+    double min = 0;
+    double max = 0;
+
+    void add(double gbps)
+    {
+      min = samples == 0 ? gbps : std::min(min, gbps);
+      max = samples == 0 ? gbps : std::max(max, gbps);
+      samples++;
+      const double delta = gbps - mean;
+      mean += delta / samples;
+      squares += delta * (gbps - mean);
+    }
+
+    double getStandardDeviation() const
+    {
+      return samples > 1 ? std::sqrt(squares / (samples - 1)) : 0;
+    }
+};
+} // Anonymous namespace
+
+/// Runs the DMA pipeline of a channel for hours or days, while disturbing it the way a long data taking run does:
+/// the consumer stalls at random, DMA is stopped and restarted or recovered at intervals, and BAR hammer threads
+/// access the BAR alongside. Like roc-bench-dma-multi, a pipeline thread pushes and pops the superpages, and a readout
+/// thread consumes them, through superpage rings.
+///
+/// Every superpage is tracked by a SoakLedger, which finds the ones the driver loses or hands out twice, and the data
+/// is checked by a LinkIntegrityMonitor, whose packet counter checks find the packets lost or duplicated within the
+/// superpages. The superpages carry the amount of restarts before their arrival as user data, so the readout thread
+/// resynchronizes the packet counters when the data generator restarted.
+class ProgramSoak: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {
+        "Soak",
+        "Run the DMA pipeline for a long time under stress, and check that no data goes astray\n"
+          "The consumer stalls at random, DMA is stopped and restarted or recovered at intervals, and threads access "
+          "the BAR alongside. Reports throughput stability, latency percentiles, lost and duplicated superpages, and "
+          "packet counter errors. Fails if any data went astray.",
+        "roc-soak --id=42:0.0 --links=0-11 --time=86400 --cycle-interval=600"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      Options::addOptionCardId(options);
+      Options::addOptionChannel(options);
+      options.add_options()
+          ("bar-threads",
+              po::value<int>(&mOptions.barThreads)->default_value(1),
+              "Amount of threads reading the BAR alongside the DMA")
+          ("buffer-size",
+              SuffixOption<size_t>::make(&mOptions.bufferSize)->default_value("1Gi"),
+              "Buffer size in bytes")
+          ("consumer",
+              po::value<std::string>(&mOptions.consumer)->default_value("random"),
+              "Consumer model, see roc-bench-dma --consumer")
+          ("cycle-interval",
+              po::value<uint64_t>(&mOptions.cycleInterval)->default_value(300),
+              "Seconds between DMA stop/start cycles, 0 for none")
+          ("driver-thread",
+              po::bool_switch(&mOptions.driverThread),
+              "Run the driver in its own thread")
+          ("generator",
+              po::value<bool>(&mOptions.generatorEnabled)->default_value(true),
+              "Enable data generator")
+          ("links",
+              po::value<std::string>(&mOptions.links)->default_value("0"),
+              "Links to open. A comma separated list of integers or ranges, e.g. '0,2,5-10'")
+          ("loopback",
+              po::value<std::string>(&mOptions.loopbackModeString)->default_value("INTERNAL"),
+              "Generator loopback mode [NONE, INTERNAL, DIU, SIU]")
+          ("no-check",
+              po::bool_switch(&mOptions.noCheck),
+              "Skip the packet counter checks, for data without RDHs")
+          ("page-size",
+              SuffixOption<size_t>::make(&mOptions.dmaPageSize)->default_value("8Ki"),
+              "Card DMA page size")
+          ("recover-every",
+              po::value<uint64_t>(&mOptions.recoverEvery)->default_value(3),
+              "Make every Nth cycle a recover() instead of a stop/start, 0 for never")
+          ("report-interval",
+              po::value<uint64_t>(&mOptions.reportInterval)->default_value(60),
+              "Seconds between report lines")
+          ("superpage-size",
+              SuffixOption<size_t>::make(&mOptions.superpageSize)->default_value("1Mi"),
+              "Superpage size in bytes")
+          ("time",
+              po::value<uint64_t>(&mOptions.seconds)->default_value(3600),
+              "Duration of the run in seconds");
+    }
+
+    virtual void run(const po::variables_map& map)
+    {
+      if (mOptions.superpageSize == 0 || mOptions.bufferSize < mOptions.superpageSize) {
+        throw ParameterException() << ErrorInfo::Message("Buffer size smaller than superpage size");
+      }
+      if (mOptions.reportInterval == 0) {
+        throw ParameterException() << ErrorInfo::Message("Report interval of 0");
+      }
+      mSuperpages = mOptions.bufferSize / mOptions.superpageSize;
+      mLinkIds = Parameters::linkMaskFromString(mOptions.links);
+      mConsumer = ConsumerModel(mOptions.consumer);
+      mLedger = SoakLedger(mSuperpages, mOptions.superpageSize);
+
+      auto cardId = Options::getOptionCardId(map);
+      auto dmaChannel = Options::getOptionChannel(map);
+      auto bufferName = (b::format("roc-soak_id=%s_chan=%d_pages") % Options::getOptionCardIdString(map)
+          % dmaChannel).str();
+      mBuffer = Utilities::tryMapFile(mOptions.bufferSize, bufferName, true);
+
+      auto params = Parameters::makeParameters(cardId, dmaChannel)
+          .setDmaPageSize(mOptions.dmaPageSize)
+          .setGeneratorEnabled(mOptions.generatorEnabled)
+          .setGeneratorDataSize(mOptions.dmaPageSize)
+          .setGeneratorLoopback(LoopbackMode::fromString(mOptions.loopbackModeString))
+          .setLinkMask(mLinkIds)
+          .setDriverThreadEnabled(mOptions.driverThread)
+          .setBufferParameters(buffer_parameters::Memory{mBuffer->getAddress(), mBuffer->getSize()});
+      mChannel = ChannelFactory().getDmaChannel(params);
+
+      mReadoutRing = std::make_unique<SuperpageRing>(mSuperpages);
+      mFreeRing = std::make_unique<SuperpageRing>(mSuperpages);
+      for (size_t i = 0; i < mSuperpages; ++i) {
+        mFreeRing->write(Superpage(i * mOptions.superpageSize, mOptions.superpageSize));
+      }
+
+      std::vector<std::unique_ptr<BarHammer>> hammers;
+      if (mOptions.barThreads > 0) {
+        auto bar = ChannelFactory().getBar(Parameters::makeParameters(cardId, 0));
+        BarHammer::Options hammerOptions;
+        hammerOptions.mode = BarHammer::Mode::Read;
+        for (int i = 0; i < mOptions.barThreads; ++i) {
+          hammers.push_back(std::make_unique<BarHammer>());
+          hammers.back()->start(bar, hammerOptions);
+        }
+      }
+
+      mChannel->startDma();
+      mStart = std::chrono::steady_clock::now();
+      mStartTicks = Utilities::getTimestampCounter();
+      auto pipelineFuture = std::async(std::launch::async, [&]{ guard([&]{ runPipeline(); }); });
+      auto readoutFuture = std::async(std::launch::async, [&]{ guard([&]{ runReadout(); }); });
+
+      monitor();
+      mStop = true;
+
+      // Collect all threads before throwing an error of one of them
+      std::exception_ptr error;
+      for (auto future : {&pipelineFuture, &readoutFuture}) {
+        try {
+          future->get();
+        } catch (...) {
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+      }
+      mEnd = std::chrono::steady_clock::now();
+      mEndTicks = Utilities::getTimestampCounter();
+      for (auto& hammer : hammers) {
+        hammer->join();
+      }
+      if (error) {
+        std::rethrow_exception(error);
+      }
+
+      // Superpages still on the card at the end are not lost, unless the final stop fails to give them back
+      mChannel->stopDma();
+      drainReadyQueue();
+      mLedger.reconcile();
+
+      outputStats(hammers);
+      if (mLedger.getLost() != 0 || mLedger.getDuplicated() != 0 || mIntegrityErrors.load() != 0) {
+        throw Exception() << ErrorInfo::Message("Data went astray, see the report");
+      }
+    }
+
+  private:
+    /// Runs a thread's function, and stops the other threads if it fails
+    template <typename Function>
+    void guard(Function function)
+    {
+      try {
+        function();
+      } catch (...) {
+        mStop = true;
+        throw;
+      }
+    }
+
+    /// Gives free superpages to the card, passes the arrived ones to the readout thread, and does the cycles
+    void runPipeline()
+    {
+      std::vector<Superpage> buffer(mSuperpages);
+      auto& channel = *mChannel;
+      auto nextCycle = mStart + std::chrono::seconds(mOptions.cycleInterval);
+      while (!mStop.load(std::memory_order_relaxed)) {
+        if (mOptions.cycleInterval != 0 && std::chrono::steady_clock::now() >= nextCycle) {
+          cycle();
+          nextCycle += std::chrono::seconds(mOptions.cycleInterval);
+        }
+
+        channel.fillSuperpages();
+        size_t pushed = 0;
+        if (auto available = channel.getTransferQueueAvailable()) {
+          auto count = mFreeRing->read(buffer.data(), std::min(size_t(available), buffer.size()));
+          for (size_t i = 0; i < count; ++i) {
+            // A superpage the ledger doesn't see as free is still in use, pushing it again would corrupt its data
+            if (mLedger.pushed(buffer[i].getOffset())) {
+              buffer[pushed++] = buffer[i];
+            }
+          }
+          if (pushed > 0) {
+            channel.pushSuperpages(buffer.data(), pushed);
+          }
+        }
+        auto popped = forwardArrivals(buffer);
+        if (pushed == 0 && popped == 0) {
+          channel.waitForReadySuperpage(std::chrono::microseconds(100));
+        }
+      }
+    }
+
+    /// Pops the arrived superpages, and passes the ones that were on the card to the readout thread
+    /// \return The amount of superpages popped
+    size_t forwardArrivals(std::vector<Superpage>& buffer)
+    {
+      auto popped = mChannel->popSuperpages(buffer.data(), buffer.size());
+      size_t forwarded = 0;
+      for (size_t i = 0; i < popped; ++i) {
+        auto& superpage = buffer[i];
+        // A duplicate is dropped, giving it to the consumer would return it twice
+        if (!mLedger.arrived(superpage.getOffset())) {
+          continue;
+        }
+        auto pushedTicks = superpage.getPushTimestamp();
+        if (pushedTicks != 0 && superpage.getTimestamp() >= pushedTicks) {
+          mArrivalLatencies.record(superpage.getTimestamp() - pushedTicks);
+        }
+        superpage.setUserData(reinterpret_cast<void*>(uintptr_t(mCycles.load(std::memory_order_relaxed))));
+        buffer[forwarded++] = superpage;
+      }
+      if (mReadoutRing->write(buffer.data(), forwarded) != forwarded) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Readout ring full"));
+      }
+      mDuplicated.store(mLedger.getDuplicated(), std::memory_order_relaxed);
+      return popped;
+    }
+
+    /// Stops and restarts the DMA, or recovers it. Stopping hands every pushed superpage back, so any still on the
+    /// card after the ready queue is popped are lost.
+    void cycle()
+    {
+      const auto cycles = mCycles.load(std::memory_order_relaxed) + 1;
+      const bool recover = mOptions.recoverEvery != 0 && cycles % mOptions.recoverEvery == 0;
+      if (recover) {
+        // Gives the superpages back like a stop, and restarts
+        mChannel->recover();
+        mRecoveries++;
+      } else {
+        mChannel->stopDma();
+      }
+      drainReadyQueue();
+      auto lost = mLedger.reconcile();
+      if (!lost.empty()) {
+        getLogger() << InfoLogger::Error << lost.size() << " superpage(s) lost in cycle " << cycles << endm;
+        for (auto offset : lost) {
+          // Back into circulation, so the run goes on with the full buffer
+          if (mFreeRing->write(Superpage(offset, mOptions.superpageSize)) != 1) {
+            BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Free ring full"));
+          }
+        }
+      }
+      mLost.store(mLedger.getLost(), std::memory_order_relaxed);
+      mCycles.store(cycles, std::memory_order_relaxed);
+      if (!recover) {
+        mChannel->startDma();
+      }
+    }
+
+    /// Passes everything in the ready queue to the readout thread
+    void drainReadyQueue()
+    {
+      std::vector<Superpage> buffer(mSuperpages);
+      while (forwardArrivals(buffer) != 0) {
+      }
+    }
+
+    /// Consumes the arrived superpages as the consumer model says, checks their data and gives them back
+    void runReadout()
+    {
+      std::vector<Superpage> buffer(mSuperpages);
+      LinkIntegrityMonitor integrity(mOptions.dmaPageSize);
+      uintptr_t generation = 0;
+      while (!mStop.load(std::memory_order_relaxed)) {
+        auto count = mReadoutRing->read(buffer.data(), buffer.size());
+        if (count == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+          continue;
+        }
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < count; ++i) {
+          auto& superpage = buffer[i];
+          mConsumer.consume(superpage.getReceived() / mOptions.dmaPageSize);
+          auto now = Utilities::getTimestampCounter();
+          if (superpage.getTimestamp() != 0 && now >= superpage.getTimestamp()) {
+            mReadoutLatencies.record(now - superpage.getTimestamp());
+          }
+
+          // The data generator starts its packet counters over when the DMA restarts
+          auto superpageGeneration = reinterpret_cast<uintptr_t>(superpage.getUserData());
+          if (superpageGeneration != generation) {
+            for (auto linkId : mLinkIds) {
+              integrity.resync(linkId);
+            }
+            generation = superpageGeneration;
+          }
+          if (!mOptions.noCheck) {
+            auto address = reinterpret_cast<const char*>(mBuffer->getAddress()) + superpage.getOffset();
+            if (integrity.checkSuperpage(address, superpage.getReceived()) != 0) {
+              mIntegrityErrors.store(integrity.getErrorCount(), std::memory_order_relaxed);
+            }
+          }
+          bytes += superpage.getReceived();
+          superpage = Superpage(superpage.getOffset(), mOptions.superpageSize);
+        }
+        mBytes.store(mBytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+        mReturned.store(mReturned.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        if (mFreeRing->write(buffer.data(), count) != count) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Free ring full"));
+        }
+      }
+      mIntegrity = integrity.getStatistics();
+    }
+
+    /// Samples the throughput and prints report lines until the time is up, a thread failed or SIGINT was given
+    void monitor()
+    {
+      const auto end = mStart + std::chrono::seconds(mOptions.seconds);
+      auto nextSample = mStart + SAMPLE_INTERVAL;
+      auto nextReport = mStart + std::chrono::seconds(mOptions.reportInterval);
+      uint64_t sampleBytes = 0;
+      uint64_t reportBytes = 0;
+      ThroughputStability reportStability;
+      auto format = b::format("  %-10s  %-10s  %-10s  %-10s  %-8s  %-6s  %-10s  %-10s\n");
+      cout << format % "Seconds" % "Gb/s" % "Min Gb/s" % "Max Gb/s" % "Cycles" % "Lost" % "Duplicated"
+          % "Errors";
+      while (!mStop.load(std::memory_order_relaxed) && !isSigInt()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= end) {
+          break;
+        }
+        if (now >= nextSample) {
+          auto bytes = mBytes.load(std::memory_order_relaxed);
+          auto gbps = toGbps(bytes - sampleBytes, std::chrono::duration<double>(SAMPLE_INTERVAL).count());
+          mStability.add(gbps);
+          reportStability.add(gbps);
+          sampleBytes = bytes;
+          nextSample += SAMPLE_INTERVAL;
+        }
+        if (now >= nextReport) {
+          auto bytes = mBytes.load(std::memory_order_relaxed);
+          cout << format % int64_t(std::chrono::duration<double>(now - mStart).count())
+              % (b::format("%.2f") % toGbps(bytes - reportBytes, double(mOptions.reportInterval))).str()
+              % (b::format("%.2f") % reportStability.min).str() % (b::format("%.2f") % reportStability.max).str()
+              % mCycles.load() % mLost.load() % mDuplicated.load() % mIntegrityErrors.load();
+          cout.flush();
+          reportBytes = bytes;
+          reportStability = ThroughputStability();
+          nextReport += std::chrono::seconds(mOptions.reportInterval);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+
+    void outputStats(const std::vector<std::unique_ptr<BarHammer>>& hammers)
+    {
+      const double seconds = std::chrono::duration<double>(mEnd - mStart).count();
+      const double ticks = double(mEndTicks - mStartTicks);
+      const double ticksPerMicrosecond = seconds > 0 ? ticks / (seconds * 1e6) : 0;
+      auto put = [](const std::string& label, const auto& value) {
+        cout << b::format("  %-28s  %s\n") % label % value;
+      };
+
+      cout << '\n';
+      put("Seconds", b::format("%.1f") % seconds);
+      put("Superpages", mReturned.load());
+      put("Average Gb/s", b::format("%.2f") % toGbps(mBytes.load(), seconds));
+      put("Sampled Gb/s mean", b::format("%.2f") % mStability.mean);
+      put("Sampled Gb/s stddev", b::format("%.2f") % mStability.getStandardDeviation());
+      put("Sampled Gb/s min", b::format("%.2f") % mStability.min);
+      put("Sampled Gb/s max", b::format("%.2f") % mStability.max);
+      put("Cycles", mCycles.load());
+      put("Recoveries", mRecoveries);
+      put("Lost superpages", mLedger.getLost());
+      put("Duplicated superpages", mLedger.getDuplicated());
+
+      uint64_t gaps = 0, dropped = 0, sizeErrors = 0;
+      for (const auto& link : mIntegrity) {
+        gaps += link.counterGaps;
+        dropped += link.dropped;
+        sizeErrors += link.sizeErrors;
+      }
+      put("Packet counter gaps", gaps);
+      put("Packets lost (lower bound)", dropped);
+      put("Packet size errors", sizeErrors);
+
+      if (ticksPerMicrosecond > 0) {
+        auto latencyFormat = b::format("  %-20s  %-12s  %-10s  %-10s  %-10s  %-10s  %-10s\n");
+        auto row = [&](const std::string& label, const LatencyHistogram& histogram, double ticksPerMicro) {
+          auto us = [&](uint64_t value) { return (b::format("%.1f") % (double(value) / ticksPerMicro)).str(); };
+          cout << latencyFormat % label % histogram.getCount() % us(histogram.getPercentile(50))
+              % us(histogram.getPercentile(99)) % us(histogram.getPercentile(99.9))
+              % us(histogram.getPercentile(99.99)) % us(histogram.getMax());
+        };
+        cout << '\n' << latencyFormat % "Latency (us)" % "Count" % "p50" % "p99" % "p99.9" % "p99.99" % "Max";
+        row("Push to arrival", mArrivalLatencies, ticksPerMicrosecond);
+        row("Arrival to readout", mReadoutLatencies, ticksPerMicrosecond);
+        if (!hammers.empty()) {
+          LatencyHistogram bar;
+          for (const auto& hammer : hammers) {
+            bar.merge(hammer->getLatencies());
+          }
+          row("BAR read", bar, hammers.front()->getTicksPerNanosecond() * 1000);
+        }
+      }
+      cout << '\n';
+    }
+
+    struct OptionsStruct
+    {
+        std::string links;
+        std::string loopbackModeString;
+        std::string consumer;
+        size_t bufferSize = 0;
+        size_t superpageSize = 0;
+        size_t dmaPageSize = 0;
+        uint64_t seconds = 0;
+        uint64_t cycleInterval = 0;
+        uint64_t recoverEvery = 0;
+        uint64_t reportInterval = 0;
+        int barThreads = 0;
+        bool generatorEnabled = true;
+        bool driverThread = false;
+        bool noCheck = false;
+    } mOptions;
+
+    size_t mSuperpages = 0;
+    Parameters::LinkMaskType mLinkIds;
+    std::unique_ptr<MemoryMappedFile> mBuffer;
+    std::shared_ptr<DmaChannelInterface> mChannel;
+
+    /// Superpages that arrived, from the pipeline thread to the readout thread
+    std::unique_ptr<SuperpageRing> mReadoutRing;
+    /// Superpages that were read out, from the readout thread back to the pipeline thread
+    std::unique_ptr<SuperpageRing> mFreeRing;
+
+    /// Set to stop the threads, when the time is up or one of them failed
+    std::atomic<bool> mStop { false };
+
+    /// Pipeline thread only
+    SoakLedger mLedger { 0, 1 };
+    LatencyHistogram mArrivalLatencies;
+    uint64_t mRecoveries = 0;
+
+    /// Readout thread only
+    ConsumerModel mConsumer;
+    LatencyHistogram mReadoutLatencies;
+    std::vector<LinkIntegrityStatistics> mIntegrity;
+
+    /// Counters for the report lines, written by one thread each
+    std::atomic<uint64_t> mBytes { 0 };
+    std::atomic<uint64_t> mReturned { 0 };
+    std::atomic<uint64_t> mCycles { 0 };
+    std::atomic<uint64_t> mLost { 0 };
+    std::atomic<uint64_t> mDuplicated { 0 };
+    std::atomic<uint64_t> mIntegrityErrors { 0 };
+
+    /// Monitor thread only
+    ThroughputStability mStability;
+
+    std::chrono::steady_clock::time_point mStart;
+    std::chrono::steady_clock::time_point mEnd;
+    uint64_t mStartTicks = 0;
+    uint64_t mEndTicks = 0;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramSoak().execute(argc, argv);
+}
@@ -0,0 +1,105 @@
+/// \file ProgramTrace.cxx
+/// \brief Utility that converts a DMA channel trace for timeline viewers
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include "CommandLineUtilities/Program.h"
+#include "CommandLineUtilities/TraceExport.h"
+#include "ExceptionInternal.h"
+#include "InfoLogger/InfoLogger.hxx"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+namespace po = boost::program_options;
+
+namespace {
+/// End InfoLogger message alias
+constexpr auto endm = InfoLogger::endm;
+
+/// Converts a trace written by DmaChannelInterface::dumpTrace(), e.g. with roc-bench-dma --trace-file, or copied from
+/// a log message, to the Chrome trace event format. The result opens in chrome://tracing and in the Perfetto UI.
+class ProgramTrace: public Program
+{
+  public:
+
+    virtual Description getDescription()
+    {
+      return {"Trace", "Convert a DMA channel trace to the Chrome trace event JSON format\n"
+          "The result opens in chrome://tracing and in the Perfetto UI (ui.perfetto.dev), with a track per link for "
+          "the superpages pushed, arrived and popped, and counters of the superpages on the card and in the ready "
+          "queue. The timestamp counter rate defaults to that of this host, so convert traces on the host they were "
+          "taken on, or give --ticks-per-us.",
+          "roc-bench-dma --id=12345 --trace-file=trace.txt && roc-trace --input=trace.txt --output=trace.json"};
+    }
+
+    virtual void addOptions(po::options_description& options)
+    {
+      options.add_options()
+          ("input",
+              po::value<std::string>(&mOptions.inputPath)->default_value("-"),
+              "File with the trace, '-' for the standard input")
+          ("output",
+              po::value<std::string>(&mOptions.outputPath)->default_value("-"),
+              "File to write the JSON to, '-' for the standard output")
+          ("ticks-per-us",
+              po::value<double>(&mOptions.ticksPerMicrosecond)->default_value(0),
+              "Rate of the timestamp counter of the host the trace was taken on. Give 0 to measure it on this host.");
+    }
+
+    virtual void run(const po::variables_map&)
+    {
+      if (mOptions.ticksPerMicrosecond < 0) {
+        throw ParameterException() << ErrorInfo::Message("Timestamp counter rate must be positive");
+      }
+
+      std::vector<TraceExport::Entry> entries;
+      if (mOptions.inputPath == "-") {
+        entries = TraceExport::parseDump(std::cin);
+      } else {
+        std::ifstream input(mOptions.inputPath);
+        if (!input) {
+          throw ParameterException() << ErrorInfo::Message("Failed to open input file")
+              << ErrorInfo::FileName(mOptions.inputPath);
+        }
+        entries = TraceExport::parseDump(input);
+      }
+      if (entries.empty()) {
+        getLogger() << InfoLogger::Warning << "No trace entries found in input" << endm;
+      }
+
+      auto ticksPerMicrosecond = mOptions.ticksPerMicrosecond;
+      if (ticksPerMicrosecond == 0) {
+        ticksPerMicrosecond = TraceExport::measureTicksPerMicrosecond(std::chrono::milliseconds(200));
+      }
+
+      if (mOptions.outputPath == "-") {
+        TraceExport::writeChromeTrace(std::cout, entries, ticksPerMicrosecond);
+      } else {
+        std::ofstream output(mOptions.outputPath);
+        if (!output) {
+          throw ParameterException() << ErrorInfo::Message("Failed to open output file")
+              << ErrorInfo::FileName(mOptions.outputPath);
+        }
+        TraceExport::writeChromeTrace(output, entries, ticksPerMicrosecond);
+        getLogger() << "Wrote " << entries.size() << " events to " << mOptions.outputPath << endm;
+      }
+    }
+
+  private:
+    struct OptionsStruct
+    {
+        std::string inputPath;
+        std::string outputPath;
+        double ticksPerMicrosecond = 0;
+    } mOptions;
+};
+} // Anonymous namespace
+
+int main(int argc, char** argv)
+{
+  return ProgramTrace().execute(argc, argv);
+}
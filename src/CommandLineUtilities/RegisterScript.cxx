@@ -0,0 +1,175 @@
+/// \file RegisterScript.cxx
+/// \brief Implementation of the RegisterScript class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/RegisterScript.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <boost/algorithm/string/trim.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace {
+
+[[noreturn]] void throwParseError(size_t line, const std::string& text, const std::string& message)
+{
+  BOOST_THROW_EXCEPTION(ParseException()
+      << ErrorInfo::Message("Register script line " + std::to_string(line) + ": " + message)
+      << ErrorInfo::String(text));
+}
+
+/// Parses a decimal or "0x" hexadecimal 32-bit number
+bool parseNumber(const std::string& string, uint32_t& value)
+{
+  const bool hex = string.size() > 2 && string[0] == '0' && (string[1] == 'x' || string[1] == 'X');
+  const auto digits = hex ? string.substr(2) : string;
+  if (digits.empty() || digits[0] == '-' || digits[0] == '+') {
+    return false;
+  }
+  try {
+    size_t end = 0;
+    auto number = std::stoull(digits, &end, hex ? 16 : 10);
+    if (end != digits.size() || number > 0xffffffffull) {
+      return false;
+    }
+    value = uint32_t(number);
+    return true;
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+} // Anonymous namespace
+
+RegisterScript RegisterScript::parse(std::istream& stream)
+{
+  RegisterScript script;
+  std::string text;
+  size_t lineNumber = 0;
+  while (std::getline(stream, text)) {
+    lineNumber++;
+    auto line = text.substr(0, text.find('#'));
+    boost::algorithm::trim(line);
+    if (line.empty()) {
+      continue;
+    }
+
+    std::istringstream words(line);
+    std::string command;
+    words >> command;
+    std::vector<uint32_t> arguments;
+    std::string word;
+    while (words >> word) {
+      uint32_t number;
+      if (!parseNumber(word, number)) {
+        throwParseError(lineNumber, text, "invalid number '" + word + "'");
+      }
+      arguments.push_back(number);
+    }
+
+    auto expectArguments = [&](size_t min, size_t max) {
+      if (arguments.size() < min || arguments.size() > max) {
+        throwParseError(lineNumber, text, "wrong amount of arguments for '" + command + "'");
+      }
+    };
+
+    Operation operation;
+    operation.line = lineNumber;
+    if (command == "read") {
+      expectArguments(1, 2);
+      operation.type = Operation::Type::Read;
+      operation.count = arguments.size() > 1 ? arguments[1] : 1;
+      if (operation.count == 0) {
+        throwParseError(lineNumber, text, "read count must be at least 1");
+      }
+    } else if (command == "write") {
+      expectArguments(2, 2);
+      operation.type = Operation::Type::Write;
+      operation.value = arguments[1];
+    } else if (command == "modify") {
+      expectArguments(3, 3);
+      operation.type = Operation::Type::Modify;
+      operation.value = arguments[1];
+      operation.mask = arguments[2];
+    } else if (command == "wait") {
+      expectArguments(1, 1);
+      operation.type = Operation::Type::Wait;
+      operation.duration = std::chrono::microseconds(arguments[0]);
+    } else {
+      throwParseError(lineNumber, text, "unknown operation '" + command + "'");
+    }
+
+    if (operation.type != Operation::Type::Wait) {
+      operation.address = arguments[0];
+      if (operation.address % 4 != 0) {
+        throwParseError(lineNumber, text, "address is not 32-bit aligned");
+      }
+    }
+    script.mOperations.push_back(operation);
+  }
+  return script;
+}
+
+auto RegisterScript::execute(RegisterReadWriteInterface& bar) const -> std::vector<ReadResult>
+{
+  std::vector<ReadResult> results;
+  std::vector<uint32_t> block;
+  for (size_t i = 0; i < mOperations.size(); ++i) {
+    const auto& operation = mOperations[i];
+    // Registers are indexed by 32 bits (4 bytes)
+    const int index = operation.address / 4;
+    switch (operation.type) {
+      case Operation::Type::Read: {
+        ReadResult result {operation.line, operation.address, std::vector<uint32_t>(operation.count)};
+        bar.readRegisters(index, result.values.data(), result.values.size());
+        results.push_back(std::move(result));
+        break;
+      }
+      case Operation::Type::Write: {
+        // The writes that follow to the next registers go in the same block
+        block.assign(1, operation.value);
+        while (i + 1 < mOperations.size() && mOperations[i + 1].type == Operation::Type::Write
+            && mOperations[i + 1].address == operation.address + block.size() * 4) {
+          block.push_back(mOperations[++i].value);
+        }
+        bar.writeRegisters(index, block.data(), block.size());
+        break;
+      }
+      case Operation::Type::Modify: {
+        auto value = bar.readRegister(index);
+        bar.writeRegister(index, (value & ~operation.mask) | (operation.value & operation.mask));
+        break;
+      }
+      case Operation::Type::Wait:
+        std::this_thread::sleep_for(operation.duration);
+        break;
+    }
+  }
+  return results;
+}
+
+void RegisterScript::writeJson(std::ostream& stream, const std::vector<ReadResult>& results)
+{
+  for (const auto& result : results) {
+    stream << "{\"line\":" << result.line << ",\"address\":" << result.address << ",\"values\":[";
+    for (size_t i = 0; i < result.values.size(); ++i) {
+      stream << (i ? "," : "") << result.values[i];
+    }
+    stream << "]}\n";
+  }
+}
+
+void RegisterScript::writeBinary(std::ostream& stream, const std::vector<ReadResult>& results)
+{
+  for (const auto& result : results) {
+    stream.write(reinterpret_cast<const char*>(result.values.data()), result.values.size() * sizeof(uint32_t));
+  }
+}
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
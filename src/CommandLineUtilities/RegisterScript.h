@@ -0,0 +1,94 @@
+/// \file RegisterScript.h
+/// \brief Definition of the RegisterScript class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_REGISTERSCRIPT_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_REGISTERSCRIPT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "ReadoutCard/RegisterReadWriteInterface.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Script of register operations, for roc-reg-batch. A script has one operation per line, addresses are in bytes and
+/// numbers may be decimal or hexadecimal with "0x":
+///
+///     read <address> [count]          Reads count consecutive registers (default 1)
+///     write <address> <value>         Writes a register
+///     modify <address> <value> <mask> Writes the bits of the value that are set in the mask, keeping the others
+///     wait <microseconds>             Sleeps
+///
+/// Everything after a '#' is a comment, and empty lines are skipped. The whole script is parsed before anything is
+/// executed, so a typo does not leave the card half configured.
+class RegisterScript
+{
+  public:
+    struct Operation
+    {
+        enum class Type
+        {
+          Read,
+          Write,
+          Modify,
+          Wait
+        };
+
+        Type type;
+        /// Line of the script, from 1
+        size_t line;
+        /// Byte address of the (first) register
+        uint32_t address = 0;
+        /// Amount of registers read
+        uint32_t count = 1;
+        uint32_t value = 0;
+        uint32_t mask = 0;
+        std::chrono::microseconds duration {0};
+    };
+
+    /// Values of a read
+    struct ReadResult
+    {
+        /// Line of the script
+        size_t line;
+        /// Byte address of the first register
+        uint32_t address;
+        std::vector<uint32_t> values;
+    };
+
+    /// Parses a script
+    /// \throw ParseException with the line number if a line is invalid
+    static RegisterScript parse(std::istream& stream);
+
+    /// Executes the script. Writes to consecutive registers are combined into a single block write, and the reads of a
+    /// range are a single block read.
+    /// \return Results of the reads, in order
+    std::vector<ReadResult> execute(RegisterReadWriteInterface& bar) const;
+
+    /// Writes the results of reads as JSON Lines, one object per read with the line, address and values
+    static void writeJson(std::ostream& stream, const std::vector<ReadResult>& results);
+
+    /// Writes the values of reads as raw 32-bit words in host byte order, one after another
+    static void writeBinary(std::ostream& stream, const std::vector<ReadResult>& results);
+
+    const std::vector<Operation>& getOperations() const
+    {
+      return mOperations;
+    }
+
+  private:
+    std::vector<Operation> mOperations;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_REGISTERSCRIPT_H_
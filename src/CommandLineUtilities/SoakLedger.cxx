@@ -0,0 +1,75 @@
+/// \file SoakLedger.cxx
+/// \brief Implementation of the SoakLedger class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/SoakLedger.h"
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+SoakLedger::SoakLedger(size_t superpages, size_t superpageSize)
+    : mSuperpageSize(superpageSize), mStates(superpages, State::Free)
+{
+  if (superpageSize == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Superpage size of 0"));
+  }
+}
+
+size_t SoakLedger::getIndex(size_t offset) const
+{
+  return (offset % mSuperpageSize == 0 && offset / mSuperpageSize < mStates.size()) ? offset / mSuperpageSize
+      : mStates.size();
+}
+
+bool SoakLedger::pushed(size_t offset)
+{
+  auto index = getIndex(offset);
+  if (index == mStates.size() || mStates[index] != State::Free) {
+    mBadPushes++;
+    return false;
+  }
+  mStates[index] = State::OnCard;
+  mOnCard++;
+  return true;
+}
+
+bool SoakLedger::arrived(size_t offset)
+{
+  auto index = getIndex(offset);
+  if (index == mStates.size() || mStates[index] != State::OnCard) {
+    mDuplicated++;
+    return false;
+  }
+  mStates[index] = State::Out;
+  mOnCard--;
+  return true;
+}
+
+void SoakLedger::returned(size_t offset)
+{
+  auto index = getIndex(offset);
+  if (index != mStates.size() && mStates[index] == State::Out) {
+    mStates[index] = State::Free;
+  }
+}
+
+std::vector<size_t> SoakLedger::reconcile()
+{
+  std::vector<size_t> lost;
+  for (size_t i = 0; i < mStates.size(); ++i) {
+    if (mStates[i] == State::OnCard) {
+      mStates[i] = State::Free;
+      lost.push_back(i * mSuperpageSize);
+    }
+  }
+  mLost += lost.size();
+  mOnCard = 0;
+  return lost;
+}
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,95 @@
+/// \file SoakLedger.h
+/// \brief Definition of the SoakLedger class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_SOAKLEDGER_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_SOAKLEDGER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+
+/// Keeps track of where every superpage of a buffer is, to find superpages the driver loses or hands out twice.
+/// The buffer is divided in superpages of equal size, told apart by their offset. A superpage is free, on the card
+/// after it was pushed, or out after it arrived, until the consumer returns it.
+///
+/// A superpage that arrives without being on the card is a duplicate. A superpage still on the card after a stopDma()
+/// and the popping of the ready queue is lost, since stopping hands back everything that was pushed. Split superpages,
+/// as made by the SuperpageFlushTimeout, are not supported.
+/// Not thread safe, the thread that pushes and pops should own it.
+class SoakLedger
+{
+  public:
+    /// \param superpages Amount of superpages in the buffer
+    /// \param superpageSize Size of the superpages
+    SoakLedger(size_t superpages, size_t superpageSize);
+
+    /// Records a push
+    /// \return False if the superpage was not free, which means the caller lost track of it
+    bool pushed(size_t offset);
+
+    /// Records an arrival
+    /// \return False if the superpage was not on the card: a duplicate, or an offset that is no superpage
+    bool arrived(size_t offset);
+
+    /// Records the return of an arrived superpage by the consumer
+    void returned(size_t offset);
+
+    /// Finds the superpages still on the card, after stopping DMA and popping the ready queue. They are counted as
+    /// lost and made free, since the stop released them from the card.
+    /// \return The offsets of the lost superpages
+    std::vector<size_t> reconcile();
+
+    /// Gets the amount of superpages on the card
+    size_t getOnCard() const
+    {
+      return mOnCard;
+    }
+
+    /// Gets the amount of superpages found lost by reconcile()
+    uint64_t getLost() const
+    {
+      return mLost;
+    }
+
+    /// Gets the amount of arrivals of superpages that were not on the card
+    uint64_t getDuplicated() const
+    {
+      return mDuplicated;
+    }
+
+    /// Gets the amount of pushes of superpages that were not free
+    uint64_t getBadPushes() const
+    {
+      return mBadPushes;
+    }
+
+  private:
+    enum class State : uint8_t
+    {
+      Free,
+      OnCard,
+      Out,
+    };
+
+    /// Gets the index of a superpage, or the amount of superpages if the offset is not one
+    size_t getIndex(size_t offset) const;
+
+    size_t mSuperpageSize;
+    std::vector<State> mStates;
+    size_t mOnCard = 0;
+    uint64_t mLost = 0;
+    uint64_t mDuplicated = 0;
+    uint64_t mBadPushes = 0;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_SOAKLEDGER_H_
@@ -0,0 +1,170 @@
+/// \file TraceExport.cxx
+/// \brief Implementation of functions to convert DMA channel traces for timeline viewers.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "CommandLineUtilities/TraceExport.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <boost/format.hpp>
+#include "Utilities/Timestamp.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace TraceExport {
+namespace {
+
+constexpr TraceRing::Event ALL_EVENTS[] = {TraceRing::Event::StartDma, TraceRing::Event::StopDma,
+    TraceRing::Event::Reset, TraceRing::Event::Pushed, TraceRing::Event::Arrived, TraceRing::Event::Popped,
+    TraceRing::Event::ReadyQueueFull, TraceRing::Event::Flushed, TraceRing::Event::Dropped, TraceRing::Event::Recover,
+    TraceRing::Event::NextRun};
+
+bool eventFromString(const std::string& string, TraceRing::Event& event)
+{
+  for (auto candidate : ALL_EVENTS) {
+    if (string == TraceRing::toString(candidate)) {
+      event = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Events concerning the whole channel rather than a link
+bool isChannelEvent(TraceRing::Event event)
+{
+  return event == TraceRing::Event::StartDma || event == TraceRing::Event::StopDma
+      || event == TraceRing::Event::Reset || event == TraceRing::Event::Recover
+      || event == TraceRing::Event::NextRun;
+}
+
+/// Superpages a link has on the card and in the ready queue
+struct LinkState
+{
+    /// Timestamps of the superpages pushed and not arrived yet, oldest first
+    std::deque<double> pushed;
+    int64_t ready = 0;
+};
+
+} // Anonymous namespace
+
+std::vector<Entry> parseDump(std::istream& stream)
+{
+  std::vector<Entry> entries;
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream lineStream(line);
+    uint64_t index;
+    std::string name;
+    std::string value;
+    Entry entry;
+    if (!(lineStream >> index >> entry.ticks >> name >> entry.link >> value) || value.compare(0, 2, "0x") != 0
+        || !eventFromString(name, entry.event)) {
+      continue;
+    }
+    try {
+      entry.value = std::stoull(value, nullptr, 16);
+    } catch (const std::exception&) {
+      continue;
+    }
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
+void writeChromeTrace(std::ostream& stream, const std::vector<Entry>& entries, double ticksPerMicrosecond)
+{
+  std::map<uint32_t, LinkState> links;
+  const int64_t first = entries.empty() ? 0 : entries.front().ticks;
+  bool comma = false;
+  auto separator = [&]{
+    stream << (comma ? ",\n" : "\n");
+    comma = true;
+  };
+  // Thread 0 is the channel, the links are the threads after it
+  auto tid = [](uint32_t link) { return uint64_t(link) + 1; };
+
+  stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  separator();
+  stream << R"({"name":"process_name","ph":"M","pid":0,"tid":0,"args":{"name":"DMA channel"}})";
+  separator();
+  stream << R"({"name":"thread_name","ph":"M","pid":0,"tid":0,"args":{"name":"Channel"}})";
+
+  for (const auto& entry : entries) {
+    const double timestamp = double(entry.ticks - first) / ticksPerMicrosecond;
+    const auto ts = (boost::format("%.3f") % timestamp).str();
+
+    if (isChannelEvent(entry.event)) {
+      separator();
+      stream << "{\"name\":\"" << TraceRing::toString(entry.event) << "\",\"ph\":\"i\",\"s\":\"g\",\"ts\":" << ts
+          << ",\"pid\":0,\"tid\":0,\"args\":{\"value\":" << entry.value << "}}";
+      continue;
+    }
+
+    auto inserted = links.insert({entry.link, LinkState()});
+    auto& link = inserted.first->second;
+    if (inserted.second) {
+      separator();
+      stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid(entry.link)
+          << ",\"args\":{\"name\":\"Link " << entry.link << "\"}}";
+    }
+
+    std::string args;
+    switch (entry.event) {
+      case TraceRing::Event::Pushed:
+        link.pushed.push_back(timestamp);
+        args = (boost::format("\"offset\":\"0x%x\"") % entry.value).str();
+        break;
+      case TraceRing::Event::Arrived:
+        // A link fills its superpages in the order they were pushed
+        args = (boost::format("\"received\":%d") % entry.value).str();
+        if (!link.pushed.empty()) {
+          args += (boost::format(",\"latency_us\":%.3f") % (timestamp - link.pushed.front())).str();
+          link.pushed.pop_front();
+        }
+        link.ready++;
+        break;
+      case TraceRing::Event::Flushed:
+        args = (boost::format("\"received\":%d") % entry.value).str();
+        link.ready++;
+        break;
+      case TraceRing::Event::Popped:
+      case TraceRing::Event::Dropped:
+        args = (boost::format("\"offset\":\"0x%x\"") % entry.value).str();
+        // The trace may start with superpages that arrived before it
+        link.ready = std::max<int64_t>(link.ready - 1, 0);
+        break;
+      default:
+        args = (boost::format("\"value\":%d") % entry.value).str();
+        break;
+    }
+
+    separator();
+    stream << "{\"name\":\"" << TraceRing::toString(entry.event) << "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << ts
+        << ",\"pid\":0,\"tid\":" << tid(entry.link) << ",\"args\":{" << args << "}}";
+    separator();
+    stream << "{\"name\":\"Link " << entry.link << " superpages\",\"ph\":\"C\",\"ts\":" << ts
+        << ",\"pid\":0,\"args\":{\"card\":" << link.pushed.size() << ",\"ready\":" << link.ready << "}}";
+  }
+  stream << "\n]}\n";
+}
+
+double measureTicksPerMicrosecond(std::chrono::milliseconds duration)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto startTicks = Utilities::getTimestampCounter();
+  std::this_thread::sleep_for(duration);
+  auto ticks = Utilities::getTimestampCounter() - startTicks;
+  auto microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  return double(ticks) / microseconds;
+}
+
+} // namespace TraceExport
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,53 @@
+/// \file TraceExport.h
+/// \brief Definition of functions to convert DMA channel traces for timeline viewers.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_TRACEEXPORT_H_
+#define ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_TRACEEXPORT_H_
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "TraceRing.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace CommandLineUtilities {
+namespace TraceExport {
+
+/// An event of a trace, as written by DmaChannelInterface::dumpTrace()
+struct Entry
+{
+    /// Timestamp counter ticks relative to the most recent event of the dump
+    int64_t ticks;
+    TraceRing::Event event;
+    uint32_t link;
+    uint64_t value;
+};
+
+/// Parses a trace written by DmaChannelInterface::dumpTrace(). Other lines, such as the header or the lines of a log
+/// file the trace was logged in, are skipped.
+std::vector<Entry> parseDump(std::istream& stream);
+
+/// Writes the entries in the Chrome trace event JSON format, which chrome://tracing and the Perfetto UI open.
+/// Every link gets a track with its pushed, arrived, popped, flushed and dropped superpages, and counter tracks with
+/// the amount of superpages it has on the card and in the ready queue. The DMA start, stop, reset and recover events
+/// are instant events across all tracks.
+/// \param stream Stream to write to
+/// \param entries Entries of the trace, oldest first
+/// \param ticksPerMicrosecond Rate of the timestamp counter of the host the trace was taken on
+void writeChromeTrace(std::ostream& stream, const std::vector<Entry>& entries, double ticksPerMicrosecond);
+
+/// Measures the rate of the timestamp counter against the steady clock
+/// \param duration Duration of the measurement
+double measureTicksPerMicrosecond(std::chrono::milliseconds duration);
+
+} // namespace TraceExport
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_COMMANDLINEUTILITIES_TRACEEXPORT_H_
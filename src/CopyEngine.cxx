@@ -0,0 +1,234 @@
+/// \file CopyEngine.cxx
+/// \brief Implementation of the CopyEngine class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/CopyEngine.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+// Definitions of the DSA specification, as in the kernel's linux/idxd.h, which older kernels don't have
+constexpr uint8_t DSA_OPCODE_MEMMOVE = 0x03;
+constexpr uint32_t DSA_FLAG_CRAV = 0x0004; ///< Completion record address valid
+constexpr uint32_t DSA_FLAG_RCR = 0x0008; ///< Request completion record
+constexpr uint32_t DSA_FLAG_CC = 0x0100; ///< Destination writes allocate in the cache
+constexpr uint8_t DSA_STATUS_MASK = 0x7f;
+constexpr uint8_t DSA_STATUS_NONE = 0;
+constexpr uint8_t DSA_STATUS_SUCCESS = 1;
+constexpr uint8_t DSA_STATUS_PAGE_FAULT = 3;
+constexpr size_t PORTAL_SIZE = 4096;
+
+struct alignas(64) DsaDescriptor
+{
+    uint32_t pasid;
+    uint32_t flagsAndOpcode;
+    uint64_t completionAddress;
+    uint64_t source;
+    uint64_t destination;
+    uint32_t transferSize;
+    uint16_t interruptHandle;
+    uint16_t reserved;
+    uint8_t operationSpecific[24];
+};
+static_assert(sizeof(DsaDescriptor) == 64, "DSA descriptors are 64 bytes");
+
+struct alignas(32) DsaCompletionRecord
+{
+    volatile uint8_t status;
+    uint8_t result;
+    uint16_t reserved;
+    uint32_t bytesCompleted;
+    uint64_t faultAddress;
+    uint8_t operationSpecific[16];
+};
+static_assert(sizeof(DsaCompletionRecord) == 32, "DSA completion records are 32 bytes");
+
+/// Gets the amount of descriptors a dedicated work queue holds, from its sysfs attributes
+/// \return The size, or 0 if the queue is not a dedicated user queue
+size_t getWorkQueueSize(const std::string& workQueuePath)
+{
+  const auto sysfs = "/sys/bus/dsa/devices/" + boost::filesystem::path(workQueuePath).filename().string();
+  std::string mode;
+  size_t size = 0;
+  std::ifstream(sysfs + "/mode") >> mode;
+  std::ifstream(sysfs + "/size") >> size;
+  return (mode == "dedicated") ? size : 0;
+}
+
+#if defined(__x86_64__)
+/// Writes a 64-byte descriptor to the portal in one non-posted write
+inline void movdir64b(void* portal, const void* descriptor)
+{
+  asm volatile(".byte 0x66, 0x0f, 0x38, 0xf8, 0x02" : : "a" (portal), "d" (descriptor) : "memory");
+}
+#endif
+
+} // Anonymous namespace
+
+struct CopyEngine::Slot
+{
+    DsaDescriptor descriptor;
+    DsaCompletionRecord completion;
+    char* destination;
+    const char* source;
+    size_t size;
+    uint64_t tag;
+};
+
+constexpr size_t CopyEngine::QUEUE_DEPTH;
+
+CopyEngine::CopyEngine(const std::string& workQueuePath)
+    : mFileDescriptor(-1), mPortal(nullptr), mSlots(nullptr), mDepth(QUEUE_DEPTH), mSubmitted(0), mReturned(0),
+      mFallbackCount(0)
+{
+  void* memory = nullptr;
+  if (posix_memalign(&memory, alignof(Slot), sizeof(Slot) * QUEUE_DEPTH) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not allocate copy engine queue"));
+  }
+  std::memset(memory, 0, sizeof(Slot) * QUEUE_DEPTH);
+  mSlots = static_cast<Slot*>(memory);
+
+#if defined(__x86_64__)
+  if (workQueuePath.empty()) {
+    return;
+  }
+  const auto workQueueSize = getWorkQueueSize(workQueuePath);
+  if (workQueueSize == 0) {
+    return;
+  }
+  mFileDescriptor = open(workQueuePath.c_str(), O_RDWR);
+  if (mFileDescriptor == -1) {
+    return;
+  }
+  mPortal = mmap(nullptr, PORTAL_SIZE, PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFileDescriptor, 0);
+  if (mPortal == MAP_FAILED) {
+    mPortal = nullptr;
+    close(mFileDescriptor);
+    mFileDescriptor = -1;
+    return;
+  }
+  // Submitting more than the queue holds would drop descriptors, since a dedicated queue gives no feedback
+  mDepth = std::min(QUEUE_DEPTH, workQueueSize);
+#else
+  (void) workQueuePath;
+#endif
+}
+
+CopyEngine::~CopyEngine()
+{
+  while (getInFlight() > 0) {
+    uint64_t tags[QUEUE_DEPTH];
+    poll(tags, QUEUE_DEPTH);
+  }
+  if (mPortal != nullptr) {
+    munmap(mPortal, PORTAL_SIZE);
+  }
+  if (mFileDescriptor != -1) {
+    close(mFileDescriptor);
+  }
+  free(mSlots);
+}
+
+bool CopyEngine::submit(void* destination, const void* source, size_t size, uint64_t tag)
+{
+  if (getInFlight() >= mDepth) {
+    return false;
+  }
+  auto& slot = mSlots[mSubmitted % QUEUE_DEPTH];
+  slot.destination = static_cast<char*>(destination);
+  slot.source = static_cast<const char*>(source);
+  slot.size = size;
+  slot.tag = tag;
+
+  // The DSA takes at most 4 GiB minus one per descriptor, larger copies are left to the CPU
+  if (isHardware() && size > 0 && size <= UINT32_MAX) {
+    submitToDevice(slot);
+  } else {
+    std::memcpy(destination, source, size);
+    slot.completion.status = DSA_STATUS_SUCCESS;
+  }
+  mSubmitted++;
+  return true;
+}
+
+void CopyEngine::submitToDevice(Slot& slot)
+{
+#if defined(__x86_64__)
+  slot.completion.status = DSA_STATUS_NONE;
+  slot.completion.bytesCompleted = 0;
+  std::memset(&slot.descriptor, 0, sizeof(slot.descriptor));
+  slot.descriptor.flagsAndOpcode = (uint32_t(DSA_OPCODE_MEMMOVE) << 24) | DSA_FLAG_CRAV | DSA_FLAG_RCR | DSA_FLAG_CC;
+  slot.descriptor.completionAddress = reinterpret_cast<uint64_t>(&slot.completion);
+  slot.descriptor.source = reinterpret_cast<uint64_t>(slot.source);
+  slot.descriptor.destination = reinterpret_cast<uint64_t>(slot.destination);
+  slot.descriptor.transferSize = slot.size;
+  // The device must see the cleared completion record before the descriptor
+  std::atomic_thread_fence(std::memory_order_release);
+  asm volatile("sfence" : : : "memory");
+  movdir64b(mPortal, &slot.descriptor);
+#else
+  (void) slot;
+#endif
+}
+
+bool CopyEngine::isDone(Slot& slot)
+{
+  const auto status = slot.completion.status & DSA_STATUS_MASK;
+  if (status == DSA_STATUS_NONE) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (status != DSA_STATUS_SUCCESS) {
+    // On a page fault the DSA reports how far it got, other errors are redone from the start
+    const size_t done = (status == DSA_STATUS_PAGE_FAULT) ? std::min<size_t>(slot.completion.bytesCompleted, slot.size)
+        : 0;
+    std::memcpy(slot.destination + done, slot.source + done, slot.size - done);
+    slot.completion.status = DSA_STATUS_SUCCESS;
+    mFallbackCount++;
+  }
+  return true;
+}
+
+size_t CopyEngine::poll(uint64_t* tags, size_t max)
+{
+  size_t count = 0;
+  while (count < max && mReturned != mSubmitted) {
+    auto& slot = mSlots[mReturned % QUEUE_DEPTH];
+    if (!isDone(slot)) {
+      break;
+    }
+    tags[count++] = slot.tag;
+    mReturned++;
+  }
+  return count;
+}
+
+size_t CopyEngine::getInFlight() const
+{
+  return mSubmitted - mReturned;
+}
+
+bool CopyEngine::isHardware() const
+{
+  return mPortal != nullptr;
+}
+
+uint64_t CopyEngine::getFallbackCount() const
+{
+  return mFallbackCount;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -8,6 +8,7 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "Crorc.h"
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
@@ -21,6 +22,7 @@
 #include "Crorc/Constants.h"
 #include "ExceptionInternal.h"
 #include "ReadoutCard/RegisterReadWriteInterface.h"
+#include "Utilities/Wait.h"
 
 using namespace std::chrono_literals;
 using std::this_thread::sleep_for;
@@ -49,6 +51,13 @@ int roundPowerOf2(int number)
   return (1 << logi2(number));
 }
 
+/// Time the DDL gets to take a command or answer it
+constexpr auto DDL_RESPONSE_TIMEOUT = std::chrono::microseconds(AliceO2::roc::Ddl::RESPONSE_TIME);
+/// Time the DDL waits busy-wait before backing off to sleeping
+constexpr auto DDL_SPIN_TIME = std::chrono::microseconds(20);
+/// Maximum interval between polls of the DDL waits once sleeping
+constexpr auto DDL_MAX_SLEEP = std::chrono::microseconds(50);
+
 // Translations of old macros
 auto ST_DEST = [](auto fw) {return ((unsigned short)((fw) & 0xf));};
 auto mask = [](auto a, auto b) {return a & b;};
@@ -65,7 +74,6 @@ namespace Flash
 {
 namespace
 {
-constexpr int MAX_WAIT = 1000000;
 constexpr int REGISTER_DATA_STATUS = Rorc::Flash::IFDSR;
 constexpr int REGISTER_ADDRESS = Rorc::Flash::IADR;
 constexpr int REGISTER_READY = Rorc::Flash::LRD;
@@ -91,85 +99,107 @@ constexpr uint32_t ADDRESS_END = 0x01460000;
 constexpr uint32_t BLOCK_SIZE = 0x010000;
 constexpr size_t MAX_WORDS = 4616222;
 
-/// Writes and sleeps
-template <typename SleepTime>
-void writeSleep(RegisterReadWriteInterface& bar0, int index, int value, SleepTime sleepTime)
+/// Maximum time for the flash interface to take a command
+constexpr auto READY_TIMEOUT = 10ms;
+/// Maximum time for the flash to finish an operation. Erasing a block is the slowest, at up to a few seconds.
+constexpr auto STATUS_TIMEOUT = 5s;
+/// Amount of words of a buffered program command, the most the flash takes at once
+constexpr int BUFFER_WORDS = 32;
+
+/// Waits until the flash interface took the last command
+void waitReady(RegisterReadWriteInterface& bar0)
 {
-  bar0.writeRegister(index, value);
-  sleep_for(sleepTime);
+  if (!Utilities::pollWithBackoff([&]{ return bar0.readRegister(REGISTER_READY) != 0; }, READY_TIMEOUT, 100ns,
+      10us)) {
+    BOOST_THROW_EXCEPTION(TimeoutException() << ErrorInfo::Message("Timed out waiting on flash interface"));
+  }
 }
 
-/// Writes to F_IFDSR and sleeps
-template <typename SleepTime = std::chrono::microseconds>
-void writeStatusSleep(RegisterReadWriteInterface& bar0, int value, SleepTime sleepTime = 10us)
+/// Writes to F_IFDSR and waits until the flash interface took it
+void writeStatusWait(RegisterReadWriteInterface& bar0, uint32_t value)
 {
-  writeSleep(bar0, REGISTER_DATA_STATUS, value, sleepTime);
+  bar0.writeRegister(REGISTER_DATA_STATUS, value);
+  waitReady(bar0);
 }
 
 unsigned readStatus(RegisterReadWriteInterface& bar0)
 {
-  writeStatusSleep(bar0, MAGIC_VALUE_1, 1us);
+  writeStatusWait(bar0, MAGIC_VALUE_1);
   return bar0.readRegister(REGISTER_ADDRESS);
 }
 
 uint32_t init(RegisterReadWriteInterface& bar0, uint32_t address)
 {
   // Clear Status register
-  writeStatusSleep(bar0, MAGIC_VALUE_2, 100us);
+  writeStatusWait(bar0, MAGIC_VALUE_2);
   // Set ASYNCH mode (Configuration Register 0xBDDF)
-  writeStatusSleep(bar0, MAGIC_VALUE_3);
-  writeStatusSleep(bar0, MAGIC_VALUE_4);
-  writeStatusSleep(bar0, MAGIC_VALUE_5);
+  writeStatusWait(bar0, MAGIC_VALUE_3);
+  writeStatusWait(bar0, MAGIC_VALUE_4);
+  writeStatusWait(bar0, MAGIC_VALUE_5);
   // Read Status register
-  writeStatusSleep(bar0, address, 10us);
-  writeStatusSleep(bar0, MAGIC_VALUE_6);
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, MAGIC_VALUE_6);
   return readStatus(bar0);
 }
 
+/// Waits until the flash reports it is done with the last operation
 void checkStatus(RegisterReadWriteInterface& channel)
 {
-  for (int i = 0; i < MAX_WAIT; ++i) {
-    if (readStatus(channel) == MAGIC_VALUE_0) {
-      return;
-    }
-    sleep_for(100us);
+  if (!Utilities::pollWithBackoff([&]{ return readStatus(channel) == MAGIC_VALUE_0; }, STATUS_TIMEOUT, 1us, 1ms)) {
+    BOOST_THROW_EXCEPTION(TimeoutException() << ErrorInfo::Message("Bad flash status"));
   }
-  BOOST_THROW_EXCEPTION(TimeoutException() << ErrorInfo::Message("Bad flash status"));
 }
 
 void unlockBlock(RegisterReadWriteInterface& bar0, uint32_t address)
 {
-//  writeStatusSequence(bar0, 10us, {MAGIC_VALUE_3, address, MAGIC_VALUE_4, MAGIC_VALUE_7});
-  writeStatusSleep(bar0, MAGIC_VALUE_3);
-  writeStatusSleep(bar0, address);
-  writeStatusSleep(bar0, MAGIC_VALUE_4);
-  writeStatusSleep(bar0, MAGIC_VALUE_7);
+  writeStatusWait(bar0, MAGIC_VALUE_3);
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, MAGIC_VALUE_4);
+  writeStatusWait(bar0, MAGIC_VALUE_7);
   checkStatus(bar0);
 }
 
 void eraseBlock(RegisterReadWriteInterface& bar0, uint32_t address)
 {
-  writeStatusSleep(bar0, address);
-  writeStatusSleep(bar0, address);
-  writeStatusSleep(bar0, MAGIC_VALUE_8);
-  writeStatusSleep(bar0, MAGIC_VALUE_7);
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, MAGIC_VALUE_8);
+  writeStatusWait(bar0, MAGIC_VALUE_7);
   checkStatus(bar0);
 }
 
-/// Currently unused, but we'll keep it as "documentation"
+/// Currently unused, since programming uses buffered writes, but we'll keep it as "documentation"
 void writeWord(RegisterReadWriteInterface& bar0, uint32_t address, int value)
 {
-  writeStatusSleep(bar0, address);
-  writeStatusSleep(bar0, MAGIC_VALUE_9);
-  writeStatusSleep(bar0, value);
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, MAGIC_VALUE_9);
+  writeStatusWait(bar0, value);
+  checkStatus(bar0);
+}
+
+/// Programs up to BUFFER_WORDS words with one buffered program command
+void writeBuffer(RegisterReadWriteInterface& bar0, uint32_t address, const uint32_t* words, int count)
+{
+  writeStatusWait(bar0, address);
+  // Set buffer program
+  writeStatusWait(bar0, MAGIC_VALUE_11);
+  checkStatus(bar0);
+  // Amount of words - 1
+  writeStatusWait(bar0, MAGIC_VALUE_13 + (count - 1));
+  for (int i = 0; i < count; ++i) {
+    writeStatusWait(bar0, address + i);
+    writeStatusWait(bar0, MAGIC_VALUE_13 + words[i]);
+  }
+  // Confirm, and wait until the buffer is programmed
+  writeStatusWait(bar0, MAGIC_VALUE_7);
   checkStatus(bar0);
 }
 
 /// Reads a 16-bit flash word and writes it into the given buffer
 void readWord(RegisterReadWriteInterface& bar0, uint32_t address, char *data)
 {
-  writeStatusSleep(bar0, address);
-  writeStatusSleep(bar0, MAGIC_VALUE_10);
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, MAGIC_VALUE_10);
 
   uint32_t stat = readStatus(bar0);
   data[0] = (stat & 0xFF00) >> 8;
@@ -181,9 +211,9 @@ void readRange(RegisterReadWriteInterface& bar0, int addressFlash, int wordNumbe
     uint32_t address = i;
     address = 0x01000000 | address;
 
-    writeStatusSleep(bar0, address, 50us);
-    writeStatusSleep(bar0, MAGIC_VALUE_10, 50us);
-    writeStatusSleep(bar0, MAGIC_VALUE_1, 50us);
+    writeStatusWait(bar0, address);
+    writeStatusWait(bar0, MAGIC_VALUE_10);
+    writeStatusWait(bar0, MAGIC_VALUE_1);
 
     uint32_t status = bar0.readRegister(REGISTER_ADDRESS);
     uint32_t status2 = bar0.readRegister(REGISTER_READY);
@@ -192,12 +222,37 @@ void readRange(RegisterReadWriteInterface& bar0, int addressFlash, int wordNumbe
   }
 }
 
-void wait(RegisterReadWriteInterface& channel) {
-  int status = 0;
-  while (status == 0) {
-    status = channel.readRegister(REGISTER_READY);
+/// Puts the flash in read array mode, in which it stays until the next command, so the words can be read with only
+/// an address and a read
+void startReadArray(RegisterReadWriteInterface& bar0, uint32_t address)
+{
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, MAGIC_VALUE_10);
+}
+
+/// Reads a word in read array mode
+uint16_t readArrayWord(RegisterReadWriteInterface& bar0, uint32_t address)
+{
+  writeStatusWait(bar0, address);
+  writeStatusWait(bar0, MAGIC_VALUE_1);
+  return bar0.readRegister(REGISTER_ADDRESS) & 0xffff;
+}
+
+/// Reads the words of a flash file, every word is on its own 'line' in the file
+std::vector<uint32_t> readFile(const std::string& dataFilePath)
+{
+  std::ifstream ifstream { dataFilePath };
+  if (!ifstream.is_open()) {
+    BOOST_THROW_EXCEPTION(
+        Exception() << ErrorInfo::Message("Failed to open file") << ErrorInfo::FileName(dataFilePath));
   }
-  sleep_for(1us);
+  std::vector<uint32_t> words;
+  words.reserve(MAX_WORDS);
+  int word;
+  while (ifstream >> word) {
+    words.push_back(word);
+  }
+  return words;
 }
 } // Anonymous namespace
 } // namespace Flash
@@ -207,8 +262,45 @@ void readFlashRange(RegisterReadWriteInterface& channel, int addressFlash, int w
   Flash::readRange(channel, addressFlash, wordNumber, out);
 }
 
+void readFlashWords(RegisterReadWriteInterface& bar0, int addressFlash, uint16_t* words, size_t count)
+{
+  if (count == 0) {
+    return;
+  }
+  uint32_t address = Flash::ADDRESS_START | addressFlash;
+  Flash::startReadArray(bar0, address);
+  for (size_t i = 0; i < count; ++i) {
+    words[i] = Flash::readArrayWord(bar0, address + i);
+  }
+}
+
+boost::optional<FlashMismatch> verifyFlash(RegisterReadWriteInterface& bar0, std::string dataFilePath,
+    int addressFlash, const std::atomic<bool>* interrupt)
+{
+  auto expected = Flash::readFile(dataFilePath);
+
+  // Read in chunks, so it can stop early at an interrupt or a mismatch
+  constexpr size_t CHUNK_WORDS = 4096;
+  std::vector<uint16_t> actual(CHUNK_WORDS);
+  for (size_t offset = 0; offset < expected.size(); offset += CHUNK_WORDS) {
+    if (interrupt != nullptr && interrupt->load(std::memory_order_relaxed)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Flash verification interrupted"));
+    }
+    auto count = std::min(CHUNK_WORDS, expected.size() - offset);
+    readFlashWords(bar0, addressFlash + offset, actual.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      if (actual[i] != uint16_t(expected[offset + i])) {
+        return FlashMismatch{offset + i, uint16_t(expected[offset + i]), actual[i]};
+      }
+    }
+  }
+  return boost::none;
+}
+
 /// Based on "pdaCrorcFlashProgrammer.c"
 /// I don't really understand what it does.
+/// Instead of sleeping a fixed time after every command like the original, it polls the ready bit of the flash
+/// interface and the status of the flash, with timeouts.
 void programFlash(RegisterReadWriteInterface& channel, std::string dataFilePath, int addressFlash, std::ostream& out,
     const std::atomic<bool>* interrupt)
 {
@@ -221,23 +313,8 @@ void programFlash(RegisterReadWriteInterface& channel, std::string dataFilePath,
     }
   };
 
-  auto writeStatusWait = [&](int value) {
-    channel.writeRegister(Flash::REGISTER_DATA_STATUS, value);
-    Flash::wait(channel);
-  };
-
-  auto readWait = [&](int index) {
-    uint32_t value = channel.readRegister(index);
-    Flash::wait(channel);
-    return value;
-  };
-
-  // Open file
-  std::ifstream ifstream { dataFilePath };
-  if (!ifstream.is_open()) {
-    BOOST_THROW_EXCEPTION(
-        Exception() << ErrorInfo::Message("Failed to open file") << ErrorInfo::FileName(dataFilePath));
-  }
+  // Read the whole file first, so a bad file does not leave the flash erased halfway
+  auto words = Flash::readFile(dataFilePath);
 
   try {
     // Initiate flash: clear status register, set asynch mode, read status reg.
@@ -266,69 +343,28 @@ void programFlash(RegisterReadWriteInterface& channel, std::string dataFilePath,
     // Write data
     out << "\nWriting\n";
 
-    int numberOfLinesRead = 0;
-    int stop = 0;
-    int maxCount = 0;
     address = Flash::ADDRESS_START;
-
     if (addressFlash != 0) {
       address = Flash::ADDRESS_START | addressFlash;
     }
 
-    while (stop != 1) {
+    size_t written = 0;
+    size_t nextProgress = 0;
+    while (written < words.size()) {
       checkInterrupt();
-      writeStatusWait(address);
-      // Set buffer program
-      writeStatusWait(Flash::MAGIC_VALUE_11);
-      Flash::checkStatus(channel);
-      // Write 32 words (31+1) (31 0x1f)
-      writeStatusWait(Flash::MAGIC_VALUE_12);
-
-      // Read 32 words from file
-      // Every word is on its own 'line' in the file
-      for (int j = 0; j < 32; j++) {
-        checkInterrupt();
-
-        int hex;
-        if (!(ifstream >> hex)) {
-          stop = 1;
-          break;
-        }
-
-        writeStatusWait(address);
-        writeStatusWait(Flash::MAGIC_VALUE_13 + hex);
-
-        address++;
-        numberOfLinesRead++;
-        if (numberOfLinesRead % 1000 == 0) {
-          float perc = ((float) numberOfLinesRead / Flash::MAX_WORDS) * 100.0;
-          out << format("\r  Progress  %1.1f%%") % perc << std::flush;
-        }
-      }
-
-      writeStatusWait(Flash::MAGIC_VALUE_7);
-      writeStatusWait(Flash::MAGIC_VALUE_1);
-
-      status = channel.readRegister(Flash::REGISTER_ADDRESS);
-      while (status != 0x80) {
-        checkInterrupt();
-
-        writeStatusWait(Flash::MAGIC_VALUE_1);
-        status = readWait(Flash::REGISTER_ADDRESS);
-
-        maxCount++;
-        if (maxCount == 5000000) {
-          BOOST_THROW_EXCEPTION(Exception()
-              << ErrorInfo::Message("Flash was stuck")
-              << ErrorInfo::Address(address));
-        }
+      int count = std::min<size_t>(Flash::BUFFER_WORDS, words.size() - written);
+      Flash::writeBuffer(channel, address, &words[written], count);
+      address += count;
+      written += count;
+
+      if (written >= nextProgress) {
+        out << format("\r  Progress  %1.1f%%") % ((double(written) / double(words.size())) * 100.0) << std::flush;
+        nextProgress += 16384;
       }
-      Flash::checkStatus(channel);
     }
-    out << format("\nCompleted programming %d words\n") % numberOfLinesRead;
+    out << format("\nCompleted programming %d words\n") % written;
     // READ STATUS REG
-    channel.writeRegister(Flash::REGISTER_DATA_STATUS, Flash::MAGIC_VALUE_6);
-    sleep_for(1us);
+    Flash::writeStatusWait(channel, Flash::MAGIC_VALUE_6);
     Flash::checkStatus(channel);
   } catch (const InterruptedException& e) {
     out << "Flash programming interrupted\n";
@@ -396,8 +432,8 @@ void Crorc::stopDataReceiver()
 /// \param command Command code
 /// \param transid Transaction ID
 /// \param param Command parameter, or the full command if dest == -1
-/// \param time If > 0 then test if command can be sent and wait as many cycles if necessary.
-void Crorc::ddlSendCommand(int dest, uint32_t command, int transid, uint32_t param, long long int time)
+/// \param timeout If > 0 then test if command can be sent and wait as long if necessary.
+void Crorc::ddlSendCommand(int dest, uint32_t command, int transid, uint32_t param, std::chrono::nanoseconds timeout)
 {
   uint32_t com;
   int destination;
@@ -414,14 +450,8 @@ void Crorc::ddlSendCommand(int dest, uint32_t command, int transid, uint32_t par
     assertLinkUp();
   }
 
-  long long int i;
-  for (i = 0; i < time; i++){
-    if (checkCommandRegister() == 0) {
-      break;
-    }
-  }
-
-  if (time && (i == time)) {
+  if (timeout.count() > 0 && !Utilities::spinThenSleep([&]{ return checkCommandRegister() == 0; }, timeout,
+      DDL_SPIN_TIME, DDL_MAX_SLEEP)) {
     BOOST_THROW_EXCEPTION(TimeoutException() << ErrorInfo::Message("Timed out sending DDL command"));
   }
 
@@ -429,13 +459,11 @@ void Crorc::ddlSendCommand(int dest, uint32_t command, int transid, uint32_t par
 }
 
 /// Checks whether status mail box or register is not empty in timeout
-/// \param timeout  Number of check cycles
-void Crorc::ddlWaitStatus(long long int timeout)
+/// \param timeout Time to wait
+void Crorc::ddlWaitStatus(std::chrono::nanoseconds timeout)
 {
-  for (int i = 0; i < timeout; ++i) {
-    if (checkRxStatus()) {
-      return;
-    }
+  if (Utilities::spinThenSleep([&]{ return checkRxStatus() != 0; }, timeout, DDL_SPIN_TIME, DDL_MAX_SLEEP)) {
+    return;
   }
   BOOST_THROW_EXCEPTION(TimeoutException() << ErrorInfo::Message("Timed out waiting on DDL"));
 }
@@ -449,7 +477,7 @@ StWord Crorc::ddlReadStatus()
   return stw;
 }
 
-StWord Crorc::ddlReadDiu(int transid, long long int time)
+StWord Crorc::ddlReadDiu(int transid, std::chrono::nanoseconds time)
 {
   /// Prepare and send DDL command
   int destination = Ddl::Destination::DIU;
@@ -467,7 +495,7 @@ StWord Crorc::ddlReadDiu(int transid, long long int time)
   return stw;
 }
 
-StWord Crorc::ddlReadCTSTW(int transid, int destination, long long int time){
+StWord Crorc::ddlReadCTSTW(int transid, int destination, std::chrono::nanoseconds time){
   ddlWaitStatus(time);
   StWord stw = ddlReadStatus();
   if ((stw.part.code != Rorc::CTSTW && stw.part.code != Rorc::ILCMD && stw.part.code != Rorc::CTSTW_TO)
@@ -480,7 +508,7 @@ StWord Crorc::ddlReadCTSTW(int transid, int destination, long long int time){
   return stw;
 }
 
-StWord Crorc::ddlReadSiu(int transid, long long int time)
+StWord Crorc::ddlReadSiu(int transid, std::chrono::nanoseconds time)
 {
   // prepare and send DDL command
   int destination = Ddl::Destination::SIU;
@@ -612,8 +640,8 @@ std::vector<std::string> ddlInterpretIFSTW(uint32_t ifstw)
 
 /// Tries to reset the SIU.
 /// \param cycle Number of status checks
-/// \param time Number of cycles to wait for command sending and replies
-void Crorc::ddlResetSiu(int cycle, long long int time)
+/// \param time Time to wait for command sending and replies
+void Crorc::ddlResetSiu(int cycle, std::chrono::nanoseconds time)
 {
   ddlSendCommand(Ddl::Destination::DIU, Ddl::SRST, 0,  0, time);
   ddlWaitStatus(time);
@@ -659,7 +687,7 @@ void Crorc::ddlResetSiu(int cycle, long long int time)
 }
 
 /// Sends a reset command
-void Crorc::resetCommand(int option, const DiuConfig& diuConfig)
+void Crorc::resetCommand(int option, const DiuConfig&)
 {
   uint32_t command = 0;
   if (option & Rorc::Reset::DIU) {
@@ -682,7 +710,7 @@ void Crorc::resetCommand(int option, const DiuConfig& diuConfig)
   }
   if (option & Rorc::Reset::SIU) {
     putCommandRegister(Rorc::DcrCommand::RESET_SIU);
-    ddlWaitStatus(Ddl::RESPONSE_TIME * diuConfig.pciLoopPerUsec);
+    ddlWaitStatus(DDL_RESPONSE_TIMEOUT);
     ddlReadStatus();
   }
   if (!option || (option & Rorc::Reset::RORC)) {
@@ -717,7 +745,7 @@ void Crorc::armDdl(int resetMask, const DiuConfig& diuConfig)
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Command not allowed"));
   }
   if (resetMask & Rorc::Reset::SIU){
-    ddlResetSiu(3, Ddl::RESPONSE_TIME * diuConfig.pciLoopPerUsec);
+    ddlResetSiu(3, DDL_RESPONSE_TIMEOUT);
   }
   if (resetMask & Rorc::Reset::LINK_UP){
     reset(Rorc::Reset::RORC);
@@ -744,6 +772,14 @@ void Crorc::armDdl(int resetMask, const DiuConfig& diuConfig)
   }
 }
 
+std::future<void> Crorc::armDdlAsync(int resetMask, const DiuConfig& diuConfig)
+{
+  // The copy only holds a reference to the BAR
+  return std::async(std::launch::async, [crorc = *this, resetMask, diuConfig]() mutable {
+    crorc.armDdl(resetMask, diuConfig);
+  });
+}
+
 auto Crorc::initDiuVersion() -> DiuConfig
 {
   int maxLoop = 1000;
@@ -772,12 +808,12 @@ void Crorc::assertLinkUp()
 
 void Crorc::siuCommand(int command)
 {
-  ddlReadSiu(command, Ddl::RESPONSE_TIME);
+  ddlReadSiu(command, DDL_RESPONSE_TIMEOUT);
 }
 
 void Crorc::diuCommand(int command)
 {
-  ddlReadDiu(command, Ddl::RESPONSE_TIME);
+  ddlReadDiu(command, DDL_RESPONSE_TIMEOUT);
 }
 
 RxFreeFifoState Crorc::getRxFreeFifoState()
@@ -818,8 +854,8 @@ void Crorc::startDataReceiver(uintptr_t readyFifoBusAddress)
   }
 }
 
-StWord Crorc::ddlSetSiuLoopBack(const DiuConfig& diuConfig){
-  long long int timeout = diuConfig.pciLoopPerUsec * Ddl::RESPONSE_TIME;
+StWord Crorc::ddlSetSiuLoopBack(const DiuConfig&){
+  auto timeout = DDL_RESPONSE_TIMEOUT;
 
   // Check SIU fw version
   ddlSendCommand(Ddl::Destination::SIU, Ddl::IFLOOP, 0, 0, timeout);
@@ -854,17 +890,17 @@ void Crorc::setSiuLoopback(const DiuConfig& diuConfig)
   ddlSetSiuLoopBack(diuConfig);
 }
 
-void Crorc::startTrigger(const DiuConfig& diuConfig)
+void Crorc::startTrigger(const DiuConfig&)
 {
-  uint64_t timeout = Ddl::RESPONSE_TIME * diuConfig.pciLoopPerUsec;
+  auto timeout = DDL_RESPONSE_TIMEOUT;
   ddlSendCommand(Ddl::Destination::FEE, Fee::RDYRX, 0, 0, timeout);
   ddlWaitStatus(timeout);
   ddlReadStatus();
 }
 
-void Crorc::stopTrigger(const DiuConfig& diuConfig)
+void Crorc::stopTrigger(const DiuConfig&)
 {
-  uint64_t timeout = Ddl::RESPONSE_TIME * diuConfig.pciLoopPerUsec;
+  auto timeout = DDL_RESPONSE_TIMEOUT;
 
   auto rorcStopTrigger = [&] {
     ddlSendCommand(Ddl::Destination::FEE, Fee::EOBTR, 0, 0, timeout);
@@ -7,6 +7,8 @@
 #define ALICEO2_SRC_READOUTCARD_CRORC_CRORC_H_
 
 #include <atomic>
+#include <chrono>
+#include <future>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -31,6 +33,31 @@ void programFlash(RegisterReadWriteInterface& bar0, std::string dataFilePath, in
 /// Read flash range
 void readFlashRange(RegisterReadWriteInterface& bar0, int addressFlash, int wordNumber, std::ostream& out);
 
+/// Reads a range of 16-bit flash words into a buffer, without formatting
+/// \param bar0 BAR 0 of the card
+/// \param addressFlash Flash address of the first word
+/// \param words Buffer for the words, must hold at least 'count' words
+/// \param count Amount of words to read
+void readFlashWords(RegisterReadWriteInterface& bar0, int addressFlash, uint16_t* words, size_t count);
+
+/// First difference between the flash and a file
+struct FlashMismatch
+{
+    size_t offset; ///< Offset of the word from the start of the file
+    uint16_t expected; ///< Word of the file
+    uint16_t actual; ///< Word of the flash
+};
+
+/// Compares the flash with a data file in the format programFlash() takes, stopping at the first difference
+/// \param bar0 BAR 0 of the card
+/// \param dataFilePath Path of the data file
+/// \param addressFlash Flash address the file was programmed at
+/// \param interrupt Flag to stop the comparison early
+/// \return The first difference, or none if the flash matches the file
+/// \throw Exception if the comparison was interrupted
+boost::optional<FlashMismatch> verifyFlash(RegisterReadWriteInterface& bar0, std::string dataFilePath,
+    int addressFlash = 0, const std::atomic<bool>* interrupt = nullptr);
+
 class Crorc
 {
   public:
@@ -41,6 +68,7 @@ class Crorc
 
     struct DiuConfig
     {
+        /// Status register reads per microsecond. Only informational, the DDL waits are timed with a clock.
         double pciLoopPerUsec = 0;
     };
 
@@ -52,6 +80,13 @@ class Crorc
     /// \param diuConfig DIU configuration
     void armDdl(int resetMask, const DiuConfig& diuConfig);
 
+    /// Arms DDL on a separate thread, so the links of several channels can be initialized in parallel
+    /// \param resetMask The reset mask. See the RORC_RESET_* macros in rorc.h
+    /// \param diuConfig DIU configuration
+    /// \return Future that becomes ready when the DDL is armed, and which rethrows its errors. The BAR must stay alive
+    ///   until then.
+    std::future<void> armDdlAsync(int resetMask, const DiuConfig& diuConfig);
+
     /// Arms C-RORC data generator
     int armDataGenerator(uint32_t initEventNumber, uint32_t initDataWord, GeneratorPattern::type dataPattern,
         int dataSize, int seed);
@@ -176,13 +211,13 @@ class Crorc
       bar.writeRegister(index, value);
     }
 
-    void ddlResetSiu(int cycle, long long int time);
-    void ddlSendCommand(int dest, uint32_t command, int transid, uint32_t param, long long int time);
-    void ddlWaitStatus(long long int timeout);
+    void ddlResetSiu(int cycle, std::chrono::nanoseconds timeout);
+    void ddlSendCommand(int dest, uint32_t command, int transid, uint32_t param, std::chrono::nanoseconds timeout);
+    void ddlWaitStatus(std::chrono::nanoseconds timeout);
     StWord ddlReadStatus();
-    StWord ddlReadDiu(int transid, long long int time);
-    StWord ddlReadSiu(int transid, long long int time);
-    StWord ddlReadCTSTW(int transid, int destination, long long int time);
+    StWord ddlReadDiu(int transid, std::chrono::nanoseconds timeout);
+    StWord ddlReadSiu(int transid, std::chrono::nanoseconds timeout);
+    StWord ddlReadCTSTW(int transid, int destination, std::chrono::nanoseconds timeout);
     void emptyDataFifos(int timeoutMicroseconds);
     StWord ddlSetSiuLoopBack(const DiuConfig& diuConfig);
     std::vector<std::string> ddlInterpretIFSTW(uint32_t ifstw);
@@ -12,6 +12,11 @@ namespace roc {
 CrorcBar::CrorcBar(const Parameters& parameters)
     : BarInterfaceBase(parameters)
 {
+  if (mPdaBar->getIndex() != 2) {
+    mFreeFifoExtension = mPdaBar->getRegisterHandle(Rorc::C_RAFX * 4);
+    mFreeFifoHigh = mPdaBar->getRegisterHandle(Rorc::C_RAFH * 4);
+    mFreeFifoLow = mPdaBar->getRegisterHandle(Rorc::C_RAFL * 4);
+  }
 }
 
 CrorcBar::~CrorcBar()
@@ -45,5 +50,27 @@ boost::optional<std::string> CrorcBar::getFirmwareInfo()
   return stream.str();
 }
 
+void CrorcBar::pushFreeFifoPages(uintptr_t busAddress, size_t pageSize, int readyFifoIndex, int count)
+{
+  if (mPdaBar->getIndex() == 2) {
+    BOOST_THROW_EXCEPTION(CrorcException() << ErrorInfo::Message("Free FIFO pages can't be pushed through BAR 2"));
+  }
+
+  // The write to the low register pushes the entry, the extension and high registers are latched. So the extension
+  // only needs to be written when the upper 32 bits change, which is at most once per 4 GiB.
+  const uint32_t pageWords = pageSize / 4;
+  uint32_t extension = Utilities::getUpper32Bits(busAddress);
+  mFreeFifoExtension.write(extension);
+  for (int i = 0; i < count; ++i) {
+    const uintptr_t address = busAddress + i * pageSize;
+    if (Utilities::getUpper32Bits(address) != extension) {
+      extension = Utilities::getUpper32Bits(address);
+      mFreeFifoExtension.write(extension);
+    }
+    mFreeFifoHigh.write(Utilities::getLower32Bits(address));
+    mFreeFifoLow.write((pageWords << 8) | uint32_t(readyFifoIndex + i));
+  }
+}
+
 } // namespace roc
 } // namespace AliceO2
@@ -30,6 +30,21 @@ class CrorcBar final : public BarInterfaceBase
 
     virtual boost::optional<int32_t> getSerial() override;
     virtual boost::optional<std::string> getFirmwareInfo() override;
+
+    /// Pushes a run of consecutive pages to the channel's Free FIFO.
+    /// Page i is located at busAddress + i * pageSize, and its transfer status is written to Ready FIFO entry
+    /// readyFifoIndex + i. The caller is responsible for splitting runs that wrap around the Ready FIFO.
+    /// \param busAddress Bus address of the first page
+    /// \param pageSize Size of a page in bytes
+    /// \param readyFifoIndex Ready FIFO index of the first page
+    /// \param count Amount of pages to push
+    void pushFreeFifoPages(uintptr_t busAddress, size_t pageSize, int readyFifoIndex, int count);
+
+  private:
+    /// Handles of the Receive Address FIFO registers, used on the DMA hot path
+    Pda::PdaBar::RegisterHandle mFreeFifoExtension;
+    Pda::PdaBar::RegisterHandle mFreeFifoHigh;
+    Pda::PdaBar::RegisterHandle mFreeFifoLow;
 };
 
 } // namespace roc
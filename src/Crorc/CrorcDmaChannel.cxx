@@ -16,6 +16,8 @@
 #include "Crorc/Constants.h"
 #include "ReadoutCard/ChannelFactory.h"
 #include "Utilities/SmartPointer.h"
+#include "Utilities/Timestamp.h"
+#include "Utilities/Wait.h"
 
 namespace b = boost;
 //namespace bip = boost::interprocess;
@@ -27,16 +29,47 @@ using namespace std::literals;
 namespace AliceO2 {
 namespace roc {
 
+constexpr std::chrono::milliseconds CrorcDmaChannel::INITIAL_PAGES_TIMEOUT;
+constexpr std::chrono::milliseconds CrorcDmaChannel::FREE_FIFO_RESET_TIMEOUT;
+
+constexpr size_t CrorcDmaChannel::DEFAULT_PAGE_SIZE;
+constexpr size_t CrorcDmaChannel::MIN_PAGE_SIZE;
+
+size_t CrorcDmaChannel::selectPageSize(const Parameters& parameters)
+{
+  if (auto pageSize = parameters.getDmaPageSize()) {
+    if (pageSize.get() < MIN_PAGE_SIZE || !Utilities::isPowerOfTwo(pageSize.get())) {
+      BOOST_THROW_EXCEPTION(CrorcException()
+          << ErrorInfo::Message("C-RORC page size must be a power of two of at least 2 KiB")
+          << ErrorInfo::DmaPageSize(pageSize.get()));
+    }
+    return pageSize.get();
+  }
+
+  if (auto dataSize = parameters.getGeneratorDataSize()) {
+    // Follow the event size, so small events don't waste most of their pages
+    size_t pageSize = MIN_PAGE_SIZE;
+    while (pageSize < dataSize.get()) {
+      pageSize *= 2;
+    }
+    return pageSize;
+  }
+
+  return DEFAULT_PAGE_SIZE;
+}
+
 CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
     : DmaChannelPdaBase(parameters, allowedChannels()), //
+    mSuperpageQueue(parameters.getSuperpageQueueCapacity().get_value_or(DEFAULT_SUPERPAGE_QUEUE_CAPACITY)), //
     //mPdaBar(getRocPciDevice().getPciDevice(), getChannelNumber()), // Initialize main DMA channel BAR
     //mPdaBar2(getRocPciDevice().getPciDevice(), 2), // Initialize BAR 2
-    mPageSize(parameters.getDmaPageSize().get_value_or(8*1024)), // 8 kB default for uniformity with CRU
+    mPageSize(selectPageSize(parameters)), //
     mInitialResetLevel(ResetLevel::Internal), // It's good to reset at least the card channel in general
     mNoRDYRX(true), // Not sure
     mUseFeeAddress(false), // Not sure
     mLoopbackMode(parameters.getGeneratorLoopback().get_value_or(LoopbackMode::Internal)), // Internal loopback by default
     mGeneratorEnabled(parameters.getGeneratorEnabled().get_value_or(true)), // Use data generator by default
+    mSdhEventSizeEnabled(parameters.getSdhEventSizeEnabled().get_value_or(true)), //
     mGeneratorPattern(parameters.getGeneratorPattern().get_value_or(GeneratorPattern::Incremental)), //
     mGeneratorMaximumEvents(0), // Infinite events
     mGeneratorInitialValue(0), // Start from 0
@@ -44,7 +77,9 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
     mGeneratorSeed(mGeneratorPattern == GeneratorPattern::Random ? 1 : 0), // We use a seed for random only
     mGeneratorDataSize(parameters.getGeneratorDataSize().get_value_or(mPageSize)), // Can use page size
     mUseContinuousReadout(parameters.getReadoutMode().is_initialized() ?
-            parameters.getReadoutModeRequired() == ReadoutMode::Continuous : false)
+            parameters.getReadoutModeRequired() == ReadoutMode::Continuous : false),
+    mWarmRestartEnabled(parameters.getWarmRestartEnabled().get_value_or(false)),
+    mFlushTimeout(parameters.getSuperpageFlushTimeout())
 {
   // Prep for BARs
   auto parameters2 = parameters;
@@ -54,12 +89,33 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
   crorcBar = std::move(std::dynamic_pointer_cast<CrorcBar> (bar)); // Initialize bar0
   crorcBar2 = std::move(std::dynamic_pointer_cast<CrorcBar> (bar2)); // Initalize bar2
 
-  // Create and register our ReadyFIFO buffer
-  log("Initializing ReadyFIFO DMA buffer", InfoLogger::InfoLogger::Debug);
-  {
-    // Create and register the buffer
+  // The C-RORC channel is a single link
+  getStatisticsCounters().addLink(0);
+
+  if (auto channels = parameters.getSynchronizedStartChannels()) {
+    if (mUseContinuousReadout) {
+      if (channels->count(getChannelNumber()) == 0) {
+        BOOST_THROW_EXCEPTION(CrorcException()
+            << ErrorInfo::Message("Channel is not one of the SynchronizedStartChannels")
+            << ErrorInfo::ChannelNumber(getChannelNumber()));
+      }
+      mStartCoordinator = CrorcStartCoordinator::get(getRocPciDevice().getPciAddress(), *channels);
+    } else {
+      log("SynchronizedStartChannels is only used with continuous readout", InfoLogger::InfoLogger::Warning);
+    }
+  }
+
+  constexpr auto FIFO_SIZE = sizeof(ReadyFifo);
+  if (parameters.getReadyFifoInBuffer().get_value_or(false)) {
+    // Put the ReadyFIFO at the end of the channel's buffer, which is already registered
+    log("Initializing ReadyFIFO in DMA buffer", InfoLogger::InfoLogger::Debug);
+    auto offset = reserveBufferTail(FIFO_SIZE);
+    mReadyFifoAddressUser = getBufferProvider().getAddress() + offset;
+    mReadyFifoAddressBus = getBusOffsetAddress(0, offset);
+  } else {
+    // Create and register our ReadyFIFO buffer
+    log("Initializing ReadyFIFO DMA buffer", InfoLogger::InfoLogger::Debug);
     // Note: if resizing the file fails, we might've accidentally put the file in a hugetlbfs mount with 1 GB page size
-    constexpr auto FIFO_SIZE = sizeof(ReadyFifo);
     Utilities::resetSmartPtr(mBufferFifoFile, getPaths().fifo(), FIFO_SIZE, true);
     Utilities::resetSmartPtr(mPdaDmaBufferFifo, getRocPciDevice().getPciDevice(), mBufferFifoFile->getAddress(),
         FIFO_SIZE, getPdaDmaBufferIndexFifo(getChannelNumber()), false);// note the 'false' at the end specifies non-hugepage memory
@@ -77,7 +133,6 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
   }
 
   getReadyFifoUser()->reset();
-  mDmaBufferUserspace = getBufferProvider().getAddress();
 }
 
 auto CrorcDmaChannel::allowedChannels() -> AllowedChannels {
@@ -90,6 +145,28 @@ CrorcDmaChannel::~CrorcDmaChannel()
 }
 
 void CrorcDmaChannel::deviceStartDma()
+{
+  mChannelResetDone = false;
+  deferDmaStart();
+}
+
+void CrorcDmaChannel::devicePrepareDma()
+{
+  // The DIU detection and the channel reset, with their waits, are done now instead of when the first superpage is
+  // pushed
+  if (!(mWarmRestartEnabled && mStartedBefore)) {
+    mDiuConfig = getCrorc().initDiuVersion();
+    deviceResetChannel(mInitialResetLevel);
+  }
+  mChannelResetDone = true;
+}
+
+void CrorcDmaChannel::deviceStartPreparedDma()
+{
+  deferDmaStart();
+}
+
+void CrorcDmaChannel::deferDmaStart()
 {
   // With the C-RORC, we can't start DMA until we have enough memory to cover 128 DMA pages (which should be covered by
   // 1 superpage). So we set the "pending DMA start" state and actually start once a superpage has been pushed.
@@ -98,6 +175,7 @@ void CrorcDmaChannel::deviceStartDma()
   mFifoBack = 0;
   mFifoSize = 0;
   mSuperpageQueue.clear();
+  mFlushWatch.reset();
   mPendingDmaStart = true;
 }
 
@@ -109,25 +187,34 @@ void CrorcDmaChannel::startPendingDma(SuperpageQueueEntry& entry)
 
   log("Starting pending DMA");
 
+  if (mStartCoordinator) {
+    armSynchronizedStart(entry);
+    return;
+  }
+
   if (mUseContinuousReadout) {
     log("Initializing continuous readout");
     Crorc::Crorc::initReadoutContinuous(*(getBar2()));
   }
 
-  // Find DIU version, required for armDdl()
-  mDiuConfig = getCrorc().initDiuVersion();
+  if (mChannelResetDone) {
+    log("Channel already reset, skipping DIU detection and channel reset");
+  } else if (mWarmRestartEnabled && mStartedBefore) {
+    log("Warm restart, skipping DIU detection and channel reset");
+  } else {
+    // Find DIU version, required for armDdl()
+    mDiuConfig = getCrorc().initDiuVersion();
 
-  // Resetting the card,according to the RESET LEVEL parameter
-  deviceResetChannel(mInitialResetLevel);
+    // Resetting the card,according to the RESET LEVEL parameter
+    deviceResetChannel(mInitialResetLevel);
+  }
 
   // Setting the card to be able to receive data
   startDataReceiving();
 
   // Initializing the firmware FIFO, pushing (entries) pages
-  for(int i = 0; i < READYFIFO_ENTRIES; ++i){
-    getReadyFifoUser()->entries[i].reset();
-    pushIntoSuperpage(entry);
-  }
+  getReadyFifoUser()->reset();
+  pushIntoSuperpage(entry, READYFIFO_ENTRIES);
 
   assert(entry.pushedPages <= entry.maxPages);
   if (entry.pushedPages == entry.maxPages) {
@@ -153,9 +240,9 @@ void CrorcDmaChannel::startPendingDma(SuperpageQueueEntry& entry)
     }
   }
 
-  /// Fixed wait for initial pages TODO polling wait with timeout
-  std::this_thread::sleep_for(10ms);
-  if (dataArrived(READYFIFO_ENTRIES - 1) != DataArrivalStatus::WholeArrived) {
+  // Wait for the initial pages
+  auto initialPagesArrived = [&]{ return dataArrived(READYFIFO_ENTRIES - 1) == DataArrivalStatus::WholeArrived; };
+  if (!Utilities::spinThenSleep(initialPagesArrived, INITIAL_PAGES_TIMEOUT, std::chrono::nanoseconds(0))) {
     log("Initial pages not arrived", InfoLogger::InfoLogger::Warning);
   }
 
@@ -163,6 +250,7 @@ void CrorcDmaChannel::startPendingDma(SuperpageQueueEntry& entry)
 
   if (entry.superpage.getReceived() == entry.superpage.getSize()) {
     entry.superpage.setReady(true);
+    entry.superpage.setTimestamp(Utilities::getTimestampCounter());
     mSuperpageQueue.moveFromArrivalsToFilledQueue();
   }
 
@@ -171,6 +259,8 @@ void CrorcDmaChannel::startPendingDma(SuperpageQueueEntry& entry)
   mFifoSize = 0;
 
   mPendingDmaStart = false;
+  mChannelResetDone = false;
+  mStartedBefore = true;
   log("DMA started");
 
   if (mUseContinuousReadout) {
@@ -179,8 +269,65 @@ void CrorcDmaChannel::startPendingDma(SuperpageQueueEntry& entry)
   }
 }
 
+void CrorcDmaChannel::armSynchronizedStart(SuperpageQueueEntry& entry)
+{
+  // The first channel of the start configures the card, which the others must not do again while it arms
+  mStartCoordinator->beginArming(getChannelNumber(), [&]{
+    log("Initializing continuous readout");
+    Crorc::Crorc::initReadoutContinuous(*(getBar2()));
+  });
+
+  if (mChannelResetDone) {
+    log("Channel already reset, skipping DIU detection and channel reset");
+  } else if (mWarmRestartEnabled && mStartedBefore) {
+    log("Warm restart, skipping DIU detection and channel reset");
+  } else {
+    mDiuConfig = getCrorc().initDiuVersion();
+    deviceResetChannel(mInitialResetLevel);
+  }
+
+  startDataReceiving();
+
+  // Filling the Free FIFO. Unlike for a start on our own, the initial pages are not waited for: the gate opens when
+  // all channels are armed, and they are retired by fillSuperpages() like any other pages.
+  getReadyFifoUser()->reset();
+  mFifoBack = 0;
+  mFifoSize = 0;
+  pushIntoSuperpage(entry, READYFIFO_ENTRIES);
+  if (entry.isPushed()) {
+    mSuperpageQueue.removeFromPushingQueue();
+  }
+
+  if (mGeneratorEnabled) {
+    log("Starting data generator");
+    startDataGenerator();
+  } else if (!mNoRDYRX) {
+    log("Starting trigger");
+    getCrorc().assertLinkUp();
+    getCrorc().siuCommand(Ddl::RandCIFST);
+    getCrorc().diuCommand(Ddl::RandCIFST);
+    getCrorc().startTrigger(mDiuConfig);
+  }
+
+  mPendingDmaStart = false;
+  mChannelResetDone = false;
+  mStartedBefore = true;
+
+  auto started = mStartCoordinator->armed(getChannelNumber(), [&]{
+    log("Starting continuous readout of all synchronized channels");
+    Crorc::Crorc::startReadoutContinuous(*(getBar2()));
+  });
+  if (!started) {
+    log("Channel armed, continuous readout starts when all synchronized channels are armed");
+  }
+  log("DMA started");
+}
+
 void CrorcDmaChannel::deviceStopDma()
 {
+  if (mStartCoordinator) {
+    mStartCoordinator->disarm(getChannelNumber());
+  }
   if (mGeneratorEnabled) {
     // Starting the data generator
     startDataGenerator();
@@ -194,6 +341,44 @@ void CrorcDmaChannel::deviceStopDma()
   }
 }
 
+void CrorcDmaChannel::deviceRecover()
+{
+  if (mPendingDmaStart) {
+    // Nothing was given to the card yet
+    return;
+  }
+
+  deviceStopDma();
+
+  // The superpages keep the pages that were counted as arrived, the rest of the pushed pages is given up
+  auto reclaimed = mSuperpageQueue.reclaimArrivals();
+  log((boost::format("Moved %1% superpage(s) to the ready queue") % reclaimed).str());
+
+  // Only the DMA engine and the FIFOs are reset, the DIU and SIU are left as they are
+  getCrorc().resetCommand(Rorc::Reset::RORC, mDiuConfig);
+  getCrorc().resetCommand(Rorc::Reset::FF, mDiuConfig);
+
+  // The DMA restarts with the next superpage that is pushed, like after startDma()
+  mFifoBack = 0;
+  mFifoSize = 0;
+  mFlushWatch.reset();
+  mChannelResetDone = true;
+  mPendingDmaStart = true;
+}
+
+void CrorcDmaChannel::deviceStartNextRun()
+{
+  if (mPendingDmaStart) {
+    // Nothing was given to the card yet, so the superpages of the run are given back empty
+    mSuperpageQueue.reclaimArrivals();
+    return;
+  }
+
+  // The superpages of the run come back with the pages that arrived, as in a recovery. The FIFOs are reset now, and
+  // the next run starts with the next superpage that is pushed, without the DIU detection and channel reset.
+  deviceRecover();
+}
+
 void CrorcDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
 {
   if (resetLevel == ResetLevel::Nothing) {
@@ -258,7 +443,9 @@ void CrorcDmaChannel::startDataGenerator()
 
 void CrorcDmaChannel::startDataReceiving()
 {
-  getCrorc().initDiuVersion();
+  if (!mChannelResetDone && !(mWarmRestartEnabled && mStartedBefore)) {
+    getCrorc().initDiuVersion();
+  }
 
   // Preparing the card.
   if (LoopbackMode::Siu == mLoopbackMode) {
@@ -269,7 +456,8 @@ void CrorcDmaChannel::startDataReceiving()
   }
 
   getCrorc().resetCommand(Rorc::Reset::FF, mDiuConfig);
-  std::this_thread::sleep_for(10ms); /// XXX Give card some time to reset the FreeFIFO
+  Utilities::spinThenSleep([&]{ return getCrorc().isFreeFifoEmpty(); }, FREE_FIFO_RESET_TIMEOUT,
+      std::chrono::nanoseconds(0));
   getCrorc().assertFreeFifoEmpty();
   getCrorc().startDataReceiver(mReadyFifoAddressBus);
 }
@@ -289,112 +477,274 @@ auto CrorcDmaChannel::getSuperpage() -> Superpage
   return mSuperpageQueue.getFrontSuperpage();
 }
 
-void CrorcDmaChannel::pushSuperpage(Superpage superpage)
+void CrorcDmaChannel::checkCrorcSuperpage(const Superpage& superpage)
 {
   checkSuperpage(superpage);
-  constexpr size_t MIN_SIZE = 1*1024*1024;
 
-  if (!Utilities::isMultiple(superpage.getSize(), MIN_SIZE)) {
+  // We require a multiple of the size of a full Ready FIFO of pages (1 MiB for 8 KiB pages), because the first
+  // superpage must fit them when starting DMA (see startPendingDma() for why we need that), and so the superpage is
+  // packed with whole pages
+  const size_t minSize = READYFIFO_ENTRIES * mPageSize;
+  if (!Utilities::isMultiple(superpage.getSize(), minSize)) {
     BOOST_THROW_EXCEPTION(CrorcException()
-        << ErrorInfo::Message("Could not enqueue superpage, C-RORC backend requires superpage size multiple of 1 MiB"));
-    // We require 1 MiB because this fits 128 8KiB DMA pages (see deviceStartDma() for why we need that)
+        << ErrorInfo::Message("Could not enqueue superpage, C-RORC backend requires superpage size multiple of "
+            + std::to_string(minSize / 1024) + " KiB (128 DMA pages)")
+        << ErrorInfo::DmaPageSize(mPageSize));
   }
+}
 
+void CrorcDmaChannel::addSuperpageToQueue(const Superpage& superpage)
+{
   SuperpageQueueEntry entry;
-  entry.busAddress = getBusOffsetAddress(superpage.getOffset());
+  entry.busAddress = getBusOffsetAddress(superpage.getBufferId(), superpage.getOffset());
   entry.maxPages = superpage.getSize() / mPageSize;
   entry.pushedPages = 0;
   entry.superpage = superpage;
   entry.superpage.setReceived(0);
+  entry.superpage.setPushTimestamp(Utilities::getTimestampCounter());
+  entry.superpage.setRunEpoch(getRunEpoch());
+  entry.superpage.setSplit(false);
+  entry.superpage.setChecked(true);
 
   mSuperpageQueue.addToQueue(entry);
+  getTraceRing().record(TraceRing::Event::Pushed, 0, superpage.getOffset());
+  getStatisticsCounters().transferQueueSize(mSuperpageQueue.getQueueCount() - mSuperpageQueue.getFilled().size());
+}
+
+void CrorcDmaChannel::pushSuperpage(Superpage superpage)
+{
+  if (!tryPushSuperpage(superpage)) {
+    BOOST_THROW_EXCEPTION(CrorcException() << ErrorInfo::Message("Could not push superpage, transfer queue was full"));
+  }
+}
+
+bool CrorcDmaChannel::tryPushSuperpage(const Superpage& superpage)
+{
+  checkCrorcSuperpage(superpage);
+  if (mSuperpageQueue.isFull()) {
+    return false;
+  }
+  addSuperpageToQueue(superpage);
+  return true;
+}
+
+void CrorcDmaChannel::pushSuperpages(const Superpage* superpages, size_t count)
+{
+  if (count > size_t(mSuperpageQueue.getQueueAvailable())) {
+    BOOST_THROW_EXCEPTION(CrorcException()
+        << ErrorInfo::Message("Could not enqueue superpages, not enough transfer queue slots")
+        << ErrorInfo::SuperpageCount(count));
+  }
+
+  // Check everything up front, so we don't leave the queue half-pushed if one of the superpages is bad
+  for (size_t i = 0; i < count; ++i) {
+    checkCrorcSuperpage(superpages[i]);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    addSuperpageToQueue(superpages[i]);
+  }
+}
+
+void CrorcDmaChannel::validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId)
+{
+  checkCrorcSuperpage(superpage);
+  DmaChannelBase::validateSuperpage(superpage, linkId);
+}
+
+void CrorcDmaChannel::releaseSuperpage(Superpage superpage)
+{
+  if (!superpage.isChecked()) {
+    checkCrorcSuperpage(superpage);
+  }
+  if (mSuperpageQueue.isFull()) {
+    BOOST_THROW_EXCEPTION(CrorcException() << ErrorInfo::Message("Could not release superpage, transfer queue was full"));
+  }
+  superpage.setReady(false);
+  addSuperpageToQueue(superpage);
 }
 
 auto CrorcDmaChannel::popSuperpage() -> Superpage
 {
-  return mSuperpageQueue.removeFromFilledQueue().superpage;
+  auto superpage = mSuperpageQueue.removeFromFilledQueue().superpage;
+  getTraceRing().record(TraceRing::Event::Popped, 0, superpage.getOffset());
+  return superpage;
 }
 
-void CrorcDmaChannel::fillSuperpages()
+bool CrorcDmaChannel::tryPopSuperpage(Superpage& superpage)
+{
+  if (mSuperpageQueue.getFilled().empty()) {
+    return false;
+  }
+  superpage = popSuperpage();
+  return true;
+}
+
+size_t CrorcDmaChannel::popSuperpages(Superpage* superpages, size_t max)
+{
+  auto count = std::min(max, mSuperpageQueue.getFilled().size());
+  for (size_t i = 0; i < count; ++i) {
+    superpages[i] = mSuperpageQueue.removeFromFilledQueue().superpage;
+    getTraceRing().record(TraceRing::Event::Popped, 0, superpages[i].getOffset());
+  }
+  return count;
+}
+
+size_t CrorcDmaChannel::getPartialSuperpages(Superpage* superpages, size_t max)
 {
-  // Push new pages into superpage
-  if (!mSuperpageQueue.getPushing().empty()) {
-    SuperpageQueueEntry& entry = mSuperpageQueue.getPushingFrontEntry();
+  // The pages arrive in order, so only the front superpage of the arrivals queue can be partially filled. Its received
+  // size counts the pages fillSuperpages() retired from the Ready FIFO.
+  if (max == 0 || mSuperpageQueue.getArrivals().empty()) {
+    return 0;
+  }
+  const auto& superpage = mSuperpageQueue.getArrivalsFrontEntry().superpage;
+  if (superpage.getReceived() == 0) {
+    return 0;
+  }
+  superpages[0] = superpage;
+  return 1;
+}
 
-    if (mPendingDmaStart) {
+void CrorcDmaChannel::fillSuperpages()
+{
+  // Push new pages into superpages
+  if (mPendingDmaStart) {
+    if (!mSuperpageQueue.getPushing().empty()) {
       // Do some special handling of first transfers......
-      startPendingDma(entry);
-    } else {
+      startPendingDma(mSuperpageQueue.getPushingFrontEntry());
+    }
+  } else {
+    // Walk the pushing queue until the Free FIFO is full. With small superpages, pushing only the front one would let
+    // the FIFO drain before the next call.
+    while (!mSuperpageQueue.getPushing().empty() && mFifoSize < int(FIFO_QUEUE_MAX)) {
+      SuperpageQueueEntry& entry = mSuperpageQueue.getPushingFrontEntry();
       int freeDescriptors = FIFO_QUEUE_MAX - mFifoSize;
       int freePages = entry.getUnpushedPages();
       int possibleToPush = std::min(freeDescriptors, freePages);
 
-      for (int i = 0; i < possibleToPush; ++i) {
-        pushIntoSuperpage(entry);
-      }
+      pushIntoSuperpage(entry, possibleToPush);
 
-      if (entry.isPushed()) {
-        // Remove superpage from pushing queue
-        mSuperpageQueue.removeFromPushingQueue();
+      if (!entry.isPushed()) {
+        break;
       }
+      // Remove superpage from pushing queue
+      mSuperpageQueue.removeFromPushingQueue();
     }
   }
 
-  // Check for arrivals & handle them
-  if (!mSuperpageQueue.getArrivals().empty()) {
-    auto isArrived = [&](int descriptorIndex) {return dataArrived(descriptorIndex) == DataArrivalStatus::WholeArrived;};
-    auto resetDescriptor = [&](int descriptorIndex) {getReadyFifoUser()->entries[descriptorIndex].reset();};
+  // Check for arrivals & handle them. With interrupts enabled, only if the card signalled something.
+  bool arrived = false;
+  if (!mSuperpageQueue.getArrivals().empty() && checkInterrupt()) {
+    // XXX Dirty hack for now: write length field into page SDH. In upcoming firmwares, the card will do this
+    // itself. Optional, since it means writing into every page of received data.
+    auto writeSdhEventSize = [](uintptr_t pageAddress, uint32_t eventSize){
+      constexpr size_t OFFSET_SDH_EVENT_SIZE = 16; // 1 * 128b word
+      auto address = reinterpret_cast<uint32_t*>(pageAddress + OFFSET_SDH_EVENT_SIZE);
+      address[0] = 0;
+      address[1] = 0;
+      address[2] = 0;
+      address[3] = eventSize;
+    };
 
     while (mFifoSize > 0) {
-      SuperpageQueueEntry& entry = mSuperpageQueue.getArrivalsFrontEntry();
-
-      if (isArrived(mFifoBack)) {
-        // XXX Dirty hack for now: write length field into page SDH. In upcoming firmwares, the card will do this
-        // itself
-        auto writeSdhEventSize = [](uintptr_t pageAddress, uint32_t eventSize){
-          constexpr size_t OFFSET_SDH_EVENT_SIZE = 16; // 1 * 128b word
-//          auto address = reinterpret_cast<char*>(pageAddress + OFFSET_SDH_EVENT_SIZE);
-//          // Clear first 3 32b values of event size word
-//          memset(address, 0, sizeof(uint32_t) * 3);
-//          // Write to 4th 32b value of event size word
-//          memcpy(address + (sizeof(uint32_t) * 3), &eventSize, sizeof(uint32_t));
-          auto address = reinterpret_cast<volatile uint32_t*>(pageAddress + OFFSET_SDH_EVENT_SIZE);
-          address[0] = 0;
-          address[1] = 0;
-          address[2] = 0;
-          address[3] = eventSize;
-        };
-
-        uint32_t length = getReadyFifoUser()->entries[mFifoBack].getSize();
-        auto pageAddress = mDmaBufferUserspace + entry.superpage.getOffset() + entry.superpage.getReceived();
-        writeSdhEventSize(pageAddress, length);
-
-        resetDescriptor(mFifoBack);
-        mFifoSize--;
-        mFifoBack = (mFifoBack + 1) % READYFIFO_ENTRIES;
-        entry.superpage.setReceived(entry.superpage.getReceived() + mPageSize);
+      // Find the run of wholly arrived entries, up to where the Ready FIFO wraps around
+      int run = getReadyFifoUser()->countArrived(mFifoBack, std::min(mFifoSize, READYFIFO_ENTRIES - mFifoBack));
+      if (run == 0) {
+        // The back one hasn't arrived yet, so the next ones will certainly not have arrived either... Or it arrived
+        // with an error, in which case this throws.
+        dataArrived(mFifoBack);
+        break;
+      }
+
+      // Retire the run, one superpage at a time
+      while (run > 0) {
+        SuperpageQueueEntry& entry = mSuperpageQueue.getArrivalsFrontEntry();
+        auto received = entry.superpage.getReceived();
+        int pages = std::min(run, int((entry.superpage.getSize() - received) / mPageSize));
+        assert(pages > 0);
+
+        if (auto pageLengths = entry.superpage.getPageLengths()) {
+          auto firstPage = received / mPageSize;
+          for (int i = 0; i < pages; ++i) {
+            pageLengths[firstPage + i] = getReadyFifoUser()->entries[mFifoBack + i].getSize();
+          }
+        }
+        if (mSdhEventSizeEnabled) {
+          for (int i = 0; i < pages; ++i) {
+            uint32_t length = getReadyFifoUser()->entries[mFifoBack + i].getSize();
+            writeSdhEventSize(getUserspaceAddress(entry.superpage) + received + i * mPageSize, length);
+          }
+        }
+
+        getReadyFifoUser()->reset(mFifoBack, pages);
+        mFifoSize -= pages;
+        mFifoBack = (mFifoBack + pages) % READYFIFO_ENTRIES;
+        entry.superpage.setReceived(received + pages * mPageSize);
+        run -= pages;
 
         if (entry.superpage.isFilled()) {
           // Move superpage to filled queue
           entry.superpage.setReady(true);
+          entry.superpage.setTimestamp(Utilities::getTimestampCounter());
+          getStatisticsCounters().superpageArrived(0, entry.superpage.getReceived());
+          getTraceRing().record(TraceRing::Event::Arrived, 0, entry.superpage.getReceived());
           mSuperpageQueue.moveFromArrivalsToFilledQueue();
+          getStatisticsCounters().readyQueueSize(mSuperpageQueue.getFilled().size());
+          arrived = true;
         }
-      } else {
-        // If the back one hasn't arrived yet, the next ones will certainly not have arrived either...
-        break;
       }
     }
   }
+
+  if (mFlushTimeout && !mPendingDmaStart && flushIdleSuperpage()) {
+    arrived = true;
+  }
+
+  if (!arrived) {
+    getStatisticsCounters().emptyFill();
+  }
 }
 
-void CrorcDmaChannel::pushIntoSuperpage(SuperpageQueueEntry& entry)
+bool CrorcDmaChannel::flushIdleSuperpage()
 {
-  assert(mFifoSize < FIFO_QUEUE_MAX);
-  assert(entry.pushedPages < entry.maxPages);
+  if (mSuperpageQueue.getArrivals().empty()) {
+    return false;
+  }
+  const auto& superpage = mSuperpageQueue.getArrivalsFrontEntry().superpage;
+  if (!mFlushWatch.isIdle(superpage.getOffset(), superpage.getReceived(), *mFlushTimeout,
+      SuperpageFlushWatch::Clock::now())) {
+    return false;
+  }
+  if (mSuperpageQueue.isFull()) {
+    // The split off part needs a slot of its own, we try again when the user popped one
+    return false;
+  }
 
-  pushFreeFifoPage(getFifoFront(), getNextSuperpageBusAddress(entry));
-  mFifoSize++;
-  entry.pushedPages++;
+  // The card keeps filling the pages it was given in the rest of the superpage, so only the received part is handed
+  // over
+  auto& split = mSuperpageQueue.getEntry(mSuperpageQueue.splitArrivalsFront(mPageSize)).superpage;
+  split.setTimestamp(Utilities::getTimestampCounter());
+  getStatisticsCounters().superpageArrived(0, split.getReceived());
+  getTraceRing().record(TraceRing::Event::Flushed, 0, split.getReceived());
+  getStatisticsCounters().readyQueueSize(mSuperpageQueue.getFilled().size());
+  return true;
+}
+
+void CrorcDmaChannel::pushIntoSuperpage(SuperpageQueueEntry& entry, int count)
+{
+  assert(mFifoSize + count <= FIFO_QUEUE_MAX);
+  assert(entry.pushedPages + count <= entry.maxPages);
+
+  // The pages are consecutive in the superpage and in the Ready FIFO, so they're pushed in runs that only need to be
+  // split where the Ready FIFO wraps around
+  while (count > 0) {
+    int readyFifoIndex = getFifoFront();
+    int run = std::min(count, READYFIFO_ENTRIES - readyFifoIndex);
+    getBar()->pushFreeFifoPages(getNextSuperpageBusAddress(entry), mPageSize, readyFifoIndex, run);
+    mFifoSize += run;
+    entry.pushedPages += run;
+    count -= run;
+  }
 }
 
 uintptr_t CrorcDmaChannel::getNextSuperpageBusAddress(const SuperpageQueueEntry& entry)
@@ -404,16 +754,10 @@ uintptr_t CrorcDmaChannel::getNextSuperpageBusAddress(const SuperpageQueueEntry&
   return pageBusAddress;
 }
 
-void CrorcDmaChannel::pushFreeFifoPage(int readyFifoIndex, uintptr_t pageBusAddress)
-{
-  size_t pageWords = mPageSize / 4; // Size in 32-bit words
-  getCrorc().pushRxFreeFifo(pageBusAddress, pageWords, readyFifoIndex);
-}
-
 CrorcDmaChannel::DataArrivalStatus::type CrorcDmaChannel::dataArrived(int index)
 {
+  auto status = getReadyFifoUser()->entries[index].loadStatus();
   auto length = getReadyFifoUser()->entries[index].length;
-  auto status = getReadyFifoUser()->entries[index].status;
 
   if (status == -1) {
     return DataArrivalStatus::NoneArrived;
@@ -455,6 +799,14 @@ boost::optional<std::string> CrorcDmaChannel::getFirmwareInfo()
   return getBar2()->getFirmwareInfo();
 }
 
+BarStatistics CrorcDmaChannel::getBarStatistics()
+{
+  auto statistics = getBar()->getBarStatistics();
+  auto statistics2 = getBar2()->getBarStatistics();
+  statistics.insert(statistics.end(), statistics2.begin(), statistics2.end());
+  return statistics;
+}
+
 } // namespace roc
 } // namespace AliceO2
 
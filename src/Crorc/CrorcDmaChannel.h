@@ -7,6 +7,7 @@
 #ifndef ALICEO2_SRC_READOUTCARD_CRORC_CRORCDMACHANNEL_H_
 #define ALICEO2_SRC_READOUTCARD_CRORC_CRORCDMACHANNEL_H_
 
+#include <chrono>
 #include <mutex>
 #include <unordered_map>
 #include <boost/circular_buffer_fwd.hpp>
@@ -14,8 +15,10 @@
 #include "DmaChannelPdaBase.h"
 #include "Crorc.h"
 #include "CrorcBar.h"
+#include "CrorcStartCoordinator.h"
 #include "ReadoutCard/Parameters.h"
 #include "ReadyFifo.h"
+#include "SuperpageFlushWatch.h"
 #include "SuperpageQueue.h"
 
 namespace AliceO2 {
@@ -32,38 +35,67 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
 
     virtual CardType::type getCardType() override;
 
+    virtual size_t getDmaPageSize() override
+    {
+      return mPageSize;
+    }
+
     virtual bool injectError() override
     {
         return false;
     }
     virtual boost::optional<int32_t> getSerial() override;
     virtual boost::optional<std::string> getFirmwareInfo() override;
+    virtual BarStatistics getBarStatistics() override;
 
     virtual void pushSuperpage(Superpage superpage) override;
+    virtual bool tryPushSuperpage(const Superpage& superpage) override;
+    virtual void pushSuperpages(const Superpage* superpages, size_t count) override;
+    virtual void validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId) override;
+    virtual void releaseSuperpage(Superpage superpage) override;
 
     virtual int getTransferQueueAvailable() override;
     virtual int getReadyQueueSize() override;
 
     virtual Superpage getSuperpage() override;
     virtual Superpage popSuperpage() override;
+    virtual bool tryPopSuperpage(Superpage& superpage) override;
+    virtual size_t popSuperpages(Superpage* superpages, size_t max) override;
     virtual void fillSuperpages() override;
+    virtual size_t getPartialSuperpages(Superpage* superpages, size_t max) override;
 
     AllowedChannels allowedChannels();
 
   protected:
 
     virtual void deviceStartDma() override;
+    virtual void devicePrepareDma() override;
+    virtual void deviceStartPreparedDma() override;
     virtual void deviceStopDma() override;
+    virtual void deviceRecover() override;
+    virtual void deviceStartNextRun() override;
     virtual void deviceResetChannel(ResetLevel::type resetLevel) override;
 
   private:
-    /// Limits the number of superpages allowed in the queue
-    static constexpr size_t MAX_SUPERPAGES = 32;
+    /// Default DMA page size, 8 KiB for uniformity with the CRU
+    static constexpr size_t DEFAULT_PAGE_SIZE = 8 * 1024;
+
+    /// Smallest supported DMA page size
+    static constexpr size_t MIN_PAGE_SIZE = 2 * 1024;
+
+    /// Default limit of the number of superpages allowed in the queue
+    static constexpr size_t DEFAULT_SUPERPAGE_QUEUE_CAPACITY = 32;
 
     /// Firmware FIFO Size
     static constexpr size_t FIFO_QUEUE_MAX = READYFIFO_ENTRIES;
 
-    using SuperpageQueueType = SuperpageQueue<MAX_SUPERPAGES>;
+    /// Maximum time to wait for the initial pages to arrive when starting DMA
+    static constexpr std::chrono::milliseconds INITIAL_PAGES_TIMEOUT { 10 };
+
+    /// Maximum time to wait for the card to reset the Free FIFO
+    static constexpr std::chrono::milliseconds FREE_FIFO_RESET_TIMEOUT { 10 };
+
+    using SuperpageQueueType = SuperpageQueue;
     using SuperpageQueueEntry = SuperpageQueueType::SuperpageQueueEntry;
 
     /// Namespace for enum describing the status of a page's arrival
@@ -79,6 +111,16 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
 
     uintptr_t getNextSuperpageBusAddress(const SuperpageQueueEntry& superpage);
 
+    /// Selects the DMA page size: the DmaPageSize parameter if given, otherwise the smallest page that fits the
+    /// GeneratorDataSize parameter, otherwise the default
+    static size_t selectPageSize(const Parameters& parameters);
+
+    /// Checks if the superpage is acceptable for the C-RORC backend
+    void checkCrorcSuperpage(const Superpage& superpage);
+
+    /// Adds an already checked superpage to the superpage queue
+    void addSuperpageToQueue(const Superpage& superpage);
+
     /// C-RORC function helper
     Crorc::Crorc getCrorc()
     {
@@ -101,19 +143,27 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
     /// Initializes and starts the data generator
     void startDataGenerator();
 
-    /// Pushes a page to the CRORC's Free FIFO
-    /// \param readyFifoIndex Index of the Ready FIFO to write the page's transfer status to
-    /// \param pageBusAddress Address on the bus to push the page to
-    void pushFreeFifoPage(int readyFifoIndex, uintptr_t pageBusAddress);
-
     /// Check if data has arrived
     DataArrivalStatus::type dataArrived(int index);
 
+    /// Resets the queues and sets the pending DMA start state, see deviceStartDma()
+    void deferDmaStart();
+
     /// Starts pending DMA with given superpage for the initial pages
     void startPendingDma(SuperpageQueueEntry& superpage);
 
-    /// Push a page into a superpage
-    void pushIntoSuperpage(SuperpageQueueEntry& superpage);
+    /// Arms the channel for a start synchronized with the other channels of the SynchronizedStartChannels parameter,
+    /// with the given superpage for the initial pages. The last channel to be armed starts the readout of all of them.
+    void armSynchronizedStart(SuperpageQueueEntry& superpage);
+
+    /// Splits the received part off the superpage being filled if it got no new pages for the SuperpageFlushTimeout
+    /// \return True if a superpage was flushed to the ready queue
+    bool flushIdleSuperpage();
+
+    /// Push pages into a superpage
+    /// \param superpage Superpage to push the pages of
+    /// \param count Amount of pages to push
+    void pushIntoSuperpage(SuperpageQueueEntry& superpage, int count);
 
     /// Get front index of FIFO
     int getFifoFront() const
@@ -158,9 +208,6 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
     /// Queue for superpages
     SuperpageQueueType mSuperpageQueue;
 
-    /// Address of DMA buffer in userspace
-    uintptr_t mDmaBufferUserspace = 0;
-
     /// Indicates deviceStartDma() was called, but DMA was not actually started yet. We do this because we need a
     /// superpage to actually start.
     bool mPendingDmaStart = false;
@@ -188,6 +235,9 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
     /// Enables the data generator
     const bool mGeneratorEnabled;
 
+    /// Write the length of arrived pages into their SDH
+    const bool mSdhEventSizeEnabled;
+
     /// Data pattern for the data generator
     const GeneratorPattern::type mGeneratorPattern;
 
@@ -209,6 +259,25 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
     /// Use continuous readout mode
     const bool mUseContinuousReadout;
 
+    /// Skip the channel reset and DIU detection on restarts
+    const bool mWarmRestartEnabled;
+
+    /// Coordinates the start with the other channels of the card, if the SynchronizedStartChannels parameter is set
+    std::shared_ptr<CrorcStartCoordinator> mStartCoordinator;
+
+    /// Time without new pages after which the received part of a superpage is flushed, if enabled
+    const boost::optional<std::chrono::nanoseconds> mFlushTimeout;
+
+    /// Watches the superpage being filled for the flush timeout
+    SuperpageFlushWatch mFlushWatch;
+
+    /// True once DMA was actually started, so the DIU config is known
+    bool mStartedBefore = false;
+
+    /// True from prepareDma() or recover() until the DMA actually started, which then skips the DIU detection and the
+    /// channel reset since they were done already
+    bool mChannelResetDone = false;
+
     Crorc::Crorc::DiuConfig mDiuConfig;
 };
 
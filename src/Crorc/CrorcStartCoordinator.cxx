@@ -0,0 +1,108 @@
+/// \file CrorcStartCoordinator.cxx
+/// \brief Implementation of the CrorcStartCoordinator class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "Crorc/CrorcStartCoordinator.h"
+#include <map>
+#include <string>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Coordinators by PCI address, kept as long as a channel uses them
+struct CoordinatorCache
+{
+    std::mutex mutex;
+    std::map<std::string, std::weak_ptr<CrorcStartCoordinator>> coordinators;
+};
+
+CoordinatorCache& getCoordinatorCache()
+{
+  static CoordinatorCache cache;
+  return cache;
+}
+
+} // Anonymous namespace
+
+std::shared_ptr<CrorcStartCoordinator> CrorcStartCoordinator::get(const PciAddress& pciAddress,
+    const Channels& channels)
+{
+  auto& cache = getCoordinatorCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto& entry = cache.coordinators[pciAddress.toString()];
+  auto coordinator = entry.lock();
+  if (!coordinator) {
+    coordinator = std::make_shared<CrorcStartCoordinator>(channels);
+    entry = coordinator;
+  } else if (coordinator->getChannels() != channels) {
+    BOOST_THROW_EXCEPTION(CrorcException()
+        << ErrorInfo::Message("Channels of the card were opened with different SynchronizedStartChannels parameters")
+        << ErrorInfo::PciAddress(pciAddress));
+  }
+  return coordinator;
+}
+
+CrorcStartCoordinator::CrorcStartCoordinator(const Channels& channels) : mChannels(channels)
+{
+  if (mChannels.empty()) {
+    BOOST_THROW_EXCEPTION(CrorcException() << ErrorInfo::Message("No channels to start together"));
+  }
+}
+
+void CrorcStartCoordinator::checkChannel(uint32_t channel) const
+{
+  if (mChannels.count(channel) == 0) {
+    BOOST_THROW_EXCEPTION(CrorcException()
+        << ErrorInfo::Message("Channel is not one of the SynchronizedStartChannels")
+        << ErrorInfo::ChannelNumber(channel));
+  }
+}
+
+void CrorcStartCoordinator::beginArming(uint32_t channel, const std::function<void()>& configure)
+{
+  checkChannel(channel);
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mConfigured) {
+    configure();
+    mConfigured = true;
+  }
+}
+
+bool CrorcStartCoordinator::armed(uint32_t channel, const std::function<void()>& trigger)
+{
+  checkChannel(channel);
+  std::lock_guard<std::mutex> lock(mMutex);
+  mArmed.insert(channel);
+  if (mArmed != mChannels) {
+    return false;
+  }
+  trigger();
+  mArmed.clear();
+  mConfigured = false;
+  mStartCount++;
+  return true;
+}
+
+void CrorcStartCoordinator::disarm(uint32_t channel)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mArmed.erase(channel);
+}
+
+auto CrorcStartCoordinator::getArmed() const -> Channels
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mArmed;
+}
+
+uint64_t CrorcStartCoordinator::getStartCount() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStartCount;
+}
+
+} // namespace roc
+} // namespace AliceO2
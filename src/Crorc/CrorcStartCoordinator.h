@@ -0,0 +1,88 @@
+/// \file CrorcStartCoordinator.h
+/// \brief Definition of the CrorcStartCoordinator class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_CRORC_CRORCSTARTCOORDINATOR_H_
+#define ALICEO2_SRC_READOUTCARD_CRORC_CRORCSTARTCOORDINATOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Starts the continuous readout of several channels of a C-RORC together.
+///
+/// The continuous readout is configured and started through card-wide registers of BAR 2. Started per channel, every
+/// channel configures the card again and opens the readout gate on its own, after waiting for its initial pages. With
+/// a coordinator, the first channel of a start configures the card, every channel arms itself (resets, fills its Free
+/// FIFO), and the last one to be armed opens the gate for all of them at once, so their data is aligned from the first
+/// page.
+///
+/// The channels of a card share one coordinator per process, through get(). They may be driven from different threads.
+class CrorcStartCoordinator
+{
+  public:
+    using Channels = std::set<uint32_t>;
+
+    /// Gets the coordinator of the card, creating it if no channel uses it yet
+    /// \param pciAddress Address of the card
+    /// \param channels The channels that start together
+    /// \throw Exception if the card's coordinator was created with other channels
+    static std::shared_ptr<CrorcStartCoordinator> get(const PciAddress& pciAddress, const Channels& channels);
+
+    /// \param channels The channels that start together
+    explicit CrorcStartCoordinator(const Channels& channels);
+
+    /// Called by a channel before it arms. The first channel of a start configures the card.
+    /// \param channel The channel
+    /// \param configure Configures the card for continuous readout, called with the coordinator locked
+    /// \throw Exception if the channel is not one of the coordinator's
+    void beginArming(uint32_t channel, const std::function<void()>& configure);
+
+    /// Called by a channel when it's armed. The last channel of a start opens the readout gate.
+    /// \param channel The channel
+    /// \param trigger Starts the readout of the card, called with the coordinator locked
+    /// \return True if this channel started the readout
+    bool armed(uint32_t channel, const std::function<void()>& trigger);
+
+    /// Called by a channel that stops, so a start it was armed for waits for it to arm again
+    void disarm(uint32_t channel);
+
+    /// Gets the channels that start together
+    const Channels& getChannels() const
+    {
+      return mChannels;
+    }
+
+    /// Gets the channels armed for the next start
+    Channels getArmed() const;
+
+    /// Gets the amount of starts given
+    uint64_t getStartCount() const;
+
+  private:
+    void checkChannel(uint32_t channel) const;
+
+    const Channels mChannels;
+
+    mutable std::mutex mMutex;
+
+    /// True once the card was configured for the next start
+    bool mConfigured = false;
+
+    /// Channels armed for the next start
+    Channels mArmed;
+
+    uint64_t mStartCount = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_CRORC_CRORCSTARTCOORDINATOR_H_
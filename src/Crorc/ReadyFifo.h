@@ -8,6 +8,12 @@
 
 #include <cstdint>
 #include <array>
+#include <cstring>
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#include "Crorc/Constants.h"
+#include "Utilities/DmaMemory.h"
 
 namespace AliceO2 {
 namespace roc {
@@ -24,13 +30,20 @@ union ReadyFifo
 {
     struct Entry
     {
-        volatile int32_t length; ///< Length of the received page in 32-bit words
-        volatile int32_t status; ///< Status of the received page
+        int32_t length; ///< Length of the received page in 32-bit words
+        int32_t status; ///< Status of the received page
 
         void reset()
         {
           length = -1;
           status = -1;
+          Utilities::releaseFence();
+        }
+
+        /// Loads the status with acquire ordering, so the length and the page data can be read with plain loads after
+        int32_t loadStatus() const
+        {
+          return Utilities::loadAcquire(status);
         }
 
         uint32_t getSize()
@@ -41,14 +54,58 @@ union ReadyFifo
 
     void reset()
     {
-      for (auto& e : entries) {
-        e.reset();
+      reset(0, READYFIFO_ENTRIES);
+    }
+
+    /// Resets a range of entries in one go. All bits set is -1 for both fields.
+    /// \param begin Index of the first entry
+    /// \param count Amount of entries
+    void reset(int begin, int count)
+    {
+      std::memset(&entries[begin], 0xff, count * sizeof(Entry));
+      Utilities::releaseFence();
+    }
+
+    /// Counts the consecutive entries that have wholly arrived without error, scanning several entries at a time
+    /// \param index Index of the first entry to check
+    /// \param max Maximum amount of entries to check. Must not go past the end of the Ready FIFO.
+    /// The status words are read with plain loads, followed by an acquire fence, so the lengths and the page data of the
+    /// arrived entries can be read with plain loads afterwards.
+    /// \return The amount of arrived entries
+    int countArrived(int index, int max) const
+    {
+      // An entry has wholly arrived when the low byte of its status is DTSW and the error bit is clear
+      constexpr uint32_t STATUS_MASK = 0x800000ff;
+      auto begin = entries.data() + index;
+      int count = 0;
+
+#if defined(__SSE2__)
+      // Two entries fit in a 128-bit word. The length lanes are masked out, so they always compare equal.
+      const __m128i mask = _mm_set_epi32(int(STATUS_MASK), 0, int(STATUS_MASK), 0);
+      const __m128i expected = _mm_set_epi32(Ddl::DTSW, 0, Ddl::DTSW, 0);
+      for (; count + 4 <= max; count += 4) {
+        auto words = reinterpret_cast<const __m128i*>(begin + count);
+        auto low = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(words), mask), expected);
+        auto high = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(words + 1), mask), expected);
+        if (_mm_movemask_epi8(_mm_and_si128(low, high)) != 0xffff) {
+          break;
+        }
+      }
+#endif
+
+      // Remainder, and the exact end of the run within the last four entries
+      for (; count < max; ++count) {
+        if ((uint32_t(Utilities::loadRelaxed(begin[count].status)) & STATUS_MASK) != uint32_t(Ddl::DTSW)) {
+          break;
+        }
       }
+      Utilities::acquireFence();
+      return count;
     }
 
     std::array<Entry, READYFIFO_ENTRIES> entries;
-    std::array<volatile int32_t, READYFIFO_ENTRIES * 2> dataInt32;
-    std::array<volatile char, READYFIFO_ENTRIES * sizeof(Entry)> dataChar;
+    std::array<int32_t, READYFIFO_ENTRIES * 2> dataInt32;
+    std::array<char, READYFIFO_ENTRIES * sizeof(Entry)> dataChar;
 };
 
 // These asserts are to check if the ReadyFifo struct is the expected size, and is not being padded or something like
@@ -6,7 +6,7 @@
 #ifndef ALICEO2_READOUTCARD_CRU_CONSTANTS_H_
 #define ALICEO2_READOUTCARD_CRU_CONSTANTS_H_
 
-#include "Register.h"
+#include "RegisterField.h"
 
 namespace AliceO2
 {
@@ -52,6 +52,14 @@ static constexpr uintptr_t SUPERPAGES_PUSHED_INTERVAL = 0x4;
 /// Amount of completely pushed superpages
 static constexpr IntervalRegister LINK_SUPERPAGES_PUSHED(0x800, SUPERPAGES_PUSHED_INTERVAL);
 
+/// High bus address of the status page the firmware writes the superpage counters to. Provisional: the status page
+/// registers are not in the firmware register map (cru_table.py), so they are only written when the firmware reports
+/// the status page in FIRMWARE_CAPABILITIES.
+static constexpr Register STATUS_PAGE_ADDRESS_HIGH(0x880);
+
+/// Low bus address of the status page. Writing 0 to both address registers disables status page updates.
+static constexpr Register STATUS_PAGE_ADDRESS_LOW(0x884);
+
 /// Enable/disable links
 /// Every bit represents a link. Set a bit to 1 to disable a link.
 static constexpr Register LINKS_ENABLE = 0x604;
@@ -64,6 +72,14 @@ static constexpr Register LINKS_ENABLE = 0x604;
 ///   0b11 -> 0x12345678
 /// Bit 3: set to inject error
 static constexpr Register DATA_GENERATOR_CONTROL(0x600);
+static constexpr RegisterField DATA_GENERATOR_ENABLE(DATA_GENERATOR_CONTROL, 0, 1);
+static constexpr RegisterField DATA_GENERATOR_PATTERN(DATA_GENERATOR_CONTROL, 1, 2);
+static constexpr uint32_t DATA_GENERATOR_PATTERN_INCREMENTAL = 0b01;
+static constexpr uint32_t DATA_GENERATOR_PATTERN_ALTERNATING = 0b10;
+static constexpr uint32_t DATA_GENERATOR_PATTERN_CONSTANT = 0b11;
+/// Size of the generated data, in 256-bit words minus 1
+static constexpr RegisterField DATA_GENERATOR_SIZE(DATA_GENERATOR_CONTROL, 8, 8);
+static constexpr RegisterField DATA_GENERATOR_RANDOM_SIZE(DATA_GENERATOR_CONTROL, 16, 1);
 
 /// Selection of data source
 /// 0x0 -> GBT
@@ -90,6 +106,30 @@ static constexpr Register FIRMWARE_COMPILE_INFO(0x280);
 /// Register containing compilation info of the firmware
 /// Can be used as a sort of version number
 static constexpr Register FIRMWARE_FEATURES(0x41c);
+/// 0x5afe for standalone firmware, whose features are then in the upper bits, cleared when enabled
+static constexpr RegisterField FIRMWARE_FEATURES_SAFEWORD(FIRMWARE_FEATURES, 0, 16);
+static constexpr uint32_t FIRMWARE_FEATURES_SAFEWORD_STANDALONE = 0x5afe;
+
+/// Performance capabilities of the firmware. Set bits are supported. Firmware whose value lacks the safeword, such as
+/// firmware from before the register existed, is taken to support none of them.
+/// Not in the firmware register map (cru_table.py), so it is only read with the FirmwareCapabilitiesEnabled parameter.
+/// * Bits [15:0]: safeword 0xca9a
+/// * Bit 16: writes the superpage counters to a status page in host memory (completion write-back)
+/// * Bit 17: raises an MSI-X interrupt when a superpage completes
+/// * Bit 18: accepts a superpage descriptor as one burst write
+/// * Bits [23:20]: largest DMA page size, as log2 of the multiple of DMA_PAGE_SIZE
+static constexpr Register FIRMWARE_CAPABILITIES(0x420);
+static constexpr RegisterField FIRMWARE_CAPABILITIES_SAFEWORD(FIRMWARE_CAPABILITIES, 0, 16);
+static constexpr uint32_t FIRMWARE_CAPABILITIES_SAFEWORD_VALUE = 0xca9a;
+static constexpr RegisterField FIRMWARE_CAPABILITIES_STATUS_PAGE(FIRMWARE_CAPABILITIES, 16, 1);
+static constexpr RegisterField FIRMWARE_CAPABILITIES_INTERRUPTS(FIRMWARE_CAPABILITIES, 17, 1);
+static constexpr RegisterField FIRMWARE_CAPABILITIES_DESCRIPTOR_BURST(FIRMWARE_CAPABILITIES, 18, 1);
+static constexpr RegisterField FIRMWARE_CAPABILITIES_MAX_PAGE_SIZE(FIRMWARE_CAPABILITIES, 20, 4);
+
+/// DMA page size, as log2 of the multiple of DMA_PAGE_SIZE. Only present on firmware with larger DMA pages, see
+/// FIRMWARE_CAPABILITIES. Not in the firmware register map either, so it is only written when the capabilities were
+/// read and report larger pages.
+static constexpr Register DMA_PAGE_SIZE_SELECT(0x424);
 
 /// Reset control register
 /// * Write a 1 to reset the card
@@ -152,6 +192,11 @@ static constexpr Register WRAPPER0(0x00400000);
 // Must be accessed on BAR 2
 static constexpr Register WRAPPER1(0x00500000);
 
+// Amount of links of a wrapper, in its configuration register at 'add_gbt_wrapper_conf1'
+// Must be accessed on BAR 2
+static constexpr RegisterField WRAPPER0_LINKS(Register(WRAPPER0.address + 0x4), 24, 8);
+static constexpr RegisterField WRAPPER1_LINKS(Register(WRAPPER1.address + 0x4), 24, 8);
+
 } // namespace Cru
 } // namespace Registers
 } // namespace roc
@@ -5,23 +5,85 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 #include "CruBar.h"
+#include <chrono>
+#include <map>
+#include <mutex>
 #include "boost/format.hpp"
+#include "RocPciDevice.h"
 #include "Utilities/Util.h"
 
 namespace AliceO2 {
 namespace roc {
+namespace {
+
+/// Time for which a temperature reading is reused
+constexpr auto TEMPERATURE_SAMPLE_INTERVAL = std::chrono::seconds(1);
+
+/// Information of a card that does not change while the process runs, and its last temperature reading
+struct CardInfo
+{
+    boost::optional<FirmwareFeatures> features;
+    boost::optional<int32_t> serial;
+    boost::optional<std::string> firmwareInfo;
+    boost::optional<std::string> cardId;
+    boost::optional<float> temperature;
+    boost::optional<std::chrono::steady_clock::time_point> temperatureTime;
+};
+
+/// The process-wide cache, keyed by PCI address
+struct CardInfoCache
+{
+    std::mutex mutex;
+    std::map<std::string, CardInfo> cards;
+};
+
+CardInfoCache& getCardInfoCache()
+{
+  static CardInfoCache cache;
+  return cache;
+}
+
+/// Gets a value from the card info cache, reading and caching it if it's not there. The read is done without holding
+/// the lock, so a concurrent first read may happen twice, which is harmless.
+template <typename T, typename Read>
+T getCached(const std::string& key, boost::optional<T> CardInfo::* field, Read read)
+{
+  if (key.empty()) {
+    return read();
+  }
+  auto& cache = getCardInfoCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    const auto& value = cache.cards[key].*field;
+    if (value) {
+      return *value;
+    }
+  }
+  T value = read();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.cards[key].*field = value;
+  return value;
+}
+
+} // Anonymous namespace
 
 CruBar::CruBar(const Parameters& parameters)
-    : BarInterfaceBase(parameters)
+    : BarInterfaceBase(parameters),
+      mCardInfoKey(mRocPciDevice->getPciAddress().toString()),
+      mShadowingEnabled(parameters.getRegisterShadowingEnabled().get_value_or(false))
 {
-  if (mPdaBar->getIndex() == 0)
-    mFeatures = parseFirmwareFeatures();
+  if (mPdaBar->getIndex() == 0) {
+    mFeatures = getCached(mCardInfoKey, &CardInfo::features, [&]{ return parseFirmwareFeatures(); });
+    initLinkRegisters();
+  }
 }
 CruBar::CruBar(std::shared_ptr<Pda::PdaBar> bar)
     : BarInterfaceBase(bar)
 {
-  if (mPdaBar->getIndex() == 0)
+  if (mPdaBar->getIndex() == 0) {
     mFeatures = parseFirmwareFeatures();
+    initLinkRegisters();
+  }
 } 
  
 CruBar::~CruBar()
@@ -38,23 +100,61 @@ void CruBar::CruBar::checkWriteSafe(int, uint32_t)
 
 boost::optional<int32_t> CruBar::getSerial()
 {
-  return getSerialNumber();
+  return getCached(mCardInfoKey, &CardInfo::serial, [&]{ return int32_t(getSerialNumber()); });
 }
 
 boost::optional<float> CruBar::getTemperature()
 {
-  return getTemperatureCelsius();
+  if (mCardInfoKey.empty()) {
+    return getTemperatureCelsius();
+  }
+  auto& cache = getCardInfoCache();
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    const auto& card = cache.cards[mCardInfoKey];
+    if (card.temperatureTime && (now - *card.temperatureTime) < TEMPERATURE_SAMPLE_INTERVAL) {
+      return card.temperature;
+    }
+  }
+  auto temperature = getTemperatureCelsius();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto& card = cache.cards[mCardInfoKey];
+  card.temperature = temperature;
+  card.temperatureTime = now;
+  return temperature;
 }
 
 boost::optional<std::string> CruBar::getFirmwareInfo()
 {
-  return (boost::format("%x-%x-%x") % getFirmwareDate() % getFirmwareTime()
-      % getFirmwareGitHash()).str();
+  return getCached(mCardInfoKey, &CardInfo::firmwareInfo, [&]{
+    return (boost::format("%x-%x-%x") % getFirmwareDate() % getFirmwareTime() % getFirmwareGitHash()).str();
+  });
 }
 
 boost::optional<std::string> CruBar::getCardId()
 {
-  return (boost::format("%08x-%08x") % getFpgaChipHigh() % getFpgaChipLow()).str();
+  return getCached(mCardInfoKey, &CardInfo::cardId, [&]{
+    return (boost::format("%08x-%08x") % getFpgaChipHigh() % getFpgaChipLow()).str();
+  });
+}
+
+void CruBar::invalidateCardInfoCache()
+{
+  auto& cache = getCardInfoCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.cards.clear();
+}
+
+void CruBar::initLinkRegisters()
+{
+  for (int link = 0; link < Cru::MAX_LINKS; ++link) {
+    auto& registers = mLinkRegisters[link];
+    registers.superpageAddressHigh = mPdaBar->getRegisterHandle(Cru::Registers::LINK_SUPERPAGE_ADDRESS_HIGH.get(link));
+    registers.superpageAddressLow = mPdaBar->getRegisterHandle(Cru::Registers::LINK_SUPERPAGE_ADDRESS_LOW.get(link));
+    registers.superpageSize = mPdaBar->getRegisterHandle(Cru::Registers::LINK_SUPERPAGE_SIZE.get(link));
+    registers.superpagesPushed = mPdaBar->getRegisterHandle(Cru::Registers::LINK_SUPERPAGES_PUSHED.get(link));
+  }
 }
 
 /// Push a superpage into the FIFO of a link
@@ -63,20 +163,70 @@ boost::optional<std::string> CruBar::getCardId()
 /// \param busAddress Superpage PCI bus address
 void CruBar::pushSuperpageDescriptor(uint32_t link, uint32_t pages, uintptr_t busAddress)
 {
+  assertBarIndex(0, "Superpage descriptors can only be pushed through BAR 0");
+  if (mWriteCombinedBar) {
+    // Write-combined stores are neither ordered nor guaranteed to be combined. The address registers are consecutive,
+    // so they can go out as one PCIe write, but the first flush must post them before the size write, which signals
+    // the push. The second flush orders the descriptor before the next one.
+    auto descriptor = mWriteCombinedDescriptors.at(link);
+    descriptor[0] = Utilities::getUpper32Bits(busAddress);
+    descriptor[1] = Utilities::getLower32Bits(busAddress);
+    Pda::PdaWriteCombinedBar::flush();
+    descriptor[2] = pages;
+    Pda::PdaWriteCombinedBar::flush();
+    return;
+  }
+
+  const auto& registers = mLinkRegisters.at(link);
   // Set superpage address. These writes are buffered on the firmware side.
-  mPdaBar->writeRegister(Cru::Registers::LINK_SUPERPAGE_ADDRESS_HIGH.get(link).index,
-      Utilities::getUpper32Bits(busAddress));
-  mPdaBar->writeRegister(Cru::Registers::LINK_SUPERPAGE_ADDRESS_LOW.get(link).index,
-      Utilities::getLower32Bits(busAddress));
+  registers.superpageAddressHigh.write(Utilities::getUpper32Bits(busAddress));
+  registers.superpageAddressLow.write(Utilities::getLower32Bits(busAddress));
   // Set superpage size. This write signals the push of the descriptor into the link's FIFO.
-  mPdaBar->writeRegister(Cru::Registers::LINK_SUPERPAGE_SIZE.get(link).index, pages);
+  registers.superpageSize.write(pages);
+}
+
+/// Maps the superpage descriptor registers with write-combining, so pushSuperpageDescriptor() can post the two address
+/// writes of a descriptor as a single PCIe write. The size write is fenced after them, since it signals the push.
+/// \param pciAddress Address of the card
+void CruBar::enableDescriptorWriteCombining(const PciAddress& pciAddress)
+{
+  assertBarIndex(0, "Write-combining can only be enabled on BAR 0");
+  static_assert(Cru::Registers::LINK_SUPERPAGE_ADDRESS_LOW.base == Cru::Registers::LINK_SUPERPAGE_ADDRESS_HIGH.base + 4
+      && Cru::Registers::LINK_SUPERPAGE_SIZE.base == Cru::Registers::LINK_SUPERPAGE_ADDRESS_HIGH.base + 8,
+      "Superpage descriptor registers must be consecutive");
+  const auto& high = Cru::Registers::LINK_SUPERPAGE_ADDRESS_HIGH;
+  mWriteCombinedBar = std::make_unique<Pda::PdaWriteCombinedBar>(pciAddress, 0, high.base,
+      high.interval * Cru::MAX_LINKS);
+  for (int link = 0; link < Cru::MAX_LINKS; ++link) {
+    mWriteCombinedDescriptors[link] = mWriteCombinedBar->getRegisterAddress(high.get(link));
+  }
 }
 
 /// Get amount of superpages pushed by a link
 /// \param link Link number
 uint32_t CruBar::getSuperpageCount(uint32_t link)
 {
-  return mPdaBar->readRegister(Cru::Registers::LINK_SUPERPAGES_PUSHED.get(link).index);
+  assertBarIndex(0, "Superpage counts can only be read through BAR 0");
+  return mLinkRegisters.at(link).superpagesPushed.read();
+}
+
+/// Get amount of superpages pushed by links 0 to (links - 1) with a single block read, since the registers are
+/// consecutive
+/// \param counts Array to store the counts, indexed by link number
+/// \param links Amount of links to read
+void CruBar::getSuperpageCounts(uint32_t* counts, size_t links)
+{
+  static_assert(Cru::Registers::SUPERPAGES_PUSHED_INTERVAL == sizeof(uint32_t),
+      "LINK_SUPERPAGES_PUSHED registers must be consecutive");
+  mPdaBar->readRegisterBlock(Cru::Registers::LINK_SUPERPAGES_PUSHED.get(0).index, counts, links);
+}
+
+/// Sets the bus address of the status page the firmware writes the superpage counters to
+/// \param busAddress Bus address of the status page, or 0 to disable the status page
+void CruBar::setStatusPageAddress(uintptr_t busAddress)
+{
+  mPdaBar->writeRegister(Cru::Registers::STATUS_PAGE_ADDRESS_HIGH.index, Utilities::getUpper32Bits(busAddress));
+  mPdaBar->writeRegister(Cru::Registers::STATUS_PAGE_ADDRESS_LOW.index, Utilities::getLower32Bits(busAddress));
 }
 
 /// Enables the data emulator
@@ -84,21 +234,21 @@ uint32_t CruBar::getSuperpageCount(uint32_t link)
 void CruBar::setDataEmulatorEnabled(bool enabled) const
 {
   mPdaBar->writeRegister(Cru::Registers::DMA_CONTROL.index, enabled ? 0x1 : 0x0);
-  uint32_t bits = mPdaBar->readRegister(Cru::Registers::DATA_GENERATOR_CONTROL.index);
-  setDataGeneratorEnableBits(bits, enabled);
-  mPdaBar->writeRegister(Cru::Registers::DATA_GENERATOR_CONTROL.index, bits);
+  writeDataGeneratorControl(Cru::Registers::DATA_GENERATOR_ENABLE(enabled).apply(readDataGeneratorControl()));
 }
 
 /// Resets the data generator counter
 void CruBar::resetDataGeneratorCounter() const
 {
   mPdaBar->writeRegister(Cru::Registers::RESET_CONTROL.index, 0x2);
+  invalidateShadowRegisters();
 }
 
 /// Performs a general reset of the card
 void CruBar::resetCard() const
 {
   mPdaBar->writeRegister(Cru::Registers::RESET_CONTROL.index, 0x1);
+  invalidateShadowRegisters();
 }
 
 /// Sets the pattern for the card's internal data generator
@@ -107,11 +257,10 @@ void CruBar::resetCard() const
 /// \param randomEnabled Give true to enable random data size. In this case, the given size is the maximum size (?)
 void CruBar::setDataGeneratorPattern(GeneratorPattern::type pattern, size_t size, bool randomEnabled)
 {
-  uint32_t bits = mPdaBar->readRegister(Cru::Registers::DATA_GENERATOR_CONTROL.index);
-  setDataGeneratorPatternBits(bits, pattern);
-  setDataGeneratorSizeBits(bits, size);
-  setDataGeneratorRandomSizeBits(bits, randomEnabled);
-  mPdaBar->writeRegister(Cru::Registers::DATA_GENERATOR_CONTROL.index, bits);
+  using namespace Cru::Registers;
+  const auto values = DATA_GENERATOR_PATTERN(getDataGeneratorPatternValue(pattern))
+      | DATA_GENERATOR_SIZE(getDataGeneratorSizeValue(size)) | DATA_GENERATOR_RANDOM_SIZE(randomEnabled);
+  writeDataGeneratorControl(values.apply(readDataGeneratorControl()));
 }
 
 /// Injects a single error into the generated data stream
@@ -133,6 +282,47 @@ void CruBar::setLinksEnabled(uint32_t mask)
   mPdaBar->writeRegister(Cru::Registers::LINKS_ENABLE.index, mask);
 }
 
+/// Sets the DMA page size. Only for firmware that reports pages larger than Cru::DMA_PAGE_SIZE in its capabilities, see
+/// getFirmwareCapabilities().
+/// \param size Page size in bytes, a power of two multiple of Cru::DMA_PAGE_SIZE
+void CruBar::setDmaPageSize(size_t size)
+{
+  uint32_t shift = 0;
+  while ((Cru::DMA_PAGE_SIZE << shift) < size) {
+    shift++;
+  }
+  mPdaBar->writeRegister(Cru::Registers::DMA_PAGE_SIZE_SELECT.index, shift);
+}
+
+/// Drops the shadowed register values, so they are read from the card again. Needed when the registers may have been
+/// changed behind the driver's back, such as by a reset.
+void CruBar::invalidateShadowRegisters() const
+{
+  mDataGeneratorControl = boost::none;
+}
+
+/// Reads DATA_GENERATOR_CONTROL, from the shadow if it has the value
+uint32_t CruBar::readDataGeneratorControl() const
+{
+  if (mDataGeneratorControl) {
+    return *mDataGeneratorControl;
+  }
+  uint32_t value = mPdaBar->readRegister(Cru::Registers::DATA_GENERATOR_CONTROL.index);
+  if (mShadowingEnabled) {
+    mDataGeneratorControl = value;
+  }
+  return value;
+}
+
+/// Writes DATA_GENERATOR_CONTROL, through the shadow if enabled
+void CruBar::writeDataGeneratorControl(uint32_t value) const
+{
+  mPdaBar->writeRegister(Cru::Registers::DATA_GENERATOR_CONTROL.index, value);
+  if (mShadowingEnabled) {
+    mDataGeneratorControl = value;
+  }
+}
+
 FirmwareFeatures CruBar::getFirmwareFeatures()
 {
   return mFeatures;
@@ -159,14 +349,7 @@ uint32_t CruBar::getLocalClock()
 // Get total # of links per wrapper
 int32_t CruBar::getLinks()
 {
-  int32_t links = 0;
-  uint32_t regread = 0x0;
-  regread = mPdaBar->readRegister((Cru::Registers::WRAPPER0.address + 0x4) / 4);
-  links += Utilities::getBits(regread, 24, 31);
-  regread = mPdaBar->readRegister((Cru::Registers::WRAPPER1.address + 0x4) / 4);
-  links += Utilities::getBits(regread, 24, 31);
-
-  return links;
+  return getLinksPerWrapper(0) + getLinksPerWrapper(1);
 
 }
 
@@ -174,15 +357,11 @@ int32_t CruBar::getLinks()
 // Get # of links per wrapper
 int32_t CruBar::getLinksPerWrapper(uint32_t wrapper)
 {
-  uint32_t regread = 0x0;
-  if (wrapper == 0)
-    regread = mPdaBar->readRegister((Cru::Registers::WRAPPER0.address + 0x4) / 4);
-  else if (wrapper == 1)
-    regread = mPdaBar->readRegister((Cru::Registers::WRAPPER1.address + 0x4) / 4);
-  else
+  if (wrapper > 1) {
     return 0;
-
-  return Utilities::getBits(regread, 24, 31);
+  }
+  const auto& field = wrapper == 0 ? Cru::Registers::WRAPPER0_LINKS : Cru::Registers::WRAPPER1_LINKS;
+  return field.get(mPdaBar->readRegister(field.reg.index));
 
 }
 
@@ -283,11 +462,22 @@ FirmwareFeatures CruBar::parseFirmwareFeatures()
   return convertToFirmwareFeatures(mPdaBar->readRegister(Cru::Registers::FIRMWARE_FEATURES.index));
 }
 
-FirmwareFeatures CruBar::convertToFirmwareFeatures(uint32_t reg)
+/// Get the enabled features for the card's firmware, with the performance capabilities. FIRMWARE_CAPABILITIES is not
+/// in the firmware register map, so it is only read when asked for with the FirmwareCapabilitiesEnabled parameter.
+FirmwareFeatures CruBar::getFirmwareCapabilities()
+{
+  assertBarIndex(0, "Can only get firmware capabilities from BAR 0");
+  return convertToFirmwareFeatures(mPdaBar->readRegister(Cru::Registers::FIRMWARE_FEATURES.index),
+      mPdaBar->readRegister(Cru::Registers::FIRMWARE_CAPABILITIES.index));
+}
+
+/// Converts the values of the features and capabilities registers
+/// \param reg Value of the FIRMWARE_FEATURES register
+/// \param capabilities Value of the FIRMWARE_CAPABILITIES register
+FirmwareFeatures CruBar::convertToFirmwareFeatures(uint32_t reg, uint32_t capabilities)
 {
   FirmwareFeatures features;
-  uint32_t safeword = Utilities::getBits(reg, 0, 15);
-  if (safeword == 0x5afe) {
+  if (Cru::Registers::FIRMWARE_FEATURES_SAFEWORD.get(reg) == Cru::Registers::FIRMWARE_FEATURES_SAFEWORD_STANDALONE) {
     // Standalone firmware
     auto enabled = [&](int i){ return Utilities::getBit(reg, i) == 0; };
     features.standalone = true;
@@ -305,37 +495,37 @@ FirmwareFeatures CruBar::convertToFirmwareFeatures(uint32_t reg)
     features.firmwareInfo = true;
     features.chipId = true;
   }
+
+  using namespace Cru::Registers;
+  if (FIRMWARE_CAPABILITIES_SAFEWORD.get(capabilities) == FIRMWARE_CAPABILITIES_SAFEWORD_VALUE) {
+    features.statusPage = FIRMWARE_CAPABILITIES_STATUS_PAGE.get(capabilities);
+    features.interrupts = FIRMWARE_CAPABILITIES_INTERRUPTS.get(capabilities);
+    features.descriptorBurst = FIRMWARE_CAPABILITIES_DESCRIPTOR_BURST.get(capabilities);
+    features.maxDmaPageSize = Cru::DMA_PAGE_SIZE << FIRMWARE_CAPABILITIES_MAX_PAGE_SIZE.get(capabilities);
+  }
   return features;
 }
 
-/// Sets the bits for the data generator pattern in the given integer
-/// \param bits Integer with bits to set
+/// Gets the value of the data generator pattern field for a pattern
 /// \param pattern Pattern to set
-void CruBar::setDataGeneratorPatternBits(uint32_t& bits, GeneratorPattern::type pattern)
+uint32_t CruBar::getDataGeneratorPatternValue(GeneratorPattern::type pattern)
 {
   switch (pattern) {
     case GeneratorPattern::Incremental:
-      Utilities::setBit(bits, 1, true);
-      Utilities::setBit(bits, 2, false);
-      break;
+      return Cru::Registers::DATA_GENERATOR_PATTERN_INCREMENTAL;
     case GeneratorPattern::Alternating:
-      Utilities::setBit(bits, 1, false);
-      Utilities::setBit(bits, 2, true);
-      break;
+      return Cru::Registers::DATA_GENERATOR_PATTERN_ALTERNATING;
     case GeneratorPattern::Constant:
-      Utilities::setBit(bits, 1, true);
-      Utilities::setBit(bits, 2, true);
-      break;
+      return Cru::Registers::DATA_GENERATOR_PATTERN_CONSTANT;
     default:
       BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Unsupported generator pattern for CRU")
           << ErrorInfo::GeneratorPattern(pattern));
   }
 }
 
-/// Sets the bits for the data generator size in the given integer
-/// \param bits Integer with bits to set
+/// Gets the value of the data generator size field for a size
 /// \param size Size to set
-void CruBar::setDataGeneratorSizeBits(uint32_t& bits, size_t size)
+uint32_t CruBar::getDataGeneratorSizeValue(size_t size)
 {
   if (!Utilities::isMultiple(size, 32ul)) {
     BOOST_THROW_EXCEPTION(Exception()
@@ -350,9 +540,23 @@ void CruBar::setDataGeneratorSizeBits(uint32_t& bits, size_t size)
   }
 
   // We set the size in 256-bit (32 byte) words and do -1 because that's how it works.
-  uint32_t sizeValue = ((size/32) - 1) << 8;
-  bits &= ~(uint32_t(0xff00));
-  bits += sizeValue;
+  return (size / 32) - 1;
+}
+
+/// Sets the bits for the data generator pattern in the given integer
+/// \param bits Integer with bits to set
+/// \param pattern Pattern to set
+void CruBar::setDataGeneratorPatternBits(uint32_t& bits, GeneratorPattern::type pattern)
+{
+  bits = Cru::Registers::DATA_GENERATOR_PATTERN.set(bits, getDataGeneratorPatternValue(pattern));
+}
+
+/// Sets the bits for the data generator size in the given integer
+/// \param bits Integer with bits to set
+/// \param size Size to set
+void CruBar::setDataGeneratorSizeBits(uint32_t& bits, size_t size)
+{
+  bits = Cru::Registers::DATA_GENERATOR_SIZE.set(bits, getDataGeneratorSizeValue(size));
 }
 
 /// Sets the bits for the data generator enabled in the given integer
@@ -360,7 +564,7 @@ void CruBar::setDataGeneratorSizeBits(uint32_t& bits, size_t size)
 /// \param enabled Generator enabled or not
 void CruBar::setDataGeneratorEnableBits(uint32_t& bits, bool enabled)
 {
-  Utilities::setBit(bits, 0, enabled);
+  bits = Cru::Registers::DATA_GENERATOR_ENABLE.set(bits, enabled);
 }
 
 /// Sets the bits for the data generator random size in the given integer
@@ -368,7 +572,7 @@ void CruBar::setDataGeneratorEnableBits(uint32_t& bits, bool enabled)
 /// \param enabled Random enabled or not
 void CruBar::setDataGeneratorRandomSizeBits(uint32_t& bits, bool enabled)
 {
-  Utilities::setBit(bits, 16, enabled);
+  bits = Cru::Registers::DATA_GENERATOR_RANDOM_SIZE.set(bits, enabled);
 }
 
 } // namespace roc
@@ -7,13 +7,17 @@
 #ifndef ALICEO2_READOUTCARD_CRU_CRUBAR_H_
 #define ALICEO2_READOUTCARD_CRU_CRUBAR_H_
 
+#include <array>
 #include <cstddef>
+#include <memory>
+#include <string>
 #include <boost/optional/optional.hpp>
 #include "BarInterfaceBase.h"
 #include "Cru/Constants.h"
 #include "Cru/FirmwareFeatures.h"
 #include "ExceptionInternal.h"
 #include "Pda/PdaBar.h"
+#include "Pda/PdaWriteCombinedBar.h"
 #include "Utilities/Util.h"
 
 namespace AliceO2 {
@@ -47,6 +51,9 @@ class CruBar final : public BarInterfaceBase
 
     void pushSuperpageDescriptor(uint32_t link, uint32_t pages, uintptr_t busAddress);
     uint32_t getSuperpageCount(uint32_t link);
+    void getSuperpageCounts(uint32_t* counts, size_t links);
+    void setStatusPageAddress(uintptr_t busAddress);
+    void enableDescriptorWriteCombining(const PciAddress& pciAddress);
     void setDataEmulatorEnabled(bool enabled) const;
     void resetDataGeneratorCounter() const;
     void resetCard() const;
@@ -54,9 +61,20 @@ class CruBar final : public BarInterfaceBase
     void dataGeneratorInjectError();
     void setDataSource(uint32_t source);
     void setLinksEnabled(uint32_t mask);
+    void setDmaPageSize(size_t size);
+    void invalidateShadowRegisters() const;
     FirmwareFeatures getFirmwareFeatures();
+    FirmwareFeatures getFirmwareCapabilities();
  
-    static FirmwareFeatures convertToFirmwareFeatures(uint32_t reg);
+    static FirmwareFeatures convertToFirmwareFeatures(uint32_t reg, uint32_t capabilities = 0);
+
+    /// The serial, firmware info, card ID and firmware features of the cards are read once per process, and the
+    /// temperature at most once per second, so monitoring doesn't compete with DMA for the BAR.
+    /// This drops the cached values, to be done after a card was reflashed or replaced.
+    static void invalidateCardInfoCache();
+
+    static uint32_t getDataGeneratorPatternValue(GeneratorPattern::type pattern);
+    static uint32_t getDataGeneratorSizeValue(size_t size);
 
     static void setDataGeneratorPatternBits(uint32_t& bits, GeneratorPattern::type pattern);
 
@@ -78,9 +96,43 @@ class CruBar final : public BarInterfaceBase
     uint32_t getFpgaChipLow();
 
     FirmwareFeatures parseFirmwareFeatures();
+
+    uint32_t readDataGeneratorControl() const;
+    void writeDataGeneratorControl(uint32_t value) const;
+
+    /// Resolves the handles of the per-link registers used on the DMA hot path
+    void initLinkRegisters();
  
     FirmwareFeatures mFeatures;
 
+    /// Key of the card in the card info cache, empty if the card is unknown and nothing is cached
+    std::string mCardInfoKey;
+
+    /// If enabled, the registers the driver read-modify-writes are shadowed, see Parameters::setRegisterShadowingEnabled()
+    bool mShadowingEnabled = false;
+
+    /// Last value written to DATA_GENERATOR_CONTROL, if shadowed. Empty until the first read or after a reset.
+    mutable boost::optional<uint32_t> mDataGeneratorControl;
+
+    /// Handles of the registers used to push superpage descriptors and read the superpage counts of a link
+    struct LinkRegisters
+    {
+        Pda::PdaBar::RegisterHandle superpageAddressHigh;
+        Pda::PdaBar::RegisterHandle superpageAddressLow;
+        Pda::PdaBar::RegisterHandle superpageSize;
+        Pda::PdaBar::RegisterHandle superpagesPushed;
+    };
+
+    /// Per-link register handles, indexed by link ID. Only resolved for BAR 0.
+    std::array<LinkRegisters, Cru::MAX_LINKS> mLinkRegisters;
+
+    /// Write-combined mapping of the superpage descriptor registers, if enabled
+    std::unique_ptr<Pda::PdaWriteCombinedBar> mWriteCombinedBar;
+
+    /// Write-combined addresses of the LINK_SUPERPAGE_ADDRESS_HIGH registers, indexed by link ID. The address low and
+    /// size registers follow it.
+    std::array<volatile uint32_t*, Cru::MAX_LINKS> mWriteCombinedDescriptors;
+
     /// Checks if this is the correct BAR. Used to check for BAR 2 for special functions.
     void assertBarIndex(int index, std::string message) const
     {
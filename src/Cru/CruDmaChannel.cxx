@@ -5,10 +5,17 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 #include "CruDmaChannel.h"
+#include <algorithm>
+#include <sstream>
 #include <thread>
 #include <boost/format.hpp>
+#include "ChannelPaths.h"
+#include "Cru/ReadyQueue.h"
 #include "ExceptionInternal.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "Utilities/DmaMemory.h"
+#include "Utilities/SmartPointer.h"
+#include "Utilities/Timestamp.h"
 
 using namespace std::literals;
 using boost::format;
@@ -18,8 +25,14 @@ namespace AliceO2
 namespace roc
 {
 
+constexpr std::chrono::milliseconds CruDmaChannel::RESET_WAIT;
+constexpr std::chrono::milliseconds CruDmaChannel::BUFFER_READY_WAIT;
+constexpr size_t CruDmaChannel::DEFAULT_READY_QUEUE_CAPACITY;
+
 CruDmaChannel::CruDmaChannel(const Parameters& parameters)
     : DmaChannelPdaBase(parameters, allowedChannels()), //
+      mReadyQueue(parameters.getReadyQueueCapacity().get_value_or(DEFAULT_READY_QUEUE_CAPACITY)),
+      mReadyQueueOverflow(parameters.getReadyQueueOverflow().get_value_or(ReadyQueueOverflow::Block)),
       mInitialResetLevel(ResetLevel::Internal), // It's good to reset at least the card channel in general
       mLoopbackMode(parameters.getGeneratorLoopback().get_value_or(LoopbackMode::Internal)), // Internal loopback by default
       mGeneratorEnabled(parameters.getGeneratorEnabled().get_value_or(true)), // Use data generator by default
@@ -29,8 +42,13 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
       mGeneratorInitialValue(0), // Start from 0
       mGeneratorInitialWord(0), // First word
       mGeneratorSeed(0), // Presumably for random patterns, incremental doesn't really need it
-      mGeneratorDataSize(parameters.getGeneratorDataSize().get_value_or(Cru::DMA_PAGE_SIZE)) // Can use page size
+      mGeneratorDataSize(parameters.getGeneratorDataSize().get_value_or(Cru::DMA_PAGE_SIZE)), // Can use page size
+      mWarmRestartEnabled(parameters.getWarmRestartEnabled().get_value_or(false)),
+      mFlushTimeout(parameters.getSuperpageFlushTimeout())
 {
+  if (mReadyQueue.capacity() == 0) {
+    BOOST_THROW_EXCEPTION(InvalidParameterException() << ErrorInfo::Message("ReadyQueueCapacity must be at least 1"));
+  }
 
   // Prep for BARs
   auto parameters2 = parameters;
@@ -39,15 +57,25 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
   auto bar2 = ChannelFactory().getBar(parameters2);
   cruBar = std::move(std::dynamic_pointer_cast<CruBar> (bar)); // Initialize BAR 0
   cruBar2 = std::move(std::dynamic_pointer_cast<CruBar> (bar2)); // Initialize BAR 2
-  mFeatures = getBar()->getFirmwareFeatures(); // Get which features of the firmware are enabled
+  // Get which features of the firmware are enabled. The capabilities register is not in the firmware register map, so
+  // it is only read when asked for.
+  mFeatures = parameters.getFirmwareCapabilitiesEnabled().get_value_or(false) ? getBar()->getFirmwareCapabilities()
+      : getBar()->getFirmwareFeatures();
   
-  if (auto pageSize = parameters.getDmaPageSize()) {
-    if (pageSize.get() != Cru::DMA_PAGE_SIZE) {
-      BOOST_THROW_EXCEPTION(CruException()
-          << ErrorInfo::Message("CRU only supports an 8KiB page size")
-          << ErrorInfo::DmaPageSize(pageSize.get()));
-    }
+  // Larger DMA pages change the layout of the data for its readers, so they are only used when asked for, by size or
+  // with 0 for the largest the firmware supports
+  mDmaPageSize = parameters.getDmaPageSize().get_value_or(Cru::DMA_PAGE_SIZE);
+  if (mDmaPageSize == 0) {
+    mDmaPageSize = mFeatures.maxDmaPageSize;
   }
+  if (mDmaPageSize < Cru::DMA_PAGE_SIZE || mDmaPageSize > mFeatures.maxDmaPageSize
+      || (mDmaPageSize & (mDmaPageSize - 1)) != 0) {
+    BOOST_THROW_EXCEPTION(CruException()
+        << ErrorInfo::Message((format("CRU firmware only supports DMA page sizes that are powers of two from 8 KiB to "
+            "%1% KiB") % (mFeatures.maxDmaPageSize / 1024)).str())
+        << ErrorInfo::DmaPageSize(mDmaPageSize));
+  }
+  setSuperpageSizeMultiple(std::max<size_t>(32 * 1024, mDmaPageSize));
 
   if (mLoopbackMode == LoopbackMode::Diu || mLoopbackMode == LoopbackMode::Siu) {
     BOOST_THROW_EXCEPTION(CruException() << ErrorInfo::Message("CRU does not support given loopback mode")
@@ -70,17 +98,86 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
     std::stringstream stream;
     stream << "Enabling link(s): ";
     auto linkMask = parameters.getLinkMask().value_or(Parameters::LinkMaskType{0});
-    mLinks.reserve(linkMask.size());
+    // Links enabled at runtime are added to the table, so there is room for all of them
+    mLinks.queues.reserve(Cru::MAX_LINKS);
+    mLinks.flushWatches.reserve(Cru::MAX_LINKS);
+    mLinkIndices.fill(-1);
     for (uint32_t id : linkMask) {
-      if (id >= Cru::MAX_LINKS) {
-        BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("CRU does not support given link ID")
-          << ErrorInfo::LinkId(id));
-      }
+      checkLinkId(id);
       stream << id << " ";
-      mLinks.push_back({static_cast<LinkId>(id)});
+      addLink(id);
     }
     log(stream.str());
   }
+
+  auto scheduling = parameters.getLinkScheduling().get_value_or(LinkScheduling::ShortestQueue);
+  log("Link scheduling: " + LinkScheduling::toString(scheduling), InfoLogger::InfoLogger::Debug);
+  mLinkScheduler = std::make_unique<Cru::LinkScheduler>(scheduling, mLinks.size, LINK_QUEUE_CAPACITY);
+
+  // The performance features default to what the firmware reports it supports
+  if (parameters.getStatusPageEnabled().get_value_or(mFeatures.statusPage)) {
+    // The status page address registers are not in the firmware register map, so they are only written if the
+    // firmware confirms them in its capabilities
+    if (mFeatures.statusPage) {
+      initStatusPage();
+    } else {
+      log("Status page not used, the firmware does not report it in its capabilities (see the "
+          "FirmwareCapabilitiesEnabled parameter)", InfoLogger::InfoLogger::Warning);
+    }
+  }
+  if (mStatusPageAddressUser == 0 && mFlushTimeout) {
+    log("Superpage flush timeout ignored, it needs the status page", InfoLogger::InfoLogger::Warning);
+    mFlushTimeout = boost::none;
+  }
+
+  bool descriptorBurst = false;
+  if (parameters.getWriteCombiningEnabled().get_value_or(mFeatures.descriptorBurst)) {
+    try {
+      getBar()->enableDescriptorWriteCombining(getPciAddress());
+      descriptorBurst = true;
+      log("Superpage descriptor write-combining enabled", InfoLogger::InfoLogger::Debug);
+    }
+    catch (const Exception& e) {
+      log("Write-combining not available, using uncached descriptor writes: " + boost::diagnostic_information(e),
+          InfoLogger::InfoLogger::Warning);
+    }
+  }
+
+  if (!parameters.getInterruptEnabled() && mFeatures.interrupts) {
+    try {
+      enableInterrupts();
+    }
+    catch (const Exception& e) {
+      log("Interrupts not available, polling for arrivals: " + boost::diagnostic_information(e),
+          InfoLogger::InfoLogger::Warning);
+    }
+  }
+
+  log((format("DMA paths: completions from the %1%, arrivals by %2%, descriptors %3%, %4% KiB DMA pages")
+      % (mStatusPageAddressUser != 0 ? "status page" : "BAR")
+      % (isInterruptEnabled() ? "interrupt" : "polling")
+      % (descriptorBurst ? "write-combined" : "uncached")
+      % (mDmaPageSize / 1024)).str());
+}
+
+void CruDmaChannel::initStatusPage()
+{
+  log("Initializing status page DMA buffer", InfoLogger::InfoLogger::Debug);
+  constexpr auto STATUS_PAGE_SIZE = sizeof(Cru::StatusPage);
+  Utilities::resetSmartPtr(mBufferStatusPageFile, getPaths().fifo(), STATUS_PAGE_SIZE, true);
+  Utilities::resetSmartPtr(mPdaDmaBufferStatusPage, getRocPciDevice().getPciDevice(),
+      mBufferStatusPageFile->getAddress(), STATUS_PAGE_SIZE, getPdaDmaBufferIndexFifo(getChannelNumber()), false);
+
+  const auto& entry = mPdaDmaBufferStatusPage->getScatterGatherList().at(0);
+  if (entry.size < STATUS_PAGE_SIZE) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Scatter gather list entry for status page was too small")
+        << ErrorInfo::ScatterGatherEntrySize(entry.size)
+        << ErrorInfo::FifoSize(STATUS_PAGE_SIZE));
+  }
+  mStatusPageAddressUser = entry.addressUser;
+  mStatusPageAddressBus = entry.addressBus;
+  getStatusPageUser()->reset();
 }
 
 auto CruDmaChannel::allowedChannels() -> AllowedChannels {
@@ -98,12 +195,27 @@ CruDmaChannel::~CruDmaChannel()
 
 void CruDmaChannel::deviceStartDma()
 {
-  // Enable links
-  uint32_t mask = 0xFfffFfff;
-  for (const auto& link : mLinks) {
-    Utilities::setBit(mask, link.id, false);
+  prepareEngine(false);
+  setBufferReady();
+}
+
+void CruDmaChannel::devicePrepareDma()
+{
+  prepareEngine(false);
+}
+
+void CruDmaChannel::deviceStartPreparedDma()
+{
+  // Everything else was done by prepareDma(), including the reset
+  setBufferReady();
+}
+
+void CruDmaChannel::prepareEngine(bool keepReadyQueue)
+{
+  writeLinkMask();
+  if (mFeatures.maxDmaPageSize > Cru::DMA_PAGE_SIZE) {
+    getBar()->setDmaPageSize(mDmaPageSize);
   }
-  getBar()->setLinksEnabled(mask);
 
   // Set data generator pattern
   if (mGeneratorEnabled) {
@@ -135,26 +247,162 @@ void CruDmaChannel::deviceStartDma()
     }
   }
 
-  // Reset CRU (should be done after link mask set)
-  resetCru();
+  // Reset CRU (should be done after link mask set). On a warm restart the counters keep running, so we continue
+  // from their current values.
+  bool warm = mWarmRestartEnabled && mStoppedCleanly;
+  if (warm) {
+    log("Warm restart, skipping card reset");
+    getBar()->getSuperpageCounts(mSuperpageCounts.data(), mSuperpageCountsSize);
+  } else {
+    resetCru();
+    mLinks.stale = 0;
+  }
+  mStoppedCleanly = false;
 
   // Initialize link queues
-  for (auto &link : mLinks) {
-    link.queue.clear();
-    link.superpageCounter = 0;
+  for (LinkIndex link = 0; link < mLinks.size; ++link) {
+    mLinks.queues[link].clear();
+    mLinks.superpageCounters[link] = warm ? mSuperpageCounts[mLinks.ids[link]] : 0;
+    mLinks.flushed[link] = 0;
+    mLinks.flushWatches[link].reset();
   }
-  mReadyQueue.clear();
-  mLinkQueuesTotalAvailable = LINK_QUEUE_CAPACITY * mLinks.size();
+  mLinks.nonEmpty = 0;
+  if (!keepReadyQueue) {
+    mReadyQueue.clear();
+  }
+  mLinkQueuesTotalAvailable = getLinkQueuesTotalCapacity();
+  mLinkScheduler->reset();
 
-  // Start DMA
-  setBufferReady();
+  // Tell the firmware where to write the superpage counters (after the reset, which may clear the address)
+  if (mStatusPageAddressUser != 0) {
+    getStatusPageUser()->reset();
+    getBar()->setStatusPageAddress(mStatusPageAddressBus);
+  }
+}
+
+void CruDmaChannel::writeLinkMask()
+{
+  // A set bit disables a link
+  uint32_t mask = 0xFfffFfff;
+  for (uint64_t links = mLinks.active; links != 0; links &= links - 1) {
+    Utilities::setBit(mask, mLinks.ids[__builtin_ctzll(links)], false);
+  }
+  getBar()->setLinksEnabled(mask);
+}
+
+void CruDmaChannel::checkLinkId(uint32_t linkId) const
+{
+  if (linkId >= Cru::MAX_LINKS) {
+    BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("CRU does not support given link ID")
+        << ErrorInfo::LinkId(linkId));
+  }
+}
+
+auto CruDmaChannel::addLink(LinkId id) -> LinkIndex
+{
+  const auto index = mLinks.size++;
+  mLinkIndices[id] = index;
+  mLinks.active |= uint64_t(1) << index;
+  mLinks.ids[index] = id;
+  mLinks.superpageCounters[index] = 0;
+  mLinks.flushed[index] = 0;
+  mLinks.queues.emplace_back(LINK_QUEUE_CAPACITY);
+  mLinks.flushWatches.emplace_back();
+  static_assert(Cru::MAX_LINKS <= ChannelStatisticsCounters::MAX_LINKS, "Too many links for statistics");
+  getStatisticsCounters().addLink(id);
+  mSuperpageCountsSize = std::max(mSuperpageCountsSize, size_t(id) + 1);
+  if (mLinkScheduler) {
+    mLinkScheduler->addLink();
+  }
+  return index;
+}
+
+void CruDmaChannel::enableLink(uint32_t linkId)
+{
+  checkLinkId(linkId);
+  if (mLinkIndices[linkId] < 0) {
+    // Not in the channel yet. It's added disabled, and enabled like a link that was disabled.
+    const auto index = addLink(linkId);
+    mLinks.active &= ~(uint64_t(1) << index);
+    mLinkScheduler->setEnabled(index, false);
+  }
+
+  const LinkIndex link = mLinkIndices[linkId];
+  const auto bit = uint64_t(1) << link;
+  if (mLinks.active & bit) {
+    return;
+  }
+  if (mLinks.stale & bit) {
+    BOOST_THROW_EXCEPTION(CruException() << ErrorInfo::Message("Could not enable link, it was disabled with "
+        "superpages on the card. The firmware has no reset per link, restart DMA to enable it.")
+        << ErrorInfo::LinkId(linkId));
+  }
+
+  // Continue from the firmware's counter, which is not reset for a single link
+  mLinks.superpageCounters[link] = getBar()->getSuperpageCount(linkId);
+  mLinks.flushed[link] = 0;
+  mLinks.flushWatches[link].reset();
+  mLinks.active |= bit;
+  mLinkScheduler->setEnabled(link, true);
+  mLinkQueuesTotalAvailable += LINK_QUEUE_CAPACITY;
+  writeLinkMask();
+  log((format("Enabled link %1%") % linkId).str());
+}
+
+void CruDmaChannel::disableLink(uint32_t linkId)
+{
+  checkLinkId(linkId);
+  const auto index = getEnabledLinkIndex(linkId);
+  if (index < 0) {
+    return;
+  }
+  const LinkIndex link = index;
+  auto& queue = mLinks.queues[link];
+
+  // Every superpage of the link goes to the ready queue, so it must fit before anything is touched
+  if (mReadyQueue.size() + queue.size() > mReadyQueue.capacity() && mReadyQueueOverflow == ReadyQueueOverflow::Grow) {
+    growReadyQueue(mReadyQueue.size() + queue.size());
+  }
+  if (mReadyQueue.size() + queue.size() > mReadyQueue.capacity()) {
+    BOOST_THROW_EXCEPTION(CruException() << ErrorInfo::Message(
+        "Could not disable link, the ready queue has no room for its superpages. Pop superpages first.")
+        << ErrorInfo::LinkId(linkId));
+  }
+
+  // Once the firmware stopped the link, its counter in the BAR is authoritative, as in stopDma()
+  mLinks.active &= ~(uint64_t(1) << link);
+  writeLinkMask();
+  const uint32_t amountAvailable = getBar()->getSuperpageCount(linkId) - mLinks.superpageCounters[link];
+  size_t moved = 0;
+  for (uint32_t i = 0; i < amountAvailable && !queue.empty(); ++i) {
+    transferSuperpageFromLinkToReady(link, queue.front().getSize());
+    moved++;
+  }
+
+  // The superpage the link was filling may be partially filled, any after it are empty. Their descriptors stay in the
+  // firmware until the card is reset.
+  if (!queue.empty()) {
+    mLinks.stale |= uint64_t(1) << link;
+  }
+  bool partial = true;
+  while (!queue.empty()) {
+    transferSuperpageFromLinkToReady(link, partial ? getPartialSuperpageReceived(link) : 0);
+    partial = false;
+    moved++;
+  }
+
+  mLinks.flushWatches[link].reset();
+  mLinkScheduler->setEnabled(link, false);
+  mLinkQueuesTotalAvailable -= LINK_QUEUE_CAPACITY;
+  log((format("Disabled link %1%, moved %2% superpage(s) to ready queue") % linkId % moved).str());
 }
 
 /// Set buffer to ready
 void CruDmaChannel::setBufferReady()
 {
   getBar()->setDataEmulatorEnabled(true);
-  std::this_thread::sleep_for(10ms);
+  // The firmware has no status for the DMA engine being armed, DMA_CONTROL only reads back what was written
+  std::this_thread::sleep_for(BUFFER_READY_WAIT);
 }
 
 /// Set buffer to non-ready
@@ -166,22 +414,85 @@ void CruDmaChannel::setBufferNonReady()
 void CruDmaChannel::deviceStopDma()
 {
   setBufferNonReady();
+
+  // Every superpage on the links goes to the ready queue. Stopping must not lose any, so the ready queue grows to fit
+  // them whatever the ReadyQueueOverflow policy is.
+  const size_t onLinks = getLinkQueuesTotalCapacity() - mLinkQueuesTotalAvailable;
+  if (mReadyQueue.size() + onLinks > mReadyQueue.capacity()) {
+    growReadyQueue(mReadyQueue.size() + onLinks);
+  }
+
+  // Read the counters from the BAR, they are authoritative once the firmware stopped
   int moved = 0;
-  for (auto& link : mLinks) {
-    int32_t superpageCount = getBar()->getSuperpageCount(link.id);
-    uint32_t amountAvailable = superpageCount - link.superpageCounter;
+  bool clean = true;
+  for (LinkIndex link = 0; link < mLinks.size; ++link) {
+    auto& queue = mLinks.queues[link];
+    int32_t superpageCount = getBar()->getSuperpageCount(mLinks.ids[link]);
+    uint32_t amountAvailable = superpageCount - mLinks.superpageCounters[link];
     //log((format("superpageCount %1% amountAvailable %2%") % superpageCount % amountAvailable).str());
-    for (uint32_t i = 0; i < (amountAvailable + 1); ++i) {
-      if (mReadyQueue.size() >= READY_QUEUE_CAPACITY) {
-        break;
-      }
-      transferSuperpageFromLinkToReady(link);
+    for (uint32_t i = 0; i < amountAvailable && !queue.empty(); ++i) {
+      transferSuperpageFromLinkToReady(link, queue.front().getSize());
       moved++;
     }
-    assert(link.queue.empty());
+
+    // The superpage the link was filling may be partially filled, any after it are empty
+    clean = clean && queue.empty();
+    bool partial = true;
+    while (!queue.empty()) {
+      transferSuperpageFromLinkToReady(link, partial ? getPartialSuperpageReceived(link) : 0);
+      partial = false;
+      moved++;
+    }
+  }
+
+  if (mStatusPageAddressUser != 0) {
+    getBar()->setStatusPageAddress(0);
   }
-  assert(mLinkQueuesTotalAvailable == LINK_QUEUE_CAPACITY * mLinks.size());
+  assert(mLinkQueuesTotalAvailable == getLinkQueuesTotalCapacity());
   log((format("Moved %1% remaining superpage(s) to ready queue") % moved).str());
+  // Descriptors of disabled links may also remain in the firmware
+  mStoppedCleanly = clean && mLinks.stale == 0;
+}
+
+void CruDmaChannel::checkReadyQueueRoom(const std::string& action)
+{
+  // Every superpage on the links goes to the ready queue, so it must fit before anything is touched
+  const size_t onLinks = getLinkQueuesTotalCapacity() - mLinkQueuesTotalAvailable;
+  if (mReadyQueue.size() + onLinks > mReadyQueue.capacity() && mReadyQueueOverflow == ReadyQueueOverflow::Grow) {
+    growReadyQueue(mReadyQueue.size() + onLinks);
+  }
+  if (mReadyQueue.size() + onLinks > mReadyQueue.capacity()) {
+    BOOST_THROW_EXCEPTION(CruException() << ErrorInfo::Message(action
+        + ", the ready queue has no room for the superpages on the links. Pop superpages first."));
+  }
+}
+
+void CruDmaChannel::deviceRecover()
+{
+  checkReadyQueueRoom("Could not recover");
+
+  // The firmware has no reset per link, so the whole channel is recovered. Stopping gives the superpages back with
+  // the amounts they received, since the counters in the BAR are authoritative once the DMA engine stopped.
+  deviceStopDma();
+
+  // The error may have left descriptors in the firmware, so the card is reset as on a cold start, but the user still
+  // has to pop the superpages that were given back
+  mStoppedCleanly = false;
+  prepareEngine(true);
+  setBufferReady();
+}
+
+void CruDmaChannel::deviceStartNextRun()
+{
+  checkReadyQueueRoom("Could not start the next run");
+
+  // The superpages of the run come back with what they received, and stay in the ready queue for the user. The
+  // firmware still holds the descriptors of the superpages that had not arrived, and it must not write into them now
+  // that the user has them, so the card is reset as on a cold start. Only if nothing was in flight, and the
+  // WarmRestartEnabled parameter is set, is the reset skipped.
+  deviceStopDma();
+  prepareEngine(true);
+  setBufferReady();
 }
 
 void CruDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
@@ -199,42 +510,113 @@ CardType::type CruDmaChannel::getCardType()
 
 void CruDmaChannel::resetCru()
 {
-  getBar()->resetDataGeneratorCounter();
-  std::this_thread::sleep_for(100ms);
+  if (mGeneratorEnabled) {
+    // There is no status to poll for this one, and it's only needed for the data generator
+    getBar()->resetDataGeneratorCounter();
+    std::this_thread::sleep_for(100ms);
+  }
+
+  // The firmware has no status for the reset being done either. Its link counters should read 0 afterwards, but that
+  // is also true before the first run, so it only serves as a check after the wait.
+  getTraceRing().record(TraceRing::Event::Reset);
   getBar()->resetCard();
-  std::this_thread::sleep_for(100ms);
+  std::this_thread::sleep_for(RESET_WAIT);
+  getBar()->getSuperpageCounts(mSuperpageCounts.data(), mSuperpageCountsSize);
+  if (!std::all_of(mLinks.ids.begin(), mLinks.ids.begin() + mLinks.size,
+      [&](uint8_t id){ return mSuperpageCounts[id] == 0; })) {
+    log("Link counters not cleared by the card reset", InfoLogger::InfoLogger::Warning);
+  }
 }
 
 auto CruDmaChannel::getNextLinkIndex() -> LinkIndex
 {
-  auto smallestQueueIndex = std::numeric_limits<LinkIndex>::max();
-  auto smallestQueueSize = std::numeric_limits<size_t>::max();
+  return mLinkScheduler->getNextLinkIndex();
+}
 
-  for (size_t i = 0; i < mLinks.size(); ++i) {
-    auto queueSize = mLinks[i].queue.size();
-    if (queueSize < smallestQueueSize) {
-      smallestQueueIndex = i;
-      smallestQueueSize = queueSize;
-    }
+void CruDmaChannel::pushSuperpage(Superpage superpage)
+{
+  if (!tryPushSuperpage(superpage)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpage, transfer queue was full"));
   }
-
-  return smallestQueueIndex;
 }
 
-void CruDmaChannel::pushSuperpage(Superpage superpage)
+bool CruDmaChannel::tryPushSuperpage(const Superpage& superpage)
 {
   checkSuperpage(superpage);
 
   if (mLinkQueuesTotalAvailable == 0) {
     // Note: the transfer queue refers to the firmware, not the mLinkIndexQueue which contains the LinkIds for links
     // that can still be pushed into (essentially the opposite of the firmware's queue).
-    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpage, transfer queue was full"));
+    return false;
+  }
+
+  pushSuperpageToNextLink(superpage);
+  return true;
+}
+
+void CruDmaChannel::pushSuperpages(const Superpage* superpages, size_t count)
+{
+  if (count > mLinkQueuesTotalAvailable) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpages, not enough transfer queue slots")
+        << ErrorInfo::SuperpageCount(count));
+  }
+
+  // Check everything up front, so we don't leave the queues half-pushed if one of the superpages is bad
+  for (size_t i = 0; i < count; ++i) {
+    checkSuperpage(superpages[i]);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    pushSuperpageToNextLink(superpages[i]);
+  }
+}
+
+bool CruDmaChannel::tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId)
+{
+  validateSuperpage(superpage, linkId);
+  auto link = LinkIndex(getEnabledLinkIndex(linkId));
+  if (mLinks.queues[link].size() >= LINK_QUEUE_CAPACITY) {
+    return false;
+  }
+  pushSuperpageToLink(link, superpage);
+  return true;
+}
+
+void CruDmaChannel::validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId)
+{
+  checkSuperpage(superpage);
+  if (linkId && getEnabledLinkIndex(*linkId) < 0) {
+    BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("Link not enabled in channel")
+        << ErrorInfo::LinkId(*linkId));
+  }
+}
+
+void CruDmaChannel::releaseSuperpage(Superpage superpage)
+{
+  if (!superpage.isChecked()) {
+    checkSuperpage(superpage);
+  }
+  if (mLinkQueuesTotalAvailable == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not release superpage, transfer queue was full"));
   }
+  superpage.setReady(false);
+  superpage.setReceived(0);
 
+  // Back to the link it came from if that is still enabled and has room, else wherever the scheduler says
+  auto index = getEnabledLinkIndex(superpage.getLinkId());
+  if (index < 0 || mLinks.queues[index].size() >= LINK_QUEUE_CAPACITY) {
+    pushSuperpageToNextLink(superpage);
+    return;
+  }
+  pushSuperpageToLink(index, superpage);
+}
+
+void CruDmaChannel::pushSuperpageToNextLink(const Superpage& superpage)
+{
   // Get the next link to push
-  auto &link = mLinks[getNextLinkIndex()];
+  auto link = getNextLinkIndex();
 
-  if (link.queue.size() >= LINK_QUEUE_CAPACITY) {
+  if (mLinks.queues[link].size() >= LINK_QUEUE_CAPACITY) {
     // Is the link's FIFO out of space?
     // This should never happen
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpage, link queue was full"));
@@ -242,9 +624,6 @@ void CruDmaChannel::pushSuperpage(Superpage superpage)
 
   // Once we've confirmed the link has a slot available, we push the superpage
   pushSuperpageToLink(link, superpage);
-  auto dmaPages = superpage.getSize() / Cru::DMA_PAGE_SIZE;
-  auto busAddress = getBusOffsetAddress(superpage.getOffset());
-  getBar()->pushSuperpageDescriptor(link.id, dmaPages, busAddress);
 }
 
 auto CruDmaChannel::getSuperpage() -> Superpage
@@ -257,58 +636,264 @@ auto CruDmaChannel::getSuperpage() -> Superpage
 
 auto CruDmaChannel::popSuperpage() -> Superpage
 {
-  if (mReadyQueue.empty()) {
+  Superpage superpage;
+  if (!tryPopSuperpage(superpage)) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not pop superpage, ready queue was empty"));
   }
-  auto superpage = mReadyQueue.front();
-  mReadyQueue.pop_front();
   return superpage;
 }
 
-void CruDmaChannel::pushSuperpageToLink(Link& link, const Superpage& superpage)
+bool CruDmaChannel::tryPopSuperpage(Superpage& superpage)
 {
+  if (mReadyQueue.empty()) {
+    return false;
+  }
+  superpage = mReadyQueue.front();
+  mReadyQueue.pop_front();
+  getTraceRing().record(TraceRing::Event::Popped, superpage.getLinkId(), superpage.getOffset());
+  return true;
+}
+
+size_t CruDmaChannel::popSuperpages(Superpage* superpages, size_t max)
+{
+  auto count = std::min(max, mReadyQueue.size());
+  std::copy_n(mReadyQueue.begin(), count, superpages);
+  mReadyQueue.erase_begin(count);
+  for (size_t i = 0; i < count; ++i) {
+    getTraceRing().record(TraceRing::Event::Popped, superpages[i].getLinkId(), superpages[i].getOffset());
+  }
+  return count;
+}
+
+void CruDmaChannel::pushSuperpageToLink(LinkIndex link, const Superpage& superpage)
+{
+  auto& queue = mLinks.queues[link];
+  const LinkId id = mLinks.ids[link];
   mLinkQueuesTotalAvailable--;
-  link.queue.push_back(superpage);
+  queue.push_back(superpage);
+  queue.back().setPushTimestamp(Utilities::getTimestampCounter());
+  queue.back().setRunEpoch(getRunEpoch());
+  queue.back().setSplit(false);
+  queue.back().setChecked(true);
+  mLinks.nonEmpty |= uint64_t(1) << link;
+  mLinkScheduler->pushed(link);
+  getTraceRing().record(TraceRing::Event::Pushed, id, superpage.getOffset());
+  getStatisticsCounters().transferQueueSize(getLinkQueuesTotalCapacity() - mLinkQueuesTotalAvailable);
+
+  auto dmaPages = superpage.getSize() / mDmaPageSize;
+  auto busAddress = getBusOffsetAddress(superpage.getBufferId(), superpage.getOffset());
+  getBar()->pushSuperpageDescriptor(id, dmaPages, busAddress);
 }
 
-void CruDmaChannel::transferSuperpageFromLinkToReady(Link& link)
+void CruDmaChannel::transferSuperpageFromLinkToReady(LinkIndex link, size_t received)
 {
-  link.queue.front().setReady(true);
-  link.queue.front().setReceived(link.queue.front().getSize());
-  mReadyQueue.push_back(link.queue.front());
+  auto& queue = mLinks.queues[link];
+  const LinkId id = mLinks.ids[link];
+  queue.front().setReady(true);
+  queue.front().setTimestamp(Utilities::getTimestampCounter());
+  queue.front().setReceived(received);
+  queue.front().setLinkId(id);
+  mLinkScheduler->arrived(link);
+  getStatisticsCounters().superpageArrived(id, received);
+  getTraceRing().record(TraceRing::Event::Arrived, id, received);
+  mReadyQueue.push_back(queue.front());
+  getStatisticsCounters().readyQueueSize(mReadyQueue.size());
   mLinkQueuesTotalAvailable++;
-  link.queue.pop_front();
-  link.superpageCounter++;
+  queue.pop_front();
+  if (queue.empty()) {
+    mLinks.nonEmpty &= ~(uint64_t(1) << link);
+  }
+  mLinks.superpageCounters[link]++;
+  mLinks.flushed[link] = 0;
+}
+
+size_t CruDmaChannel::getPartialSuperpageReceived(LinkIndex link)
+{
+  const auto size = mLinks.queues[link].front().getSize();
+  if (mStatusPageAddressUser == 0) {
+    return size;
+  }
+  const auto flushed = mLinks.flushed[link];
+  const auto received = size_t(getStatusPageUser()->loadPagesPushed(mLinks.ids[link])) * mDmaPageSize;
+  return received > flushed ? std::min(size, received - flushed) : 0;
+}
+
+size_t CruDmaChannel::getFrontReceived(LinkIndex link)
+{
+  // The page counter is read before the superpage counter: if the link moved on to its next superpage in between,
+  // the page counter may belong to that one, so it is not used.
+  const auto statusPage = getStatusPageUser();
+  const auto id = mLinks.ids[link];
+  const auto flushed = mLinks.flushed[link];
+  const auto received = size_t(statusPage->loadPagesPushed(id)) * mDmaPageSize;
+  if (statusPage->loadSuperpagesPushed(id) != mLinks.superpageCounters[link] || received <= flushed) {
+    return 0;
+  }
+  return std::min(mLinks.queues[link].front().getSize(), received - flushed);
+}
+
+void CruDmaChannel::flushIdleSuperpages()
+{
+  const auto now = SuperpageFlushWatch::Clock::now();
+  for (uint64_t links = mLinks.nonEmpty; links != 0; links &= links - 1) {
+    const LinkIndex link = __builtin_ctzll(links);
+    const LinkId id = mLinks.ids[link];
+    auto& front = mLinks.queues[link].front();
+    const auto received = getFrontReceived(link);
+    if (!mLinks.flushWatches[link].isIdle(front.getOffset(), received, *mFlushTimeout, now)
+        || received == front.getSize()) {
+      continue;
+    }
+    if (mReadyQueue.full()) {
+      // Dropping a superpage frees no slot for its return to the card, so with DropOldest the flush waits
+      if (mReadyQueueOverflow != ReadyQueueOverflow::Grow) {
+        return;
+      }
+      growReadyQueue(mReadyQueue.size() + 1);
+    }
+
+    // The firmware keeps filling the rest of the superpage it was given, so only the received part is handed over
+    auto split = Cru::splitReceived(front, received);
+    split.setTimestamp(Utilities::getTimestampCounter());
+    split.setLinkId(id);
+    mLinks.flushed[link] += received;
+
+    getStatisticsCounters().superpageArrived(id, received);
+    getTraceRing().record(TraceRing::Event::Flushed, id, received);
+    mReadyQueue.push_back(split);
+    getStatisticsCounters().readyQueueSize(mReadyQueue.size());
+  }
+}
+
+bool CruDmaChannel::makeReadyQueueRoom(boost::optional<Superpage>& dropped)
+{
+  switch (mReadyQueueOverflow) {
+    case ReadyQueueOverflow::Grow:
+      growReadyQueue(mReadyQueue.size() + 1);
+      return true;
+    case ReadyQueueOverflow::DropOldest: {
+      // Pieces of flushed superpages cannot go back to the card, they are left for the user to pop
+      const auto oldest = Cru::findRecyclable(mReadyQueue);
+      if (oldest == mReadyQueue.end()) {
+        return false;
+      }
+      dropped = *oldest;
+      mReadyQueue.erase(oldest);
+      getStatisticsCounters().superpageDropped();
+      getTraceRing().record(TraceRing::Event::Dropped, dropped->getLinkId(), dropped->getOffset());
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void CruDmaChannel::growReadyQueue(size_t needed)
+{
+  const auto capacity = std::max(mReadyQueue.capacity() * 2, needed);
+  log((format("Ready queue full, growing it to %1% superpages") % capacity).str(), InfoLogger::InfoLogger::Warning);
+  mReadyQueue.set_capacity(capacity);
+}
+
+size_t CruDmaChannel::getPartialSuperpages(Superpage* superpages, size_t max)
+{
+  // Only the status page tells how far the links got in their current superpage
+  if (mStatusPageAddressUser == 0) {
+    return 0;
+  }
+
+  size_t count = 0;
+  for (uint64_t links = mLinks.nonEmpty; links != 0 && count < max; links &= links - 1) {
+    const LinkIndex link = __builtin_ctzll(links);
+    const auto& front = mLinks.queues[link].front();
+    const auto received = getFrontReceived(link);
+    if (received == 0 || received == front.getSize()) {
+      continue;
+    }
+    superpages[count] = front;
+    superpages[count].setReceived(received);
+    superpages[count].setLinkId(mLinks.ids[link]);
+    count++;
+  }
+  return count;
 }
 
 void CruDmaChannel::fillSuperpages()
 {
-  // Check for arrivals & handle them
-  const auto size = mLinks.size();
-  for (LinkIndex linkIndex = 0; linkIndex < size; ++linkIndex) {
-    auto& link = mLinks[linkIndex];
-    uint32_t superpageCount = getBar()->getSuperpageCount(link.id);
-    auto available = superpageCount > link.superpageCounter;
-    if (available) {
-      uint32_t amountAvailable = superpageCount - link.superpageCounter;
-      if (amountAvailable > link.queue.size()) {
+  // An idle link doesn't interrupt, so this goes before the interrupt check
+  if (mFlushTimeout) {
+    flushIdleSuperpages();
+  }
+
+  // With interrupts enabled, skip reading the link counters if the card did not signal anything
+  if (!checkInterrupt()) {
+    getStatisticsCounters().emptyFill();
+    return;
+  }
+
+  // Take a snapshot of all links' counters in one go, and find the links that have new arrivals.
+  // With the status page, the counters are already in host memory and no PCIe reads are needed.
+  if (mStatusPageAddressUser != 0) {
+    const auto& pushed = getStatusPageUser()->superpagesPushed;
+    for (size_t i = 0; i < mSuperpageCountsSize; ++i) {
+      mSuperpageCounts[i] = Utilities::loadRelaxed(pushed[i]);
+    }
+    Utilities::acquireFence();
+  } else {
+    getBar()->getSuperpageCounts(mSuperpageCounts.data(), mSuperpageCountsSize);
+  }
+  // All links are checked, not only the ones with superpages, so arrivals on an empty link are caught as an error
+  uint64_t changed = 0;
+  for (uint64_t links = mLinks.active; links != 0; links &= links - 1) {
+    const LinkIndex link = __builtin_ctzll(links);
+    changed |= uint64_t(mSuperpageCounts[mLinks.ids[link]] > mLinks.superpageCounters[link]) << link;
+  }
+  if (changed == 0) {
+    getStatisticsCounters().emptyFill();
+  }
+
+  // Handle arrivals, skipping idle links
+  while (changed != 0) {
+    const LinkIndex link = __builtin_ctzll(changed);
+    changed &= changed - 1;
+    const LinkId id = mLinks.ids[link];
+    const auto& queue = mLinks.queues[link];
+    uint32_t superpageCount = mSuperpageCounts[id];
+    uint32_t amountAvailable = superpageCount - mLinks.superpageCounters[link];
+    if (amountAvailable > queue.size()) {
+      logLimited(mFifoErrorLogLimit, [&] {
         std::stringstream stream;
         stream << "FATAL: Firmware reported more superpages available (" << amountAvailable <<
-          ") than should be present in FIFO (" << link.queue.size() << "); "
-          << link.superpageCounter << " superpages received from link " << int(link.id) << " according to driver, "
+          ") than should be present in FIFO (" << queue.size() << "); "
+          << mLinks.superpageCounters[link] << " superpages received from link " << int(id) << " according to driver, "
           << superpageCount << " pushed according to firmware";
-        log(stream.str(), InfoLogger::InfoLogger::Error);
-        BOOST_THROW_EXCEPTION(Exception()
-            << ErrorInfo::Message("FATAL: Firmware reported more superpages available than should be present in FIFO"));
+        stream << "\nTrace of the channel:\n";
+        dumpTrace(stream);
+        return stream.str();
+      }, InfoLogger::InfoLogger::Error);
+      BOOST_THROW_EXCEPTION(Exception()
+          << ErrorInfo::Message("FATAL: Firmware reported more superpages available than should be present in FIFO"));
+    }
+
+    for (uint32_t i = 0; i < amountAvailable; ++i) {
+      boost::optional<Superpage> dropped;
+      if (mReadyQueue.full() && !makeReadyQueueRoom(dropped)) {
+        const auto left = amountAvailable - i;
+        getStatisticsCounters().readyQueueFull(left);
+        getTraceRing().record(TraceRing::Event::ReadyQueueFull, id, left);
+        logLimited(mReadyQueueFullLogLimit, [&] {
+          return (format("Ready queue full, %1% arrived superpage(s) of link %2% left on the card. Pop superpages "
+              "sooner, or raise the ReadyQueueCapacity parameter") % left % id).str();
+        }, InfoLogger::InfoLogger::Warning);
+        break;
       }
 
-      for (uint32_t i = 0; i < amountAvailable; ++i) {
-        if (mReadyQueue.size() >= READY_QUEUE_CAPACITY) {
-          break;
-        }
+      // Front superpage has arrived. The firmware only counts a superpage as pushed when all its pages are written.
+      transferSuperpageFromLinkToReady(link, queue.front().getSize());
 
-        // Front superpage has arrived
-        transferSuperpageFromLinkToReady(link);
+      if (dropped) {
+        // The arrival freed a slot in the transfer queue
+        releaseSuperpage(*dropped);
       }
     }
   }
@@ -366,6 +951,14 @@ boost::optional<std::string> CruDmaChannel::getCardId()
     return {};
 }
 
+BarStatistics CruDmaChannel::getBarStatistics()
+{
+  auto statistics = getBar()->getBarStatistics();
+  auto statistics2 = getBar2()->getBarStatistics();
+  statistics.insert(statistics.end(), statistics2.begin(), statistics2.end());
+  return statistics;
+}
+
 
 } // namespace roc
 } // namespace AliceO2
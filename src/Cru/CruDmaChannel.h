@@ -8,12 +8,18 @@
 #define ALICEO2_READOUTCARD_CRU_CRUDMACHANNEL_H_
 
 #include "DmaChannelPdaBase.h"
+#include <array>
 #include <memory>
 #include <deque>
 //#define BOOST_CB_ENABLE_DEBUG 1
 #include <boost/circular_buffer.hpp>
+#include <boost/scoped_ptr.hpp>
 #include "Cru/CruBar.h"
 #include "Cru/FirmwareFeatures.h"
+#include "Cru/LinkScheduler.h"
+#include "Cru/StatusPage.h"
+#include "SuperpageFlushWatch.h"
+#include "Utilities/AlignedAllocator.h"
 #include "ReadoutCard/Parameters.h"
 
 namespace AliceO2 {
@@ -29,40 +35,65 @@ class CruDmaChannel final : public DmaChannelPdaBase
 
     virtual CardType::type getCardType() override;
 
+    virtual size_t getDmaPageSize() override
+    {
+      return mDmaPageSize;
+    }
+
     virtual void pushSuperpage(Superpage) override;
+    virtual bool tryPushSuperpage(const Superpage& superpage) override;
+    virtual void pushSuperpages(const Superpage* superpages, size_t count) override;
+    virtual bool tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId) override;
+    virtual void validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId) override;
+    virtual void releaseSuperpage(Superpage superpage) override;
+    virtual void enableLink(uint32_t linkId) override;
+    virtual void disableLink(uint32_t linkId) override;
 
     virtual int getTransferQueueAvailable() override;
     virtual int getReadyQueueSize() override;
 
     virtual Superpage getSuperpage() override;
     virtual Superpage popSuperpage() override;
+    virtual bool tryPopSuperpage(Superpage& superpage) override;
+    virtual size_t popSuperpages(Superpage* superpages, size_t max) override;
     virtual void fillSuperpages() override;
+    virtual size_t getPartialSuperpages(Superpage* superpages, size_t max) override;
 
     virtual bool injectError() override;
     virtual boost::optional<int32_t> getSerial() override;
     virtual boost::optional<float> getTemperature() override;
     virtual boost::optional<std::string> getFirmwareInfo() override;
     virtual boost::optional<std::string> getCardId() override;
+    virtual BarStatistics getBarStatistics() override;
     AllowedChannels allowedChannels();
 
   protected:
 
     virtual void deviceStartDma() override;
+    virtual void devicePrepareDma() override;
+    virtual void deviceStartPreparedDma() override;
     virtual void deviceStopDma() override;
+    virtual void deviceRecover() override;
+    virtual void deviceStartNextRun() override;
     virtual void deviceResetChannel(ResetLevel::type resetLevel) override;
 
   private:
 
+    /// Time to wait for the card to finish a reset
+    static constexpr std::chrono::milliseconds RESET_WAIT { 100 };
+
+    /// Time to wait for the firmware to enable the DMA engine
+    static constexpr std::chrono::milliseconds BUFFER_READY_WAIT { 10 };
+
     /// Max amount of superpages per link.
     /// This may not exceed the limit determined by the firmware capabilities.
     static constexpr size_t LINK_QUEUE_CAPACITY = Cru::MAX_SUPERPAGE_DESCRIPTORS;
 
-    /// Max amount of superpages in the ready queue.
-    /// This is an arbitrary size, can easily be increased if more headroom is needed.
-    static constexpr size_t READY_QUEUE_CAPACITY = Cru::MAX_SUPERPAGE_DESCRIPTORS * Cru::MAX_LINKS;
+    /// Default max amount of superpages in the ready queue, see the ReadyQueueCapacity parameter
+    static constexpr size_t DEFAULT_READY_QUEUE_CAPACITY = Cru::MAX_SUPERPAGE_DESCRIPTORS * Cru::MAX_LINKS;
 
     /// Queue for one link
-    using SuperpageQueue = boost::circular_buffer<Superpage>;
+    using SuperpageQueue = boost::circular_buffer<Superpage, Utilities::CacheAlignedAllocator<Superpage>>;
 
     /// Index into mLinks
     using LinkIndex = uint32_t;
@@ -70,23 +101,82 @@ class CruDmaChannel final : public DmaChannelPdaBase
     /// ID for a link
     using LinkId = uint32_t;
 
-    /// Struct for keeping track of one link's counter and superpages
-    struct Link
+    /// State of the links in structure-of-arrays layout, indexed by LinkIndex. What fillSuperpages() checks for every
+    /// link on every call, the masks, IDs and counters, is kept in dense arrays that span a few cache lines. The
+    /// superpage queues and the flush state are only touched for links that have superpages.
+    struct LinkTable
     {
-        /// The link's FEE ID
-        LinkId id = 0;
+        /// Amount of links
+        LinkIndex size = 0;
+
+        static_assert(Cru::MAX_LINKS <= 64, "Too many links for the link masks");
+
+        /// Bit per link of the channel that is enabled. Disabled links keep their index and stay in the table.
+        uint64_t active = 0;
 
-        /// The amount of superpages received from this link
-        uint32_t superpageCounter = 0;
+        /// Bit per link that was disabled while the firmware still had descriptors of it. The firmware has no reset per
+        /// link, so these can only be enabled again after a reset of the card.
+        uint64_t stale = 0;
 
-        /// The superpage queue
-        SuperpageQueue queue {LINK_QUEUE_CAPACITY};
+        /// Bit per link with superpages in its queue
+        uint64_t nonEmpty = 0;
+
+        /// The links' FEE IDs
+        std::array<uint8_t, Cru::MAX_LINKS> ids;
+
+        /// The amount of superpages received from every link
+        std::array<uint32_t, Cru::MAX_LINKS> superpageCounters;
+
+        /// Bytes of the front superpage of every link that were already flushed to the ready queue. The firmware still
+        /// counts its pages from the start of the superpage as it was pushed.
+        std::array<size_t, Cru::MAX_LINKS> flushed;
+
+        /// The superpage queues
+        std::vector<SuperpageQueue> queues;
+
+        /// Watch the front superpages for the flush timeout
+        std::vector<SuperpageFlushWatch> flushWatches;
     };
 
     void resetCru();
+
+    /// Sets up the links and resets the card, everything up to enabling the DMA engine
+    /// \param keepReadyQueue Keep the superpages in the ready queue, which recover() or startNextRun() gave back
+    void prepareEngine(bool keepReadyQueue);
+
+    /// Throws if the ready queue has no room for the superpages on the links, growing it first if allowed
+    /// \param action What needs the room, for the message
+    void checkReadyQueueRoom(const std::string& action);
+
     void setBufferReady();
     void setBufferNonReady();
 
+    /// Writes the mask of the enabled links to the firmware
+    void writeLinkMask();
+
+    /// Gets the capacity of the link queues of the enabled links in total
+    size_t getLinkQueuesTotalCapacity() const
+    {
+      return LINK_QUEUE_CAPACITY * __builtin_popcountll(mLinks.active);
+    }
+
+    /// Checks that a link ID is valid for the CRU
+    void checkLinkId(uint32_t linkId) const;
+
+    /// Adds a link to the table, enabled
+    /// \return Index of the link
+    LinkIndex addLink(LinkId id);
+
+    /// Gets the index of a link if it's enabled, else -1
+    int getEnabledLinkIndex(uint32_t linkId) const
+    {
+      if (linkId >= Cru::MAX_LINKS || mLinkIndices[linkId] < 0
+          || !(mLinks.active & (uint64_t(1) << mLinkIndices[linkId]))) {
+        return -1;
+      }
+      return mLinkIndices[linkId];
+    }
+
     auto getBar()
     {
       return cruBar.get();
@@ -100,11 +190,46 @@ class CruDmaChannel final : public DmaChannelPdaBase
     /// Gets index of next link to push
     LinkIndex getNextLinkIndex();
 
-    /// Push a superpage to a link
-    void pushSuperpageToLink(Link& link, const Superpage& superpage);
+    /// Push an already checked superpage to a link and hand its descriptor to the firmware
+    void pushSuperpageToLink(LinkIndex link, const Superpage& superpage);
+
+    /// Push an already checked superpage to the next link and hand its descriptor to the firmware
+    void pushSuperpageToNextLink(const Superpage& superpage);
 
     /// Mark the front superpage of a link ready and transfer it to the ready queue
-    void transferSuperpageFromLinkToReady(Link& link);
+    /// \param link Link to transfer from
+    /// \param received Amount of bytes received in the superpage
+    void transferSuperpageFromLinkToReady(LinkIndex link, size_t received);
+
+    /// Gets the amount of bytes received in the superpage a link is currently filling, which is only known if the
+    /// status page is enabled. Otherwise, the superpage is assumed to be filled.
+    size_t getPartialSuperpageReceived(LinkIndex link);
+
+    /// Gets the amount of bytes received in the superpage a link is currently filling from the status page, while DMA
+    /// is running. Returns 0 if the link finished the superpage, since the page counter then belongs to the next one.
+    size_t getFrontReceived(LinkIndex link);
+
+    /// Makes room in the full ready queue for an arriving superpage, as the ReadyQueueOverflow policy says
+    /// \param dropped Set to the superpage taken out of the ready queue by the DropOldest policy. The caller must give
+    ///        it back to the card once the arrival freed a slot in the transfer queue. Pieces of flushed superpages
+    ///        are never dropped.
+    /// \return False if the arriving superpage has to stay on the card
+    bool makeReadyQueueRoom(boost::optional<Superpage>& dropped);
+
+    /// Raises the capacity of the ready queue, by at least double
+    /// \param needed Capacity needed
+    void growReadyQueue(size_t needed);
+
+    /// Splits the received part off the superpages of the links that got no new pages for the SuperpageFlushTimeout
+    void flushIdleSuperpages();
+
+    /// Create and register the status page buffer
+    void initStatusPage();
+
+    Cru::StatusPage* getStatusPageUser()
+    {
+      return reinterpret_cast<Cru::StatusPage*>(mStatusPageAddressUser);
+    }
 
     /// BAR 0 is needed for DMA engine interaction and various other functions
     std::shared_ptr<CruBar> cruBar;
@@ -115,14 +240,44 @@ class CruDmaChannel final : public DmaChannelPdaBase
     /// Features of the firmware
     FirmwareFeatures mFeatures;
 
-    /// Vector of objects representing links
-    std::vector<Link> mLinks;
+    /// DMA page size in bytes. Larger than Cru::DMA_PAGE_SIZE only if the firmware supports it and it was asked for.
+    size_t mDmaPageSize = Cru::DMA_PAGE_SIZE;
+
+    /// State of the links
+    LinkTable mLinks;
+
+    /// Index into mLinks by link ID, -1 for links not in the channel
+    std::array<int, Cru::MAX_LINKS> mLinkIndices;
+
+    /// Memory mapped file for the status page
+    boost::scoped_ptr<MemoryMappedFile> mBufferStatusPageFile;
+
+    /// PDA DMABuffer object for the status page
+    boost::scoped_ptr<Pda::PdaDmaBuffer> mPdaDmaBufferStatusPage;
+
+    /// Userspace address of the status page, 0 if the status page is not used
+    uintptr_t mStatusPageAddressUser = 0;
+
+    /// Bus address of the status page
+    uintptr_t mStatusPageAddressBus = 0;
+
+    /// Snapshot of the LINK_SUPERPAGES_PUSHED registers, indexed by link ID
+    std::array<uint32_t, Cru::MAX_LINKS> mSuperpageCounts;
+
+    /// Amount of LINK_SUPERPAGES_PUSHED registers to read for a snapshot: the highest enabled link ID + 1
+    size_t mSuperpageCountsSize = 0;
+
+    /// Decides which link gets the next superpage
+    std::unique_ptr<Cru::LinkScheduler> mLinkScheduler;
 
     /// To keep track of how many slots are available in the link queues (in mLinks) in total
     size_t mLinkQueuesTotalAvailable;
 
     /// Queue for superpages that have been transferred and are waiting for popping by the user
-    SuperpageQueue mReadyQueue { READY_QUEUE_CAPACITY };
+    SuperpageQueue mReadyQueue;
+
+    /// What to do with superpages arriving while the ready queue is full
+    const ReadyQueueOverflow::type mReadyQueueOverflow;
 
     // These variables are configuration parameters
 
@@ -155,6 +310,21 @@ class CruDmaChannel final : public DmaChannelPdaBase
 
     /// Length of data written to each page
     const size_t mGeneratorDataSize;
+
+    /// Skip the card reset on restarts after a clean stop
+    const bool mWarmRestartEnabled;
+
+    /// Time without new pages after which the received part of a superpage is flushed, if enabled
+    boost::optional<std::chrono::nanoseconds> mFlushTimeout;
+
+    /// True if the last stopDma() found no superpages left on the links, so no descriptors remain in the firmware
+    bool mStoppedCleanly = false;
+
+    /// Rate limit of the FIFO overflow error, whose message carries the whole trace
+    LogRateLimit mFifoErrorLogLimit {1, std::chrono::seconds(10)};
+
+    /// Rate limit of the warning for superpages left on the card because the ready queue was full
+    LogRateLimit mReadyQueueFullLogLimit {1, std::chrono::seconds(10)};
 };
 
 } // namespace roc
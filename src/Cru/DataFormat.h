@@ -9,7 +9,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include "Utilities/Util.h"
+#include "RegisterField.h"
 
 namespace AliceO2
 {
@@ -19,6 +19,15 @@ namespace Cru
 {
 namespace DataFormat
 {
+/// Fields of the RDH. The header is addressed like a register file: the register of a field is its 32-bit word.
+namespace Fields
+{
+static constexpr RegisterField OFFSET_NEXT_PACKET(0x8, 0, 16); ///< Bits #[64-79]
+static constexpr RegisterField EVENT_SIZE(0x8, 16, 16); ///< Bits #[80-95]
+static constexpr RegisterField LINK_ID(0xc, 0, 8); ///< Bits #[96-103]
+static constexpr RegisterField PACKET_COUNTER(0xc, 8, 8); ///< Bits #[104-111]
+} // namespace Fields
+
 namespace
 {
   uint32_t getWord(const char* data, int i)
@@ -27,24 +36,34 @@ namespace
     memcpy(&word, &data[sizeof(word)*i], sizeof(word));
     return word;
   }
+
+  uint32_t getField(const char* data, const RegisterField& field)
+  {
+    return field.get(getWord(data, field.reg.index));
+  }
 } // Anonymous namespace
 
-uint32_t getLinkId(const char* data)
+inline uint32_t getLinkId(const char* data)
 {
-  return Utilities::getBits(getWord(data, 3), 0, 7); //bits #[96-103] from RDH
+  return getField(data, Fields::LINK_ID);
 }
 
-uint32_t getEventSize(const char* data)
+inline uint32_t getEventSize(const char* data)
 {
-  return Utilities::getBits(getWord(data, 2), 16, 31); //bits #[80-95] from RDH
+  return getField(data, Fields::EVENT_SIZE);
 }
 
-uint32_t getPacketCounter(const char* data)
+inline uint32_t getPacketCounter(const char* data)
 {
-  return Utilities::getBits(getWord(data, 3), 8, 15); //bits #[104-111] from RDH
+  return getField(data, Fields::PACKET_COUNTER);
 }
 
-////TODO: Add getOffset (pointer to the beginning of the next dma page)
+/// Get the offset from the start of the packet to the start of the next one, in bytes. With one packet per DMA page,
+/// this is the page size; with packed packets, it is the packet's memory size rounded up to whole 256-bit words.
+inline uint32_t getOffsetNextPacket(const char* data)
+{
+  return getField(data, Fields::OFFSET_NEXT_PACKET);
+}
 
 /// Get header size in bytes
 constexpr size_t getHeaderSize()
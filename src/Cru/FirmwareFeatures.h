@@ -7,6 +7,9 @@
 #ifndef ALICEO2_READOUTCARD_CRU_FIRMWAREFEATURES_H_
 #define ALICEO2_READOUTCARD_CRU_FIRMWAREFEATURES_H_
 
+#include <cstddef>
+#include "Cru/Constants.h"
+
 namespace AliceO2 {
 namespace roc {
 
@@ -29,6 +32,20 @@ struct FirmwareFeatures
 
     /// Is the Arria 10 FPGA chip ID available?
     bool chipId = false;
+
+    // Performance capabilities, see Cru::Registers::FIRMWARE_CAPABILITIES
+
+    /// Can the firmware write the superpage counters to a status page?
+    bool statusPage = false;
+
+    /// Can the firmware raise an interrupt when a superpage completes?
+    bool interrupts = false;
+
+    /// Does the firmware accept a superpage descriptor as one burst write?
+    bool descriptorBurst = false;
+
+    /// Largest DMA page size the firmware supports, in bytes
+    size_t maxDmaPageSize = Cru::DMA_PAGE_SIZE;
 };
 
 } // namespace roc
@@ -0,0 +1,146 @@
+/// \file LinkScheduler.cxx
+/// \brief Implementation of the LinkScheduler class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "Cru/LinkScheduler.h"
+#include <algorithm>
+#include <limits>
+
+namespace AliceO2 {
+namespace roc {
+namespace Cru {
+
+constexpr uint32_t LinkScheduler::DECAY_INTERVAL;
+
+LinkScheduler::LinkScheduler(LinkScheduling::type policy, size_t links, size_t linkCapacity)
+    : mPolicy(policy), mLinkCapacity(linkCapacity), mQueueSizes(links, 0), mEnabled(links, true),
+      mArrivals(links, 0), mTokens(links * linkCapacity * 2)
+{
+}
+
+void LinkScheduler::reset()
+{
+  std::fill(mQueueSizes.begin(), mQueueSizes.end(), 0);
+  std::fill(mArrivals.begin(), mArrivals.end(), 0);
+  mQueuedTotal = 0;
+  mArrivalsTotal = 0;
+  mArrivalsSinceDecay = 0;
+  mTokens.clear();
+  mRoundRobin = 0;
+}
+
+auto LinkScheduler::addLink() -> LinkIndex
+{
+  mQueueSizes.push_back(0);
+  mEnabled.push_back(true);
+  mArrivals.push_back(0);
+  mTokens.set_capacity(mQueueSizes.size() * mLinkCapacity * 2);
+  return LinkIndex(mQueueSizes.size() - 1);
+}
+
+void LinkScheduler::setEnabled(LinkIndex index, bool enabled)
+{
+  mEnabled[index] = enabled;
+  // Its tokens are dropped by getThroughputLinkIndex(), since it has no room
+  mArrivalsTotal -= mArrivals[index];
+  mArrivals[index] = 0;
+}
+
+auto LinkScheduler::getNextLinkIndex() -> LinkIndex
+{
+  if (mPolicy == LinkScheduling::Throughput) {
+    return getThroughputLinkIndex();
+  }
+  return getShortestQueueLinkIndex();
+}
+
+auto LinkScheduler::getShortestQueueLinkIndex() const -> LinkIndex
+{
+  auto smallestQueueIndex = std::numeric_limits<LinkIndex>::max();
+  auto smallestQueueSize = std::numeric_limits<size_t>::max();
+
+  for (size_t i = 0; i < mQueueSizes.size(); ++i) {
+    auto queueSize = mQueueSizes[i];
+    if (mEnabled[i] && queueSize < smallestQueueSize) {
+      smallestQueueIndex = i;
+      smallestQueueSize = queueSize;
+    }
+  }
+
+  return smallestQueueIndex;
+}
+
+auto LinkScheduler::getThroughputLinkIndex() -> LinkIndex
+{
+  // Tokens of links that reached their target are dropped, their slots go to other links
+  while (!mTokens.empty()) {
+    auto index = mTokens.front();
+    mTokens.pop_front();
+    if (hasRoom(index) && belowTarget(index)) {
+      return index;
+    }
+  }
+
+  // No tokens, go round-robin over the links below their target
+  const auto links = LinkIndex(mQueueSizes.size());
+  for (LinkIndex i = 0; i < links; ++i) {
+    auto index = mRoundRobin;
+    mRoundRobin = (mRoundRobin + 1) % links;
+    if (hasRoom(index) && belowTarget(index)) {
+      return index;
+    }
+  }
+
+  // All links are at their target, there are more superpages than the throughput estimate accounts for
+  return getShortestQueueLinkIndex();
+}
+
+size_t LinkScheduler::getTarget(LinkIndex index) const
+{
+  if (mArrivalsTotal == 0) {
+    return mLinkCapacity;
+  }
+  // Share of the superpages in flight (plus the one being pushed), but at least one so idle links are not shut out
+  auto target = ((mQueuedTotal + 1) * mArrivals[index] + mArrivalsTotal - 1) / mArrivalsTotal;
+  return std::max<size_t>(1, std::min<size_t>(target, mLinkCapacity));
+}
+
+void LinkScheduler::pushed(LinkIndex index)
+{
+  mQueueSizes[index]++;
+  mQueuedTotal++;
+}
+
+void LinkScheduler::arrived(LinkIndex index)
+{
+  mQueueSizes[index]--;
+  mQueuedTotal--;
+
+  if (mPolicy != LinkScheduling::Throughput || !mEnabled[index]) {
+    return;
+  }
+
+  mArrivals[index]++;
+  mArrivalsTotal++;
+  mArrivalsSinceDecay++;
+  if (mArrivalsSinceDecay >= DECAY_INTERVAL) {
+    // Halve the counts, so the estimate follows changes in the link rates
+    mArrivalsTotal = 0;
+    for (auto& arrivals : mArrivals) {
+      arrivals /= 2;
+      mArrivalsTotal += arrivals;
+    }
+    mArrivalsSinceDecay = 0;
+  }
+
+  mTokens.push_back(index);
+  if (belowTarget(index)) {
+    // Let the link grow
+    mTokens.push_back(index);
+  }
+}
+
+} // namespace Cru
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,120 @@
+/// \file LinkScheduler.h
+/// \brief Definition of the LinkScheduler class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_CRU_LINKSCHEDULER_H_
+#define ALICEO2_SRC_READOUTCARD_CRU_LINKSCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/circular_buffer.hpp>
+#include "ReadoutCard/ParameterTypes/LinkScheduling.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Cru {
+
+/// Decides which link a pushed superpage goes to.
+/// It keeps track of the queue size of every link, so the channel only has to report pushes and arrivals.
+///
+/// The ShortestQueue policy picks the link with the fewest queued superpages.
+///
+/// The Throughput policy keeps an exponentially decaying count of arrivals per link, and gives every link a target
+/// queue size proportional to its share of the arrivals. A link gets a "refill token" when a superpage arrives from
+/// it, or two if it's below its target. Pushes consume tokens, skipping the ones of links that are at their target,
+/// so slots of slow links flow to fast links. Only when no token is available, the links are visited round-robin.
+/// This makes a push O(1) in the steady state.
+///
+/// Links can be added and disabled while superpages are queued, for links that come and go during a run. A disabled
+/// link is never chosen.
+class LinkScheduler
+{
+  public:
+    using LinkIndex = uint32_t;
+
+    /// \param policy Scheduling policy
+    /// \param links Amount of links
+    /// \param linkCapacity Maximum queue size of a link
+    LinkScheduler(LinkScheduling::type policy, size_t links, size_t linkCapacity);
+
+    /// Forgets all queued superpages and observed throughput. Disabled links stay disabled.
+    void reset();
+
+    /// Adds an enabled link with an empty queue
+    /// \return Index of the link
+    LinkIndex addLink();
+
+    /// Enables or disables a link. A link must have no queued superpages when it is disabled, and its observed
+    /// throughput is forgotten, so it starts from scratch when it is enabled again.
+    void setEnabled(LinkIndex index, bool enabled);
+
+    bool isEnabled(LinkIndex index) const
+    {
+      return mEnabled[index];
+    }
+
+    /// Chooses the link to push the next superpage to. The caller must make sure there is at least one enabled link
+    /// with room.
+    LinkIndex getNextLinkIndex();
+
+    /// Reports that a superpage was pushed to a link
+    void pushed(LinkIndex index);
+
+    /// Reports that a superpage arrived from a link
+    void arrived(LinkIndex index);
+
+    /// Gets the target queue size of a link. Only meaningful for the Throughput policy.
+    size_t getTarget(LinkIndex index) const;
+
+  private:
+    /// Amount of arrivals after which the arrival counts are halved
+    static constexpr uint32_t DECAY_INTERVAL = 256;
+
+    LinkIndex getShortestQueueLinkIndex() const;
+    LinkIndex getThroughputLinkIndex();
+
+    bool hasRoom(LinkIndex index) const
+    {
+      return mEnabled[index] && mQueueSizes[index] < mLinkCapacity;
+    }
+
+    bool belowTarget(LinkIndex index) const
+    {
+      return mQueueSizes[index] < getTarget(index);
+    }
+
+    const LinkScheduling::type mPolicy;
+    const size_t mLinkCapacity;
+
+    /// Queued superpages per link
+    std::vector<size_t> mQueueSizes;
+
+    /// Links that may be chosen
+    std::vector<bool> mEnabled;
+
+    /// Total queued superpages
+    size_t mQueuedTotal = 0;
+
+    /// Decaying arrival count per link
+    std::vector<uint32_t> mArrivals;
+
+    /// Sum of mArrivals
+    uint64_t mArrivalsTotal = 0;
+
+    /// Arrivals since the last decay
+    uint32_t mArrivalsSinceDecay = 0;
+
+    /// Links that should get the next pushes
+    boost::circular_buffer<LinkIndex> mTokens;
+
+    /// Position for the round-robin fallback
+    LinkIndex mRoundRobin = 0;
+};
+
+} // namespace Cru
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_CRU_LINKSCHEDULER_H_
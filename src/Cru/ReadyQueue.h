@@ -0,0 +1,49 @@
+/// \file ReadyQueue.h
+/// \brief Definition of the ready queue helpers of the CRU DMA channel.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_CRU_READYQUEUE_H_
+#define ALICEO2_SRC_READOUTCARD_CRU_READYQUEUE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include "ReadoutCard/Superpage.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Cru {
+
+/// Splits the received part off the superpage a link is filling, as after the SuperpageFlushTimeout
+/// \param front Superpage the link is filling. Left with the part the firmware still has to fill.
+/// \param received Amount of bytes received in the superpage
+/// \return The received part, marked as ready and split
+inline Superpage splitReceived(Superpage& front, size_t received)
+{
+  auto split = front;
+  split.setSize(received);
+  split.setReceived(received);
+  split.setReady(true);
+  split.setSplit(true);
+  front.setOffset(front.getOffset() + received);
+  front.setSize(front.getSize() - received);
+  return split;
+}
+
+/// Finds the oldest superpage of the ready queue that the DropOldest policy can give back to the card. The pieces of
+/// flushed superpages are skipped: their offset and size are no longer those the user pushed, so they would not pass
+/// the superpage checks, and only the user can hand the whole superpage back.
+/// \return Iterator to the superpage, or the end of the queue if it holds only pieces
+template <typename Queue>
+typename Queue::iterator findRecyclable(Queue& queue)
+{
+  return std::find_if(queue.begin(), queue.end(), [](const Superpage& superpage) {
+    return superpage.isChecked() && !superpage.isSplit();
+  });
+}
+
+} // namespace Cru
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_CRU_READYQUEUE_H_
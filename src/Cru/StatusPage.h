@@ -0,0 +1,62 @@
+/// \file StatusPage.h
+/// \brief Definition of the StatusPage struct.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_CRU_STATUSPAGE_H_
+#define ALICEO2_SRC_READOUTCARD_CRU_STATUSPAGE_H_
+
+#include <cstdint>
+#include <array>
+#include "Cru/Constants.h"
+#include "Utilities/DmaMemory.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Cru {
+
+/// Struct representing the CRU status page: a small host memory buffer the firmware writes completion counters to, so
+/// the driver can poll host memory instead of the BAR.
+/// This struct is meant to be used as an aliased type, reinterpret_casted from a raw memory pointer.
+struct StatusPage
+{
+    void reset()
+    {
+      for (auto& count : superpagesPushed) {
+        count = 0;
+      }
+      for (auto& count : pagesPushed) {
+        count = 0;
+      }
+      Utilities::releaseFence();
+    }
+
+    /// Loads the superpage counter of a link with acquire ordering, so the data of the pushed superpages can be read
+    /// with plain loads after
+    uint32_t loadSuperpagesPushed(int link) const
+    {
+      return Utilities::loadAcquire(superpagesPushed[link]);
+    }
+
+    /// Loads the page counter of a link with acquire ordering, so the data of the pushed pages can be read with plain
+    /// loads after
+    uint32_t loadPagesPushed(int link) const
+    {
+      return Utilities::loadAcquire(pagesPushed[link]);
+    }
+
+    /// Amount of completely pushed superpages per link, mirroring the LINK_SUPERPAGES_PUSHED registers
+    std::array<uint32_t, MAX_LINKS> superpagesPushed;
+
+    /// Amount of DMA pages written into the superpage each link is currently filling
+    std::array<uint32_t, MAX_LINKS> pagesPushed;
+};
+
+// The size is critical, because the structure must map exactly to what the CRU writes
+static_assert(sizeof(StatusPage) == (2 * MAX_LINKS * sizeof(uint32_t)), "Size of StatusPage invalid");
+
+} // namespace Cru
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_CRU_STATUSPAGE_H_
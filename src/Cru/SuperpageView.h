@@ -0,0 +1,280 @@
+/// \file SuperpageView.h
+/// \brief Definition of the SuperpageView class and the RDH decoding it uses.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_CRU_SUPERPAGEVIEW_H_
+#define ALICEO2_SRC_READOUTCARD_CRU_SUPERPAGEVIEW_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include "Cru/DataFormat.h"
+#include "Utilities/Util.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Cru {
+
+/// The RDH fields of a DMA page, decoded at once
+struct Rdh
+{
+    uint16_t offsetNextPacket; ///< Bits #[64-79]
+    uint16_t memorySize; ///< Size of the RDH and payload in bytes, bits #[80-95]
+    uint8_t linkId; ///< Bits #[96-103]
+    uint8_t packetCounter; ///< Bits #[104-111]
+    uint16_t cruId; ///< Bits #[112-123]
+    uint8_t dataWrapperId; ///< Bits #[124-127]
+    uint32_t triggerOrbit; ///< Bits #[128-159]
+    uint32_t heartbeatOrbit; ///< Bits #[160-191]
+};
+
+/// Decodes the RDH at the start of a DMA page. The words holding the fields are read with a single copy.
+inline Rdh decodeRdh(const char* page)
+{
+  uint32_t words[6];
+  memcpy(words, page, sizeof(words));
+  Rdh rdh;
+  rdh.offsetNextPacket = Utilities::getBits(words[2], 0, 15);
+  rdh.memorySize = Utilities::getBits(words[2], 16, 31);
+  rdh.linkId = Utilities::getBits(words[3], 0, 7);
+  rdh.packetCounter = Utilities::getBits(words[3], 8, 15);
+  rdh.cruId = Utilities::getBits(words[3], 16, 27);
+  rdh.dataWrapperId = Utilities::getBits(words[3], 28, 31);
+  rdh.triggerOrbit = words[4];
+  rdh.heartbeatOrbit = words[5];
+  return rdh;
+}
+
+/// A DMA page of a superpage, with its decoded RDH. The pointers refer to the DMA buffer, nothing is copied.
+struct Packet
+{
+    Rdh rdh;
+    /// Start of the DMA page, where the RDH is
+    const char* page;
+    /// Start of the payload, right after the RDH
+    const char* payload;
+    /// Size of the payload in bytes, 0 if the memory size is out of range
+    size_t payloadSize;
+    /// False if the RDH's memory size is smaller than the RDH or larger than the DMA page. With packed packets, also
+    /// false if the memory size is larger than the offset to the next packet, or that offset is past the superpage.
+    bool valid;
+};
+
+/// Zero-copy view over the DMA pages of a received superpage, for iterating over them with their decoded RDH:
+///
+///   for (const auto& packet : SuperpageView(bufferAddress + superpage.getOffset(), superpage.getReceived())) {
+///     ...
+///   }
+///
+/// With a prefetch distance, reaching a page prefetches the page that many pages further, so it is in the cache by the
+/// time the loop gets to it. A distance of 2 to 4 pages is typically enough to hide the memory latency.
+///
+/// By default, every DMA page holds one packet. With packed packets, the packets follow each other through the
+/// superpage, and the view steps from one to the next by the offset to the next packet of their RDH, so a DMA page can
+/// hold several small packets, and a packet can cross the boundary between two pages. Since a bad offset leaves no
+/// way to find the next packet, the walk ends after an invalid packet.
+class SuperpageView
+{
+  public:
+    /// Default size of CRU DMA pages
+    static constexpr size_t DMA_PAGE_SIZE = 8 * 1024;
+
+    /// Iterates over the DMA pages, decoding the RDH of a page when the iterator reaches it
+    class RdhIterator : public std::iterator<std::forward_iterator_tag, const Packet>
+    {
+      public:
+        const Packet& operator*() const
+        {
+          return mPacket;
+        }
+
+        const Packet* operator->() const
+        {
+          return &mPacket;
+        }
+
+        RdhIterator& operator++()
+        {
+          mPage = mNext;
+          decode();
+          return *this;
+        }
+
+        RdhIterator operator++(int)
+        {
+          auto copy = *this;
+          ++*this;
+          return copy;
+        }
+
+        bool operator==(const RdhIterator& other) const
+        {
+          return mPage == other.mPage;
+        }
+
+        bool operator!=(const RdhIterator& other) const
+        {
+          return mPage != other.mPage;
+        }
+
+      private:
+        friend class SuperpageView;
+
+        RdhIterator(const char* page, const char* end, size_t pageSize, size_t prefetchDistance,
+            bool prefetchPayload, bool packed)
+            : mPage(page), mNext(page), mEnd(end), mPageSize(pageSize), mPrefetchBytes(prefetchDistance * pageSize),
+              mPrefetchSize(prefetchPayload ? pageSize : Utilities::CACHE_LINE_SIZE), mPacked(packed)
+        {
+          // The pages before the distance are not prefetched by earlier pages
+          const size_t warmup = std::min(mPrefetchBytes, size_t(mEnd - mPage));
+          for (size_t offset = mPageSize; offset < warmup; offset += mPageSize) {
+            Utilities::prefetchRange(mPage + offset, mPrefetchSize);
+          }
+          decode();
+        }
+
+        void decode()
+        {
+          if (mPage == mEnd) {
+            return;
+          }
+          if (mPrefetchBytes != 0 && mPrefetchBytes < size_t(mEnd - mPage)) {
+            Utilities::prefetchRange(mPage + mPrefetchBytes, mPrefetchSize);
+          }
+          mPacket.rdh = decodeRdh(mPage);
+          mPacket.page = mPage;
+          mPacket.payload = mPage + DataFormat::getHeaderSize();
+          const size_t memorySize = mPacket.rdh.memorySize;
+          if (mPacked) {
+            const size_t offset = mPacket.rdh.offsetNextPacket;
+            mPacket.valid = (memorySize >= DataFormat::getHeaderSize()) && (memorySize <= offset)
+                && (offset <= size_t(mEnd - mPage));
+            mNext = mPacket.valid ? mPage + offset : mEnd;
+          } else {
+            mPacket.valid = (memorySize >= DataFormat::getHeaderSize()) && (memorySize <= mPageSize);
+            mNext = mPage + mPageSize;
+          }
+          mPacket.payloadSize = mPacket.valid ? (mPacket.rdh.memorySize - DataFormat::getHeaderSize()) : 0;
+        }
+
+        const char* mPage;
+        /// Start of the next packet
+        const char* mNext;
+        const char* mEnd;
+        size_t mPageSize;
+        /// Distance of the prefetched page in bytes, 0 for none
+        size_t mPrefetchBytes;
+        /// Amount of bytes prefetched of a page
+        size_t mPrefetchSize;
+        bool mPacked;
+        Packet mPacket = Packet();
+    };
+
+    /// \param address Start of the superpage in the DMA buffer
+    /// \param received Amount of bytes received in the superpage. Only the complete DMA pages are walked, or with
+    ///   packed packets, the packets that end within the received bytes.
+    /// \param pageSize Size of the DMA pages
+    /// \param prefetchDistance Amount of pages to prefetch ahead of the iteration, 0 to not prefetch
+    /// \param prefetchPayload True to prefetch whole pages, for loops that read the payload, false to only prefetch the
+    ///   RDH
+    /// \param packed True if the packets are packed, false if every DMA page holds one
+    SuperpageView(const void* address, size_t received, size_t pageSize = DMA_PAGE_SIZE, size_t prefetchDistance = 0,
+        bool prefetchPayload = true, bool packed = false)
+        : mBegin(static_cast<const char*>(address)), mPageSize(pageSize), mPages(received / pageSize),
+          mSize(packed ? received : mPages * pageSize), mPrefetchDistance(prefetchDistance),
+          mPrefetchPayload(prefetchPayload), mPacked(packed)
+    {
+    }
+
+    RdhIterator begin() const
+    {
+      return RdhIterator(mBegin, getEnd(), mPageSize, mPrefetchDistance, mPrefetchPayload, mPacked);
+    }
+
+    RdhIterator end() const
+    {
+      return RdhIterator(getEnd(), getEnd(), mPageSize, 0, false, mPacked);
+    }
+
+    /// Gets the amount of complete DMA pages in the view. With packed packets, the amount of packets is only known by
+    /// walking them.
+    size_t size() const
+    {
+      return mPages;
+    }
+
+  private:
+    const char* getEnd() const
+    {
+      return mBegin + mSize;
+    }
+
+    const char* mBegin;
+    size_t mPageSize;
+    size_t mPages;
+    /// Amount of bytes walked
+    size_t mSize;
+    size_t mPrefetchDistance;
+    bool mPrefetchPayload;
+    bool mPacked;
+};
+
+/// Checks the continuity of the 8-bit packet counters of the links while walking the packets
+class PacketCounterChecker
+{
+  public:
+    /// Amount of links whose counters are tracked, the link ID is 8 bits
+    static constexpr size_t MAX_LINKS = 256;
+
+    PacketCounterChecker()
+    {
+      reset();
+    }
+
+    /// Forgets the counters of all links, so the next packet of a link starts its sequence
+    void reset()
+    {
+      for (auto& expected : mExpected) {
+        expected = UNKNOWN;
+      }
+    }
+
+    /// Checks the packet's counter against the previous one of its link, and continues the sequence from it
+    /// \return False if the counter did not follow the previous one. The first packet of a link always passes.
+    bool check(const Rdh& rdh)
+    {
+      auto& expected = mExpected[rdh.linkId];
+      bool continuous = (expected == UNKNOWN) || (expected == rdh.packetCounter);
+      expected = (rdh.packetCounter + 1) % 0x100;
+      return continuous;
+    }
+
+    /// Checks all packets of a superpage
+    /// \return The amount of discontinuities
+    size_t check(const SuperpageView& view)
+    {
+      size_t errors = 0;
+      for (const auto& packet : view) {
+        if (!check(packet.rdh)) {
+          errors++;
+        }
+      }
+      return errors;
+    }
+
+  private:
+    static constexpr uint16_t UNKNOWN = 0xffff;
+
+    /// Expected next counter of every link
+    std::array<uint16_t, MAX_LINKS> mExpected;
+};
+
+} // namespace Cru
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_CRU_SUPERPAGEVIEW_H_
@@ -28,10 +28,13 @@ print to_replace
 cfile = open('Constants.h')
 contents = cfile.readlines()
 
+# Only the definitions of the registers themselves, not the lines that refer to them (such as the fields of
+# WRAPPER0_LINKS, whose name contains the key)
 for key,value in to_replace.iteritems():
+  definition = re.compile("Register " + key + "\\(")
   for (i, line) in enumerate(contents):
-    if (key in line):
-      contents[i] = re.sub("\([^)]*\)", '(' + value + ')', line)
+    if definition.search(line):
+      contents[i] = re.sub("\\([^)]*\\)", '(' + value + ')', line, count=1)
 
 cfile = open('Constants.h', 'w')
 cfile.writelines(contents)
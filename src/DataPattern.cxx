@@ -0,0 +1,190 @@
+/// \file DataPattern.cxx
+/// \brief Implementation of the DataPattern class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/DataPattern.h"
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+# define ALICEO2_READOUTCARD_DATAPATTERN_X86
+#endif
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// The pattern in the form the kernels use
+struct Pattern
+{
+    uint32_t start;
+    uint32_t shift;
+    uint32_t increment;
+    std::array<uint32_t, 4> mask;
+
+    /// Expected word before masking
+    uint32_t getRaw(size_t index) const
+    {
+      return start + uint32_t(index >> shift) * increment;
+    }
+
+    uint32_t getExpected(size_t index) const
+    {
+      return getRaw(index) & mask[index % 4];
+    }
+};
+
+/// The vector kernels start at an index that is a multiple of this, so the lanes line up with the pattern's groups
+constexpr size_t VECTOR_ALIGNMENT = 16;
+
+size_t findMismatchScalar(const uint32_t* data, size_t begin, size_t end, const Pattern& pattern)
+{
+  for (size_t i = begin; i < end; ++i) {
+    if (data[i] != pattern.getExpected(i)) {
+      return i;
+    }
+  }
+  return end;
+}
+
+/// Checks up to the first index the vector kernels can start at
+/// \return The index to continue from, or a mismatch
+size_t findMismatchPrologue(const uint32_t* data, size_t begin, size_t end, const Pattern& pattern, size_t& vectorBegin)
+{
+  vectorBegin = std::min(end, ((begin + VECTOR_ALIGNMENT - 1) / VECTOR_ALIGNMENT) * VECTOR_ALIGNMENT);
+  return findMismatchScalar(data, begin, vectorBegin, pattern);
+}
+
+#ifdef ALICEO2_READOUTCARD_DATAPATTERN_X86
+
+__attribute__((target("avx2")))
+size_t findMismatchAvx2(const uint32_t* data, size_t begin, size_t end, const Pattern& pattern)
+{
+  constexpr size_t lanes = 8;
+  size_t i;
+  auto mismatch = findMismatchPrologue(data, begin, end, pattern, i);
+  if (mismatch != i) {
+    return mismatch;
+  }
+
+  alignas(32) uint32_t raw[lanes];
+  alignas(32) uint32_t mask[lanes];
+  for (size_t j = 0; j < lanes; ++j) {
+    raw[j] = pattern.getRaw(i + j);
+    mask[j] = pattern.mask[j % 4];
+  }
+  auto rawVector = _mm256_load_si256(reinterpret_cast<const __m256i*>(raw));
+  const auto maskVector = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+  const auto step = _mm256_set1_epi32(int32_t(uint32_t(lanes >> pattern.shift) * pattern.increment));
+
+  for (; (i + lanes) <= end; i += lanes) {
+    auto actual = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    auto equal = _mm256_cmpeq_epi32(actual, _mm256_and_si256(rawVector, maskVector));
+    auto bits = uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+    if (bits != 0xff) {
+      return i + __builtin_ctz(~bits);
+    }
+    rawVector = _mm256_add_epi32(rawVector, step);
+  }
+  return findMismatchScalar(data, i, end, pattern);
+}
+
+__attribute__((target("avx512f")))
+size_t findMismatchAvx512(const uint32_t* data, size_t begin, size_t end, const Pattern& pattern)
+{
+  constexpr size_t lanes = 16;
+  size_t i;
+  auto mismatch = findMismatchPrologue(data, begin, end, pattern, i);
+  if (mismatch != i) {
+    return mismatch;
+  }
+
+  alignas(64) uint32_t raw[lanes];
+  alignas(64) uint32_t mask[lanes];
+  for (size_t j = 0; j < lanes; ++j) {
+    raw[j] = pattern.getRaw(i + j);
+    mask[j] = pattern.mask[j % 4];
+  }
+  auto rawVector = _mm512_load_si512(raw);
+  const auto maskVector = _mm512_load_si512(mask);
+  const auto step = _mm512_set1_epi32(int32_t(uint32_t(lanes >> pattern.shift) * pattern.increment));
+
+  for (; (i + lanes) <= end; i += lanes) {
+    auto actual = _mm512_loadu_si512(data + i);
+    auto notEqual = _mm512_cmpneq_epu32_mask(actual, _mm512_and_si512(rawVector, maskVector));
+    if (notEqual != 0) {
+      return i + __builtin_ctz(notEqual);
+    }
+    rawVector = _mm512_add_epi32(rawVector, step);
+  }
+  return findMismatchScalar(data, i, end, pattern);
+}
+
+#endif // ALICEO2_READOUTCARD_DATAPATTERN_X86
+
+using Kernel = size_t (*)(const uint32_t*, size_t, size_t, const Pattern&);
+
+struct Implementation
+{
+    Kernel kernel;
+    const char* name;
+};
+
+Implementation selectImplementation()
+{
+#ifdef ALICEO2_READOUTCARD_DATAPATTERN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return {findMismatchAvx512, "avx512"};
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return {findMismatchAvx2, "avx2"};
+  }
+#endif
+  return {findMismatchScalar, "scalar"};
+}
+
+const Implementation& getSelectedImplementation()
+{
+  static const Implementation implementation = selectImplementation();
+  return implementation;
+}
+
+} // Anonymous namespace
+
+DataPattern DataPattern::makeIncremental(uint32_t first)
+{
+  return DataPattern(first, 0, 1, {{~0u, ~0u, ~0u, ~0u}});
+}
+
+DataPattern DataPattern::makeConstant(uint32_t value)
+{
+  return DataPattern(value, 0, 0, {{~0u, ~0u, ~0u, ~0u}});
+}
+
+DataPattern DataPattern::makeCruInternal(uint32_t counter)
+{
+  return DataPattern(counter, 3, 1, {{~0u, ~0u, ~0u, ~0u}});
+}
+
+DataPattern DataPattern::makeCruDdg(uint32_t counter)
+{
+  return DataPattern(counter, 2, 1, {{~0u, ~0u, 0xffffu, 0u}});
+}
+
+size_t DataPattern::findMismatch(const void* data, size_t begin, size_t end) const
+{
+  if (begin >= end) {
+    return end;
+  }
+  return getSelectedImplementation().kernel(static_cast<const uint32_t*>(data), begin, end,
+      Pattern{mStart, mShift, mIncrement, mMask});
+}
+
+const char* DataPattern::getImplementation()
+{
+  return getSelectedImplementation().name;
+}
+
+} // namespace roc
+} // namespace AliceO2
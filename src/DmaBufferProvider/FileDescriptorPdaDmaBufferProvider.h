@@ -0,0 +1,81 @@
+/// \file FileDescriptorPdaDmaBufferProvider.h
+/// \brief Definition of the FileDescriptorPdaDmaBufferProvider class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_FILEDESCRIPTORPDADMABUFFERPROVIDER_H_
+#define ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_FILEDESCRIPTORPDADMABUFFERPROVIDER_H_
+
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ReadoutCard/HugepageMemfd.h"
+#include "Pda/PdaDevice.h"
+#include "Pda/PdaDmaBuffer.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Implementation of the DmaBufferProviderInterface for DMA buffers in a HugepageMemfd, mapped from a
+/// file descriptor and registered with PDA
+class FileDescriptorPdaDmaBufferProvider : public DmaBufferProviderInterface
+{
+  public:
+    FileDescriptorPdaDmaBufferProvider(Pda::PdaDevice::PdaPciDevice pciDevice, int fileDescriptor,
+        size_t size, int dmaBufferId, bool requireHugepage)
+        : mMemfd(fileDescriptor, size), mAddress(mMemfd.getAddress()), mSize(mMemfd.getSize()),
+          mPdaBuffer(pciDevice, mAddress, mSize, dmaBufferId, requireHugepage)
+    {
+
+    }
+
+    virtual ~FileDescriptorPdaDmaBufferProvider() = default;
+
+    /// Get starting userspace address of the DMA buffer
+    virtual uintptr_t getAddress() const
+    {
+      return reinterpret_cast<uintptr_t>(mAddress);
+    }
+
+    /// Get total size of the DMA buffer
+    virtual size_t getSize() const
+    {
+      return mSize;
+    }
+
+    /// Amount of entries in the scatter-gather list
+    virtual size_t getScatterGatherListSize() const
+    {
+      return mPdaBuffer.getScatterGatherList().size();
+    }
+
+    /// Get size of an entry of the scatter-gather list
+    virtual size_t getScatterGatherEntrySize(int index) const
+    {
+      return mPdaBuffer.getScatterGatherList().at(index).size;
+    }
+
+    /// Get userspace address of an entry of the scatter-gather list
+    virtual uintptr_t getScatterGatherEntryAddress(int index) const
+    {
+      return mPdaBuffer.getScatterGatherList().at(index).addressUser;
+    }
+
+    /// Function for getting the bus address that corresponds to the user address + given offset
+    virtual uintptr_t getBusOffsetAddress(size_t offset) const
+    {
+      return mPdaBuffer.getBusOffsetAddress(offset);
+    }
+
+  private:
+    HugepageMemfd mMemfd;
+    void* mAddress;
+    size_t mSize;
+    Pda::PdaDmaBuffer mPdaBuffer;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_FILEDESCRIPTORPDADMABUFFERPROVIDER_H_
\ No newline at end of file
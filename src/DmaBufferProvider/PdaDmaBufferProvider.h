@@ -8,6 +8,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include "DmaBufferProvider/DmaBufferProviderInterface.h"
 #include "Pda/PdaDevice.h"
@@ -22,12 +23,18 @@ class PdaDmaBufferProvider : public DmaBufferProviderInterface
   public:
     PdaDmaBufferProvider(Pda::PdaDevice::PdaPciDevice pciDevice, void* userBufferAddress, size_t userBufferSize,
         int dmaBufferId, bool requireHugepage)
-        : mAddress(userBufferAddress), mSize(userBufferSize), mPdaBuffer(pciDevice, userBufferAddress, userBufferSize,
-            dmaBufferId, requireHugepage)
+        : mAddress(userBufferAddress), mSize(userBufferSize), mPdaBuffer(std::make_shared<Pda::PdaDmaBuffer>(pciDevice,
+            userBufferAddress, userBufferSize, dmaBufferId, requireHugepage))
     {
 
     }
 
+    /// Uses an existing registration, which may be shared, such as one kept by the PdaDmaBufferCache
+    PdaDmaBufferProvider(void* userBufferAddress, size_t userBufferSize, std::shared_ptr<Pda::PdaDmaBuffer> pdaBuffer)
+        : mAddress(userBufferAddress), mSize(userBufferSize), mPdaBuffer(std::move(pdaBuffer))
+    {
+    }
+
     virtual ~PdaDmaBufferProvider() = default;
 
     /// Get starting userspace address of the DMA buffer
@@ -45,31 +52,31 @@ class PdaDmaBufferProvider : public DmaBufferProviderInterface
     /// Amount of entries in the scatter-gather list
     virtual size_t getScatterGatherListSize() const
     {
-      return mPdaBuffer.getScatterGatherList().size();
+      return mPdaBuffer->getScatterGatherList().size();
     }
 
     /// Get size of an entry of the scatter-gather list
     virtual size_t getScatterGatherEntrySize(int index) const
     {
-      return mPdaBuffer.getScatterGatherList().at(index).size;
+      return mPdaBuffer->getScatterGatherList().at(index).size;
     }
 
     /// Get userspace address of an entry of the scatter-gather list
     virtual uintptr_t getScatterGatherEntryAddress(int index) const
     {
-      return mPdaBuffer.getScatterGatherList().at(index).addressUser;
+      return mPdaBuffer->getScatterGatherList().at(index).addressUser;
     }
 
     /// Function for getting the bus address that corresponds to the user address + given offset
     virtual uintptr_t getBusOffsetAddress(size_t offset) const
     {
-      return mPdaBuffer.getBusOffsetAddress(offset);
+      return mPdaBuffer->getBusOffsetAddress(offset);
     }
 
   private:
     void* mAddress;
     size_t mSize;
-    Pda::PdaDmaBuffer mPdaBuffer;
+    std::shared_ptr<Pda::PdaDmaBuffer> mPdaBuffer;
 };
 
 } // namespace roc
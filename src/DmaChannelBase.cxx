@@ -4,12 +4,17 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include "DmaChannelBase.h"
 #include <iostream>
 //#include "ChannelPaths.h"
 #include "Common/System.h"
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+# include "Pda/PdaDmaBufferCache.h"
+#endif
 #include "Utilities/SmartPointer.h"
+#include "Utilities/Wait.h"
 #include "Visitor.h"
 
 namespace AliceO2 {
@@ -53,13 +58,23 @@ void DmaChannelBase::freeUnusedChannelBuffer()
   namespace bfs = boost::filesystem;
   InfoLogger::InfoLogger logger;
  
+  std::unique_ptr<Pda::PdaLock> lock;
   try {
-    Pda::PdaLock lock{}; // We're messing around with PDA buffers so we need this even though we hold the DMA lock
+    // We're messing around with PDA buffers so we need this even though we hold the DMA lock
+    lock = std::make_unique<Pda::PdaLock>(mCardDescriptor.pciAddress);
   } catch (const LockException& exception) {
     log("Failed to acquire PDA lock", InfoLogger::InfoLogger::Debug);
     throw;
   }
 
+  // Registrations of hugepage pool buffers are kept on purpose, so the channels can be reopened on them
+  std::vector<std::string> retainedIds;
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+  for (int id : Pda::PdaDmaBufferCache::getDmaBufferIds(mCardDescriptor.pciAddress)) {
+    retainedIds.push_back(std::to_string(id));
+  }
+#endif
+
   try {
     std::string pciPath = "/sys/bus/pci/drivers/uio_pci_dma/";
     if (boost::filesystem::exists(pciPath)) {
@@ -74,7 +89,8 @@ void DmaChannelBase::freeUnusedChannelBuffer()
             std::string dmaPath("/sys/bus/pci/drivers/uio_pci_dma/" + filename + "/dma");
             for (auto &entry : boost::make_iterator_range(bfs::directory_iterator(dmaPath), {})) {
               auto bufferId = entry.path().filename().string();
-              if (bfs::is_directory(entry)) {
+              bool retained = std::find(retainedIds.begin(), retainedIds.end(), bufferId) != retainedIds.end();
+              if (bfs::is_directory(entry) && !retained) {
                 std::string mapPath = dmaPath + "/" + bufferId + "/map";
                 std::string freePath = dmaPath + "/free";
                                 logger << "Freeing PDA buffer '" + mapPath + "'" << InfoLogger::InfoLogger::endm;
@@ -91,10 +107,25 @@ void DmaChannelBase::freeUnusedChannelBuffer()
   }
 }
 
+constexpr std::chrono::nanoseconds DmaChannelBase::DEFAULT_WAIT_SPIN_TIME;
+
 DmaChannelBase::DmaChannelBase(CardDescriptor cardDescriptor, Parameters& parameters,
     const AllowedChannels& allowedChannels)
-    : mCardDescriptor(cardDescriptor), mChannelNumber(parameters.getChannelNumberRequired())
+    : mCardDescriptor(cardDescriptor), mChannelNumber(parameters.getChannelNumberRequired()),
+      mWaitSpinTime(parameters.getWaitSpinTime().get_value_or(DEFAULT_WAIT_SPIN_TIME))
 {
+  mLogPrefix = "[pci=" + cardDescriptor.pciAddress.toString();
+  if (auto serial = getSerialNumber()) {
+    mLogPrefix += " serial=" + std::to_string(serial.get());
+  }
+  mLogPrefix += " channel=" + std::to_string(getChannelNumber()) + "] ";
+
+  if (parameters.getAsyncLoggingEnabled().get_value_or(false)) {
+    mAsyncLogger = std::make_unique<AsyncLogger>([this](AsyncLogger::Severity severity, const std::string& message) {
+      mAsyncInfoLogger << severity << message << InfoLogger::InfoLogger::endm;
+    });
+  }
+
 #ifndef NDEBUG
   log("Backend compiled without NDEBUG; performance may be severely degraded", InfoLogger::InfoLogger::Info);
 #endif
@@ -117,6 +148,14 @@ DmaChannelBase::DmaChannelBase(CardDescriptor cardDescriptor, Parameters& parame
 
   log("Acquired DMA channel lock", InfoLogger::InfoLogger::Debug);
 
+  // Only the owner of the channel may reset its table, so it is mapped after the lock is acquired
+  ChannelStatisticsTable* statisticsTable = nullptr;
+  if (parameters.getStatisticsPublishingEnabled().get_value_or(false)) {
+    mStatisticsFile = std::make_unique<MemoryMappedFile>(getPaths().statistics(), sizeof(ChannelStatisticsTable));
+    statisticsTable = reinterpret_cast<ChannelStatisticsTable*>(mStatisticsFile->getAddress());
+  }
+  mStatisticsCounters = std::make_unique<ChannelStatisticsCounters>(statisticsTable);
+
   freeUnusedChannelBuffer();
 }
 
@@ -125,14 +164,106 @@ DmaChannelBase::~DmaChannelBase()
   log("Releasing DMA channel lock", InfoLogger::InfoLogger::Debug);
 }
 
+void DmaChannelBase::pushSuperpages(const Superpage* superpages, size_t count)
+{
+  if (count > size_t(getTransferQueueAvailable())) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpages, not enough transfer queue slots")
+        << ErrorInfo::SuperpageCount(count));
+  }
+
+  // Check everything up front, so we don't leave the queue half-pushed if one of the superpages is bad
+  for (size_t i = 0; i < count; ++i) {
+    validateSuperpage(superpages[i], boost::none);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    pushSuperpage(superpages[i]);
+  }
+}
+
+bool DmaChannelBase::tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId)
+{
+  // The superpage itself is checked by tryPushSuperpage()
+  DmaChannelBase::validateSuperpage(superpage, linkId);
+  return tryPushSuperpage(superpage);
+}
+
+void DmaChannelBase::validateSuperpage(const Superpage&, boost::optional<uint32_t> linkId)
+{
+  if (linkId && *linkId != 0) {
+    BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("Card has one link per channel, only link 0 is valid")
+        << ErrorInfo::LinkId(*linkId));
+  }
+}
+
+void DmaChannelBase::releaseSuperpage(Superpage superpage)
+{
+  superpage.setReady(false);
+  superpage.setReceived(0);
+  pushSuperpage(superpage);
+}
+
+size_t DmaChannelBase::popSuperpages(Superpage* superpages, size_t max)
+{
+  auto count = std::min(max, size_t(getReadyQueueSize()));
+  for (size_t i = 0; i < count; ++i) {
+    superpages[i] = popSuperpage();
+  }
+  return count;
+}
+
+bool DmaChannelBase::tryPushSuperpage(const Superpage& superpage)
+{
+  if (getTransferQueueAvailable() <= 0) {
+    return false;
+  }
+  pushSuperpage(superpage);
+  return true;
+}
+
+bool DmaChannelBase::tryPopSuperpage(Superpage& superpage)
+{
+  return popSuperpages(&superpage, 1) == 1;
+}
+
+bool DmaChannelBase::waitForReadySuperpage(std::chrono::nanoseconds timeout)
+{
+  return Utilities::spinThenSleep([&]{
+      fillSuperpages();
+      return getReadyQueueSize() > 0;
+    }, timeout, mWaitSpinTime);
+}
+
+int DmaChannelBase::getReadyFileDescriptor()
+{
+  return -1;
+}
+
+int DmaChannelBase::addBuffer(const buffer_parameters::Memory&)
+{
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Additional DMA buffers not supported by this card type"));
+}
+
+void DmaChannelBase::enableLink(uint32_t linkId)
+{
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Enabling links at runtime not supported by this card type")
+      << ErrorInfo::LinkId(linkId));
+}
+
+void DmaChannelBase::disableLink(uint32_t linkId)
+{
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Disabling links at runtime not supported by this card type")
+      << ErrorInfo::LinkId(linkId));
+}
+
 void DmaChannelBase::log(const std::string& message, boost::optional<InfoLogger::InfoLogger::Severity> severity)
 {
-  mLogger << severity.get_value_or(mLogLevel);
-  mLogger << "[pci=" << getCardDescriptor().pciAddress.toString();
-  if (auto serial = getSerialNumber()) {
-    mLogger << " serial=" << serial.get();
+  if (mAsyncLogger) {
+    mAsyncLogger->post(severity.get_value_or(mLogLevel), mLogPrefix + message);
+    return;
   }
-  mLogger << " channel=" << getChannelNumber() << "] ";
+  mLogger << severity.get_value_or(mLogLevel);
+  mLogger << mLogPrefix;
   mLogger << message;
   mLogger << InfoLogger::InfoLogger::endm;
 }
@@ -12,13 +12,17 @@
 #include <mutex>
 #include <boost/optional.hpp>
 #include <InfoLogger/InfoLogger.hxx>
+#include "AsyncLogger.h"
 #include "CardDescriptor.h"
 #include "ChannelPaths.h"
+#include "ChannelStatisticsCounters.h"
 #include "InterprocessLock.h"
 #include "Pda/PdaLock.h"
 #include "ReadoutCard/DmaChannelInterface.h"
 #include "ReadoutCard/Exception.h"
+#include "ReadoutCard/MemoryMappedFile.h"
 #include "ReadoutCard/Parameters.h"
+#include "TraceRing.h"
 #include "Utilities/Util.h"
 
 namespace AliceO2 {
@@ -41,6 +45,48 @@ class DmaChannelBase: public DmaChannelInterface
         const AllowedChannels& allowedChannels);
     virtual ~DmaChannelBase();
 
+    /// Default implementation, validates all superpages and then pushes them one by one
+    virtual void pushSuperpages(const Superpage* superpages, size_t count) override;
+
+    /// Default implementation for cards with one link per channel, pushes with tryPushSuperpage()
+    virtual bool tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId) override;
+
+    /// Default implementation for cards with one link per channel, only checks the link ID
+    virtual void validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId) override;
+
+    /// Default implementation, resets the superpage and pushes it with pushSuperpage()
+    virtual void releaseSuperpage(Superpage superpage) override;
+
+    /// Default implementation, pops the superpages one by one
+    virtual size_t popSuperpages(Superpage* superpages, size_t max) override;
+
+    /// Default implementation, checks the transfer queue before pushing
+    virtual bool tryPushSuperpage(const Superpage& superpage) override;
+
+    /// Default implementation, pops with popSuperpages()
+    virtual bool tryPopSuperpage(Superpage& superpage) override;
+
+    /// Default implementation, superpages are only handed out when they are filled
+    virtual size_t getPartialSuperpages(Superpage*, size_t) override
+    {
+      return 0;
+    }
+
+    /// Default implementation, spins on fillSuperpages() and then sleeps with exponential backoff
+    virtual bool waitForReadySuperpage(std::chrono::nanoseconds timeout) override;
+
+    /// Default implementation, no descriptor available
+    virtual int getReadyFileDescriptor() override;
+
+    /// Default implementation, additional buffers are not supported
+    virtual int addBuffer(const buffer_parameters::Memory& buffer) override;
+
+    /// Default implementation, links can't be enabled and disabled at runtime
+    virtual void enableLink(uint32_t linkId) override;
+
+    /// Default implementation, links can't be enabled and disabled at runtime
+    virtual void disableLink(uint32_t linkId) override;
+
     /// Default implementation for optional function
     virtual boost::optional<float> getTemperature() override
     {
@@ -59,6 +105,27 @@ class DmaChannelBase: public DmaChannelInterface
       return {};
     }
 
+    /// Default implementation, no BARs to report on
+    virtual BarStatistics getBarStatistics() override
+    {
+      return {};
+    }
+
+    virtual ChannelStatistics getStatistics() override
+    {
+      return mStatisticsCounters->get();
+    }
+
+    virtual void dumpTrace(std::ostream& stream) override
+    {
+      mTraceRing.dump(stream);
+    }
+
+    virtual uint16_t getRunEpoch() override
+    {
+      return mRunEpoch;
+    }
+
   protected:
     /// Namespace for enum describing the initialization state of the shared data
     struct InitializationState
@@ -89,8 +156,28 @@ class DmaChannelBase: public DmaChannelInterface
       return {getCardDescriptor().pciAddress, getChannelNumber()};
     }
 
+    /// Logs a message with the channel's PCI address, serial and channel number. With the AsyncLoggingEnabled
+    /// parameter, it goes through the asynchronous log ring, so it does not wait for the logging I/O.
     void log(const std::string& message, boost::optional<InfoLogger::InfoLogger::Severity> severity = boost::none);
 
+    /// Logs a message of a rate-limited site. The message is only formatted if the site may log, so the formatting
+    /// costs nothing while a flood is suppressed. The first message after a suppression tells how many were suppressed.
+    /// \param limit Rate limit of the site
+    /// \param format Function returning the message
+    template <class Format>
+    void logLimited(LogRateLimit& limit, Format format,
+        boost::optional<InfoLogger::InfoLogger::Severity> severity = boost::none)
+    {
+      if (!limit.allow()) {
+        return;
+      }
+      std::string message = format();
+      if (auto suppressed = limit.takeSuppressed()) {
+        message += " (" + std::to_string(suppressed) + " similar messages suppressed)";
+      }
+      log(message, severity);
+    }
+
     InfoLogger::InfoLogger& getLogger()
     {
       return mLogger;
@@ -101,12 +188,35 @@ class DmaChannelBase: public DmaChannelInterface
       return mLogLevel;
     }
 
+    /// Gets the counters behind getStatistics(), to be updated by the implementation
+    ChannelStatisticsCounters& getStatisticsCounters()
+    {
+      return *mStatisticsCounters;
+    }
+
+    /// Gets the trace ring behind dumpTrace(), to be recorded into by the implementation
+    TraceRing& getTraceRing()
+    {
+      return mTraceRing;
+    }
+
     virtual void setLogLevel(InfoLogger::InfoLogger::Severity severity) final override
     {
       mLogLevel = severity;
     }
 
+    /// Moves to the next run epoch, for startNextRun(). The implementation stamps pushed superpages with
+    /// getRunEpoch().
+    /// \return The new epoch
+    uint16_t advanceRunEpoch()
+    {
+      return ++mRunEpoch;
+    }
+
   private:
+    /// Default time waitForReadySuperpage() busy-polls before sleeping
+    static constexpr std::chrono::nanoseconds DEFAULT_WAIT_SPIN_TIME = std::chrono::microseconds(20);
+
     /// Check if the channel number is valid
     void checkChannelNumber(const AllowedChannels& allowedChannels);
 
@@ -128,8 +238,32 @@ class DmaChannelBase: public DmaChannelInterface
     /// InfoLogger instance
     InfoLogger::InfoLogger mLogger;
 
+    /// InfoLogger instance of the asynchronous log's flusher thread, which must not share mLogger
+    InfoLogger::InfoLogger mAsyncInfoLogger;
+
+    /// Asynchronous log, only created with the AsyncLoggingEnabled parameter
+    std::unique_ptr<AsyncLogger> mAsyncLogger;
+
+    /// Prefix of the log messages, identifying the channel
+    std::string mLogPrefix;
+
     /// Current log level
     InfoLogger::InfoLogger::Severity mLogLevel;
+
+    /// Time waitForReadySuperpage() busy-polls before sleeping
+    const std::chrono::nanoseconds mWaitSpinTime;
+
+    /// Shared-memory table of the statistics, only mapped with the StatisticsPublishingEnabled parameter
+    std::unique_ptr<MemoryMappedFile> mStatisticsFile;
+
+    /// Channel statistics, created once the channel lock is held
+    std::unique_ptr<ChannelStatisticsCounters> mStatisticsCounters;
+
+    /// Trace of the most recent DMA events
+    TraceRing mTraceRing;
+
+    /// Epoch of the current run, see startNextRun()
+    uint16_t mRunEpoch = 0;
 };
 
 } // namespace roc
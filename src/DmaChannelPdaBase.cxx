@@ -4,14 +4,22 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "DmaChannelPdaBase.h"
+#include <poll.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <boost/exception/diagnostic_information.hpp>
 #include <boost/filesystem/path.hpp>
 #include "Common/Iommu.h"
+#include "Pda/PdaDmaBufferCache.h"
+#include "ReadoutCard/HugepagePool.h"
 #include "Utilities/MemoryMaps.h"
 #include "Utilities/Numa.h"
 #include "Utilities/SmartPointer.h"
 #include "Utilities/Util.h"
 #include "DmaBufferProvider/PdaDmaBufferProvider.h"
 #include "DmaBufferProvider/FilePdaDmaBufferProvider.h"
+#include "DmaBufferProvider/FileDescriptorPdaDmaBufferProvider.h"
 #include "DmaBufferProvider/NullDmaBufferProvider.h"
 #include "Visitor.h"
 
@@ -36,31 +44,38 @@ DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
   Utilities::resetSmartPtr(mRocPciDevice, getCardDescriptor().pciAddress);
 
   // Create/register buffer
+  mRetainRegistration = parameters.getBufferRegistrationRetained().get_value_or(false);
+  mExcludeBufferFromDump = parameters.getBufferDumpExcluded().get_value_or(true);
+  mBufferProviders.reserve(DMA_BUFFER_INDEX_PAGES_CHANNEL_MAX);
+  mBusMappings.reserve(DMA_BUFFER_INDEX_PAGES_CHANNEL_MAX);
   if (auto bufferParameters = parameters.getBufferParameters()) {
     // Create appropriate BufferProvider subclass
     auto bufferId = getPdaDmaBufferIndexPages(getChannelNumber(), 0);
-    mBufferProvider = Visitor::apply<std::unique_ptr<DmaBufferProviderInterface>>(*bufferParameters,
+    addBufferProvider(Visitor::apply<std::unique_ptr<DmaBufferProviderInterface>>(*bufferParameters,
         [&](buffer_parameters::Memory parameters){
-          log("Initializing with DMA buffer from memory region", InfoLogger::InfoLogger::Debug);
-          return std::make_unique<PdaDmaBufferProvider>(mRocPciDevice->getPciDevice(), parameters.address,
-            parameters.size, bufferId, true);
+          return makeBufferProvider(parameters, bufferId);
         },
         [&](buffer_parameters::File parameters){
           log("Initializing with DMA buffer from memory-mapped file", InfoLogger::InfoLogger::Debug);
           return std::make_unique<FilePdaDmaBufferProvider>(mRocPciDevice->getPciDevice(), parameters.path,
             parameters.size, bufferId, true);
         },
+        [&](buffer_parameters::FileDescriptor parameters){
+          log("Initializing with DMA buffer from file descriptor", InfoLogger::InfoLogger::Debug);
+          return std::make_unique<FileDescriptorPdaDmaBufferProvider>(mRocPciDevice->getPciDevice(),
+            parameters.fileDescriptor, parameters.size, bufferId, true);
+        },
         [&](buffer_parameters::Null){
           log("Initializing with null DMA buffer", InfoLogger::InfoLogger::Debug);
           return std::make_unique<NullDmaBufferProvider>();
-        });
+        }));
   } else {
     BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("DmaChannel requires buffer_parameters"));
   }
 
   // Check if scatter-gather list is not suspicious
   {
-    auto listSize = mBufferProvider->getScatterGatherListSize();
+    auto listSize = getBufferProvider().getScatterGatherListSize();
     auto hugePageMinSize = 1024*1024*2; // 2 MiB, the smallest hugepage size
     auto bufferSize = getBufferProvider().getSize();
     log(std::string("Scatter-gather list size: ") + std::to_string(listSize));
@@ -75,38 +90,133 @@ DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
   // Check memory mappings if it's hugepage
   if (getBufferProvider().getSize() > 0) {
     // Non-null buffer
-    bool checked = false;
-    const auto maps = Utilities::getMemoryMaps();
-    for (const auto& map : maps) {
-      const auto bufferAddress = reinterpret_cast<uintptr_t>(getBufferProvider().getAddress());
-      if (map.addressStart == bufferAddress) {
-        if (map.pageSizeKiB > 4) {
-          log("Buffer is hugepage-backed", InfoLogger::InfoLogger::Info);
+    const auto pageSize = Utilities::getPageSize(reinterpret_cast<const void*>(getBufferProvider().getAddress()));
+    if (!pageSize) {
+      log("Failed to check if buffer is hugepage-backed", InfoLogger::InfoLogger::Warning);
+    } else if (*pageSize > 4*1024) {
+      log("Buffer is hugepage-backed", InfoLogger::InfoLogger::Info);
+    } else {
+      if (Common::Iommu::isEnabled()) {
+        // Anonymous memory may still be backed by transparent hugepages, as a TransparentHugepageBuffer is
+        const auto size = getBufferProvider().getSize();
+        const auto hugepageBytes = std::min(Utilities::getTransparentHugepageBytes(
+            reinterpret_cast<const void*>(getBufferProvider().getAddress())).get_value_or(0), size);
+        if (hugepageBytes > 0) {
+          log("Buffer is backed by transparent hugepages for " + std::to_string(hugepageBytes / (1024*1024)) + " of "
+              + std::to_string(size / (1024*1024)) + " MiB, effective page size "
+              + (hugepageBytes == size ? "2 MiB" : "4 KiB") + ", IOMMU is enabled",
+              hugepageBytes == size ? InfoLogger::InfoLogger::Info : InfoLogger::InfoLogger::Warning);
         } else {
-          if (Common::Iommu::isEnabled()) {
-            log("Buffer is NOT hugepage-backed, but IOMMU is enabled", InfoLogger::InfoLogger::Warning);
-          } else {
-            std::string message = "Buffer is NOT hugepage-backed and IOMMU is disabled - unsupported buffer "
-              "configuration";
-            log(message, InfoLogger::InfoLogger::Error);
-            BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(message)
-              << ErrorInfo::PossibleCauses({"roc-setup-hugetlbfs was not run"}));
-          }
+          log("Buffer is NOT hugepage-backed, but IOMMU is enabled. A TransparentHugepageBuffer gives 2 MiB pages "
+              "without reserved hugepages", InfoLogger::InfoLogger::Warning);
         }
-        checked = true;
-        break;
+      } else {
+        std::string message = "Buffer is NOT hugepage-backed and IOMMU is disabled - unsupported buffer "
+          "configuration";
+        log(message, InfoLogger::InfoLogger::Error);
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(message)
+          << ErrorInfo::PossibleCauses({"roc-setup-hugetlbfs was not run"}));
       }
     }
-    if (!checked) {
-      log("Failed to check if buffer is hugepage-backed", InfoLogger::InfoLogger::Warning);
+  }
+
+  // Check if the buffer is local to the card, otherwise every DMA write and every read by the user crosses the
+  // inter-socket link. The pages were faulted in by the PDA registration, this only looks them up.
+  if (getBufferProvider().getSize() > 0 && getCardDescriptor().numaNode >= 0) {
+    const int numaNode = getCardDescriptor().numaNode;
+    const size_t hugePageMinSize = 1024*1024*2;
+    try {
+      const auto address = reinterpret_cast<const void*>(getBufferProvider().getAddress());
+      const size_t size = getBufferProvider().getSize();
+      const size_t pages = (size + hugePageMinSize - 1) / hugePageMinSize;
+      const size_t remote = Utilities::countRemotePages(address, size, hugePageMinSize, numaNode);
+      if (remote > 0) {
+        log("DMA buffer is NOT local to the card: " + std::to_string(remote) + " of " + std::to_string(pages)
+            + " 2 MiB regions are not on the card's NUMA node " + std::to_string(numaNode)
+            + ". Allocate the buffer on that node, for example with a HugepagePool created for it",
+            InfoLogger::InfoLogger::Error);
+      } else {
+        log("DMA buffer is on the card's NUMA node " + std::to_string(numaNode), InfoLogger::InfoLogger::Debug);
+      }
+    }
+    catch (const Exception& e) {
+      log("Failed to check NUMA locality of buffer: " + boost::diagnostic_information(e),
+          InfoLogger::InfoLogger::Warning);
     }
   }
+
+  if (parameters.getInterruptEnabled().get_value_or(false)) {
+    enableInterrupts();
+  }
 }
 
+void DmaChannelPdaBase::enableInterrupts()
+{
+  log("Enabling interrupt-driven arrival notification", InfoLogger::InfoLogger::Debug);
+  mInterrupt = std::make_unique<Pda::PdaInterrupt>(getCardDescriptor().pciAddress);
+}
+
+constexpr std::chrono::milliseconds DmaChannelPdaBase::INTERRUPT_FALLBACK_INTERVAL;
+
 DmaChannelPdaBase::~DmaChannelPdaBase()
 {
 }
 
+std::unique_ptr<DmaBufferProviderInterface> DmaChannelPdaBase::makeBufferProvider(
+    const buffer_parameters::Memory& buffer, int bufferId)
+{
+  if (HugepagePool::isPoolMemory(buffer.address, buffer.size) || mRetainRegistration) {
+    log(mRetainRegistration ? "Initializing with DMA buffer from memory region, retaining registration"
+      : "Initializing with DMA buffer from hugepage pool", InfoLogger::InfoLogger::Debug);
+    return std::make_unique<PdaDmaBufferProvider>(buffer.address, buffer.size,
+      Pda::PdaDmaBufferCache::getDmaBuffer(mRocPciDevice->getPciDevice(), getCardDescriptor().pciAddress,
+        buffer.address, buffer.size, bufferId, true));
+  }
+  log("Initializing with DMA buffer from memory region", InfoLogger::InfoLogger::Debug);
+  return std::make_unique<PdaDmaBufferProvider>(mRocPciDevice->getPciDevice(), buffer.address, buffer.size, bufferId,
+    true);
+}
+
+int DmaChannelPdaBase::addBuffer(const buffer_parameters::Memory& buffer)
+{
+  const int id = mBufferProviders.size();
+  if (id >= DMA_BUFFER_INDEX_PAGES_CHANNEL_MAX) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not add DMA buffer, channel has too many buffers"));
+  }
+  addBufferProvider(makeBufferProvider(buffer, getPdaDmaBufferIndexPages(getChannelNumber(), id)));
+  log("Added DMA buffer " + std::to_string(id), InfoLogger::InfoLogger::Debug);
+  return id;
+}
+
+void DmaChannelPdaBase::addBufferProvider(std::unique_ptr<DmaBufferProviderInterface> provider)
+{
+  // Within a scatter-gather entry the bus addresses follow the user addresses, so it's enough to check that every
+  // entry, and the end of the buffer, is where the start of the buffer puts it
+  BusMapping mapping {false, 0};
+  const size_t size = provider->getSize();
+  if (size > 0 && provider->getScatterGatherListSize() > 0) {
+    const uintptr_t base = provider->getBusOffsetAddress(0);
+    bool contiguous = provider->getBusOffsetAddress(size - 1) == base + size - 1;
+    for (size_t i = 0; contiguous && i < provider->getScatterGatherListSize(); ++i) {
+      const auto entryAddress = provider->getScatterGatherEntryAddress(i);
+      if (entryAddress > provider->getAddress() && entryAddress < provider->getAddress() + size) {
+        const size_t offset = entryAddress - provider->getAddress();
+        contiguous = provider->getBusOffsetAddress(offset) == base + offset;
+      }
+    }
+    mapping = BusMapping {contiguous, base};
+    log(std::string("DMA buffer ") + std::to_string(mBufferProviders.size()) + " is "
+        + (contiguous ? "contiguous" : "not contiguous") + " on the bus", InfoLogger::InfoLogger::Debug);
+  }
+  if (size > 0 && mExcludeBufferFromDump
+      && !Utilities::excludeFromDumpAndFork(reinterpret_cast<const void*>(provider->getAddress()), size)) {
+    log(std::string("Failed to exclude DMA buffer ") + std::to_string(mBufferProviders.size())
+        + " from core dumps and child processes: " + std::strerror(errno), InfoLogger::InfoLogger::Warning);
+  }
+  mBufferProviders.push_back(std::move(provider));
+  mBusMappings.push_back(mapping);
+}
+
 // Checks DMA state and forwards call to subclass if necessary
 void DmaChannelPdaBase::startDma()
 {
@@ -114,13 +224,35 @@ void DmaChannelPdaBase::startDma()
     log("Unknown DMA state");
   } else if (mDmaState == DmaState::STARTED) {
     log("DMA already started. Ignoring startDma() call");
+  } else if (mDmaState == DmaState::PREPARED) {
+    getTraceRing().record(TraceRing::Event::StartDma);
+    deviceStartPreparedDma();
   } else {
     log("Starting DMA", InfoLogger::InfoLogger::Debug);
+    getTraceRing().record(TraceRing::Event::StartDma);
     deviceStartDma();
   }
   mDmaState = DmaState::STARTED;
 }
 
+void DmaChannelPdaBase::prepareDma()
+{
+  if (mDmaState == DmaState::UNKNOWN) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Prepare DMA failed: DMA in unknown state"));
+  }
+  if (mDmaState == DmaState::STARTED) {
+    log("DMA already started. Ignoring prepareDma() call");
+    return;
+  }
+  if (mDmaState == DmaState::PREPARED) {
+    return;
+  }
+
+  log("Preparing DMA", InfoLogger::InfoLogger::Debug);
+  devicePrepareDma();
+  mDmaState = DmaState::PREPARED;
+}
+
 // Checks DMA state and forwards call to subclass if necessary
 void DmaChannelPdaBase::stopDma()
 {
@@ -130,11 +262,38 @@ void DmaChannelPdaBase::stopDma()
     log("Warning: DMA already stopped. Ignoring stopDma() call");
   } else {
     log("Stopping DMA", InfoLogger::InfoLogger::Debug);
+    getTraceRing().record(TraceRing::Event::StopDma);
     deviceStopDma();
   }
   mDmaState = DmaState::STOPPED;
 }
 
+void DmaChannelPdaBase::recover()
+{
+  if (mDmaState != DmaState::STARTED) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Recover failed: DMA was not started"));
+  }
+
+  log("Recovering DMA", InfoLogger::InfoLogger::Warning);
+  getTraceRing().record(TraceRing::Event::Recover);
+  deviceRecover();
+  getStatisticsCounters().recovered();
+}
+
+uint16_t DmaChannelPdaBase::startNextRun()
+{
+  if (mDmaState != DmaState::STARTED) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Starting next run failed: DMA was not started"));
+  }
+
+  // The superpages given back belong to the current run, those pushed after this to the next
+  deviceStartNextRun();
+  auto epoch = advanceRunEpoch();
+  log("Started run epoch " + std::to_string(epoch), InfoLogger::InfoLogger::Debug);
+  getTraceRing().record(TraceRing::Event::NextRun, 0, epoch);
+  return epoch;
+}
+
 void DmaChannelPdaBase::resetChannel(ResetLevel::type resetLevel)
 {
   if (mDmaState == DmaState::UNKNOWN) {
@@ -145,26 +304,31 @@ void DmaChannelPdaBase::resetChannel(ResetLevel::type resetLevel)
   }
 
   log("Resetting channel", InfoLogger::InfoLogger::Debug);
+  getTraceRing().record(TraceRing::Event::Reset, 0, resetLevel);
   deviceResetChannel(resetLevel);
 }
 
-uintptr_t DmaChannelPdaBase::getBusOffsetAddress(size_t offset)
-{
-  return getBufferProvider().getBusOffsetAddress(offset);
-}
-
 void DmaChannelPdaBase::checkSuperpage(const Superpage& superpage)
 {
   if (superpage.getSize() == 0) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not enqueue superpage, size == 0"));
   }
 
-  if (!Utilities::isMultiple(superpage.getSize(), size_t(32*1024))) {
+  if (!Utilities::isMultiple(superpage.getSize(), mSuperpageSizeMultiple)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not enqueue superpage, size not a multiple of "
+        + std::to_string(mSuperpageSizeMultiple / 1024) + " KiB"));
+  }
+
+  if (superpage.getBufferId() >= mBufferProviders.size()) {
     BOOST_THROW_EXCEPTION(Exception()
-        << ErrorInfo::Message("Could not enqueue superpage, size not a multiple of 32 KiB"));
+        << ErrorInfo::Message("Could not enqueue superpage, unknown buffer ID " + std::to_string(superpage.getBufferId())));
   }
 
-  if ((superpage.getOffset() + superpage.getSize()) > getBufferProvider().getSize()) {
+  auto usableSize = getBufferProvider(superpage.getBufferId()).getSize();
+  if (superpage.getBufferId() == 0) {
+    usableSize -= mReservedBufferTail;
+  }
+  if ((superpage.getOffset() + superpage.getSize()) > usableSize) {
     BOOST_THROW_EXCEPTION(Exception()
         << ErrorInfo::Message("Superpage out of range"));
   }
@@ -175,6 +339,63 @@ void DmaChannelPdaBase::checkSuperpage(const Superpage& superpage)
   }
 }
 
+size_t DmaChannelPdaBase::reserveBufferTail(size_t size)
+{
+  constexpr size_t ALIGNMENT = 4 * 1024;
+  const auto reserved = mReservedBufferTail + ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+  const auto bufferSize = getBufferProvider().getSize();
+  if (reserved > bufferSize || !Utilities::isMultiple(bufferSize, ALIGNMENT)) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Could not reserve end of DMA buffer, buffer too small or not a multiple of 4 KiB")
+        << ErrorInfo::DmaBufferSize(bufferSize));
+  }
+  mReservedBufferTail = reserved;
+  return bufferSize - reserved;
+}
+
+bool DmaChannelPdaBase::checkInterrupt()
+{
+  if (!mInterrupt) {
+    return true;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (mInterrupt->acknowledge() || ((now - mLastArrivalCheck) > INTERRUPT_FALLBACK_INTERVAL)) {
+    mLastArrivalCheck = now;
+    return true;
+  }
+  return false;
+}
+
+bool DmaChannelPdaBase::waitForReadySuperpage(std::chrono::nanoseconds timeout)
+{
+  if (!mInterrupt) {
+    return DmaChannelBase::waitForReadySuperpage(timeout);
+  }
+
+  // Sleep on the interrupt instead of polling the card
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    fillSuperpages();
+    if (getReadyQueueSize() > 0) {
+      return true;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(end - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      return false;
+    }
+    auto sleep = std::min(remaining, std::chrono::nanoseconds(INTERRUPT_FALLBACK_INTERVAL));
+    timespec time { 0, long(sleep.count()) };
+    pollfd descriptor { mInterrupt->getFileDescriptor(), POLLIN, 0 };
+    ppoll(&descriptor, 1, &time, nullptr);
+  }
+}
+
+int DmaChannelPdaBase::getReadyFileDescriptor()
+{
+  return mInterrupt ? mInterrupt->getFileDescriptor() : -1;
+}
+
 PciAddress DmaChannelPdaBase::getPciAddress()
 {
   return getCardDescriptor().pciAddress;
@@ -6,11 +6,15 @@
 #ifndef ALICEO2_SRC_READOUTCARD_DMACHANNELPDABASE_H_
 #define ALICEO2_SRC_READOUTCARD_DMACHANNELPDABASE_H_
 
+#include <chrono>
+#include <memory>
+#include <vector>
 #include <boost/scoped_ptr.hpp>
 #include "DmaBufferProvider/DmaBufferProviderInterface.h"
 #include "DmaChannelBase.h"
 #include "Pda/PdaBar.h"
 #include "Pda/PdaDmaBuffer.h"
+#include "Pda/PdaInterrupt.h"
 #include "ReadoutCard/DmaChannelInterface.h"
 #include "ReadoutCard/Exception.h"
 #include "ReadoutCard/MemoryMappedFile.h"
@@ -35,10 +39,16 @@ class DmaChannelPdaBase: public DmaChannelBase
     ~DmaChannelPdaBase();
 
     virtual void startDma() final override;
+    virtual void prepareDma() final override;
     virtual void stopDma() final override;
+    virtual void recover() final override;
+    virtual uint16_t startNextRun() final override;
     void resetChannel(ResetLevel::type resetLevel) final override;
     virtual PciAddress getPciAddress() final override;
     virtual int getNumaNode() final override;
+    virtual bool waitForReadySuperpage(std::chrono::nanoseconds timeout) override;
+    virtual int getReadyFileDescriptor() final override;
+    virtual int addBuffer(const buffer_parameters::Memory& buffer) final override;
 
   protected:
 
@@ -73,7 +83,7 @@ class DmaChannelPdaBase: public DmaChannelBase
         /// The state of the DMA
         enum type
         {
-          UNKNOWN = 0, STOPPED = 1, STARTED = 2
+          UNKNOWN = 0, STOPPED = 1, STARTED = 2, PREPARED = 3
         };
     };
 
@@ -83,18 +93,80 @@ class DmaChannelPdaBase: public DmaChannelBase
     /// Template method called by startDma() to do device-specific (CRORC, RCU...) actions
     virtual void deviceStartDma() = 0;
 
+    /// Template method called by prepareDma() to do device-specific (CRORC, RCU...) actions
+    virtual void devicePrepareDma() = 0;
+
+    /// Template method called by startDma() after prepareDma() to do device-specific (CRORC, RCU...) actions
+    virtual void deviceStartPreparedDma() = 0;
+
     /// Template method called by stopDma() to do device-specific (CRORC, RCU...) actions
     virtual void deviceStopDma() = 0;
 
+    /// Template method called by recover() to do device-specific (CRORC, RCU...) actions. Called with DMA started,
+    /// and must leave it started.
+    virtual void deviceRecover() = 0;
+
+    /// Template method called by startNextRun() to do device-specific (CRORC, RCU...) actions. Called with DMA started,
+    /// and must give back the superpages on the card and leave the DMA started for the next run.
+    virtual void deviceStartNextRun() = 0;
+
     /// Template method called by resetChannel() to do device-specific (CRORC, RCU...) actions
     virtual void deviceResetChannel(ResetLevel::type resetLevel) = 0;
 
+    /// Checks if the card should be checked for arrived superpages. Without interrupts enabled, this is always the case.
+    /// With interrupts enabled, it's only the case if an interrupt was received (this also acknowledges it), or if the
+    /// fallback interval expired, in case the card missed or coalesced an interrupt.
+    bool checkInterrupt();
+
     /// Function for getting the bus address that corresponds to the user address + given offset
-    uintptr_t getBusOffsetAddress(size_t offset);
+    /// \param bufferId ID of the buffer, see addBuffer()
+    /// \param offset Offset in the buffer
+    uintptr_t getBusOffsetAddress(int bufferId, size_t offset)
+    {
+      // The offsets of superpages are checked by checkSuperpage(), so the contiguous case needs no lookup
+      const auto& mapping = mBusMappings[bufferId];
+      if (mapping.contiguous) {
+        return mapping.base + offset;
+      }
+      return getBufferProvider(bufferId).getBusOffsetAddress(offset);
+    }
+
+    /// Gets the userspace address of a superpage
+    uintptr_t getUserspaceAddress(const Superpage& superpage) const
+    {
+      return getBufferProvider(superpage.getBufferId()).getAddress() + superpage.getOffset();
+    }
+
+    /// Reserves the end of the channel's buffer for the driver's own use, such as a FIFO the card writes into.
+    /// checkSuperpage() then rejects superpages that overlap it.
+    /// \param size Size to reserve, rounded up to a multiple of 4 KiB so the region lies within one page
+    /// \return Offset of the reserved region in the buffer
+    size_t reserveBufferTail(size_t size);
+
+    /// Sets the size superpages must be a multiple of, which checkSuperpage() checks. The default is 32 KiB.
+    void setSuperpageSizeMultiple(size_t multiple)
+    {
+      mSuperpageSizeMultiple = multiple;
+    }
+
+    /// Enables interrupt-driven arrival notification, for backends that decide on it after the InterruptEnabled
+    /// parameter was handled, such as from the capabilities of the firmware
+    void enableInterrupts();
+
+    bool isInterruptEnabled() const
+    {
+      return mInterrupt != nullptr;
+    }
 
     const DmaBufferProviderInterface& getBufferProvider() const
     {
-      return *(mBufferProvider.get());
+      return *(mBufferProviders.front().get());
+    }
+
+    /// Gets the provider of a buffer. The ID is checked by checkSuperpage().
+    const DmaBufferProviderInterface& getBufferProvider(int bufferId) const
+    {
+      return *(mBufferProviders[bufferId].get());
     }
 
     const RocPciDevice& getRocPciDevice() const
@@ -103,14 +175,55 @@ class DmaChannelPdaBase: public DmaChannelBase
     }
 
   private:
-    /// Contains addresses & size of the buffer
-    std::unique_ptr<DmaBufferProviderInterface> mBufferProvider;
+    /// Interval after which arrivals are checked even if no interrupt was received
+    static constexpr std::chrono::milliseconds INTERRUPT_FALLBACK_INTERVAL { 1 };
+
+    /// Makes the provider of a buffer in memory
+    std::unique_ptr<DmaBufferProviderInterface> makeBufferProvider(const buffer_parameters::Memory& buffer,
+        int bufferId);
+
+    /// Bus address range of a buffer
+    struct BusMapping
+    {
+        /// Whether the buffer is contiguous on the bus, as with the IOMMU enabled, or with a single scatter-gather
+        /// entry. Its bus addresses are then the base plus the offset.
+        bool contiguous;
+        uintptr_t base;
+    };
+
+    /// Adds the provider of a buffer, and finds out if the buffer is contiguous on the bus
+    void addBufferProvider(std::unique_ptr<DmaBufferProviderInterface> provider);
+
+    /// Contains addresses & size of the buffers, indexed by buffer ID. The buffer of the parameters is the first.
+    /// Its capacity is reserved up front, so adding a buffer does not move the others while a driver thread uses them.
+    std::vector<std::unique_ptr<DmaBufferProviderInterface>> mBufferProviders;
+
+    /// Bus mappings of the buffers, indexed by buffer ID, reserved like mBufferProviders
+    std::vector<BusMapping> mBusMappings;
+
+    /// Size at the end of the channel's buffer reserved by reserveBufferTail()
+    size_t mReservedBufferTail = 0;
+
+    /// Size superpages must be a multiple of
+    size_t mSuperpageSizeMultiple = 32 * 1024;
+
+    /// Keep the registrations of buffers in memory, see Parameters::setBufferRegistrationRetained()
+    bool mRetainRegistration;
+
+    /// Exclude buffers from core dumps and child processes, see Parameters::setBufferDumpExcluded()
+    bool mExcludeBufferFromDump;
 
     /// Current state of the DMA
     DmaState::type mDmaState;
 
     /// PDA device objects
     boost::scoped_ptr<RocPciDevice> mRocPciDevice;
+
+    /// Interrupt of the card, if interrupts are enabled
+    std::unique_ptr<Pda::PdaInterrupt> mInterrupt;
+
+    /// Last time checkInterrupt() allowed an arrivals check
+    std::chrono::steady_clock::time_point mLastArrivalCheck;
 };
 
 } // namespace roc
@@ -0,0 +1,628 @@
+/// \file DriverThreadDmaChannel.cxx
+/// \brief Implementation of the DriverThreadDmaChannel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "DriverThreadDmaChannel.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <future>
+#include <sstream>
+#include "ExceptionInternal.h"
+#include "ReadoutCard/CacheAllocation.h"
+#include "Utilities/Affinity.h"
+#include "Utilities/Futex.h"
+#include "Utilities/Numa.h"
+#include "Utilities/Wait.h"
+
+namespace AliceO2 {
+namespace roc {
+
+DriverThreadDmaChannel::DriverThreadDmaChannel(std::shared_ptr<DmaChannelInterface> channel,
+    const Parameters& parameters)
+    : mChannel(std::move(channel)), mCpu(parameters.getDriverThreadCpu()),
+      mCacheGroup(parameters.getDriverThreadCacheGroup()),
+      mEventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      mWaitSpinTime(parameters.getWaitSpinTime().get_value_or(std::chrono::microseconds(20)))
+{
+  if (mEventFd < 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not create eventfd for driver thread"));
+  }
+}
+
+DriverThreadDmaChannel::~DriverThreadDmaChannel()
+{
+  stopThread();
+  close(mEventFd);
+}
+
+void DriverThreadDmaChannel::startDma()
+{
+  if (mRunning) {
+    return;
+  }
+
+  mChannel->startDma();
+
+  // The channel's transfer queue capacity is only known once DMA is started
+  auto capacity = mChannel->getTransferQueueAvailable();
+  mTransferQueue = std::make_unique<folly::ProducerConsumerQueue<Transfer>>(capacity + 1);
+  mTransferQueueAvailable = capacity;
+  mTransferQueueCapacity = capacity;
+  startThread();
+}
+
+void DriverThreadDmaChannel::startThread()
+{
+  mStopFlag = false;
+  mThreadFailed = false;
+  mThreadException = nullptr;
+  // Only the thread itself can move into a resctrl group, since that takes its thread ID
+  std::promise<void> joined;
+  auto joinedFuture = joined.get_future();
+  mThread = std::thread([&, joined = std::move(joined)]() mutable {
+    try {
+      if (mCacheGroup) {
+        CacheAllocation::joinGroup(*mCacheGroup);
+      }
+      joined.set_value();
+    } catch (...) {
+      joined.set_exception(std::current_exception());
+    }
+    driverLoop();
+  });
+  mRunning = true;
+  setThreadAffinity();
+  try {
+    joinedFuture.get();
+  }
+  catch (const Exception& e) {
+    mLogger << InfoLogger::InfoLogger::Warning << "Could not move driver thread into cache allocation group: "
+        << boost::diagnostic_information(e) << InfoLogger::InfoLogger::endm;
+  }
+}
+
+void DriverThreadDmaChannel::prepareDma()
+{
+  if (mRunning) {
+    return;
+  }
+  mChannel->prepareDma();
+}
+
+void DriverThreadDmaChannel::stopDma()
+{
+  if (!mRunning) {
+    mChannel->stopDma();
+    return;
+  }
+
+  stopThread();
+
+  // Superpages that did not make it to the channel yet are pushed now, so the channel's stopDma() will return them
+  // to the ready queue. This always fits, since the user can't push more than the channel's transfer queue capacity,
+  // though superpages for a link that is full go to any link.
+  if (!mThreadFailed) {
+    Transfer transfer;
+    while (mTransferQueue->read(transfer)) {
+      if (!giveToChannel(transfer)) {
+        mChannel->pushSuperpage(transfer.superpage);
+      }
+    }
+  }
+
+  mChannel->stopDma();
+  checkDriverThread();
+}
+
+void DriverThreadDmaChannel::recover()
+{
+  if (!mRunning) {
+    mChannel->recover();
+    return;
+  }
+
+  // The superpages still in the transfer queue stay there, and are given to the channel once the thread runs again.
+  // Those the channel gives back go through the ready queue as usual, which keeps the transfer queue count right.
+  stopThread();
+  try {
+    mChannel->recover();
+  }
+  catch (...) {
+    startThread();
+    throw;
+  }
+  startThread();
+}
+
+uint16_t DriverThreadDmaChannel::startNextRun()
+{
+  if (!mRunning) {
+    return mChannel->startNextRun();
+  }
+
+  // An exception of the driver thread is for recover(), not for the next run
+  checkDriverThread();
+  stopThread();
+  uint16_t epoch;
+  try {
+    epoch = mChannel->startNextRun();
+  }
+  catch (...) {
+    startThread();
+    throw;
+  }
+  startThread();
+  return epoch;
+}
+
+uint16_t DriverThreadDmaChannel::getRunEpoch()
+{
+  return mChannel->getRunEpoch();
+}
+
+void DriverThreadDmaChannel::enableLink(uint32_t linkId)
+{
+  changeLink([&]{ mChannel->enableLink(linkId); });
+}
+
+void DriverThreadDmaChannel::disableLink(uint32_t linkId)
+{
+  changeLink([&]{ mChannel->disableLink(linkId); });
+}
+
+void DriverThreadDmaChannel::changeLink(const std::function<void()>& change)
+{
+  if (!mRunning) {
+    change();
+    return;
+  }
+
+  stopThread();
+  const auto available = mChannel->getTransferQueueAvailable();
+  const auto ready = mChannel->getReadyQueueSize();
+  try {
+    change();
+  }
+  catch (...) {
+    startThread();
+    throw;
+  }
+
+  // The superpages the channel moved to its ready queue are counted as available when they are handed back, so only
+  // the change of the capacity is counted now. After a disable, the count may go below zero until they are.
+  const auto capacityChange = (mChannel->getTransferQueueAvailable() - available)
+      - (mChannel->getReadyQueueSize() - ready);
+  mTransferQueueAvailable.fetch_add(capacityChange);
+  mTransferQueueCapacity += capacityChange;
+  if (capacityChange > 0) {
+    // The driver thread is stopped, so the superpages waiting in the transfer queue can move to a larger one
+    auto queue = std::make_unique<folly::ProducerConsumerQueue<Transfer>>(mTransferQueueCapacity + 1);
+    Transfer transfer;
+    while (mTransferQueue->read(transfer)) {
+      queue->write(transfer);
+    }
+    mTransferQueue = std::move(queue);
+  }
+  startThread();
+}
+
+void DriverThreadDmaChannel::resetChannel(ResetLevel::type resetLevel)
+{
+  mChannel->resetChannel(resetLevel);
+}
+
+void DriverThreadDmaChannel::stopThread()
+{
+  if (!mRunning) {
+    return;
+  }
+
+  mStopFlag = true;
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+  mRunning = false;
+}
+
+void DriverThreadDmaChannel::setThreadAffinity()
+{
+  try {
+    if (mCpu) {
+      Utilities::setThreadAffinity(mThread, {*mCpu});
+    } else {
+      Utilities::setThreadAffinity(mThread, Utilities::getLocalCpus(mChannel->getPciAddress()));
+    }
+  }
+  catch (const Exception& e) {
+    mLogger << InfoLogger::InfoLogger::Warning << "Could not set driver thread affinity: "
+        << boost::diagnostic_information(e) << InfoLogger::InfoLogger::endm;
+  }
+}
+
+void DriverThreadDmaChannel::driverLoop()
+{
+  try {
+    while (!mStopFlag.load(std::memory_order_relaxed)) {
+      bool idle = true;
+
+      // Give the superpages pushed by the user to the channel
+      while (mChannel->getTransferQueueAvailable() > 0) {
+        auto transfer = mTransferQueue->frontPtr();
+        if (transfer == nullptr || !giveToChannel(*transfer)) {
+          break;
+        }
+        mTransferQueue->popFront();
+        idle = false;
+      }
+
+      mChannel->fillSuperpages();
+
+      // Hand arrived superpages back to the user
+      bool handed = false;
+      while (mChannel->getReadyQueueSize() > 0 && !mReadyQueue.isFull()) {
+        auto superpage = mChannel->popSuperpage();
+        mReadyQueue.write(superpage);
+        // A split off part is followed by the rest of its superpage, which frees the slot
+        if (!superpage.isSplit()) {
+          mTransferQueueAvailable.fetch_add(1, std::memory_order_release);
+        }
+        handed = true;
+      }
+
+      if (handed) {
+        idle = false;
+        mReadySequence.fetch_add(1);
+        if (mWaiting.load()) {
+          Utilities::futexWakeAll(mReadySequence);
+        }
+        uint64_t one = 1;
+        if (write(mEventFd, &one, sizeof(one)) < 0) {
+          // Only fails if the counter would overflow, in which case it's signalled anyway
+        }
+      }
+
+      if (idle) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  catch (...) {
+    std::ostringstream trace;
+    mChannel->dumpTrace(trace);
+    mLogger << InfoLogger::InfoLogger::Error << "Driver thread stopped by exception, trace of the channel:\n"
+        << trace.str() << InfoLogger::InfoLogger::endm;
+    mThreadException = std::current_exception();
+    mThreadFailed.store(true, std::memory_order_release);
+  }
+}
+
+void DriverThreadDmaChannel::checkDriverThread()
+{
+  if (mThreadFailed.load(std::memory_order_acquire)) {
+    // The exception is rethrown to whichever side checks first
+    std::exception_ptr exception;
+    {
+      std::lock_guard<std::mutex> lock(mThreadExceptionMutex);
+      std::swap(exception, mThreadException);
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+}
+
+void DriverThreadDmaChannel::pushSuperpage(Superpage superpage)
+{
+  if (!mRunning) {
+    mChannel->pushSuperpage(superpage);
+    return;
+  }
+
+  if (!tryPushSuperpage(superpage)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpage, transfer queue was full"));
+  }
+}
+
+bool DriverThreadDmaChannel::tryPushSuperpage(const Superpage& superpage)
+{
+  if (!mRunning) {
+    return mChannel->tryPushSuperpage(superpage);
+  }
+
+  checkDriverThread();
+  // Checked here, on the caller's thread, so an invalid superpage throws to the caller instead of stopping the driver
+  // thread. Superpages the channel checked before are skipped, like giveToChannel() does.
+  if (!superpage.isChecked()) {
+    mChannel->validateSuperpage(superpage, boost::none);
+  }
+  return enqueue(superpage, -1);
+}
+
+bool DriverThreadDmaChannel::tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId)
+{
+  if (!mRunning) {
+    return mChannel->tryPushSuperpageToLink(superpage, linkId);
+  }
+
+  checkDriverThread();
+  mChannel->validateSuperpage(superpage, linkId);
+  return enqueue(superpage, linkId);
+}
+
+bool DriverThreadDmaChannel::enqueue(const Superpage& superpage, int64_t linkId)
+{
+  if (mTransferQueueAvailable.load(std::memory_order_acquire) <= 0
+      || !mTransferQueue->write(Transfer{superpage, linkId})) {
+    return false;
+  }
+  mTransferQueueAvailable.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+void DriverThreadDmaChannel::validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId)
+{
+  // Only reads the channel's configuration, so this is safe from any thread
+  mChannel->validateSuperpage(superpage, linkId);
+}
+
+void DriverThreadDmaChannel::releaseSuperpage(Superpage superpage)
+{
+  if (!mRunning) {
+    mChannel->releaseSuperpage(superpage);
+    return;
+  }
+
+  superpage.setReady(false);
+  superpage.setReceived(0);
+  if (!tryPushSuperpage(superpage)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not release superpage, transfer queue was full"));
+  }
+}
+
+bool DriverThreadDmaChannel::giveToChannel(const Transfer& transfer)
+{
+  if (transfer.linkId >= 0) {
+    return mChannel->tryPushSuperpageToLink(transfer.superpage, transfer.linkId);
+  }
+  // Superpages the channel checked before can skip its checks
+  if (transfer.superpage.isChecked()) {
+    mChannel->releaseSuperpage(transfer.superpage);
+  } else {
+    mChannel->pushSuperpage(transfer.superpage);
+  }
+  return true;
+}
+
+void DriverThreadDmaChannel::pushSuperpages(const Superpage* superpages, size_t count)
+{
+  if (!mRunning) {
+    mChannel->pushSuperpages(superpages, count);
+    return;
+  }
+
+  checkDriverThread();
+  // All or nothing: everything is checked before the first superpage is queued. Only this thread takes slots, so
+  // the driver thread can only free more of them in the meantime.
+  for (size_t i = 0; i < count; ++i) {
+    if (!superpages[i].isChecked()) {
+      mChannel->validateSuperpage(superpages[i], boost::none);
+    }
+  }
+  if (count > size_t(mTransferQueueAvailable.load(std::memory_order_acquire))) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpages, not enough transfer queue slots")
+        << ErrorInfo::SuperpageCount(count));
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (!enqueue(superpages[i], -1)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpage, transfer queue was full"));
+    }
+  }
+}
+
+auto DriverThreadDmaChannel::getSuperpage() -> Superpage
+{
+  checkDriverThread();
+  if (auto superpage = mReadyQueue.frontPtr()) {
+    return *superpage;
+  }
+  if (!mRunning) {
+    return mChannel->getSuperpage();
+  }
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not get superpage, ready queue was empty"));
+}
+
+bool DriverThreadDmaChannel::tryPopSuperpage(Superpage& superpage)
+{
+  checkDriverThread();
+  if (mReadyQueue.read(superpage)) {
+    return true;
+  }
+  return !mRunning && mChannel->tryPopSuperpage(superpage);
+}
+
+auto DriverThreadDmaChannel::popSuperpage() -> Superpage
+{
+  checkDriverThread();
+  Superpage superpage;
+  if (mReadyQueue.read(superpage)) {
+    return superpage;
+  }
+  if (!mRunning) {
+    return mChannel->popSuperpage();
+  }
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not pop superpage, ready queue was empty"));
+}
+
+size_t DriverThreadDmaChannel::popSuperpages(Superpage* superpages, size_t max)
+{
+  checkDriverThread();
+  size_t count = 0;
+  while (count < max && mReadyQueue.read(superpages[count])) {
+    count++;
+  }
+  if (!mRunning && count < max) {
+    count += mChannel->popSuperpages(superpages + count, max - count);
+  }
+  return count;
+}
+
+size_t DriverThreadDmaChannel::getPartialSuperpages(Superpage* superpages, size_t max)
+{
+  checkDriverThread();
+  if (mRunning) {
+    return 0;
+  }
+  return mChannel->getPartialSuperpages(superpages, max);
+}
+
+void DriverThreadDmaChannel::fillSuperpages()
+{
+  if (!mRunning) {
+    mChannel->fillSuperpages();
+    return;
+  }
+
+  // The driver thread takes care of business, we only need to clear the eventfd and report its failure
+  uint64_t count;
+  if (read(mEventFd, &count, sizeof(count)) < 0) {
+    // Nothing was signalled
+  }
+  checkDriverThread();
+}
+
+bool DriverThreadDmaChannel::waitForReadySuperpage(std::chrono::nanoseconds timeout)
+{
+  if (!mRunning) {
+    return mChannel->waitForReadySuperpage(timeout);
+  }
+
+  auto isReady = [&]{
+    checkDriverThread();
+    return !mReadyQueue.isEmpty();
+  };
+
+  // Spin for a while, the driver thread is probably about to deliver
+  const auto start = std::chrono::steady_clock::now();
+  if (Utilities::spinThenSleep(isReady, std::min(timeout, mWaitSpinTime), mWaitSpinTime)) {
+    return true;
+  }
+
+  // Then sleep until the driver thread wakes us up. The sequence number is read before checking the queue, so if the
+  // driver thread delivers in between, the futex wait returns immediately.
+  const auto end = start + timeout;
+  while (true) {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= end) {
+      return isReady();
+    }
+    auto sequence = mReadySequence.load();
+    mWaiting.store(true);
+    if (isReady()) {
+      mWaiting.store(false);
+      return true;
+    }
+    Utilities::futexWait(mReadySequence, sequence, end - now);
+    mWaiting.store(false);
+    if (isReady()) {
+      return true;
+    }
+  }
+}
+
+int DriverThreadDmaChannel::getReadyFileDescriptor()
+{
+  return mEventFd;
+}
+
+int DriverThreadDmaChannel::addBuffer(const buffer_parameters::Memory& buffer)
+{
+  // The buffer is only used by the driver thread once a superpage in it is pushed, which happens after this returns
+  return mChannel->addBuffer(buffer);
+}
+
+int DriverThreadDmaChannel::getTransferQueueAvailable()
+{
+  if (!mRunning) {
+    return mChannel->getTransferQueueAvailable();
+  }
+  return mTransferQueueAvailable.load(std::memory_order_acquire);
+}
+
+int DriverThreadDmaChannel::getReadyQueueSize()
+{
+  int size = mReadyQueue.sizeGuess();
+  if (!mRunning) {
+    size += mChannel->getReadyQueueSize();
+  }
+  return size;
+}
+
+CardType::type DriverThreadDmaChannel::getCardType()
+{
+  return mChannel->getCardType();
+}
+
+void DriverThreadDmaChannel::setLogLevel(InfoLogger::InfoLogger::Severity severity)
+{
+  mChannel->setLogLevel(severity);
+}
+
+PciAddress DriverThreadDmaChannel::getPciAddress()
+{
+  return mChannel->getPciAddress();
+}
+
+int DriverThreadDmaChannel::getNumaNode()
+{
+  return mChannel->getNumaNode();
+}
+
+size_t DriverThreadDmaChannel::getDmaPageSize()
+{
+  return mChannel->getDmaPageSize();
+}
+
+bool DriverThreadDmaChannel::injectError()
+{
+  return mChannel->injectError();
+}
+
+boost::optional<int32_t> DriverThreadDmaChannel::getSerial()
+{
+  return mChannel->getSerial();
+}
+
+boost::optional<float> DriverThreadDmaChannel::getTemperature()
+{
+  return mChannel->getTemperature();
+}
+
+boost::optional<std::string> DriverThreadDmaChannel::getFirmwareInfo()
+{
+  return mChannel->getFirmwareInfo();
+}
+
+boost::optional<std::string> DriverThreadDmaChannel::getCardId()
+{
+  return mChannel->getCardId();
+}
+
+BarStatistics DriverThreadDmaChannel::getBarStatistics()
+{
+  return mChannel->getBarStatistics();
+}
+
+ChannelStatistics DriverThreadDmaChannel::getStatistics()
+{
+  // The driver thread drives the wrapped channel, so its counters are accurate and safe to read from here
+  return mChannel->getStatistics();
+}
+
+void DriverThreadDmaChannel::dumpTrace(std::ostream& stream)
+{
+  mChannel->dumpTrace(stream);
+}
+
+} // namespace roc
+} // namespace AliceO2
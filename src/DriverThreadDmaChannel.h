@@ -0,0 +1,187 @@
+/// \file DriverThreadDmaChannel.h
+/// \brief Definition of the DriverThreadDmaChannel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_DRIVERTHREADDMACHANNEL_H_
+#define ALICEO2_SRC_READOUTCARD_DRIVERTHREADDMACHANNEL_H_
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <InfoLogger/InfoLogger.hxx>
+#include "folly/ProducerConsumerQueue.h"
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/Parameters.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Wraps a DmaChannelInterface implementation and runs its fillSuperpages() on an internal driver thread while DMA
+/// is started. The user pushes and pops superpages as usual, but these are passed to and from the driver thread
+/// through single-producer single-consumer lock-free queues, and fillSuperpages() no longer needs to be called.
+/// While DMA is stopped, all calls are forwarded directly to the wrapped channel.
+///
+/// The user side of this class is meant to be used from a single thread.
+class DriverThreadDmaChannel final : public DmaChannelInterface
+{
+  public:
+    /// \param channel The channel to drive
+    /// \param parameters Parameters of the channel, used for DriverThreadCpu and DriverThreadCacheGroup
+    DriverThreadDmaChannel(std::shared_ptr<DmaChannelInterface> channel, const Parameters& parameters);
+    virtual ~DriverThreadDmaChannel() override;
+
+    virtual void startDma() override;
+    virtual void prepareDma() override;
+    virtual void stopDma() override;
+    /// Also clears an exception that stopped the driver thread, so the channel can be recovered from it
+    virtual void recover() override;
+    /// The driver thread is stopped for the transition, as for recover(). Superpages still waiting in the transfer
+    /// queue are given to the card after it, so they carry the epoch of the next run.
+    virtual uint16_t startNextRun() override;
+    virtual uint16_t getRunEpoch() override;
+    virtual void resetChannel(ResetLevel::type resetLevel) override;
+
+    virtual void pushSuperpage(Superpage superpage) override;
+    virtual bool tryPushSuperpage(const Superpage& superpage) override;
+    /// While the driver thread runs, this only returns false if the transfer queue is full. The superpage waits in it
+    /// until the link has room.
+    virtual bool tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId) override;
+    virtual void pushSuperpages(const Superpage* superpages, size_t count) override;
+    virtual void validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId) override;
+    virtual void releaseSuperpage(Superpage superpage) override;
+    virtual Superpage getSuperpage() override;
+    virtual Superpage popSuperpage() override;
+    virtual bool tryPopSuperpage(Superpage& superpage) override;
+    virtual size_t popSuperpages(Superpage* superpages, size_t max) override;
+    /// While DMA is started, the wrapped channel belongs to the driver thread, so no partial superpages are given
+    virtual size_t getPartialSuperpages(Superpage* superpages, size_t max) override;
+    virtual void fillSuperpages() override;
+    virtual bool waitForReadySuperpage(std::chrono::nanoseconds timeout) override;
+    virtual int getReadyFileDescriptor() override;
+    virtual int addBuffer(const buffer_parameters::Memory& buffer) override;
+    /// While DMA is started, the driver thread is stopped for the change, as for recover()
+    virtual void enableLink(uint32_t linkId) override;
+    /// While DMA is started, the driver thread is stopped for the change, as for recover()
+    virtual void disableLink(uint32_t linkId) override;
+    virtual int getTransferQueueAvailable() override;
+    virtual int getReadyQueueSize() override;
+
+    virtual CardType::type getCardType() override;
+    virtual void setLogLevel(InfoLogger::InfoLogger::Severity severity) override;
+    virtual PciAddress getPciAddress() override;
+    virtual int getNumaNode() override;
+    virtual size_t getDmaPageSize() override;
+    virtual bool injectError() override;
+    virtual boost::optional<int32_t> getSerial() override;
+    virtual boost::optional<float> getTemperature() override;
+    virtual boost::optional<std::string> getFirmwareInfo() override;
+    virtual boost::optional<std::string> getCardId() override;
+    virtual BarStatistics getBarStatistics() override;
+    virtual ChannelStatistics getStatistics() override;
+    virtual void dumpTrace(std::ostream& stream) override;
+
+  private:
+    using Queue = folly::ProducerConsumerQueue<Superpage>;
+
+    /// A superpage pushed by the user
+    struct Transfer
+    {
+        Superpage superpage;
+        /// Link given to tryPushSuperpageToLink(), or -1 to let the channel pick
+        int64_t linkId;
+    };
+
+    /// Capacity of the queue that passes arrived superpages to the user.
+    /// If it is full, the driver thread leaves the superpages in the wrapped channel's ready queue.
+    static constexpr size_t READY_QUEUE_CAPACITY = 1024;
+
+    /// Body of the driver thread
+    void driverLoop();
+
+    /// Starts the driver thread
+    void startThread();
+
+    /// Stops and joins the driver thread
+    void stopThread();
+
+    /// Gives a superpage of the transfer queue to the wrapped channel, released if the channel checked it before
+    /// \return False if the superpage was for a link whose queue is full
+    bool giveToChannel(const Transfer& transfer);
+
+    /// Puts a superpage in the transfer queue
+    bool enqueue(const Superpage& superpage, int64_t linkId);
+
+    /// Pins the driver thread to the configured CPU, or to the CPUs local to the card
+    void setThreadAffinity();
+
+    /// Rethrows an exception that occurred on the driver thread, if any
+    void checkDriverThread();
+
+    /// Enables or disables a link of the channel, and follows the change of its transfer queue capacity
+    void changeLink(const std::function<void()>& change);
+
+    /// The channel being driven
+    std::shared_ptr<DmaChannelInterface> mChannel;
+
+    /// CPU to pin the driver thread to
+    boost::optional<int32_t> mCpu;
+
+    /// resctrl group to move the driver thread into
+    boost::optional<std::string> mCacheGroup;
+
+    /// Superpages pushed by the user, waiting to be pushed into the channel by the driver thread
+    std::unique_ptr<folly::ProducerConsumerQueue<Transfer>> mTransferQueue;
+
+    /// Transfer queue capacity of the channel, which mTransferQueue has room for
+    int mTransferQueueCapacity = 0;
+
+    /// Superpages that arrived, waiting to be popped by the user
+    Queue mReadyQueue { READY_QUEUE_CAPACITY + 1 };
+
+    /// Amount of superpages the user can still push. The user decrements it, the driver thread increments it when a
+    /// superpage is handed back through the ready queue.
+    std::atomic<int> mTransferQueueAvailable { 0 };
+
+    /// Incremented by the driver thread when it hands superpages to the ready queue. Used as futex word by
+    /// waitForReadySuperpage().
+    std::atomic<uint32_t> mReadySequence { 0 };
+
+    /// True while the user is sleeping in waitForReadySuperpage(), so the driver thread knows it has to wake it
+    std::atomic<bool> mWaiting { false };
+
+    /// Eventfd signalled by the driver thread when it hands superpages to the ready queue, cleared by fillSuperpages()
+    int mEventFd;
+
+    /// Time waitForReadySuperpage() busy-polls before sleeping
+    const std::chrono::nanoseconds mWaitSpinTime;
+
+    /// Flag to tell the driver thread to stop
+    std::atomic<bool> mStopFlag { false };
+
+    /// Set by the driver thread when it stopped because of an exception
+    std::atomic<bool> mThreadFailed { false };
+
+    /// Exception that stopped the driver thread
+    std::exception_ptr mThreadException;
+
+    /// Guards taking mThreadException, since the push and pop sides may be used from different threads
+    std::mutex mThreadExceptionMutex;
+
+    /// The driver thread
+    std::thread mThread;
+
+    /// True while the driver thread is running
+    bool mRunning = false;
+
+    /// InfoLogger instance
+    InfoLogger::InfoLogger mLogger;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DRIVERTHREADDMACHANNEL_H_
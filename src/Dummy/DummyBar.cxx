@@ -5,6 +5,7 @@
 
 #include "DummyBar.h"
 #include <iostream>
+#include "Utilities/Wait.h"
 
 // using std::cout;
 
@@ -12,6 +13,8 @@ namespace AliceO2 {
 namespace roc {
 
 DummyBar::DummyBar(const Parameters& parameters)
+    : mReadLatency(parameters.getDummyBarReadLatency().get_value_or(std::chrono::nanoseconds(0))),
+      mWriteLatency(parameters.getDummyBarWriteLatency().get_value_or(std::chrono::nanoseconds(0)))
 {
   mBarIndex = parameters.getChannelNumberRequired();
   auto id = parameters.getCardIdRequired();
@@ -35,12 +38,51 @@ DummyBar::~DummyBar()
 uint32_t DummyBar::readRegister(int index)
 {
 //  cout << "DummyBar::readRegister(" << index << ")\n";
-  return 0;
+  uint32_t value;
+  readRegisters(index, &value, 1);
+  return value;
 }
 
 void DummyBar::writeRegister(int index, uint32_t value)
 {
 //  cout << "DummyBar::writeRegister(index:" << index << ", value:" << value << ")\n";
+  writeRegisters(index, &value, 1);
+}
+
+void DummyBar::readRegisters(int startIndex, uint32_t* values, size_t count)
+{
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = mModel.read(startIndex + i);
+    }
+  }
+  waitLatency(start, mReadLatency);
+}
+
+void DummyBar::writeRegisters(int startIndex, const uint32_t* values, size_t count)
+{
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < count; ++i) {
+      mModel.write(startIndex + i, values[i]);
+    }
+  }
+  waitLatency(start, mWriteLatency);
+}
+
+void DummyBar::waitLatency(std::chrono::steady_clock::time_point start, std::chrono::nanoseconds latency)
+{
+  if (latency.count() == 0) {
+    return;
+  }
+  // Latencies are around a microsecond, too short to sleep
+  const auto end = start + latency;
+  while (std::chrono::steady_clock::now() < end) {
+    Utilities::cpuRelax();
+  }
 }
 
 } // namespace roc
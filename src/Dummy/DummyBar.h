@@ -7,7 +7,11 @@
 #define ALICEO2_SRC_READOUTCARD_DUMMY_DUMMYBAR_H_
 
 #include "ReadoutCard/BarInterface.h"
+#include "ReadoutCard/Parameters.h"
+#include "Dummy/DummyRegisterModel.h"
 #include <array>
+#include <chrono>
+#include <mutex>
 
 namespace AliceO2 {
 namespace roc {
@@ -15,8 +19,9 @@ namespace roc {
 /// A dummy implementation of the BarInterface.
 /// This exists so that the ReadoutCard module may be built even if the all the dependencies of the 'real' card
 /// implementation are not met (this mainly concerns the PDA driver library).
-/// In the future, a dummy implementation could be a simulated card. Currently, methods of this implementation do
-/// nothing besides print which method was called. Returned values are static and should not be used.
+/// The registers are a DummyRegisterModel, which emulates the SCA and SWT cores. With the DummyBarReadLatency and
+/// DummyBarWriteLatency parameters, every access (or block of accesses) takes the given time, so control software can
+/// be benchmarked without a card. The accesses of different threads overlap, like on a real BAR.
 class DummyBar : public BarInterface
 {
   public:
@@ -25,6 +30,8 @@ class DummyBar : public BarInterface
     virtual ~DummyBar();
     virtual uint32_t readRegister(int index) override;
     virtual void writeRegister(int index, uint32_t value) override;
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count) override;
+    virtual void writeRegisters(int startIndex, const uint32_t* values, size_t count) override;
 
     virtual int getIndex() const override
     {
@@ -85,9 +92,21 @@ class DummyBar : public BarInterface
     {
       return 0;
     }
+
+    virtual BarStatistics getBarStatistics() override
+    {
+      return {};
+    }
   
   private:
+    /// Busy-waits for the rest of the latency of an access that started at the given time
+    static void waitLatency(std::chrono::steady_clock::time_point start, std::chrono::nanoseconds latency);
+
     int mBarIndex;
+    std::chrono::nanoseconds mReadLatency;
+    std::chrono::nanoseconds mWriteLatency;
+    std::mutex mMutex;
+    DummyRegisterModel mModel;
 };
 
 } // namespace roc
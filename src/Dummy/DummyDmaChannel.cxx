@@ -4,9 +4,16 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "DummyDmaChannel.h"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <random>
+#include <boost/filesystem.hpp>
+#include "Cru/Constants.h"
+#include "Cru/DataFormat.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/DataPattern.h"
+#include "Utilities/Timestamp.h"
 #include "Visitor.h"
 
 namespace AliceO2 {
@@ -19,6 +26,14 @@ CardDescriptor makeDummyDescriptor()
 
 constexpr size_t TRANSFER_QUEUE_SIZE = 16;
 constexpr size_t READY_QUEUE_SIZE = 32;
+/// Queue depth of a simulated link, as in the CRU firmware
+constexpr size_t LINK_QUEUE_SIZE = Cru::MAX_SUPERPAGE_DESCRIPTORS;
+/// Longest time the simulation thread sleeps when it waits for room in the ready queue
+constexpr auto SIMULATION_IDLE_WAIT = std::chrono::milliseconds(1);
+/// Smallest page the simulated generator writes: the RDH and one 256-bit word
+constexpr size_t MIN_GENERATOR_DATA_SIZE = 0x40 + 32;
+/// Packets the simulated generator writes per heartbeat orbit of a link
+constexpr uint32_t PACKETS_PER_ORBIT = 8;
 }
 
 constexpr auto endm = InfoLogger::InfoLogger::StreamOps::endm;
@@ -33,29 +48,431 @@ DummyDmaChannel::DummyDmaChannel(const Parameters& params)
   if (auto bufferParameters = params.getBufferParameters()) {
     // Create appropriate BufferProvider subclass
     Visitor::apply(*bufferParameters,
-        [&](buffer_parameters::Memory parameters){ mBufferSize = parameters.size; },
+        [&](buffer_parameters::Memory parameters){
+          mBufferSize = parameters.size;
+          mBufferAddress = static_cast<char*>(parameters.address);
+        },
         [&](buffer_parameters::File parameters){ mBufferSize = parameters.size; },
+        [&](buffer_parameters::FileDescriptor parameters){ mBufferSize = parameters.size; },
         [&](buffer_parameters::Null){ mBufferSize = 0; });
   } else {
     BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("DmaChannel requires buffer_parameters"));
   }
+
+  if (auto replayFile = params.getReplayFile()) {
+    namespace bip = boost::interprocess;
+    if (!mBufferAddress) {
+      BOOST_THROW_EXCEPTION(ParameterException()
+          << ErrorInfo::Message("Replaying a file requires memory buffer parameters"));
+    }
+    if (!boost::filesystem::exists(*replayFile) || boost::filesystem::file_size(*replayFile) == 0) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Replay file does not exist or is empty")
+          << ErrorInfo::Filename(*replayFile));
+    }
+    mReplayFileMapping = std::make_unique<bip::file_mapping>(replayFile->c_str(), bip::read_only);
+    mReplayRegion = std::make_unique<bip::mapped_region>(*mReplayFileMapping, bip::read_only);
+    mReplayRegion->advise(bip::mapped_region::advice_sequential);
+    getLogger() << "Replaying file " << *replayFile << " of " << mReplayRegion->get_size() << " bytes"
+        << InfoLogger::InfoLogger::endm;
+  }
+
+  mReplayRate = params.getReplayRate();
+  if (mReplayRate && *mReplayRate == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Replay rate must be greater than 0"));
+  }
+
+  if (auto bandwidth = params.getDummyLinkBandwidth()) {
+    if (*bandwidth == 0) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Link bandwidth must be greater than 0"));
+    }
+    if (!mBufferAddress) {
+      BOOST_THROW_EXCEPTION(ParameterException()
+          << ErrorInfo::Message("Simulating a card requires memory buffer parameters"));
+    }
+    mLinkBandwidth = *bandwidth;
+    mDmaPageSize = params.getDmaPageSize().get_value_or(8 * 1024);
+    if (mDmaPageSize <= Cru::DataFormat::getHeaderSize() || mDmaPageSize > 0xffff) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("DMA page size out of range for simulation")
+          << ErrorInfo::DmaPageSize(mDmaPageSize));
+    }
+    mGeneratorEnabled = params.getGeneratorEnabled().get_value_or(true);
+    mGeneratorDataSize = std::min(params.getGeneratorDataSize().get_value_or(mDmaPageSize), mDmaPageSize);
+    mGeneratorRandomSize = params.getGeneratorRandomSizeEnabled().get_value_or(false);
+    mPackedPackets = params.getPackedPacketsEnabled().get_value_or(false);
+    if (mPackedPackets && 2 * mDmaPageSize > 0xffff) {
+      // The offset of the last packet of a superpage covers up to two packets
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("DMA page size out of range for packed packets")
+          << ErrorInfo::DmaPageSize(mDmaPageSize));
+    }
+    if (mGeneratorDataSize < MIN_GENERATOR_DATA_SIZE) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Generator data size too small for simulation")
+          << ErrorInfo::GeneratorEventLength(mGeneratorDataSize));
+    }
+    for (auto id : params.getLinkMask().value_or(Parameters::LinkMaskType{0})) {
+      if (id >= uint32_t(Cru::MAX_LINKS)) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Link ID out of range")
+            << ErrorInfo::LinkId(id));
+      }
+      mLinks.emplace_back(id, LINK_QUEUE_SIZE);
+    }
+    if (mReplayRegion) {
+      indexReplayPackets();
+    }
+    mTransferQueue.set_capacity(0);
+    mReadyQueue.set_capacity(LINK_QUEUE_SIZE * mLinks.size());
+    getLogger() << "Simulating " << mLinks.size() << " links of " << mLinkBandwidth << " bytes/s"
+        << InfoLogger::InfoLogger::endm;
+  }
 }
 
 DummyDmaChannel::~DummyDmaChannel()
 {
+  stopSimulation();
   getLogger() << "DummyDmaChannel::~DummyDmaChannel()" << InfoLogger::InfoLogger::endm;
 }
 
 void DummyDmaChannel::startDma()
 {
   getLogger() << "DummyDmaChannel::startDma()" << InfoLogger::InfoLogger::endm;
+  stopSimulation();
+
+  std::lock_guard<std::mutex> lock(mMutex);
   mTransferQueue.clear();
   mReadyQueue.clear();
+  mStartTime = std::chrono::steady_clock::now();
+  mBytesCompleted = 0;
+
+  if (isSimulated()) {
+    for (auto& link : mLinks) {
+      link.queue.clear();
+      link.frontCompletion = boost::none;
+      link.frontWritten = false;
+      link.lastCompletion = mStartTime;
+      link.packetCounter = 0;
+      link.dataCounter = 0;
+      link.replayNext = 0;
+    }
+    startSimulation();
+  }
+}
+
+void DummyDmaChannel::recover()
+{
+  getLogger() << InfoLogger::InfoLogger::Warning << "DummyDmaChannel::recover()" << InfoLogger::InfoLogger::endm;
+  reclaimSuperpages("Could not recover", [&]{ getStatisticsCounters().recovered(); });
+}
+
+uint16_t DummyDmaChannel::startNextRun()
+{
+  getLogger() << "DummyDmaChannel::startNextRun()" << InfoLogger::InfoLogger::endm;
+  uint16_t epoch = 0;
+  reclaimSuperpages("Could not start the next run", [&]{
+    // The next run starts from fresh counters, as after startDma()
+    mStartTime = std::chrono::steady_clock::now();
+    mBytesCompleted = 0;
+    for (auto& link : mLinks) {
+      link.packetCounter = 0;
+      link.dataCounter = 0;
+      link.replayNext = 0;
+    }
+    epoch = advanceRunEpoch();
+  });
+  getTraceRing().record(TraceRing::Event::NextRun, 0, epoch);
+  return epoch;
+}
+
+void DummyDmaChannel::reclaimSuperpages(const std::string& action, const std::function<void()>& stopped)
+{
+  const bool simulating = mSimulationThread.joinable();
+  stopSimulation();
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  size_t given = mTransferQueue.size();
+  for (const auto& link : mLinks) {
+    given += link.queue.size();
+  }
+  if (given > mReadyQueue.capacity() - mReadyQueue.size()) {
+    if (simulating) {
+      startSimulation();
+    }
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(action
+        + ", the ready queue has no room for the superpages given to the card. Pop superpages first."));
+  }
+
+  // Only the superpage a link is transferring received data, the others are given back empty
+  auto reclaim = [&](Queue& queue, size_t frontReceived) {
+    for (auto& superpage : queue) {
+      superpage.setReceived(frontReceived);
+      superpage.setReady(true);
+      superpage.setTimestamp(Utilities::getTimestampCounter());
+      mReadyQueue.push_back(superpage);
+      frontReceived = 0;
+    }
+    queue.clear();
+  };
+  reclaim(mTransferQueue, 0);
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& link : mLinks) {
+    reclaim(link.queue, getFrontReceived(link, now));
+    link.frontCompletion = boost::none;
+    link.frontWritten = false;
+    link.lastCompletion = now;
+  }
+  stopped();
+
+  if (simulating) {
+    startSimulation();
+  }
 }
 
 void DummyDmaChannel::stopDma()
 {
   getLogger() << "DummyDmaChannel::stopDma()" << InfoLogger::InfoLogger::endm;
+  stopSimulation();
+}
+
+void DummyDmaChannel::startSimulation()
+{
+  mSimulationStop = false;
+  mSimulationThread = std::thread([&]{ simulate(); });
+}
+
+void DummyDmaChannel::stopSimulation()
+{
+  if (mSimulationThread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mSimulationStop = true;
+    }
+    mCondition.notify_all();
+    mSimulationThread.join();
+  }
+}
+
+void DummyDmaChannel::simulate()
+{
+  std::vector<std::pair<Superpage, Link*>> started;
+  std::vector<Superpage> completed;
+  std::unique_lock<std::mutex> lock(mMutex);
+  // At most one transfer per link starts and a ready queue's worth completes per round, so these never allocate again
+  started.reserve(mLinks.size());
+  completed.reserve(mReadyQueue.capacity());
+
+  while (!mSimulationStop) {
+    const auto now = std::chrono::steady_clock::now();
+    auto wakeUp = now + SIMULATION_IDLE_WAIT;
+    size_t readyAvailable = mReadyQueue.capacity() - mReadyQueue.size();
+
+    for (auto& link : mLinks) {
+      while (!link.queue.empty()) {
+        if (!link.frontCompletion) {
+          // The transfer starts when the previous one completed, or now if the link was idle
+          auto transferTime = std::chrono::duration<double>(double(link.queue.front().getSize()) / mLinkBandwidth);
+          link.frontStart = std::max(now, link.lastCompletion);
+          link.frontCompletion = link.frontStart
+              + std::chrono::duration_cast<std::chrono::steady_clock::duration>(transferTime);
+        }
+        if (!link.frontWritten) {
+          // The data is written when the transfer starts, so that the received part can be read before it completes
+          started.emplace_back(link.queue.front(), &link);
+          break;
+        }
+        if (*link.frontCompletion > now) {
+          wakeUp = std::min(wakeUp, *link.frontCompletion);
+          break;
+        }
+        if (readyAvailable == 0) {
+          // Back-pressure, the link stalls until there's room in the ready queue
+          break;
+        }
+        readyAvailable--;
+        link.lastCompletion = *link.frontCompletion;
+        link.frontCompletion = boost::none;
+        link.frontWritten = false;
+        completed.push_back(link.queue.front());
+        link.queue.pop_front();
+      }
+    }
+
+    if (!started.empty() || !completed.empty()) {
+      // Write the data without holding the lock. Only this thread takes superpages from the links and pushes to the
+      // ready queue, so the started superpages stay at the front and the room taken for the completed ones stays
+      // available.
+      lock.unlock();
+      for (auto& superpage : started) {
+        writeSimulated(superpage.first, *superpage.second);
+      }
+      for (auto& superpage : completed) {
+        superpage.setReady(true);
+        superpage.setTimestamp(Utilities::getTimestampCounter());
+        superpage.setReceived(superpage.getSize());
+      }
+      lock.lock();
+      for (const auto& superpage : started) {
+        superpage.second->frontWritten = true;
+      }
+      for (const auto& superpage : completed) {
+        mReadyQueue.push_back(superpage);
+      }
+      started.clear();
+      completed.clear();
+      continue;
+    }
+
+    mCondition.wait_until(lock, wakeUp);
+  }
+}
+
+void DummyDmaChannel::writeSimulated(const Superpage& superpage, Link& link)
+{
+  if (mReplayRegion) {
+    replayLink(superpage, link);
+  } else if (mGeneratorEnabled) {
+    generate(superpage, link);
+  }
+}
+
+size_t DummyDmaChannel::getFrontReceived(const Link& link, TimePoint now) const
+{
+  if (link.queue.empty() || !link.frontWritten || now <= link.frontStart) {
+    return 0;
+  }
+  const size_t size = link.queue.front().getSize();
+  if (now >= *link.frontCompletion) {
+    return size;
+  }
+  // The pages arrive evenly over the transfer
+  const double fraction = std::chrono::duration<double>(now - link.frontStart).count()
+      / std::chrono::duration<double>(*link.frontCompletion - link.frontStart).count();
+  return std::min(size, size_t(fraction * double(size / mDmaPageSize)) * mDmaPageSize);
+}
+
+size_t DummyDmaChannel::getPartialSuperpages(Superpage* superpages, size_t max)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  const auto now = std::chrono::steady_clock::now();
+  size_t count = 0;
+  for (const auto& link : mLinks) {
+    if (count == max) {
+      break;
+    }
+    if (auto received = getFrontReceived(link, now)) {
+      superpages[count] = link.queue.front();
+      superpages[count].setReceived(received);
+      count++;
+    }
+  }
+  return count;
+}
+
+template <class NextSize, class Write>
+void DummyDmaChannel::layOutPackets(const Superpage& superpage, NextSize nextSize, Write write)
+{
+  const auto address = mBufferAddress + superpage.getOffset();
+
+  if (!mPackedPackets) {
+    const size_t pages = superpage.getSize() / mDmaPageSize;
+    for (size_t i = 0; i < pages; ++i) {
+      write(address + i * mDmaPageSize, nextSize(), mDmaPageSize);
+    }
+    return;
+  }
+
+  // Every packet starts at a 256-bit word. The last one's offset covers the rest of the superpage.
+  size_t offset = 0;
+  size_t size = nextSize();
+  while (offset + size <= superpage.getSize()) {
+    const size_t next = offset + ((size + 31) / 32) * 32;
+    const size_t nextPacketSize = nextSize();
+    const bool last = (next + nextPacketSize > superpage.getSize());
+    write(address + offset, size, last ? superpage.getSize() - offset : next - offset);
+    offset = next;
+    size = nextPacketSize;
+  }
+}
+
+void DummyDmaChannel::generate(const Superpage& superpage, Link& link)
+{
+  // Random sizes are whole 256-bit words, like the CRU's generator
+  std::uniform_int_distribution<size_t> randomSize(MIN_GENERATOR_DATA_SIZE / 32, mGeneratorDataSize / 32);
+  layOutPackets(superpage,
+      [&]{ return mGeneratorRandomSize ? randomSize(mRandom) * 32 : mGeneratorDataSize; },
+      [&](char* packet, size_t size, size_t offsetNext) {
+        generatePacket(reinterpret_cast<uint32_t*>(packet), size, offsetNext, link);
+      });
+}
+
+void DummyDmaChannel::replayLink(const Superpage& superpage, Link& link)
+{
+  auto file = static_cast<const char*>(mReplayRegion->get_address());
+  const auto& packets = link.replayPackets;
+  // The layout looks one packet ahead of the one it writes
+  size_t peek = link.replayNext;
+  layOutPackets(superpage,
+      [&]{
+        auto size = packets[peek].size;
+        peek = (peek + 1) % packets.size();
+        return size;
+      },
+      [&](char* packet, size_t size, size_t offsetNext) {
+        std::memcpy(packet, file + packets[link.replayNext].offset, size);
+        auto word = reinterpret_cast<uint32_t*>(packet) + 2;
+        *word = (*word & 0xffff0000) | uint32_t(offsetNext);
+        link.replayNext = (link.replayNext + 1) % packets.size();
+      });
+}
+
+void DummyDmaChannel::indexReplayPackets()
+{
+  auto file = static_cast<const char*>(mReplayRegion->get_address());
+  const size_t fileSize = mReplayRegion->get_size();
+  size_t offset = 0;
+  while (offset + Cru::DataFormat::getHeaderSize() <= fileSize) {
+    auto packet = file + offset;
+    const size_t size = Cru::DataFormat::getEventSize(packet);
+    const size_t offsetNext = Cru::DataFormat::getOffsetNextPacket(packet);
+    if (size < Cru::DataFormat::getHeaderSize() || size > mDmaPageSize || offsetNext < size
+        || (offset + size) > fileSize) {
+      BOOST_THROW_EXCEPTION(ParameterException()
+          << ErrorInfo::Message("Replay file is not a stream of RDH packets that fit the DMA pages")
+          << ErrorInfo::Offset(offset)
+          << ErrorInfo::DmaPageSize(mDmaPageSize));
+    }
+    const uint32_t id = Cru::DataFormat::getLinkId(packet);
+    auto link = std::find_if(mLinks.begin(), mLinks.end(), [&](const Link& l) { return l.id == id; });
+    if (link != mLinks.end()) {
+      link->replayPackets.push_back({offset, size});
+    }
+    offset += offsetNext;
+  }
+
+  for (const auto& link : mLinks) {
+    if (link.replayPackets.empty()) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Replay file has no packets of the link")
+          << ErrorInfo::LinkId(link.id));
+    }
+  }
+}
+
+void DummyDmaChannel::generatePacket(uint32_t* packet, size_t size, size_t offsetNext, Link& link)
+{
+  const size_t headerWords = Cru::DataFormat::getHeaderSize() / sizeof(uint32_t);
+  const size_t payloadWords = (size - Cru::DataFormat::getHeaderSize()) / sizeof(uint32_t);
+  std::fill_n(packet, headerWords, 0);
+  packet[2] = (uint32_t(size) << 16) | uint32_t(offsetNext); // Memory size, offset to next packet
+  packet[3] = ((link.packetCounter & 0xff) << 8) | link.id; // Packet counter, link ID
+  packet[4] = link.packets / PACKETS_PER_ORBIT; // Trigger orbit
+  packet[5] = link.packets / PACKETS_PER_ORBIT; // Heartbeat orbit
+
+  auto pattern = DataPattern::makeCruDdg(link.dataCounter);
+  auto payload = packet + headerWords;
+  for (size_t j = 0; j < payloadWords; ++j) {
+    payload[j] = pattern.getExpected(j);
+  }
+
+  link.packetCounter = (link.packetCounter + 1) & 0xff;
+  link.packets++;
+  link.dataCounter += (payloadWords + 3) / 4;
 }
 
 void DummyDmaChannel::resetChannel(ResetLevel::type resetLevel)
@@ -66,16 +483,30 @@ void DummyDmaChannel::resetChannel(ResetLevel::type resetLevel)
 
 CardType::type DummyDmaChannel::getCardType()
 {
-  return CardType::Dummy;
+  return isSimulated() ? CardType::Simulated : CardType::Dummy;
 }
 
 int DummyDmaChannel::getTransferQueueAvailable()
 {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return getTransferQueueAvailableLocked();
+}
+
+int DummyDmaChannel::getTransferQueueAvailableLocked() const
+{
+  if (isSimulated()) {
+    size_t available = 0;
+    for (const auto& link : mLinks) {
+      available += link.queue.capacity() - link.queue.size();
+    }
+    return available;
+  }
   return mTransferQueue.capacity() - mTransferQueue.size();
 }
 
 int DummyDmaChannel::getReadyQueueSize()
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   return mReadyQueue.size();
 }
 
@@ -86,10 +517,23 @@ boost::optional<std::string> DummyDmaChannel::getFirmwareInfo()
 
 void DummyDmaChannel::pushSuperpage(Superpage superpage)
 {
-  if (getTransferQueueAvailable() == 0) {
+  if (!tryPushSuperpage(superpage)) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpage, transfer queue was full"));
   }
+}
+
+bool DummyDmaChannel::tryPushSuperpage(const Superpage& superpage)
+{
+  return tryPush(superpage, boost::none);
+}
+
+bool DummyDmaChannel::tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId)
+{
+  return tryPush(superpage, linkId);
+}
 
+void DummyDmaChannel::validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId)
+{
   if (superpage.getSize() == 0) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not enqueue superpage, size == 0"));
   }
@@ -109,39 +553,133 @@ void DummyDmaChannel::pushSuperpage(Superpage superpage)
                             << ErrorInfo::Message("Superpage offset not 32-bit aligned"));
   }
 
+  // The links are fixed at construction, so this needs no lock
+  if (isSimulated() && linkId
+      && std::none_of(mLinks.begin(), mLinks.end(), [&](const Link& l) { return l.id == *linkId; })) {
+    BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("Link not enabled in channel")
+        << ErrorInfo::LinkId(*linkId));
+  }
+}
+
+bool DummyDmaChannel::tryPush(const Superpage& pushed, boost::optional<uint32_t> linkId)
+{
+  validateSuperpage(pushed, linkId);
+  auto superpage = pushed;
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  if (getTransferQueueAvailableLocked() == 0) {
+    return false;
+  }
+
+  superpage.setPushTimestamp(Utilities::getTimestampCounter());
+  superpage.setRunEpoch(getRunEpoch());
+  if (isSimulated()) {
+    auto link = mLinks.begin();
+    if (linkId) {
+      link = std::find_if(mLinks.begin(), mLinks.end(), [&](const Link& l) { return l.id == *linkId; });
+      if (link->queue.full()) {
+        return false;
+      }
+    } else {
+      // Like the CRU's shortest queue scheduling, the superpage goes to the link with the most room
+      link = std::max_element(mLinks.begin(), mLinks.end(), [](const Link& a, const Link& b) {
+        return a.queue.reserve() < b.queue.reserve();
+      });
+    }
+    superpage.setLinkId(link->id);
+    link->queue.push_back(superpage);
+    lock.unlock();
+    mCondition.notify_all();
+    return true;
+  }
+
+  if (linkId) {
+    superpage.setLinkId(*linkId);
+  }
   mTransferQueue.push_back(superpage);
+  return true;
 }
 
 Superpage DummyDmaChannel::getSuperpage()
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   return mReadyQueue.front();
 }
 
 Superpage DummyDmaChannel::popSuperpage()
 {
-  if (mReadyQueue.empty()) {
+  Superpage superpage;
+  if (!tryPopSuperpage(superpage)) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not pop superpage, ready queue was empty"));
   }
+  return superpage;
+}
 
-  auto superpage = mReadyQueue.front();
+bool DummyDmaChannel::tryPopSuperpage(Superpage& superpage)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  if (mReadyQueue.empty()) {
+    return false;
+  }
+
+  superpage = mReadyQueue.front();
   mReadyQueue.pop_front();
-  return superpage;
+  if (isSimulated()) {
+    // A link may be waiting for room in the ready queue
+    lock.unlock();
+    mCondition.notify_all();
+  }
+  return true;
 }
 
 void DummyDmaChannel::fillSuperpages()
 {
+  if (isSimulated()) {
+    // The simulation thread completes the superpages
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
   size_t pushQueueSize = mTransferQueue.size();
   for (size_t i = 0; i < pushQueueSize; ++i) {
-    if (mReadyQueue.full()) {
+    if (mReadyQueue.full() || !isRateAllowing(mTransferQueue.front().getSize())) {
       break;
     }
+    if (mReplayRegion) {
+      replay(mTransferQueue.front());
+    }
+    mBytesCompleted += mTransferQueue.front().getSize();
     mTransferQueue.front().setReady(true);
+    mTransferQueue.front().setTimestamp(Utilities::getTimestampCounter());
     mTransferQueue.front().setReceived(mTransferQueue.front().getSize());
     mReadyQueue.push_back(mTransferQueue.front());
     mTransferQueue.pop_front();
   }
 }
 
+bool DummyDmaChannel::isRateAllowing(size_t size) const
+{
+  if (!mReplayRate) {
+    return true;
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+  return double(mBytesCompleted + size) <= (seconds * double(*mReplayRate));
+}
+
+void DummyDmaChannel::replay(const Superpage& superpage)
+{
+  auto file = static_cast<const char*>(mReplayRegion->get_address());
+  auto fileSize = mReplayRegion->get_size();
+  auto destination = mBufferAddress + superpage.getOffset();
+  size_t copied = 0;
+  while (copied < superpage.getSize()) {
+    auto size = std::min(superpage.getSize() - copied, fileSize - mReplayOffset);
+    std::memcpy(destination + copied, file + mReplayOffset, size);
+    copied += size;
+    mReplayOffset = (mReplayOffset + size) % fileSize;
+  }
+}
+
 boost::optional<int32_t> DummyDmaChannel::getSerial()
 {
   return ChannelFactory::getDummySerialNumber();
@@ -167,5 +705,11 @@ int DummyDmaChannel::getNumaNode()
   return 0;
 }
 
+size_t DummyDmaChannel::getDmaPageSize()
+{
+  // Only a simulated card fills pages
+  return isSimulated() ? mDmaPageSize : 8 * 1024;
+}
+
 } // namespace roc
 } // namespace AliceO2
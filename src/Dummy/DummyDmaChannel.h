@@ -7,10 +7,22 @@
 #define ALICEO2_SRC_READOUTCARD_DUMMY_DUMMYDMACHANNEL_H_
 
 #include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/optional.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/circular_buffer_fwd.hpp>
 #include <boost/circular_buffer.hpp>
 #include "DmaChannelBase.h"
+#include "Utilities/AlignedAllocator.h"
 
 namespace AliceO2 {
 namespace roc {
@@ -19,6 +31,21 @@ namespace roc {
 /// This exists so that the ReadoutCard module may be built even if the all the dependencies of the 'real' card
 /// implementation are not met (this mainly concerns the PDA driver library).
 /// It provides some basic simulation of page pushing and output.
+/// With the ReplayFile parameter, it fills the superpages with the data of a recorded file, and with the ReplayRate
+/// parameter, it completes them at the given rate instead of as fast as possible. This allows testing the readout
+/// of realistic data at a realistic throughput without a card.
+///
+/// With the DummyLinkBandwidth parameter, it simulates a card and reports CardType::Simulated: every link of the link
+/// mask has a queue with the depth of the CRU's firmware queues, and a background thread completes the superpages of
+/// every link at the given bandwidth. A link whose superpage can't go to the full ready queue stalls, like the card
+/// does. The data of a superpage is written when its transfer starts, and its pages count as received evenly over the
+/// transfer, which getPartialSuperpages() and the superpages given back by recover() follow.
+/// The pages are filled with an RDH and the CRU's DDG pattern, unless the generator is disabled. The generator writes
+/// GeneratorDataSize bytes per page, or a random amount up to it with GeneratorRandomSizeEnabled. With
+/// PackedPacketsEnabled, the packets follow each other through the superpage instead of starting a page each. The RDH
+/// orbits advance every few packets, so time frame boundaries fall within superpages.
+/// With a ReplayFile, which must then be a stream of RDH packets such as a recording of a CRU, every link replays the
+/// packets the file has of the same link ID instead, laid out in the pages like the generated ones.
 class DummyDmaChannel final : public DmaChannelBase
 {
   public:
@@ -27,9 +54,14 @@ class DummyDmaChannel final : public DmaChannelBase
     virtual ~DummyDmaChannel();
 
     virtual void pushSuperpage(Superpage) override;
+    virtual bool tryPushSuperpage(const Superpage& superpage) override;
+    virtual bool tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId) override;
+    virtual void validateSuperpage(const Superpage& superpage, boost::optional<uint32_t> linkId) override;
     virtual Superpage getSuperpage() override;
     virtual Superpage popSuperpage() override;
+    virtual bool tryPopSuperpage(Superpage& superpage) override;
     virtual void fillSuperpages() override;
+    virtual size_t getPartialSuperpages(Superpage* superpages, size_t max) override;
     virtual bool injectError() override
     {
       return false;
@@ -41,17 +73,178 @@ class DummyDmaChannel final : public DmaChannelBase
     virtual int getReadyQueueSize() override;
     virtual void resetChannel(ResetLevel::type resetLevel) override;
     virtual void startDma() override;
+    /// Nothing to prepare, starting the simulation is cheap
+    virtual void prepareDma() override
+    {
+    }
     virtual void stopDma() override;
+    virtual void recover() override;
+    virtual uint16_t startNextRun() override;
     virtual CardType::type getCardType() override;
     virtual PciAddress getPciAddress() override;
     virtual int getNumaNode() override;
+    virtual size_t getDmaPageSize() override;
 
   private:
-    using Queue = boost::circular_buffer<Superpage>;
+    using Queue = boost::circular_buffer<Superpage, Utilities::CacheAlignedAllocator<Superpage>>;
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    /// Checks and pushes a superpage
+    /// \param linkId Link to push to, or boost::none to pick the link with the most room
+    bool tryPush(const Superpage& superpage, boost::optional<uint32_t> linkId);
+
+    /// A packet of the replay file
+    struct ReplayPacket
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    /// A link of the simulated card
+    struct Link
+    {
+        Link(uint32_t id, size_t capacity) : id(id), queue(capacity)
+        {
+        }
+
+        uint32_t id;
+        /// Superpages pushed to the link
+        Queue queue;
+        /// Completion time of the superpage at the front of the queue, once its transfer started
+        boost::optional<TimePoint> frontCompletion;
+        /// Start time of the transfer of the superpage at the front of the queue
+        TimePoint frontStart;
+        /// Whether the data of the superpage at the front of the queue was written
+        bool frontWritten = false;
+        /// Completion time of the previous superpage
+        TimePoint lastCompletion;
+        /// Packet counter of the next DMA page
+        uint32_t packetCounter = 0;
+        /// DDG counter of the next DMA page
+        uint32_t dataCounter = 0;
+        /// Packets generated so far, which give the orbit of the next one
+        uint64_t packets = 0;
+        /// Packets of the replay file with the link's ID
+        std::vector<ReplayPacket> replayPackets;
+        /// Index of the next replayed packet
+        size_t replayNext = 0;
+    };
+
+    /// Returns true if the channel simulates a card
+    bool isSimulated() const
+    {
+      return !mLinks.empty();
+    }
+
+    int getTransferQueueAvailableLocked() const;
+
+    /// Function of the simulation thread
+    void simulate();
+
+    /// Starts the simulation thread. Called with mMutex held.
+    void startSimulation();
+
+    /// Gives the superpages of the transfer queue and of the links back through the ready queue, with the simulation
+    /// stopped meanwhile
+    /// \param action What needs them back, for the message if the ready queue has no room for them
+    /// \param stopped Called after the superpages were given back, with the simulation stopped and mMutex held
+    void reclaimSuperpages(const std::string& action, const std::function<void()>& stopped);
+
+    /// Stops the simulation thread if it runs
+    void stopSimulation();
+
+    /// Writes the data of a superpage whose transfer the simulation started
+    void writeSimulated(const Superpage& superpage, Link& link);
+
+    /// Gets the amount of bytes the superpage at the front of a link received so far. Called with mMutex held.
+    size_t getFrontReceived(const Link& link, TimePoint now) const;
+
+    /// Lays out the packets of a superpage: one per DMA page, or packed back to back
+    /// \param nextSize Gives the memory size of the next packet
+    /// \param write Writes a packet, given its address, memory size and offset to the next packet
+    template <class NextSize, class Write>
+    void layOutPackets(const Superpage& superpage, NextSize nextSize, Write write);
+
+    /// Fills the DMA pages of the superpage with an RDH and the DDG pattern
+    void generate(const Superpage& superpage, Link& link);
+
+    /// Fills the DMA pages of the superpage with the next packets of the link in the replay file
+    void replayLink(const Superpage& superpage, Link& link);
+
+    /// Splits the replay file into the packets of the simulated links
+    void indexReplayPackets();
+
+    /// Writes a packet of the DDG pattern, and advances the link's counters
+    /// \param size Memory size of the packet, the RDH and payload
+    /// \param offsetNext Offset to the next packet
+    void generatePacket(uint32_t* packet, size_t size, size_t offsetNext, Link& link);
+
+    /// Checks if the rate limit allows completing another superpage of the given size
+    bool isRateAllowing(size_t size) const;
+
+    /// Copies the next part of the replay file into the superpage, starting over at the end of the file
+    void replay(const Superpage& superpage);
 
     Queue mTransferQueue;
     Queue mReadyQueue;
     size_t mBufferSize;
+
+    /// Start of the buffer. Only known with memory buffer parameters.
+    char* mBufferAddress = nullptr;
+
+    /// Mapping of the file given with the ReplayFile parameter
+    std::unique_ptr<boost::interprocess::file_mapping> mReplayFileMapping;
+
+    /// Region of the replay file mapping
+    std::unique_ptr<boost::interprocess::mapped_region> mReplayRegion;
+
+    /// Offset in the replay file of the data for the next superpage
+    size_t mReplayOffset = 0;
+
+    /// Rate in bytes per second given with the ReplayRate parameter
+    boost::optional<size_t> mReplayRate;
+
+    /// Start of the DMA, for the rate limit
+    std::chrono::steady_clock::time_point mStartTime;
+
+    /// Amount of bytes completed since the start of the DMA, for the rate limit
+    uint64_t mBytesCompleted = 0;
+
+    /// Links of the simulated card. Empty if the channel does not simulate a card.
+    std::vector<Link> mLinks;
+
+    /// Bandwidth of a simulated link in bytes per second
+    size_t mLinkBandwidth = 0;
+
+    /// Size of the DMA pages the simulation writes
+    size_t mDmaPageSize = 0;
+
+    /// Whether the simulation writes the generator pattern
+    bool mGeneratorEnabled = true;
+
+    /// Bytes of RDH and payload the simulation writes per DMA page, at most the page size
+    size_t mGeneratorDataSize = 0;
+
+    /// Whether the amount of bytes per DMA page is random, up to mGeneratorDataSize
+    bool mGeneratorRandomSize = false;
+
+    /// Whether the packets are packed instead of one per DMA page
+    bool mPackedPackets = false;
+
+    /// Random sizes of the simulation. Simulation thread only.
+    std::mt19937 mRandom;
+
+    /// Guards the queues, which the simulation thread accesses as well
+    mutable std::mutex mMutex;
+
+    /// Wakes the simulation thread when superpages are pushed or popped, or when it must stop
+    std::condition_variable mCondition;
+
+    /// Tells the simulation thread to stop. Guarded by mMutex.
+    bool mSimulationStop = false;
+
+    /// Thread completing the superpages of the simulated card
+    std::thread mSimulationThread;
 };
 
 } // namespace roc
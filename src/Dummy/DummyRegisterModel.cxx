@@ -0,0 +1,97 @@
+/// \file DummyRegisterModel.cxx
+/// \brief Implementation of the DummyRegisterModel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "DummyRegisterModel.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+/// SCA registers of the dummy card, as in Sca.cxx
+namespace Sca {
+constexpr int WRITE_DATA = 0x20 / 4;
+constexpr int WRITE_COMMAND = 0x24 / 4;
+constexpr int CONTROL = 0x28 / 4;
+constexpr int READ_DATA = 0x30 / 4;
+constexpr int READ_COMMAND = 0x34 / 4;
+constexpr int READ_BUSY = 0x38 / 4;
+constexpr uint32_t CONTROL_EXECUTE = 0x4;
+constexpr uint32_t CHANNEL_BUSY = 0x40;
+} // namespace Sca
+
+/// SWT registers, as in Swt.cxx
+namespace Swt {
+constexpr int BASE_INDEX = 0x0f00000 / 4;
+constexpr int WR_WORD_L = BASE_INDEX + 0x40 / 4;
+constexpr int CMD = BASE_INDEX + 0x4c / 4;
+constexpr int RD_WORD_L = BASE_INDEX + 0x50 / 4;
+constexpr int MON = BASE_INDEX + 0x5c / 4;
+constexpr int SET_CHANNEL = BASE_INDEX + 0x60 / 4;
+constexpr int RESET_CORE = BASE_INDEX + 0x64 / 4;
+constexpr uint32_t CMD_WRITE = 0x1;
+constexpr uint32_t CMD_READ = 0x2;
+} // namespace Swt
+} // Anonymous namespace
+
+constexpr std::chrono::nanoseconds DummyRegisterModel::DEFAULT_SCA_TRANSACTION_TIME;
+
+uint32_t DummyRegisterModel::read(int index)
+{
+  switch (index) {
+    case Sca::READ_BUSY:
+      return isScaBusy() ? (uint32_t(1) << 31) : 0;
+    case Sca::READ_DATA:
+      return isScaBusy() ? at(index) : mScaReply[0];
+    case Sca::READ_COMMAND:
+      return isScaBusy() ? ((at(index) & ~uint32_t(0xff)) | Sca::CHANNEL_BUSY) : mScaReply[1];
+    case Swt::MON:
+      return mSwtFifos[at(Swt::SET_CHANNEL)].size();
+    default:
+      return at(index);
+  }
+}
+
+void DummyRegisterModel::write(int index, uint32_t value)
+{
+  switch (index) {
+    case Sca::CONTROL:
+      if (value != 0) {
+        // The previous reply stays readable while busy
+        if (!isScaBusy()) {
+          at(Sca::READ_DATA) = mScaReply[0];
+          at(Sca::READ_COMMAND) = mScaReply[1];
+        }
+        if (value == Sca::CONTROL_EXECUTE) {
+          mScaReply = {{at(Sca::WRITE_DATA), at(Sca::WRITE_COMMAND) & ~uint32_t(0xff)}};
+        }
+        mScaBusyUntil = Clock::now() + mScaTransactionTime;
+      }
+      break;
+    case Swt::CMD:
+      if (value == Swt::CMD_WRITE) {
+        mSwtFifos[at(Swt::SET_CHANNEL)].push_back({{at(Swt::WR_WORD_L), at(Swt::WR_WORD_L + 1),
+            at(Swt::WR_WORD_L + 2)}});
+      } else if (value == Swt::CMD_READ) {
+        auto& fifo = mSwtFifos[at(Swt::SET_CHANNEL)];
+        if (!fifo.empty()) {
+          for (int i = 0; i < 3; ++i) {
+            at(Swt::RD_WORD_L + i) = fifo.front()[i];
+          }
+          fifo.pop_front();
+        }
+      }
+      break;
+    case Swt::RESET_CORE:
+      if (value == 0x1) {
+        mSwtFifos.clear();
+      }
+      break;
+    default:
+      break;
+  }
+  at(index) = value;
+}
+
+} // namespace roc
+} // namespace AliceO2
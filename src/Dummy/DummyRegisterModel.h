@@ -0,0 +1,69 @@
+/// \file DummyRegisterModel.h
+/// \brief Definition of the DummyRegisterModel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_DUMMY_DUMMYREGISTERMODEL_H_
+#define ALICEO2_SRC_READOUTCARD_DUMMY_DUMMYREGISTERMODEL_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Register file of the dummy BAR. Registers keep the values written to them, except those of the SCA and SWT cores,
+/// which behave like the firmware's, so the Sca and Swt classes, ALF and register scripts can run and be benchmarked
+/// without a card:
+/// - SCA, at the registers Sca uses for the dummy card: an execute or reset on the control register makes the core
+///   busy for the transaction time. Until then, the busy flag is set and the channel-busy code is in the read command.
+///   Afterwards, the read data and command registers hold the reply: the data and command written, without error.
+/// - SWT, at the registers Swt uses: a write command queues the word on the selected GBT channel, a read command puts
+///   the oldest word of the channel in the read registers, and the monitor register holds the amount of queued words.
+///
+/// The model is not thread-safe, the dummy BAR serializes the accesses. Time is taken from the steady clock.
+class DummyRegisterModel
+{
+  public:
+    /// Time an SCA transaction takes, a few microseconds like the real SCA
+    static constexpr std::chrono::nanoseconds DEFAULT_SCA_TRANSACTION_TIME {std::chrono::microseconds(5)};
+
+    explicit DummyRegisterModel(std::chrono::nanoseconds scaTransactionTime = DEFAULT_SCA_TRANSACTION_TIME)
+        : mScaTransactionTime(scaTransactionTime)
+    {
+    }
+
+    uint32_t read(int index);
+    void write(int index, uint32_t value);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using SwtWord = std::array<uint32_t, 3>;
+
+    bool isScaBusy() const
+    {
+      return Clock::now() < mScaBusyUntil;
+    }
+
+    uint32_t& at(int index)
+    {
+      return mRegisters[index];
+    }
+
+    const std::chrono::nanoseconds mScaTransactionTime;
+    std::unordered_map<int, uint32_t> mRegisters;
+    Clock::time_point mScaBusyUntil;
+    /// Reply of the SCA transaction in progress or done, as {data, command}
+    std::array<uint32_t, 2> mScaReply {{0, 0}};
+    /// Queued words per GBT channel
+    std::map<uint32_t, std::deque<SwtWord>> mSwtFifos;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DUMMY_DUMMYREGISTERMODEL_H_
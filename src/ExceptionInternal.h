@@ -36,9 +36,11 @@ using FilesystemType = AliceO2::Common::ErrorInfo::FilesystemType;
 DEFINE_ERRINFO(Address, uintptr_t);
 DEFINE_ERRINFO(BarIndex, size_t);
 DEFINE_ERRINFO(BarSize, size_t);
+DEFINE_ERRINFO(BufferId, int);
 DEFINE_ERRINFO(CardId, ::AliceO2::roc::Parameters::CardIdType);
 DEFINE_ERRINFO(CardType, ::AliceO2::roc::CardType::type);
 DEFINE_ERRINFO(ChannelNumber, int);
+DEFINE_ERRINFO(Cpu, int);
 DEFINE_ERRINFO(DdlResetMask, std::string);
 DEFINE_ERRINFO(Directory, std::string);
 DEFINE_ERRINFO(DiuCommand, int);
@@ -48,6 +50,7 @@ DEFINE_ERRINFO(DmaPageSize, size_t);
 DEFINE_ERRINFO(FifoIndex, int);
 DEFINE_ERRINFO(FifoSize, size_t);
 DEFINE_ERRINFO(FileSize, size_t);
+DEFINE_ERRINFO(Filename, std::string);
 DEFINE_ERRINFO(GeneratorEventLength, size_t);
 DEFINE_ERRINFO(GeneratorPattern, int);
 DEFINE_ERRINFO(GeneratorSeed, int);
@@ -55,6 +58,7 @@ DEFINE_ERRINFO(Index, size_t);
 DEFINE_ERRINFO(LinkId, uint32_t);
 DEFINE_ERRINFO(LoopbackMode, ::AliceO2::roc::LoopbackMode::type);
 DEFINE_ERRINFO(NamedMutexName, std::string);
+DEFINE_ERRINFO(NumaNode, int);
 DEFINE_ERRINFO(Offset, size_t);
 DEFINE_ERRINFO(PageIndex, int);
 DEFINE_ERRINFO(Pages, size_t);
@@ -83,6 +87,8 @@ DEFINE_ERRINFO(SiuCommand, int);
 DEFINE_ERRINFO(String, std::string);
 DEFINE_ERRINFO(StwExpected, std::string);
 DEFINE_ERRINFO(StwReceived, std::string);
+DEFINE_ERRINFO(SuperpageCount, size_t);
+DEFINE_ERRINFO(SuperpageSize, size_t);
 
 // Undefine macro for header safety (we don't want to pollute the global namespace with collision-prone names)
 #undef DEFINE_ERRINFO
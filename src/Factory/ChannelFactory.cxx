@@ -5,14 +5,18 @@
 
 #include "ReadoutCard/ReadoutCard.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include <future>
+#include "DriverThreadDmaChannel.h"
 #include "Dummy/DummyDmaChannel.h"
 #include "Dummy/DummyBar.h"
 #include "Factory/ChannelFactoryUtils.h"
+#include "MonitorBar.h"
 #ifdef ALICEO2_READOUTCARD_PDA_ENABLED
 #  include "Crorc/CrorcDmaChannel.h"
 #  include "Crorc/CrorcBar.h"
 #  include "Cru/CruDmaChannel.h"
 #  include "Cru/CruBar.h"
+#  include "Pda/PdaDmaBufferCache.h"
 #else
 #  pragma message("PDA not enabled, ChannelFactory will always return a dummy implementation")
 #endif
@@ -33,13 +37,55 @@ ChannelFactory::~ChannelFactory()
 
 auto ChannelFactory::getDmaChannel(const Parameters &params) -> DmaChannelSharedPtr
 {
-  return channelFactoryHelper<DmaChannelInterface>(params, getDummySerialNumber(), {
+  auto channel = channelFactoryHelper<DmaChannelInterface>(params, getDummySerialNumber(), {
     {CardType::Dummy, [&]{ return std::make_unique<DummyDmaChannel>(params); }},
 #ifdef ALICEO2_READOUTCARD_PDA_ENABLED
     {CardType::Crorc, [&]{ return std::make_unique<CrorcDmaChannel>(params); }},
     {CardType::Cru,   [&]{ return std::make_unique<CruDmaChannel>(params); }}
 #endif
   });
+
+  if (params.getDriverThreadEnabled().get_value_or(false)) {
+    return std::make_shared<DriverThreadDmaChannel>(std::move(channel), params);
+  }
+  return channel;
+}
+
+auto ChannelFactory::getSplitDmaChannel(const Parameters &params) -> SplitDmaChannel
+{
+  // The queues between the user and the driver thread are what makes the split safe
+  auto threadParams = params;
+  threadParams.setDriverThreadEnabled(true);
+  auto channel = getDmaChannel(threadParams);
+  return {channel, SuperpageProducer(channel), SuperpageConsumer(channel)};
+}
+
+auto ChannelFactory::getDmaChannels(const std::vector<Parameters> &parameters) -> std::vector<DmaChannelSharedPtr>
+{
+  std::vector<std::future<DmaChannelSharedPtr>> futures;
+  futures.reserve(parameters.size());
+  for (const auto& params : parameters) {
+    futures.push_back(std::async(std::launch::async, [this, &params]{ return getDmaChannel(params); }));
+  }
+
+  // Wait for all of them, even if one fails, so no channel is left half-initialized on another thread
+  std::vector<DmaChannelSharedPtr> channels;
+  std::exception_ptr exception;
+  for (auto& future : futures) {
+    try {
+      channels.push_back(future.get());
+    }
+    catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+  return channels;
 }
 
 auto ChannelFactory::getBar(const Parameters &params) -> BarSharedPtr
@@ -53,5 +99,39 @@ auto ChannelFactory::getBar(const Parameters &params) -> BarSharedPtr
   });
 }
 
+auto ChannelFactory::getMonitorBar(const Parameters &params) -> BarSharedPtr
+{
+  auto bar = getBar(params);
+
+  auto registers = MonitorBar::getDefaultRegisters(bar->getCardType(), bar->getIndex());
+  if (auto extra = params.getMonitorRegisters()) {
+    registers.insert(extra->begin(), extra->end());
+  }
+
+  // The budget is per card, so the monitors of a card share it whichever ID they opened it with
+  std::string cardKey = "Dummy";
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+  if (bar->getCardType() != CardType::Dummy) {
+    auto id = params.getCardIdRequired();
+    auto address = boost::get<PciAddress>(&id);
+    cardKey = (address ? *address : findCard(id).pciAddress).toString();
+  }
+#endif
+  auto bytesPerSecond = params.getMonitorBudget().get_value_or(MonitorBar::DEFAULT_BUDGET);
+  // Bursts of up to a tenth of a second of the budget, so the registers of a sample go out together
+  auto budget = std::make_shared<PcieBudget>(PcieBudget::getPath(cardKey), bytesPerSecond, bytesPerSecond / 10);
+  return std::make_shared<MonitorBar>(bar, registers, budget);
+}
+
+void ChannelFactory::releaseBufferRegistrations(void* address, size_t size)
+{
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+  Pda::PdaDmaBufferCache::release(reinterpret_cast<uintptr_t>(address), size);
+#else
+  (void) address;
+  (void) size;
+#endif
+}
+
 } // namespace roc
 } // namespace AliceO2
@@ -0,0 +1,74 @@
+/// \file GpuBufferRegistration.cxx
+/// \brief Implementation of the GpuBufferRegistration class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/GpuBufferRegistration.h"
+#include <cuda_runtime_api.h>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+void throwIfError(cudaError_t error, const std::string& message, int bufferId)
+{
+  if (error != cudaSuccess) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message(message + ": " + cudaGetErrorString(error))
+        << ErrorInfo::BufferId(bufferId));
+  }
+}
+
+} // Anonymous namespace
+
+GpuBufferRegistration::~GpuBufferRegistration()
+{
+  for (const auto& entry : mBuffers) {
+    cudaHostUnregister(entry.second.address);
+  }
+}
+
+void GpuBufferRegistration::registerBuffer(int bufferId, void* address, size_t size)
+{
+  if (mBuffers.count(bufferId)) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Buffer already registered")
+        << ErrorInfo::BufferId(bufferId));
+  }
+  // Portable so every context can use it, mapped so kernels can access it directly
+  throwIfError(cudaHostRegister(address, size, cudaHostRegisterPortable | cudaHostRegisterMapped),
+      "Failed to register buffer with CUDA", bufferId);
+  void* devicePointer = nullptr;
+  auto error = cudaHostGetDevicePointer(&devicePointer, address, 0);
+  if (error != cudaSuccess) {
+    cudaHostUnregister(address);
+    throwIfError(error, "Failed to get device pointer of buffer", bufferId);
+  }
+  mBuffers[bufferId] = Buffer{address, devicePointer};
+}
+
+void GpuBufferRegistration::deregisterBuffer(int bufferId)
+{
+  throwIfError(cudaHostUnregister(getBuffer(bufferId).address), "Failed to deregister buffer with CUDA", bufferId);
+  mBuffers.erase(bufferId);
+}
+
+void* GpuBufferRegistration::getDevicePointer(const Superpage& superpage) const
+{
+  return static_cast<char*>(getBuffer(superpage.getBufferId()).devicePointer) + superpage.getOffset();
+}
+
+const GpuBufferRegistration::Buffer& GpuBufferRegistration::getBuffer(int bufferId) const
+{
+  auto iterator = mBuffers.find(bufferId);
+  if (iterator == mBuffers.end()) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Buffer not registered")
+        << ErrorInfo::BufferId(bufferId));
+  }
+  return iterator->second;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,212 @@
+/// \file HugepageMemfd.cxx
+/// \brief Implementation of the HugepageMemfd class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/HugepageMemfd.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "ExceptionInternal.h"
+#include "Utilities/Numa.h"
+#include "Utilities/Util.h"
+
+// Older C libraries don't have the memfd_create() wrapper and its flags
+#ifndef MFD_CLOEXEC
+# define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_HUGETLB
+# define MFD_HUGETLB 0x0004U
+#endif
+#ifndef MFD_HUGE_SHIFT
+# define MFD_HUGE_SHIFT 26
+#endif
+#ifndef MFD_HUGE_2MB
+# define MFD_HUGE_2MB (21U << MFD_HUGE_SHIFT)
+#endif
+#ifndef MFD_HUGE_1GB
+# define MFD_HUGE_1GB (30U << MFD_HUGE_SHIFT)
+#endif
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+constexpr size_t SIZE_2MiB = 2*1024*1024;
+constexpr size_t SIZE_1GiB = 1*1024*1024*1024;
+
+int memfdCreate(const std::string& name, unsigned int flags)
+{
+#ifdef SYS_memfd_create
+  return syscall(SYS_memfd_create, name.c_str(), flags);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+std::string errorString(const std::string& message)
+{
+  return message + ": " + std::strerror(errno);
+}
+
+} // Anonymous namespace
+
+HugepageMemfd::HugepageMemfd(size_t size, const std::string& name, boost::optional<int> numaNode)
+{
+  if (!Utilities::isMultiple(size, SIZE_2MiB)) {
+    BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message("Memfd size not a multiple of 2 MiB"));
+  }
+
+  auto tryCreate = [&](size_t pageSize) {
+    const unsigned int flags = MFD_CLOEXEC | MFD_HUGETLB | (pageSize == SIZE_1GiB ? MFD_HUGE_1GB : MFD_HUGE_2MB);
+    mFileDescriptor = memfdCreate(name, flags);
+    if (mFileDescriptor == -1) {
+      BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(errorString("Failed to create memfd")));
+    }
+    if (ftruncate(mFileDescriptor, size) == -1) {
+      BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(errorString("Failed to resize memfd")));
+    }
+    if (numaNode) {
+      // As in the hugetlbfs: the thread's policy makes the hugepages get reserved from the node, the mapping's policy
+      // makes them get allocated there when faulted in
+      Utilities::ScopedNumaMemoryPolicy policy(*numaNode);
+      map(size);
+      Utilities::bindMemoryToNumaNode(mAddress, size, *numaNode);
+    } else {
+      map(size);
+    }
+    mPageSize = pageSize;
+  };
+
+  auto cleanUp = [&]{
+    if (mAddress) {
+      munmap(mAddress, mSize);
+      mAddress = nullptr;
+    }
+    if (mFileDescriptor != -1) {
+      close(mFileDescriptor);
+      mFileDescriptor = -1;
+    }
+  };
+
+  if (Utilities::isMultiple(size, SIZE_1GiB)) {
+    try {
+      tryCreate(SIZE_1GiB);
+    }
+    catch (const Exception&) {
+      // Not enough 1 GiB hugepages, falling back to 2 MiB hugepages...
+      cleanUp();
+    }
+  }
+
+  try {
+    if (!mAddress) {
+      tryCreate(SIZE_2MiB);
+    }
+    if (numaNode) {
+      auto remote = Utilities::countRemotePages(mAddress, size, mPageSize, *numaNode);
+      if (remote > 0) {
+        BOOST_THROW_EXCEPTION(Exception()
+            << ErrorInfo::Message("Hugepages of memfd are not on the requested NUMA node")
+            << ErrorInfo::NumaNode(*numaNode)
+            << ErrorInfo::Pages(remote));
+      }
+    }
+  }
+  catch (boost::exception& e) {
+    cleanUp();
+    e << ErrorInfo::FileSize(size);
+    addPossibleCauses(e, {"Not enough free hugepages (check /sys/devices/system/node/node*/hugepages)",
+        "Kernel older than 4.14, which added hugepage support to memfd_create()"});
+    throw;
+  }
+}
+
+HugepageMemfd::HugepageMemfd(int fileDescriptor, size_t size)
+{
+  mFileDescriptor = fcntl(fileDescriptor, F_DUPFD_CLOEXEC, 0);
+  if (mFileDescriptor == -1) {
+    BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(errorString("Failed to duplicate memfd")));
+  }
+  try {
+    map(size);
+  }
+  catch (...) {
+    close(mFileDescriptor);
+    throw;
+  }
+  struct stat status;
+  mPageSize = (fstat(mFileDescriptor, &status) == 0) ? size_t(status.st_blksize) : 0;
+}
+
+HugepageMemfd::~HugepageMemfd()
+{
+  munmap(mAddress, mSize);
+  close(mFileDescriptor);
+}
+
+void HugepageMemfd::map(size_t size)
+{
+  // Populating the mapping reserves and faults in the hugepages now, so a shortage shows up here instead of as a
+  // SIGBUS during DMA
+  void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFileDescriptor, 0);
+  if (address == MAP_FAILED) {
+    BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(errorString("Failed to map memfd")));
+  }
+  mAddress = address;
+  mSize = size;
+}
+
+void HugepageMemfd::sendFileDescriptor(int socket, int fileDescriptor, size_t size)
+{
+  uint64_t payload = size;
+  iovec vector { &payload, sizeof(payload) };
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr message {};
+  message.msg_iov = &vector;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(header), &fileDescriptor, sizeof(int));
+
+  if (sendmsg(socket, &message, MSG_NOSIGNAL) != ssize_t(sizeof(payload))) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to send file descriptor")));
+  }
+}
+
+int HugepageMemfd::receiveFileDescriptor(int socket, size_t& size)
+{
+  uint64_t payload = 0;
+  iovec vector { &payload, sizeof(payload) };
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr message {};
+  message.msg_iov = &vector;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  if (recvmsg(socket, &message, MSG_CMSG_CLOEXEC) != ssize_t(sizeof(payload))) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to receive file descriptor")));
+  }
+  cmsghdr* header = CMSG_FIRSTHDR(&message);
+  if (!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Received message without file descriptor"));
+  }
+  int fileDescriptor;
+  std::memcpy(&fileDescriptor, CMSG_DATA(header), sizeof(int));
+  size = payload;
+  return fileDescriptor;
+}
+
+} // namespace roc
+} // namespace AliceO2
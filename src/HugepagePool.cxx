@@ -0,0 +1,165 @@
+/// \file HugepagePool.cxx
+/// \brief Implementation of the HugepagePool class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/HugepagePool.h"
+#include <iterator>
+#include <vector>
+#include "ExceptionInternal.h"
+#include "Utilities/Hugetlbfs.h"
+#include "Utilities/Util.h"
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+# include "Pda/PdaDmaBufferCache.h"
+#endif
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Regions of the pools that are alive, as start to end address
+struct PoolRegistry
+{
+    std::mutex mutex;
+    std::map<uintptr_t, uintptr_t> regions;
+};
+
+PoolRegistry& getPoolRegistry()
+{
+  static PoolRegistry registry;
+  return registry;
+}
+
+size_t roundUp(size_t size, size_t alignment)
+{
+  return ((size + alignment - 1) / alignment) * alignment;
+}
+
+} // Anonymous namespace
+
+constexpr size_t HugepagePool::SLICE_ALIGNMENT;
+
+HugepagePool::HugepagePool(size_t size, const std::string& name, boost::optional<int> numaNode)
+{
+  mFile = Utilities::tryMapFile(size, name, true, nullptr, numaNode);
+  // The region is reserved up front, so channels using it don't take page faults on their first transfers
+  mFile->prefault();
+  mAddress = reinterpret_cast<uintptr_t>(mFile->getAddress());
+  mSize = mFile->getSize();
+  init();
+}
+
+HugepagePool::HugepagePool(void* address, size_t size)
+    : mAddress(reinterpret_cast<uintptr_t>(address)), mSize(size)
+{
+  if ((mAddress % SLICE_ALIGNMENT) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Hugepage pool address not aligned to 2 MiB"));
+  }
+  init();
+}
+
+void HugepagePool::init()
+{
+  if (!Utilities::isMultiple(mSize, SLICE_ALIGNMENT)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Hugepage pool size not a multiple of 2 MiB"));
+  }
+  mFree[0] = mSize;
+
+  auto& registry = getPoolRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.regions[mAddress] = mAddress + mSize;
+}
+
+HugepagePool::~HugepagePool()
+{
+  {
+    auto& registry = getPoolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.regions.erase(mAddress);
+  }
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+  // The memory is about to be unmapped, so its registrations can't be kept any longer
+  Pda::PdaDmaBufferCache::release(mAddress, mSize);
+#endif
+}
+
+buffer_parameters::Memory HugepagePool::allocate(size_t size)
+{
+  if (size == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not allocate from hugepage pool, size == 0"));
+  }
+  size = roundUp(size, SLICE_ALIGNMENT);
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  // First fit, which keeps the slices of channels that are reopened in order at the same place
+  for (auto it = mFree.begin(); it != mFree.end(); ++it) {
+    if (it->second >= size) {
+      auto offset = it->first;
+      auto remaining = it->second - size;
+      mFree.erase(it);
+      if (remaining > 0) {
+        mFree[offset + size] = remaining;
+      }
+      return {reinterpret_cast<void*>(mAddress + offset), size};
+    }
+  }
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not allocate from hugepage pool, not enough space")
+      << ErrorInfo::DmaBufferSize(size));
+}
+
+void HugepagePool::release(const buffer_parameters::Memory& slice)
+{
+  auto address = reinterpret_cast<uintptr_t>(slice.address);
+  if (address < mAddress || (address + slice.size) > (mAddress + mSize)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not release slice, not part of the hugepage pool"));
+  }
+  auto offset = address - mAddress;
+  auto size = slice.size;
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto next = mFree.lower_bound(offset);
+  if ((next != mFree.end() && next->first < offset + size)
+      || (next != mFree.begin() && std::prev(next)->first + std::prev(next)->second > offset)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not release slice, it was already free"));
+  }
+
+  // Merge with the neighbouring free ranges
+  if (next != mFree.end() && next->first == offset + size) {
+    size += next->second;
+    next = mFree.erase(next);
+  }
+  if (next != mFree.begin()) {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == offset) {
+      previous->second += size;
+      return;
+    }
+  }
+  mFree[offset] = size;
+}
+
+size_t HugepagePool::getAvailable() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  size_t available = 0;
+  for (const auto& range : mFree) {
+    available += range.second;
+  }
+  return available;
+}
+
+bool HugepagePool::isPoolMemory(const void* address, size_t size)
+{
+  auto begin = reinterpret_cast<uintptr_t>(address);
+  auto& registry = getPoolRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto region = registry.regions.upper_bound(begin);
+  if (region == registry.regions.begin()) {
+    return false;
+  }
+  --region;
+  return begin >= region->first && (begin + size) <= region->second;
+}
+
+} // namespace roc
+} // namespace AliceO2
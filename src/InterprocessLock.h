@@ -10,6 +10,7 @@
 #include <boost/exception/errinfo_errno.hpp>
 #include <chrono>
 #include "ExceptionInternal.h"
+#include "Utilities/Wait.h"
 #include <sys/socket.h>
 #include <sys/un.h>
 
@@ -38,14 +39,16 @@ class Lock
       mServerAddress.sun_path[0] = 0; //this makes the unix domain socket *abstract*
 
       if (waitOnLock) { //retry until timeout
-        const auto start = std::chrono::steady_clock::now();
-        auto timeExceeded = [&]() { return ((std::chrono::steady_clock::now() - start) > std::chrono::seconds(LOCK_TIMEOUT)); };
+        // The retries back off to sleeping, so waiters don't take CPU time from the process holding the lock. The
+        // maximum interval bounds the delay between a release and the next acquisition.
+        constexpr auto RETRY_MIN_INTERVAL = std::chrono::microseconds(10);
+        constexpr auto RETRY_MAX_INTERVAL = std::chrono::milliseconds(2);
+        auto tryBind = [&]{
+          return bind(mSocketFd, (const struct sockaddr *) &mServerAddress, mAddressLength) == 0;
+        };
 
-        while (bind(mSocketFd,
-              (const struct sockaddr *) &mServerAddress,
-              mAddressLength) < 0 && !timeExceeded()) {}
-
-        if (timeExceeded()) { //we timed out
+        if (!Utilities::pollWithBackoff(tryBind, std::chrono::seconds(LOCK_TIMEOUT), RETRY_MIN_INTERVAL,
+              RETRY_MAX_INTERVAL)) { //we timed out
           close(mSocketFd);
           BOOST_THROW_EXCEPTION(LockException()
               << ErrorInfo::PossibleCauses({"Bind to socket timed out"}));
@@ -0,0 +1,119 @@
+/// \file LatencyHistogram.h
+/// \brief Definition of the LatencyHistogram class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_LATENCYHISTOGRAM_H_
+#define ALICEO2_SRC_READOUTCARD_LATENCYHISTOGRAM_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Histogram of latencies in the style of an HdrHistogram: buckets are linear within each power of 2, so every value
+/// is kept with a relative error below 1 / SUB_BUCKETS_HALF (1.6%), over the full 64-bit range, in a fixed amount of
+/// memory. Recording a value is a few instructions and no allocation, so it can be done for every superpage.
+///
+/// A histogram has a single writer. Histograms of different threads are combined with merge() when reporting.
+class LatencyHistogram
+{
+  public:
+    /// Amount of bits of a value that are kept exactly
+    static constexpr size_t SUB_BUCKET_BITS = 7;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t SUB_BUCKETS_HALF = SUB_BUCKETS / 2;
+    /// Values below SUB_BUCKETS have a bucket each, every further power of 2 has SUB_BUCKETS_HALF buckets
+    static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS) * SUB_BUCKETS_HALF + SUB_BUCKETS;
+
+    LatencyHistogram()
+    {
+      mCounts.fill(0);
+    }
+
+    void record(uint64_t value)
+    {
+      mCounts[getIndex(value)]++;
+      mCount++;
+      mMax = std::max(mMax, value);
+    }
+
+    /// Adds the values recorded in another histogram to this one
+    void merge(const LatencyHistogram& other)
+    {
+      for (size_t i = 0; i < BUCKETS; ++i) {
+        mCounts[i] += other.mCounts[i];
+      }
+      mCount += other.mCount;
+      mMax = std::max(mMax, other.mMax);
+    }
+
+    /// Gets the amount of recorded values
+    uint64_t getCount() const
+    {
+      return mCount;
+    }
+
+    /// Gets the largest recorded value, exactly. 0 if nothing was recorded.
+    uint64_t getMax() const
+    {
+      return mMax;
+    }
+
+    /// Gets the value below or at which the given percentage of the recorded values are. The value is the upper bound
+    /// of its bucket, so it is never below the real percentile.
+    /// \param percentile Percentage, from 0 to 100
+    /// \return The value, or 0 if nothing was recorded
+    uint64_t getPercentile(double percentile) const
+    {
+      if (mCount == 0) {
+        return 0;
+      }
+      auto target = uint64_t(std::ceil((std::min(std::max(percentile, 0.0), 100.0) / 100.0) * mCount));
+      target = std::max<uint64_t>(target, 1);
+      uint64_t seen = 0;
+      for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += mCounts[i];
+        if (seen >= target) {
+          return std::min(getUpperBound(i), mMax);
+        }
+      }
+      return mMax;
+    }
+
+    /// Gets the bucket of a value
+    static size_t getIndex(uint64_t value)
+    {
+      if (value < SUB_BUCKETS) {
+        return value;
+      }
+      // The value's bit length is above SUB_BUCKET_BITS, shift the bits below the kept ones out
+      size_t shift = (64 - __builtin_clzll(value)) - SUB_BUCKET_BITS;
+      return shift * SUB_BUCKETS_HALF + (value >> shift);
+    }
+
+    /// Gets the largest value that goes in a bucket
+    static uint64_t getUpperBound(size_t index)
+    {
+      if (index < SUB_BUCKETS) {
+        return index;
+      }
+      size_t shift = (index / SUB_BUCKETS_HALF) - 1;
+      uint64_t subBucket = index - shift * SUB_BUCKETS_HALF;
+      return ((subBucket + 1) << shift) - 1;
+    }
+
+  private:
+    std::array<uint64_t, BUCKETS> mCounts;
+    uint64_t mCount = 0;
+    uint64_t mMax = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_LATENCYHISTOGRAM_H_
@@ -0,0 +1,92 @@
+/// \file LinkGroupChannel.cxx
+/// \brief Implementation of the LinkGroupChannel class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/LinkGroupChannel.h"
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+#include "LinkGroupSegment.h"
+
+namespace AliceO2 {
+namespace roc {
+
+using namespace LinkGroupSegment;
+
+LinkGroupChannel::LinkGroupChannel(const std::string& name, size_t group)
+{
+  const auto path = getPath(name);
+  if (!boost::filesystem::exists(path)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link groups do not exist")
+        << ErrorInfo::Filename(path));
+  }
+  const auto segmentSize = boost::filesystem::file_size(path);
+  if (segmentSize < sizeof(Header)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link group segment too small")
+        << ErrorInfo::Filename(path));
+  }
+  mSegmentFile = std::make_unique<MemoryMappedFile>(path, segmentSize, false);
+  auto header = static_cast<Header*>(mSegmentFile->getAddress());
+
+  if (header->magic.load(std::memory_order_acquire) != MAGIC || header->version != VERSION) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link group segment not initialized or incompatible")
+        << ErrorInfo::Filename(path));
+  }
+  if (group >= header->groupCount) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link group index out of range, there are "
+        + std::to_string(header->groupCount) + " groups") << ErrorInfo::Filename(path));
+  }
+  const size_t ringCapacity = header->ringCapacity;
+  if (getSegmentSize(header->groupCount, ringCapacity) > segmentSize) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link group segment too small for its rings")
+        << ErrorInfo::Filename(path));
+  }
+
+  mLinkMask = header->linkMasks[group];
+  for (uint32_t linkId = 0; linkId < MAX_LINKS; ++linkId) {
+    if (mLinkMask & (uint64_t(1) << linkId)) {
+      mLinks.push_back(linkId);
+    }
+  }
+
+  mBufferFile = std::make_unique<MemoryMappedFile>(std::string(header->bufferPath), header->bufferSize, false);
+  auto segment = static_cast<char*>(mSegmentFile->getAddress());
+  mPushRing = std::make_unique<SuperpageRing>(segment + getRingOffset(ringCapacity, group, false), ringCapacity,
+      false);
+  mReadyRing = std::make_unique<SuperpageRing>(segment + getRingOffset(ringCapacity, group, true), ringCapacity,
+      false);
+}
+
+LinkGroupChannel::~LinkGroupChannel()
+{
+}
+
+void* LinkGroupChannel::getAddress() const
+{
+  return mBufferFile->getAddress();
+}
+
+size_t LinkGroupChannel::getSize() const
+{
+  return mBufferFile->getSize();
+}
+
+bool LinkGroupChannel::tryPushSuperpage(const Superpage& superpage, uint32_t linkId)
+{
+  if (linkId >= MAX_LINKS || !(mLinkMask & (uint64_t(1) << linkId))) {
+    BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("Link is not in the link group")
+        << ErrorInfo::LinkId(linkId));
+  }
+  auto copy = withoutPointers(superpage);
+  copy.setLinkId(linkId);
+  return mPushRing->write(copy);
+}
+
+bool LinkGroupChannel::tryPopSuperpage(Superpage& superpage)
+{
+  // The ready flag is passed on by the master, it's false for superpages it could not push
+  return mReadyRing->read(superpage);
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,206 @@
+/// \file LinkGroupMaster.cxx
+/// \brief Implementation of the LinkGroupMaster class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/LinkGroupMaster.h"
+#include <cstring>
+#include <new>
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+#include "LinkGroupSegment.h"
+#include "Utilities/Hugetlbfs.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Amount of arrived superpages popped from the channel at once
+constexpr size_t BATCH_SIZE = 64;
+
+} // Anonymous namespace
+
+using namespace LinkGroupSegment;
+
+LinkGroupMaster::LinkGroupMaster(const std::string& name, size_t bufferSize,
+    const std::vector<std::vector<uint32_t>>& groups, size_t ringCapacity, boost::optional<int> numaNode)
+{
+  mBufferFile = Utilities::tryMapFile(bufferSize, "AliceO2_RoC_LinkGroups_" + name + "_buffer", true, nullptr,
+      numaNode);
+  init(name, groups, ringCapacity);
+}
+
+LinkGroupMaster::LinkGroupMaster(const std::string& name, const std::string& bufferPath, size_t bufferSize,
+    const std::vector<std::vector<uint32_t>>& groups, size_t ringCapacity)
+{
+  mBufferFile = std::make_unique<MemoryMappedFile>(bufferPath, bufferSize, true);
+  init(name, groups, ringCapacity);
+}
+
+LinkGroupMaster::~LinkGroupMaster()
+{
+}
+
+void LinkGroupMaster::init(const std::string& name, const std::vector<std::vector<uint32_t>>& groups,
+    size_t ringCapacity)
+{
+  if (ringCapacity == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link group ring capacity must be greater than 0"));
+  }
+  if (groups.empty() || groups.size() > MAX_GROUPS) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Amount of link groups must be between 1 and "
+        + std::to_string(MAX_GROUPS)));
+  }
+  if (mBufferFile->getFileName().size() >= BUFFER_PATH_LENGTH) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link group buffer file path too long")
+        << ErrorInfo::Filename(mBufferFile->getFileName()));
+  }
+
+  mGroupByLink.fill(-1);
+  std::vector<uint64_t> linkMasks(groups.size(), 0);
+  for (size_t group = 0; group < groups.size(); ++group) {
+    if (groups[group].empty()) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Link group has no links"));
+    }
+    for (auto linkId : groups[group]) {
+      if (linkId >= MAX_LINKS) {
+        BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("Link ID of link group too large")
+            << ErrorInfo::LinkId(linkId));
+      }
+      if (mGroupByLink[linkId] != -1) {
+        BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("Link is in more than one link group")
+            << ErrorInfo::LinkId(linkId));
+      }
+      mGroupByLink[linkId] = group;
+      linkMasks[group] |= uint64_t(1) << linkId;
+    }
+  }
+
+  // A segment left behind by a crashed process must not be attached to while we initialize it
+  const auto path = getPath(name);
+  boost::filesystem::remove(path);
+  const auto segmentSize = getSegmentSize(groups.size(), ringCapacity);
+  mSegmentFile = std::make_unique<MemoryMappedFile>(path, segmentSize, true);
+  std::memset(mSegmentFile->getAddress(), 0, segmentSize);
+
+  auto header = new (mSegmentFile->getAddress()) Header;
+  header->version = VERSION;
+  header->groupCount = groups.size();
+  header->bufferSize = mBufferFile->getSize();
+  header->ringCapacity = ringCapacity;
+  std::copy(linkMasks.begin(), linkMasks.end(), header->linkMasks);
+  std::strncpy(header->bufferPath, mBufferFile->getFileName().c_str(), BUFFER_PATH_LENGTH - 1);
+
+  auto segment = static_cast<char*>(mSegmentFile->getAddress());
+  mGroups.resize(groups.size());
+  for (size_t group = 0; group < groups.size(); ++group) {
+    mGroups[group].pushRing = std::make_unique<SuperpageRing>(segment + getRingOffset(ringCapacity, group, false),
+        ringCapacity, true);
+    mGroups[group].readyRing = std::make_unique<SuperpageRing>(segment + getRingOffset(ringCapacity, group, true),
+        ringCapacity, true);
+  }
+  mBatch.resize(BATCH_SIZE);
+
+  // Groups may attach from here on
+  header->magic.store(MAGIC, std::memory_order_release);
+}
+
+buffer_parameters::Memory LinkGroupMaster::getBufferParameters() const
+{
+  return buffer_parameters::Memory{mBufferFile->getAddress(), mBufferFile->getSize()};
+}
+
+size_t LinkGroupMaster::poll(DmaChannelInterface& channel)
+{
+  size_t handled = 0;
+
+  // Push what the groups gave us, stopping a group at its first full link so its superpages keep their order
+  for (size_t index = 0; index < mGroups.size(); ++index) {
+    auto& group = mGroups[index];
+    Superpage superpage;
+    while (!group.pendingPushes.empty() || group.pushRing->read(superpage)) {
+      if (!group.pendingPushes.empty()) {
+        if (!channel.tryPushSuperpageToLink(group.pendingPushes.front(), group.pendingPushes.front().getLinkId())) {
+          break;
+        }
+        group.pendingPushes.pop_front();
+      } else if (!isPushable(channel, index, superpage)) {
+        // The ring is written by another process, so a bad superpage goes back to it instead of stopping the master
+        superpage.setReady(false);
+        superpage.setReceived(0);
+        handOut(group, superpage);
+      } else if (!channel.tryPushSuperpageToLink(superpage, superpage.getLinkId())) {
+        group.pendingPushes.push_back(superpage);
+        break;
+      }
+      handled++;
+    }
+  }
+
+  channel.fillSuperpages();
+
+  // Hand out what arrived, first what a full ready ring held back last time
+  for (auto& group : mGroups) {
+    while (!group.pendingReady.empty() && group.readyRing->write(group.pendingReady.front())) {
+      group.pendingReady.pop_front();
+      handled++;
+    }
+  }
+  // Superpages on links without a group are kept for takeUnroutedSuperpages(), so the rest of the batch is still
+  // handed out before we throw
+  const size_t unrouted = mUnrouted.size();
+  while (true) {
+    const size_t popped = channel.popSuperpages(mBatch.data(), mBatch.size());
+    for (size_t i = 0; i < popped; ++i) {
+      const auto linkId = mBatch[i].getLinkId();
+      if (linkId >= MAX_LINKS || mGroupByLink[linkId] == -1) {
+        mUnrouted.push_back(mBatch[i]);
+        continue;
+      }
+      if (handOut(mGroups[mGroupByLink[linkId]], withoutPointers(mBatch[i]))) {
+        handled++;
+      }
+    }
+    if (popped < mBatch.size()) {
+      break;
+    }
+  }
+  if (mUnrouted.size() > unrouted) {
+    BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message("Superpage arrived on link without link group")
+        << ErrorInfo::LinkId(mUnrouted[unrouted].getLinkId()));
+  }
+  return handled;
+}
+
+std::vector<Superpage> LinkGroupMaster::takeUnroutedSuperpages()
+{
+  std::vector<Superpage> superpages;
+  superpages.swap(mUnrouted);
+  return superpages;
+}
+
+bool LinkGroupMaster::isPushable(DmaChannelInterface& channel, size_t group, const Superpage& superpage) const
+{
+  const auto linkId = superpage.getLinkId();
+  if (linkId >= MAX_LINKS || mGroupByLink[linkId] != int(group)) {
+    return false;
+  }
+  try {
+    channel.validateSuperpage(superpage, linkId);
+  } catch (const Exception&) {
+    return false;
+  }
+  return true;
+}
+
+bool LinkGroupMaster::handOut(Group& group, const Superpage& superpage)
+{
+  if (group.pendingReady.empty() && group.readyRing->write(superpage)) {
+    return true;
+  }
+  group.pendingReady.push_back(superpage);
+  return false;
+}
+
+} // namespace roc
+} // namespace AliceO2
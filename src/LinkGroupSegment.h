@@ -0,0 +1,84 @@
+/// \file LinkGroupSegment.h
+/// \brief Definition of the layout of the shared segment of LinkGroupMaster and LinkGroupChannel.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_LINKGROUPSEGMENT_H_
+#define ALICEO2_SRC_READOUTCARD_LINKGROUPSEGMENT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ReadoutCard/SuperpageRing.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace LinkGroupSegment {
+
+/// Marks an initialized segment, "ROCLNKGR"
+constexpr uint64_t MAGIC = 0x524f434c4e4b4752;
+constexpr uint32_t VERSION = 1;
+constexpr size_t MAX_GROUPS = 32;
+/// Link IDs must be below this, so a group's links fit in a 64-bit mask
+constexpr uint32_t MAX_LINKS = 64;
+constexpr size_t BUFFER_PATH_LENGTH = 256;
+constexpr size_t SEGMENT_ALIGNMENT = 4096;
+
+/// Start of the segment. It is followed by two rings per group, aligned to a cache line: first the push ring, through
+/// which the group's process gives superpages to the master, then the ready ring, through which the master hands it the
+/// superpages that arrived on its links.
+struct Header
+{
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t groupCount;
+    uint64_t bufferSize;
+    uint64_t ringCapacity;
+    /// Links of every group, bit N for link N
+    uint64_t linkMasks[MAX_GROUPS];
+    char bufferPath[BUFFER_PATH_LENGTH];
+};
+
+inline size_t roundUp(size_t size, size_t alignment)
+{
+  return ((size + alignment - 1) / alignment) * alignment;
+}
+
+inline std::string getPath(const std::string& name)
+{
+  return "/dev/shm/AliceO2_RoC_LinkGroups_" + name;
+}
+
+inline size_t getRingStride(size_t ringCapacity)
+{
+  return roundUp(SuperpageRing::getRequiredSize(ringCapacity), SuperpageRing::CACHE_LINE_SIZE);
+}
+
+/// Gets the offset of a ring in the segment
+/// \param group Index of the group
+/// \param ready False for the push ring, true for the ready ring
+inline size_t getRingOffset(size_t ringCapacity, size_t group, bool ready)
+{
+  return roundUp(sizeof(Header), SuperpageRing::CACHE_LINE_SIZE)
+      + (2 * group + (ready ? 1 : 0)) * getRingStride(ringCapacity);
+}
+
+inline size_t getSegmentSize(size_t groupCount, size_t ringCapacity)
+{
+  return roundUp(getRingOffset(ringCapacity, groupCount, false), SEGMENT_ALIGNMENT);
+}
+
+/// Pointers of one process are meaningless in the other
+inline Superpage withoutPointers(Superpage superpage)
+{
+  superpage.setUserData(nullptr);
+  superpage.setPageLengths(nullptr);
+  return superpage;
+}
+
+} // namespace LinkGroupSegment
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_LINKGROUPSEGMENT_H_
@@ -0,0 +1,147 @@
+/// \file LinkIntegrityMonitor.cxx
+/// \brief Implementation of the LinkIntegrityMonitor class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/LinkIntegrityMonitor.h"
+#include "ReadoutCard/PageChecksum.h"
+#include "Cru/DataFormat.h"
+#include "Cru/SuperpageView.h"
+
+namespace AliceO2 {
+namespace roc {
+
+constexpr size_t LinkIntegrityMonitor::MAX_LINKS;
+constexpr size_t LinkIntegrityMonitor::DMA_PAGE_SIZE;
+constexpr uint16_t LinkIntegrityMonitor::UNKNOWN;
+
+LinkIntegrityMonitor::LinkIntegrityMonitor(size_t pageSize, bool packed) : mPageSize(pageSize), mPacked(packed)
+{
+  reset();
+}
+
+size_t LinkIntegrityMonitor::checkSuperpage(const void* address, size_t received)
+{
+  return checkSuperpage(address, received, nullptr);
+}
+
+size_t LinkIntegrityMonitor::checkSuperpage(const void* address, size_t received, uint32_t* checksums)
+{
+  size_t errors = 0;
+  if (mPacked) {
+    // The packets do not line up with the pages, so the checksums are computed separately
+    auto packet = static_cast<const char*>(address);
+    const auto end = packet + received;
+    while (packet != end) {
+      const auto status = checkPacket(packet, end - packet);
+      if (status == Status::SizeError) {
+        // The offset to the next packet can't be trusted
+        errors++;
+        break;
+      }
+      if (status != Status::Ok) {
+        errors++;
+      }
+      packet += Cru::decodeRdh(packet).offsetNextPacket;
+    }
+    if (checksums) {
+      PageChecksum::computePages(address, received, mPageSize, checksums);
+    }
+    return errors;
+  }
+
+  auto page = static_cast<const char*>(address);
+  const auto end = page + (received / mPageSize) * mPageSize;
+  for (; page != end; page += mPageSize) {
+    if (checkPage(page) != Status::Ok) {
+      errors++;
+    }
+    if (checksums) {
+      *checksums++ = PageChecksum::compute(page, mPageSize);
+    }
+  }
+  return errors;
+}
+
+LinkIntegrityMonitor::Status LinkIntegrityMonitor::checkPage(const void* page)
+{
+  return checkPacket(page, mPageSize);
+}
+
+LinkIntegrityMonitor::Status LinkIntegrityMonitor::checkPacket(const void* packet, size_t available)
+{
+  const auto rdh = Cru::decodeRdh(static_cast<const char*>(packet));
+  auto& link = mLinks[rdh.linkId];
+  link.packets++;
+
+  const size_t limit = mPacked ? rdh.offsetNextPacket : mPageSize;
+  if (rdh.memorySize < Cru::DataFormat::getHeaderSize() || rdh.memorySize > limit
+      || (mPacked && rdh.offsetNextPacket > available)) {
+    link.sizeErrors++;
+    return Status::SizeError;
+  }
+  link.bytes += rdh.memorySize;
+
+  // The counter is 8 bits, so the gap is the amount of packets missing modulo 256
+  auto& expected = mExpected[rdh.linkId];
+  const bool continuous = (expected == UNKNOWN) || (expected == rdh.packetCounter);
+  if (!continuous) {
+    link.counterGaps++;
+    link.dropped += (rdh.packetCounter - expected) & 0xff;
+  }
+  expected = (rdh.packetCounter + 1) & 0xff;
+  return continuous ? Status::Ok : Status::CounterGap;
+}
+
+void LinkIntegrityMonitor::resync(uint32_t linkId)
+{
+  mExpected.at(linkId) = UNKNOWN;
+}
+
+void LinkIntegrityMonitor::reset()
+{
+  mExpected.fill(UNKNOWN);
+  mLinks.fill(Link());
+}
+
+int LinkIntegrityMonitor::getLastPacketCounter(uint32_t linkId) const
+{
+  const auto expected = mExpected.at(linkId);
+  return expected == UNKNOWN ? -1 : (expected + 0xff) & 0xff;
+}
+
+LinkIntegrityStatistics LinkIntegrityMonitor::getLinkStatistics(uint32_t linkId) const
+{
+  const auto& link = mLinks.at(linkId);
+  LinkIntegrityStatistics statistics;
+  statistics.linkId = linkId;
+  statistics.packets = link.packets;
+  statistics.bytes = link.bytes;
+  statistics.counterGaps = link.counterGaps;
+  statistics.dropped = link.dropped;
+  statistics.sizeErrors = link.sizeErrors;
+  return statistics;
+}
+
+std::vector<LinkIntegrityStatistics> LinkIntegrityMonitor::getStatistics() const
+{
+  std::vector<LinkIntegrityStatistics> statistics;
+  for (uint32_t linkId = 0; linkId < MAX_LINKS; ++linkId) {
+    if (mLinks[linkId].packets != 0) {
+      statistics.push_back(getLinkStatistics(linkId));
+    }
+  }
+  return statistics;
+}
+
+uint64_t LinkIntegrityMonitor::getErrorCount() const
+{
+  uint64_t errors = 0;
+  for (const auto& link : mLinks) {
+    errors += link.counterGaps + link.sizeErrors;
+  }
+  return errors;
+}
+
+} // namespace roc
+} // namespace AliceO2
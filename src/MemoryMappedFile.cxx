@@ -4,6 +4,10 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "ReadoutCard/MemoryMappedFile.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <boost/filesystem.hpp>
 #include <boost/interprocess/file_mapping.hpp>
@@ -60,6 +64,46 @@ std::string MemoryMappedFile::getFileName() const
   return mInternal->fileName;
 }
 
+void MemoryMappedFile::prefault()
+{
+  auto address = getAddress();
+  auto size = getSize();
+
+#ifdef MADV_POPULATE_WRITE
+  if (madvise(address, size, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+  if (errno != EINVAL) {
+    BOOST_THROW_EXCEPTION(MemoryMapException()
+        << ErrorInfo::Message(std::string("Failed to prefault memory map file: ") + std::strerror(errno))
+        << ErrorInfo::FileName(getFileName())
+        << ErrorInfo::FileSize(size)
+        << ErrorInfo::PossibleCauses({"Not enough hugepages allocated (check 'hugeadm --pool-list')"}));
+  }
+  // The running kernel does not support it, so we touch the pages ourselves
+#endif
+
+  // Writing back what was read faults the page in for writing, without changing the contents
+  const size_t pageSize = sysconf(_SC_PAGESIZE);
+  auto data = static_cast<volatile char*>(address);
+  for (size_t offset = 0; offset < size; offset += pageSize) {
+    data[offset] = data[offset];
+  }
+}
+
+void MemoryMappedFile::lock()
+{
+  if (mlock(getAddress(), getSize()) != 0) {
+    BOOST_THROW_EXCEPTION(MemoryMapException()
+        << ErrorInfo::Message(std::string("Failed to lock memory map file: ") + std::strerror(errno))
+        << ErrorInfo::FileName(getFileName())
+        << ErrorInfo::FileSize(getSize())
+        << ErrorInfo::PossibleCauses({
+          "Locked memory limit too low (check 'ulimit -l')",
+          "Not enough memory available"}));
+  }
+}
+
 void MemoryMappedFile::map(const std::string& fileName, size_t fileSize)
 {
   try {
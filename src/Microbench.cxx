@@ -0,0 +1,289 @@
+/// \file Microbench.cxx
+/// \brief Microbenchmarks of the driver's hot paths, which run without a card.
+///
+/// These measure the per-superpage and per-page code of the DMA channels in isolation, so a change to one of them can
+/// be checked for regressions without hardware. Run with --benchmark_filter=<regex> to select benchmarks.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "Crorc/Constants.h"
+#include "Crorc/ReadyFifo.h"
+#include "Cru/Constants.h"
+#include "Cru/DataFormat.h"
+#include "Cru/LinkScheduler.h"
+#include "Cru/SuperpageView.h"
+#include "Pda/ScatterGatherIndex.h"
+#include "ReadoutCard/PageChecksum.h"
+#include "SuperpageQueue.h"
+#include "Utilities/Util.h"
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+# include "Cru/CruBar.h"
+#endif
+
+using namespace AliceO2::roc;
+
+namespace {
+
+constexpr size_t KIBI = 1024;
+constexpr size_t MEBI = 1024 * KIBI;
+
+/// Makes a scatter-gather list of entries of the given size, with the bus addresses shuffled like a real IOMMU-less
+/// allocation would have them
+Pda::ScatterGatherVector makeScatterGatherList(size_t entries, size_t entrySize, bool uniform)
+{
+  Pda::ScatterGatherVector list;
+  std::mt19937 random(entries);
+  uintptr_t addressUser = 0x7f0000000000;
+  for (size_t i = 0; i < entries; ++i) {
+    // Non-uniform lists alternate between entries of 1 and 2 times the size
+    size_t size = uniform ? entrySize : entrySize * (1 + (i % 2));
+    list.push_back({size, addressUser, 0x100000000 + (random() % entries) * 4 * entrySize, 0});
+    addressUser += size;
+  }
+  std::shuffle(list.begin(), list.end(), random);
+  return list;
+}
+
+size_t getScatterGatherListSize(const Pda::ScatterGatherVector& list)
+{
+  size_t size = 0;
+  for (const auto& entry : list) {
+    size += entry.size;
+  }
+  return size;
+}
+
+/// Writes an RDH at the start of every page
+std::vector<char> makePages(size_t pages, size_t pageSize)
+{
+  std::vector<char> data(pages * pageSize, 0);
+  for (size_t i = 0; i < pages; ++i) {
+    uint32_t words[4] = {0x4, 0, uint32_t((pageSize << 16) | pageSize), uint32_t(((i % 256) << 8) | (i % 24))};
+    std::memcpy(&data[i * pageSize], words, sizeof(words));
+  }
+  return data;
+}
+
+/// A superpage's whole trip through the queue: add, push, arrive, fill, remove
+void BM_SuperpageQueueLifecycle(benchmark::State& state)
+{
+  SuperpageQueue queue(Cru::MAX_SUPERPAGE_DESCRIPTORS);
+  SuperpageQueue::SuperpageQueueEntry entry;
+  entry.busAddress = 0x100000000;
+  entry.pushedPages = 0;
+  entry.maxPages = 256;
+  entry.superpage.setSize(MEBI);
+
+  for (auto _ : state) {
+    queue.addToQueue(entry);
+    auto& pushing = queue.getPushingFrontEntry();
+    pushing.pushedPages = pushing.maxPages;
+    queue.removeFromPushingQueue();
+    queue.getArrivalsFrontEntry().superpage.setReady(true);
+    queue.moveFromArrivalsToFilledQueue();
+    benchmark::DoNotOptimize(queue.removeFromFilledQueue());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SuperpageQueueLifecycle);
+
+/// Lookups of the bus address of every page of a buffer, arg 0 is the amount of scatter-gather entries and arg 1 if
+/// they are uniformly sized
+void BM_ScatterGatherIndex(benchmark::State& state)
+{
+  constexpr size_t PAGE_SIZE = 8 * KIBI;
+  auto list = makeScatterGatherList(state.range(0), 2 * MEBI, state.range(1));
+  Pda::ScatterGatherIndex index(list);
+  size_t bufferSize = getScatterGatherListSize(list);
+  size_t offset = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.getBusOffsetAddress(offset));
+    offset += PAGE_SIZE;
+    if (offset >= bufferSize) {
+      offset = 0;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScatterGatherIndex)->Args({512, 1})->Args({512, 0})->Args({8192, 1})->Args({8192, 0});
+
+/// The getters the readout uses on every page, one field at a time
+void BM_DataFormatGetters(benchmark::State& state)
+{
+  constexpr size_t PAGES = 256;
+  constexpr size_t PAGE_SIZE = 8 * KIBI;
+  auto data = makePages(PAGES, PAGE_SIZE);
+  size_t page = 0;
+
+  for (auto _ : state) {
+    const char* rdh = &data[page * PAGE_SIZE];
+    benchmark::DoNotOptimize(Cru::DataFormat::getLinkId(rdh));
+    benchmark::DoNotOptimize(Cru::DataFormat::getEventSize(rdh));
+    benchmark::DoNotOptimize(Cru::DataFormat::getPacketCounter(rdh));
+    page = (page + 1) % PAGES;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataFormatGetters);
+
+/// The same fields with a single decode
+void BM_DecodeRdh(benchmark::State& state)
+{
+  constexpr size_t PAGES = 256;
+  constexpr size_t PAGE_SIZE = 8 * KIBI;
+  auto data = makePages(PAGES, PAGE_SIZE);
+  size_t page = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Cru::decodeRdh(&data[page * PAGE_SIZE]));
+    page = (page + 1) % PAGES;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DecodeRdh);
+
+/// The read-modify-write bit manipulation of the register setters
+void BM_RegisterBits(benchmark::State& state)
+{
+  uint32_t bits = 0;
+  int index = 0;
+
+  for (auto _ : state) {
+    Utilities::setBit(bits, index, !Utilities::getBit(bits, index));
+    benchmark::DoNotOptimize(Utilities::getBits(bits, 1, 2));
+    index = (index + 1) % 32;
+  }
+  benchmark::DoNotOptimize(bits);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegisterBits);
+
+#ifdef ALICEO2_READOUTCARD_PDA_ENABLED
+void BM_CruDataGeneratorBits(benchmark::State& state)
+{
+  uint32_t bits = 0;
+  size_t size = 32;
+
+  for (auto _ : state) {
+    CruBar::setDataGeneratorPatternBits(bits, GeneratorPattern::Incremental);
+    CruBar::setDataGeneratorSizeBits(bits, size);
+    CruBar::setDataGeneratorRandomSizeBits(bits, false);
+    benchmark::DoNotOptimize(bits);
+    size = (size == 8 * KIBI) ? 32 : size * 2;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CruDataGeneratorBits);
+#endif
+
+/// Choosing the link of a push with all 24 links of a CRU in use, arg 0 is the policy. A superpage arrives for every
+/// push, with the links at different speeds, so the queues stay at a steady state.
+void BM_LinkScheduler(benchmark::State& state)
+{
+  constexpr size_t LINKS = 24;
+  constexpr size_t LINK_CAPACITY = Cru::MAX_SUPERPAGE_DESCRIPTORS;
+  auto policy = LinkScheduling::type(state.range(0));
+  Cru::LinkScheduler scheduler(policy, LINKS, LINK_CAPACITY);
+  std::array<size_t, LINKS> queued {};
+  size_t arrivalLink = 0;
+
+  // Fill the queues half way
+  for (size_t i = 0; i < (LINKS * LINK_CAPACITY) / 2; ++i) {
+    auto link = scheduler.getNextLinkIndex();
+    scheduler.pushed(link);
+    queued[link]++;
+  }
+
+  for (auto _ : state) {
+    auto link = scheduler.getNextLinkIndex();
+    scheduler.pushed(link);
+    queued[link]++;
+
+    // Faster links (lower indexes) get more of the arrivals
+    size_t candidate = (arrivalLink * arrivalLink) % LINKS;
+    arrivalLink = (arrivalLink + 1) % LINKS;
+    for (size_t i = 0; i < LINKS; ++i) {
+      size_t index = (candidate + i) % LINKS;
+      if (queued[index] > 0) {
+        queued[index]--;
+        scheduler.arrived(index);
+        break;
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LinkScheduler)->Arg(LinkScheduling::ShortestQueue)->Arg(LinkScheduling::Throughput);
+
+/// Scanning the CRORC Ready FIFO for arrived pages, arg 0 is the amount of arrived entries
+void BM_ReadyFifoScan(benchmark::State& state)
+{
+  ReadyFifo fifo;
+  fifo.reset();
+  for (int i = 0; i < state.range(0); ++i) {
+    fifo.entries[i].length = 2048;
+    fifo.entries[i].status = Ddl::DTSW;
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fifo.countArrived(0, READYFIFO_ENTRIES));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReadyFifoScan)->Arg(1)->Arg(16)->Arg(READYFIFO_ENTRIES);
+
+/// Reading out superpages of a buffer larger than the last-level cache, so the data is cold like after a DMA.
+/// Arg 0 is the prefetch distance in pages, arg 1 is 0 to verify the payload and 1 to copy it out.
+void BM_SuperpageReadout(benchmark::State& state)
+{
+  constexpr size_t PAGE_SIZE = 8 * KIBI;
+  constexpr size_t SUPERPAGE_SIZE = MEBI;
+  constexpr size_t BUFFER_SIZE = 512 * MEBI;
+  static auto data = makePages(BUFFER_SIZE / PAGE_SIZE, PAGE_SIZE);
+  const size_t distance = state.range(0);
+  const bool copy = state.range(1) != 0;
+  std::vector<char> output(PAGE_SIZE);
+  size_t offset = 0;
+
+  for (auto _ : state) {
+    uint64_t checksum = 0;
+    for (const auto& packet : Cru::SuperpageView(&data[offset], SUPERPAGE_SIZE, PAGE_SIZE, distance)) {
+      if (copy) {
+        std::memcpy(output.data(), packet.page, PAGE_SIZE);
+        benchmark::ClobberMemory();
+      } else {
+        const auto words = reinterpret_cast<const uint64_t*>(packet.page);
+        for (size_t i = 0; i < PAGE_SIZE / sizeof(uint64_t); ++i) {
+          checksum += words[i];
+        }
+      }
+    }
+    benchmark::DoNotOptimize(checksum);
+    offset = (offset + SUPERPAGE_SIZE) % BUFFER_SIZE;
+  }
+  state.SetBytesProcessed(state.iterations() * SUPERPAGE_SIZE);
+}
+BENCHMARK(BM_SuperpageReadout)->ArgsProduct({{0, 1, 2, 4, 8}, {0, 1}});
+
+/// CRC32C of a DMA page in the cache, with the implementation selected for this CPU
+void BM_PageChecksum(benchmark::State& state)
+{
+  const size_t pageSize = state.range(0);
+  std::vector<char> page(pageSize, 0x5a);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(PageChecksum::compute(page.data(), pageSize));
+  }
+  state.SetBytesProcessed(state.iterations() * pageSize);
+  state.SetLabel(PageChecksum::getImplementation());
+}
+BENCHMARK(BM_PageChecksum)->Arg(8 * KIBI)->Arg(MEBI);
+
+} // Anonymous namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,187 @@
+/// \file MonitorBar.cxx
+/// \brief Implementation of the MonitorBar class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "MonitorBar.h"
+#include <vector>
+#include "Crorc/Constants.h"
+#include "Cru/Constants.h"
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+
+constexpr size_t MonitorBar::REGISTER_READ_COST;
+constexpr size_t MonitorBar::DEFAULT_BUDGET;
+
+MonitorBar::MonitorBar(std::shared_ptr<BarInterface> bar, std::set<uint32_t> registers,
+    std::shared_ptr<PcieBudget> budget)
+    : mBar(std::move(bar)), mRegisters(std::move(registers)), mBudget(std::move(budget)),
+      mCardType(mBar->getCardType())
+{
+}
+
+std::set<uint32_t> MonitorBar::getDefaultRegisters(CardType::type cardType, int barIndex)
+{
+  if (cardType == CardType::Cru && barIndex == 0) {
+    std::set<uint32_t> registers {
+      Cru::Registers::FIRMWARE_COMPILE_INFO.index,
+      Cru::Registers::FIRMWARE_FEATURES.index,
+      Cru::Registers::FIRMWARE_CAPABILITIES.index};
+    for (int link = 0; link < Cru::MAX_LINKS; ++link) {
+      registers.insert(Cru::Registers::LINK_SUPERPAGES_PUSHED.get(link).index);
+    }
+    return registers;
+  }
+  if (cardType == CardType::Cru && barIndex == 2) {
+    return {
+      Cru::Registers::TEMPERATURE.index,
+      Cru::Registers::NUM_DROPPED_PACKETS.index,
+      Cru::Registers::CTP_CLOCK.index,
+      Cru::Registers::LOCAL_CLOCK.index,
+      Cru::Registers::WRAPPER0_LINKS.reg.index,
+      Cru::Registers::WRAPPER1_LINKS.reg.index,
+      Cru::Registers::FIRMWARE_GIT_HASH.index,
+      Cru::Registers::FIRMWARE_EPOCH.index,
+      Cru::Registers::FIRMWARE_DATE.index,
+      Cru::Registers::FIRMWARE_TIME.index,
+      Cru::Registers::FPGA_CHIP_HIGH.index,
+      Cru::Registers::FPGA_CHIP_LOW.index,
+      Cru::Registers::SERIAL_NUMBER.index};
+  }
+  if (cardType == CardType::Crorc) {
+    return {Rorc::RFID, Rorc::C_CSR};
+  }
+  return {};
+}
+
+void MonitorBar::checkRead(int index) const
+{
+  if (index < 0 || mRegisters.count(uint32_t(index)) == 0) {
+    BOOST_THROW_EXCEPTION(UnsafeReadAccess()
+        << ErrorInfo::Message("Register is not readable by a monitor BAR")
+        << ErrorInfo::Index(index)
+        << ErrorInfo::BarIndex(getIndex()));
+  }
+}
+
+void MonitorBar::charge(size_t registers)
+{
+  if (registers > 0) {
+    mBudget->charge(registers * REGISTER_READ_COST);
+  }
+}
+
+uint32_t MonitorBar::readRegister(int index)
+{
+  checkRead(index);
+  charge(1);
+  return mBar->readRegister(index);
+}
+
+void MonitorBar::readRegisters(int startIndex, uint32_t* values, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    checkRead(startIndex + int(i));
+  }
+  charge(count);
+  mBar->readRegisters(startIndex, values, count);
+}
+
+void MonitorBar::readRegisterSet(const int* indexes, uint32_t* values, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    checkRead(indexes[i]);
+  }
+  charge(count);
+  size_t begin = 0;
+  while (begin < count) {
+    size_t end = begin + 1;
+    while (end < count && indexes[end] == indexes[end - 1] + 1) {
+      ++end;
+    }
+    mBar->readRegisters(indexes[begin], values + begin, end - begin);
+    begin = end;
+  }
+}
+
+void MonitorBar::writeRegister(int index, uint32_t)
+{
+  BOOST_THROW_EXCEPTION(UnsafeWriteAccess()
+      << ErrorInfo::Message("Monitor BAR is read-only")
+      << ErrorInfo::Index(index)
+      << ErrorInfo::BarIndex(getIndex()));
+}
+
+void MonitorBar::writeRegisters(int startIndex, const uint32_t* values, size_t)
+{
+  writeRegister(startIndex, values[0]);
+}
+
+void MonitorBar::writeRegistersWide(int startIndex, const uint32_t* values, size_t)
+{
+  writeRegister(startIndex, values[0]);
+}
+
+// Only the CRU's getters read registers, the others give a constant
+
+boost::optional<int32_t> MonitorBar::getSerial()
+{
+  if (mCardType == CardType::Crorc) {
+    return {};
+  }
+  charge(mCardType == CardType::Cru ? 1 : 0);
+  return mBar->getSerial();
+}
+
+boost::optional<float> MonitorBar::getTemperature()
+{
+  charge(mCardType == CardType::Cru ? 1 : 0);
+  return mBar->getTemperature();
+}
+
+boost::optional<std::string> MonitorBar::getFirmwareInfo()
+{
+  charge(mCardType == CardType::Cru ? 3 : mCardType == CardType::Crorc ? 1 : 0);
+  return mBar->getFirmwareInfo();
+}
+
+boost::optional<std::string> MonitorBar::getCardId()
+{
+  charge(mCardType == CardType::Cru ? 2 : 0);
+  return mBar->getCardId();
+}
+
+int32_t MonitorBar::getDroppedPackets()
+{
+  charge(mCardType == CardType::Cru ? 1 : 0);
+  return mBar->getDroppedPackets();
+}
+
+uint32_t MonitorBar::getCTPClock()
+{
+  charge(mCardType == CardType::Cru ? 1 : 0);
+  return mBar->getCTPClock();
+}
+
+uint32_t MonitorBar::getLocalClock()
+{
+  charge(mCardType == CardType::Cru ? 1 : 0);
+  return mBar->getLocalClock();
+}
+
+int32_t MonitorBar::getLinks()
+{
+  charge(mCardType == CardType::Cru ? 2 : 0);
+  return mBar->getLinks();
+}
+
+int32_t MonitorBar::getLinksPerWrapper(uint32_t wrapper)
+{
+  charge(mCardType == CardType::Cru ? 1 : 0);
+  return mBar->getLinksPerWrapper(wrapper);
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,110 @@
+/// \file MonitorBar.h
+/// \brief Definition of the MonitorBar class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_MONITORBAR_H_
+#define ALICEO2_SRC_READOUTCARD_MONITORBAR_H_
+
+#include <memory>
+#include <set>
+#include "ReadoutCard/BarInterface.h"
+#include "PcieBudget.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// A read-only view of a BAR for monitoring, which can be opened next to the process that owns the card's DMA.
+///
+/// Only the whitelisted status registers can be read: other reads throw UnsafeReadAccess, and all writes throw
+/// UnsafeWriteAccess. The accesses are charged to a PCIe budget shared by all monitors of the card, and wait when it
+/// is used up, so however many monitoring processes there are, their BAR traffic stays within the budget and cannot
+/// take the link from the DMA. A call is charged once, before any of its registers is read, so reading several
+/// registers with readRegisters() or readRegisterSet() sends them back to back instead of spreading them over the
+/// waits.
+///
+/// The card-level getters (temperature, clocks, links, ...) read only status registers and are allowed, charged for
+/// the registers they read. The C-RORC's serial number is read from its flash through writes, so it's not available.
+///
+/// To instantiate it, use the ChannelFactory::getMonitorBar() method.
+class MonitorBar : public BarInterface
+{
+  public:
+    /// Approximate PCIe traffic of a 32-bit register read: a read request and a completion, with their headers
+    static constexpr size_t REGISTER_READ_COST = 52;
+
+    /// Default of the MonitorBudget parameter, in bytes per second
+    static constexpr size_t DEFAULT_BUDGET = 256 * 1024;
+
+    /// \param bar The BAR to monitor
+    /// \param registers Indexes of the registers that may be read
+    /// \param budget The PCIe budget of the card
+    MonitorBar(std::shared_ptr<BarInterface> bar, std::set<uint32_t> registers, std::shared_ptr<PcieBudget> budget);
+
+    /// Gets the registers of a BAR that are allowed by default: the status registers behind the card-level getters
+    static std::set<uint32_t> getDefaultRegisters(CardType::type cardType, int barIndex);
+
+    virtual uint32_t readRegister(int index) override;
+    virtual void writeRegister(int index, uint32_t value) override;
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count) override;
+    virtual void writeRegisters(int startIndex, const uint32_t* values, size_t count) override;
+    virtual void writeRegistersWide(int startIndex, const uint32_t* values, size_t count) override;
+
+    /// Reads registers that need not be consecutive. The budget is charged once, and runs of consecutive indexes are
+    /// read with the bulk read of the BAR.
+    /// \param indexes Indexes of the registers, must hold at least 'count' values
+    /// \param values Array to store the register values, must hold at least 'count' values
+    /// \param count The amount of registers to read
+    /// \throw UnsafeReadAccess if any of the registers is not whitelisted, before any is read
+    void readRegisterSet(const int* indexes, uint32_t* values, size_t count);
+
+    virtual int getIndex() const override
+    {
+      return mBar->getIndex();
+    }
+
+    virtual size_t getSize() const override
+    {
+      return mBar->getSize();
+    }
+
+    virtual CardType::type getCardType() override
+    {
+      return mCardType;
+    }
+
+    virtual boost::optional<int32_t> getSerial() override;
+    virtual boost::optional<float> getTemperature() override;
+    virtual boost::optional<std::string> getFirmwareInfo() override;
+    virtual boost::optional<std::string> getCardId() override;
+    virtual int32_t getDroppedPackets() override;
+    virtual uint32_t getCTPClock() override;
+    virtual uint32_t getLocalClock() override;
+    virtual int32_t getLinks() override;
+    virtual int32_t getLinksPerWrapper(uint32_t wrapper) override;
+
+    virtual BarStatistics getBarStatistics() override
+    {
+      return mBar->getBarStatistics();
+    }
+
+    /// Gets the registers that may be read
+    const std::set<uint32_t>& getRegisters() const
+    {
+      return mRegisters;
+    }
+
+  private:
+    void checkRead(int index) const;
+    void charge(size_t registers);
+
+    std::shared_ptr<BarInterface> mBar;
+    const std::set<uint32_t> mRegisters;
+    std::shared_ptr<PcieBudget> mBudget;
+    CardType::type mCardType;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_MONITORBAR_H_
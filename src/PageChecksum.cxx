@@ -0,0 +1,194 @@
+/// \file PageChecksum.cxx
+/// \brief Implementation of the PageChecksum class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/PageChecksum.h"
+#include <array>
+#include <cstring>
+#if defined(__x86_64__)
+# include <nmmintrin.h>
+# define ALICEO2_READOUTCARD_PAGECHECKSUM_X86
+#endif
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// CRC32C polynomial, bit-reflected
+constexpr uint32_t POLYNOMIAL = 0x82f63b78;
+
+/// Size of each of the three streams the SSE4.2 kernel interleaves. The crc32 instruction has a latency of three cycles
+/// and a throughput of one, so three independent streams keep it busy.
+constexpr size_t STREAM_SIZE = 256;
+
+struct Tables
+{
+    /// CRC of every byte value, for the scalar kernel
+    std::array<uint32_t, 256> bytes;
+    /// Advances a CRC state over STREAM_SIZE zero bytes, one table per state byte. This is linear in the state, so the
+    /// states of the streams can be joined with it.
+    std::array<std::array<uint32_t, 256>, 4> shift;
+};
+
+uint32_t updateByte(const Tables& tables, uint32_t state, uint8_t byte)
+{
+  return tables.bytes[(state ^ byte) & 0xff] ^ (state >> 8);
+}
+
+Tables makeTables()
+{
+  Tables tables;
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1) ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+    }
+    tables.bytes[i] = crc;
+  }
+
+  std::array<uint32_t, 32> bits;
+  for (int bit = 0; bit < 32; ++bit) {
+    uint32_t state = uint32_t(1) << bit;
+    for (size_t i = 0; i < STREAM_SIZE; ++i) {
+      state = updateByte(tables, state, 0);
+    }
+    bits[bit] = state;
+  }
+  for (int byte = 0; byte < 4; ++byte) {
+    for (uint32_t value = 0; value < 256; ++value) {
+      uint32_t shifted = 0;
+      for (int bit = 0; bit < 8; ++bit) {
+        if (value & (1 << bit)) {
+          shifted ^= bits[byte * 8 + bit];
+        }
+      }
+      tables.shift[byte][value] = shifted;
+    }
+  }
+  return tables;
+}
+
+const Tables& getTables()
+{
+  static const Tables tables = makeTables();
+  return tables;
+}
+
+uint32_t updateScalar(uint32_t state, const uint8_t* data, size_t size)
+{
+  const auto& tables = getTables();
+  for (size_t i = 0; i < size; ++i) {
+    state = updateByte(tables, state, data[i]);
+  }
+  return state;
+}
+
+#ifdef ALICEO2_READOUTCARD_PAGECHECKSUM_X86
+
+uint64_t load(const uint8_t* data)
+{
+  uint64_t word;
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+uint32_t shiftStream(const Tables& tables, uint32_t state)
+{
+  return tables.shift[0][state & 0xff] ^ tables.shift[1][(state >> 8) & 0xff] ^ tables.shift[2][(state >> 16) & 0xff]
+      ^ tables.shift[3][state >> 24];
+}
+
+__attribute__((target("sse4.2")))
+uint32_t updateSse42(uint32_t state, const uint8_t* data, size_t size)
+{
+  const auto& tables = getTables();
+  for (; size > 0 && (reinterpret_cast<uintptr_t>(data) % sizeof(uint64_t)) != 0; ++data, --size) {
+    state = _mm_crc32_u8(state, *data);
+  }
+
+  // The second and third streams start from 0, and the first is advanced over them when they are joined
+  for (; size >= 3 * STREAM_SIZE; data += 3 * STREAM_SIZE, size -= 3 * STREAM_SIZE) {
+    uint64_t first = state;
+    uint64_t second = 0;
+    uint64_t third = 0;
+    for (size_t i = 0; i < STREAM_SIZE; i += sizeof(uint64_t)) {
+      first = _mm_crc32_u64(first, load(data + i));
+      second = _mm_crc32_u64(second, load(data + STREAM_SIZE + i));
+      third = _mm_crc32_u64(third, load(data + 2 * STREAM_SIZE + i));
+    }
+    state = shiftStream(tables, shiftStream(tables, uint32_t(first)) ^ uint32_t(second)) ^ uint32_t(third);
+  }
+
+  uint64_t wide = state;
+  for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    wide = _mm_crc32_u64(wide, load(data));
+  }
+  state = uint32_t(wide);
+  for (; size > 0; ++data, --size) {
+    state = _mm_crc32_u8(state, *data);
+  }
+  return state;
+}
+
+#endif // ALICEO2_READOUTCARD_PAGECHECKSUM_X86
+
+using Kernel = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+struct Implementation
+{
+    Kernel kernel;
+    const char* name;
+};
+
+Implementation selectImplementation()
+{
+#ifdef ALICEO2_READOUTCARD_PAGECHECKSUM_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2")) {
+    return {updateSse42, "sse4.2"};
+  }
+#endif
+  return {updateScalar, "scalar"};
+}
+
+const Implementation& getSelectedImplementation()
+{
+  static const Implementation implementation = selectImplementation();
+  return implementation;
+}
+
+} // Anonymous namespace
+
+uint32_t PageChecksum::compute(const void* data, size_t size, uint32_t crc)
+{
+  return ~getSelectedImplementation().kernel(~crc, static_cast<const uint8_t*>(data), size);
+}
+
+size_t PageChecksum::computePages(const void* address, size_t received, size_t pageSize, uint32_t* checksums)
+{
+  const auto pages = received / pageSize;
+  for (size_t i = 0; i < pages; ++i) {
+    checksums[i] = compute(static_cast<const char*>(address) + i * pageSize, pageSize);
+  }
+  return pages;
+}
+
+size_t PageChecksum::findMismatch(const void* address, size_t received, size_t pageSize, const uint32_t* checksums)
+{
+  const auto pages = received / pageSize;
+  for (size_t i = 0; i < pages; ++i) {
+    if (compute(static_cast<const char*>(address) + i * pageSize, pageSize) != checksums[i]) {
+      return i;
+    }
+  }
+  return pages;
+}
+
+const char* PageChecksum::getImplementation()
+{
+  return getSelectedImplementation().name;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,31 @@
+/// \file LinkScheduling.cxx
+/// \brief Implementation of the LinkScheduling enum and supporting functions.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/ParameterTypes/LinkScheduling.h"
+#include "Utilities/Enum.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+static const auto converter = Utilities::makeEnumConverter<LinkScheduling::type>("LinkScheduling", {
+  { LinkScheduling::ShortestQueue, "SHORTEST_QUEUE" },
+  { LinkScheduling::Throughput, "THROUGHPUT" },
+});
+
+} // Anonymous namespace
+
+std::string LinkScheduling::toString(const LinkScheduling::type& scheduling)
+{
+  return converter.toString(scheduling);
+}
+
+LinkScheduling::type LinkScheduling::fromString(const std::string& string)
+{
+  return converter.fromString(string);
+}
+
+} // namespace roc
+} // namespace AliceO2
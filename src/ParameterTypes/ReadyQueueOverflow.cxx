@@ -0,0 +1,32 @@
+/// \file ReadyQueueOverflow.cxx
+/// \brief Implementation of the ReadyQueueOverflow enum and supporting functions.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/ParameterTypes/ReadyQueueOverflow.h"
+#include "Utilities/Enum.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+static const auto converter = Utilities::makeEnumConverter<ReadyQueueOverflow::type>("ReadyQueueOverflow", {
+  { ReadyQueueOverflow::Block, "BLOCK" },
+  { ReadyQueueOverflow::Grow, "GROW" },
+  { ReadyQueueOverflow::DropOldest, "DROP_OLDEST" },
+});
+
+} // Anonymous namespace
+
+std::string ReadyQueueOverflow::toString(const ReadyQueueOverflow::type& overflow)
+{
+  return converter.toString(overflow);
+}
+
+ReadyQueueOverflow::type ReadyQueueOverflow::fromString(const std::string& string)
+{
+  return converter.fromString(string);
+}
+
+} // namespace roc
+} // namespace AliceO2
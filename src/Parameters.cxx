@@ -20,7 +20,11 @@ namespace roc {
 /// Variant used for internal storage of parameters
 using Variant = boost::variant<size_t, int32_t, bool, Parameters::BufferParametersType, Parameters::CardIdType,
   Parameters::GeneratorLoopbackType, Parameters::GeneratorPatternType, Parameters::ReadoutModeType,
-  Parameters::LinkMaskType>;
+  Parameters::LinkMaskType,
+  Parameters::WaitSpinTimeType,
+  Parameters::LinkSchedulingType,
+  Parameters::ReadyQueueOverflowType,
+  std::string>;
 
 using KeyType = const char*;
 
@@ -110,6 +114,36 @@ _PARAMETER_FUNCTIONS(GeneratorPattern, "generator_pattern")
 _PARAMETER_FUNCTIONS(GeneratorRandomSizeEnabled, "generator_random_size_enabled")
 _PARAMETER_FUNCTIONS(ReadoutMode, "readout_mode")
 _PARAMETER_FUNCTIONS(LinkMask, "link_mask")
+_PARAMETER_FUNCTIONS(DriverThreadEnabled, "driver_thread_enabled")
+_PARAMETER_FUNCTIONS(DriverThreadCpu, "driver_thread_cpu")
+_PARAMETER_FUNCTIONS(DriverThreadCacheGroup, "driver_thread_cache_group")
+_PARAMETER_FUNCTIONS(WaitSpinTime, "wait_spin_time")
+_PARAMETER_FUNCTIONS(InterruptEnabled, "interrupt_enabled")
+_PARAMETER_FUNCTIONS(StatusPageEnabled, "status_page_enabled")
+_PARAMETER_FUNCTIONS(LinkScheduling, "link_scheduling")
+_PARAMETER_FUNCTIONS(WarmRestartEnabled, "warm_restart_enabled")
+_PARAMETER_FUNCTIONS(WriteCombiningEnabled, "write_combining_enabled")
+_PARAMETER_FUNCTIONS(FirmwareCapabilitiesEnabled, "firmware_capabilities_enabled")
+_PARAMETER_FUNCTIONS(RegisterShadowingEnabled, "register_shadowing_enabled")
+_PARAMETER_FUNCTIONS(SdhEventSizeEnabled, "sdh_event_size_enabled")
+_PARAMETER_FUNCTIONS(ReadyFifoInBuffer, "ready_fifo_in_buffer")
+_PARAMETER_FUNCTIONS(SuperpageQueueCapacity, "superpage_queue_capacity")
+_PARAMETER_FUNCTIONS(BufferRegistrationRetained, "buffer_registration_retained")
+_PARAMETER_FUNCTIONS(BufferDumpExcluded, "buffer_dump_excluded")
+_PARAMETER_FUNCTIONS(ReplayFile, "replay_file")
+_PARAMETER_FUNCTIONS(ReplayRate, "replay_rate")
+_PARAMETER_FUNCTIONS(DummyLinkBandwidth, "dummy_link_bandwidth")
+_PARAMETER_FUNCTIONS(SuperpageFlushTimeout, "superpage_flush_timeout")
+_PARAMETER_FUNCTIONS(PackedPacketsEnabled, "packed_packets_enabled")
+_PARAMETER_FUNCTIONS(AsyncLoggingEnabled, "async_logging_enabled")
+_PARAMETER_FUNCTIONS(StatisticsPublishingEnabled, "statistics_publishing_enabled")
+_PARAMETER_FUNCTIONS(DummyBarReadLatency, "dummy_bar_read_latency")
+_PARAMETER_FUNCTIONS(DummyBarWriteLatency, "dummy_bar_write_latency")
+_PARAMETER_FUNCTIONS(ReadyQueueCapacity, "ready_queue_capacity")
+_PARAMETER_FUNCTIONS(ReadyQueueOverflow, "ready_queue_overflow")
+_PARAMETER_FUNCTIONS(SynchronizedStartChannels, "synchronized_start_channels")
+_PARAMETER_FUNCTIONS(MonitorRegisters, "monitor_registers")
+_PARAMETER_FUNCTIONS(MonitorBudget, "monitor_budget")
 #undef _PARAMETER_FUNCTIONS
 
 Parameters::Parameters() : mPimpl(std::make_unique<ParametersPimpl>())
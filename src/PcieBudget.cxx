@@ -0,0 +1,62 @@
+/// \file PcieBudget.cxx
+/// \brief Implementation of the PcieBudget class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "PcieBudget.h"
+#include <algorithm>
+#include <thread>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+constexpr size_t FILE_SIZE = 4 * 1024;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The budget is shared between processes, its atomic must be lock-free");
+
+int64_t now()
+{
+  // The steady clock is CLOCK_MONOTONIC, which is the same in every process of the system
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // Anonymous namespace
+
+PcieBudget::PcieBudget(const std::string& path, size_t bytesPerSecond, size_t burst)
+    : mFile(path, FILE_SIZE), mShared(reinterpret_cast<Shared*>(mFile.getAddress())), mBytesPerSecond(bytesPerSecond)
+{
+  if (bytesPerSecond == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("PCIe budget must not be 0")
+        << ErrorInfo::FileName(path));
+  }
+  mBurstNanoseconds = int64_t(burst) * 1000000000 / int64_t(bytesPerSecond);
+}
+
+std::string PcieBudget::getPath(const std::string& cardKey)
+{
+  return "/dev/shm/AliceO2_RoC_" + cardKey + "_PcieBudget";
+}
+
+std::chrono::nanoseconds PcieBudget::reserve(size_t bytes)
+{
+  const int64_t cost = int64_t(bytes) * 1000000000 / int64_t(mBytesPerSecond);
+  int64_t time = now();
+  int64_t arrival = mShared->arrival.load(std::memory_order_relaxed);
+  int64_t next;
+  do {
+    next = std::max(arrival, time) + cost;
+  } while (!mShared->arrival.compare_exchange_weak(arrival, next, std::memory_order_relaxed));
+  return std::chrono::nanoseconds(std::max<int64_t>(0, next - time - mBurstNanoseconds));
+}
+
+void PcieBudget::charge(size_t bytes)
+{
+  auto wait = reserve(bytes);
+  if (wait.count() > 0) {
+    std::this_thread::sleep_for(wait);
+  }
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,70 @@
+/// \file PcieBudget.h
+/// \brief Definition of the PcieBudget class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_PCIEBUDGET_H_
+#define ALICEO2_SRC_READOUTCARD_PCIEBUDGET_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ReadoutCard/MemoryMappedFile.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Rate limit of the PCIe traffic of a card, shared by all processes that use the same file.
+///
+/// The limit is a token bucket, kept as the theoretical arrival time of the next access (the generic cell rate
+/// algorithm): an access moves it ahead by its cost in time, and the caller sleeps for as long as it is more than the
+/// burst tolerance ahead of now. It's a single atomic in shared memory on the system-wide monotonic clock, so processes
+/// share the budget without locking, and a process that dies in the middle leaves nothing behind. The file starts out
+/// zeroed, which is a full bucket.
+///
+/// Each user charges at its own rate, so all users of a card should be given the same one.
+class PcieBudget
+{
+  public:
+    /// \param path Path of the shared file, see getPath()
+    /// \param bytesPerSecond The budget
+    /// \param burst The amount of bytes that may go out at once after the budget was left unused
+    PcieBudget(const std::string& path, size_t bytesPerSecond, size_t burst);
+
+    /// Gets the path of the shared file of a card
+    /// \param cardKey Key of the card, such as its PCI address
+    static std::string getPath(const std::string& cardKey);
+
+    /// Charges an access to the budget, sleeping until the budget allows it
+    /// \param bytes The cost of the access in bytes
+    void charge(size_t bytes);
+
+    /// Charges an access to the budget, without sleeping
+    /// \param bytes The cost of the access in bytes
+    /// \return The time to sleep before the access is within the budget
+    std::chrono::nanoseconds reserve(size_t bytes);
+
+    size_t getBytesPerSecond() const
+    {
+      return mBytesPerSecond;
+    }
+
+  private:
+    struct Shared
+    {
+        /// Theoretical arrival time in nanoseconds of the monotonic clock
+        std::atomic<int64_t> arrival;
+    };
+
+    MemoryMappedFile mFile;
+    Shared* mShared;
+    size_t mBytesPerSecond;
+    int64_t mBurstNanoseconds;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_PCIEBUDGET_H_
@@ -5,8 +5,12 @@
 
 #include "PdaBar.h"
 
+#include <cstring>
 #include <limits>
 #include <string>
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
 #include <boost/lexical_cast.hpp>
 
 #include "ReadoutCard/Exception.h"
@@ -17,6 +21,9 @@ namespace Pda {
 
 PdaBar::PdaBar() : mPdaBar(nullptr), mBarLength(-1), mBarNumber(-1), mUserspaceAddress(0)
 {
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  mStatistics = std::make_shared<PdaBarStatistics>(mBarNumber);
+#endif
 }
 
 PdaBar::PdaBar(PdaDevice::PdaPciDevice pciDevice, int barNumberInt) : mBarNumber(barNumberInt)
@@ -44,6 +51,101 @@ PdaBar::PdaBar(PdaDevice::PdaPciDevice pciDevice, int barNumberInt) : mBarNumber
         << ErrorInfo::ChannelNumber(barNumber));
   }
   mUserspaceAddress = reinterpret_cast<uintptr_t>(address);
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  mStatistics = std::make_shared<PdaBarStatistics>(mBarNumber);
+#endif
+}
+
+void PdaBar::readRegisterBlock(int index, uint32_t* values, size_t count) const
+{
+  uintptr_t byteOffset = index * sizeof(uint32_t);
+  if (count == 0) {
+    return;
+  }
+  assertRange<uint32_t>(byteOffset + (count - 1) * sizeof(uint32_t));
+
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  auto start = PdaBarStatistics::getCycles();
+#endif
+  auto address = reinterpret_cast<volatile uint32_t*>(getOffsetAddress(byteOffset));
+  size_t i = 0;
+#if defined(__SSE2__)
+  // Single registers until the address is 16-byte aligned
+  while (i < count && (reinterpret_cast<uintptr_t>(address + i) % 16) != 0) {
+    values[i] = address[i];
+    ++i;
+  }
+  // 4 registers per load
+  for (; (i + 4) <= count; i += 4) {
+    auto block = _mm_load_si128(const_cast<const __m128i*>(reinterpret_cast<volatile __m128i*>(address + i)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), block);
+  }
+#endif
+  for (; i < count; ++i) {
+    values[i] = address[i];
+  }
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  mStatistics->addReads(index, count, PdaBarStatistics::getCycles() - start);
+#endif
+}
+
+void PdaBar::writeRegisterBlock(int index, const uint32_t* values, size_t count) const
+{
+  uintptr_t byteOffset = index * sizeof(uint32_t);
+  if (count == 0) {
+    return;
+  }
+  assertRange<uint32_t>(byteOffset + (count - 1) * sizeof(uint32_t));
+
+  // Plain 32-bit stores, since the firmware may act on every single register write
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  auto start = PdaBarStatistics::getCycles();
+#endif
+  auto address = reinterpret_cast<volatile uint32_t*>(getOffsetAddress(byteOffset));
+  for (size_t i = 0; i < count; ++i) {
+    address[i] = values[i];
+  }
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  mStatistics->addWrites(index, count, PdaBarStatistics::getCycles() - start);
+#endif
+}
+
+void PdaBar::writeRegisterBlockWide(int index, const uint32_t* values, size_t count) const
+{
+  uintptr_t byteOffset = index * sizeof(uint32_t);
+  if (count == 0) {
+    return;
+  }
+  assertRange<uint32_t>(byteOffset + (count - 1) * sizeof(uint32_t));
+
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  auto start = PdaBarStatistics::getCycles();
+#endif
+  auto address = reinterpret_cast<volatile uint32_t*>(getOffsetAddress(byteOffset));
+  size_t i = 0;
+  while (i < count) {
+    auto alignment = reinterpret_cast<uintptr_t>(address + i);
+#if defined(__SSE2__)
+    if ((i + 4) <= count && (alignment % 16) == 0) {
+      _mm_store_si128(const_cast<__m128i*>(reinterpret_cast<volatile __m128i*>(address + i)),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+      i += 4;
+      continue;
+    }
+#endif
+    if ((i + 2) <= count && (alignment % 8) == 0) {
+      uint64_t word;
+      std::memcpy(&word, values + i, sizeof(word));
+      *reinterpret_cast<volatile uint64_t*>(address + i) = word;
+      i += 2;
+      continue;
+    }
+    address[i] = values[i];
+    ++i;
+  }
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+  mStatistics->addWrites(index, count, PdaBarStatistics::getCycles() - start);
+#endif
 }
 
 } // namespace Pda
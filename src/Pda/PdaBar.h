@@ -7,9 +7,14 @@
 #define ALICEO2_SRC_READOUTCARD_PDA_PDABAR_H_
 
 #include "ReadoutCard/BarInterface.h"
+#include "ReadoutCard/BarStatistics.h"
 #include <pda.h>
 #include "PdaDevice.h"
 #include "ExceptionInternal.h"
+#include "Register.h"
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+# include "Pda/PdaBarStatistics.h"
+#endif
 #ifndef NDEBUG
 # include <boost/type_index.hpp>
 #endif
@@ -36,6 +41,40 @@ class PdaBar : public BarInterface
       barWrite<uint32_t>(index * sizeof(uint32_t), value);
     }
 
+    /// Reads a block of consecutive registers. Where alignment allows, 128-bit loads are used, so that the block is
+    /// read with a few PCIe read requests instead of one per register.
+    /// \param index Index of the first register
+    /// \param values Array to store the register values
+    /// \param count Amount of registers to read
+    void readRegisterBlock(int index, uint32_t* values, size_t count) const;
+
+    /// Writes a block of consecutive registers, in order of increasing index, with a single range check
+    /// \param index Index of the first register
+    /// \param values Array of the values to write
+    /// \param count Amount of registers to write
+    void writeRegisterBlock(int index, const uint32_t* values, size_t count) const;
+
+    /// Writes a block of consecutive registers with 128-bit and 64-bit stores where alignment allows
+    /// \param index Index of the first register
+    /// \param values Array of the values to write
+    /// \param count Amount of registers to write
+    void writeRegisterBlockWide(int index, const uint32_t* values, size_t count) const;
+
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count) override
+    {
+      readRegisterBlock(startIndex, values, count);
+    }
+
+    virtual void writeRegisters(int startIndex, const uint32_t* values, size_t count) override
+    {
+      writeRegisterBlock(startIndex, values, count);
+    }
+
+    virtual void writeRegistersWide(int startIndex, const uint32_t* values, size_t count) override
+    {
+      writeRegisterBlockWide(startIndex, values, count);
+    }
+
     virtual int getIndex() const override
     {
       return mBarNumber;
@@ -51,6 +90,68 @@ class PdaBar : public BarInterface
       return CardType::Unknown;
     }
 
+    /// Handle to a single 32-bit register of the BAR, resolved to a raw pointer. The range is checked once when the
+    /// handle is made, so reads and writes are inlineable volatile accesses without range check or virtual dispatch.
+    /// Meant for the DMA hot path. The handle must not outlive the PdaBar it was made from.
+    class RegisterHandle
+    {
+      public:
+        RegisterHandle() : mAddress(nullptr)
+        {
+        }
+
+        uint32_t read() const
+        {
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+          auto start = PdaBarStatistics::getCycles();
+          uint32_t value = *mAddress;
+          mStatistics->addReads(mIndex, 1, PdaBarStatistics::getCycles() - start);
+          return value;
+#else
+          return *mAddress;
+#endif
+        }
+
+        void write(uint32_t value) const
+        {
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+          auto start = PdaBarStatistics::getCycles();
+          *mAddress = value;
+          mStatistics->addWrites(mIndex, 1, PdaBarStatistics::getCycles() - start);
+#else
+          *mAddress = value;
+#endif
+        }
+
+      private:
+        friend class PdaBar;
+
+        explicit RegisterHandle(volatile uint32_t* address) : mAddress(address)
+        {
+        }
+
+        volatile uint32_t* mAddress;
+
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+        PdaBarStatistics* mStatistics = nullptr;
+        size_t mIndex = 0;
+#endif
+    };
+
+    /// Makes a handle for unchecked access to a register
+    /// \param reg The register
+    /// \return The handle
+    RegisterHandle getRegisterHandle(Register reg) const
+    {
+      assertRange<uint32_t>(reg.address);
+      RegisterHandle handle(reinterpret_cast<volatile uint32_t*>(getOffsetAddress(reg.address)));
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+      handle.mStatistics = mStatistics.get();
+      handle.mIndex = reg.index;
+#endif
+      return handle;
+    }
+
     template<typename T>
     void barWrite(uintptr_t byteOffset, const T &value) const
     {
@@ -60,7 +161,13 @@ class PdaBar : public BarInterface
 //      std::fflush(stdout);
 //#endif
       assertRange<T>(byteOffset);
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+      auto start = PdaBarStatistics::getCycles();
       memcpy(getOffsetAddress(byteOffset), &value, sizeof(T));
+      mStatistics->addWrites(byteOffset / sizeof(uint32_t), 1, PdaBarStatistics::getCycles() - start);
+#else
+      memcpy(getOffsetAddress(byteOffset), &value, sizeof(T));
+#endif
     }
 
     template<typename T>
@@ -73,7 +180,13 @@ class PdaBar : public BarInterface
 //#endif
       assertRange<T>(byteOffset);
       T value;
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+      auto start = PdaBarStatistics::getCycles();
       memcpy(&value, getOffsetAddress(byteOffset), sizeof(T));
+      mStatistics->addReads(byteOffset / sizeof(uint32_t), 1, PdaBarStatistics::getCycles() - start);
+#else
+      memcpy(&value, getOffsetAddress(byteOffset), sizeof(T));
+#endif
 //#ifndef NDEBUG
 //      std::printf("PdaBar::barRead<%s>(address=0x%lx) -> 0x%x\n",
 //                  boost::typeindex::type_id<T>().pretty_name().c_str(), byteOffset, value);
@@ -137,6 +250,17 @@ class PdaBar : public BarInterface
       return 0;
     }
 
+    /// Gets the access statistics of the registers of this BAR.
+    /// Always empty unless built with ALICEO2_READOUTCARD_BAR_STATISTICS.
+    virtual BarStatistics getBarStatistics() override
+    {
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+      return mStatistics->get();
+#else
+      return {};
+#endif
+    }
+
   private:
     template<typename T>
     bool isInRange(size_t offset) const
@@ -171,6 +295,11 @@ class PdaBar : public BarInterface
 
     /// Userspace addresses of the mapped BARs
     uintptr_t mUserspaceAddress;
+
+#ifdef ALICEO2_READOUTCARD_BAR_STATISTICS
+    /// Register access counters
+    std::shared_ptr<PdaBarStatistics> mStatistics;
+#endif
 };
 
 } // namespace Pda
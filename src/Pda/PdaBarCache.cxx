@@ -0,0 +1,62 @@
+/// \file PdaBarCache.cxx
+/// \brief Implementation of the PdaBarCache class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "Pda/PdaBarCache.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+namespace {
+
+/// The cache, keyed by PCI address and BAR number
+struct Cache
+{
+    std::mutex mutex;
+    std::map<std::pair<std::string, int>, std::shared_ptr<PdaBar>> bars;
+};
+
+Cache& getCache()
+{
+  static Cache cache;
+  return cache;
+}
+
+} // Anonymous namespace
+
+std::shared_ptr<PdaBar> PdaBarCache::getBar(PdaDevice::PdaPciDevice pciDevice, const PciAddress& pciAddress,
+    int barNumber)
+{
+  auto& cache = getCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto& bar = cache.bars[std::make_pair(pciAddress.toString(), barNumber)];
+  if (!bar) {
+    try {
+      bar = std::make_shared<PdaBar>(pciDevice, barNumber);
+    }
+    catch (...) {
+      cache.bars.erase(std::make_pair(pciAddress.toString(), barNumber));
+      throw;
+    }
+  }
+  return bar;
+}
+
+void PdaBarCache::clear()
+{
+  auto& cache = getCache();
+  decltype(cache.bars) cleared;
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cleared.swap(cache.bars);
+  }
+}
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
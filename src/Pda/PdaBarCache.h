@@ -0,0 +1,36 @@
+/// \file PdaBarCache.h
+/// \brief Definition of the PdaBarCache class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_PDA_PDABARCACHE_H_
+#define ALICEO2_SRC_READOUTCARD_PDA_PDABARCACHE_H_
+
+#include <memory>
+#include "Pda/PdaBar.h"
+#include "Pda/PdaDevice.h"
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+/// Process-wide cache of the BAR mappings. Every BAR of a card is mapped once, and the mapping is shared by all
+/// BarInterface objects and DMA channels of the process opened on it, so opening them again doesn't need to map it
+/// again. Note that the BarStatistics of a shared mapping count the accesses of all its users.
+class PdaBarCache
+{
+  public:
+    /// Gets the mapping of the BAR of the card, mapping it if it's not cached yet
+    static std::shared_ptr<PdaBar> getBar(PdaDevice::PdaPciDevice pciDevice, const PciAddress& pciAddress,
+        int barNumber);
+
+    /// Drops the cached mappings. They are unmapped when their last user is gone.
+    static void clear();
+};
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_PDA_PDABARCACHE_H_
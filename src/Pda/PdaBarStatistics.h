@@ -0,0 +1,122 @@
+/// \file PdaBarStatistics.h
+/// \brief Definition of the PdaBarStatistics class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_PDA_PDABARSTATISTICS_H_
+#define ALICEO2_SRC_READOUTCARD_PDA_PDABARSTATISTICS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ReadoutCard/BarStatistics.h"
+#include "Utilities/Timestamp.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+/// Counts the reads, writes and cycles spent per register of a BAR. Only used when ReadoutCard is built with
+/// ALICEO2_READOUTCARD_BAR_STATISTICS.
+/// The registers are kept in a fixed-size open addressing table, so counting is lock-free and allocation-free: a few
+/// relaxed atomic additions per access. If more distinct registers are accessed than the table can hold, the
+/// accesses to the excess registers are not counted.
+class PdaBarStatistics
+{
+  public:
+    /// \param barIndex Index of the BAR, reported in the statistics
+    PdaBarStatistics(int barIndex) : mBarIndex(barIndex), mSlots(new Slot[SLOTS])
+    {
+    }
+
+    /// Gets the current CPU timestamp counter value
+    static uint64_t getCycles()
+    {
+      return Utilities::getTimestampCounter();
+    }
+
+    /// Counts reads of the registers [index, index + count), sharing the cycles between them
+    void addReads(size_t index, size_t count, uint64_t cycles)
+    {
+      for (size_t i = 0; i < count; ++i) {
+        if (auto slot = getSlot(index + i)) {
+          slot->reads.fetch_add(1, std::memory_order_relaxed);
+          slot->cycles.fetch_add(cycles / count, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// Counts writes of the registers [index, index + count), sharing the cycles between them
+    void addWrites(size_t index, size_t count, uint64_t cycles)
+    {
+      for (size_t i = 0; i < count; ++i) {
+        if (auto slot = getSlot(index + i)) {
+          slot->writes.fetch_add(1, std::memory_order_relaxed);
+          slot->cycles.fetch_add(cycles / count, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// Gets the statistics of all registers that were accessed
+    BarStatistics get() const
+    {
+      BarStatistics statistics;
+      for (size_t i = 0; i < SLOTS; ++i) {
+        const auto& slot = mSlots[i];
+        auto index = slot.index.load(std::memory_order_acquire);
+        if (index != EMPTY) {
+          statistics.push_back({mBarIndex, uintptr_t(index) * sizeof(uint32_t),
+              slot.reads.load(std::memory_order_relaxed), slot.writes.load(std::memory_order_relaxed),
+              slot.cycles.load(std::memory_order_relaxed)});
+        }
+      }
+      return statistics;
+    }
+
+  private:
+    /// Amount of distinct registers that can be counted. Must be a power of 2.
+    static constexpr size_t SLOTS = 4096;
+
+    /// Register index of an unused slot
+    static constexpr uint32_t EMPTY = 0xffffffff;
+
+    struct Slot
+    {
+      std::atomic<uint32_t> index { EMPTY };
+      std::atomic<uint64_t> reads { 0 };
+      std::atomic<uint64_t> writes { 0 };
+      std::atomic<uint64_t> cycles { 0 };
+    };
+
+    /// Finds or claims the slot of a register
+    /// \return The slot, or nullptr if the table is full
+    Slot* getSlot(size_t registerIndex)
+    {
+      auto index = uint32_t(registerIndex);
+      auto hash = size_t((uint64_t(index) * 0x9e3779b97f4a7c15ULL) >> 32);
+      for (size_t probe = 0; probe < SLOTS; ++probe) {
+        auto& slot = mSlots[(hash + probe) & (SLOTS - 1)];
+        auto current = slot.index.load(std::memory_order_relaxed);
+        if (current == index) {
+          return &slot;
+        }
+        if (current == EMPTY) {
+          if (slot.index.compare_exchange_strong(current, index, std::memory_order_acq_rel)
+              || current == index) {
+            return &slot;
+          }
+        }
+      }
+      return nullptr;
+    }
+
+    const int mBarIndex;
+    std::unique_ptr<Slot[]> mSlots;
+};
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_PDA_PDABARSTATISTICS_H_
@@ -6,6 +6,7 @@
 #include "PdaDevice.h"
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <pda.h>
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
@@ -27,6 +28,43 @@ namespace Pda {
 namespace b = boost;
 namespace bfs = boost::filesystem;
 
+namespace {
+
+/// Devices in use, keyed by vendor and device ID
+struct DeviceCache
+{
+    std::mutex mutex;
+    std::map<std::string, std::weak_ptr<PdaDevice>> devices;
+};
+
+DeviceCache& getDeviceCache()
+{
+  static DeviceCache cache;
+  return cache;
+}
+
+} // Anonymous namespace
+
+PdaDevice::SharedPdaDevice PdaDevice::getPdaDevice(const PciId& pciId)
+{
+  auto& cache = getDeviceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto& entry = cache.devices[pciId.getVendorId() + " " + pciId.getDeviceId()];
+  auto device = entry.lock();
+  if (!device) {
+    device = std::make_shared<PdaDevice>(pciId);
+    entry = device;
+  }
+  return device;
+}
+
+void PdaDevice::invalidateDeviceCache()
+{
+  auto& cache = getDeviceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.devices.clear();
+}
+
 PdaDevice::PdaDevice(const PciId& pciId) : mDeviceOperator(nullptr)
 {
   try {
@@ -87,6 +125,18 @@ int PdaDevice::getPciDeviceCount()
   return deviceCount;
 }
 
+PciAddress PdaDevice::PdaPciDevice::getPciAddress() const
+{
+  uint8_t busId;
+  uint8_t deviceId;
+  uint8_t functionId;
+  if (PciDevice_getBusID(mPciDevice, &busId) || PciDevice_getDeviceID(mPciDevice, &deviceId)
+      || PciDevice_getFunctionID(mPciDevice, &functionId)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to retrieve device address"));
+  }
+  return PciAddress(busId, deviceId, functionId);
+}
+
 } // namespace Pda
 } // namespace roc
 } // namespace AliceO2
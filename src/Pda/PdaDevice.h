@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include <pda.h>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
 #include "ReadoutCard/PciId.h"
 
 namespace AliceO2 {
@@ -53,6 +54,10 @@ class PdaDevice
         {
           return mPciDevice;
         }
+
+        /// Gets the PCI address of the device
+        PciAddress getPciAddress() const;
+
       private:
         PciDevice* mPciDevice;
         SharedPdaDevice mPdaDevice;
@@ -60,10 +65,13 @@ class PdaDevice
 
     PdaDevice(const PciId& pciId);
 
-    static SharedPdaDevice getPdaDevice(const PciId& pciId)
-    {
-      return std::make_shared<PdaDevice>(pciId);
-    }
+    /// Gets the device of the PCI ID. As long as it's in use, the same device is handed out within the process, so the
+    /// PDA DeviceOperator is only made once.
+    static SharedPdaDevice getPdaDevice(const PciId& pciId);
+
+    /// Makes the next getPdaDevice() calls enumerate the devices again, instead of reusing the ones in use. Use it after
+    /// cards were added or removed.
+    static void invalidateDeviceCache();
 
     static PdaDeviceOperator getDeviceOperator(SharedPdaDevice pdaDevice)
     {
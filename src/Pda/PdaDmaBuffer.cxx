@@ -5,6 +5,8 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 #include "PdaDmaBuffer.h"
+#include <algorithm>
+#include <memory>
 #include <pda.h>
 #include <InfoLogger/InfoLogger.hxx>
 #include "ExceptionInternal.h"
@@ -18,9 +20,12 @@ namespace Pda {
 PdaDmaBuffer::PdaDmaBuffer(PdaDevice::PdaPciDevice pciDevice, void* userBufferAddress, size_t userBufferSize,
     int dmaBufferId, bool requireHugepage) : mPciDevice(pciDevice)
 {
-  // Safeguard against PDA kernel module deadlocks, since it does not like parallel buffer registration
+  // Safeguard against PDA kernel module deadlocks, since it does not like parallel buffer registration.
+  // The lock is held until the constructor returns, so channels of the device opened concurrently register one at a
+  // time. Other devices have their own lock.
+  std::unique_ptr<Pda::PdaLock> lock;
   try {
-    Pda::PdaLock lock{};
+    lock = std::make_unique<Pda::PdaLock>(mPciDevice.getPciAddress());
   } catch (const LockException& e) {
     InfoLogger::InfoLogger() << "Failed to acquire PDA lock" << e.what() << InfoLogger::InfoLogger::endm;
     throw;
@@ -94,6 +99,8 @@ PdaDmaBuffer::PdaDmaBuffer(PdaDevice::PdaPciDevice pciDevice, void* userBufferAd
       BOOST_THROW_EXCEPTION(PdaException() << ErrorInfo::Message(
         "Failed to initialize scatter-gather list, was empty"));
     }
+
+    mIndex = ScatterGatherIndex(mScatterGatherVector);
   }
   catch (const PdaException& ) {
     PciDevice_deleteDMABuffer(mPciDevice.get(), mDmaBuffer);
@@ -105,8 +112,9 @@ PdaDmaBuffer::~PdaDmaBuffer()
 {
   // Safeguard against PDA kernel module deadlocks, since it does not like parallel buffer registration
   // NOTE: not sure if necessary for deregistration as well
+  std::unique_ptr<Pda::PdaLock> lock;
   try {
-    Pda::PdaLock lock{};
+    lock = std::make_unique<Pda::PdaLock>(mPciDevice.getPciAddress());
   } catch (const LockException& e) {
     InfoLogger::InfoLogger() << "Failed to acquire PDA lock" << e.what() << InfoLogger::InfoLogger::endm;
     throw;
@@ -122,29 +130,7 @@ PdaDmaBuffer::~PdaDmaBuffer()
 
 uintptr_t PdaDmaBuffer::getBusOffsetAddress(size_t offset) const
 {
-  const auto& list = mScatterGatherVector;
-
-  auto userBase = list.at(0).addressUser;
-  auto userWithOffset = userBase + offset;
-
-  // First we find the SGL entry that contains our address
-  for (size_t i = 0; i < list.size(); ++i) {
-    auto entryUserStartAddress = list[i].addressUser;
-    auto entryUserEndAddress = entryUserStartAddress + list[i].size;
-
-    if ((userWithOffset >= entryUserStartAddress) && (userWithOffset < entryUserEndAddress)) {
-      // This is the entry we need
-      // We now need to calculate the difference from the start of this entry to the given offset. We make use of the
-      // fact that the userspace addresses will be contiguous
-      auto entryOffset = userWithOffset - entryUserStartAddress;
-      auto offsetBusAddress = list[i].addressBus + entryOffset;
-      return offsetBusAddress;
-    }
-  }
-
-  BOOST_THROW_EXCEPTION(Exception()
-      << ErrorInfo::Message("Physical offset address out of range")
-      << ErrorInfo::Offset(offset));
+  return mIndex.getBusOffsetAddress(offset);
 }
 
 } // namespace Pda
@@ -6,9 +6,11 @@
 #ifndef ALICEO2_SRC_READOUTCARD_PDA_PDADMABUFFER_H_
 #define ALICEO2_SRC_READOUTCARD_PDA_PDADMABUFFER_H_
 
+#include <cstdint>
 #include <vector>
 #include <pda.h>
 #include "Pda/PdaDevice.h"
+#include "Pda/ScatterGatherIndex.h"
 
 namespace AliceO2 {
 namespace roc {
@@ -30,27 +32,25 @@ class PdaDmaBuffer
 
     ~PdaDmaBuffer();
 
-    struct ScatterGatherEntry
-    {
-      size_t size;
-      uintptr_t addressUser;
-      uintptr_t addressBus;
-      uintptr_t addressKernel;
-    };
-    using ScatterGatherVector = std::vector<ScatterGatherEntry>;
+    using ScatterGatherEntry = Pda::ScatterGatherEntry;
+    using ScatterGatherVector = Pda::ScatterGatherVector;
 
     const ScatterGatherVector& getScatterGatherList() const
     {
       return mScatterGatherVector;
     }
 
-    /// Function for getting the bus address that corresponds to the user address + given offset
+    /// Function for getting the bus address that corresponds to the user address + given offset.
+    /// This is O(1) when the scatter-gather entries are uniformly sized (as with hugepages), O(log n) otherwise.
     uintptr_t getBusOffsetAddress(size_t offset) const;
 
   private:
     DMABuffer* mDmaBuffer;
     PdaDevice::PdaPciDevice mPciDevice;
     ScatterGatherVector mScatterGatherVector;
+
+    /// Index of the scatter-gather list used by getBusOffsetAddress()
+    ScatterGatherIndex mIndex;
 };
 
 } // namespace Pda
@@ -0,0 +1,103 @@
+/// \file PdaDmaBufferCache.cxx
+/// \brief Implementation of the PdaDmaBufferCache class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "Pda/PdaDmaBufferCache.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+namespace {
+
+struct Entry
+{
+    uintptr_t address;
+    size_t size;
+    std::shared_ptr<PdaDmaBuffer> buffer;
+};
+
+/// The cache, keyed by PCI address and buffer ID.
+/// Note that registering and deregistering takes the PdaLock of the device, and freeing leftover buffers takes it before
+/// asking for the cached IDs. So buffers are never created or destroyed while holding the mutex.
+struct Cache
+{
+    std::mutex mutex;
+    std::map<std::pair<std::string, int>, Entry> entries;
+};
+
+Cache& getCache()
+{
+  static Cache cache;
+  return cache;
+}
+
+} // Anonymous namespace
+
+std::shared_ptr<PdaDmaBuffer> PdaDmaBufferCache::getDmaBuffer(PdaDevice::PdaPciDevice pciDevice,
+    const PciAddress& pciAddress, void* address, size_t size, int dmaBufferId, bool requireHugepage)
+{
+  auto& cache = getCache();
+  auto key = std::make_pair(pciAddress.toString(), dmaBufferId);
+  std::shared_ptr<PdaDmaBuffer> replaced;
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.entries.find(key);
+    if (it != cache.entries.end()) {
+      if (it->second.address == reinterpret_cast<uintptr_t>(address) && it->second.size == size) {
+        return it->second.buffer;
+      }
+      replaced = std::move(it->second.buffer);
+      cache.entries.erase(it);
+    }
+  }
+
+  // The old registration must be gone before the buffer ID is registered again
+  replaced.reset();
+  auto buffer = std::make_shared<PdaDmaBuffer>(pciDevice, address, size, dmaBufferId, requireHugepage);
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.entries[key] = Entry{reinterpret_cast<uintptr_t>(address), size, buffer};
+  return buffer;
+}
+
+void PdaDmaBufferCache::release(uintptr_t address, size_t size)
+{
+  auto& cache = getCache();
+  std::vector<std::shared_ptr<PdaDmaBuffer>> released;
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+      const auto& entry = it->second;
+      if (entry.address < (address + size) && (entry.address + entry.size) > address) {
+        released.push_back(std::move(it->second.buffer));
+        it = cache.entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // Deregistered here, outside the mutex
+}
+
+std::vector<int> PdaDmaBufferCache::getDmaBufferIds(const PciAddress& pciAddress)
+{
+  auto& cache = getCache();
+  auto pciAddressString = pciAddress.toString();
+  std::vector<int> ids;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  for (const auto& entry : cache.entries) {
+    if (entry.first.first == pciAddressString) {
+      ids.push_back(entry.first.second);
+    }
+  }
+  return ids;
+}
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,42 @@
+/// \file PdaDmaBufferCache.h
+/// \brief Definition of the PdaDmaBufferCache class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_PDA_PDADMABUFFERCACHE_H_
+#define ALICEO2_SRC_READOUTCARD_PDA_PDADMABUFFERCACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Pda/PdaDevice.h"
+#include "Pda/PdaDmaBuffer.h"
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+/// Process-wide cache of the PDA registrations of DMA buffers in HugepagePool memory, or of buffers opened with
+/// Parameters::setBufferRegistrationRetained(). The registrations are kept when a channel is closed, so reopening it on
+/// the same buffer does not need to register it again.
+class PdaDmaBufferCache
+{
+  public:
+    /// Gets the registration of the buffer for the card, registering it if it's not cached yet. A cached registration
+    /// for the same card and buffer ID but another memory range is replaced.
+    static std::shared_ptr<PdaDmaBuffer> getDmaBuffer(PdaDevice::PdaPciDevice pciDevice, const PciAddress& pciAddress,
+        void* address, size_t size, int dmaBufferId, bool requireHugepage);
+
+    /// Drops the registrations of buffers within the memory range, to be done before it is unmapped
+    static void release(uintptr_t address, size_t size);
+
+    /// Gets the IDs of the cached registrations of the card, so they're not cleaned up as leftovers
+    static std::vector<int> getDmaBufferIds(const PciAddress& pciAddress);
+};
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_PDA_PDADMABUFFERCACHE_H_
@@ -0,0 +1,90 @@
+/// \file PdaInterrupt.cxx
+/// \brief Implementation of the PdaInterrupt class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "PdaInterrupt.h"
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+namespace b = boost;
+namespace bfs = boost::filesystem;
+namespace {
+
+/// Finds the /dev/uioN file of the card, using the uio directory in the device's sysfs directory
+std::string getUioDevicePath(const PciAddress& pciAddress)
+{
+  auto directory = (b::format("/sys/bus/pci/devices/0000:%s/uio") % pciAddress.toString()).str();
+  try {
+    for (const auto& entry : b::make_iterator_range(bfs::directory_iterator(directory), {})) {
+      auto name = entry.path().filename().string();
+      if (name.compare(0, 3, "uio") == 0) {
+        return "/dev/" + name;
+      }
+    }
+  }
+  catch (const bfs::filesystem_error&) {
+  }
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not find UIO device of card")
+      << ErrorInfo::Directory(directory)
+      << ErrorInfo::PciAddress(pciAddress)
+      << ErrorInfo::PossibleCauses({"Driver module not inserted (> modprobe uio_pci_dma)",
+          "Card not bound to uio_pci_dma"}));
+}
+
+} // Anonymous namespace
+
+PdaInterrupt::PdaInterrupt(const PciAddress& pciAddress)
+    : mPath(getUioDevicePath(pciAddress)), mFileDescriptor(open(mPath.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC))
+{
+  if (mFileDescriptor < 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not open UIO device of card")
+        << ErrorInfo::Filename(mPath)
+        << ErrorInfo::PciAddress(pciAddress)
+        << ErrorInfo::PossibleCauses({"Insufficient permissions on UIO device file"}));
+  }
+  enable();
+}
+
+PdaInterrupt::~PdaInterrupt()
+{
+  close(mFileDescriptor);
+}
+
+void PdaInterrupt::enable()
+{
+  uint32_t enable = 1;
+  if (write(mFileDescriptor, &enable, sizeof(enable)) != sizeof(enable)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not enable interrupt through UIO device")
+        << ErrorInfo::Filename(mPath)
+        << ErrorInfo::PossibleCauses({"PDA kernel module does not support interrupt control"}));
+  }
+}
+
+bool PdaInterrupt::acknowledge()
+{
+  // Reading gives the total interrupt count, we only care whether it changed
+  uint32_t count;
+  auto result = read(mFileDescriptor, &count, sizeof(count));
+  if (result != sizeof(count)) {
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return false;
+    }
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not read interrupt count from UIO device")
+        << ErrorInfo::Filename(mPath));
+  }
+  enable();
+  return true;
+}
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,56 @@
+/// \file PdaInterrupt.h
+/// \brief Definition of the PdaInterrupt class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_PDA_PDAINTERRUPT_H_
+#define ALICEO2_SRC_READOUTCARD_PDA_PDAINTERRUPT_H_
+
+#include <string>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+/// Gives access to the MSI/MSI-X interrupt of a card bound to the uio_pci_dma module.
+/// The PDA kernel module is a UIO driver, so the interrupt is exposed through the device's /dev/uioN file: it becomes
+/// readable when the card has raised an interrupt, and the interrupt is re-armed by writing to it.
+class PdaInterrupt
+{
+  public:
+    /// Opens the UIO device of the card and arms the interrupt
+    /// \param pciAddress Address of the card
+    PdaInterrupt(const PciAddress& pciAddress);
+    ~PdaInterrupt();
+
+    PdaInterrupt(const PdaInterrupt&) = delete;
+    PdaInterrupt& operator=(const PdaInterrupt&) = delete;
+
+    /// Gets the file descriptor that becomes readable when the card raises an interrupt.
+    /// It is non-blocking and can be monitored with poll(), select() or epoll.
+    int getFileDescriptor() const
+    {
+      return mFileDescriptor;
+    }
+
+    /// Consumes a pending interrupt, if any, and re-arms the interrupt
+    /// \return True if an interrupt was pending
+    bool acknowledge();
+
+  private:
+    /// Writes to the UIO device to (re-)enable the interrupt
+    void enable();
+
+    /// Path of the UIO device file
+    std::string mPath;
+
+    /// File descriptor of the UIO device file
+    int mFileDescriptor;
+};
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_PDA_PDAINTERRUPT_H_
@@ -1,30 +1,44 @@
-/// \file PdaDmaBuffer.h
-/// \brief Definition of the PdaDmaBuffer class.
+/// \file PdaLock.h
+/// \brief Definition of the PdaLock class.
 ///
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #ifndef ALICEO2_SRC_READOUTCARD_PDA_PDALOCK_H_
 #define ALICEO2_SRC_READOUTCARD_PDA_PDALOCK_H_
 
+#include <cstdlib>
+#include <cstring>
+#include <string>
 #include "InterprocessLock.h"
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
 #include "boost/filesystem.hpp"
 
 namespace AliceO2 {
 namespace roc {
 namespace Pda {
 
-/// Represents a global, system-wide lock on ReadoutCard's PDA usage. This is needed because the PDA kernel module
-/// will lock up if buffers are created/freed in parallel.
+/// Represents a lock on ReadoutCard's PDA usage. This is needed because the PDA kernel module will lock up if buffers
+/// are created/freed in parallel.
+/// The lock is per PCI device by default, so buffers of different cards can be registered in parallel. Setting the
+/// environment variable ALICEO2_READOUTCARD_PDA_GLOBAL_LOCK (to anything but "0") makes all of them take one global,
+/// system-wide lock instead. The variable must then be set for all processes using PDA, since a process taking a
+/// per-device lock does not exclude one taking the global lock.
 /// Just hope nobody else uses PDA in parallel.
 class PdaLock
 {
   public:
 
+    /// Takes the global lock.
     /// Be careful you don't use it like this:
     ///   Pda::PdaLock lock()
     /// But rather like this:
     ///   Pda::PdaLock lock{}
-    PdaLock(bool waitOnLock = true) : mLock("Alice_O2_RoC_PDA_lock", waitOnLock)
+    PdaLock(bool waitOnLock = true) : mLock(getGlobalLockName(), waitOnLock)
+    {
+    }
+
+    /// Takes the lock of a PCI device, or the global lock if it is forced by the environment
+    PdaLock(const PciAddress& pciAddress, bool waitOnLock = true) : mLock(getLockName(pciAddress), waitOnLock)
     {
     }
 
@@ -32,6 +46,24 @@ class PdaLock
     {
     }
 
+    /// Checks if the global lock is forced by the environment variable ALICEO2_READOUTCARD_PDA_GLOBAL_LOCK
+    static bool isGlobalLockForced()
+    {
+      const char* value = std::getenv("ALICEO2_READOUTCARD_PDA_GLOBAL_LOCK");
+      return value != nullptr && std::strcmp(value, "0") != 0;
+    }
+
+    /// Gets the name of the lock used for a PCI device
+    static std::string getLockName(const PciAddress& pciAddress)
+    {
+      return isGlobalLockForced() ? getGlobalLockName() : "Alice_O2_RoC_PDA_" + pciAddress.toString() + "_lock";
+    }
+
+    static std::string getGlobalLockName()
+    {
+      return "Alice_O2_RoC_PDA_lock";
+    }
+
   private:
     Interprocess::Lock mLock;
 };
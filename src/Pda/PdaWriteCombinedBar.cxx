@@ -0,0 +1,51 @@
+/// \file PdaWriteCombinedBar.cxx
+/// \brief Implementation of the PdaWriteCombinedBar class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "PdaWriteCombinedBar.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+PdaWriteCombinedBar::PdaWriteCombinedBar(const PciAddress& pciAddress, int barNumber, uintptr_t offset, size_t size)
+{
+  // mmap() needs a page-aligned offset
+  const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  mOffset = offset - (offset % pageSize);
+  mSize = ((offset + size - mOffset + pageSize - 1) / pageSize) * pageSize;
+
+  auto path = (boost::format("/sys/bus/pci/devices/0000:%s/resource%d_wc") % pciAddress.toString() % barNumber).str();
+  int fileDescriptor = open(path.c_str(), O_RDWR | O_CLOEXEC);
+  if (fileDescriptor < 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not open write-combining BAR resource")
+        << ErrorInfo::Filename(path)
+        << ErrorInfo::PciAddress(pciAddress)
+        << ErrorInfo::PossibleCauses({"BAR is not prefetchable, so the kernel does not offer a write-combining mapping",
+            "Insufficient permissions on the resource file"}));
+  }
+
+  void* address = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, mOffset);
+  close(fileDescriptor);
+  if (address == MAP_FAILED) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not map write-combining BAR resource")
+        << ErrorInfo::Filename(path)
+        << ErrorInfo::PciAddress(pciAddress));
+  }
+  mAddress = reinterpret_cast<uintptr_t>(address);
+}
+
+PdaWriteCombinedBar::~PdaWriteCombinedBar()
+{
+  munmap(reinterpret_cast<void*>(mAddress), mSize);
+}
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,71 @@
+/// \file PdaWriteCombinedBar.h
+/// \brief Definition of the PdaWriteCombinedBar class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_PDA_PDAWRITECOMBINEDBAR_H_
+#define ALICEO2_SRC_READOUTCARD_PDA_PDAWRITECOMBINEDBAR_H_
+
+#include <cstddef>
+#include <cstdint>
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+#include "Register.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+/// Maps a region of a BAR with write-combining, through the resource[N]_wc file the kernel offers for prefetchable
+/// BARs. Consecutive writes to the region are collected in the CPU's write-combining buffers and may be posted to the
+/// card as a single PCIe write, instead of one per register. The writes are not ordered among each other, so a write
+/// that must reach the card after others needs a flush() before it. Reads should go through the regular, uncached
+/// mapping.
+class PdaWriteCombinedBar
+{
+  public:
+    /// Maps the region containing the given range of the BAR
+    /// \param pciAddress Address of the card
+    /// \param barNumber Number of the BAR
+    /// \param offset Byte offset in the BAR of the start of the range
+    /// \param size Size in bytes of the range
+    PdaWriteCombinedBar(const PciAddress& pciAddress, int barNumber, uintptr_t offset, size_t size);
+    ~PdaWriteCombinedBar();
+
+    PdaWriteCombinedBar(const PdaWriteCombinedBar&) = delete;
+    PdaWriteCombinedBar& operator=(const PdaWriteCombinedBar&) = delete;
+
+    /// Gets the write-combined address of a register, which must be in the mapped range
+    volatile uint32_t* getRegisterAddress(Register reg) const
+    {
+      return reinterpret_cast<volatile uint32_t*>(mAddress + (reg.address - mOffset));
+    }
+
+    /// Posts the writes that are still in the CPU's write-combining buffers, and orders them before later writes
+    static void flush()
+    {
+#if defined(__SSE2__)
+      _mm_sfence();
+#else
+      __sync_synchronize();
+#endif
+    }
+
+  private:
+    /// Byte offset in the BAR of the start of the mapping
+    uintptr_t mOffset;
+
+    /// Size of the mapping
+    size_t mSize;
+
+    /// Userspace address of the mapping
+    uintptr_t mAddress;
+};
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_PDA_PDAWRITECOMBINEDBAR_H_
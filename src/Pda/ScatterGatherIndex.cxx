@@ -0,0 +1,74 @@
+/// \file ScatterGatherIndex.cxx
+/// \brief Implementation of the ScatterGatherIndex class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "Pda/ScatterGatherIndex.h"
+#include <algorithm>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+ScatterGatherIndex::ScatterGatherIndex(const ScatterGatherVector& list)
+{
+  if (list.empty()) {
+    return;
+  }
+
+  // The userspace addresses of the entries are contiguous, so the lowest one is the start of the buffer
+  auto userBase = std::min_element(list.begin(), list.end(),
+      [](const ScatterGatherEntry& a, const ScatterGatherEntry& b) { return a.addressUser < b.addressUser; })
+      ->addressUser;
+
+  mOffsetIndex.reserve(list.size());
+  for (const auto& entry : list) {
+    mOffsetIndex.push_back(OffsetEntry{entry.addressUser - userBase, entry.size, entry.addressBus});
+  }
+  std::sort(mOffsetIndex.begin(), mOffsetIndex.end(),
+      [](const OffsetEntry& a, const OffsetEntry& b) { return a.offset < b.offset; });
+
+  const auto& last = mOffsetIndex.back();
+  mTotalSize = last.offset + last.size;
+
+  // Check if we can index the entries directly
+  mUniformEntrySize = mOffsetIndex.front().size;
+  for (size_t i = 0; i < mOffsetIndex.size(); ++i) {
+    const auto& entry = mOffsetIndex[i];
+    bool isLast = (i + 1) == mOffsetIndex.size();
+    if ((entry.offset != i * mUniformEntrySize) || (isLast ? entry.size > mUniformEntrySize
+        : entry.size != mUniformEntrySize)) {
+      mUniformEntrySize = 0;
+      break;
+    }
+  }
+}
+
+uintptr_t ScatterGatherIndex::getBusOffsetAddress(size_t offset) const
+{
+  if (offset < mTotalSize) {
+    if (mUniformEntrySize != 0) {
+      const auto& entry = mOffsetIndex[offset / mUniformEntrySize];
+      return entry.addressBus + (offset - entry.offset);
+    }
+
+    // Find the last entry that starts at or before the offset
+    auto iter = std::upper_bound(mOffsetIndex.begin(), mOffsetIndex.end(), offset,
+        [](size_t value, const OffsetEntry& entry) { return value < entry.offset; });
+    if (iter != mOffsetIndex.begin()) {
+      const auto& entry = *(iter - 1);
+      if (offset < (entry.offset + entry.size)) {
+        return entry.addressBus + (offset - entry.offset);
+      }
+    }
+  }
+
+  BOOST_THROW_EXCEPTION(Exception()
+      << ErrorInfo::Message("Physical offset address out of range")
+      << ErrorInfo::Offset(offset));
+}
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,72 @@
+/// \file ScatterGatherIndex.h
+/// \brief Definition of the ScatterGatherIndex class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_PDA_SCATTERGATHERINDEX_H_
+#define ALICEO2_SRC_READOUTCARD_PDA_SCATTERGATHERINDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+namespace Pda {
+
+/// An entry of the scatter-gather list of a DMA buffer
+struct ScatterGatherEntry
+{
+  size_t size;
+  uintptr_t addressUser;
+  uintptr_t addressBus;
+  uintptr_t addressKernel;
+};
+
+using ScatterGatherVector = std::vector<ScatterGatherEntry>;
+
+/// Converts offsets in a DMA buffer to bus addresses, using the buffer's scatter-gather list.
+/// It does not depend on PDA, so it can be used on synthetic lists.
+class ScatterGatherIndex
+{
+  public:
+    ScatterGatherIndex() = default;
+
+    /// \param list The scatter-gather list. The userspace addresses of the entries must be contiguous, in any order.
+    explicit ScatterGatherIndex(const ScatterGatherVector& list);
+
+    /// Gets the bus address that corresponds to the start of the buffer + given offset.
+    /// This is O(1) when the scatter-gather entries are uniformly sized (as with hugepages), O(log n) otherwise.
+    /// \throw Exception if the offset is outside of the buffer
+    uintptr_t getBusOffsetAddress(size_t offset) const;
+
+    /// Checks if the entries are uniformly sized, so the lookup is O(1)
+    bool isUniform() const
+    {
+      return mUniformEntrySize != 0;
+    }
+
+  private:
+    struct OffsetEntry
+    {
+      size_t offset; ///< Offset of the entry from the start of the buffer
+      size_t size;
+      uintptr_t addressBus;
+    };
+
+    /// Entries sorted by their offset in the buffer
+    std::vector<OffsetEntry> mOffsetIndex;
+
+    /// Size of the entries if they are contiguous and all the same size (except possibly the last, which may be
+    /// smaller), so the entry of an offset can be computed directly. 0 otherwise.
+    size_t mUniformEntrySize = 0;
+
+    /// Total size covered by the scatter-gather list
+    size_t mTotalSize = 0;
+};
+
+} // namespace Pda
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_PDA_SCATTERGATHERINDEX_H_
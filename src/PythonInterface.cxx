@@ -4,12 +4,16 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include <iostream>
+#include <map>
 #include <string>
 #include <boost/lexical_cast/try_lexical_convert.hpp>
 #include <boost/python.hpp>
 #include "Common/GuardFunction.h"
+#include "CommandLineUtilities/AliceLowlevelFrontend/Sca.h"
 #include "ExceptionInternal.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "Swt/Swt.h"
 
 namespace {
 using namespace AliceO2::roc;
@@ -41,6 +45,128 @@ Args:
     value: 32-bit value to write to the register)";
 
 
+/// Documentation for the register block read function
+auto sRegisterReadBlockDocString =
+R"(Read consecutive 32-bit registers with one call, as bytes in host byte order.
+numpy.frombuffer(result, dtype=numpy.uint32) gives the values as a NumPy array.
+
+Args:
+    index: 32-bit aligned address of the first register
+    count: Amount of registers to read
+Returns:
+    The values as bytes)";
+
+/// Documentation for the register block write function
+auto sRegisterWriteBlockDocString =
+R"(Write consecutive 32-bit registers with one call
+
+Args:
+    index: 32-bit aligned address of the first register
+    values: Object with the buffer protocol holding the 32-bit values in host byte order, such as bytes or a NumPy
+        uint32 array)";
+
+/// Documentation for the SCA sequence function
+auto sScaSequenceDocString =
+R"(Execute a sequence of SCA commands with one call. An SCA error stops the sequence.
+
+Args:
+    link: Link of the SCA
+    commands: List of (command, data) tuples
+Returns:
+    Tuple of the list of (command, data) results of the executed commands, and the error message or None)";
+
+/// Documentation for the SWT write sequence function
+auto sSwtWriteSequenceDocString =
+R"(Write a sequence of SWT words with one call
+
+Args:
+    gbt channel: GBT channel of the SWT
+    words: List of (low, med, high) tuples
+Returns:
+    The monitor status after the last word)";
+
+/// Documentation for the SWT read sequence function
+auto sSwtReadSequenceDocString =
+R"(Read a sequence of SWT words with one call
+
+Args:
+    gbt channel: GBT channel of the SWT
+    count: Amount of words to read
+Returns:
+    Tuple of the list of (low, med, high) words, and the monitor status after the last word)";
+
+/// Documentation for the SWT multi-channel sequences function
+auto sSwtSequencesDocString =
+R"(Execute SWT sequences on several GBT channels with one call. The channels take turns writing batches of their words,
+and then read their replies. An error stops the sequence of its channel only.
+
+Args:
+    sequences: Dict of GBT channel to a tuple of the list of (low, med, high) words to write, and the amount of words
+        to read after them
+    batch size: Maximum amount of words written to a channel in a turn
+Returns:
+    Dict of GBT channel to a tuple of the amount of words written, the list of (low, med, high) words read, the last
+    monitor status, and the error message or None)";
+
+/// Documentation for the DMA channel init function (constructor)
+auto sDmaInitDocString =
+R"(Initializes a DmaChannel object, with a DMA buffer in a hugetlbfs file
+
+Args:
+    card id: String containing PCI address (e.g. 42:0.0) or serial number (e.g. 12345)
+    channel number: Number of the DMA channel to open
+    buffer file: Path of the buffer file to create, e.g. /var/lib/hugetlbfs/global/pagesize-2MB/roc-python
+    buffer size: Size of the buffer in bytes, a multiple of the hugepage size)";
+
+/// Documentation for the push superpage function
+auto sPushSuperpageDocString =
+R"(Push a superpage into the transfer queue
+
+Args:
+    offset: Offset of the superpage in the DMA buffer
+    size: Size of the superpage in bytes
+Returns:
+    False if the transfer queue was full)";
+
+/// Documentation for the pop superpage function
+auto sPopSuperpageDocString =
+R"(Pop a superpage from the ready queue
+
+Returns:
+    The superpage, or None if the ready queue was empty)";
+
+/// Documentation for the buffer function
+auto sBufferDocString =
+R"(Get a writable memoryview of the whole DMA buffer, without copying it.
+numpy.frombuffer(channel.buffer(), dtype=numpy.uint32) gives a NumPy array view. The view must not be used after the
+channel object is gone.
+
+Returns:
+    The memoryview)";
+
+/// Documentation for the superpage view function
+auto sSuperpageViewDocString =
+R"(Get a read-only memoryview of the received data of a superpage, without copying it. The view must not be used after
+the superpage was pushed again, or after the channel object is gone.
+
+Args:
+    superpage: A superpage popped from the channel
+Returns:
+    The memoryview)";
+
+/// Makes a memoryview of memory owned by C++, without copying it
+boost::python::object makeMemoryView(void* address, size_t size, bool writable)
+{
+#if PY_MAJOR_VERSION >= 3
+  auto view = PyMemoryView_FromMemory(static_cast<char*>(address), Py_ssize_t(size),
+      writable ? PyBUF_WRITE : PyBUF_READ);
+#else
+  auto view = writable ? PyBuffer_FromReadWriteMemory(address, Py_ssize_t(size))
+      : PyBuffer_FromMemory(address, Py_ssize_t(size));
+#endif
+  return boost::python::object(boost::python::handle<>(view));
+}
+
 class BarChannel
 {
   public:
@@ -60,9 +186,196 @@ class BarChannel
       return mBarChannel->writeRegister(address / 4, value);
     }
 
+    boost::python::object readBlock(uint32_t address, size_t count)
+    {
+      std::vector<uint32_t> values(count);
+      mBarChannel->readRegisters(address / 4, values.data(), count);
+      auto data = reinterpret_cast<const char*>(values.data());
+#if PY_MAJOR_VERSION >= 3
+      return boost::python::object(boost::python::handle<>(PyBytes_FromStringAndSize(data, count * sizeof(uint32_t))));
+#else
+      return boost::python::object(boost::python::handle<>(PyString_FromStringAndSize(data, count * sizeof(uint32_t))));
+#endif
+    }
+
+    void writeBlock(uint32_t address, boost::python::object values)
+    {
+      Py_buffer buffer;
+      if (PyObject_GetBuffer(values.ptr(), &buffer, PyBUF_CONTIG_RO) != 0) {
+        boost::python::throw_error_already_set();
+      }
+      AliceO2::Common::GuardFunction release{[&]{ PyBuffer_Release(&buffer); }};
+      if (buffer.len % sizeof(uint32_t) != 0) {
+        BOOST_THROW_EXCEPTION(ParameterException()
+            << ErrorInfo::Message("Register values must be a multiple of 32 bits"));
+      }
+      mBarChannel->writeRegisters(address / 4, static_cast<const uint32_t*>(buffer.buf), buffer.len / sizeof(uint32_t));
+    }
+
+    boost::python::tuple scaSequence(int link, boost::python::list commands)
+    {
+      using Sca = CommandLineUtilities::Alf::Sca;
+      std::vector<Sca::CommandData> sequence;
+      for (boost::python::ssize_t i = 0; i < boost::python::len(commands); ++i) {
+        boost::python::tuple command = boost::python::extract<boost::python::tuple>(commands[i]);
+        sequence.push_back({boost::python::extract<uint32_t>(command[0]), boost::python::extract<uint32_t>(command[1])});
+      }
+
+      auto result = Sca(*mBarChannel, mBarChannel->getCardType(), link).executeSequence(sequence);
+      boost::python::list results;
+      for (const auto& read : result.results) {
+        results.append(boost::python::make_tuple(read.command, read.data));
+      }
+      auto error = result.error ? boost::python::object(*result.error) : boost::python::object();
+      return boost::python::make_tuple(results, error);
+    }
+
+    uint32_t swtWriteSequence(int gbtChannel, boost::python::list words)
+    {
+      std::vector<SwtWord> sequence;
+      for (boost::python::ssize_t i = 0; i < boost::python::len(words); ++i) {
+        boost::python::tuple word = boost::python::extract<boost::python::tuple>(words[i]);
+        sequence.emplace_back(boost::python::extract<uint32_t>(word[0]), boost::python::extract<uint32_t>(word[1]),
+            boost::python::extract<uint16_t>(word[2]));
+      }
+      return Swt(*mBarChannel, gbtChannel).writeSequence(sequence);
+    }
+
+    boost::python::dict swtSequences(boost::python::dict sequences, size_t batchSize)
+    {
+      std::map<int, Swt::Sequence> swtSequences;
+      boost::python::list channels = sequences.keys();
+      for (boost::python::ssize_t i = 0; i < boost::python::len(channels); ++i) {
+        int channel = boost::python::extract<int>(channels[i]);
+        boost::python::tuple sequence = boost::python::extract<boost::python::tuple>(sequences[channels[i]]);
+        boost::python::list words = boost::python::extract<boost::python::list>(sequence[0]);
+        auto& swtSequence = swtSequences[channel];
+        for (boost::python::ssize_t j = 0; j < boost::python::len(words); ++j) {
+          boost::python::tuple word = boost::python::extract<boost::python::tuple>(words[j]);
+          swtSequence.writes.emplace_back(boost::python::extract<uint32_t>(word[0]),
+              boost::python::extract<uint32_t>(word[1]), boost::python::extract<uint16_t>(word[2]));
+        }
+        swtSequence.readCount = boost::python::extract<size_t>(sequence[1]);
+      }
+
+      boost::python::dict results;
+      for (const auto& result : Swt::executeSequences(*mBarChannel, swtSequences, batchSize)) {
+        boost::python::list words;
+        for (const auto& word : result.second.reads) {
+          words.append(boost::python::make_tuple(word.getLow(), word.getMed(), word.getHigh()));
+        }
+        auto error = result.second.error ? boost::python::object(*result.second.error) : boost::python::object();
+        results[result.first] = boost::python::make_tuple(result.second.written, words, result.second.monitor, error);
+      }
+      return results;
+    }
+
+    boost::python::tuple swtReadSequence(int gbtChannel, size_t count)
+    {
+      std::vector<SwtWord> sequence(count);
+      auto status = Swt(*mBarChannel, gbtChannel).readSequence(sequence);
+      boost::python::list words;
+      for (const auto& word : sequence) {
+        words.append(boost::python::make_tuple(word.getLow(), word.getMed(), word.getHigh()));
+      }
+      return boost::python::make_tuple(words, status);
+    }
+
   private:
     std::shared_ptr<AliceO2::roc::BarInterface> mBarChannel;
 };
+
+/// This is a Python wrapper class for a DMA channel. It owns the DMA buffer, and gives views of it without copying.
+class DmaChannel
+{
+  public:
+    DmaChannel(std::string cardIdString, int channelNumber, std::string bufferFile, size_t bufferSize)
+        : mBufferFile(std::make_unique<MemoryMappedFile>(bufferFile, bufferSize, true))
+    {
+      auto cardId = Parameters::cardIdFromString(cardIdString);
+      auto parameters = Parameters::makeParameters(cardId, channelNumber);
+      parameters.setBufferParameters(buffer_parameters::Memory{mBufferFile->getAddress(), bufferSize});
+      mDmaChannel = ChannelFactory().getDmaChannel(parameters);
+    }
+
+    void startDma()
+    {
+      mDmaChannel->startDma();
+    }
+
+    void prepareDma()
+    {
+      mDmaChannel->prepareDma();
+    }
+
+    void stopDma()
+    {
+      mDmaChannel->stopDma();
+    }
+
+    void recover()
+    {
+      mDmaChannel->recover();
+    }
+
+    int startNextRun()
+    {
+      return mDmaChannel->startNextRun();
+    }
+
+    void fillSuperpages()
+    {
+      mDmaChannel->fillSuperpages();
+    }
+
+    bool pushSuperpage(size_t offset, size_t size)
+    {
+      return mDmaChannel->tryPushSuperpage(Superpage(offset, size));
+    }
+
+    boost::python::object popSuperpage()
+    {
+      Superpage superpage;
+      if (!mDmaChannel->tryPopSuperpage(superpage)) {
+        return boost::python::object();
+      }
+      return boost::python::object(superpage);
+    }
+
+    int getTransferQueueAvailable()
+    {
+      return mDmaChannel->getTransferQueueAvailable();
+    }
+
+    int getReadyQueueSize()
+    {
+      return mDmaChannel->getReadyQueueSize();
+    }
+
+    size_t getBufferSize()
+    {
+      return mBufferFile->getSize();
+    }
+
+    boost::python::object buffer()
+    {
+      return makeMemoryView(mBufferFile->getAddress(), mBufferFile->getSize(), true);
+    }
+
+    boost::python::object superpageView(const Superpage& superpage)
+    {
+      if (superpage.getOffset() + superpage.getReceived() > mBufferFile->getSize()) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Superpage outside of the DMA buffer"));
+      }
+      auto address = static_cast<char*>(mBufferFile->getAddress()) + superpage.getOffset();
+      return makeMemoryView(address, superpage.getReceived(), false);
+    }
+
+  private:
+    // The buffer is declared first, so it outlives the channel using it
+    std::unique_ptr<MemoryMappedFile> mBufferFile;
+    std::shared_ptr<DmaChannelInterface> mDmaChannel;
+};
 } // Anonymous namespace
 
 // Note that the name given here to BOOST_PYTHON_MODULE must be the actual name of the shared object file this file is
@@ -73,6 +386,36 @@ BOOST_PYTHON_MODULE(libReadoutCard)
 
   class_<BarChannel>("BarChannel", init<std::string, int>(sInitDocString))
       .def("register_read", &BarChannel::read, sRegisterReadDocString)
-      .def("register_write", &BarChannel::write, sRegisterWriteDocString);
+      .def("register_write", &BarChannel::write, sRegisterWriteDocString)
+      .def("register_read_block", &BarChannel::readBlock, sRegisterReadBlockDocString)
+      .def("register_write_block", &BarChannel::writeBlock, sRegisterWriteBlockDocString)
+      .def("sca_sequence", &BarChannel::scaSequence, sScaSequenceDocString)
+      .def("swt_write_sequence", &BarChannel::swtWriteSequence, sSwtWriteSequenceDocString)
+      .def("swt_read_sequence", &BarChannel::swtReadSequence, sSwtReadSequenceDocString)
+      .def("swt_sequences", &BarChannel::swtSequences, sSwtSequencesDocString);
+
+  class_<Superpage>("Superpage", no_init)
+      .add_property("offset", &Superpage::getOffset)
+      .add_property("size", &Superpage::getSize)
+      .add_property("received", &Superpage::getReceived)
+      .add_property("link_id", &Superpage::getLinkId)
+      .add_property("timestamp", &Superpage::getTimestamp)
+      .def("is_ready", &Superpage::isReady)
+      .def("is_filled", &Superpage::isFilled);
+
+  class_<DmaChannel, boost::noncopyable>("DmaChannel", init<std::string, int, std::string, size_t>(sDmaInitDocString))
+      .def("start_dma", &DmaChannel::startDma)
+      .def("prepare_dma", &DmaChannel::prepareDma)
+      .def("stop_dma", &DmaChannel::stopDma)
+      .def("recover", &DmaChannel::recover)
+      .def("start_next_run", &DmaChannel::startNextRun)
+      .def("fill_superpages", &DmaChannel::fillSuperpages)
+      .def("push_superpage", &DmaChannel::pushSuperpage, sPushSuperpageDocString)
+      .def("pop_superpage", &DmaChannel::popSuperpage, sPopSuperpageDocString)
+      .def("transfer_queue_available", &DmaChannel::getTransferQueueAvailable)
+      .def("ready_queue_size", &DmaChannel::getReadyQueueSize)
+      .def("buffer_size", &DmaChannel::getBufferSize)
+      .def("buffer", &DmaChannel::buffer, sBufferDocString)
+      .def("superpage_view", &DmaChannel::superpageView, sSuperpageViewDocString);
 }
 
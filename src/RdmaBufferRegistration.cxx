@@ -0,0 +1,88 @@
+/// \file RdmaBufferRegistration.cxx
+/// \brief Implementation of the RdmaBufferRegistration class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/RdmaBufferRegistration.h"
+#include <cerrno>
+#include <cstring>
+#include <infiniband/verbs.h>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+
+RdmaBufferRegistration::RdmaBufferRegistration(ibv_pd* protectionDomain) : mProtectionDomain(protectionDomain)
+{
+  if (!mProtectionDomain) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Protection domain is null"));
+  }
+}
+
+RdmaBufferRegistration::~RdmaBufferRegistration()
+{
+  for (const auto& entry : mMemoryRegions) {
+    ibv_dereg_mr(entry.second);
+  }
+}
+
+void RdmaBufferRegistration::registerBuffer(int bufferId, void* address, size_t size, int access)
+{
+  if (mMemoryRegions.count(bufferId)) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Buffer already registered")
+        << ErrorInfo::BufferId(bufferId));
+  }
+  if (access == -1) {
+    access = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE;
+  }
+  ibv_mr* memoryRegion = ibv_reg_mr(mProtectionDomain, address, size, access);
+  if (!memoryRegion) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message(std::string("Failed to register buffer with ibverbs: ") + std::strerror(errno))
+        << ErrorInfo::BufferId(bufferId)
+        << ErrorInfo::DmaBufferSize(size)
+        << ErrorInfo::PossibleCauses({"Locked memory limit too low (check 'ulimit -l')"}));
+  }
+  mMemoryRegions[bufferId] = memoryRegion;
+}
+
+void RdmaBufferRegistration::deregisterBuffer(int bufferId)
+{
+  auto memoryRegion = getMemoryRegion(bufferId);
+  if (int error = ibv_dereg_mr(memoryRegion)) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message(std::string("Failed to deregister buffer with ibverbs: ") + std::strerror(error))
+        << ErrorInfo::BufferId(bufferId));
+  }
+  mMemoryRegions.erase(bufferId);
+}
+
+uint32_t RdmaBufferRegistration::getLocalKey(const Superpage& superpage) const
+{
+  return getMemoryRegion(superpage.getBufferId())->lkey;
+}
+
+uint32_t RdmaBufferRegistration::getRemoteKey(const Superpage& superpage) const
+{
+  return getMemoryRegion(superpage.getBufferId())->rkey;
+}
+
+uint64_t RdmaBufferRegistration::getAddress(const Superpage& superpage) const
+{
+  return reinterpret_cast<uint64_t>(getMemoryRegion(superpage.getBufferId())->addr) + superpage.getOffset();
+}
+
+ibv_mr* RdmaBufferRegistration::getMemoryRegion(int bufferId) const
+{
+  auto iterator = mMemoryRegions.find(bufferId);
+  if (iterator == mMemoryRegions.end()) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Buffer not registered")
+        << ErrorInfo::BufferId(bufferId));
+  }
+  return iterator->second;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,90 @@
+/// \file RegisterField.h
+/// \brief Definition of the RegisterField and RegisterFieldValues structs.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_REGISTERFIELD_H_
+#define ALICEO2_SRC_READOUTCARD_REGISTERFIELD_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include "Register.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Values for fields of a single register, to be written together. Values for fields of the same register are combined
+/// with `|`, so a multi-field update is one read-modify-write, and when the values are constants, the mask and bits
+/// are computed by the compiler.
+struct RegisterFieldValues
+{
+    constexpr RegisterFieldValues(Register reg, uint32_t mask, uint32_t bits) noexcept
+        : reg(reg), mask(mask), bits(bits)
+    {
+    }
+
+    /// Applies the values to the current value of the register
+    constexpr uint32_t apply(uint32_t registerValue) const
+    {
+      return (registerValue & ~mask) | bits;
+    }
+
+    const Register reg;
+    const uint32_t mask; ///< Bits of the fields
+    const uint32_t bits; ///< Values of the fields, in place
+};
+
+/// Combines the values of fields of the same register. In a constant expression, combining fields of different
+/// registers fails to compile.
+constexpr RegisterFieldValues operator|(const RegisterFieldValues& a, const RegisterFieldValues& b)
+{
+  return a.reg.index == b.reg.index
+      ? RegisterFieldValues(a.reg, a.mask | b.mask, (a.bits & ~b.mask) | b.bits)
+      : throw std::logic_error("Combined fields of different registers");
+}
+
+/// A bit field of a register: its register, the position of its lowest bit and its width. The accessors are constexpr,
+/// so with a constant descriptor the shifts and masks are folded into the code.
+struct RegisterField
+{
+    /// \param reg Register of the field
+    /// \param shift Position of the lowest bit of the field
+    /// \param width Amount of bits of the field, 1 to 32
+    constexpr RegisterField(Register reg, int shift, int width) noexcept
+        : reg(reg), shift(shift), width(width)
+    {
+    }
+
+    /// Gets the bits of the field, in place
+    constexpr uint32_t mask() const
+    {
+      return (width >= 32 ? ~uint32_t(0) : ((uint32_t(1) << width) - 1)) << shift;
+    }
+
+    /// Extracts the field from a value of the register
+    constexpr uint32_t get(uint32_t registerValue) const
+    {
+      return (registerValue & mask()) >> shift;
+    }
+
+    /// Replaces the field in a value of the register. Bits of the value that don't fit in the field are dropped.
+    constexpr uint32_t set(uint32_t registerValue, uint32_t value) const
+    {
+      return (registerValue & ~mask()) | ((value << shift) & mask());
+    }
+
+    /// Makes the value of the field, to be applied to the register or combined with values of other fields
+    constexpr RegisterFieldValues operator()(uint32_t value) const
+    {
+      return RegisterFieldValues(reg, mask(), (value << shift) & mask());
+    }
+
+    const Register reg;
+    const int shift;
+    const int width;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_REGISTERFIELD_H_
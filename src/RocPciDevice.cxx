@@ -6,15 +6,26 @@
 
 #include "RocPciDevice.h"
 
+#include <cstdio>
+#include <fstream>
+#include <future>
 #include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <unistd.h>
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <functional>
 #include <iostream>
 #include "Crorc/Crorc.h"
 #include "Cru/CruBar.h"
 #include "Pda/PdaBar.h"
+#include "Pda/PdaBarCache.h"
 #include "Pda/PdaDevice.h"
 #include "ReadoutCard/ChannelFactory.h"
 #include "ReadoutCard/Exception.h"
@@ -41,34 +52,201 @@ const std::vector<DeviceType> deviceTypes = {
 };
 
 PciAddress addressFromDevice(Pda::PdaDevice::PdaPciDevice pciDevice){
-  uint8_t busId;
-  uint8_t deviceId;
-  uint8_t functionId;
-  if (PciDevice_getBusID(pciDevice.get(), &busId) || PciDevice_getDeviceID(pciDevice.get(), &deviceId)
-      || PciDevice_getFunctionID(pciDevice.get(), &functionId)) {
-    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to retrieve device address"));
-  }
-  PciAddress address (busId, deviceId, functionId);
-  return address;
+  return pciDevice.getPciAddress();
 }
 
 CardDescriptor defaultDescriptor() {
   return {CardType::Unknown, -1, {"unknown", "unknown"}, PciAddress(0,0,0), -1};
 }
+
+/// Process-wide cache of the ReadoutCard devices on the system, indexed by serial number and PCI address
+struct DeviceCache
+{
+    std::mutex mutex;
+    bool valid = false;
+    std::vector<CardDescriptor> cards;
+    std::unordered_map<int, std::vector<CardDescriptor>> bySerial;
+    std::unordered_map<std::string, std::vector<CardDescriptor>> byAddress;
+
+    /// Path of the on-disk cache, empty if disabled
+    std::string filePath;
+};
+
+DeviceCache& getDeviceCache()
+{
+  static DeviceCache cache;
+  return cache;
+}
+
+/// Enumerates the devices through PDA and reads their serial numbers. Reading a serial maps a BAR and, for the C-RORC,
+/// reads the flash, so the cards are read concurrently.
+std::vector<CardDescriptor> discoverDevices()
+{
+  std::vector<std::future<CardDescriptor>> futures;
+  for (const auto& type : deviceTypes) {
+    for (const auto& pciDevice : Pda::PdaDevice::getPciDevices(type.pciId)) {
+      futures.push_back(std::async(std::launch::async, [&type, pciDevice]{
+        return CardDescriptor{type.cardType, type.getSerial(pciDevice), type.pciId, addressFromDevice(pciDevice),
+          PciDevice_getNumaNode(pciDevice.get())};
+      }));
+    }
+  }
+
+  std::vector<CardDescriptor> cards;
+  for (auto& future : futures) {
+    future.wait();
+  }
+  for (auto& future : futures) {
+    cards.push_back(future.get());
+  }
+  return cards;
+}
+
+/// Makes a fingerprint of the ReadoutCard devices in sysfs, from their addresses and the modification times of their
+/// directories. The on-disk cache is only valid while this does not change.
+std::string getSysfsFingerprint()
+{
+  namespace bfs = boost::filesystem;
+  const bfs::path devicesPath("/sys/bus/pci/devices");
+  std::vector<std::string> entries;
+  for (const auto& entry : boost::make_iterator_range(bfs::directory_iterator(devicesPath), {})) {
+    auto readId = [&](const std::string& file) {
+      std::string id;
+      bfs::ifstream stream(entry.path() / file);
+      stream >> id;
+      return boost::algorithm::starts_with(id, "0x") ? id.substr(2) : id;
+    };
+    auto vendor = readId("vendor");
+    auto device = readId("device");
+    for (const auto& type : deviceTypes) {
+      if (type.pciId.vendor == vendor && type.pciId.device == device) {
+        entries.push_back(entry.path().filename().string() + "@"
+            + std::to_string(bfs::last_write_time(bfs::canonical(entry.path()))));
+      }
+    }
+  }
+  std::sort(entries.begin(), entries.end());
+  return boost::algorithm::join(entries, ",");
+}
+
+/// Reads the on-disk cache. The first line holds the sysfs fingerprint, the others one card each:
+/// "[card type] [serial or -] [vendor ID] [device ID] [PCI address] [NUMA node]"
+/// \return False if the file does not exist, has a different fingerprint, or could not be parsed
+bool readCacheFile(const std::string& path, const std::string& fingerprint, std::vector<CardDescriptor>& cards)
+{
+  std::ifstream stream(path);
+  std::string line;
+  if (!std::getline(stream, line) || line != fingerprint) {
+    return false;
+  }
+
+  std::vector<CardDescriptor> read;
+  while (std::getline(stream, line)) {
+    std::istringstream lineStream(line);
+    std::string type, serial, vendor, device, address;
+    int32_t numaNode;
+    if (!(lineStream >> type >> serial >> vendor >> device >> address >> numaNode)) {
+      return false;
+    }
+    auto pciAddress = PciAddress::fromString(address);
+    if (!pciAddress) {
+      return false;
+    }
+    boost::optional<int> serialNumber;
+    if (serial != "-") {
+      serialNumber = boost::lexical_cast<int>(serial);
+    }
+    read.push_back(CardDescriptor{CardType::fromString(type), serialNumber, PciId{device, vendor}, *pciAddress,
+        numaNode});
+  }
+  cards = std::move(read);
+  return true;
+}
+
+/// Writes the on-disk cache. A temporary file is renamed over the old one, so concurrent readers never see a
+/// partially written file.
+void writeCacheFile(const std::string& path, const std::string& fingerprint, const std::vector<CardDescriptor>& cards)
+{
+  auto temporaryPath = path + "." + std::to_string(getpid());
+  {
+    std::ofstream stream(temporaryPath);
+    stream << fingerprint << '\n';
+    for (const auto& card : cards) {
+      stream << CardType::toString(card.cardType) << ' '
+          << (card.serialNumber ? std::to_string(*card.serialNumber) : std::string("-")) << ' '
+          << card.pciId.vendor << ' ' << card.pciId.device << ' ' << card.pciAddress.toString() << ' '
+          << card.numaNode << '\n';
+    }
+    if (!stream) {
+      return;
+    }
+  }
+  std::rename(temporaryPath.c_str(), path.c_str());
+}
+
+/// Fills the cache if it is not valid. The cache's mutex must be held.
+void fillDeviceCache(DeviceCache& cache)
+{
+  if (cache.valid) {
+    return;
+  }
+
+  // The on-disk cache is a shortcut only, if anything goes wrong with it we just enumerate
+  bool fromFile = false;
+  std::string fingerprint;
+  if (!cache.filePath.empty()) {
+    try {
+      fingerprint = getSysfsFingerprint();
+      fromFile = readCacheFile(cache.filePath, fingerprint, cache.cards);
+    }
+    catch (const std::exception&) {
+      fingerprint.clear();
+    }
+  }
+
+  if (!fromFile) {
+    cache.cards = discoverDevices();
+    if (!cache.filePath.empty() && !fingerprint.empty()) {
+      writeCacheFile(cache.filePath, fingerprint, cache.cards);
+    }
+  }
+
+  cache.bySerial.clear();
+  cache.byAddress.clear();
+  for (const auto& card : cache.cards) {
+    if (card.serialNumber) {
+      cache.bySerial[*card.serialNumber].push_back(card);
+    }
+    cache.byAddress[card.pciAddress.toString()].push_back(card);
+  }
+  cache.valid = true;
+}
 } // Anonymous namespace
 
+bool RocPciDevice::initWithDescriptor(const CardDescriptor& descriptor)
+{
+  mPdaDevice = Pda::PdaDevice::getPdaDevice(descriptor.pciId);
+  for (const auto& pciDevice : mPdaDevice->getPciDevices(mPdaDevice)) {
+    if (addressFromDevice(pciDevice) == descriptor.pciAddress) {
+      Utilities::resetSmartPtr(mPciDevice, pciDevice);
+      mDescriptor = descriptor;
+      return true;
+    }
+  }
+  return false;
+}
+
 void RocPciDevice::initWithSerial(int serialNumber)
 {
   try {
-    for (const auto& type : deviceTypes) {
-      mPdaDevice = Pda::PdaDevice::getPdaDevice(type.pciId);
-      for (auto& pciDevice : mPdaDevice->getPciDevices(mPdaDevice)) {
-        if (type.getSerial(pciDevice) == serialNumber) {
-          Utilities::resetSmartPtr(mPciDevice, pciDevice);
-          mDescriptor = CardDescriptor{type.cardType, serialNumber, type.pciId, addressFromDevice(pciDevice), PciDevice_getNumaNode(pciDevice.get())};
-          return;
-        }
+    // The device cache gives us the card's address, so we don't have to read the serial of every card again.
+    // If the cached card is gone, the cache is stale, so we try again with a fresh one.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+      auto cards = findSystemDevices(serialNumber);
+      if (!cards.empty() && initWithDescriptor(cards.at(0))) {
+        return;
       }
+      invalidateSystemDevicesCache();
     }
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not find card"));
   }
@@ -82,15 +260,12 @@ void RocPciDevice::initWithSerial(int serialNumber)
 void RocPciDevice::initWithAddress(const PciAddress& address)
 {
   try {
-    for (const auto& type : deviceTypes) {
-      mPdaDevice = Pda::PdaDevice::getPdaDevice(type.pciId);
-      for (const auto& pciDevice : mPdaDevice->getPciDevices(mPdaDevice)) {
-        if (addressFromDevice(pciDevice) == address) {
-          Utilities::resetSmartPtr(mPciDevice, pciDevice);
-          mDescriptor = CardDescriptor { type.cardType, type.getSerial(pciDevice), type.pciId, address, PciDevice_getNumaNode(pciDevice.get())};
-          return;
-        }
+    for (int attempt = 0; attempt < 2; ++attempt) {
+      auto cards = findSystemDevices(address);
+      if (!cards.empty() && initWithDescriptor(cards.at(0))) {
+        return;
       }
+      invalidateSystemDevicesCache();
     }
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not find card"));
   } catch (boost::exception& e) {
@@ -128,55 +303,61 @@ RocPciDevice::~RocPciDevice()
 
 std::vector<CardDescriptor> RocPciDevice::findSystemDevices()
 {
-  std::vector<CardDescriptor> cards;
-  for (const auto& type : deviceTypes) {
-    for (const auto& pciDevice : Pda::PdaDevice::getPciDevices(type.pciId)) {
-      cards.push_back(CardDescriptor{type.cardType, type.getSerial(pciDevice), type.pciId,
-        addressFromDevice(pciDevice), PciDevice_getNumaNode(pciDevice.get())});
-    }
-  }
-  return cards;
+  auto& cache = getDeviceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  fillDeviceCache(cache);
+  return cache.cards;
 }
 
 std::vector<CardDescriptor> RocPciDevice::findSystemDevices(int serialNumber)
 {
-  std::vector<CardDescriptor> cards;
   try {
-    for (const auto& type : deviceTypes) {
-      for (const auto& pciDevice : Pda::PdaDevice::getPciDevices(type.pciId)) {
-        if (type.getSerial(pciDevice) == serialNumber) {
-          cards.push_back(CardDescriptor{type.cardType, type.getSerial(pciDevice), type.pciId,
-                  addressFromDevice(pciDevice), PciDevice_getNumaNode(pciDevice.get())});
-        }
-      }
-    }
+    auto& cache = getDeviceCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    fillDeviceCache(cache);
+    auto iter = cache.bySerial.find(serialNumber);
+    return iter != cache.bySerial.end() ? iter->second : std::vector<CardDescriptor>();
   }
   catch (boost::exception& e) {
     e << ErrorInfo::SerialNumber(serialNumber);
     addPossibleCauses(e, {"Invalid serial number search target"});
     throw;
   }
-  return cards;
 }
 
 std::vector<CardDescriptor> RocPciDevice::findSystemDevices(const PciAddress& address)
 {
-  std::vector<CardDescriptor> cards;
   try {
-    for (const auto& type : deviceTypes) {
-      for (const auto& pciDevice : Pda::PdaDevice::getPciDevices(type.pciId)) {
-        if (addressFromDevice(pciDevice) == address) {
-          cards.push_back(CardDescriptor{type.cardType, type.getSerial(pciDevice), type.pciId, address, PciDevice_getNumaNode(pciDevice.get())});
-        }
-      }
-    }
+    auto& cache = getDeviceCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    fillDeviceCache(cache);
+    auto iter = cache.byAddress.find(address.toString());
+    return iter != cache.byAddress.end() ? iter->second : std::vector<CardDescriptor>();
   }
   catch (boost::exception& e) {
     e << ErrorInfo::PciAddress(address);
     addPossibleCauses(e, {"Invalid PCI address search target"});
     throw;
   }
-  return cards;
+}
+
+void RocPciDevice::invalidateSystemDevicesCache()
+{
+  auto& cache = getDeviceCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.valid = false;
+  }
+  Pda::PdaDevice::invalidateDeviceCache();
+  Pda::PdaBarCache::clear();
+  CruBar::invalidateCardInfoCache();
+}
+
+void RocPciDevice::setSystemDevicesCacheFile(const std::string& path)
+{
+  auto& cache = getDeviceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.filePath = path;
 }
 
 void RocPciDevice::printDeviceInfo(std::ostream& ostream)
@@ -207,17 +388,19 @@ void RocPciDevice::printDeviceInfo(std::ostream& ostream)
   ostream << f % "BAR type" << barTypeString;
 }
 
+// The BARs are mapped through the process-wide cache, so the channels opened after the enumeration reuse the mappings
+
 boost::optional<int32_t> cruGetSerial(Pda::PdaDevice::PdaPciDevice pciDevice)
 {
-  std::shared_ptr<Pda::PdaBar> pdaBar2;
-  Utilities::resetSmartPtr(pdaBar2, pciDevice, 2);
+  auto pdaBar2 = Pda::PdaBarCache::getBar(pciDevice, addressFromDevice(pciDevice), 2);
   return CruBar(pdaBar2).getSerial();
 }
 
 boost::optional<int32_t> crorcGetSerial(Pda::PdaDevice::PdaPciDevice pciDevice)
 {
-  Pda::PdaBar pdaBar(pciDevice, 0); // Must use BAR 0 to access flash
-  return Crorc::getSerial(pdaBar);
+  // Must use BAR 0 to access flash
+  auto pdaBar = Pda::PdaBarCache::getBar(pciDevice, addressFromDevice(pciDevice), 0);
+  return Crorc::getSerial(*pdaBar);
 }
 
 } // namespace roc
@@ -71,11 +71,27 @@ class RocPciDevice
     // Finds ReadoutCard devices on the system with the given address
     static std::vector<CardDescriptor> findSystemDevices(const PciAddress& address);
 
+    /// The findSystemDevices() functions enumerate the devices once per process and keep the result in a cache, so
+    /// later lookups by serial number or PCI address are O(1). This discards the cache, so the next lookup enumerates
+    /// the devices again. Use it after cards were added, removed, or reflashed. It also drops the process-wide PDA device
+    /// and BAR mappings, so the cards are opened again.
+    static void invalidateSystemDevicesCache();
+
+    /// Enables the on-disk device cache, which lets separate processes skip the enumeration and serial readout.
+    /// The file is only used while the sysfs directories of the cards keep the modification times they had when it
+    /// was written, which changes when devices are removed or rescanned.
+    /// \param path Path of the cache file. An empty string disables the on-disk cache.
+    static void setSystemDevicesCacheFile(const std::string& path);
+
   private:
 
     void initWithSerial(int serialNumber);
     void initWithAddress(const PciAddress& address);
 
+    /// Opens the PCI device of a card found by findSystemDevices()
+    /// \return False if the card is no longer on the system
+    bool initWithDescriptor(const CardDescriptor& descriptor);
+
     Pda::PdaDevice::SharedPdaDevice mPdaDevice;
     std::unique_ptr<Pda::PdaDevice::PdaPciDevice> mPciDevice;
     CardDescriptor mDescriptor;
@@ -0,0 +1,228 @@
+/// \file SharedMemoryBuffer.cxx
+/// \brief Implementation of the SharedMemoryBuffer class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/SharedMemoryBuffer.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+#include "Utilities/Hugetlbfs.h"
+#include "Utilities/Wait.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Marks an initialized segment, "ROCSHMBF"
+constexpr uint64_t MAGIC = 0x524f4353484d4246;
+constexpr uint32_t VERSION = 2;
+constexpr size_t BUFFER_PATH_LENGTH = 256;
+constexpr size_t SEGMENT_ALIGNMENT = 4096;
+
+size_t roundUp(size_t size, size_t alignment)
+{
+  return ((size + alignment - 1) / alignment) * alignment;
+}
+
+/// Distance between the rings in the segment
+size_t getRingStride(size_t capacity)
+{
+  return roundUp(SuperpageRing::getRequiredSize(capacity), SuperpageRing::CACHE_LINE_SIZE);
+}
+
+/// Pointers of one process are meaningless in the other
+Superpage withoutPointers(Superpage superpage)
+{
+  superpage.setUserData(nullptr);
+  superpage.setPageLengths(nullptr);
+  return superpage;
+}
+
+} // Anonymous namespace
+
+/// Layout of the start of the ring segment. It is followed by the memory of the ready ring, and then that of the free
+/// ring, both aligned to a cache line.
+struct SharedMemoryBuffer::Header
+{
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint64_t bufferSize;
+    uint64_t ringCapacity;
+    char bufferPath[BUFFER_PATH_LENGTH];
+    /// Incremented by every consumer that calls attach()
+    std::atomic<uint64_t> attachRequest;
+    /// Latest attach request granted by the driver
+    std::atomic<uint64_t> attachGranted;
+};
+
+SharedMemoryBuffer::SharedMemoryBuffer(const std::string& name, size_t bufferSize, size_t ringCapacity,
+    boost::optional<int> numaNode)
+{
+  mBufferFile = Utilities::tryMapFile(bufferSize, "AliceO2_RoC_Shared_" + name, true, nullptr, numaNode);
+  init(name, ringCapacity, true);
+}
+
+SharedMemoryBuffer::SharedMemoryBuffer(const std::string& name, const std::string& bufferPath, size_t bufferSize,
+    size_t ringCapacity)
+{
+  mBufferFile = std::make_unique<MemoryMappedFile>(bufferPath, bufferSize, true);
+  init(name, ringCapacity, true);
+}
+
+SharedMemoryBuffer::SharedMemoryBuffer(const std::string& name)
+{
+  init(name, 0, false);
+}
+
+SharedMemoryBuffer::~SharedMemoryBuffer()
+{
+}
+
+std::string SharedMemoryBuffer::getRingPath(const std::string& name)
+{
+  return "/dev/shm/AliceO2_RoC_Shared_" + name + "_rings";
+}
+
+void SharedMemoryBuffer::init(const std::string& name, size_t ringCapacity, bool create)
+{
+  const auto ringPath = getRingPath(name);
+  const size_t ringOffset = getRingOffset();
+
+  if (create) {
+    if (ringCapacity == 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Shared buffer ring capacity must be greater than 0"));
+    }
+    if (mBufferFile->getFileName().size() >= BUFFER_PATH_LENGTH) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Shared buffer file path too long")
+          << ErrorInfo::Filename(mBufferFile->getFileName()));
+    }
+
+    // A segment left behind by a crashed process must not be attached to while we initialize it
+    boost::filesystem::remove(ringPath);
+    auto segmentSize = roundUp(ringOffset + 2 * getRingStride(ringCapacity), SEGMENT_ALIGNMENT);
+    mRingFile = std::make_unique<MemoryMappedFile>(ringPath, segmentSize, true);
+    std::memset(mRingFile->getAddress(), 0, segmentSize);
+
+    mHeader = new (mRingFile->getAddress()) Header;
+    mHeader->version = VERSION;
+    mHeader->bufferSize = mBufferFile->getSize();
+    mHeader->ringCapacity = ringCapacity;
+    std::strncpy(mHeader->bufferPath, mBufferFile->getFileName().c_str(), BUFFER_PATH_LENGTH - 1);
+  } else {
+    if (!boost::filesystem::exists(ringPath)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Shared buffer does not exist")
+          << ErrorInfo::Filename(ringPath));
+    }
+    auto segmentSize = boost::filesystem::file_size(ringPath);
+    if (segmentSize < sizeof(Header)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Shared buffer segment too small")
+          << ErrorInfo::Filename(ringPath));
+    }
+    mRingFile = std::make_unique<MemoryMappedFile>(ringPath, segmentSize, false);
+    mHeader = static_cast<Header*>(mRingFile->getAddress());
+
+    if (mHeader->magic.load(std::memory_order_acquire) != MAGIC || mHeader->version != VERSION) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Shared buffer segment not initialized or incompatible")
+          << ErrorInfo::Filename(ringPath));
+    }
+    ringCapacity = mHeader->ringCapacity;
+    if ((ringOffset + 2 * getRingStride(ringCapacity)) > segmentSize) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Shared buffer segment too small for its rings")
+          << ErrorInfo::Filename(ringPath));
+    }
+    mBufferFile = std::make_unique<MemoryMappedFile>(std::string(mHeader->bufferPath), mHeader->bufferSize, false);
+  }
+
+  mapRings(create);
+
+  if (create) {
+    // Consumers may attach from here on
+    mHeader->magic.store(MAGIC, std::memory_order_release);
+  }
+}
+
+size_t SharedMemoryBuffer::getRingOffset()
+{
+  return roundUp(sizeof(Header), SuperpageRing::CACHE_LINE_SIZE);
+}
+
+void SharedMemoryBuffer::mapRings(bool initialize)
+{
+  const size_t ringCapacity = mHeader->ringCapacity;
+  auto rings = static_cast<char*>(mRingFile->getAddress()) + getRingOffset();
+  mReadyRing = std::make_unique<SuperpageRing>(rings, ringCapacity, initialize);
+  mFreeRing = std::make_unique<SuperpageRing>(rings + getRingStride(ringCapacity), ringCapacity, initialize);
+}
+
+bool SharedMemoryBuffer::attach(std::chrono::milliseconds timeout)
+{
+  const auto request = mHeader->attachRequest.fetch_add(1, std::memory_order_acq_rel) + 1;
+  auto granted = [&]{ return mHeader->attachGranted.load(std::memory_order_acquire) >= request; };
+  if (!Utilities::spinThenSleep(granted, timeout, std::chrono::nanoseconds(0))) {
+    return false;
+  }
+  // The driver emptied the rings, so the indices this side cached are outdated
+  mapRings(false);
+  return true;
+}
+
+bool SharedMemoryBuffer::acceptAttach()
+{
+  const auto request = mHeader->attachRequest.load(std::memory_order_acquire);
+  if (request == mHeader->attachGranted.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  mapRings(true);
+  mHeader->attachGranted.store(request, std::memory_order_release);
+  return true;
+}
+
+void* SharedMemoryBuffer::getAddress() const
+{
+  return mBufferFile->getAddress();
+}
+
+size_t SharedMemoryBuffer::getSize() const
+{
+  return mBufferFile->getSize();
+}
+
+size_t SharedMemoryBuffer::getRingCapacity() const
+{
+  return mHeader->ringCapacity;
+}
+
+buffer_parameters::Memory SharedMemoryBuffer::getBufferParameters() const
+{
+  return buffer_parameters::Memory{getAddress(), getSize()};
+}
+
+bool SharedMemoryBuffer::pushReady(const Superpage& superpage)
+{
+  return mReadyRing->write(withoutPointers(superpage));
+}
+
+bool SharedMemoryBuffer::popFree(Superpage& superpage)
+{
+  return mFreeRing->read(superpage);
+}
+
+bool SharedMemoryBuffer::popReady(Superpage& superpage)
+{
+  if (mReadyRing->read(superpage)) {
+    superpage.setReady(true);
+    return true;
+  }
+  return false;
+}
+
+bool SharedMemoryBuffer::pushFree(const Superpage& superpage)
+{
+  return mFreeRing->write(withoutPointers(superpage));
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,125 @@
+/// \file SuperpageAllocator.cxx
+/// \brief Implementation of the SuperpageAllocator class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/SuperpageAllocator.h"
+#include "ExceptionInternal.h"
+#include "Utilities/Util.h"
+
+namespace AliceO2 {
+namespace roc {
+
+constexpr size_t SuperpageAllocator::MIN_SUPERPAGE_SIZE;
+
+SuperpageAllocator::SuperpageAllocator(size_t regionOffset, size_t regionSize, size_t maxSuperpageSize,
+    uint16_t bufferId)
+    : mMaxOrder(0), mBufferId(bufferId)
+{
+  if (!Utilities::isMultiple(maxSuperpageSize, MIN_SUPERPAGE_SIZE)
+      || !Utilities::isPowerOfTwo(maxSuperpageSize / MIN_SUPERPAGE_SIZE)) {
+    BOOST_THROW_EXCEPTION(ParameterException()
+        << ErrorInfo::Message("Maximum superpage size must be a power-of-two multiple of 32 KiB")
+        << ErrorInfo::SuperpageSize(maxSuperpageSize));
+  }
+  while (getBlockSize(mMaxOrder) < maxSuperpageSize) {
+    mMaxOrder++;
+  }
+  mFree.resize(mMaxOrder + 1);
+
+  // Carve the region into the largest blocks that are aligned to their size
+  const size_t end = regionOffset + regionSize;
+  size_t offset = ((regionOffset + MIN_SUPERPAGE_SIZE - 1) / MIN_SUPERPAGE_SIZE) * MIN_SUPERPAGE_SIZE;
+  while (offset < end && (end - offset) >= MIN_SUPERPAGE_SIZE) {
+    int order = mMaxOrder;
+    while (order > 0 && ((offset % getBlockSize(order)) != 0 || getBlockSize(order) > (end - offset))) {
+      order--;
+    }
+    mFree[order].insert(offset);
+    mAvailable += getBlockSize(order);
+    offset += getBlockSize(order);
+  }
+
+  if (mAvailable == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException()
+        << ErrorInfo::Message("Allocator region does not fit a superpage")
+        << ErrorInfo::Range(regionSize));
+  }
+}
+
+bool SuperpageAllocator::tryAllocate(size_t size, Superpage& superpage)
+{
+  if (size == 0 || size > getMaxSuperpageSize()) {
+    BOOST_THROW_EXCEPTION(ParameterException()
+        << ErrorInfo::Message("Superpage size must be between 1 byte and the maximum superpage size")
+        << ErrorInfo::SuperpageSize(size));
+  }
+  int order = 0;
+  while (getBlockSize(order) < size) {
+    order++;
+  }
+
+  // Split the smallest free block that is large enough
+  int from = order;
+  while (from <= mMaxOrder && mFree[from].empty()) {
+    from++;
+  }
+  if (from > mMaxOrder) {
+    return false;
+  }
+  const size_t offset = *mFree[from].begin();
+  mFree[from].erase(mFree[from].begin());
+  while (from > order) {
+    from--;
+    mFree[from].insert(offset + getBlockSize(from));
+  }
+
+  mAllocated[offset] = order;
+  mAvailable -= getBlockSize(order);
+  superpage = Superpage(offset, getBlockSize(order));
+  superpage.setBufferId(mBufferId);
+  return true;
+}
+
+void SuperpageAllocator::release(const Superpage& superpage)
+{
+  auto it = mAllocated.find(superpage.getOffset());
+  if (it == mAllocated.end() || superpage.getBufferId() != mBufferId) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Could not release superpage, it was not allocated or already released")
+        << ErrorInfo::Offset(superpage.getOffset())
+        << ErrorInfo::BufferId(superpage.getBufferId()));
+  }
+  const int order = it->second;
+  mAllocated.erase(it);
+  mAvailable += getBlockSize(order);
+  free(superpage.getOffset(), order);
+}
+
+void SuperpageAllocator::free(size_t offset, int order)
+{
+  while (order < mMaxOrder) {
+    // Blocks are aligned to their size, so the buddy differs in one bit of the offset
+    auto buddy = mFree[order].find(offset ^ getBlockSize(order));
+    if (buddy == mFree[order].end()) {
+      break;
+    }
+    mFree[order].erase(buddy);
+    offset &= ~getBlockSize(order);
+    order++;
+  }
+  mFree[order].insert(offset);
+}
+
+size_t SuperpageAllocator::getLargestAvailable() const
+{
+  for (int order = mMaxOrder; order >= 0; --order) {
+    if (!mFree[order].empty()) {
+      return getBlockSize(order);
+    }
+  }
+  return 0;
+}
+
+} // namespace roc
+} // namespace AliceO2
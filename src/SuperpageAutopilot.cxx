@@ -0,0 +1,190 @@
+/// \file SuperpageAutopilot.cxx
+/// \brief Implementation of the SuperpageAutopilot class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/SuperpageAutopilot.h"
+#include <algorithm>
+#include <set>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Maximum amount of superpages handled by one poll()
+constexpr size_t BATCH_SIZE = 32;
+
+} // Anonymous namespace
+
+SuperpageAutopilot::SuperpageAutopilot(std::shared_ptr<DmaChannelInterface> channel, size_t regionOffset,
+    size_t regionSize, size_t superpageSize, uint16_t bufferId)
+    : mChannel(std::move(channel)), mSuperpageCount(superpageSize == 0 ? 0 : regionSize / superpageSize),
+      mSuperpageSize(superpageSize), mLinkAffine(false), mBatch(BATCH_SIZE)
+{
+  if (mSuperpageCount == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException()
+        << ErrorInfo::Message("Autopilot region does not fit a superpage")
+        << ErrorInfo::Range(regionSize)
+        << ErrorInfo::SuperpageSize(superpageSize));
+  }
+  addPool(0, regionOffset, mSuperpageCount, superpageSize, bufferId);
+}
+
+SuperpageAutopilot::SuperpageAutopilot(std::shared_ptr<DmaChannelInterface> channel, size_t regionOffset,
+    size_t regionSize, size_t superpageSize, const std::vector<LinkRate>& links, uint16_t bufferId)
+    : mChannel(std::move(channel)), mSuperpageCount(superpageSize == 0 ? 0 : regionSize / superpageSize),
+      mSuperpageSize(superpageSize), mLinkAffine(true), mBatch(BATCH_SIZE)
+{
+  if (links.empty() || mSuperpageCount < links.size()) {
+    BOOST_THROW_EXCEPTION(ParameterException()
+        << ErrorInfo::Message("Autopilot region does not fit a superpage for every link")
+        << ErrorInfo::Range(regionSize)
+        << ErrorInfo::SuperpageSize(superpageSize));
+  }
+  double totalRate = 0;
+  std::set<uint32_t> linkIds;
+  for (const auto& link : links) {
+    if (!(link.rate >= 0)) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Link rate must not be negative")
+          << ErrorInfo::LinkId(link.linkId));
+    }
+    if (!linkIds.insert(link.linkId).second) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Link given more than once")
+          << ErrorInfo::LinkId(link.linkId));
+    }
+    totalRate += link.rate;
+  }
+
+  // Every link gets one superpage, and the rest is shared by rate. What rounding down leaves goes to the links that
+  // lost the largest fractions.
+  const size_t shared = mSuperpageCount - links.size();
+  std::vector<size_t> counts(links.size(), 1);
+  std::vector<std::pair<double, size_t>> fractions;
+  size_t assigned = 0;
+  for (size_t i = 0; i < links.size(); ++i) {
+    const double share = (totalRate > 0) ? shared * (links[i].rate / totalRate) : double(shared) / links.size();
+    const auto whole = std::min(shared - assigned, size_t(share));
+    counts[i] += whole;
+    assigned += whole;
+    fractions.emplace_back(share - whole, i);
+  }
+  std::stable_sort(fractions.begin(), fractions.end(),
+      [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) { return a.first > b.first; });
+  for (size_t i = 0; assigned < shared; i = (i + 1) % fractions.size(), ++assigned) {
+    counts[fractions[i].second]++;
+  }
+
+  size_t offset = regionOffset;
+  for (size_t i = 0; i < links.size(); ++i) {
+    addPool(links[i].linkId, offset, counts[i], superpageSize, bufferId);
+    offset += counts[i] * superpageSize;
+  }
+}
+
+void SuperpageAutopilot::addPool(uint32_t linkId, size_t offset, size_t superpageCount, size_t superpageSize,
+    uint16_t bufferId)
+{
+  Pool pool;
+  pool.arena = Arena{linkId, offset, superpageCount};
+  // Pushed in order of offset, since fill() takes them from the back
+  pool.free.reserve(superpageCount);
+  for (size_t i = superpageCount; i > 0; --i) {
+    Superpage superpage(offset + (i - 1) * superpageSize, superpageSize);
+    superpage.setBufferId(bufferId);
+    pool.free.push_back(superpage);
+  }
+  mPools.push_back(std::move(pool));
+}
+
+auto SuperpageAutopilot::getPool(const Superpage& superpage) -> Pool&
+{
+  if (!mLinkAffine) {
+    return mPools.front();
+  }
+  auto it = std::upper_bound(mPools.begin(), mPools.end(), superpage.getOffset(),
+      [](size_t offset, const Pool& pool) { return offset < pool.arena.offset; });
+  if (it == mPools.begin() || superpage.getOffset() >= (std::prev(it)->arena.offset
+      + std::prev(it)->arena.superpageCount * mSuperpageSize)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Released superpage is not in an arena of the autopilot")
+        << ErrorInfo::Offset(superpage.getOffset()));
+  }
+  return *std::prev(it);
+}
+
+bool SuperpageAutopilot::give(Pool& pool, const Superpage& superpage)
+{
+  if (mLinkAffine) {
+    auto recycled = superpage;
+    recycled.setReady(false);
+    recycled.setReceived(0);
+    return mChannel->tryPushSuperpageToLink(recycled, pool.arena.linkId);
+  }
+  if (superpage.isChecked()) {
+    // Released before, so the channel can skip its checks
+    if (mChannel->getTransferQueueAvailable() == 0) {
+      return false;
+    }
+    mChannel->releaseSuperpage(superpage);
+    return true;
+  }
+  return mChannel->tryPushSuperpage(superpage);
+}
+
+void SuperpageAutopilot::fill()
+{
+  for (auto& pool : mPools) {
+    // A full link queue only stops its own arena
+    while (!pool.free.empty() && give(pool, pool.free.back())) {
+      pool.free.pop_back();
+    }
+  }
+  mChannel->fillSuperpages();
+}
+
+bool SuperpageAutopilot::tryGetSuperpage(Superpage& superpage)
+{
+  fill();
+  return mChannel->tryPopSuperpage(superpage);
+}
+
+void SuperpageAutopilot::release(const Superpage& superpage)
+{
+  auto& pool = getPool(superpage);
+  if (!give(pool, superpage)) {
+    pool.free.push_back(superpage);
+  }
+}
+
+size_t SuperpageAutopilot::getFreeCount() const
+{
+  size_t count = 0;
+  for (const auto& pool : mPools) {
+    count += pool.free.size();
+  }
+  return count;
+}
+
+auto SuperpageAutopilot::getArenas() const -> std::vector<Arena>
+{
+  std::vector<Arena> arenas;
+  if (mLinkAffine) {
+    for (const auto& pool : mPools) {
+      arenas.push_back(pool.arena);
+    }
+  }
+  return arenas;
+}
+
+size_t SuperpageAutopilot::getLinkFreeCount(uint32_t linkId) const
+{
+  for (const auto& pool : mPools) {
+    if (mLinkAffine && pool.arena.linkId == linkId) {
+      return pool.free.size();
+    }
+  }
+  return 0;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,57 @@
+/// \file SuperpageFlushWatch.h
+/// \brief Definition of the SuperpageFlushWatch class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_READOUTCARD_SRC_SUPERPAGEFLUSHWATCH_H_
+#define ALICEO2_READOUTCARD_SRC_SUPERPAGEFLUSHWATCH_H_
+
+#include <chrono>
+#include <cstddef>
+
+namespace AliceO2 {
+namespace roc {
+
+/// Watches the superpage a link is filling, to find out when it got no new data for the SuperpageFlushTimeout.
+/// The backends feed it the state of the superpage on every fillSuperpages(), so the idle time is measured from the
+/// first call that saw the current received size.
+class SuperpageFlushWatch
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Checks if the superpage should be flushed
+    /// \param offset Offset of the superpage, which tells superpages apart
+    /// \param received Received size of the superpage
+    /// \param timeout Time without new data after which the superpage is flushed
+    /// \param now Current time
+    /// \return True if the superpage received data, and its received size did not change for the timeout
+    bool isIdle(size_t offset, size_t received, std::chrono::nanoseconds timeout, Clock::time_point now)
+    {
+      if (offset != mOffset || received != mReceived) {
+        mOffset = offset;
+        mReceived = received;
+        mSince = now;
+        return false;
+      }
+      return received != 0 && (now - mSince) >= timeout;
+    }
+
+    /// Forgets the watched superpage
+    void reset()
+    {
+      mOffset = 0;
+      mReceived = 0;
+      mSince = Clock::time_point();
+    }
+
+  private:
+    size_t mOffset = 0;
+    size_t mReceived = 0;
+    Clock::time_point mSince;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_SUPERPAGEFLUSHWATCH_H_
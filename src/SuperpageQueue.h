@@ -6,9 +6,8 @@
 #ifndef ALICEO2_READOUTCARD_SRC_SUPERPAGEQUEUE_H_
 #define ALICEO2_READOUTCARD_SRC_SUPERPAGEQUEUE_H_
 
-#include <iostream>
-#include <unordered_map>
-#include <boost/circular_buffer.hpp>
+#include <cstdint>
+#include <vector>
 #include "ReadoutCard/Superpage.h"
 #include "ExceptionInternal.h"
 
@@ -17,14 +16,75 @@ namespace roc {
 
 /// Queue to handle superpages
 /// We keep this header-only to make it inlineable, since these are all very short and simple functions.
-template <size_t MAX_SUPERPAGES>
+/// The capacity is set at construction, after which the queue does not allocate.
 class SuperpageQueue {
   public:
-    using Id = uint8_t;
-    using Queue = boost::circular_buffer<Id>;
+    using Id = uint32_t;
 
-    SuperpageQueue()
+    /// Fixed-capacity ring of IDs
+    class Queue
     {
+      public:
+        explicit Queue(size_t capacity) : mIds(capacity)
+        {
+        }
+
+        bool empty() const
+        {
+          return mSize == 0;
+        }
+
+        size_t size() const
+        {
+          return mSize;
+        }
+
+        Id front() const
+        {
+          return mIds[mFront];
+        }
+
+        Id back() const
+        {
+          return mIds[wrap(mFront + mSize - 1)];
+        }
+
+        void push_back(Id id)
+        {
+          mIds[wrap(mFront + mSize)] = id;
+          mSize++;
+        }
+
+        void pop_front()
+        {
+          mFront = wrap(mFront + 1);
+          mSize--;
+        }
+
+        void clear()
+        {
+          mFront = 0;
+          mSize = 0;
+        }
+
+      private:
+        size_t wrap(size_t index) const
+        {
+          return index < mIds.size() ? index : index - mIds.size();
+        }
+
+        std::vector<Id> mIds;
+        size_t mFront = 0;
+        size_t mSize = 0;
+    };
+
+    /// \param capacity Maximum amount of superpages in the queue
+    explicit SuperpageQueue(size_t capacity)
+        : mCapacity(capacity), mRegistry(capacity), mPushing(capacity), mArrivals(capacity), mFilled(capacity)
+    {
+      if (capacity == 0) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Superpage queue capacity must be larger than 0"));
+      }
       clear();
     }
 
@@ -103,19 +163,8 @@ class SuperpageQueue {
         BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not enqueue superpage, queue full"));
       }
 
-      auto id = mNextId;
-
-#ifndef NDEBUG
-      if (isValidEntry(mRegistry.at(id))) {
-        BOOST_THROW_EXCEPTION(
-            Exception() << ErrorInfo::Message("Could not enqueue superpage, would overwrite index ID already in use")
-                << ErrorInfo::Index(id) << ErrorInfo::FifoSize(getQueueCount()));
-      }
-#endif
-
+      auto id = allocateId();
       mRegistry[id] = entry; // We don't use getEntry() because it checks for entry validity
-      mNextId = (mNextId + 1) % MAX_SUPERPAGES;
-      mNumberOfEntries++;
 
       mPushing.push_back(id);
       mArrivals.push_back(id);
@@ -165,6 +214,67 @@ class SuperpageQueue {
       return id;
     }
 
+    /// Splits the received part off the front superpage of the arrivals queue, and puts it in the filled queue as a
+    /// superpage of its own. The front entry keeps the rest of the superpage, so the pages that were already pushed
+    /// into it stay owned by the queue.
+    /// \param pageSize Size of the pages, the received size must be a multiple of it
+    /// \return ID of the split off superpage
+    Id splitArrivalsFront(size_t pageSize)
+    {
+      if (mArrivals.empty()) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not split superpage, arrivals was empty"));
+      }
+      if (isFull()) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not split superpage, queue full"));
+      }
+
+      auto& front = getArrivalsFrontEntry();
+      const auto received = front.superpage.getReceived();
+      const int pages = received / pageSize;
+      if (pages == 0 || received == front.superpage.getSize()) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not split superpage, nothing to split off"));
+      }
+
+      SuperpageQueueEntry split = front;
+      split.superpage.setSize(received);
+      split.superpage.setReady(true);
+      split.superpage.setSplit(true);
+      split.pushedPages = pages;
+      split.maxPages = pages;
+
+      front.superpage.setOffset(front.superpage.getOffset() + received);
+      front.superpage.setSize(front.superpage.getSize() - received);
+      front.superpage.setReceived(0);
+      if (auto pageLengths = front.superpage.getPageLengths()) {
+        front.superpage.setPageLengths(pageLengths + pages);
+      }
+      front.busAddress += received;
+      front.pushedPages -= pages;
+      front.maxPages -= pages;
+
+      auto id = allocateId();
+      mRegistry[id] = split;
+      mFilled.push_back(id);
+      return id;
+    }
+
+    /// Moves all superpages of the arrivals queue to the filled queue with what they received so far, for when the DMA
+    /// stopped and the card will not fill them any further. Their pages are no longer pushed either, so the pushing
+    /// queue is cleared.
+    /// \return Amount of superpages moved
+    size_t reclaimArrivals()
+    {
+      size_t count = 0;
+      while (!mArrivals.empty()) {
+        auto id = mArrivals.front();
+        getEntry(id).superpage.setReady(true);
+        mFilled.push_back(id);
+        mArrivals.pop_front();
+        count++;
+      }
+      mPushing.clear();
+      return count;
+    }
 
     /// Removes a superpage that's completely filled from the filled queue, ending the 'lifecycle' of the superpage
     SuperpageQueueEntry removeFromFilledQueue()
@@ -190,12 +300,12 @@ class SuperpageQueue {
 
     int getQueueAvailable() const
     {
-      return MAX_SUPERPAGES - getQueueCount();
+      return mCapacity - getQueueCount();
     }
 
     int getQueueCapacity() const
     {
-      return MAX_SUPERPAGES;
+      return mCapacity;
     }
 
     int isEmpty() const
@@ -205,7 +315,7 @@ class SuperpageQueue {
 
     int isFull() const
     {
-      return getQueueCount() == MAX_SUPERPAGES;
+      return size_t(getQueueCount()) == mCapacity;
     }
 
     const Queue& getPushing() const
@@ -267,25 +377,36 @@ class SuperpageQueue {
 
   private:
 
+    /// Takes a free registry slot. Split off superpages leave the queue before the one they came from, so the slots are
+    /// not always freed in the order they were taken.
+    Id allocateId()
+    {
+      auto id = mNextId;
+      while (isValidEntry(mRegistry[id])) {
+        id = (id + 1) % mCapacity;
+      }
+      mNextId = (id + 1) % mCapacity;
+      mNumberOfEntries++;
+      return id;
+    }
+
     static constexpr int PUSHED_PAGES_INVALID = -1;
+    const size_t mCapacity;
     int mNumberOfEntries = 0;
     Id mNextId = 0;
 
     /// Registry for superpages
     /// The queues contain an ID that's used as a key for this registry.
-    std::array<SuperpageQueueEntry, MAX_SUPERPAGES> mRegistry;
+    std::vector<SuperpageQueueEntry> mRegistry;
 
     /// Queue for superpages that can be pushed into
-    Queue mPushing { MAX_SUPERPAGES };
+    Queue mPushing;
 
     /// Queue for superpages that must be checked for arrivals
-    Queue mArrivals { MAX_SUPERPAGES };
+    Queue mArrivals;
 
     /// Queue for superpages that are filled
-    Queue mFilled { MAX_SUPERPAGES };
-
-    static_assert(MAX_SUPERPAGES <= (size_t(std::numeric_limits<Id>::max()) + 1),
-        "Id type can't handle amount of entries");
+    Queue mFilled;
 };
 
 
@@ -0,0 +1,618 @@
+/// \file SuperpageRecorder.cxx
+/// \brief Implementation of the SuperpageRecorder and SuperpageRecording classes.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/SuperpageRecorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#ifdef ALICEO2_READOUTCARD_LZ4_ENABLED
+# include <lz4.h>
+#endif
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+# include <zstd.h>
+#endif
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Identifies an index file, and the version of its format
+constexpr char INDEX_MAGIC[8] = {'R', 'O', 'C', 'S', 'P', 'R', 'C', '1'};
+
+static_assert(sizeof(SuperpageRecorder::IndexEntry) == 32, "Index entries are written to the file as they are");
+
+std::string errnoString()
+{
+  return std::strerror(errno);
+}
+
+size_t roundUp(size_t size, size_t alignment)
+{
+  return ((size + alignment - 1) / alignment) * alignment;
+}
+
+bool isAligned(const void* data, size_t size)
+{
+  return (reinterpret_cast<uintptr_t>(data) % SuperpageRecorder::DIRECT_ALIGNMENT) == 0
+      && (size % SuperpageRecorder::DIRECT_ALIGNMENT) == 0;
+}
+
+/// Compresses with the context of a worker thread, so the contexts are not allocated per superpage
+class Compressor
+{
+  public:
+    Compressor(SuperpageRecorder::Compression compression, int level)
+        : mCompression(compression), mLevel(level)
+    {
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+      if (mCompression == SuperpageRecorder::Compression::Zstd) {
+        mZstdContext = ZSTD_createCCtx();
+      }
+#endif
+    }
+
+    ~Compressor()
+    {
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+      ZSTD_freeCCtx(mZstdContext);
+#endif
+    }
+
+    /// Gets the size the destination needs for data of the given size
+    size_t getBound(size_t size) const
+    {
+      switch (mCompression) {
+#ifdef ALICEO2_READOUTCARD_LZ4_ENABLED
+        case SuperpageRecorder::Compression::Lz4:
+          return size_t(LZ4_compressBound(int(size)));
+#endif
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+        case SuperpageRecorder::Compression::Zstd:
+          return ZSTD_compressBound(size);
+#endif
+        default:
+          return size;
+      }
+    }
+
+    /// \return The compressed size, 0 if the compression failed
+    size_t compress(const void* source, size_t size, void* destination, size_t capacity)
+    {
+      (void) source; (void) size; (void) destination; (void) capacity;
+      switch (mCompression) {
+#ifdef ALICEO2_READOUTCARD_LZ4_ENABLED
+        case SuperpageRecorder::Compression::Lz4:
+          return size_t(std::max(0, LZ4_compress_fast(static_cast<const char*>(source),
+              static_cast<char*>(destination), int(size), int(capacity), std::max(1, mLevel))));
+#endif
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+        case SuperpageRecorder::Compression::Zstd: {
+          auto result = ZSTD_compressCCtx(mZstdContext, destination, capacity, source, size, mLevel);
+          return ZSTD_isError(result) ? 0 : result;
+        }
+#endif
+        default:
+          return 0;
+      }
+    }
+
+  private:
+    SuperpageRecorder::Compression mCompression;
+    int mLevel;
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+    ZSTD_CCtx* mZstdContext = nullptr;
+#endif
+};
+
+/// Decompresses data of an index entry
+/// \return The decompressed size, or -1 if the data is corrupt
+long decompress(SuperpageRecorder::Compression compression, const void* source, size_t size, void* destination,
+    size_t capacity)
+{
+  (void) source; (void) size; (void) destination; (void) capacity;
+  switch (compression) {
+#ifdef ALICEO2_READOUTCARD_LZ4_ENABLED
+    case SuperpageRecorder::Compression::Lz4:
+      return std::max(-1, LZ4_decompress_safe(static_cast<const char*>(source), static_cast<char*>(destination),
+          int(size), int(capacity)));
+#endif
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+    case SuperpageRecorder::Compression::Zstd: {
+      auto result = ZSTD_decompress(destination, capacity, source, size);
+      return ZSTD_isError(result) ? -1 : long(result);
+    }
+#endif
+    default:
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Recording compressed with an unavailable compression"));
+  }
+}
+
+/// Opens a stripe, with O_DIRECT if the file system supports it
+int openStripe(const std::string& path, bool& direct)
+{
+  int fileDescriptor = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+  direct = (fileDescriptor != -1);
+  if (!direct && errno == EINVAL) {
+    fileDescriptor = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  }
+  if (fileDescriptor == -1) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open recorder stripe: " + errnoString())
+        << ErrorInfo::Filename(path));
+  }
+  return fileDescriptor;
+}
+
+/// Memory aligned for O_DIRECT, which grows as needed
+class AlignedBuffer
+{
+  public:
+    char* get(size_t size)
+    {
+      if (size > mSize) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, SuperpageRecorder::DIRECT_ALIGNMENT,
+            roundUp(size, SuperpageRecorder::DIRECT_ALIGNMENT)) != 0) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to allocate recorder buffer"));
+        }
+        mMemory.reset(static_cast<char*>(memory));
+        mSize = size;
+      }
+      return mMemory.get();
+    }
+
+  private:
+    struct Free
+    {
+        void operator()(char* memory)
+        {
+          std::free(memory);
+        }
+    };
+
+    std::unique_ptr<char, Free> mMemory;
+    size_t mSize = 0;
+};
+
+} // Anonymous namespace
+
+constexpr size_t SuperpageRecorder::DIRECT_ALIGNMENT;
+
+struct SuperpageRecorder::Slot
+{
+    Superpage superpage;
+    const char* data = nullptr;
+    IndexEntry entry;
+    /// Compressed data, or a padded copy of data that is not aligned for O_DIRECT
+    AlignedBuffer buffer;
+    /// What the writer writes, padded if the stripe uses O_DIRECT
+    const char* writeData = nullptr;
+    size_t writeSize = 0;
+    bool done = false;
+    std::exception_ptr error;
+};
+
+struct SuperpageRecorder::Stripe
+{
+    std::string path;
+    int fileDescriptor = -1;
+    bool direct = false;
+    /// Offset of the next write. Only the writer thread uses it.
+    uint64_t offset = 0;
+    std::deque<Slot*> queue;
+    std::condition_variable work;
+    std::thread thread;
+};
+
+auto SuperpageRecorder::compressionFromString(const std::string& string) -> Compression
+{
+  auto lower = boost::algorithm::to_lower_copy(string);
+  if (lower == "none") {
+    return Compression::None;
+  } else if (lower == "lz4") {
+    return Compression::Lz4;
+  } else if (lower == "zstd") {
+    return Compression::Zstd;
+  }
+  BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Invalid compression") << ErrorInfo::String(string));
+}
+
+bool SuperpageRecorder::isCompressionAvailable(Compression compression)
+{
+  switch (compression) {
+    case Compression::None:
+      return true;
+    case Compression::Lz4:
+#ifdef ALICEO2_READOUTCARD_LZ4_ENABLED
+      return true;
+#else
+      return false;
+#endif
+    case Compression::Zstd:
+#ifdef ALICEO2_READOUTCARD_ZSTD_ENABLED
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+SuperpageRecorder::SuperpageRecorder(const Options& options)
+    : mOptions(options)
+{
+  if (mOptions.stripePaths.empty()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Recorder needs at least one stripe"));
+  }
+  if (mOptions.queueDepth == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Recorder queue depth must be greater than 0"));
+  }
+  if (!isCompressionAvailable(mOptions.compression)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Recorder compression not available")
+        << ErrorInfo::PossibleCauses({"The library was built without LZ4 or zstd"}));
+  }
+  if (mOptions.compression != Compression::None && mOptions.compressionThreads == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Recorder compression needs at least one thread"));
+  }
+  if (mOptions.indexPath.empty()) {
+    mOptions.indexPath = mOptions.stripePaths[0] + ".index";
+  }
+
+  for (size_t i = 0; i < mOptions.queueDepth; ++i) {
+    mSlots.push_back(std::make_unique<Slot>());
+  }
+
+  // The index names the stripes, so a recording is replayed with the index alone
+  mIndex.open(mOptions.indexPath, std::ios::binary | std::ios::trunc);
+  mIndex.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  const auto stripeCount = uint32_t(mOptions.stripePaths.size());
+  mIndex.write(reinterpret_cast<const char*>(&stripeCount), sizeof(stripeCount));
+  for (const auto& path : mOptions.stripePaths) {
+    const auto length = uint32_t(path.size());
+    mIndex.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    mIndex.write(path.data(), length);
+  }
+  mIndex.flush();
+  if (!mIndex) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to write recorder index")
+        << ErrorInfo::Filename(mOptions.indexPath));
+  }
+
+  try {
+    for (const auto& path : mOptions.stripePaths) {
+      auto stripe = std::make_unique<Stripe>();
+      stripe->path = path;
+      stripe->fileDescriptor = openStripe(path, stripe->direct);
+      mStripes.push_back(std::move(stripe));
+    }
+  }
+  catch (...) {
+    for (auto& stripe : mStripes) {
+      close(stripe->fileDescriptor);
+    }
+    throw;
+  }
+
+  for (auto& stripe : mStripes) {
+    auto pointer = stripe.get();
+    stripe->thread = std::thread([this, pointer]{ writeLoop(*pointer); });
+  }
+  if (mOptions.compression != Compression::None) {
+    for (size_t i = 0; i < mOptions.compressionThreads; ++i) {
+      mCompressThreads.emplace_back([this]{ compressLoop(); });
+    }
+  }
+}
+
+SuperpageRecorder::~SuperpageRecorder()
+{
+  std::vector<Superpage> superpages(mOptions.queueDepth);
+  while (getInFlight() > 0) {
+    try {
+      reap(superpages.data(), superpages.size(), true);
+    }
+    catch (const std::exception&) {
+      // Nothing more we can do with a failed write here
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCompressWork.notify_all();
+  for (auto& thread : mCompressThreads) {
+    thread.join();
+  }
+  for (auto& stripe : mStripes) {
+    stripe->work.notify_all();
+    stripe->thread.join();
+    close(stripe->fileDescriptor);
+  }
+}
+
+bool SuperpageRecorder::write(const Superpage& superpage, const void* data, size_t size)
+{
+  if (getInFlight() >= mOptions.queueDepth) {
+    return false;
+  }
+
+  auto& slot = *mSlots[mSubmitted % mOptions.queueDepth];
+  slot.superpage = superpage;
+  slot.data = static_cast<const char*>(data);
+  slot.entry.offset = 0;
+  slot.entry.storedSize = size;
+  slot.entry.size = size;
+  slot.entry.stripe = uint32_t(mSubmitted % mStripes.size());
+  slot.entry.compression = Compression::None;
+  slot.writeData = slot.data;
+  slot.writeSize = size;
+  slot.done = false;
+  slot.error = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mOptions.compression != Compression::None) {
+      mCompressQueue.push_back(&slot);
+      mCompressWork.notify_one();
+    } else {
+      queueWrite(slot);
+    }
+  }
+  mSubmitted++;
+  return true;
+}
+
+size_t SuperpageRecorder::reap(Superpage* superpages, size_t max, bool wait)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  if (wait && getInFlight() > 0 && max > 0) {
+    auto& next = *mSlots[mReaped % mOptions.queueDepth];
+    mFinished.wait(lock, [&]{ return next.done; });
+  }
+
+  // All finished superpages are handled before reporting a failed one, so no slot is lost
+  size_t count = 0;
+  std::exception_ptr error;
+  while (count < max && getInFlight() > 0) {
+    auto& slot = *mSlots[mReaped % mOptions.queueDepth];
+    if (!slot.done) {
+      break;
+    }
+    mReaped++;
+    if (slot.error) {
+      error = error ? error : slot.error;
+      continue;
+    }
+    mIndex.write(reinterpret_cast<const char*>(&slot.entry), sizeof(slot.entry));
+    mBytesRecorded += slot.entry.size;
+    mBytesStored += slot.entry.storedSize;
+    superpages[count++] = slot.superpage;
+  }
+  lock.unlock();
+
+  if (count > 0) {
+    mIndex.flush();
+    if (!mIndex) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to write recorder index")
+          << ErrorInfo::Filename(mOptions.indexPath));
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return count;
+}
+
+bool SuperpageRecorder::isDirect() const
+{
+  return std::all_of(mStripes.begin(), mStripes.end(), [](const std::unique_ptr<Stripe>& s) { return s->direct; });
+}
+
+void SuperpageRecorder::queueWrite(Slot& slot)
+{
+  auto& stripe = *mStripes[slot.entry.stripe];
+  stripe.queue.push_back(&slot);
+  stripe.work.notify_one();
+}
+
+void SuperpageRecorder::finish(Slot& slot, std::exception_ptr error)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  slot.error = error;
+  slot.done = true;
+  mFinished.notify_all();
+}
+
+void SuperpageRecorder::compressLoop()
+{
+  Compressor compressor(mOptions.compression, mOptions.compressionLevel);
+  while (true) {
+    Slot* slot;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCompressWork.wait(lock, [&]{ return mStop || !mCompressQueue.empty(); });
+      if (mCompressQueue.empty()) {
+        return;
+      }
+      slot = mCompressQueue.front();
+      mCompressQueue.pop_front();
+    }
+
+    try {
+      const size_t size = slot->entry.size;
+      const size_t capacity = compressor.getBound(size);
+      auto buffer = slot->buffer.get(roundUp(capacity, DIRECT_ALIGNMENT));
+      const size_t compressed = compressor.compress(slot->data, size, buffer, capacity);
+      // Data that doesn't get smaller, such as random data, is stored as it is
+      if (compressed > 0 && compressed < size) {
+        slot->entry.compression = mOptions.compression;
+        slot->entry.storedSize = compressed;
+        slot->writeData = buffer;
+        slot->writeSize = compressed;
+      }
+    }
+    catch (...) {
+      finish(*slot, std::current_exception());
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    queueWrite(*slot);
+  }
+}
+
+void SuperpageRecorder::writeLoop(Stripe& stripe)
+{
+  while (true) {
+    Slot* slot;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      stripe.work.wait(lock, [&]{ return mStop || !stripe.queue.empty(); });
+      if (stripe.queue.empty()) {
+        return;
+      }
+      slot = stripe.queue.front();
+      stripe.queue.pop_front();
+    }
+
+    try {
+      const char* data = slot->writeData;
+      size_t size = slot->writeSize;
+      if (stripe.direct && !isAligned(data, size)) {
+        // Padded in place when it's already the slot's buffer, copied into it otherwise
+        const size_t padded = roundUp(size, DIRECT_ALIGNMENT);
+        if (data != slot->buffer.get(0)) {
+          auto buffer = slot->buffer.get(padded);
+          std::memcpy(buffer, data, size);
+          data = buffer;
+        }
+        std::memset(const_cast<char*>(data) + size, 0, padded - size);
+        size = padded;
+      }
+
+      slot->entry.offset = stripe.offset;
+      size_t written = 0;
+      while (written < size) {
+        auto result = pwrite(stripe.fileDescriptor, data + written, size - written, stripe.offset + written);
+        if (result < 0 && errno == EINTR) {
+          continue;
+        }
+        if (result <= 0) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Recorder write failed: " + errnoString())
+              << ErrorInfo::Filename(stripe.path) << ErrorInfo::Offset(stripe.offset + written));
+        }
+        written += size_t(result);
+      }
+      stripe.offset += size;
+      finish(*slot, nullptr);
+    }
+    catch (...) {
+      finish(*slot, std::current_exception());
+    }
+  }
+}
+
+SuperpageRecording::SuperpageRecording(const std::string& indexPath)
+{
+  auto malformed = [&](const std::string& message) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Malformed recorder index: " + message)
+        << ErrorInfo::Filename(indexPath));
+  };
+
+  std::ifstream index(indexPath, std::ios::binary);
+  if (!index.is_open()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open recorder index")
+        << ErrorInfo::Filename(indexPath));
+  }
+  char magic[sizeof(INDEX_MAGIC)];
+  uint32_t stripeCount = 0;
+  if (!index.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), INDEX_MAGIC)) {
+    malformed("unknown format");
+  }
+  if (!index.read(reinterpret_cast<char*>(&stripeCount), sizeof(stripeCount)) || stripeCount == 0) {
+    malformed("no stripes");
+  }
+  for (uint32_t i = 0; i < stripeCount; ++i) {
+    uint32_t length = 0;
+    index.read(reinterpret_cast<char*>(&length), sizeof(length));
+    std::string path(length, '\0');
+    if (!index.read(&path[0], length)) {
+      malformed("truncated stripe path");
+    }
+    mStripePaths.push_back(path);
+  }
+
+  SuperpageRecorder::IndexEntry entry;
+  while (index.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+    if (entry.stripe >= stripeCount || entry.storedSize > entry.size) {
+      malformed("invalid entry");
+    }
+    mEntries.push_back(entry);
+  }
+  if (index.gcount() != 0) {
+    malformed("truncated entry");
+  }
+
+  for (const auto& path : mStripePaths) {
+    int fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor == -1) {
+      auto message = "Failed to open recorder stripe: " + errnoString();
+      for (auto descriptor : mFileDescriptors) {
+        close(descriptor);
+      }
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(message) << ErrorInfo::Filename(path));
+    }
+    mFileDescriptors.push_back(fileDescriptor);
+  }
+}
+
+SuperpageRecording::~SuperpageRecording()
+{
+  for (auto fileDescriptor : mFileDescriptors) {
+    close(fileDescriptor);
+  }
+}
+
+size_t SuperpageRecording::read(size_t index, void* destination, size_t capacity)
+{
+  const auto& entry = mEntries.at(index);
+  if (capacity < entry.size) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Destination too small for recorded superpage")
+        << ErrorInfo::Range(capacity));
+  }
+
+  const bool compressed = entry.compression != SuperpageRecorder::Compression::None;
+  if (compressed) {
+    mCompressed.resize(entry.storedSize);
+  }
+  auto data = compressed ? mCompressed.data() : static_cast<char*>(destination);
+  size_t done = 0;
+  while (done < entry.storedSize) {
+    auto result = pread(mFileDescriptors[entry.stripe], data + done, entry.storedSize - done, entry.offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(result < 0
+          ? "Failed to read recorded superpage: " + errnoString() : "Recorded superpage truncated")
+          << ErrorInfo::Filename(mStripePaths[entry.stripe]) << ErrorInfo::Offset(entry.offset + done));
+    }
+    done += size_t(result);
+  }
+
+  if (compressed && decompress(entry.compression, data, entry.storedSize, destination, capacity) != long(entry.size)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to decompress recorded superpage")
+        << ErrorInfo::Filename(mStripePaths[entry.stripe]) << ErrorInfo::Offset(entry.offset));
+  }
+  return entry.size;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,176 @@
+/// \file SuperpageRing.cxx
+/// \brief Implementation of the SuperpageRing class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/SuperpageRing.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Ring indices must be lock-free to be shared between processes");
+
+/// Indices of the ring. They only increase, the slot is the index modulo the capacity. The producer only writes
+/// writeIndex and the consumer only writes readIndex.
+struct SuperpageRing::Control
+{
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writeIndex;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> readIndex;
+};
+
+/// A superpage in the ring, with a fixed layout so both sides of a shared memory ring agree on it
+struct alignas(SuperpageRing::CACHE_LINE_SIZE) SuperpageRing::Entry
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t received;
+    uint64_t timestamp;
+    uint64_t pushTimestamp;
+    uint64_t userData;
+    uint64_t pageLengths;
+    uint32_t linkId;
+    uint32_t ready;
+
+    void set(const Superpage& superpage)
+    {
+      offset = superpage.getOffset();
+      size = superpage.getSize();
+      received = superpage.getReceived();
+      timestamp = superpage.getTimestamp();
+      pushTimestamp = superpage.getPushTimestamp();
+      userData = reinterpret_cast<uintptr_t>(superpage.getUserData());
+      pageLengths = reinterpret_cast<uintptr_t>(superpage.getPageLengths());
+      linkId = superpage.getLinkId();
+      ready = superpage.isReady();
+    }
+
+    void get(Superpage& superpage) const
+    {
+      superpage = Superpage(offset, size, reinterpret_cast<void*>(userData));
+      superpage.setReceived(received);
+      superpage.setTimestamp(timestamp);
+      superpage.setPushTimestamp(pushTimestamp);
+      superpage.setPageLengths(reinterpret_cast<uint32_t*>(pageLengths));
+      superpage.setLinkId(linkId);
+      superpage.setReady(ready != 0);
+    }
+};
+
+constexpr size_t SuperpageRing::CACHE_LINE_SIZE;
+
+namespace {
+
+void checkCapacity(size_t capacity)
+{
+  if (capacity == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Superpage ring capacity must be greater than 0"));
+  }
+}
+
+void* allocateRing(size_t capacity)
+{
+  checkCapacity(capacity);
+  void* memory = nullptr;
+  if (posix_memalign(&memory, SuperpageRing::CACHE_LINE_SIZE, SuperpageRing::getRequiredSize(capacity)) != 0) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+} // Anonymous namespace
+
+size_t SuperpageRing::getRequiredSize(size_t capacity)
+{
+  static_assert(sizeof(Entry) == CACHE_LINE_SIZE, "Ring entry must fit in a cache line");
+  return sizeof(Control) + capacity * sizeof(Entry);
+}
+
+SuperpageRing::SuperpageRing(size_t capacity)
+    : SuperpageRing(allocateRing(capacity), capacity, true)
+{
+  // Nothing can throw after the allocation, the other constructor's checks already passed
+  mOwnedMemory.reset(mControl);
+}
+
+SuperpageRing::SuperpageRing(void* memory, size_t capacity, bool initialize)
+    : mOwnedMemory(nullptr, std::free), mCapacity(capacity)
+{
+  checkCapacity(capacity);
+  if ((reinterpret_cast<uintptr_t>(memory) % CACHE_LINE_SIZE) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Superpage ring memory not aligned to a cache line")
+        << ErrorInfo::Address(reinterpret_cast<uintptr_t>(memory)));
+  }
+
+  if (initialize) {
+    mControl = new (memory) Control;
+    mControl->writeIndex.store(0, std::memory_order_relaxed);
+    mControl->readIndex.store(0, std::memory_order_release);
+  } else {
+    mControl = static_cast<Control*>(memory);
+  }
+  mEntries = reinterpret_cast<Entry*>(static_cast<char*>(memory) + sizeof(Control));
+  mCachedReadIndex = mControl->readIndex.load(std::memory_order_acquire);
+  mCachedWriteIndex = mControl->writeIndex.load(std::memory_order_acquire);
+}
+
+SuperpageRing::~SuperpageRing()
+{
+}
+
+bool SuperpageRing::write(const Superpage& superpage)
+{
+  return write(&superpage, 1) == 1;
+}
+
+size_t SuperpageRing::write(const Superpage* superpages, size_t count)
+{
+  const auto writeIndex = mControl->writeIndex.load(std::memory_order_relaxed);
+  if ((writeIndex - mCachedReadIndex + count) > mCapacity) {
+    mCachedReadIndex = mControl->readIndex.load(std::memory_order_acquire);
+  }
+  const size_t free = mCapacity - (writeIndex - mCachedReadIndex);
+  const size_t written = std::min(count, free);
+  for (size_t i = 0; i < written; ++i) {
+    mEntries[(writeIndex + i) % mCapacity].set(superpages[i]);
+  }
+  if (written > 0) {
+    mControl->writeIndex.store(writeIndex + written, std::memory_order_release);
+  }
+  return written;
+}
+
+bool SuperpageRing::read(Superpage& superpage)
+{
+  return read(&superpage, 1) == 1;
+}
+
+size_t SuperpageRing::read(Superpage* superpages, size_t max)
+{
+  const auto readIndex = mControl->readIndex.load(std::memory_order_relaxed);
+  if ((mCachedWriteIndex - readIndex) < max) {
+    mCachedWriteIndex = mControl->writeIndex.load(std::memory_order_acquire);
+  }
+  const size_t available = mCachedWriteIndex - readIndex;
+  const size_t count = std::min(max, available);
+  for (size_t i = 0; i < count; ++i) {
+    mEntries[(readIndex + i) % mCapacity].get(superpages[i]);
+  }
+  if (count > 0) {
+    mControl->readIndex.store(readIndex + count, std::memory_order_release);
+  }
+  return count;
+}
+
+size_t SuperpageRing::sizeGuess() const
+{
+  // The read index is loaded first, so it can't be ahead of the write index
+  const auto readIndex = mControl->readIndex.load(std::memory_order_acquire);
+  return mControl->writeIndex.load(std::memory_order_acquire) - readIndex;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,64 @@
+/// \file SuperpageSizeTuner.cxx
+/// \brief Implementation of the SuperpageSizeTuner class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/SuperpageSizeTuner.h"
+#include <algorithm>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// Weight of a new rate measurement in the average
+constexpr double RATE_SMOOTHING = 0.25;
+
+} // Anonymous namespace
+
+SuperpageSizeTuner::SuperpageSizeTuner(std::vector<size_t> sizes, std::chrono::nanoseconds latencyTarget)
+    : mSizes(std::move(sizes)), mLatencyTarget(latencyTarget)
+{
+  if (mSizes.empty() || std::find(mSizes.begin(), mSizes.end(), 0) != mSizes.end()) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Superpage sizes must be given and not be 0"));
+  }
+  std::sort(mSizes.begin(), mSizes.end());
+  mSizes.erase(std::unique(mSizes.begin(), mSizes.end()), mSizes.end());
+}
+
+void SuperpageSizeTuner::update(const ChannelStatistics& statistics, Clock::time_point now)
+{
+  for (const auto& linkStatistics : statistics.links) {
+    auto inserted = mLinks.emplace(linkStatistics.linkId, Link());
+    auto& link = inserted.first->second;
+    if (!inserted.second && now > link.time && linkStatistics.bytes >= link.bytes) {
+      double seconds = std::chrono::duration<double>(now - link.time).count();
+      double rate = double(linkStatistics.bytes - link.bytes) / seconds;
+      link.rate = (link.rate < 0) ? rate : link.rate + (rate - link.rate) * RATE_SMOOTHING;
+    }
+    link.bytes = linkStatistics.bytes;
+    link.time = now;
+  }
+}
+
+size_t SuperpageSizeTuner::getSuperpageSize(uint32_t linkId) const
+{
+  const double rate = getRate(linkId);
+  if (rate <= 0) {
+    return mSizes.front();
+  }
+  // The largest size the link fills within the target
+  const double maxBytes = rate * std::chrono::duration<double>(mLatencyTarget).count();
+  auto it = std::upper_bound(mSizes.begin(), mSizes.end(), maxBytes,
+      [](double bytes, size_t size) { return bytes < double(size); });
+  return (it == mSizes.begin()) ? mSizes.front() : *std::prev(it);
+}
+
+double SuperpageSizeTuner::getRate(uint32_t linkId) const
+{
+  auto it = mLinks.find(linkId);
+  return (it == mLinks.end() || it->second.rate < 0) ? 0 : it->second.rate;
+}
+
+} // namespace roc
+} // namespace AliceO2
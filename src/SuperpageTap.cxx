@@ -0,0 +1,292 @@
+/// \file SuperpageTap.cxx
+/// \brief Implementation of the SuperpageTap class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/SuperpageTap.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "ExceptionInternal.h"
+
+// Older C library headers don't have the zero-copy definitions of Linux 4.14
+#ifndef SO_ZEROCOPY
+# define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+# define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+# define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+# define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+/// How long the sending thread waits for a client or for data before checking if it must stop
+constexpr int ACCEPT_TIMEOUT_MS = 100;
+constexpr int IDLE_TIMEOUT_MS = 1;
+/// Timeout of a send, so a client that stopped reading doesn't keep the thread from stopping
+constexpr timeval SEND_TIMEOUT = {0, 100 * 1000};
+
+std::string errnoString()
+{
+  return std::strerror(errno);
+}
+
+} // Anonymous namespace
+
+constexpr uint32_t SuperpageTap::SAMPLE_MAGIC;
+
+SuperpageTap::SuperpageTap(const Options& options)
+    : mOptions(options),
+      mSlotSize(sizeof(SampleHeader) + options.maxSampleSize),
+      mFree(std::max<size_t>(options.slots, 1)),
+      mFilled(std::max<size_t>(options.slots, 1))
+{
+  if (mOptions.sampleEvery == 0 || mOptions.slots == 0 || mOptions.maxSampleSize == 0) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Tap sample interval, slots and sample size must be greater than 0"));
+  }
+  for (auto link : mOptions.links) {
+    if (link >= 64) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Tap link ID must be below 64")
+          << ErrorInfo::LinkId(link));
+    }
+    mLinkMask |= uint64_t(1) << link;
+  }
+
+  mMemory.reset(new char[mOptions.slots * mSlotSize]);
+  for (size_t i = 0; i < mOptions.slots; ++i) {
+    mFree.write(Superpage(i * mSlotSize, mSlotSize));
+  }
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(mOptions.port);
+  if (inet_pton(AF_INET, mOptions.address.c_str(), &address.sin_addr) != 1) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Invalid tap address")
+        << ErrorInfo::String(mOptions.address));
+  }
+  mListenSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (mListenSocket == -1) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to create tap socket: " + errnoString()));
+  }
+  int reuse = 1;
+  setsockopt(mListenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  socklen_t length = sizeof(address);
+  if (bind(mListenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+      || listen(mListenSocket, 1) != 0
+      || getsockname(mListenSocket, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+    auto message = "Failed to listen on tap socket: " + errnoString();
+    close(mListenSocket);
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(message) << ErrorInfo::String(mOptions.address));
+  }
+  mPort = ntohs(address.sin_port);
+
+  mThread = std::thread([this]{ sendLoop(); });
+}
+
+SuperpageTap::~SuperpageTap()
+{
+  mStop = true;
+  mThread.join();
+  disconnectClient();
+  close(mListenSocket);
+}
+
+bool SuperpageTap::offer(const Superpage& superpage, const void* data, size_t size)
+{
+  const auto sequence = mOffered.load(std::memory_order_relaxed);
+  mOffered.store(sequence + 1, std::memory_order_relaxed);
+
+  const auto link = superpage.getLinkId();
+  if (mLinkMask != 0 && (link >= 64 || (mLinkMask & (uint64_t(1) << link)) == 0)) {
+    return false;
+  }
+  if ((mMatching++ % mOptions.sampleEvery) != 0 || !mConnected.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  Superpage slot;
+  if (!mFree.read(slot)) {
+    mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  SampleHeader header;
+  header.magic = SAMPLE_MAGIC;
+  header.linkId = link;
+  header.sequence = sequence;
+  header.size = std::min(size, mOptions.maxSampleSize);
+  header.received = size;
+  header.dropped = mDropped.load(std::memory_order_relaxed);
+  auto address = getSlotAddress(slot);
+  std::memcpy(address, &header, sizeof(header));
+  std::memcpy(address + sizeof(header), data, header.size);
+  slot.setReceived(sizeof(header) + header.size);
+  mFilled.write(slot);
+  mSampled.store(mSampled.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  return true;
+}
+
+void SuperpageTap::sendLoop()
+{
+  while (!mStop.load(std::memory_order_relaxed)) {
+    if (mClientSocket == -1) {
+      acceptClient();
+      continue;
+    }
+
+    reapCompletions();
+    Superpage slot;
+    if (mFilled.read(slot)) {
+      if (sendSlot(slot)) {
+        mSent.store(mSent.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      } else {
+        mFree.write(slot);
+        mDiscarded.store(mDiscarded.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        disconnectClient();
+      }
+      continue;
+    }
+
+    // Idle: notice a client that went away. Completions are signalled as errors, and reaped above.
+    pollfd descriptor = {mClientSocket, POLLRDHUP, 0};
+    if (poll(&descriptor, 1, IDLE_TIMEOUT_MS) > 0 && (descriptor.revents & (POLLRDHUP | POLLHUP))) {
+      disconnectClient();
+    }
+  }
+}
+
+void SuperpageTap::acceptClient()
+{
+  pollfd descriptor = {mListenSocket, POLLIN, 0};
+  if (poll(&descriptor, 1, ACCEPT_TIMEOUT_MS) <= 0) {
+    return;
+  }
+  int client = accept4(mListenSocket, nullptr, nullptr, SOCK_CLOEXEC);
+  if (client == -1) {
+    return;
+  }
+  setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &SEND_TIMEOUT, sizeof(SEND_TIMEOUT));
+  int enable = 1;
+  mZeroCopySupported = setsockopt(client, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+  mZeroCopy = mZeroCopySupported;
+  mZeroCopySends = 0;
+  // Samples offered while the previous client was going away
+  discardFilled();
+  mClientSocket = client;
+  mConnected.store(true, std::memory_order_release);
+}
+
+void SuperpageTap::disconnectClient()
+{
+  if (mClientSocket == -1) {
+    return;
+  }
+  mConnected.store(false, std::memory_order_release);
+  close(mClientSocket);
+  mClientSocket = -1;
+
+  // Without a client, the pages held by the socket are not sent anymore, so their slots can be reused
+  for (const auto& pending : mPending) {
+    mFree.write(pending.slot);
+  }
+  mPending.clear();
+  discardFilled();
+}
+
+void SuperpageTap::discardFilled()
+{
+  Superpage slot;
+  while (mFilled.read(slot)) {
+    mFree.write(slot);
+    mDiscarded.store(mDiscarded.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+}
+
+bool SuperpageTap::sendSlot(const Superpage& slot)
+{
+  const char* data = getSlotAddress(slot);
+  const size_t size = slot.getReceived();
+  size_t sent = 0;
+  bool zeroCopied = false;
+  while (sent < size) {
+    if (mStop.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    const int flags = MSG_NOSIGNAL | (mZeroCopySupported ? MSG_ZEROCOPY : 0);
+    auto result = send(mClientSocket, data + sent, size - sent, flags);
+    if (result < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+        // Interrupted, or the client is slow: the send timed out
+        continue;
+      }
+      if (errno == ENOBUFS && mZeroCopySupported) {
+        // Too much memory pinned by sends in flight, wait for some to complete
+        reapCompletions();
+        pollfd descriptor = {mClientSocket, 0, 0};
+        poll(&descriptor, 1, IDLE_TIMEOUT_MS);
+        continue;
+      }
+      return false;
+    }
+    if (mZeroCopySupported) {
+      mZeroCopySends++;
+      zeroCopied = true;
+    }
+    sent += size_t(result);
+  }
+
+  if (zeroCopied) {
+    // The kernel reads the data after send() returns, the slot is reused when it reports the send complete
+    mPending.push_back({slot, mZeroCopySends - 1});
+  } else {
+    mFree.write(slot);
+  }
+  return true;
+}
+
+void SuperpageTap::reapCompletions()
+{
+  while (!mPending.empty()) {
+    char control[128];
+    msghdr message = {};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (recvmsg(mClientSocket, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      return;
+    }
+    for (auto header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+      if (!((header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR)
+          || (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+      auto error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(header));
+      if (error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      mZeroCopy = (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) == 0;
+      // Sends ee_info to ee_data completed. TCP completes them in order, so all sends up to ee_data are done.
+      const uint32_t last = error->ee_data;
+      while (!mPending.empty() && int32_t(last - mPending.front().lastSend) >= 0) {
+        mFree.write(mPending.front().slot);
+        mPending.pop_front();
+      }
+    }
+  }
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -4,9 +4,11 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 #include "Swt/Swt.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include "ExceptionInternal.h"
 
 namespace AliceO2 {
 namespace roc {
@@ -75,6 +77,115 @@ uint32_t Swt::read(SwtWord& swtWord)
   return barRead(Registers::SWT_RD_WORD_MON);
 }
 
+uint32_t Swt::writeSequence(const std::vector<SwtWord>& swtWords)
+{
+  streamWords(swtWords.data(), swtWords.size());
+  return readMonitor();
+}
+
+void Swt::streamWords(const SwtWord* swtWords, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    const auto& swtWord = swtWords[i];
+    // The word registers are followed by the command register, so the word and its write command are one block
+    const uint32_t block[] = {uint32_t(swtWord.getLow()), uint32_t(swtWord.getMed()), swtWord.getHigh(), 0x1};
+    static_assert(Registers::SWT_WR_CMD == Registers::SWT_WR_WORD_L + 3, "SWT write registers not consecutive");
+    barWriteBlock(Registers::SWT_WR_WORD_L, block, 4);
+    barWrite(Registers::SWT_WR_CMD, 0x0); //void cmd to sync clocks, a posted write
+  }
+}
+
+uint32_t Swt::readMonitor()
+{
+  return barRead(Registers::SWT_RD_WORD_MON);
+}
+
+uint32_t Swt::readSequence(std::vector<SwtWord>& swtWords)
+{
+  if (swtWords.empty()) {
+    return barRead(Registers::SWT_RD_WORD_MON);
+  }
+
+  uint32_t block[4] = {0, 0, 0, 0};
+  for (auto& swtWord : swtWords) {
+    barWrite(Registers::SWT_RD_CMD, 0x2);
+    barWrite(Registers::SWT_RD_CMD, 0x0); // void cmd to sync clocks
+
+    // The reply registers are followed by the monitor register, 16-byte aligned, so this can be a single wide read
+    static_assert(Registers::SWT_RD_WORD_MON == Registers::SWT_RD_WORD_L + 3, "SWT read registers not consecutive");
+    barReadBlock(Registers::SWT_RD_WORD_L, block, 4);
+    swtWord.setLow(block[0]);
+    swtWord.setMed(block[1]);
+    swtWord.setHigh(block[2]);
+  }
+
+  return block[3];
+}
+
+constexpr size_t Swt::DEFAULT_BATCH_SIZE;
+
+auto Swt::executeSequences(RegisterReadWriteInterface& bar2, const std::map<int, Sequence>& sequences,
+    size_t batchSize) -> std::map<int, SequenceResult>
+{
+  if (batchSize == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("SWT batch size must be at least 1"));
+  }
+
+  std::map<int, SequenceResult> results;
+  if (sequences.empty()) {
+    return results;
+  }
+  Swt swt(bar2, sequences.begin()->first);
+
+  // Stops the sequence of a channel at its first error, the other channels go on
+  auto attempt = [&](int gbtChannel, auto function) {
+    auto& result = results[gbtChannel];
+    if (result.error) {
+      return false;
+    }
+    try {
+      function(result);
+      return true;
+    } catch (const std::exception& e) {
+      result.error = std::string(e.what());
+      return false;
+    }
+  };
+
+  bool pending = true;
+  while (pending) {
+    pending = false;
+    int lastChannel = -1;
+    for (const auto& sequence : sequences) {
+      const auto& writes = sequence.second.writes;
+      if (results[sequence.first].written == writes.size()) {
+        continue;
+      }
+      attempt(sequence.first, [&](SequenceResult& result) {
+        const size_t count = std::min(batchSize, writes.size() - result.written);
+        swt.setChannel(sequence.first);
+        swt.streamWords(writes.data() + result.written, count);
+        result.written += count;
+        lastChannel = sequence.first;
+        pending = pending || result.written < writes.size();
+      });
+    }
+    if (lastChannel != -1) {
+      // A read is not posted, so it returns once the writes of the round reached the card
+      attempt(lastChannel, [&](SequenceResult& result) { result.monitor = swt.readMonitor(); });
+    }
+  }
+
+  for (const auto& sequence : sequences) {
+    attempt(sequence.first, [&](SequenceResult& result) {
+      swt.setChannel(sequence.first);
+      result.reads.resize(sequence.second.readCount);
+      result.monitor = swt.readSequence(result.reads);
+    });
+  }
+  return results;
+}
+
 void Swt::barWrite(uint32_t offset, uint32_t data)
 {
   mBar2.writeRegister(Registers::SWT_BASE_INDEX + offset, data);
@@ -86,5 +197,15 @@ uint32_t Swt::barRead(uint32_t offset)
   return read;
 }
 
+void Swt::barWriteBlock(uint32_t offset, const uint32_t* data, size_t count)
+{
+  mBar2.writeRegisters(Registers::SWT_BASE_INDEX + offset, data, count);
+}
+
+void Swt::barReadBlock(uint32_t offset, uint32_t* data, size_t count)
+{
+  mBar2.readRegisters(Registers::SWT_BASE_INDEX + offset, data, count);
+}
+
 } //namespace roc
 } //namespace AliceO2
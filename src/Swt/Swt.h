@@ -6,7 +6,10 @@
 #ifndef ALICEO2_READOUTCARD_UTILITIES_SWT_H
 #define ALICEO2_READOUTCARD_UTILITIES_SWT_H
 
+#include <map>
 #include <string>
+#include <vector>
+#include <boost/optional.hpp>
 #include "ReadoutCard/RegisterReadWriteInterface.h"
 #include "Swt/SwtWord.h"
 
@@ -25,13 +28,65 @@ class Swt
     Swt(RegisterReadWriteInterface& bar2, int gbtChannel);
 
     void reset();
+    /// Switches the SWT core to another GBT channel
+    void setChannel(int gbtChannel);
     uint32_t write(SwtWord& swtWord);
     uint32_t read(SwtWord& swtWord);
 
+    /// Writes a sequence of words, streaming them to the firmware without waiting for each one. The monitor status is
+    /// read once, after the last word, which makes this a single round trip to the card instead of one per word.
+    /// The firmware's FIFO must be able to hold the whole sequence, so long sequences should be split in batches.
+    /// \param swtWords Words to write, in order
+    /// \return The monitor status after the last word
+    uint32_t writeSequence(const std::vector<SwtWord>& swtWords);
+
+    /// Reads a sequence of words. The words of a reply and the monitor status are read with a single block read, so
+    /// each word takes one round trip to the card instead of four.
+    /// \param swtWords Words to read into, as many as the vector holds
+    /// \return The monitor status after the last word
+    uint32_t readSequence(std::vector<SwtWord>& swtWords);
+
+    /// Words to write to a GBT channel, and amount of reply words to read after them
+    struct Sequence
+    {
+        std::vector<SwtWord> writes;
+        size_t readCount = 0;
+    };
+
+    /// Result of a sequence on a GBT channel
+    struct SequenceResult
+    {
+        /// Amount of words written
+        size_t written = 0;
+        /// Reply words read
+        std::vector<SwtWord> reads;
+        /// Last monitor status read on the channel
+        uint32_t monitor = 0;
+        /// Error message of the BAR access that failed, after which the sequence stopped. None if it completed.
+        boost::optional<std::string> error;
+    };
+
+    static constexpr size_t DEFAULT_BATCH_SIZE = 32;
+
+    /// Executes sequences on several GBT channels. There is a single SWT core, so the channels take turns: each turn
+    /// switches to a channel and streams a batch of its words as posted writes, so one channel's words go out on its
+    /// link while the next batches are written. The monitor status is read once per round of turns, which flushes the
+    /// posted writes, and once per channel at the end, with its reply words.
+    /// The firmware's FIFO must be able to hold a batch of words per channel.
+    /// \param bar2 SWT is on BAR 2
+    /// \param sequences Sequences per GBT channel
+    /// \param batchSize Maximum amount of words written to a channel in a turn
+    /// \return Results per GBT channel
+    static std::map<int, SequenceResult> executeSequences(RegisterReadWriteInterface& bar2,
+        const std::map<int, Sequence>& sequences, size_t batchSize = DEFAULT_BATCH_SIZE);
+
   private:
-    void setChannel(int gbtChannel);
+    void streamWords(const SwtWord* swtWords, size_t count);
+    uint32_t readMonitor();
     void barWrite(uint32_t offset, uint32_t data);
     uint32_t barRead(uint32_t index);
+    void barWriteBlock(uint32_t offset, const uint32_t* data, size_t count);
+    void barReadBlock(uint32_t offset, uint32_t* data, size_t count);
 
     RegisterReadWriteInterface& mBar2;
 };
@@ -3,6 +3,9 @@
 ///
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#ifndef ALICEO2_READOUTCARD_SWT_SWTWORD_H
+#define ALICEO2_READOUTCARD_SWT_SWTWORD_H
+
 #include <iostream>
 #include <cstdint>
 #include <cstddef>
@@ -74,7 +77,7 @@ class SwtWord
       uint16_t mHigh;
 };
  
-std::ostream& operator<< (std::ostream& stream, const SwtWord &swtWord){
+inline std::ostream& operator<< (std::ostream& stream, const SwtWord &swtWord){
   stream << "0x"  << std::setfill('0')<< std::hex << std::setw(4) << swtWord.getHigh()
      << std::setfill('0') << std::setw(8) << swtWord.getMed() << std::setfill('0') << std::setw(8) << swtWord.getLow();
   return stream;
@@ -82,3 +85,5 @@ std::ostream& operator<< (std::ostream& stream, const SwtWord &swtWord){
 
 } // namespace roc
 } // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SWT_SWTWORD_H
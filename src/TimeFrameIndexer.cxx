@@ -0,0 +1,88 @@
+/// \file TimeFrameIndexer.cxx
+/// \brief Implementation of the TimeFrameIndexer class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/TimeFrameIndexer.h"
+#include "Cru/SuperpageView.h"
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+
+constexpr size_t TimeFrameIndexer::MAX_LINKS;
+constexpr size_t TimeFrameIndexer::DMA_PAGE_SIZE;
+constexpr uint32_t TimeFrameIndexer::DEFAULT_TIME_FRAME_LENGTH;
+constexpr uint64_t TimeFrameIndexer::UNKNOWN;
+
+TimeFrameIndexer::TimeFrameIndexer(uint32_t timeFrameLength, size_t pageSize, bool packed)
+    : mTimeFrameLength(timeFrameLength), mPageSize(pageSize), mPacked(packed)
+{
+  if (timeFrameLength == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Time frame length must be at least 1 orbit"));
+  }
+  reset();
+}
+
+size_t TimeFrameIndexer::indexSuperpage(const void* address, size_t received, std::vector<TimeFrameSlice>& slices)
+{
+  slices.clear();
+  const auto begin = static_cast<const char*>(address);
+  size_t index = 0;
+  for (const auto& packet : Cru::SuperpageView(address, received, mPageSize, 0, false, mPacked)) {
+    const uint32_t timeFrame = getTimeFrame(packet.rdh.heartbeatOrbit);
+    if (slices.empty() || (packet.valid && timeFrame != slices.back().timeFrame)) {
+      if (!slices.empty()) {
+        slices.back().size = (packet.page - begin) - slices.back().offset;
+      }
+      TimeFrameSlice slice;
+      slice.timeFrame = timeFrame;
+      slice.firstOrbit = packet.rdh.heartbeatOrbit;
+      slice.lastOrbit = packet.rdh.heartbeatOrbit;
+      slice.linkId = packet.rdh.linkId;
+      slice.firstPacket = index;
+      slice.packets = 0;
+      slice.offset = packet.page - begin;
+      slice.size = 0;
+      slice.continued = (mLastTimeFrame[slice.linkId] == timeFrame);
+      slices.push_back(slice);
+    }
+    auto& slice = slices.back();
+    if (packet.valid) {
+      slice.lastOrbit = packet.rdh.heartbeatOrbit;
+    }
+    slice.packets++;
+    index++;
+  }
+
+  if (!slices.empty()) {
+    slices.back().size = received - slices.back().offset;
+    mLastTimeFrame[slices.back().linkId] = slices.back().timeFrame;
+  }
+  return slices.size();
+}
+
+std::vector<Superpage> TimeFrameIndexer::split(const Superpage& superpage, const std::vector<TimeFrameSlice>& slices)
+{
+  std::vector<Superpage> pieces;
+  pieces.reserve(slices.size());
+  for (const auto& slice : slices) {
+    Superpage piece = superpage;
+    piece.setOffset(superpage.getOffset() + slice.offset);
+    piece.setSize(slice.size);
+    piece.setReceived(slice.size);
+    piece.setReady(true);
+    // The page lengths are those of the whole superpage
+    piece.setPageLengths(nullptr);
+    pieces.push_back(piece);
+  }
+  return pieces;
+}
+
+void TimeFrameIndexer::reset()
+{
+  mLastTimeFrame.fill(UNKNOWN);
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,119 @@
+/// \file TraceRing.h
+/// \brief Definition of the TraceRing class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_TRACERING_H_
+#define ALICEO2_SRC_READOUTCARD_TRACERING_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <boost/format.hpp>
+#include "Utilities/Timestamp.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Ring buffer of the most recent DMA events of a channel, with timestamp counter timestamps.
+/// Recording an event is a timestamp read and a few stores, so the trace can stay enabled in production, and be dumped
+/// when something goes wrong to see what led up to it.
+///
+/// There is a single writer: the thread driving the channel. The ring can be dumped from another thread, but entries
+/// that are overwritten during the dump may then be inconsistent.
+class TraceRing
+{
+  public:
+    /// Type of a traced event
+    enum class Event : uint32_t
+    {
+      StartDma, ///< DMA started
+      StopDma, ///< DMA stopped
+      Reset, ///< Card or channel reset
+      Pushed, ///< Superpage pushed to the card. Value: superpage offset
+      Arrived, ///< Superpage arrived. Value: received bytes
+      Popped, ///< Superpage popped by the user. Value: superpage offset
+      ReadyQueueFull, ///< Arrived superpages left on the card because the ready queue was full. Value: amount
+      Flushed, ///< Received part of an idle superpage split off to the ready queue. Value: received bytes
+      Dropped, ///< Oldest superpage of the full ready queue given back to the card unread. Value: superpage offset
+      Recover, ///< DMA recovered after an error
+      NextRun ///< Next run started, see DmaChannelInterface::startNextRun(). Value: epoch of the new run
+    };
+
+    /// Amount of events kept. Must be a power of 2.
+    static constexpr size_t CAPACITY = 4096;
+
+    /// Records an event
+    /// \param event Type of the event
+    /// \param link Link ID the event refers to, if any
+    /// \param value Event-specific value
+    void record(Event event, uint32_t link = 0, uint64_t value = 0)
+    {
+      auto index = mIndex.load(std::memory_order_relaxed);
+      auto& entry = mEntries[index & (CAPACITY - 1)];
+      entry.timestamp = Utilities::getTimestampCounter();
+      entry.event = event;
+      entry.link = link;
+      entry.value = value;
+      mIndex.store(index + 1, std::memory_order_release);
+    }
+
+    /// Writes the recorded events to the stream, oldest first. Timestamps are given in timestamp counter ticks
+    /// relative to the most recent event.
+    void dump(std::ostream& stream) const
+    {
+      auto end = mIndex.load(std::memory_order_acquire);
+      auto begin = end > CAPACITY ? end - CAPACITY : 0;
+      if (begin == end) {
+        stream << "Trace empty\n";
+        return;
+      }
+      auto last = mEntries[(end - 1) & (CAPACITY - 1)].timestamp;
+      auto format = boost::format("%8d %14d %-16s %4d 0x%x\n");
+      stream << boost::format("%8s %14s %-16s %4s %s\n") % "#" % "Ticks" % "Event" % "Link" % "Value";
+      for (auto i = begin; i < end; ++i) {
+        const auto& entry = mEntries[i & (CAPACITY - 1)];
+        stream << format % i % (int64_t(entry.timestamp) - int64_t(last)) % toString(entry.event) % entry.link
+            % entry.value;
+      }
+    }
+
+    static const char* toString(Event event)
+    {
+      switch (event) {
+        case Event::StartDma: return "START_DMA";
+        case Event::StopDma: return "STOP_DMA";
+        case Event::Reset: return "RESET";
+        case Event::Pushed: return "PUSHED";
+        case Event::Arrived: return "ARRIVED";
+        case Event::Popped: return "POPPED";
+        case Event::ReadyQueueFull: return "READY_QUEUE_FULL";
+        case Event::Flushed: return "FLUSHED";
+        case Event::Dropped: return "DROPPED";
+        case Event::Recover: return "RECOVER";
+        case Event::NextRun: return "NEXT_RUN";
+      }
+      return "UNKNOWN";
+    }
+
+  private:
+    struct Entry
+    {
+      uint64_t timestamp;
+      Event event;
+      uint32_t link;
+      uint64_t value;
+    };
+
+    std::array<Entry, CAPACITY> mEntries {};
+
+    /// Index of the next entry to write, increases monotonically
+    std::atomic<uint64_t> mIndex { 0 };
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_TRACERING_H_
@@ -0,0 +1,109 @@
+/// \file TransparentHugepageBuffer.cxx
+/// \brief Implementation of the TransparentHugepageBuffer class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "ReadoutCard/TransparentHugepageBuffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include "ExceptionInternal.h"
+#include "Utilities/MemoryMaps.h"
+#include "Utilities/Numa.h"
+#include "Utilities/Util.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace {
+
+constexpr size_t SIZE_4KiB = 4*1024;
+constexpr size_t SIZE_2MiB = 2*1024*1024;
+
+std::string errorString(const std::string& message)
+{
+  return message + ": " + std::strerror(errno);
+}
+
+/// Checks the system-wide THP mode, "[always] madvise never" with the active one in brackets
+bool isThpDisabled()
+{
+  std::ifstream stream("/sys/kernel/mm/transparent_hugepage/enabled");
+  std::string modes;
+  std::getline(stream, modes);
+  return modes.empty() || modes.find("[never]") != std::string::npos;
+}
+
+} // Anonymous namespace
+
+TransparentHugepageBuffer::TransparentHugepageBuffer(size_t size, boost::optional<int> numaNode)
+{
+  if (size == 0 || !Utilities::isMultiple(size, SIZE_2MiB)) {
+    BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message("Buffer size not a multiple of 2 MiB"));
+  }
+  if (isThpDisabled()) {
+    BOOST_THROW_EXCEPTION(MemoryMapException()
+        << ErrorInfo::Message("Transparent hugepages are disabled or not supported")
+        << ErrorInfo::PossibleCauses({"'never' in /sys/kernel/mm/transparent_hugepage/enabled, set it to 'madvise'"}));
+  }
+
+  // Only 2 MiB aligned regions can get hugepages, so the mapping gets room to be aligned, and the excess is unmapped
+  const size_t mappedSize = size + SIZE_2MiB;
+  void* mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(errorString("Failed to map buffer"))
+        << ErrorInfo::FileSize(size));
+  }
+  const auto start = reinterpret_cast<uintptr_t>(mapped);
+  const auto aligned = (start + SIZE_2MiB - 1) & ~uintptr_t(SIZE_2MiB - 1);
+  if (aligned > start) {
+    munmap(mapped, aligned - start);
+  }
+  if (start + mappedSize > aligned + size) {
+    munmap(reinterpret_cast<void*>(aligned + size), start + mappedSize - (aligned + size));
+  }
+  mAddress = reinterpret_cast<void*>(aligned);
+  mSize = size;
+
+  try {
+    if (madvise(mAddress, mSize, MADV_HUGEPAGE) != 0) {
+      BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(errorString("Failed to advise hugepages")));
+    }
+    if (numaNode) {
+      Utilities::bindMemoryToNumaNode(mAddress, mSize, *numaNode);
+    }
+  }
+  catch (...) {
+    munmap(mAddress, mSize);
+    throw;
+  }
+
+  // Faulting in a 2 MiB region allocates a hugepage for it. Where the kernel falls back to 4 KiB pages, every page
+  // must be touched.
+  auto bytes = static_cast<volatile char*>(mAddress);
+  for (size_t offset = 0; offset < mSize; offset += SIZE_4KiB) {
+    bytes[offset] = 0;
+  }
+}
+
+TransparentHugepageBuffer::~TransparentHugepageBuffer()
+{
+  munmap(mAddress, mSize);
+}
+
+size_t TransparentHugepageBuffer::getHugepageBytes() const
+{
+  // The kernel may have merged the mapping with an adjacent one with the same flags, such as another buffer
+  return std::min(Utilities::getTransparentHugepageBytes(mAddress).get_value_or(0), mSize);
+}
+
+size_t TransparentHugepageBuffer::getPageSize() const
+{
+  return getHugepageBytes() >= mSize ? SIZE_2MiB : SIZE_4KiB;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,85 @@
+/// \file Affinity.cxx
+/// \brief Implementation of functions for setting CPU affinity
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "Affinity.h"
+#include <pthread.h>
+#include <sched.h>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+namespace b = boost;
+namespace {
+
+void setAffinity(pthread_t handle, const std::vector<int>& cpus)
+{
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("CPU number out of range") << ErrorInfo::Cpu(cpu));
+    }
+    CPU_SET(cpu, &cpuSet);
+  }
+
+  if (pthread_setaffinity_np(handle, sizeof(cpuSet), &cpuSet) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to set thread affinity"));
+  }
+}
+
+} // Anonymous namespace
+
+std::vector<int> parseCpuList(const std::string& string)
+{
+  std::vector<int> cpus;
+
+  try {
+    std::vector<std::string> commaSeparateds;
+    b::split(commaSeparateds, b::trim_copy(string), b::is_any_of(","));
+    for (const auto& commaSeparated : commaSeparateds) {
+      if (commaSeparated.empty()) {
+        continue;
+      }
+      std::vector<std::string> dashSeparateds;
+      b::split(dashSeparateds, commaSeparated, b::is_any_of("-"));
+      if (dashSeparateds.size() == 1) {
+        cpus.push_back(b::lexical_cast<int>(dashSeparateds[0]));
+      } else if (dashSeparateds.size() == 2) {
+        auto start = b::lexical_cast<int>(dashSeparateds[0]);
+        auto end = b::lexical_cast<int>(dashSeparateds[1]);
+        for (int i = start; i <= end; ++i) {
+          cpus.push_back(i);
+        }
+      } else {
+        BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Invalid CPU list format")
+            << ErrorInfo::String(string));
+      }
+    }
+  }
+  catch (b::bad_lexical_cast& e) {
+    BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message(std::string("Invalid CPU list format: ") + e.what())
+        << ErrorInfo::String(string));
+  }
+
+  return cpus;
+}
+
+void setThreadAffinity(std::thread& thread, const std::vector<int>& cpus)
+{
+  setAffinity(thread.native_handle(), cpus);
+}
+
+void setThreadAffinity(const std::vector<int>& cpus)
+{
+  setAffinity(pthread_self(), cpus);
+}
+
+} // namespace Util
+} // namespace roc
+} // namespace AliceO2
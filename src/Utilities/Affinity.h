@@ -0,0 +1,33 @@
+/// \file Affinity.h
+/// \brief Definition of functions for setting CPU affinity
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_AFFINITY_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_AFFINITY_H_
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+/// Parses a CPU list in the format used by sysfs, e.g. "0-3,8,10-11"
+/// \throw ParseException on failure to parse
+std::vector<int> parseCpuList(const std::string& string);
+
+/// Restricts the given thread to run on the given CPUs
+/// \throw Exception if the affinity could not be set
+void setThreadAffinity(std::thread& thread, const std::vector<int>& cpus);
+
+/// Restricts the calling thread to run on the given CPUs
+/// \throw Exception if the affinity could not be set
+void setThreadAffinity(const std::vector<int>& cpus);
+
+} // namespace Util
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_AFFINITY_H_
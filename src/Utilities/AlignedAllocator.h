@@ -0,0 +1,108 @@
+/// \file AlignedAllocator.h
+/// \brief Definition of the AlignedAllocator class.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_ALIGNEDALLOCATOR_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_ALIGNEDALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+/// Size of a cache line on the machines we run on
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/// Allocator for containers whose storage must start at an alignment larger than the one of operator new, such as a
+/// cache line. With elements whose size is a multiple of the alignment, every element then starts on its own boundary.
+/// \tparam T Type of the elements
+/// \tparam Alignment Alignment in bytes, a power of two and a multiple of sizeof(void*)
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+  public:
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert((Alignment % sizeof(void*)) == 0, "Alignment must be a multiple of the pointer size");
+
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+      if (count == 0) {
+        return nullptr;
+      }
+      void* memory = nullptr;
+      if (posix_memalign(&memory, Alignment, count * sizeof(T)) != 0) {
+        throw std::bad_alloc();
+      }
+      return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* pointer, size_t)
+    {
+      free(pointer);
+    }
+
+    size_t max_size() const
+    {
+      return size_t(-1) / sizeof(T);
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* pointer, Args&&... args)
+    {
+      ::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy(U* pointer)
+    {
+      pointer->~U();
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+  return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+  return false;
+}
+
+/// Allocator for storage that starts on a cache line
+template <typename T>
+using CacheAlignedAllocator = AlignedAllocator<T, CACHE_LINE_SIZE>;
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_ALIGNEDALLOCATOR_H_
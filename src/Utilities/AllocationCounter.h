@@ -0,0 +1,152 @@
+/// \file AllocationCounter.h
+/// \brief Definition of a hook counting heap allocations per thread
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_ALLOCATIONCOUNTER_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_ALLOCATIONCOUNTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+/// Counts the heap allocations of the calling thread, to check that the steady state of the DMA loop doesn't allocate.
+///
+/// The counting is done by replacements of the global operator new, which are defined when this header is included
+/// with ALICEO2_READOUTCARD_ALLOCATION_HOOK defined. That must be done in exactly one translation unit of an
+/// executable, never in the library, since the replacements apply to the whole process. Allocations made with
+/// malloc() directly are not counted.
+class AllocationCounter
+{
+  public:
+    /// Checks if the hook is linked in, otherwise the count stays 0
+    static bool isEnabled()
+    {
+      return enabled();
+    }
+
+    /// Gets the amount of allocations the calling thread made since it started
+    static uint64_t get()
+    {
+      return count();
+    }
+
+    /// Counts an allocation of the calling thread, called by the replacements of operator new
+    static void add()
+    {
+      count()++;
+    }
+
+    /// Called by the hook at static initialization
+    static void enable()
+    {
+      enabled() = true;
+    }
+
+  private:
+    static uint64_t& count()
+    {
+      static thread_local uint64_t count = 0;
+      return count;
+    }
+
+    static bool& enabled()
+    {
+      static bool enabled = false;
+      return enabled;
+    }
+};
+
+/// Counts the allocations of the calling thread while in scope
+class AllocationScope
+{
+  public:
+    AllocationScope() : mStart(AllocationCounter::get())
+    {
+    }
+
+    /// Gets the amount of allocations the calling thread made since the scope started
+    uint64_t get() const
+    {
+      return AllocationCounter::get() - mStart;
+    }
+
+  private:
+    uint64_t mStart;
+};
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#ifdef ALICEO2_READOUTCARD_ALLOCATION_HOOK
+namespace {
+const bool allocationCounterEnabled = (::AliceO2::roc::Utilities::AllocationCounter::enable(), true);
+
+void* countedAllocate(std::size_t size)
+{
+  ::AliceO2::roc::Utilities::AllocationCounter::add();
+  return std::malloc(size == 0 ? 1 : size);
+}
+} // Anonymous namespace
+
+void* operator new(std::size_t size)
+{
+  if (auto pointer = countedAllocate(size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+  std::free(pointer);
+}
+#endif // ALICEO2_READOUTCARD_ALLOCATION_HOOK
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_ALLOCATIONCOUNTER_H_
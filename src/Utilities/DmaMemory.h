@@ -0,0 +1,55 @@
+/// \file DmaMemory.h
+/// \brief Definition of helpers for reading host memory the card writes by DMA
+///
+/// A consumer polls a small status word (the C-RORC Ready FIFO status, the CRU status page counters) with an acquire
+/// load, and then reads the data it covers with plain loads, which the compiler is free to vectorize. PCIe writes from
+/// the card arrive in order, so the acquire only has to keep the compiler and CPU from moving the plain loads before
+/// the status load. This replaces volatile, which blocks vectorization but gives no such ordering.
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_DMAMEMORY_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_DMAMEMORY_H_
+
+#include <atomic>
+#include <type_traits>
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+/// Loads a status word written by the card. Plain loads after it see the data the card wrote before the word.
+template <typename T>
+inline T loadAcquire(const T& word)
+{
+  static_assert(std::is_integral<T>::value, "DMA status words must be integers");
+  return __atomic_load_n(&word, __ATOMIC_ACQUIRE);
+}
+
+/// Loads a word written by the card, without ordering. The compiler still reloads it on every call.
+template <typename T>
+inline T loadRelaxed(const T& word)
+{
+  static_assert(std::is_integral<T>::value, "DMA status words must be integers");
+  return __atomic_load_n(&word, __ATOMIC_RELAXED);
+}
+
+/// Orders plain or relaxed loads before the fence, for example a vectorized scan of status words, before the loads
+/// after it
+inline void acquireFence()
+{
+  std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+/// Orders stores to host memory before the fence, for example resetting status words, before the stores after it,
+/// such as the register write that hands the memory back to the card
+inline void releaseFence()
+{
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_DMAMEMORY_H_
@@ -0,0 +1,44 @@
+/// \file Futex.h
+/// \brief Definition of thin wrappers around the futex system call
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_FUTEX_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_FUTEX_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+/// Sleeps until the futex word is woken with futexWakeAll(), or the timeout expires.
+/// Returns immediately if the word no longer contains the expected value.
+inline void futexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+  auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec time;
+  time.tv_sec = seconds.count();
+  time.tv_nsec = (timeout - seconds).count();
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &time, nullptr, 0);
+}
+
+/// Wakes all threads waiting on the futex word
+inline void futexWakeAll(std::atomic<uint32_t>& word)
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace Util
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_FUTEX_H_
@@ -9,6 +9,7 @@
 #include <boost/format.hpp>
 #include "ExceptionInternal.h"
 #include "Common/System.h"
+#include "Utilities/Numa.h"
 #include "Utilities/Util.h"
 #include "Utilities/SmartPointer.h"
 
@@ -28,10 +29,11 @@ std::string getDirectory(HugepageType hugepageType)
 }
 
 std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string bufferName, bool deleteOnDestruction,
-    HugepageType* allocatedHugepageType)
+    HugepageType* allocatedHugepageType, boost::optional<int> numaNode)
 {
   std::unique_ptr<MemoryMappedFile> memoryMappedFile;
   HugepageType attemptHugepageType;
+  size_t hugepageSize = SIZE_2MiB;
 
   // To use hugepages, the buffer size must be a multiple of 2 MiB (or 1 GiB, but we cover that with 2 MiB anyway)
   if (!Utilities::isMultiple(bufferSize, SIZE_2MiB)) {
@@ -51,7 +53,16 @@ std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string buff
         b::format("/var/lib/hugetlbfs/global/pagesize-%1%/%2%")
         % (hugepageType == HugepageType::Size2MiB ? "2MB" : "1GB")
         % bufferName);
-    Utilities::resetSmartPtr(memoryMappedFile, bufferFilePath, bufferSize, deleteOnDestruction);
+    if (numaNode) {
+      // The thread's policy makes the hugepages get reserved from the node, the mapping's policy makes them get
+      // allocated there when faulted in
+      ScopedNumaMemoryPolicy policy(*numaNode);
+      Utilities::resetSmartPtr(memoryMappedFile, bufferFilePath, bufferSize, deleteOnDestruction);
+      bindMemoryToNumaNode(memoryMappedFile->getAddress(), bufferSize, *numaNode);
+    } else {
+      Utilities::resetSmartPtr(memoryMappedFile, bufferFilePath, bufferSize, deleteOnDestruction);
+    }
+    hugepageSize = (hugepageType == HugepageType::Size2MiB) ? SIZE_2MiB : SIZE_1GiB;
     if (allocatedHugepageType) {
       *allocatedHugepageType = hugepageType;
     }
@@ -68,6 +79,20 @@ std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string buff
   if (!memoryMappedFile) {
     createBuffer(HugepageType::Size2MiB);
   }
+
+  if (numaNode) {
+    auto remote = countRemotePages(memoryMappedFile->getAddress(), bufferSize, hugepageSize, *numaNode);
+    if (remote > 0) {
+      BOOST_THROW_EXCEPTION(Exception()
+          << ErrorInfo::Message("Hugepages of buffer are not on the requested NUMA node")
+          << ErrorInfo::NumaNode(*numaNode)
+          << ErrorInfo::Pages(remote)
+          << ErrorInfo::Filename(memoryMappedFile->getFileName())
+          << ErrorInfo::PossibleCauses({
+            "Buffer file already existed with pages on another node",
+            "Not enough free hugepages on the node (check /sys/devices/system/node/node*/hugepages)"}));
+    }
+  }
   return memoryMappedFile;
 }
 
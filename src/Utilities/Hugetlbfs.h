@@ -7,6 +7,7 @@
 #define ALICEO2_SRC_READOUTCARD_UTILITIES_HUGETLBFS_H_
 
 #include <memory>
+#include <boost/optional.hpp>
 #include "ReadoutCard/ParameterTypes/PciAddress.h"
 #include "ReadoutCard/MemoryMappedFile.h"
 
@@ -35,8 +36,11 @@ std::string getDirectory(HugepageType hugepageType);
 ///        destruction of the MemoryMappedFile.
 /// \param allocatedHugepageType Optional argument, set to a HugepageType if you must know what type of hugepage was
 ///        allocated.
+/// \param numaNode Optional argument, if given the hugepages are reserved from and bound to this NUMA node, typically
+///        the one of the card that will write into the buffer. If the pages end up on another node anyway, for example
+///        because the file already existed, an exception is thrown.
 std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string bufferName, bool deleteFileOnDestruction,
-    HugepageType* allocatedHugepageType = nullptr);
+    HugepageType* allocatedHugepageType = nullptr, boost::optional<int> numaNode = boost::none);
 
 } // namespace Util
 } // namespace roc
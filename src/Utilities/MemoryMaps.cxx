@@ -5,8 +5,13 @@
 
 #include "MemoryMaps.h"
 
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <unistd.h>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <tuple>
 #include <sstream>
 #include <string>
 #include <iostream>
@@ -115,6 +120,95 @@ std::map<uintptr_t, NumaMapping> getNumaMaps()
   return maps;
 }
 
+/// Magic number of hugetlbfs in statfs::f_type, from linux/magic.h
+constexpr decltype(statfs::f_type) HUGETLBFS_MAGIC = 0x958458f6;
+
+/// Identifies a mapping, so a cached page size isn't used for a different mapping at the same address
+struct MappingKey
+{
+    uintptr_t addressStart;
+    uintptr_t addressEnd;
+    std::string dev;
+    size_t inode;
+
+    bool operator<(const MappingKey& other) const
+    {
+      return std::tie(addressStart, addressEnd, dev, inode)
+          < std::tie(other.addressStart, other.addressEnd, other.dev, other.inode);
+    }
+};
+
+/// Finds the line of /proc/self/maps containing the address
+bool findMapping(uintptr_t address, Mapping& mapping)
+{
+  std::ifstream stream("/proc/self/maps");
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream lineStream(line);
+    std::string range;
+    lineStream >> range;
+    auto dash = range.find('-');
+    if (dash == std::string::npos) {
+      continue;
+    }
+    auto start = std::strtoul(range.c_str(), nullptr, 16);
+    auto end = std::strtoul(range.c_str() + dash + 1, nullptr, 16);
+    if (address < start || address >= end) {
+      continue;
+    }
+
+    mapping.addressStart = start;
+    mapping.addressEnd = end;
+    std::string offset;
+    lineStream >> mapping.permissions >> offset >> mapping.dev >> mapping.inode;
+    mapping.offset = std::strtoul(offset.c_str(), nullptr, 16);
+    std::getline(lineStream, mapping.path);
+    boost::trim(mapping.path);
+    return true;
+  }
+  return false;
+}
+
+/// Gets the page size of a file system, if it is a hugetlbfs
+boost::optional<size_t> getHugetlbfsPageSize(const std::string& path)
+{
+  struct statfs stat;
+  if (statfs(path.c_str(), &stat) == 0 && stat.f_type == HUGETLBFS_MAGIC) {
+    return size_t(stat.f_bsize);
+  }
+  return boost::none;
+}
+
+boost::optional<size_t> lookUpPageSize(const Mapping& mapping)
+{
+  const size_t basePageSize = sysconf(_SC_PAGESIZE);
+
+  if (mapping.inode == 0) {
+    // Anonymous mapping, not hugetlbfs
+    return basePageSize;
+  }
+
+  // A file that is not deleted can be checked directly
+  const std::string deleted = " (deleted)";
+  if (!boost::ends_with(mapping.path, deleted) && !mapping.path.empty() && mapping.path.front() == '/') {
+    return getHugetlbfsPageSize(mapping.path).get_value_or(basePageSize);
+  }
+
+  // Deleted files and MAP_HUGETLB mappings can only be reached through map_files, which may require privileges
+  std::ostringstream mapFile;
+  mapFile << "/proc/self/map_files/" << std::hex << mapping.addressStart << '-' << mapping.addressEnd;
+  if (auto hugepageSize = getHugetlbfsPageSize(mapFile.str())) {
+    return hugepageSize;
+  }
+
+  // Fall back to the expensive way
+  for (const auto& map : getMemoryMaps()) {
+    if (map.addressStart == mapping.addressStart && map.pageSizeKiB != 0) {
+      return map.pageSizeKiB * 1024;
+    }
+  }
+  return boost::none;
+}
 
 } // Anonymous namespace
 
@@ -139,6 +233,69 @@ std::vector<MemoryMap> getMemoryMaps()
   return memoryMaps;
 }
 
+boost::optional<size_t> getPageSize(const void* address)
+{
+  Mapping mapping;
+  if (!findMapping(reinterpret_cast<uintptr_t>(address), mapping)) {
+    return boost::none;
+  }
+
+  static std::mutex mutex;
+  static std::map<MappingKey, size_t> cache;
+  const MappingKey key {mapping.addressStart, mapping.addressEnd, mapping.dev, mapping.inode};
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iterator = cache.find(key);
+    if (iterator != cache.end()) {
+      return iterator->second;
+    }
+  }
+
+  auto pageSize = lookUpPageSize(mapping);
+  if (pageSize) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cache[key] = *pageSize;
+  }
+  return pageSize;
+}
+
+boost::optional<size_t> getTransparentHugepageBytes(const void* address)
+{
+  const auto target = reinterpret_cast<uintptr_t>(address);
+  std::ifstream stream("/proc/self/smaps");
+  std::string line;
+  bool inMapping = false;
+  while (std::getline(stream, line)) {
+    // Mapping header lines start with the address range, attribute lines with a name ending in a colon
+    auto dash = line.find('-');
+    auto space = line.find(' ');
+    auto colon = line.find(':');
+    if (dash < space && space != std::string::npos && (colon == std::string::npos || colon > space)) {
+      auto start = std::strtoul(line.substr(0, dash).c_str(), nullptr, 16);
+      auto end = std::strtoul(line.substr(dash + 1, space - dash - 1).c_str(), nullptr, 16);
+      inMapping = target >= start && target < end;
+    } else if (inMapping && line.find("AnonHugePages:") == 0) {
+      std::istringstream value(line.substr(line.find(':') + 1));
+      size_t kib = 0;
+      value >> kib;
+      return kib * 1024;
+    }
+  }
+  return boost::none;
+}
+
+bool excludeFromDumpAndFork(const void* address, size_t size)
+{
+  if (size == 0) {
+    return true;
+  }
+  const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  const auto start = reinterpret_cast<uintptr_t>(address) & ~(pageSize - 1);
+  const auto end = (reinterpret_cast<uintptr_t>(address) + size + pageSize - 1) & ~(pageSize - 1);
+  return madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTDUMP) == 0
+      && madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTFORK) == 0;
+}
+
 } // namespace Util
 } // namespace roc
 } // namespace AliceO2
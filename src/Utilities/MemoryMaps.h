@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <boost/optional.hpp>
 
 namespace AliceO2 {
 namespace roc {
@@ -26,6 +27,29 @@ struct MemoryMap
 /// TODO Work in progress
 std::vector<MemoryMap> getMemoryMaps();
 
+/// Gets the size of the pages backing the mapping that contains the given address.
+/// This is much cheaper than getMemoryMaps(): it reads `/proc/self/maps` only up to the mapping, and looks up the page
+/// size of a file-backed mapping with statfs() on the file, instead of having the kernel walk the page tables of every
+/// mapping for `/proc/self/numa_maps`. The result is cached per mapping.
+/// \param address An address in the mapping
+/// \return The page size in bytes, or none if the address is not mapped or the page size could not be determined
+boost::optional<size_t> getPageSize(const void* address);
+
+/// Gets the amount of memory of the anonymous mapping that contains the given address that is backed by transparent
+/// hugepages, from the mapping's `AnonHugePages` in `/proc/self/smaps`. The kernel walks the page tables of the mapping
+/// to compute it, so it's not for hot paths.
+/// \param address An address in the mapping
+/// \return The amount in bytes, or none if the address is not mapped
+boost::optional<size_t> getTransparentHugepageBytes(const void* address);
+
+/// Excludes a memory range from core dumps and from child processes with madvise() MADV_DONTDUMP and MADV_DONTFORK.
+/// Dumping a DMA buffer of several GiB stalls a crashing process for minutes, and a forked child would otherwise share
+/// its mapping, or have it copied. The range is extended to whole base pages.
+/// \param address Start of the range
+/// \param size Size of the range
+/// \return True on success, false with errno set if the kernel refused, e.g. for a range cutting through a hugepage
+bool excludeFromDumpAndFork(const void* address, size_t size);
+
 } // namespace Util
 } // namespace roc
 } // namespace AliceO2
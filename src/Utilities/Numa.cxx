@@ -4,11 +4,18 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "Numa.h"
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include "ExceptionInternal.h"
+#include "Utilities/Affinity.h"
 #include "Common/System.h"
 
 namespace AliceO2 {
@@ -32,6 +39,46 @@ std::string slurp(std::string filePath)
   return stringstream.str();
 }
 
+/// Amount of bits in a node mask word
+constexpr size_t NODE_MASK_WORD_BITS = sizeof(unsigned long) * CHAR_BIT;
+
+/// Amount of nodes our node masks can hold
+constexpr size_t NODE_MASK_NODES = 1024;
+
+/// The raw system calls are used, so we don't need to link against libnuma.
+/// Note that the kernel expects "maxnode" to be one more than the amount of bits in the mask.
+long sysMbind(void* address, size_t size, int mode, const unsigned long* nodeMask, unsigned long maxNode,
+    unsigned flags)
+{
+  return syscall(SYS_mbind, address, size, mode, nodeMask, maxNode, flags);
+}
+
+long sysSetMempolicy(int mode, const unsigned long* nodeMask, unsigned long maxNode)
+{
+  return syscall(SYS_set_mempolicy, mode, nodeMask, maxNode);
+}
+
+long sysGetMempolicy(int* mode, unsigned long* nodeMask, unsigned long maxNode, const void* address,
+    unsigned long flags)
+{
+  return syscall(SYS_get_mempolicy, mode, nodeMask, maxNode, address, flags);
+}
+
+std::vector<unsigned long> makeNodeMask(int numaNode)
+{
+  if (numaNode < 0 || size_t(numaNode) >= NODE_MASK_NODES) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Invalid NUMA node") << ErrorInfo::NumaNode(numaNode));
+  }
+  std::vector<unsigned long> mask(NODE_MASK_NODES / NODE_MASK_WORD_BITS, 0);
+  mask[numaNode / NODE_MASK_WORD_BITS] |= 1ul << (numaNode % NODE_MASK_WORD_BITS);
+  return mask;
+}
+
+std::string errnoString()
+{
+  return std::strerror(errno);
+}
+
 } // Anonymous namespace
 
 int getNumaNode(const PciAddress& pciAddress)
@@ -46,6 +93,71 @@ int getNumaNode(const PciAddress& pciAddress)
   return result;
 }
 
+std::vector<int> getLocalCpus(const PciAddress& pciAddress)
+{
+  auto cpus = parseCpuList(slurp((b::format("%s/local_cpulist") % getPciSysfsDirectory(pciAddress)).str()));
+  if (cpus.empty()) {
+    BOOST_THROW_EXCEPTION(
+        Exception() << ErrorInfo::Message("Failed to get local CPUs") << ErrorInfo::PciAddress(pciAddress));
+  }
+  return cpus;
+}
+
+void bindMemoryToNumaNode(void* address, size_t size, int numaNode)
+{
+  auto mask = makeNodeMask(numaNode);
+  if (sysMbind(address, size, MPOL_BIND, mask.data(), NODE_MASK_NODES + 1, 0) != 0) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Failed to bind memory to NUMA node: " + errnoString())
+        << ErrorInfo::NumaNode(numaNode)
+        << ErrorInfo::Address(reinterpret_cast<uintptr_t>(address))
+        << ErrorInfo::Range(size));
+  }
+}
+
+int getMemoryNumaNode(const void* address)
+{
+  int node = -1;
+  if (sysGetMempolicy(&node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Failed to get NUMA node of memory: " + errnoString())
+        << ErrorInfo::Address(reinterpret_cast<uintptr_t>(address)));
+  }
+  return node;
+}
+
+size_t countRemotePages(const void* address, size_t size, size_t pageSize, int numaNode)
+{
+  size_t remote = 0;
+  auto start = reinterpret_cast<const char*>(address);
+  for (size_t offset = 0; offset < size; offset += pageSize) {
+    if (getMemoryNumaNode(start + offset) != numaNode) {
+      remote++;
+    }
+  }
+  return remote;
+}
+
+ScopedNumaMemoryPolicy::ScopedNumaMemoryPolicy(int numaNode)
+    : mPreviousMode(MPOL_DEFAULT), mPreviousNodeMask(NODE_MASK_NODES / NODE_MASK_WORD_BITS, 0)
+{
+  if (sysGetMempolicy(&mPreviousMode, mPreviousNodeMask.data(), NODE_MASK_NODES + 1, nullptr, 0) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to get memory policy: " + errnoString()));
+  }
+  auto mask = makeNodeMask(numaNode);
+  if (sysSetMempolicy(MPOL_BIND, mask.data(), NODE_MASK_NODES + 1) != 0) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Failed to set memory policy: " + errnoString())
+        << ErrorInfo::NumaNode(numaNode));
+  }
+}
+
+ScopedNumaMemoryPolicy::~ScopedNumaMemoryPolicy()
+{
+  // The previous policy was valid, so restoring it can't fail
+  sysSetMempolicy(mPreviousMode, mPreviousNodeMask.data(), NODE_MASK_NODES + 1);
+}
+
 } // namespace Util
 } // namespace roc
 } // namespace AliceO2
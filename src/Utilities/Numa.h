@@ -6,6 +6,8 @@
 #ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_NUMA_H_
 #define ALICEO2_SRC_READOUTCARD_UTILITIES_NUMA_H_
 
+#include <cstddef>
+#include <vector>
 #include "ReadoutCard/ParameterTypes/PciAddress.h"
 
 namespace AliceO2 {
@@ -14,6 +16,49 @@ namespace Utilities {
 
 int getNumaNode(const PciAddress& pciAddress);
 
+/// Gets the CPUs that are local to the given PCI device's NUMA node
+/// The list is retrieved from the `/sys/bus/pci/devices/[PCI address]/local_cpulist` sysfs file
+std::vector<int> getLocalCpus(const PciAddress& pciAddress);
+
+/// Binds a memory region to the given NUMA node using `mbind()`. Pages of the region that are faulted in afterwards are
+/// allocated on that node only. Pages that were already faulted in are not moved.
+/// \param address Start of the region, must be page-aligned
+/// \param size Size of the region
+/// \param numaNode The NUMA node to bind to
+void bindMemoryToNumaNode(void* address, size_t size, int numaNode);
+
+/// Gets the NUMA node of the page containing the given address. The page is faulted in if it wasn't already.
+int getMemoryNumaNode(const void* address);
+
+/// Counts the pages of a memory region that are not on the given NUMA node. The pages are faulted in if they weren't
+/// already.
+/// \param address Start of the region
+/// \param size Size of the region
+/// \param pageSize Size of the pages backing the region. One address per page is checked.
+/// \param numaNode The NUMA node the pages should be on
+/// \return The amount of pages that are on another node
+size_t countRemotePages(const void* address, size_t size, size_t pageSize, int numaNode);
+
+/// Sets the memory policy of the calling thread to allocate on the given NUMA node only, and restores the previous
+/// policy on destruction. Hugetlbfs mappings made while it is active reserve their hugepages from that node, so a node
+/// without enough free hugepages makes the mapping fail instead of making the DMA buffer remote.
+class ScopedNumaMemoryPolicy
+{
+  public:
+    explicit ScopedNumaMemoryPolicy(int numaNode);
+    ~ScopedNumaMemoryPolicy();
+
+    ScopedNumaMemoryPolicy(const ScopedNumaMemoryPolicy&) = delete;
+    ScopedNumaMemoryPolicy& operator=(const ScopedNumaMemoryPolicy&) = delete;
+
+  private:
+    /// Memory policy mode before construction
+    int mPreviousMode;
+
+    /// Node mask of the memory policy before construction
+    std::vector<unsigned long> mPreviousNodeMask;
+};
+
 } // namespace Util
 } // namespace roc
 } // namespace AliceO2
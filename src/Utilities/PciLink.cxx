@@ -0,0 +1,188 @@
+/// \file PciLink.cxx
+/// \brief Implementation of functions for inspecting the PCIe link of a card
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#include "PciLink.h"
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+namespace b = boost;
+namespace {
+
+/// Registers of the configuration space
+constexpr size_t CONFIG_STATUS = 0x06;
+constexpr uint8_t CONFIG_STATUS_CAPABILITIES = 0x10;
+constexpr size_t CONFIG_CAPABILITIES_POINTER = 0x34;
+
+/// Capability ID of PCI Express, and its registers, relative to the capability
+constexpr uint8_t CAPABILITY_PCI_EXPRESS = 0x10;
+constexpr size_t PCI_EXPRESS_DEVICE_CAPABILITIES = 0x04;
+constexpr size_t PCI_EXPRESS_DEVICE_CONTROL = 0x08;
+
+/// Bytes a TLP takes besides its payload: 12 or 16 header, 2 sequence number, 4 LCRC and 2 framing
+constexpr int TLP_OVERHEAD = 24;
+
+std::string getPciSysfsDirectory(const PciAddress& pciAddress)
+{
+  return (b::format("/sys/bus/pci/devices/0000:%s") % pciAddress.toString()).str();
+}
+
+std::string readAttribute(const PciAddress& pciAddress, const std::string& name)
+{
+  auto path = getPciSysfsDirectory(pciAddress) + "/" + name;
+  std::ifstream stream(path);
+  std::string value;
+  if (!std::getline(stream, value)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to read PCI link attribute")
+        << ErrorInfo::Filename(path) << ErrorInfo::PciAddress(pciAddress));
+  }
+  return value;
+}
+
+double readSpeed(const PciAddress& pciAddress, const std::string& name)
+{
+  auto value = readAttribute(pciAddress, name);
+  auto speed = parsePciLinkSpeed(value);
+  if (speed == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to parse PCI link speed")
+        << ErrorInfo::String(value) << ErrorInfo::PciAddress(pciAddress));
+  }
+  return speed;
+}
+
+int readWidth(const PciAddress& pciAddress, const std::string& name)
+{
+  auto value = readAttribute(pciAddress, name);
+  try {
+    return std::stoi(value);
+  } catch (const std::exception&) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to parse PCI link width")
+        << ErrorInfo::String(value) << ErrorInfo::PciAddress(pciAddress));
+  }
+}
+
+uint16_t readWord(const std::vector<uint8_t>& config, size_t offset)
+{
+  return uint16_t(config.at(offset) | (config.at(offset + 1) << 8));
+}
+
+/// Decodes a 3-bit size field: 0 is 128 bytes, every step doubles it
+int decodeSize(uint32_t field)
+{
+  return 128 << (field & 0x7);
+}
+
+} // Anonymous namespace
+
+double parsePciLinkSpeed(const std::string& string)
+{
+  std::istringstream stream(string);
+  double speed = 0;
+  std::string unit;
+  if (!(stream >> speed >> unit) || unit != "GT/s" || speed <= 0) {
+    return 0;
+  }
+  return speed;
+}
+
+PciExpressCapability parsePciExpressCapability(const std::vector<uint8_t>& config)
+{
+  if (config.size() < 0x100 || !(config[CONFIG_STATUS] & CONFIG_STATUS_CAPABILITIES)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("No capabilities in PCI configuration space"));
+  }
+
+  // The capabilities form a list. The bottom two bits of the pointers are reserved. The amount of steps is bounded, so
+  // a corrupt list can't loop forever.
+  size_t pointer = config[CONFIG_CAPABILITIES_POINTER] & ~0x3;
+  for (int steps = 0; pointer != 0 && steps < 48; ++steps) {
+    if (pointer + PCI_EXPRESS_DEVICE_CONTROL + 2 > config.size()) {
+      break;
+    }
+    if (config[pointer] == CAPABILITY_PCI_EXPRESS) {
+      auto deviceCapabilities = readWord(config, pointer + PCI_EXPRESS_DEVICE_CAPABILITIES);
+      auto deviceControl = readWord(config, pointer + PCI_EXPRESS_DEVICE_CONTROL);
+      PciExpressCapability capability;
+      capability.maxPayloadSizeSupported = decodeSize(deviceCapabilities);
+      capability.maxPayloadSize = decodeSize(deviceControl >> 5);
+      capability.maxReadRequestSize = decodeSize(deviceControl >> 12);
+      return capability;
+    }
+    pointer = config[pointer + 1] & ~0x3;
+  }
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("PCI Express capability not found"));
+}
+
+PciLinkStatus getPciLinkStatus(const PciAddress& pciAddress)
+{
+  PciLinkStatus status;
+  status.currentSpeed = readSpeed(pciAddress, "current_link_speed");
+  status.maxSpeed = readSpeed(pciAddress, "max_link_speed");
+  status.currentWidth = readWidth(pciAddress, "current_link_width");
+  status.maxWidth = readWidth(pciAddress, "max_link_width");
+
+  auto path = getPciSysfsDirectory(pciAddress) + "/config";
+  std::ifstream stream(path, std::ios::binary);
+  std::vector<uint8_t> config((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+  if (config.size() < 0x100) {
+    BOOST_THROW_EXCEPTION(Exception()
+        << ErrorInfo::Message("Failed to read PCI configuration space, reading beyond the header requires root")
+        << ErrorInfo::Filename(path) << ErrorInfo::PciAddress(pciAddress));
+  }
+  auto capability = parsePciExpressCapability(config);
+  status.maxPayloadSize = capability.maxPayloadSize;
+  status.maxPayloadSizeSupported = capability.maxPayloadSizeSupported;
+  status.maxReadRequestSize = capability.maxReadRequestSize;
+  return status;
+}
+
+double getPciLinkBandwidth(double speed, int width)
+{
+  const double encoding = speed > 5.0 ? 128.0 / 130.0 : 8.0 / 10.0;
+  return speed * width * encoding;
+}
+
+double getPciPayloadEfficiency(int maxPayloadSize)
+{
+  return double(maxPayloadSize) / double(maxPayloadSize + TLP_OVERHEAD);
+}
+
+std::vector<std::string> auditPciLink(const PciLinkStatus& status, double linksBandwidth)
+{
+  std::vector<std::string> messages;
+  if (status.currentSpeed < status.maxSpeed) {
+    messages.push_back((b::format("Link trained at %g GT/s, the card supports %g GT/s") % status.currentSpeed
+        % status.maxSpeed).str());
+  }
+  if (status.currentWidth < status.maxWidth) {
+    messages.push_back((b::format("Link trained at x%d, the card supports x%d") % status.currentWidth
+        % status.maxWidth).str());
+  }
+  if (status.maxPayloadSize < status.maxPayloadSizeSupported) {
+    messages.push_back((b::format("MaxPayloadSize is %d bytes, the card supports %d bytes: %.0f%% instead of %.0f%% "
+        "of the link carries DMA data, check the setting of the root port") % status.maxPayloadSize
+        % status.maxPayloadSizeSupported % (getPciPayloadEfficiency(status.maxPayloadSize) * 100)
+        % (getPciPayloadEfficiency(status.maxPayloadSizeSupported) * 100)).str());
+  }
+  if (status.maxReadRequestSize < status.maxPayloadSize) {
+    messages.push_back((b::format("MaxReadRequestSize is %d bytes, below the MaxPayloadSize of %d bytes")
+        % status.maxReadRequestSize % status.maxPayloadSize).str());
+  }
+  const double usable = getPciLinkBandwidth(status.currentSpeed, status.currentWidth)
+      * getPciPayloadEfficiency(status.maxPayloadSize);
+  if (linksBandwidth > usable) {
+    messages.push_back((b::format("The links deliver up to %.1f Gb/s, the PCIe link carries at most %.1f Gb/s of DMA "
+        "data") % linksBandwidth % usable).str());
+  }
+  return messages;
+}
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,78 @@
+/// \file PciLink.h
+/// \brief Definition of functions for inspecting the PCIe link of a card
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_PCILINK_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_PCILINK_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+/// State of the PCIe link of a device, and the transaction sizes its DMA uses
+struct PciLinkStatus
+{
+    /// Link speeds, in GT/s per lane
+    double currentSpeed;
+    double maxSpeed;
+
+    /// Link widths, in lanes
+    int currentWidth;
+    int maxWidth;
+
+    /// MaxPayloadSize the device is set to, and the largest it supports, in bytes. This is the largest TLP it writes to
+    /// host memory.
+    int maxPayloadSize;
+    int maxPayloadSizeSupported;
+
+    /// MaxReadRequestSize the device is set to, in bytes
+    int maxReadRequestSize;
+};
+
+/// Parses a link speed as found in sysfs, e.g. "8 GT/s", "8.0 GT/s PCIe" or "2.5 GT/s"
+/// \return The speed in GT/s, or 0 if the string could not be parsed
+double parsePciLinkSpeed(const std::string& string);
+
+/// Sizes from the PCI Express capability of a device
+struct PciExpressCapability
+{
+    int maxPayloadSize;
+    int maxPayloadSizeSupported;
+    int maxReadRequestSize;
+};
+
+/// Finds the PCI Express capability in the configuration space of a device and decodes its payload and read request
+/// sizes
+/// \param config The configuration space, at least the standard 256 bytes
+/// \throw Exception if the capability is not found
+PciExpressCapability parsePciExpressCapability(const std::vector<uint8_t>& config);
+
+/// Reads the link state from the device's sysfs directory, and the sizes from its configuration space. Beyond the
+/// first 64 bytes, the configuration space is only readable by root.
+/// \throw Exception if a file could not be read or parsed
+PciLinkStatus getPciLinkStatus(const PciAddress& pciAddress);
+
+/// Bandwidth of a link, in Gb/s, after the line encoding: 8b/10b up to 5 GT/s, 128b/130b above
+double getPciLinkBandwidth(double speed, int width);
+
+/// Fraction of the link bandwidth that carries DMA payload when writes are split in TLPs of the given payload size,
+/// counting 24 bytes of header, sequence number, LCRC and framing per TLP
+double getPciPayloadEfficiency(int maxPayloadSize);
+
+/// Checks a link against the bandwidth the card's links deliver
+/// \param status The link
+/// \param linksBandwidth Total bandwidth of the card's links, in Gb/s, or 0 if unknown
+/// \return A message for every setting that caps the DMA throughput, empty if none does
+std::vector<std::string> auditPciLink(const PciLinkStatus& status, double linksBandwidth);
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_PCILINK_H_
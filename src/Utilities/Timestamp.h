@@ -0,0 +1,34 @@
+/// \file Timestamp.h
+/// \brief Definition of helper functions for cheap timestamps
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_TIMESTAMP_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_TIMESTAMP_H_
+
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#endif
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+/// Gets the CPU timestamp counter, which takes only a few nanoseconds to read. On other architectures, this falls
+/// back to the steady clock in nanoseconds.
+inline uint64_t getTimestampCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+} // namespace Util
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_TIMESTAMP_H_
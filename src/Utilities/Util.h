@@ -6,7 +6,10 @@
 #ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_UTIL_H_
 #define ALICEO2_SRC_READOUTCARD_UTILITIES_UTIL_H_
 
+#include <cassert>
 #include <cstdint>
+#include <cstdlib>
+#include "Utilities/AlignedAllocator.h"
 
 namespace AliceO2 {
 namespace roc {
@@ -19,6 +22,13 @@ bool isMultiple(const T1& x, const T2& y)
   return (x >= y) && ((x % y) == 0);
 }
 
+/// Is x a power of two
+template <typename T>
+bool isPowerOfTwo(const T& x)
+{
+  return (x != 0) && ((x & (x - 1)) == 0);
+}
+
 inline uint32_t getLower32Bits(uint64_t x)
 {
   return x & 0xFfffFfff;
@@ -75,6 +85,16 @@ inline bool checkAlignment(void* address, uint64_t alignment)
   return (uint64_t(address) % alignment) == 0;
 }
 
+/// Prefetches a range of memory for reading, one cache line at a time. DMA'd data is cold in the cache, and the hardware
+/// prefetchers don't cross 4 KiB pages, so a loop over DMA pages can prefetch a few pages ahead of its processing.
+inline void prefetchRange(const void* address, size_t bytes)
+{
+  const auto begin = static_cast<const char*>(address);
+  for (size_t offset = 0; offset < bytes; offset += CACHE_LINE_SIZE) {
+    __builtin_prefetch(begin + offset, 0, 3);
+  }
+}
+
 } // namespace Util
 } // namespace roc
 } // namespace AliceO2
@@ -0,0 +1,114 @@
+/// \file Wait.h
+/// \brief Definition of helper functions for waiting on a condition
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_WAIT_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_WAIT_H_
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace AliceO2 {
+namespace roc {
+namespace Utilities {
+
+/// Hint to the CPU that we're in a busy-wait loop
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+/// Waits until the predicate returns true or the timeout expires.
+/// The predicate is polled in a busy loop during the spin time. After that, the function backs off to sleeping for
+/// exponentially increasing intervals up to maxSleep, so an idle waiter does not burn a whole core.
+/// \param predicate Function returning true when the wait is over
+/// \param timeout Maximum time to wait
+/// \param spinTime Time to busy-wait before sleeping
+/// \param maxSleep Maximum interval between polls once sleeping
+/// \return The last value returned by the predicate
+template <typename Predicate>
+bool spinThenSleep(Predicate predicate, std::chrono::nanoseconds timeout, std::chrono::nanoseconds spinTime,
+    std::chrono::nanoseconds maxSleep = std::chrono::microseconds(100))
+{
+  if (predicate()) {
+    return true;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto spinEnd = start + std::min(spinTime, timeout);
+  const auto end = start + timeout;
+
+  while (std::chrono::steady_clock::now() < spinEnd) {
+    if (predicate()) {
+      return true;
+    }
+    cpuRelax();
+  }
+
+  std::chrono::nanoseconds sleep = std::chrono::microseconds(1);
+  while (true) {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= end) {
+      return predicate();
+    }
+    std::this_thread::sleep_for(std::min(sleep, std::chrono::duration_cast<std::chrono::nanoseconds>(end - now)));
+    if (predicate()) {
+      return true;
+    }
+    sleep = std::min(sleep * 2, maxSleep);
+  }
+}
+
+/// Waits until the predicate returns true or the timeout expires, polling at exponentially increasing intervals.
+/// Unlike spinThenSleep(), the predicate is never polled in a tight loop, which matters when a poll is a round trip to
+/// the card: the intervals start at minInterval and double up to maxInterval. Short intervals are waited with
+/// cpuRelax(), since sleeping is not precise at that scale.
+/// \param predicate Function returning true when the wait is over
+/// \param timeout Maximum time to wait
+/// \param minInterval Interval between the first polls
+/// \param maxInterval Maximum interval between polls
+/// \return The last value returned by the predicate
+template <typename Predicate>
+bool pollWithBackoff(Predicate predicate, std::chrono::nanoseconds timeout,
+    std::chrono::nanoseconds minInterval = std::chrono::nanoseconds(500),
+    std::chrono::nanoseconds maxInterval = std::chrono::microseconds(100))
+{
+  // Below this interval, the wait between polls is a busy wait
+  constexpr auto SLEEP_THRESHOLD = std::chrono::microseconds(50);
+
+  if (predicate()) {
+    return true;
+  }
+
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  auto interval = minInterval;
+  while (true) {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= end) {
+      return predicate();
+    }
+    auto wait = std::min(interval, std::chrono::duration_cast<std::chrono::nanoseconds>(end - now));
+    if (wait >= SLEEP_THRESHOLD) {
+      std::this_thread::sleep_for(wait);
+    } else {
+      auto waitEnd = now + wait;
+      while (std::chrono::steady_clock::now() < waitEnd) {
+        cpuRelax();
+      }
+    }
+    if (predicate()) {
+      return true;
+    }
+    interval = std::min(interval * 2, maxInterval);
+  }
+}
+
+} // namespace Util
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_WAIT_H_
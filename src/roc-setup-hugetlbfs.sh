@@ -53,6 +53,7 @@ echo "Hugepages:"
 hugeadm --pool-list
 echo ""
 echo "Use 'echo [number] > /sys/kernel/mm/hugepages/hugepages-[size]/nr_hugepages' to allocate hugepages manually"
+echo "Or use 'roc-hugepages' to allocate them on the NUMA nodes of the cards"
 echo "Or set a number in the following conf files and run the script again:"
 echo "  echo [number] > $HUGEPAGES_2M_CONF"
 echo "  echo [number] > $HUGEPAGES_1G_CONF"
\ No newline at end of file
@@ -0,0 +1,327 @@
+/// \file FakeDmaChannel.h
+/// \brief Definition of the FakeDmaChannel class, a channel implementation for tests
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#ifndef ALICEO2_TEST_READOUTCARD_FAKEDMACHANNEL_H_
+#define ALICEO2_TEST_READOUTCARD_FAKEDMACHANNEL_H_
+
+#include <boost/circular_buffer.hpp>
+#include "ExceptionInternal.h"
+#include "ReadoutCard/DmaChannelInterface.h"
+
+namespace AliceO2 {
+namespace roc {
+
+/// Minimal channel that completes every pushed superpage on the next fillSuperpages() call
+class FakeDmaChannel : public DmaChannelInterface
+{
+  public:
+    virtual void startDma() override
+    {
+      mTransferQueue.clear();
+      mReadyQueue.clear();
+    }
+
+    virtual void prepareDma() override
+    {
+    }
+
+    virtual void stopDma() override
+    {
+      while (!mTransferQueue.empty()) {
+        mReadyQueue.push_back(mTransferQueue.front());
+        mTransferQueue.pop_front();
+      }
+    }
+
+    virtual void recover() override
+    {
+      stopDma();
+    }
+
+    virtual uint16_t startNextRun() override
+    {
+      stopDma();
+      return ++mRunEpoch;
+    }
+
+    virtual uint16_t getRunEpoch() override
+    {
+      return mRunEpoch;
+    }
+
+    virtual void resetChannel(ResetLevel::type) override
+    {
+    }
+
+    virtual void pushSuperpage(Superpage superpage) override
+    {
+      validateSuperpage(superpage, boost::none);
+      if (mTransferQueue.full()) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Transfer queue full"));
+      }
+      superpage.setChecked(true);
+      superpage.setRunEpoch(mRunEpoch);
+      mTransferQueue.push_back(superpage);
+    }
+
+    virtual bool tryPushSuperpageToLink(const Superpage& superpage, uint32_t linkId) override
+    {
+      if (!tryPushSuperpage(superpage)) {
+        return false;
+      }
+      mTransferQueue.back().setLinkId(linkId);
+      return true;
+    }
+
+    virtual void releaseSuperpage(Superpage superpage) override
+    {
+      if (!superpage.isChecked()) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Released superpage was not checked"));
+      }
+      mReleasedCount++;
+      superpage.setReady(false);
+      pushSuperpage(superpage);
+    }
+
+    /// Amount of superpages given to releaseSuperpage()
+    int getReleasedCount() const
+    {
+      return mReleasedCount;
+    }
+
+    virtual bool tryPushSuperpage(const Superpage& superpage) override
+    {
+      validateSuperpage(superpage, boost::none);
+      if (mTransferQueue.full()) {
+        return false;
+      }
+      mTransferQueue.push_back(superpage);
+      mTransferQueue.back().setChecked(true);
+      mTransferQueue.back().setRunEpoch(mRunEpoch);
+      return true;
+    }
+
+    virtual void pushSuperpages(const Superpage* superpages, size_t count) override
+    {
+      for (size_t i = 0; i < count; ++i) {
+        validateSuperpage(superpages[i], boost::none);
+      }
+      for (size_t i = 0; i < count; ++i) {
+        pushSuperpage(superpages[i]);
+      }
+    }
+
+    /// Only empty superpages are invalid
+    virtual void validateSuperpage(const Superpage& superpage, boost::optional<uint32_t>) override
+    {
+      if (superpage.getSize() == 0) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Superpage size == 0"));
+      }
+    }
+
+    virtual Superpage getSuperpage() override
+    {
+      return mReadyQueue.front();
+    }
+
+    virtual Superpage popSuperpage() override
+    {
+      auto superpage = mReadyQueue.front();
+      mReadyQueue.pop_front();
+      return superpage;
+    }
+
+    virtual bool tryPopSuperpage(Superpage& superpage) override
+    {
+      if (mReadyQueue.empty()) {
+        return false;
+      }
+      superpage = popSuperpage();
+      return true;
+    }
+
+    virtual size_t popSuperpages(Superpage* superpages, size_t max) override
+    {
+      size_t count = 0;
+      while (count < max && !mReadyQueue.empty()) {
+        superpages[count++] = popSuperpage();
+      }
+      return count;
+    }
+
+    virtual size_t getPartialSuperpages(Superpage* superpages, size_t max) override
+    {
+      if (mPartialReceived == 0 || max == 0 || mTransferQueue.empty()) {
+        return 0;
+      }
+      superpages[0] = mTransferQueue.front();
+      superpages[0].setReceived(mPartialReceived);
+      return 1;
+    }
+
+    /// Makes getPartialSuperpages() report the front pushed superpage with the given received size, 0 for none
+    void setPartialReceived(size_t received)
+    {
+      mPartialReceived = received;
+    }
+
+    /// Makes fillSuperpages() flush the given amount of bytes of every superpage first, as a split off superpage of
+    /// its own, as after the SuperpageFlushTimeout. 0 for none.
+    void setFlushSize(size_t size)
+    {
+      mFlushSize = size;
+    }
+
+    virtual void fillSuperpages() override
+    {
+      while (!mTransferQueue.empty()) {
+        auto superpage = mTransferQueue.front();
+        if (mFlushSize != 0) {
+          auto split = superpage;
+          split.setSize(mFlushSize);
+          split.setReceived(mFlushSize);
+          split.setReady(true);
+          split.setSplit(true);
+          mReadyQueue.push_back(split);
+          superpage.setOffset(superpage.getOffset() + mFlushSize);
+          superpage.setSize(superpage.getSize() - mFlushSize);
+        }
+        superpage.setReceived(superpage.getSize());
+        superpage.setReady(true);
+        mReadyQueue.push_back(superpage);
+        mTransferQueue.pop_front();
+      }
+    }
+
+    virtual bool waitForReadySuperpage(std::chrono::nanoseconds) override
+    {
+      fillSuperpages();
+      return !mReadyQueue.empty();
+    }
+
+    virtual int getReadyFileDescriptor() override
+    {
+      return -1;
+    }
+
+    virtual int addBuffer(const buffer_parameters::Memory&) override
+    {
+      return ++mBufferCount;
+    }
+
+    /// Gives a link of LINK_QUEUE_SIZE back to the transfer queue
+    virtual void enableLink(uint32_t linkId) override
+    {
+      if (mDisabledLinks & (1u << linkId)) {
+        mDisabledLinks &= ~(1u << linkId);
+        mTransferQueue.set_capacity(mTransferQueue.capacity() + LINK_QUEUE_SIZE);
+      }
+    }
+
+    /// Moves the pushed superpages to the ready queue, as if they were all on the link, and takes a link of
+    /// LINK_QUEUE_SIZE out of the transfer queue
+    virtual void disableLink(uint32_t linkId) override
+    {
+      if (!(mDisabledLinks & (1u << linkId))) {
+        stopDma();
+        mDisabledLinks |= 1u << linkId;
+        mTransferQueue.set_capacity(mTransferQueue.capacity() - LINK_QUEUE_SIZE);
+      }
+    }
+
+    virtual int getTransferQueueAvailable() override
+    {
+      return mTransferQueue.capacity() - mTransferQueue.size();
+    }
+
+    virtual int getReadyQueueSize() override
+    {
+      return mReadyQueue.size();
+    }
+
+    virtual CardType::type getCardType() override
+    {
+      return CardType::Dummy;
+    }
+
+    virtual void setLogLevel(AliceO2::InfoLogger::InfoLogger::Severity) override
+    {
+    }
+
+    virtual PciAddress getPciAddress() override
+    {
+      return PciAddress(0, 0, 0);
+    }
+
+    virtual int getNumaNode() override
+    {
+      return 0;
+    }
+
+    virtual size_t getDmaPageSize() override
+    {
+      return 8 * 1024;
+    }
+
+    virtual bool injectError() override
+    {
+      return false;
+    }
+
+    virtual boost::optional<int32_t> getSerial() override
+    {
+      return {};
+    }
+
+    virtual boost::optional<float> getTemperature() override
+    {
+      return {};
+    }
+
+    virtual boost::optional<std::string> getFirmwareInfo() override
+    {
+      return {};
+    }
+
+    virtual boost::optional<std::string> getCardId() override
+    {
+      return {};
+    }
+
+    virtual BarStatistics getBarStatistics() override
+    {
+      return {};
+    }
+
+    virtual ChannelStatistics getStatistics() override
+    {
+      return {};
+    }
+
+    virtual void dumpTrace(std::ostream&) override
+    {
+    }
+
+    /// Capacity of the transfer queue
+    static constexpr size_t TRANSFER_QUEUE_SIZE = 8;
+
+    /// Capacity of the queue of a link, the transfer queue has two
+    static constexpr size_t LINK_QUEUE_SIZE = TRANSFER_QUEUE_SIZE / 2;
+
+  private:
+    boost::circular_buffer<Superpage> mTransferQueue { TRANSFER_QUEUE_SIZE };
+    boost::circular_buffer<Superpage> mReadyQueue { TRANSFER_QUEUE_SIZE * 4 };
+    size_t mPartialReceived = 0;
+    size_t mFlushSize = 0;
+    int mBufferCount = 0;
+    int mReleasedCount = 0;
+    uint32_t mDisabledLinks = 0;
+    uint16_t mRunEpoch = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_TEST_READOUTCARD_FAKEDMACHANNEL_H_
@@ -0,0 +1,68 @@
+/// \file TestAlfLinkWorkerPool.cxx
+/// \brief Test of the ALF LinkWorkerPool class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestAlfLinkWorkerPool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/AliceLowlevelFrontend/LinkWorkerPool.h"
+
+using namespace ::AliceO2::roc::CommandLineUtilities::Alf;
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(SameLinkInOrder)
+{
+  LinkWorkerPool pool;
+  std::mutex mutex;
+  std::vector<int> order;
+  for (int i = 0; i < 100; ++i) {
+    pool.submit({1, 0}, [&, i]{
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(i);
+    });
+  }
+  // Runs after all the others of the link
+  pool.execute({1, 0}, []{});
+  BOOST_REQUIRE_EQUAL(order.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(order[i], i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LinksConcurrent)
+{
+  LinkWorkerPool pool;
+  // Link 0 blocks until link 1 has run, which requires them to run concurrently
+  std::promise<void> linkOneDone;
+  auto linkOneFuture = linkOneDone.get_future();
+  std::atomic<bool> linkZeroSawLinkOne {false};
+  pool.submit({1, 0}, [&]{
+    linkZeroSawLinkOne = linkOneFuture.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+  });
+  pool.submit({1, 1}, [&]{ linkOneDone.set_value(); });
+  pool.execute({1, 0}, []{});
+  BOOST_CHECK(linkZeroSawLinkOne);
+}
+
+BOOST_AUTO_TEST_CASE(Execute)
+{
+  LinkWorkerPool pool;
+  BOOST_CHECK_EQUAL(pool.execute({2, 3}, []{ return 42; }), 42);
+  BOOST_CHECK_THROW(pool.execute({2, 3}, []() -> int { throw std::runtime_error("fail"); }), std::runtime_error);
+  // The worker survives a throwing task
+  BOOST_CHECK_EQUAL(pool.execute({2, 3}, []{ return 43; }), 43);
+
+  pool.stop();
+  BOOST_CHECK_THROW(pool.execute({2, 3}, []{ return 44; }), std::runtime_error);
+}
+
+} // Anonymous namespace
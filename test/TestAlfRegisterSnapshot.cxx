@@ -0,0 +1,82 @@
+/// \file TestAlfRegisterSnapshot.cxx
+/// \brief Test of the ALF RegisterSnapshot class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestAlfRegisterSnapshot
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <stdexcept>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/AliceLowlevelFrontend/RegisterSnapshot.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities::Alf;
+
+namespace {
+
+/// Register value is index * 10, and the bulk reads are counted
+class CountingBar : public RegisterReadWriteInterface
+{
+  public:
+    virtual uint32_t readRegister(int index) override
+    {
+      singleReads++;
+      return index * 10;
+    }
+
+    virtual void writeRegister(int, uint32_t) override
+    {
+    }
+
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count) override
+    {
+      bulkReads++;
+      for (size_t i = 0; i < count; ++i) {
+        values[i] = (startIndex + i) * 10;
+      }
+    }
+
+    int singleReads = 0;
+    int bulkReads = 0;
+};
+
+BOOST_AUTO_TEST_CASE(CoalescesRuns)
+{
+  CountingBar bar;
+  // Two services: 0x10, 0x14, 0x18 and 0x18, 0x1c, 0x40. Together two runs: 0x10-0x1c and 0x40
+  RegisterSnapshot snapshot(bar, {0x10, 0x14, 0x18, 0x18, 0x1c, 0x40});
+  BOOST_CHECK_EQUAL(bar.bulkReads, 2);
+  BOOST_CHECK_EQUAL(bar.singleReads, 0);
+  BOOST_CHECK_EQUAL(snapshot.getReadCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Values)
+{
+  CountingBar bar;
+  RegisterSnapshot snapshot(bar, {0x40, 0x10, 0x14});
+  BOOST_CHECK_EQUAL(snapshot.getValue(0x10), 0x4 * 10);
+  BOOST_CHECK_EQUAL(snapshot.getValue(0x40), 0x10 * 10);
+  auto values = snapshot.getValues({0x40, 0x14, 0x40});
+  std::vector<uint32_t> expected {0x10 * 10, 0x5 * 10, 0x10 * 10};
+  BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(MissingAddress)
+{
+  CountingBar bar;
+  RegisterSnapshot snapshot(bar, {0x10, 0x18});
+  BOOST_CHECK_THROW(snapshot.getValue(0x14), std::out_of_range);
+  BOOST_CHECK_THROW(snapshot.getValue(0x20), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+  CountingBar bar;
+  RegisterSnapshot snapshot(bar, {});
+  BOOST_CHECK_EQUAL(bar.bulkReads, 0);
+  BOOST_CHECK(snapshot.getValues({}).empty());
+}
+
+} // Anonymous namespace
@@ -0,0 +1,163 @@
+/// \file TestAlfSca.cxx
+/// \brief Test of the ALF Sca class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestAlfSca
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <map>
+#include <mutex>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/AliceLowlevelFrontend/Sca.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities::Alf;
+
+namespace {
+
+constexpr int CRU_BASE_INDEX = 0x4224000 / 4;
+constexpr int CRU_LINK_OFFSET = 0x20000 / 4;
+constexpr int WRITE_DATA = 0x20 / 4;
+constexpr int WRITE_COMMAND = 0x24 / 4;
+constexpr int CONTROL = 0x28 / 4;
+constexpr int READ_DATA = 0x30 / 4;
+constexpr int READ_COMMAND = 0x34 / 4;
+constexpr int READ_BUSY = 0x38 / 4;
+
+/// Emulates the SCA register blocks of the CRU links. An executed command stays busy for a few polls, and its result
+/// has the data incremented by one. A command with transaction ID 0x66 fails with an "invalid command" error.
+class FakeBar : public RegisterReadWriteInterface
+{
+  public:
+    virtual uint32_t readRegister(int index) override
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto& link = getLink(index);
+      switch (getRegister(index)) {
+        case READ_BUSY:
+          return (link.busyPolls > 0 && link.busyPolls--) ? (1u << 31) : 0;
+        case READ_COMMAND:
+          return (link.channelBusyPolls > 0 && link.channelBusyPolls--) ? 0x40 : link.resultCommand;
+        case READ_DATA:
+          return link.resultData;
+        default:
+          return 0;
+      }
+    }
+
+    virtual void writeRegister(int index, uint32_t value) override
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto& link = getLink(index);
+      switch (getRegister(index)) {
+        case WRITE_DATA:
+          link.data = value;
+          break;
+        case WRITE_COMMAND:
+          link.command = value;
+          break;
+        case CONTROL:
+          if (value == 0x4) {
+            link.executed++;
+            link.busyPolls = 3;
+            link.channelBusyPolls = 2;
+            link.resultData = link.data + 1;
+            bool fail = ((link.command >> 16) & 0xff) == 0x66;
+            link.resultCommand = (link.command & ~0xffu) | (fail ? 0x4 : 0x0);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+
+    struct Link
+    {
+        uint32_t data = 0;
+        uint32_t command = 0;
+        uint32_t resultData = 0;
+        uint32_t resultCommand = 0;
+        int busyPolls = 0;
+        int channelBusyPolls = 0;
+        int executed = 0;
+    };
+
+    Link& getLink(int index)
+    {
+      return mLinks[(index - CRU_BASE_INDEX) / CRU_LINK_OFFSET];
+    }
+
+    int getRegister(int index)
+    {
+      return (index - CRU_BASE_INDEX) % CRU_LINK_OFFSET;
+    }
+
+    std::map<int, Link> mLinks;
+    std::mutex mMutex;
+};
+
+std::vector<Sca::CommandData> makeSequence(uint32_t dataBase, int commands)
+{
+  std::vector<Sca::CommandData> sequence;
+  for (int i = 0; i < commands; ++i) {
+    sequence.push_back({uint32_t(0x02010000 | ((i + 1) << 8)), dataBase + i});
+  }
+  return sequence;
+}
+
+BOOST_AUTO_TEST_CASE(Sequence)
+{
+  FakeBar bar;
+  Sca sca(bar, CardType::Cru, 0);
+  auto sequence = makeSequence(100, 10);
+  auto result = sca.executeSequence(sequence);
+  BOOST_CHECK(!result.error);
+  BOOST_REQUIRE_EQUAL(result.results.size(), sequence.size());
+  for (size_t i = 0; i < sequence.size(); ++i) {
+    BOOST_CHECK_EQUAL(result.results[i].data, sequence[i].data + 1);
+    BOOST_CHECK_EQUAL(result.results[i].command, sequence[i].command);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SequenceError)
+{
+  FakeBar bar;
+  Sca sca(bar, CardType::Cru, 0);
+  auto sequence = makeSequence(100, 5);
+  sequence[2].command = 0x02660000;
+  auto result = sca.executeSequence(sequence);
+  BOOST_CHECK(result.error);
+  BOOST_CHECK_EQUAL(result.results.size(), 2);
+  BOOST_CHECK_EQUAL(bar.mLinks[0].executed, 3);
+
+  // Invalid transaction IDs are caught before executing anything
+  FakeBar bar2;
+  Sca sca2(bar2, CardType::Cru, 0);
+  auto result2 = sca2.executeSequence({{0x02000000, 0}});
+  BOOST_CHECK(result2.error);
+  BOOST_CHECK_EQUAL(bar2.mLinks[0].executed, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelLinks)
+{
+  FakeBar bar;
+  std::map<int, std::vector<Sca::CommandData>> sequences;
+  for (int link = 0; link < 4; ++link) {
+    sequences[link] = makeSequence(link * 1000, 20);
+  }
+  auto results = Sca::executeSequences(bar, CardType::Cru, sequences);
+  BOOST_REQUIRE_EQUAL(results.size(), sequences.size());
+  for (const auto& sequence : sequences) {
+    const auto& result = results.at(sequence.first);
+    BOOST_CHECK(!result.error);
+    BOOST_REQUIRE_EQUAL(result.results.size(), sequence.second.size());
+    for (size_t i = 0; i < sequence.second.size(); ++i) {
+      BOOST_CHECK_EQUAL(result.results[i].data, sequence.second[i].data + 1);
+    }
+  }
+
+  BOOST_CHECK_THROW(Sca::executeSequences(bar, CardType::Cru, {{99, makeSequence(0, 1)}}), std::exception);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,51 @@
+/// \file TestAlignedAllocator.cxx
+/// \brief Test of the AlignedAllocator class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestAlignedAllocator
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstdint>
+#include <vector>
+#include <boost/circular_buffer.hpp>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Superpage.h"
+#include "Utilities/AlignedAllocator.h"
+
+using namespace ::AliceO2::roc;
+using Utilities::CACHE_LINE_SIZE;
+
+namespace {
+
+bool isCacheAligned(const void* pointer)
+{
+  return (reinterpret_cast<uintptr_t>(pointer) % CACHE_LINE_SIZE) == 0;
+}
+
+BOOST_AUTO_TEST_CASE(Vector)
+{
+  for (size_t size = 1; size < 100; size += 7) {
+    std::vector<char, Utilities::CacheAlignedAllocator<char>> vector(size);
+    BOOST_CHECK(isCacheAligned(vector.data()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SuperpageQueue)
+{
+  // Every superpage of the queue is on its own cache line, also after the ring wrapped around
+  boost::circular_buffer<Superpage, Utilities::CacheAlignedAllocator<Superpage>> queue(5);
+  for (size_t i = 0; i < 12; ++i) {
+    if (queue.full()) {
+      queue.pop_front();
+    }
+    queue.push_back(Superpage(i, 32 * 1024));
+    for (const auto& superpage : queue) {
+      BOOST_CHECK(isCacheAligned(&superpage));
+    }
+  }
+  BOOST_CHECK_EQUAL(queue.front().getOffset(), 7);
+  BOOST_CHECK_EQUAL(queue.back().getOffset(), 11);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,150 @@
+/// \file TestAsyncLogger.cxx
+/// \brief Tests for the AsyncLogger and LogRateLimit classes
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestAsyncLogger
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "AsyncLogger.h"
+
+using namespace AliceO2::roc;
+
+namespace {
+
+constexpr auto INFO = AliceO2::InfoLogger::InfoLogger::Info;
+
+/// Collects the messages of a logger
+struct Collector
+{
+    AsyncLogger::Sink makeSink()
+    {
+      return [this](AsyncLogger::Severity, const std::string& message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back(message);
+      };
+    }
+
+    std::vector<std::string> get()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return messages;
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> messages;
+};
+
+BOOST_AUTO_TEST_CASE(InOrder)
+{
+  Collector collector;
+  {
+    AsyncLogger logger(collector.makeSink(), std::chrono::milliseconds(1));
+    for (int i = 0; i < 100; ++i) {
+      BOOST_CHECK(logger.post(INFO, std::to_string(i)));
+    }
+  }
+  auto messages = collector.get();
+  BOOST_REQUIRE_EQUAL(messages.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(messages[i], std::to_string(i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LongMessage)
+{
+  Collector collector;
+  {
+    AsyncLogger logger(collector.makeSink(), std::chrono::hours(1));
+    logger.post(INFO, std::string(AsyncLogger::MAX_MESSAGE_SIZE + 10, 'x'));
+    logger.post(INFO, "");
+  }
+  auto messages = collector.get();
+  BOOST_REQUIRE_EQUAL(messages.size(), 3);
+  BOOST_CHECK_EQUAL(messages[0].size(), AsyncLogger::MAX_MESSAGE_SIZE);
+  BOOST_CHECK_EQUAL(messages[1], std::string(10, 'x'));
+  BOOST_CHECK(messages[2].empty());
+}
+
+BOOST_AUTO_TEST_CASE(DropWhenFull)
+{
+  Collector collector;
+  {
+    // The flusher does not run before the logger is destroyed, so the ring fills up
+    AsyncLogger logger(collector.makeSink(), std::chrono::hours(1));
+    for (size_t i = 0; i < AsyncLogger::CAPACITY; ++i) {
+      BOOST_CHECK(logger.post(INFO, "message"));
+    }
+    BOOST_CHECK(!logger.post(INFO, "dropped"));
+    BOOST_CHECK_EQUAL(logger.getDropped(), 1);
+
+    logger.flush();
+    BOOST_CHECK(logger.post(INFO, "after flush"));
+  }
+  auto messages = collector.get();
+  BOOST_REQUIRE_EQUAL(messages.size(), AsyncLogger::CAPACITY + 2);
+  BOOST_CHECK_EQUAL(messages[AsyncLogger::CAPACITY], "1 log messages dropped, the asynchronous log ring was full");
+  BOOST_CHECK_EQUAL(messages.back(), "after flush");
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentPosts)
+{
+  constexpr int threads = 4;
+  constexpr int perThread = 1000;
+  Collector collector;
+  uint64_t dropped = 0;
+  {
+    AsyncLogger logger(collector.makeSink(), std::chrono::milliseconds(1));
+    std::vector<std::thread> posters;
+    for (int t = 0; t < threads; ++t) {
+      posters.emplace_back([&logger, t] {
+        for (int i = 0; i < perThread; ++i) {
+          logger.post(INFO, std::to_string(t) + ":" + std::to_string(i));
+        }
+      });
+    }
+    for (auto& poster : posters) {
+      poster.join();
+    }
+    dropped = logger.getDropped();
+  }
+  // Every message either arrived or was counted as dropped, and the messages of a thread kept their order
+  auto messages = collector.get();
+  std::vector<int> next(threads, 0);
+  size_t arrived = 0;
+  for (const auto& message : messages) {
+    auto colon = message.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    int t = std::stoi(message.substr(0, colon));
+    int i = std::stoi(message.substr(colon + 1));
+    BOOST_CHECK(i >= next[t]);
+    next[t] = i + 1;
+    arrived++;
+  }
+  BOOST_CHECK_EQUAL(arrived + dropped, threads * perThread);
+}
+
+BOOST_AUTO_TEST_CASE(RateLimit)
+{
+  LogRateLimit limit(3, std::chrono::seconds(1));
+  auto start = LogRateLimit::Clock::now();
+  int allowed = 0;
+  for (int i = 0; i < 10; ++i) {
+    allowed += limit.allow(start) ? 1 : 0;
+  }
+  BOOST_CHECK_EQUAL(allowed, 3);
+  BOOST_CHECK_EQUAL(limit.takeSuppressed(), 7);
+  BOOST_CHECK_EQUAL(limit.takeSuppressed(), 0);
+  BOOST_CHECK(!limit.allow(start + std::chrono::milliseconds(999)));
+  BOOST_CHECK(limit.allow(start + std::chrono::seconds(1)));
+}
+
+} // Anonymous namespace
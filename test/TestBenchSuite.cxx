@@ -0,0 +1,109 @@
+/// \file TestBenchSuite.cxx
+/// \brief Test of the configuration matrix and result comparison of roc-bench-suite
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestBenchSuite
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <algorithm>
+#include <cstdio>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/BenchmarkOutput.h"
+#include "CommandLineUtilities/BenchSuite.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+
+namespace {
+
+const std::string path("/tmp/AliceO2_TestBenchSuite");
+
+bool contains(const std::vector<std::string>& strings, const std::string& string)
+{
+  return std::find(strings.begin(), strings.end(), string) != strings.end();
+}
+
+BOOST_AUTO_TEST_CASE(Configurations)
+{
+  BenchSuite::Matrix matrix;
+  matrix.superpageSizes = {"256Ki", "1Mi"};
+  matrix.linkCounts = {1, 12};
+  matrix.generatorSizes = {"default", "random"};
+  matrix.errorChecks = {true, false};
+  matrix.pinnings = {"numa"};
+  auto configurations = BenchSuite::makeConfigurations(matrix);
+  BOOST_REQUIRE_EQUAL(configurations.size(), 16);
+
+  const auto& last = configurations.back();
+  BOOST_CHECK_EQUAL(last.name, "sp=1Mi,links=12,size=random,check=off,pin=numa");
+  BOOST_CHECK(!last.errorCheck);
+  BOOST_CHECK(contains(last.arguments, "--superpage-size=1Mi"));
+  BOOST_CHECK(contains(last.arguments, "--links=0-11"));
+  BOOST_CHECK(contains(last.arguments, "--generator-random-size"));
+  BOOST_CHECK(contains(last.arguments, "--no-errorcheck"));
+  BOOST_CHECK(contains(last.arguments, "--numa-pin"));
+
+  matrix.pinnings = {"everywhere"};
+  BOOST_CHECK_THROW(BenchSuite::makeConfigurations(matrix), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(ReadSummary)
+{
+  {
+    BenchmarkOutput output(path, BenchmarkOutput::Format::Json, {{"superpage-size", "1Mi"}});
+    BenchmarkOutput::Sample sample;
+    sample.seconds = 2;
+    sample.bytes = 1000 * 1000 * 1000;
+    output.writeSample(sample);
+    sample.errors = 3;
+    output.writeSummary(sample);
+  }
+  auto summary = BenchSuite::readBenchmarkSummary(path);
+  BOOST_REQUIRE(summary);
+  BOOST_CHECK(summary->completed);
+  BOOST_CHECK_CLOSE(summary->gbps, 4.0, 0.01);
+  BOOST_CHECK_EQUAL(summary->errors.value_or(-1), 3);
+  std::remove(path.c_str());
+  BOOST_CHECK(!BenchSuite::readBenchmarkSummary(path));
+}
+
+BOOST_AUTO_TEST_CASE(CompareWithBaseline)
+{
+  std::vector<BenchSuite::Result> baseline(4);
+  baseline[0].name = "a";
+  baseline[0].gbps = 100;
+  baseline[1].name = "b";
+  baseline[1].gbps = 100;
+  baseline[1].tolerance = 0.2;
+  baseline[2].name = "c";
+  baseline[2].gbps = 100;
+  baseline[3].name = "d";
+  baseline[3].gbps = 100;
+  for (auto& result : baseline) {
+    result.completed = true;
+  }
+  BenchSuite::writeResults(path, baseline);
+  auto read = BenchSuite::readResults(path);
+  std::remove(path.c_str());
+  BOOST_REQUIRE_EQUAL(read.size(), 4);
+  BOOST_CHECK_EQUAL(read[1].tolerance.value_or(0), 0.2);
+  BOOST_CHECK(!read[0].errors);
+
+  auto results = read;
+  results[0].gbps = 96; // Within 5%
+  results[1].gbps = 85; // Within its own 20%
+  results[2].gbps = 90;
+  results[3].errors = 1;
+  results.push_back(results[0]);
+  results.back().name = "new";
+  results.back().completed = false;
+
+  auto regressions = BenchSuite::compare(results, read, 0.05);
+  BOOST_REQUIRE_EQUAL(regressions.size(), 2);
+  BOOST_CHECK_EQUAL(regressions[0].substr(0, 2), "c:");
+  BOOST_CHECK_EQUAL(regressions[1], "d: 1 errors");
+}
+
+} // Anonymous namespace
@@ -0,0 +1,82 @@
+/// \file TestBenchmarkOutput.cxx
+/// \brief Test of the BenchmarkOutput class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestBenchmarkOutput
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/BenchmarkOutput.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+
+namespace {
+
+const std::string path("/tmp/AliceO2_BenchmarkOutput_Test");
+
+std::vector<std::string> readLines()
+{
+  std::vector<std::string> lines;
+  std::ifstream stream(path);
+  for (std::string line; std::getline(stream, line);) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+/// Writes two samples, one second apart with 1 GB read out in between, and a summary
+void writeRecords(BenchmarkOutput::Format format)
+{
+  BenchmarkOutput output(path, format, {{"id", "-1"}, {"name", "a \"b\"\n"}});
+  BenchmarkOutput::Sample sample;
+  sample.seconds = 1;
+  sample.pushed = 10;
+  sample.read = 8;
+  sample.bytes = 1000 * 1000 * 1000;
+  sample.payloadBytes = 900 * 1000 * 1000;
+  sample.links = {{0, 5, 500}, {3, 5, 600}};
+  sample.errors = 2;
+  sample.driverQueue = 4;
+  sample.readoutQueue = 2;
+  sample.freeQueue = 1;
+  output.writeSample(sample);
+  sample.seconds = 2;
+  sample.bytes *= 2;
+  output.writeSample(sample);
+  output.writeSummary(sample);
+}
+
+BOOST_AUTO_TEST_CASE(Json)
+{
+  writeRecords(BenchmarkOutput::Format::Json);
+  auto lines = readLines();
+  BOOST_REQUIRE_EQUAL(lines.size(), 3);
+  BOOST_CHECK_EQUAL(lines[1], "{\"type\":\"sample\",\"seconds\":2.000,\"pushed\":10,\"read\":8,\"bytes\":2000000000,"
+      "\"payload_bytes\":900000000,\"gbps\":8.000,\"errors\":2,\"temperature\":null,\"queues\":{\"driver\":4,\"readout\":2,\"free\":1},"
+      "\"links\":[{\"id\":0,\"superpages\":5,\"bytes\":500},{\"id\":3,\"superpages\":5,\"bytes\":600}]}");
+  BOOST_CHECK(lines[2].find("{\"type\":\"summary\"") == 0);
+  BOOST_CHECK(lines[2].find("\"configuration\":{\"id\":\"-1\",\"name\":\"a \\\"b\\\"\\n\"}") != std::string::npos);
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(Csv)
+{
+  writeRecords(BenchmarkOutput::Format::Csv);
+  auto lines = readLines();
+  BOOST_REQUIRE_EQUAL(lines.size(), 6);
+  BOOST_CHECK_EQUAL(lines[0], "# id=-1");
+  BOOST_CHECK_EQUAL(lines[1], "# name=a \"b\" ");
+  BOOST_CHECK_EQUAL(lines[2], "type,seconds,pushed,read,bytes,payload_bytes,gbps,errors,temperature,driver_queue,readout_queue,"
+      "free_queue,link0_bytes,link3_bytes");
+  BOOST_CHECK_EQUAL(lines[3], "sample,1.000,10,8,1000000000,900000000,8.000,2,,4,2,1,500,600");
+  BOOST_CHECK_EQUAL(lines[5], "summary,2.000,10,8,2000000000,900000000,8.000,2,,4,2,1,500,600");
+  boost::filesystem::remove(path);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,94 @@
+/// \file TestCacheAllocation.cxx
+/// \brief Test of the CacheAllocation class, against a directory that mimics the resctrl filesystem
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCacheAllocation
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/CacheAllocation.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+namespace bfs = boost::filesystem;
+
+namespace {
+
+const std::string resctrlPath("/tmp/AliceO2_CacheAllocation_Test");
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream stream(path);
+  std::string content;
+  std::getline(stream, content);
+  return content;
+}
+
+void writeFile(const std::string& path, const std::string& content)
+{
+  std::ofstream(path) << content;
+}
+
+/// Makes the files of a resctrl mount that CacheAllocation checks for
+struct FakeResctrl
+{
+    FakeResctrl()
+    {
+      bfs::remove_all(resctrlPath);
+      bfs::create_directories(resctrlPath + "/info/L3");
+      writeFile(resctrlPath + "/schemata", "L3:0=7ff\n");
+    }
+
+    ~FakeResctrl()
+    {
+      bfs::remove_all(resctrlPath);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(NotAvailable)
+{
+  bfs::remove_all(resctrlPath);
+  BOOST_CHECK(!CacheAllocation::isAvailable(resctrlPath));
+  BOOST_CHECK_THROW(CacheAllocation("readout", "L3:0=00f", resctrlPath), Exception);
+}
+
+BOOST_FIXTURE_TEST_CASE(GroupAndThreads, FakeResctrl)
+{
+  BOOST_CHECK(CacheAllocation::isAvailable(resctrlPath));
+  CacheAllocation allocation("readout", "L3:0=00f;1=00f", resctrlPath);
+  BOOST_CHECK_EQUAL(allocation.getPath(), resctrlPath + "/readout");
+  BOOST_CHECK_EQUAL(readFile(resctrlPath + "/readout/schemata"), "L3:0=00f;1=00f");
+
+  allocation.addCurrentThread();
+  BOOST_CHECK_EQUAL(readFile(resctrlPath + "/readout/tasks"), std::to_string(syscall(SYS_gettid)));
+
+  BOOST_CHECK_THROW(CacheAllocation::joinGroup("other", resctrlPath), Exception);
+  BOOST_CHECK_THROW(CacheAllocation("a/b", "L3:0=00f", resctrlPath), ParameterException);
+}
+
+BOOST_FIXTURE_TEST_CASE(Monitoring, FakeResctrl)
+{
+  CacheAllocation allocation("readout", "L3:0=00f", resctrlPath);
+  auto monitoring = allocation.getMonitoring();
+  BOOST_CHECK(!monitoring.llcOccupancy);
+
+  // Summed over the cache domains, skipping the ones without a counter
+  bfs::create_directories(resctrlPath + "/readout/mon_data/mon_L3_00");
+  bfs::create_directories(resctrlPath + "/readout/mon_data/mon_L3_01");
+  writeFile(resctrlPath + "/readout/mon_data/mon_L3_00/llc_occupancy", "1000\n");
+  writeFile(resctrlPath + "/readout/mon_data/mon_L3_01/llc_occupancy", "234\n");
+  writeFile(resctrlPath + "/readout/mon_data/mon_L3_00/mbm_total_bytes", "Unavailable\n");
+  monitoring = allocation.getMonitoring();
+  BOOST_REQUIRE(monitoring.llcOccupancy);
+  BOOST_CHECK_EQUAL(*monitoring.llcOccupancy, 1234);
+  BOOST_CHECK(!monitoring.totalBytes);
+  BOOST_CHECK(!monitoring.localBytes);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,79 @@
+/// \file TestChannelGroup.cxx
+/// \brief Test of the ChannelGroup class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestChannelGroup
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/ChannelGroup.h"
+#include "FakeDmaChannel.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t SUPERPAGE_SIZE = 1024 * 1024;
+
+BOOST_AUTO_TEST_CASE(PollAll)
+{
+  constexpr size_t channels = 3;
+  ChannelGroup group;
+  for (size_t i = 0; i < channels; ++i) {
+    BOOST_CHECK_EQUAL(group.addChannel(std::make_shared<FakeDmaChannel>()), i);
+  }
+  BOOST_CHECK_EQUAL(group.size(), channels);
+  group.startDma();
+
+  for (size_t i = 0; i < channels; ++i) {
+    group.getChannel(i).pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+    group.getChannel(i).pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+
+  std::vector<size_t> perChannel(channels, 0);
+  auto handled = group.poll([&](size_t index, const Superpage& superpage) {
+    BOOST_CHECK(superpage.isReady());
+    BOOST_CHECK_EQUAL(superpage.getOffset(), index * SUPERPAGE_SIZE);
+    perChannel.at(index)++;
+  });
+  BOOST_CHECK_EQUAL(handled, channels * 2);
+  for (auto count : perChannel) {
+    BOOST_CHECK_EQUAL(count, 2);
+  }
+  BOOST_CHECK_EQUAL(group.poll([](size_t, const Superpage&) {}), 0);
+  group.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(Batching)
+{
+  // With a batch size of 2, each poll handles at most 2 superpages per channel, and the first channel rotates
+  ChannelGroup group(2);
+  group.addChannel(std::make_shared<FakeDmaChannel>());
+  group.addChannel(std::make_shared<FakeDmaChannel>());
+  group.startDma();
+
+  for (size_t i = 0; i < 4; ++i) {
+    group.getChannel(0).pushSuperpage(Superpage(0, SUPERPAGE_SIZE));
+    group.getChannel(1).pushSuperpage(Superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+
+  std::vector<size_t> order;
+  auto record = [&](size_t index, const Superpage&) { order.push_back(index); };
+  BOOST_CHECK_EQUAL(group.poll(record), 4);
+  BOOST_CHECK((order == std::vector<size_t>{0, 0, 1, 1}));
+  order.clear();
+  BOOST_CHECK_EQUAL(group.poll(record), 4);
+  BOOST_CHECK((order == std::vector<size_t>{1, 1, 0, 0}));
+  group.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(InvalidArguments)
+{
+  BOOST_CHECK_THROW(ChannelGroup(0), Exception);
+  ChannelGroup group;
+  BOOST_CHECK_THROW(group.addChannel(nullptr), Exception);
+}
+
+} // Anonymous namespace
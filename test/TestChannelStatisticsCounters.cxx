@@ -0,0 +1,119 @@
+/// \file TestChannelStatisticsCounters.cxx
+/// \brief Test of the ChannelStatisticsCounters class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestChannelStatisticsCounters
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "ChannelStatisticsCounters.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(Counting)
+{
+  ChannelStatisticsCounters counters;
+  counters.addLink(3);
+  counters.addLink(7);
+
+  counters.superpageArrived(3, 1024);
+  counters.superpageArrived(3, 512);
+  counters.superpageArrived(7, 2048);
+  counters.transferQueueSize(5);
+  counters.transferQueueSize(2);
+  counters.readyQueueSize(4);
+  counters.emptyFill();
+  counters.emptyFill();
+  counters.readyQueueFull(3);
+  counters.superpageDropped();
+  counters.recovered();
+
+  auto statistics = counters.get();
+  BOOST_REQUIRE_EQUAL(statistics.links.size(), 2);
+  BOOST_CHECK_EQUAL(statistics.links[0].linkId, 3);
+  BOOST_CHECK_EQUAL(statistics.links[0].superpages, 2);
+  BOOST_CHECK_EQUAL(statistics.links[0].bytes, 1536);
+  BOOST_CHECK_EQUAL(statistics.links[1].linkId, 7);
+  BOOST_CHECK_EQUAL(statistics.links[1].superpages, 1);
+  BOOST_CHECK_EQUAL(statistics.links[1].bytes, 2048);
+  BOOST_CHECK_EQUAL(statistics.transferQueueHighWater, 5);
+  BOOST_CHECK_EQUAL(statistics.readyQueueHighWater, 4);
+  BOOST_CHECK_EQUAL(statistics.emptyFills, 2);
+  BOOST_CHECK_EQUAL(statistics.readyQueueFull, 1);
+  BOOST_CHECK_EQUAL(statistics.superpagesLeftOnCard, 3);
+  BOOST_CHECK_EQUAL(statistics.superpagesDropped, 1);
+  BOOST_CHECK_EQUAL(statistics.recoveries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(SharedTable)
+{
+  // Zeroed like a new file in /dev/shm
+  auto memory = std::make_unique<char[]>(sizeof(ChannelStatisticsTable));
+  std::fill_n(memory.get(), sizeof(ChannelStatisticsTable), 0);
+  auto table = reinterpret_cast<ChannelStatisticsTable*>(memory.get());
+  BOOST_CHECK(!table->isValid());
+
+  {
+    ChannelStatisticsCounters counters(table);
+    counters.addLink(1);
+    counters.superpageArrived(1, 4096);
+    counters.readyQueueSize(3);
+    BOOST_CHECK(table->isValid());
+    BOOST_CHECK(table->isOpen());
+
+    auto statistics = table->read();
+    BOOST_REQUIRE_EQUAL(statistics.links.size(), 1);
+    BOOST_CHECK_EQUAL(statistics.links[0].bytes, 4096);
+    BOOST_CHECK_EQUAL(statistics.readyQueueSize, 3);
+  }
+
+  // The closed channel leaves its statistics, and the next one starts over
+  BOOST_CHECK(!table->isOpen());
+  BOOST_CHECK_EQUAL(table->read().links.size(), 1);
+  ChannelStatisticsCounters counters(table);
+  BOOST_CHECK(table->isOpen());
+  BOOST_CHECK_EQUAL(table->read().links.size(), 0);
+  BOOST_CHECK_EQUAL(table->read().readyQueueSize, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConsistentSnapshots)
+{
+  constexpr uint64_t ARRIVALS = 200000;
+  constexpr size_t SIZE = 1024;
+  ChannelStatisticsCounters counters;
+  counters.addLink(0);
+
+  std::atomic<bool> done(false);
+  uint64_t inconsistent = 0;
+  std::thread reader([&] {
+    while (!done.load()) {
+      auto statistics = counters.get();
+      if (statistics.links[0].bytes != statistics.links[0].superpages * SIZE) {
+        inconsistent++;
+      }
+    }
+  });
+  for (uint64_t i = 0; i < ARRIVALS; ++i) {
+    counters.superpageArrived(0, SIZE);
+  }
+  done = true;
+  reader.join();
+
+  BOOST_CHECK_EQUAL(inconsistent, 0);
+  BOOST_CHECK_EQUAL(counters.get().links[0].superpages, ARRIVALS);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidLink)
+{
+  ChannelStatisticsCounters counters;
+  BOOST_CHECK_THROW(counters.addLink(ChannelStatisticsCounters::MAX_LINKS), std::out_of_range);
+}
+
+} // Anonymous namespace
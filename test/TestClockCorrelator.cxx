@@ -0,0 +1,120 @@
+/// \file TestClockCorrelator.cxx
+/// \brief Test of the ClockCorrelator class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestClockCorrelator
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/ClockCorrelator.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+/// A card clock of 40 MHz that runs 50 ppm fast and started counting at host time 1 s
+struct SimulatedClock
+{
+    static constexpr double FREQUENCY = 40e6 * (1 + 50e-6);
+    static constexpr int64_t START = 1000 * 1000 * 1000;
+
+    uint64_t counter(int64_t host) const
+    {
+      return uint64_t(std::llround(double(host - START) * FREQUENCY / 1e9));
+    }
+};
+
+ClockCorrelator::Options makeOptions(int counterBits)
+{
+  ClockCorrelator::Options options;
+  options.frequency = 40e6;
+  options.counterBits = counterBits;
+  return options;
+}
+
+BOOST_AUTO_TEST_CASE(OffsetAndDrift)
+{
+  SimulatedClock clock;
+  ClockCorrelator correlator([]{ return uint64_t(0); }, makeOptions(64));
+  BOOST_CHECK(!correlator.isValid());
+  BOOST_CHECK_EQUAL(correlator.toHostTime(0), 0);
+
+  // Samples every 100 ms with brackets of a microsecond, the counter read in the middle
+  for (int64_t i = 0; i < 20; ++i) {
+    int64_t host = 2 * SimulatedClock::START + i * 100 * 1000 * 1000;
+    correlator.addSample({clock.counter(host), host - 500, host + 500});
+  }
+  BOOST_CHECK(correlator.isValid());
+  BOOST_CHECK_CLOSE(correlator.getDriftPpm(), 50.0, 1.0);
+  BOOST_CHECK_LT(correlator.getResidual(), 100.0);
+
+  // A timestamp taken a while after the last sample
+  int64_t host = 2 * SimulatedClock::START + int64_t(2500) * 1000 * 1000;
+  BOOST_CHECK_LT(std::abs(correlator.toHostTime(clock.counter(host)) - host), 100);
+}
+
+BOOST_AUTO_TEST_CASE(Wrap)
+{
+  // A 16-bit counter wraps every 1.6 ms at 40 MHz, so the samples come every 0.5 ms
+  SimulatedClock clock;
+  ClockCorrelator correlator([]{ return uint64_t(0); }, makeOptions(16));
+  int64_t host = SimulatedClock::START;
+  for (int i = 0; i < 10; ++i, host += 500 * 1000) {
+    correlator.addSample({clock.counter(host) & 0xffff, host - 50, host + 50});
+  }
+  BOOST_CHECK_CLOSE(correlator.getDriftPpm(), 50.0, 5.0);
+
+  // Truncated timestamps a little before and after the latest sample
+  const int64_t last = host - 500 * 1000;
+  for (int64_t delta : {-500 * 1000, -1000, 0, 1000, 500 * 1000}) {
+    BOOST_CHECK_LT(std::abs(correlator.toHostTime(clock.counter(last + delta) & 0xffff) - (last + delta)), 100);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SingleSample)
+{
+  ClockCorrelator correlator([]{ return uint64_t(0); }, makeOptions(32));
+  correlator.addSample({1000, 5000, 5000});
+  // With one sample, the nominal frequency is used: 40 ticks per microsecond
+  BOOST_CHECK_EQUAL(correlator.toHostTime(1040), 6000);
+  BOOST_CHECK_EQUAL(correlator.toHostTime(960), 4000);
+  BOOST_CHECK_CLOSE(correlator.getFrequency(), 40e6, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(BackgroundSampling)
+{
+  // A counter of microseconds of the host clock itself
+  ClockCorrelator::Options options;
+  options.frequency = 1e6;
+  options.counterBits = 64;
+  options.interval = std::chrono::milliseconds(5);
+  ClockCorrelator correlator([]{ return uint64_t(ClockCorrelator::getHostTime() / 1000); }, options);
+  correlator.start();
+  for (int i = 0; i < 200 && correlator.getSampleCount() < 5; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  correlator.stop();
+  BOOST_REQUIRE_GE(correlator.getSampleCount(), 5);
+
+  const auto now = ClockCorrelator::getHostTime();
+  BOOST_CHECK_LT(std::abs(correlator.toHostTime(uint64_t(now / 1000)) - now), 100 * 1000);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  auto read = []{ return uint64_t(0); };
+  ClockCorrelator::Options options;
+  BOOST_CHECK_THROW(ClockCorrelator(read, options), Exception);
+  options = makeOptions(0);
+  BOOST_CHECK_THROW(ClockCorrelator(read, options), Exception);
+  options = makeOptions(32);
+  options.readsPerSample = 0;
+  BOOST_CHECK_THROW(ClockCorrelator(read, options), Exception);
+}
+
+} // Anonymous namespace
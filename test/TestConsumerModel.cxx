@@ -0,0 +1,70 @@
+/// \file TestConsumerModel.cxx
+/// \brief Test of the ConsumerModel class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestConsumerModel
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/ConsumerModel.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+using namespace std::chrono_literals;
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(Parse)
+{
+  BOOST_CHECK(ConsumerModel().getType() == ConsumerModel::Type::None);
+  BOOST_CHECK(ConsumerModel("random").getType() == ConsumerModel::Type::RandomPause);
+  BOOST_CHECK(ConsumerModel("pareto:50us,1.5").getType() == ConsumerModel::Type::Pareto);
+  BOOST_CHECK(ConsumerModel::parseDuration("1.5ms") == 1500us);
+  BOOST_CHECK_THROW(ConsumerModel("constant"), Exception);
+  BOOST_CHECK_THROW(ConsumerModel("constant:2"), Exception);
+  BOOST_CHECK_THROW(ConsumerModel("stall:1s"), Exception);
+  BOOST_CHECK_THROW(ConsumerModel("pareto:50us,0"), Exception);
+  BOOST_CHECK_THROW(ConsumerModel("lazy"), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(ConstantAndStall)
+{
+  const ConsumerModel::Clock::time_point start;
+  ConsumerModel constant("constant:2us");
+  BOOST_CHECK(constant.getDelay(start, 8) == 16us);
+
+  ConsumerModel stall("stall:1s,200ms");
+  BOOST_CHECK(stall.getDelay(start, 1) == 0ns);
+  BOOST_CHECK(stall.getDelay(start + 999ms, 1) == 0ns);
+  BOOST_CHECK(stall.getDelay(start + 1s, 1) == 200ms);
+  BOOST_CHECK(stall.getDelay(start + 1500ms, 1) == 0ns);
+  // The stalls at 2 and 3 s were missed, so the next is at 4 s
+  BOOST_CHECK(stall.getDelay(start + 3500ms, 1) == 200ms);
+  BOOST_CHECK(stall.getDelay(start + 3900ms, 1) == 0ns);
+  BOOST_CHECK(stall.getDelay(start + 4s, 1) == 200ms);
+}
+
+BOOST_AUTO_TEST_CASE(Pareto)
+{
+  ConsumerModel pareto("pareto:10us,1.5", 42);
+  const ConsumerModel::Clock::time_point start;
+  std::chrono::nanoseconds total(0);
+  std::chrono::nanoseconds max(0);
+  const int samples = 100000;
+  for (int i = 0; i < samples; ++i) {
+    auto delay = pareto.getDelay(start, 1);
+    BOOST_REQUIRE(delay >= 10us);
+    BOOST_REQUIRE(delay <= ConsumerModel::MAX_PARETO_DELAY);
+    total += delay;
+    max = std::max(max, delay);
+  }
+  // The mean is scale * shape / (shape - 1) = 30 us, though the heavy tail makes the sample mean noisy
+  const double mean = std::chrono::duration<double, std::micro>(total).count() / samples;
+  BOOST_CHECK_GT(mean, 20);
+  BOOST_CHECK_LT(mean, 45);
+  BOOST_CHECK(max > 1ms);
+}
+
+} // Anonymous namespace
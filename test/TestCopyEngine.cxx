@@ -0,0 +1,51 @@
+/// \file TestCopyEngine.cxx
+/// \brief Test of the CopyEngine class, with the CPU fallback
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCopyEngine
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <numeric>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/CopyEngine.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t COPY_SIZE = 4096;
+
+BOOST_AUTO_TEST_CASE(CopiesInOrder)
+{
+  // A work queue that does not exist falls back to the CPU
+  CopyEngine engine("/dev/dsa/wq-does-not-exist");
+  BOOST_CHECK(!engine.isHardware());
+
+  std::vector<char> source(COPY_SIZE * CopyEngine::QUEUE_DEPTH);
+  std::iota(source.begin(), source.end(), 0);
+  std::vector<char> destination(source.size(), 0);
+  for (size_t i = 0; i < CopyEngine::QUEUE_DEPTH; ++i) {
+    BOOST_REQUIRE(engine.submit(&destination[i * COPY_SIZE], &source[i * COPY_SIZE], COPY_SIZE, 100 + i));
+  }
+  BOOST_CHECK(!engine.submit(destination.data(), source.data(), COPY_SIZE, 0));
+  BOOST_CHECK_EQUAL(engine.getInFlight(), CopyEngine::QUEUE_DEPTH);
+
+  uint64_t tags[CopyEngine::QUEUE_DEPTH];
+  BOOST_CHECK_EQUAL(engine.poll(tags, 2), 2);
+  BOOST_CHECK_EQUAL(tags[0], 100);
+  BOOST_CHECK_EQUAL(tags[1], 101);
+  BOOST_CHECK_EQUAL(engine.poll(tags, CopyEngine::QUEUE_DEPTH), CopyEngine::QUEUE_DEPTH - 2);
+  BOOST_CHECK_EQUAL(tags[0], 102);
+  BOOST_CHECK_EQUAL(engine.getInFlight(), 0);
+  BOOST_CHECK(destination == source);
+  BOOST_CHECK_EQUAL(engine.getFallbackCount(), 0);
+
+  // The queue can be reused once the copies were returned
+  BOOST_CHECK(engine.submit(destination.data(), source.data(), COPY_SIZE, 7));
+  BOOST_CHECK_EQUAL(engine.poll(tags, 1), 1);
+  BOOST_CHECK_EQUAL(tags[0], 7);
+}
+
+} // Anonymous namespace
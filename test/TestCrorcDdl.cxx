@@ -0,0 +1,82 @@
+/// \file TestCrorcDdl.cxx
+/// \brief Test of the C-RORC DDL command waits
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCrorcDdl
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "Crorc/Constants.h"
+#include "Crorc/Crorc.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+/// Link that is up, but never takes a command or answers one. The BAR reads are counted.
+class DeadLinkBar : public RegisterReadWriteInterface
+{
+  public:
+    virtual uint32_t readRegister(int index) override
+    {
+      reads++;
+      if (index == Rorc::C_CSR) {
+        return commandBusy ? Rorc::CcsrStatus::CMD_NOT_EMPTY : 0;
+      }
+      return 0;
+    }
+
+    virtual void writeRegister(int, uint32_t) override
+    {
+    }
+
+    bool commandBusy = true;
+    std::atomic<int64_t> reads {0};
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+BOOST_AUTO_TEST_CASE(CommandTimeout)
+{
+  DeadLinkBar bar;
+  Crorc::Crorc crorc(bar);
+  auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK_THROW(crorc.siuCommand(0), TimeoutException);
+  // The timeout is a time, not a number of reads, so it does not depend on how fast the reads are
+  BOOST_CHECK_LT(secondsSince(start), 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(StatusTimeout)
+{
+  DeadLinkBar bar;
+  bar.commandBusy = false;
+  Crorc::Crorc crorc(bar);
+  BOOST_CHECK_THROW(crorc.siuCommand(0), TimeoutException);
+  // After the spin time, the wait sleeps between polls, so it doesn't read in a tight loop for the whole timeout
+  BOOST_CHECK_LT(bar.reads.load(), 100000);
+}
+
+BOOST_AUTO_TEST_CASE(ArmDdlAsync)
+{
+  constexpr int CHANNELS = 6;
+  std::vector<DeadLinkBar> bars(CHANNELS);
+  std::vector<std::future<void>> futures;
+  for (auto& bar : bars) {
+    futures.push_back(Crorc::Crorc(bar).armDdlAsync(Rorc::Reset::SIU, Crorc::Crorc::DiuConfig()));
+  }
+  for (auto& future : futures) {
+    // The SIU reset fails on a dead link, the error comes out of the future
+    BOOST_CHECK_THROW(future.get(), Exception);
+  }
+}
+
+} // Anonymous namespace
@@ -0,0 +1,167 @@
+/// \file TestCrorcFlash.cxx
+/// \brief Test of the C-RORC flash programming
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCrorcFlash
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "Crorc/Constants.h"
+#include "Crorc/Crorc.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr uint32_t BUFFER_PROGRAM = 0x030000e8;
+constexpr uint32_t COMMAND_BASE = 0x03000000;
+constexpr uint32_t READ_STATUS = 0x04000000;
+constexpr uint32_t READ_ARRAY = 0x030000ff;
+constexpr uint32_t ADDRESS_START = 0x01000000;
+
+/// Flash that is always ready and always reports a good status. In read array mode, reads return the word of the
+/// memory at the last address. The writes to the data & status register are recorded.
+class FakeFlash : public RegisterReadWriteInterface
+{
+  public:
+    virtual uint32_t readRegister(int index) override
+    {
+      if (index == Rorc::Flash::LRD) {
+        return ready ? 1 : 0;
+      }
+      if (index == Rorc::Flash::IADR) {
+        return readArray ? memory.at(address - ADDRESS_START) : 0x80;
+      }
+      return 0;
+    }
+
+    virtual void writeRegister(int index, uint32_t value) override
+    {
+      if (index == Rorc::Flash::IFDSR) {
+        writes.push_back(value);
+        if ((value & 0xff000000) == ADDRESS_START) {
+          address = value;
+        } else if ((value & 0xff000000) == COMMAND_BASE) {
+          readArray = (value == READ_ARRAY);
+        }
+      }
+    }
+
+    bool ready = true;
+    std::vector<uint32_t> writes;
+    std::vector<uint16_t> memory;
+    uint32_t address = 0;
+    bool readArray = false;
+};
+
+/// Writes a flash file of the given amount of words and removes it at the end of the scope
+struct FlashFile
+{
+    FlashFile(int words)
+      : path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+    {
+      std::ofstream stream(path);
+      for (int i = 0; i < words; ++i) {
+        stream << (i & 0xffff) << '\n';
+      }
+    }
+
+    ~FlashFile()
+    {
+      std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+BOOST_AUTO_TEST_CASE(BufferedProgram)
+{
+  FakeFlash flash;
+  FlashFile file(40);
+  std::ostringstream out;
+  Crorc::programFlash(flash, file.path, 0, out);
+
+  // 40 words go in a buffer of 32 and one of 8. The word count after the buffer program command is count - 1, after
+  // the status reads of the check.
+  std::vector<uint32_t> counts;
+  std::vector<uint32_t> words;
+  for (size_t i = 0; i < flash.writes.size(); ++i) {
+    if (flash.writes[i] == BUFFER_PROGRAM) {
+      size_t j = i + 1;
+      while (flash.writes.at(j) == READ_STATUS) {
+        ++j;
+      }
+      auto count = flash.writes.at(j) - COMMAND_BASE + 1;
+      counts.push_back(count);
+      // Then pairs of address and data
+      for (size_t k = 0; k < count; ++k) {
+        words.push_back(flash.writes.at(j + 2 + k * 2) - COMMAND_BASE);
+      }
+    }
+  }
+  std::vector<uint32_t> expectedCounts {32, 8};
+  BOOST_CHECK_EQUAL_COLLECTIONS(counts.begin(), counts.end(), expectedCounts.begin(), expectedCounts.end());
+  BOOST_REQUIRE_EQUAL(words.size(), 40);
+  for (uint32_t i = 0; i < words.size(); ++i) {
+    BOOST_CHECK_EQUAL(words[i], i);
+  }
+  BOOST_CHECK(out.str().find("Completed programming 40 words") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(NotReady)
+{
+  FakeFlash flash;
+  flash.ready = false;
+  FlashFile file(1);
+  std::ostringstream out;
+  BOOST_CHECK_THROW(Crorc::programFlash(flash, file.path, 0, out), TimeoutException);
+}
+
+BOOST_AUTO_TEST_CASE(MissingFile)
+{
+  FakeFlash flash;
+  std::ostringstream out;
+  BOOST_CHECK_THROW(Crorc::programFlash(flash, "/nonexistent/flash/file", 0, out), Exception);
+  BOOST_CHECK(flash.writes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ReadWords)
+{
+  FakeFlash flash;
+  for (int i = 0; i < 100; ++i) {
+    flash.memory.push_back(0xa000 + i);
+  }
+  std::vector<uint16_t> words(10);
+  Crorc::readFlashWords(flash, 20, words.data(), words.size());
+  for (size_t i = 0; i < words.size(); ++i) {
+    BOOST_CHECK_EQUAL(words[i], 0xa000 + 20 + i);
+  }
+  // The read array command is given once, then every word takes an address and a read
+  BOOST_CHECK_EQUAL(flash.writes.size(), 2 + words.size() * 2);
+}
+
+BOOST_AUTO_TEST_CASE(Verify)
+{
+  FakeFlash flash;
+  FlashFile file(5000);
+  for (int i = 0; i < 5000; ++i) {
+    flash.memory.push_back(i);
+  }
+  BOOST_CHECK(!Crorc::verifyFlash(flash, file.path));
+
+  flash.memory[4500] = 0x1234;
+  auto mismatch = Crorc::verifyFlash(flash, file.path);
+  BOOST_REQUIRE(mismatch);
+  BOOST_CHECK_EQUAL(mismatch->offset, 4500);
+  BOOST_CHECK_EQUAL(mismatch->expected, 4500);
+  BOOST_CHECK_EQUAL(mismatch->actual, 0x1234);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,96 @@
+/// \file TestCrorcStartCoordinator.cxx
+/// \brief Test of the CrorcStartCoordinator class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCrorcStartCoordinator
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "Crorc/CrorcStartCoordinator.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(ConfigureOnceTriggerOnce)
+{
+  CrorcStartCoordinator coordinator({0, 1, 2});
+  int configured = 0;
+  int triggered = 0;
+  auto configure = [&]{ configured++; };
+  auto trigger = [&]{ triggered++; };
+
+  for (int start = 1; start <= 2; ++start) {
+    for (uint32_t channel : {2, 0, 1}) {
+      coordinator.beginArming(channel, configure);
+    }
+    BOOST_CHECK_EQUAL(configured, start);
+
+    BOOST_CHECK(!coordinator.armed(2, trigger));
+    BOOST_CHECK(!coordinator.armed(0, trigger));
+    BOOST_CHECK_EQUAL(triggered, start - 1);
+    BOOST_CHECK(coordinator.armed(1, trigger));
+    BOOST_CHECK_EQUAL(triggered, start);
+    BOOST_CHECK(coordinator.getArmed().empty());
+    BOOST_CHECK_EQUAL(coordinator.getStartCount(), start);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Disarm)
+{
+  CrorcStartCoordinator coordinator({0, 1});
+  int triggered = 0;
+  auto trigger = [&]{ triggered++; };
+  coordinator.armed(0, trigger);
+  coordinator.disarm(0);
+  coordinator.armed(1, trigger);
+  BOOST_CHECK_EQUAL(triggered, 0);
+  coordinator.armed(0, trigger);
+  BOOST_CHECK_EQUAL(triggered, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Threads)
+{
+  // Every channel armed from a thread of its own, as with one readout thread per channel
+  CrorcStartCoordinator::Channels channels = {0, 1, 2, 3, 4, 5};
+  CrorcStartCoordinator coordinator(channels);
+  std::atomic<int> configured(0);
+  std::atomic<int> triggered(0);
+  std::vector<std::thread> threads;
+  for (auto channel : channels) {
+    threads.emplace_back([&, channel]{
+      coordinator.beginArming(channel, [&]{ configured++; });
+      coordinator.armed(channel, [&]{ triggered++; });
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK_EQUAL(configured, 1);
+  BOOST_CHECK_EQUAL(triggered, 1);
+}
+
+BOOST_AUTO_TEST_CASE(SharedPerCard)
+{
+  PciAddress address(1, 2, 3);
+  auto a = CrorcStartCoordinator::get(address, {0, 1});
+  auto b = CrorcStartCoordinator::get(address, {0, 1});
+  BOOST_CHECK_EQUAL(a, b);
+  BOOST_CHECK_THROW(CrorcStartCoordinator::get(address, {0, 2}), Exception);
+  BOOST_CHECK_NE(CrorcStartCoordinator::get(PciAddress(1, 2, 4), {0, 2}), a);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidChannel)
+{
+  CrorcStartCoordinator coordinator({0, 1});
+  BOOST_CHECK_THROW(coordinator.beginArming(3, []{}), Exception);
+  BOOST_CHECK_THROW(coordinator.armed(3, []{}), Exception);
+  BOOST_CHECK_THROW(CrorcStartCoordinator({}), Exception);
+}
+
+} // Anonymous namespace
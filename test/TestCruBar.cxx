@@ -51,6 +51,34 @@ BOOST_AUTO_TEST_CASE(TestFirmwareFeatures)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestFirmwareCapabilities)
+{
+  {
+    // Firmware without the capabilities register
+    FirmwareFeatures f = CruBar::convertToFirmwareFeatures(0x40000000, 0xffffffff);
+    BOOST_CHECK(!f.statusPage);
+    BOOST_CHECK(!f.interrupts);
+    BOOST_CHECK(!f.descriptorBurst);
+    BOOST_CHECK_EQUAL(f.maxDmaPageSize, Cru::DMA_PAGE_SIZE);
+    BOOST_CHECK(!CruBar::convertToFirmwareFeatures(0x40000000, 0).statusPage);
+  }
+  {
+    // Everything, with pages up to 64 KiB
+    FirmwareFeatures f = CruBar::convertToFirmwareFeatures(0x40000000, 0xca9a + (0b111 << 16) + (3 << 20));
+    BOOST_CHECK(f.statusPage);
+    BOOST_CHECK(f.interrupts);
+    BOOST_CHECK(f.descriptorBurst);
+    BOOST_CHECK_EQUAL(f.maxDmaPageSize, 64 * 1024);
+  }
+  {
+    // Individual capabilities
+    BOOST_CHECK(CruBar::convertToFirmwareFeatures(0x40000000, 0xca9a + (1 << 16)).statusPage);
+    BOOST_CHECK(!CruBar::convertToFirmwareFeatures(0x40000000, 0xca9a + (1 << 16)).interrupts);
+    BOOST_CHECK(CruBar::convertToFirmwareFeatures(0x40000000, 0xca9a + (1 << 17)).interrupts);
+    BOOST_CHECK(CruBar::convertToFirmwareFeatures(0x40000000, 0xca9a + (1 << 18)).descriptorBurst);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestDataGeneratorConfiguration)
 {
   {
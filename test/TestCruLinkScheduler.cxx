@@ -0,0 +1,102 @@
+/// \file TestCruLinkScheduler.cxx
+/// \brief Test of the CRU LinkScheduler class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCruLinkScheduler
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <deque>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "Cru/LinkScheduler.h"
+
+using namespace ::AliceO2::roc;
+using Cru::LinkScheduler;
+
+namespace {
+
+constexpr size_t LINKS = 4;
+constexpr size_t LINK_CAPACITY = 128;
+
+BOOST_AUTO_TEST_CASE(ShortestQueue)
+{
+  LinkScheduler scheduler(LinkScheduling::ShortestQueue, LINKS, LINK_CAPACITY);
+  std::vector<size_t> pushed(LINKS, 0);
+  for (size_t i = 0; i < LINKS * 10; ++i) {
+    auto index = scheduler.getNextLinkIndex();
+    scheduler.pushed(index);
+    pushed.at(index)++;
+  }
+  for (auto count : pushed) {
+    BOOST_CHECK_EQUAL(count, 10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Throughput)
+{
+  // Link 0 is ten times as fast as the others. A fixed amount of superpages circulates, as it would with a buffer of
+  // limited size.
+  constexpr size_t SUPERPAGES = 130;
+  LinkScheduler scheduler(LinkScheduling::Throughput, LINKS, LINK_CAPACITY);
+  std::vector<std::deque<int>> queues(LINKS);
+
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto index = scheduler.getNextLinkIndex();
+    scheduler.pushed(index);
+    queues.at(index).push_back(0);
+  }
+
+  for (int tick = 0; tick < 20000; ++tick) {
+    for (size_t link = 0; link < LINKS; ++link) {
+      bool arrives = (link == 0) || ((tick % 10) == 0);
+      if (arrives && !queues[link].empty()) {
+        queues[link].pop_front();
+        scheduler.arrived(link);
+        auto index = scheduler.getNextLinkIndex();
+        scheduler.pushed(index);
+        queues.at(index).push_back(0);
+      }
+    }
+  }
+
+  // The fast link should hold most of the superpages, but the slow ones must not be starved
+  BOOST_CHECK_GT(queues[0].size(), SUPERPAGES / 2);
+  for (size_t link = 1; link < LINKS; ++link) {
+    BOOST_CHECK_GE(queues[link].size(), 1);
+    BOOST_CHECK_LT(queues[link].size(), queues[0].size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(EnableAndDisable)
+{
+  for (auto policy : {LinkScheduling::ShortestQueue, LinkScheduling::Throughput}) {
+    LinkScheduler scheduler(policy, LINKS, LINK_CAPACITY);
+    scheduler.setEnabled(1, false);
+    auto added = scheduler.addLink();
+    BOOST_CHECK_EQUAL(added, LINKS);
+
+    // The enabled links fill up, and the disabled one gets nothing
+    std::vector<size_t> pushed(LINKS + 1, 0);
+    for (size_t i = 0; i < LINKS * LINK_CAPACITY; ++i) {
+      auto index = scheduler.getNextLinkIndex();
+      scheduler.pushed(index);
+      pushed.at(index)++;
+    }
+    for (size_t index = 0; index < pushed.size(); ++index) {
+      BOOST_CHECK_EQUAL(pushed[index], index == 1 ? 0 : LINK_CAPACITY);
+    }
+
+    // A disabled link stays disabled through a reset
+    scheduler.reset();
+    for (size_t i = 0; i < LINKS * 10; ++i) {
+      BOOST_CHECK_NE(scheduler.getNextLinkIndex(), 1);
+    }
+    scheduler.setEnabled(1, true);
+    BOOST_CHECK_EQUAL(scheduler.getNextLinkIndex(), 0);
+    scheduler.pushed(0);
+    BOOST_CHECK_EQUAL(scheduler.getNextLinkIndex(), 1);
+  }
+}
+
+} // Anonymous namespace
@@ -0,0 +1,91 @@
+/// \file TestCruReadyQueue.cxx
+/// \brief Tests for the ready queue helpers of the CRU DMA channel
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCruReadyQueue
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/circular_buffer.hpp>
+#include <boost/test/unit_test.hpp>
+#include "Cru/ReadyQueue.h"
+
+using namespace AliceO2::roc;
+using namespace AliceO2::roc::Cru;
+
+namespace {
+
+constexpr size_t SUPERPAGE_SIZE = 32 * 1024;
+constexpr size_t DMA_PAGE_SIZE = 8 * 1024;
+
+/// A superpage as the driver gives it to the card
+Superpage pushed(size_t index)
+{
+  Superpage superpage(index * SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+  superpage.setChecked(true);
+  return superpage;
+}
+
+/// The superpage as the driver finds it arrived
+Superpage arrived(Superpage superpage)
+{
+  superpage.setReceived(superpage.getSize());
+  superpage.setReady(true);
+  return superpage;
+}
+
+BOOST_AUTO_TEST_CASE(SplitReceived)
+{
+  auto front = pushed(1);
+  auto split = splitReceived(front, DMA_PAGE_SIZE);
+
+  BOOST_CHECK_EQUAL(split.getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(split.getSize(), DMA_PAGE_SIZE);
+  BOOST_CHECK_EQUAL(split.getReceived(), DMA_PAGE_SIZE);
+  BOOST_CHECK(split.isReady());
+  BOOST_CHECK(split.isSplit());
+  BOOST_CHECK(!split.isChecked());
+
+  BOOST_CHECK_EQUAL(front.getOffset(), SUPERPAGE_SIZE + DMA_PAGE_SIZE);
+  BOOST_CHECK_EQUAL(front.getSize(), SUPERPAGE_SIZE - DMA_PAGE_SIZE);
+  BOOST_CHECK(!front.isChecked());
+}
+
+BOOST_AUTO_TEST_CASE(DropOldestSkipsFlushedPieces)
+{
+  boost::circular_buffer<Superpage> readyQueue(4);
+
+  // A flushed superpage: its received part is handed over first, the rest arrives later
+  auto front = pushed(0);
+  readyQueue.push_back(splitReceived(front, DMA_PAGE_SIZE));
+  readyQueue.push_back(arrived(front));
+  readyQueue.push_back(arrived(pushed(1)));
+  readyQueue.push_back(arrived(pushed(2)));
+  BOOST_REQUIRE(readyQueue.full());
+
+  // The oldest whole superpage is dropped, the pieces stay in order for the user
+  auto oldest = findRecyclable(readyQueue);
+  BOOST_REQUIRE(oldest != readyQueue.end());
+  BOOST_CHECK_EQUAL(oldest->getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK(oldest->isChecked());
+  readyQueue.erase(oldest);
+
+  BOOST_REQUIRE_EQUAL(readyQueue.size(), 3);
+  BOOST_CHECK_EQUAL(readyQueue[0].getOffset(), 0);
+  BOOST_CHECK_EQUAL(readyQueue[1].getOffset(), DMA_PAGE_SIZE);
+  BOOST_CHECK_EQUAL(readyQueue[2].getOffset(), 2 * SUPERPAGE_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(DropOldestWithOnlyFlushedPieces)
+{
+  boost::circular_buffer<Superpage> readyQueue(2);
+  auto front = pushed(0);
+  readyQueue.push_back(splitReceived(front, DMA_PAGE_SIZE));
+  readyQueue.push_back(arrived(front));
+
+  // Nothing can go back to the card, so the arriving superpage has to stay on it
+  BOOST_CHECK(findRecyclable(readyQueue) == readyQueue.end());
+  BOOST_CHECK_EQUAL(readyQueue.size(), 2);
+}
+
+} // Anonymous namespace
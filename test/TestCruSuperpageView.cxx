@@ -0,0 +1,151 @@
+/// \file TestCruSuperpageView.cxx
+/// \brief Tests for the CRU SuperpageView and PacketCounterChecker
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestCruSuperpageView
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "Cru/SuperpageView.h"
+
+using namespace AliceO2::roc;
+using namespace AliceO2::roc::Cru;
+
+namespace {
+
+constexpr size_t PAGE_SIZE = SuperpageView::DMA_PAGE_SIZE;
+
+/// Writes the RDH words the view decodes
+void setRdh(std::vector<uint32_t>& buffer, size_t page, uint32_t memorySize, uint32_t linkId, uint32_t packetCounter)
+{
+  auto rdh = &buffer[page * PAGE_SIZE / sizeof(uint32_t)];
+  rdh[2] = (memorySize << 16) | PAGE_SIZE;
+  rdh[3] = (0x5 << 28) | (0x123 << 16) | ((packetCounter & 0xff) << 8) | linkId;
+}
+
+BOOST_AUTO_TEST_CASE(DecodeRdh)
+{
+  std::vector<uint32_t> buffer(PAGE_SIZE / sizeof(uint32_t));
+  setRdh(buffer, 0, 0x100, 18, 0xab);
+  auto rdh = decodeRdh(reinterpret_cast<const char*>(buffer.data()));
+  BOOST_CHECK_EQUAL(rdh.offsetNextPacket, PAGE_SIZE);
+  BOOST_CHECK_EQUAL(rdh.memorySize, 0x100);
+  BOOST_CHECK_EQUAL(rdh.linkId, 18);
+  BOOST_CHECK_EQUAL(rdh.packetCounter, 0xab);
+  BOOST_CHECK_EQUAL(rdh.cruId, 0x123);
+  BOOST_CHECK_EQUAL(rdh.dataWrapperId, 0x5);
+}
+
+BOOST_AUTO_TEST_CASE(Walk)
+{
+  constexpr size_t pages = 4;
+  std::vector<uint32_t> buffer(pages * PAGE_SIZE / sizeof(uint32_t));
+  for (size_t i = 0; i < pages; ++i) {
+    setRdh(buffer, i, 0x40 + i * 0x100, 3, i);
+  }
+  setRdh(buffer, 3, PAGE_SIZE + 1, 3, 3);
+
+  // The incomplete last page is not walked
+  SuperpageView view(buffer.data(), pages * PAGE_SIZE - 1);
+  BOOST_CHECK_EQUAL(view.size(), pages - 1);
+
+  size_t i = 0;
+  for (const auto& packet : view) {
+    BOOST_CHECK(packet.valid);
+    BOOST_CHECK_EQUAL(packet.rdh.packetCounter, i);
+    BOOST_CHECK(packet.page == reinterpret_cast<const char*>(buffer.data()) + i * PAGE_SIZE);
+    BOOST_CHECK(packet.payload == packet.page + 0x40);
+    BOOST_CHECK_EQUAL(packet.payloadSize, i * 0x100);
+    ++i;
+  }
+  BOOST_CHECK_EQUAL(i, pages - 1);
+
+  // The last page's memory size is larger than the page
+  SuperpageView full(buffer.data(), pages * PAGE_SIZE);
+  auto last = full.begin();
+  std::advance(last, pages - 1);
+  BOOST_CHECK(!last->valid);
+  BOOST_CHECK_EQUAL(last->payloadSize, 0);
+  BOOST_CHECK(++last == full.end());
+}
+
+BOOST_AUTO_TEST_CASE(WalkPacked)
+{
+  constexpr size_t pages = 2;
+  std::vector<uint32_t> buffer(pages * PAGE_SIZE / sizeof(uint32_t));
+  auto setPacket = [&](size_t offset, uint32_t memorySize, uint32_t offsetNext, uint32_t packetCounter) {
+    auto rdh = &buffer[offset / sizeof(uint32_t)];
+    rdh[2] = (memorySize << 16) | offsetNext;
+    rdh[3] = (packetCounter << 8) | 4;
+  };
+  // Small packets, and one crossing into the second page, which the last packet fills up
+  setPacket(0, 0x60, 0x60, 0);
+  setPacket(0x60, 0x1000, 0x1000, 1);
+  setPacket(0x1060, 0x1800, 0x1800, 2);
+  setPacket(0x2860, 0x100, 2 * PAGE_SIZE - 0x2860, 3);
+
+  size_t i = 0;
+  for (const auto& packet : SuperpageView(buffer.data(), pages * PAGE_SIZE, PAGE_SIZE, 1, true, true)) {
+    BOOST_CHECK(packet.valid);
+    BOOST_CHECK_EQUAL(packet.rdh.packetCounter, i);
+    BOOST_CHECK_EQUAL(packet.payloadSize, packet.rdh.memorySize - 0x40);
+    ++i;
+  }
+  BOOST_CHECK_EQUAL(i, 4);
+
+  // An offset past the superpage ends the walk after the packet, which is invalid
+  setPacket(0x1060, 0x1800, 2 * PAGE_SIZE, 2);
+  std::vector<bool> valid;
+  for (const auto& packet : SuperpageView(buffer.data(), pages * PAGE_SIZE, PAGE_SIZE, 0, true, true)) {
+    valid.push_back(packet.valid);
+  }
+  BOOST_CHECK(valid == std::vector<bool>({true, true, false}));
+}
+
+BOOST_AUTO_TEST_CASE(WalkWithPrefetch)
+{
+  // Prefetching does not change what is walked, also with a distance past the end
+  constexpr size_t pages = 5;
+  std::vector<uint32_t> buffer(pages * PAGE_SIZE / sizeof(uint32_t));
+  for (size_t i = 0; i < pages; ++i) {
+    setRdh(buffer, i, 0x40, 7, i);
+  }
+  for (size_t distance : {1, 2, 8}) {
+    for (bool payload : {true, false}) {
+      size_t i = 0;
+      for (const auto& packet : SuperpageView(buffer.data(), pages * PAGE_SIZE, PAGE_SIZE, distance, payload)) {
+        BOOST_CHECK_EQUAL(packet.rdh.packetCounter, i);
+        ++i;
+      }
+      BOOST_CHECK_EQUAL(i, pages);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PacketCounterContinuity)
+{
+  constexpr size_t pages = 6;
+  std::vector<uint32_t> buffer(pages * PAGE_SIZE / sizeof(uint32_t));
+  // Two interleaved links, each continuous, with the counter wrapping around
+  setRdh(buffer, 0, 0x40, 1, 0xfe);
+  setRdh(buffer, 1, 0x40, 2, 0x10);
+  setRdh(buffer, 2, 0x40, 1, 0xff);
+  setRdh(buffer, 3, 0x40, 2, 0x11);
+  setRdh(buffer, 4, 0x40, 1, 0x00);
+  setRdh(buffer, 5, 0x40, 2, 0x12);
+
+  PacketCounterChecker checker;
+  SuperpageView view(buffer.data(), buffer.size() * sizeof(uint32_t));
+  BOOST_CHECK_EQUAL(checker.check(view), 0);
+
+  // The sequence continues across superpages, so a repeat of the same superpage is a discontinuity on both links
+  BOOST_CHECK_EQUAL(checker.check(view), 2);
+
+  checker.reset();
+  setRdh(buffer, 3, 0x40, 2, 0x20);
+  BOOST_CHECK_EQUAL(checker.check(view), 2);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,79 @@
+/// \file TestDataPattern.cxx
+/// \brief Test of the DataPattern class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestDataPattern
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/DataPattern.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+/// Fills a buffer with the pattern
+std::vector<uint32_t> generate(const DataPattern& pattern, size_t size)
+{
+  std::vector<uint32_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = pattern.getExpected(i);
+  }
+  return data;
+}
+
+BOOST_AUTO_TEST_CASE(Expected)
+{
+  auto incremental = DataPattern::makeIncremental(-1);
+  BOOST_CHECK_EQUAL(incremental.getExpected(0), 0xffffffff);
+  BOOST_CHECK_EQUAL(incremental.getExpected(8), 7);
+
+  auto constant = DataPattern::makeConstant(0xa5a5a5a5);
+  BOOST_CHECK_EQUAL(constant.getExpected(0), 0xa5a5a5a5);
+  BOOST_CHECK_EQUAL(constant.getExpected(1000), 0xa5a5a5a5);
+
+  auto internal = DataPattern::makeCruInternal(0xfffffffe);
+  BOOST_CHECK_EQUAL(internal.getExpected(7), 0xfffffffe);
+  BOOST_CHECK_EQUAL(internal.getExpected(8), 0xffffffff);
+  BOOST_CHECK_EQUAL(internal.getExpected(16), 0);
+
+  auto ddg = DataPattern::makeCruDdg(0x12345);
+  BOOST_CHECK_EQUAL(ddg.getExpected(0), 0x12345);
+  BOOST_CHECK_EQUAL(ddg.getExpected(1), 0x12345);
+  BOOST_CHECK_EQUAL(ddg.getExpected(2), 0x2345);
+  BOOST_CHECK_EQUAL(ddg.getExpected(3), 0);
+  BOOST_CHECK_EQUAL(ddg.getExpected(4), 0x12346);
+}
+
+BOOST_AUTO_TEST_CASE(FindMismatch)
+{
+  BOOST_TEST_MESSAGE("Implementation: " << DataPattern::getImplementation());
+
+  const std::vector<DataPattern> patterns {
+    DataPattern::makeIncremental(-1),
+    DataPattern::makeConstant(0x12345678),
+    DataPattern::makeCruInternal(0xfffffff0),
+    DataPattern::makeCruDdg(0xfffe),
+  };
+  constexpr size_t size = 2048 + 5;
+
+  for (const auto& pattern : patterns) {
+    auto data = generate(pattern, size);
+    // Different alignments of the range, so the scalar prologue and tail are covered as well as the vector loop
+    for (size_t begin : {0, 1, 8, 15, 16, 17}) {
+      BOOST_CHECK_EQUAL(pattern.findMismatch(data.data(), begin, size), size);
+      for (size_t index : {begin, begin + 3, size_t(100), size_t(1023), size - 1}) {
+        auto corrupted = data;
+        corrupted[index] ^= 0x100;
+        BOOST_CHECK_EQUAL(pattern.findMismatch(corrupted.data(), begin, size), index);
+        // A mismatch outside of the range is not reported
+        BOOST_CHECK_EQUAL(pattern.findMismatch(corrupted.data(), index + 1, size), size);
+      }
+    }
+    BOOST_CHECK_EQUAL(pattern.findMismatch(data.data(), 10, 10), 10);
+  }
+}
+
+} // Anonymous namespace
@@ -0,0 +1,316 @@
+/// \file TestDriverThreadDmaChannel.cxx
+/// \brief Test of the DriverThreadDmaChannel class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestDriverThreadDmaChannel
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include "DriverThreadDmaChannel.h"
+#include "ExceptionInternal.h"
+#include "FakeDmaChannel.h"
+#include "ReadoutCard/SuperpageHandles.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t TRANSFER_QUEUE_SIZE = FakeDmaChannel::TRANSFER_QUEUE_SIZE;
+constexpr size_t SUPERPAGE_SIZE = 1024 * 1024;
+
+Parameters makeParameters()
+{
+  return Parameters().setDriverThreadEnabled(true).setDriverThreadCpu(0);
+}
+
+/// Waits for the ready queue to reach the given size
+bool waitForReady(DmaChannelInterface& channel, int size)
+{
+  auto start = std::chrono::steady_clock::now();
+  while (channel.getReadyQueueSize() < size) {
+    if ((std::chrono::steady_clock::now() - start) > std::chrono::seconds(5)) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(PushAndPop)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  channel.startDma();
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE);
+
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+  BOOST_CHECK_THROW(channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE)), Exception);
+
+  BOOST_REQUIRE(waitForReady(channel, TRANSFER_QUEUE_SIZE));
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE);
+
+  std::vector<Superpage> superpages(TRANSFER_QUEUE_SIZE);
+  BOOST_REQUIRE_EQUAL(channel.popSuperpages(superpages.data(), superpages.size()), TRANSFER_QUEUE_SIZE);
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    BOOST_CHECK(superpages[i].isReady());
+    BOOST_CHECK_EQUAL(superpages[i].getOffset(), i * SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK_EQUAL(channel.getReadyQueueSize(), 0);
+  BOOST_CHECK_THROW(channel.popSuperpage(), Exception);
+
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(Recover)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  channel.startDma();
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+  channel.recover();
+
+  // Every superpage comes back once, and the channel is driven again afterwards
+  BOOST_REQUIRE(waitForReady(channel, TRANSFER_QUEUE_SIZE));
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE);
+  std::vector<Superpage> superpages(TRANSFER_QUEUE_SIZE);
+  BOOST_REQUIRE_EQUAL(channel.popSuperpages(superpages.data(), superpages.size()), TRANSFER_QUEUE_SIZE);
+  channel.pushSuperpages(superpages.data(), superpages.size());
+  BOOST_REQUIRE(waitForReady(channel, TRANSFER_QUEUE_SIZE));
+  BOOST_CHECK_EQUAL(channel.getReadyQueueSize(), TRANSFER_QUEUE_SIZE);
+
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(EnableAndDisableLink)
+{
+  constexpr size_t LINK_QUEUE_SIZE = FakeDmaChannel::LINK_QUEUE_SIZE;
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  channel.startDma();
+
+  // The superpages on the disabled link come back, and the transfer queue shrinks by a link
+  for (size_t i = 0; i < 2; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+  channel.disableLink(1);
+  BOOST_REQUIRE(waitForReady(channel, 2));
+  std::vector<Superpage> superpages(2);
+  BOOST_REQUIRE_EQUAL(channel.popSuperpages(superpages.data(), superpages.size()), 2);
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE - LINK_QUEUE_SIZE);
+
+  // After enabling it again, the whole transfer queue can be pushed
+  channel.enableLink(1);
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE);
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+  BOOST_REQUIRE(waitForReady(channel, TRANSFER_QUEUE_SIZE));
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(WaitForReady)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  channel.startDma();
+
+  // Nothing was pushed, so this must time out
+  BOOST_CHECK(!channel.waitForReadySuperpage(std::chrono::milliseconds(10)));
+
+  channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE));
+  BOOST_CHECK(channel.waitForReadySuperpage(std::chrono::seconds(5)));
+  BOOST_CHECK(channel.popSuperpage().isReady());
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(PushBatch)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  channel.startDma();
+
+  std::vector<Superpage> superpages;
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE + 1; ++i) {
+    superpages.emplace_back(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK_THROW(channel.pushSuperpages(superpages.data(), superpages.size()), Exception);
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE);
+
+  channel.pushSuperpages(superpages.data(), TRANSFER_QUEUE_SIZE);
+  BOOST_REQUIRE(waitForReady(channel, TRANSFER_QUEUE_SIZE));
+  channel.stopDma();
+  BOOST_CHECK_EQUAL(channel.getReadyQueueSize(), TRANSFER_QUEUE_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSuperpage)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  channel.startDma();
+
+  // Invalid superpages throw on the caller's thread, and the driver thread keeps going
+  BOOST_CHECK_THROW(channel.pushSuperpage(Superpage(0, 0)), Exception);
+  BOOST_CHECK_THROW(channel.tryPushSuperpageToLink(Superpage(0, 0), 0), Exception);
+
+  // A batch with an invalid superpage queues none of it
+  std::vector<Superpage> superpages;
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    superpages.emplace_back(i * SUPERPAGE_SIZE, i == 1 ? 0 : SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK_THROW(channel.pushSuperpages(superpages.data(), superpages.size()), Exception);
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE);
+
+  superpages[1].setSize(SUPERPAGE_SIZE);
+  channel.pushSuperpages(superpages.data(), superpages.size());
+  BOOST_REQUIRE(waitForReady(channel, TRANSFER_QUEUE_SIZE));
+  BOOST_CHECK_EQUAL(channel.popSuperpage().getOffset(), 0);
+
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(PartialSuperpages)
+{
+  auto fake = std::make_shared<FakeDmaChannel>();
+  DriverThreadDmaChannel channel(fake, makeParameters());
+  std::vector<Superpage> superpages(TRANSFER_QUEUE_SIZE);
+
+  // While DMA is stopped, the calls go to the wrapped channel
+  fake->setPartialReceived(SUPERPAGE_SIZE / 4);
+  channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE));
+  BOOST_REQUIRE_EQUAL(channel.getPartialSuperpages(superpages.data(), superpages.size()), 1);
+  BOOST_CHECK_EQUAL(superpages[0].getReceived(), SUPERPAGE_SIZE / 4);
+  BOOST_CHECK(!superpages[0].isReady());
+  BOOST_CHECK_EQUAL(channel.getPartialSuperpages(superpages.data(), 0), 0);
+
+  // While it runs, the wrapped channel belongs to the driver thread
+  channel.startDma();
+  channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE));
+  BOOST_CHECK_EQUAL(channel.getPartialSuperpages(superpages.data(), superpages.size()), 0);
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(FlushedSuperpages)
+{
+  auto fake = std::make_shared<FakeDmaChannel>();
+  fake->setFlushSize(SUPERPAGE_SIZE / 4);
+  DriverThreadDmaChannel channel(fake, makeParameters());
+  channel.startDma();
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+
+  // Every superpage arrives in two pieces, and only the second frees its slot
+  BOOST_REQUIRE(waitForReady(channel, 2 * TRANSFER_QUEUE_SIZE));
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), TRANSFER_QUEUE_SIZE);
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    BOOST_CHECK(channel.popSuperpage().isSplit());
+    BOOST_CHECK(!channel.popSuperpage().isSplit());
+  }
+
+  // So pushing what it reports as free works
+  for (int i = channel.getTransferQueueAvailable(); i > 0; --i) {
+    channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE));
+  }
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(TryPushAndPop)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  Superpage superpage;
+  BOOST_CHECK(!channel.tryPopSuperpage(superpage));
+
+  channel.startDma();
+  BOOST_CHECK(!channel.tryPopSuperpage(superpage));
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    BOOST_CHECK(channel.tryPushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE)));
+  }
+  BOOST_CHECK(!channel.tryPushSuperpage(Superpage(0, SUPERPAGE_SIZE)));
+
+  BOOST_REQUIRE(waitForReady(channel, TRANSFER_QUEUE_SIZE));
+  for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; ++i) {
+    BOOST_REQUIRE(channel.tryPopSuperpage(superpage));
+    BOOST_CHECK(superpage.isReady());
+    BOOST_CHECK_EQUAL(superpage.getOffset(), i * SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK(!channel.tryPopSuperpage(superpage));
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(AddBuffer)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), makeParameters());
+  const int bufferId = channel.addBuffer(buffer_parameters::Memory{nullptr, SUPERPAGE_SIZE});
+  BOOST_CHECK_EQUAL(bufferId, 1);
+
+  channel.startDma();
+  Superpage pushed(0, SUPERPAGE_SIZE);
+  pushed.setBufferId(bufferId);
+  channel.pushSuperpage(pushed);
+  BOOST_REQUIRE(waitForReady(channel, 1));
+  BOOST_CHECK_EQUAL(channel.popSuperpage().getBufferId(), bufferId);
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(ReleaseSuperpage)
+{
+  auto fake = std::make_shared<FakeDmaChannel>();
+  DriverThreadDmaChannel channel(fake, makeParameters());
+  channel.startDma();
+
+  channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE));
+  BOOST_REQUIRE(waitForReady(channel, 1));
+  auto superpage = channel.popSuperpage();
+  BOOST_CHECK(superpage.isChecked());
+
+  // Recycled as it is, the channel may skip its checks
+  channel.releaseSuperpage(superpage);
+  BOOST_REQUIRE(waitForReady(channel, 1));
+  superpage = channel.popSuperpage();
+  BOOST_CHECK(superpage.isReady());
+  BOOST_CHECK_EQUAL(fake->getReleasedCount(), 1);
+
+  // Changing it makes it go through the checks again
+  superpage.setOffset(SUPERPAGE_SIZE);
+  BOOST_CHECK(!superpage.isChecked());
+  channel.releaseSuperpage(superpage);
+  BOOST_REQUIRE(waitForReady(channel, 1));
+  BOOST_CHECK_EQUAL(channel.popSuperpage().getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(fake->getReleasedCount(), 1);
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(SplitHandles)
+{
+  auto channel = std::make_shared<DriverThreadDmaChannel>(std::make_shared<FakeDmaChannel>(), makeParameters());
+  SuperpageProducer producer(channel);
+  SuperpageConsumer consumer(channel);
+  channel->startDma();
+
+  // One thread refills, this one consumes
+  constexpr size_t COUNT = 10000;
+  std::thread refill([&]{
+    size_t pushed = 0;
+    while (pushed < COUNT) {
+      if (producer.tryPush(Superpage((pushed % TRANSFER_QUEUE_SIZE) * SUPERPAGE_SIZE, SUPERPAGE_SIZE))) {
+        pushed++;
+      }
+    }
+  });
+
+  size_t popped = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (popped < COUNT && (std::chrono::steady_clock::now() - start) < std::chrono::seconds(10)) {
+    Superpage superpage;
+    if (consumer.waitForReady(std::chrono::milliseconds(1)) && consumer.tryPop(superpage)) {
+      BOOST_REQUIRE_EQUAL(superpage.getOffset(), (popped % TRANSFER_QUEUE_SIZE) * SUPERPAGE_SIZE);
+      popped++;
+    }
+  }
+  refill.join();
+  BOOST_CHECK_EQUAL(popped, COUNT);
+  channel->stopDma();
+}
+
+} // Anonymous namespace
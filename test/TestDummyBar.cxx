@@ -0,0 +1,95 @@
+/// \file TestDummyBar.cxx
+/// \brief Test of the DummyBar class and its register model
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestDummyBar
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <map>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/AliceLowlevelFrontend/Sca.h"
+#include "Dummy/DummyBar.h"
+#include "Swt/Swt.h"
+
+using namespace ::AliceO2::roc;
+using Sca = ::AliceO2::roc::CommandLineUtilities::Alf::Sca;
+
+namespace {
+
+Parameters makeParameters()
+{
+  return Parameters::makeParameters(Parameters::CardIdType(-1), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Registers)
+{
+  DummyBar bar(makeParameters());
+  bar.writeRegister(0x400, 42);
+  BOOST_CHECK_EQUAL(bar.readRegister(0x400), 42);
+
+  std::vector<uint32_t> values {1, 2, 3};
+  bar.writeRegisters(0x500, values.data(), values.size());
+  std::vector<uint32_t> read(3);
+  bar.readRegisters(0x500, read.data(), read.size());
+  BOOST_CHECK(read == values);
+}
+
+BOOST_AUTO_TEST_CASE(ScaSequence)
+{
+  DummyBar bar(makeParameters());
+  Sca sca(bar, bar.getCardType(), 0);
+  std::vector<Sca::CommandData> commands {{0x00010002, 0xff000000}, {0x02030020, 0x12345678}};
+  auto result = sca.executeSequence(commands);
+  BOOST_CHECK(!result.error);
+  BOOST_REQUIRE_EQUAL(result.results.size(), 2);
+  for (size_t i = 0; i < commands.size(); ++i) {
+    BOOST_CHECK_EQUAL(result.results[i].command, commands[i].command & ~uint32_t(0xff));
+    BOOST_CHECK_EQUAL(result.results[i].data, commands[i].data);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SwtChannels)
+{
+  DummyBar bar(makeParameters());
+  std::map<int, Swt::Sequence> sequences;
+  sequences[0].writes = {SwtWord(1, 2, 3), SwtWord(4, 5, 6)};
+  sequences[0].readCount = 2;
+  sequences[3].writes = {SwtWord(7, 8, 9)};
+  sequences[3].readCount = 1;
+  auto results = Swt::executeSequences(bar, sequences);
+  for (auto& sequence : sequences) {
+    auto& result = results.at(sequence.first);
+    BOOST_CHECK(!result.error);
+    BOOST_CHECK_EQUAL(result.monitor, 0);
+    BOOST_REQUIRE_EQUAL(result.reads.size(), sequence.second.writes.size());
+    for (size_t i = 0; i < result.reads.size(); ++i) {
+      BOOST_CHECK(result.reads[i] == sequence.second.writes[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Latency)
+{
+  auto parameters = makeParameters();
+  parameters.setDummyBarReadLatency(std::chrono::microseconds(20));
+  DummyBar bar(parameters);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 10; ++i) {
+    bar.readRegister(0);
+  }
+  BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::microseconds(200));
+
+  // A block read takes the latency once
+  std::vector<uint32_t> values(100);
+  start = std::chrono::steady_clock::now();
+  bar.readRegisters(0, values.data(), values.size());
+  auto blockTime = std::chrono::steady_clock::now() - start;
+  BOOST_CHECK(blockTime >= std::chrono::microseconds(20));
+  BOOST_CHECK(blockTime < std::chrono::microseconds(20 * 100));
+}
+
+} // Anonymous namespace
@@ -0,0 +1,369 @@
+/// \file TestDummyDmaChannel.cxx
+/// \brief Test of the DummyDmaChannel class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestDummyDmaChannel
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "Cru/DataFormat.h"
+#include "Cru/SuperpageView.h"
+#include "ReadoutCard/LinkIntegrityMonitor.h"
+#include "Dummy/DummyDmaChannel.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/DataPattern.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+const std::string replayPath("/tmp/AliceO2_TestDummyDmaChannel_Replay");
+constexpr size_t SUPERPAGE_SIZE = 32 * 1024;
+constexpr size_t SUPERPAGES = 4;
+
+Parameters makeParameters(std::vector<char>& buffer)
+{
+  return Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0)
+      .setBufferParameters(buffer_parameters::Memory{buffer.data(), buffer.size()});
+}
+
+/// Pushes the superpages of the buffer and waits until they arrive, or the timeout passes
+size_t pushAndFill(DummyDmaChannel& channel, std::chrono::milliseconds timeout)
+{
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (channel.getReadyQueueSize() < int(SUPERPAGES) && (std::chrono::steady_clock::now() - start) < timeout) {
+    channel.fillSuperpages();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return channel.getReadyQueueSize();
+}
+
+BOOST_AUTO_TEST_CASE(Replay)
+{
+  // A file of one and a half superpages, so the replay has to start over halfway through a superpage
+  std::vector<char> file(SUPERPAGE_SIZE + SUPERPAGE_SIZE / 2);
+  for (size_t i = 0; i < file.size(); ++i) {
+    file[i] = char(i * 7);
+  }
+  std::ofstream(replayPath, std::ios::binary).write(file.data(), file.size());
+
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeParameters(buffer).setReplayFile(replayPath));
+  channel.startDma();
+  BOOST_REQUIRE_EQUAL(pushAndFill(channel, std::chrono::seconds(1)), SUPERPAGES);
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    if (buffer[i] != file[i % file.size()]) {
+      BOOST_FAIL("Replayed data mismatch at byte " << i);
+    }
+  }
+  channel.stopDma();
+  boost::filesystem::remove(replayPath);
+
+  BOOST_CHECK_THROW(DummyDmaChannel(makeParameters(buffer).setReplayFile(replayPath)), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(ReplayRate)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  // One superpage per 50 ms
+  DummyDmaChannel channel(makeParameters(buffer).setReplayRate(SUPERPAGE_SIZE * 20));
+  channel.startDma();
+  auto start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE_EQUAL(pushAndFill(channel, std::chrono::seconds(2)), SUPERPAGES);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(SUPERPAGES * 50 - 10));
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(PushSuperpagesInvalid)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeParameters(buffer));
+  auto available = channel.getTransferQueueAvailable();
+  // The last superpage is out of range, so none of the batch may be pushed
+  std::vector<Superpage> superpages;
+  for (size_t i = 0; i <= SUPERPAGES; ++i) {
+    superpages.emplace_back(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK_THROW(channel.pushSuperpages(superpages.data(), superpages.size()), Exception);
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), available);
+  channel.pushSuperpages(superpages.data(), SUPERPAGES);
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), available - int(SUPERPAGES));
+}
+
+BOOST_AUTO_TEST_CASE(Simulation)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  // Two links of one superpage per 50 ms each
+  DummyDmaChannel channel(makeParameters(buffer)
+      .setLinkMask(Parameters::LinkMaskType{3, 5})
+      .setDummyLinkBandwidth(SUPERPAGE_SIZE * 20));
+  BOOST_CHECK_EQUAL(channel.getTransferQueueAvailable(), 2 * 128);
+  channel.startDma();
+  auto start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE_EQUAL(pushAndFill(channel, std::chrono::seconds(2)), SUPERPAGES);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds((SUPERPAGES / 2) * 50 - 10));
+  channel.stopDma();
+
+  Cru::PacketCounterChecker checker;
+  size_t dataCounter[2] = {0, 0};
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto superpage = channel.popSuperpage();
+    BOOST_REQUIRE_EQUAL(superpage.getReceived(), SUPERPAGE_SIZE);
+    BOOST_REQUIRE(superpage.getLinkId() == 3 || superpage.getLinkId() == 5);
+    BOOST_CHECK_NE(superpage.getPushTimestamp(), 0);
+    BOOST_CHECK_GE(superpage.getTimestamp(), superpage.getPushTimestamp());
+    auto& counter = dataCounter[superpage.getLinkId() == 3 ? 0 : 1];
+    Cru::SuperpageView view(buffer.data() + superpage.getOffset(), superpage.getReceived());
+    BOOST_CHECK_EQUAL(checker.check(view), 0);
+    for (const auto& packet : view) {
+      BOOST_REQUIRE(packet.valid);
+      BOOST_CHECK_EQUAL(packet.rdh.linkId, superpage.getLinkId());
+      auto words = packet.payloadSize / sizeof(uint32_t);
+      BOOST_CHECK_EQUAL(DataPattern::makeCruDdg(counter).findMismatch(packet.payload, 0, words), words);
+      counter += words / 4;
+    }
+  }
+
+  BOOST_CHECK_THROW(DummyDmaChannel(makeParameters(buffer).setDummyLinkBandwidth(0)), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(SimulationReplay)
+{
+  // A recording of links 3, 5 and 7 with packed packets, three of each link, the payload telling them apart
+  constexpr size_t PACKET_SIZE = 256;
+  std::vector<uint32_t> file;
+  for (uint32_t i = 0; i < 3; ++i) {
+    for (uint32_t link : {3, 5, 7}) {
+      std::vector<uint32_t> packet(PACKET_SIZE / sizeof(uint32_t), link * 1000 + i);
+      std::fill_n(packet.begin(), Cru::DataFormat::getHeaderSize() / sizeof(uint32_t), 0);
+      packet[2] = (PACKET_SIZE << 16) | PACKET_SIZE;
+      packet[3] = link;
+      file.insert(file.end(), packet.begin(), packet.end());
+    }
+  }
+  std::ofstream(replayPath, std::ios::binary).write(reinterpret_cast<const char*>(file.data()),
+      file.size() * sizeof(uint32_t));
+
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  {
+    DummyDmaChannel channel(makeParameters(buffer)
+        .setLinkMask(Parameters::LinkMaskType{3, 5})
+        .setDummyLinkBandwidth(SUPERPAGE_SIZE * 20)
+        .setReplayFile(replayPath));
+    BOOST_CHECK_EQUAL(channel.getCardType(), CardType::Simulated);
+    channel.startDma();
+    BOOST_REQUIRE_EQUAL(pushAndFill(channel, std::chrono::seconds(2)), SUPERPAGES);
+    channel.stopDma();
+
+    // Every link replays its own packets, one per DMA page, continuing where its previous superpage stopped
+    size_t next[2] = {0, 0};
+    for (size_t i = 0; i < SUPERPAGES; ++i) {
+      auto superpage = channel.popSuperpage();
+      BOOST_REQUIRE_EQUAL(superpage.getReceived(), SUPERPAGE_SIZE);
+      auto& packetIndex = next[superpage.getLinkId() == 3 ? 0 : 1];
+      for (const auto& packet : Cru::SuperpageView(buffer.data() + superpage.getOffset(), superpage.getReceived())) {
+        BOOST_REQUIRE(packet.valid);
+        BOOST_CHECK_EQUAL(packet.rdh.linkId, superpage.getLinkId());
+        BOOST_CHECK_EQUAL(packet.rdh.memorySize, PACKET_SIZE);
+        BOOST_CHECK_EQUAL(packet.rdh.offsetNextPacket, channel.getDmaPageSize());
+        BOOST_CHECK_EQUAL(reinterpret_cast<const uint32_t*>(packet.payload)[0],
+            superpage.getLinkId() * 1000 + packetIndex % 3);
+        packetIndex++;
+      }
+    }
+  }
+
+  // A link the recording has no packets of can't be simulated
+  BOOST_CHECK_THROW(DummyDmaChannel(makeParameters(buffer)
+      .setLinkMask(Parameters::LinkMaskType{4})
+      .setDummyLinkBandwidth(SUPERPAGE_SIZE * 20)
+      .setReplayFile(replayPath)), ParameterException);
+  boost::filesystem::remove(replayPath);
+}
+
+BOOST_AUTO_TEST_CASE(SimulationPartialSuperpages)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  // One superpage per second
+  DummyDmaChannel channel(makeParameters(buffer)
+      .setLinkMask(Parameters::LinkMaskType{0})
+      .setDummyLinkBandwidth(SUPERPAGE_SIZE));
+  channel.startDma();
+  channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE));
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+
+  // The pages received so far are written and can be read
+  std::vector<Superpage> superpages(2);
+  BOOST_REQUIRE_EQUAL(channel.getPartialSuperpages(superpages.data(), superpages.size()), 1);
+  auto received = superpages[0].getReceived();
+  BOOST_CHECK_GT(received, 0);
+  BOOST_CHECK_LT(received, SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(received % channel.getDmaPageSize(), 0);
+  for (const auto& packet : Cru::SuperpageView(buffer.data(), received)) {
+    BOOST_CHECK(packet.valid);
+  }
+  BOOST_CHECK_EQUAL(channel.getPartialSuperpages(superpages.data(), 0), 0);
+  BOOST_CHECK_EQUAL(channel.getReadyQueueSize(), 0);
+
+  // And come back with the superpage when it is taken off the card
+  channel.recover();
+  auto superpage = channel.popSuperpage();
+  BOOST_CHECK_GE(superpage.getReceived(), received);
+  BOOST_CHECK_LT(superpage.getReceived(), SUPERPAGE_SIZE);
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(SimulationRecover)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeParameters(buffer)
+      .setLinkMask(Parameters::LinkMaskType{3, 5})
+      .setDummyLinkBandwidth(SUPERPAGE_SIZE * 20));
+  channel.startDma();
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+
+  // Every superpage comes back, the ones still on the links with the pages they received
+  channel.recover();
+  BOOST_CHECK_EQUAL(channel.getStatistics().recoveries, 1);
+  BOOST_REQUIRE_EQUAL(channel.getReadyQueueSize(), SUPERPAGES);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto superpage = channel.popSuperpage();
+    BOOST_CHECK(superpage.isReady());
+    BOOST_CHECK_LE(superpage.getReceived(), SUPERPAGE_SIZE);
+    BOOST_CHECK_EQUAL(superpage.getReceived() % channel.getDmaPageSize(), 0);
+    BOOST_CHECK(superpage.getLinkId() == 3 || superpage.getLinkId() == 5);
+  }
+
+  // And the DMA carries on
+  BOOST_REQUIRE_EQUAL(pushAndFill(channel, std::chrono::seconds(2)), SUPERPAGES);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    BOOST_CHECK_EQUAL(channel.popSuperpage().getReceived(), SUPERPAGE_SIZE);
+  }
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(SimulationNextRun)
+{
+  std::vector<char> buffer(2 * SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeParameters(buffer)
+      .setLinkMask(Parameters::LinkMaskType{3, 5})
+      .setDummyLinkBandwidth(SUPERPAGE_SIZE * 20));
+  channel.startDma();
+  BOOST_CHECK_EQUAL(channel.getRunEpoch(), 0);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+
+  // The superpages of the first run stay in the ready queue while the next run fills new ones
+  BOOST_CHECK_EQUAL(channel.startNextRun(), 1);
+  BOOST_CHECK_EQUAL(channel.getRunEpoch(), 1);
+  BOOST_CHECK_EQUAL(channel.getStatistics().recoveries, 0);
+  BOOST_REQUIRE_EQUAL(channel.getReadyQueueSize(), SUPERPAGES);
+  for (size_t i = SUPERPAGES; i < 2 * SUPERPAGES; ++i) {
+    channel.pushSuperpage(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (channel.getReadyQueueSize() < int(2 * SUPERPAGES)
+      && (std::chrono::steady_clock::now() - start) < std::chrono::seconds(2)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(channel.getReadyQueueSize(), 2 * SUPERPAGES);
+
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    BOOST_CHECK_EQUAL(channel.popSuperpage().getRunEpoch(), 0);
+  }
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto superpage = channel.popSuperpage();
+    BOOST_CHECK_EQUAL(superpage.getRunEpoch(), 1);
+    BOOST_CHECK_EQUAL(superpage.getReceived(), SUPERPAGE_SIZE);
+  }
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(SimulationRandomSize)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeParameters(buffer)
+      .setLinkMask(Parameters::LinkMaskType{0})
+      .setDummyLinkBandwidth(SUPERPAGE_SIZE * 1000)
+      .setGeneratorDataSize(4096)
+      .setGeneratorRandomSizeEnabled(true));
+  channel.startDma();
+  BOOST_REQUIRE_EQUAL(pushAndFill(channel, std::chrono::seconds(2)), SUPERPAGES);
+  channel.stopDma();
+
+  size_t counter = 0;
+  size_t sizes = 0;
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto superpage = channel.popSuperpage();
+    for (const auto& packet : Cru::SuperpageView(buffer.data() + superpage.getOffset(), superpage.getReceived())) {
+      BOOST_REQUIRE(packet.valid);
+      BOOST_CHECK_LE(packet.rdh.memorySize, 4096);
+      BOOST_CHECK_EQUAL(packet.rdh.memorySize % 32, 0);
+      auto words = packet.payloadSize / sizeof(uint32_t);
+      BOOST_CHECK_EQUAL(DataPattern::makeCruDdg(counter).findMismatch(packet.payload, 0, words), words);
+      counter += words / 4;
+      sizes += (packet.rdh.memorySize != 4096);
+    }
+  }
+  BOOST_CHECK_GT(sizes, 0);
+
+  BOOST_CHECK_THROW(DummyDmaChannel(makeParameters(buffer).setDummyLinkBandwidth(1).setGeneratorDataSize(64)),
+      Exception);
+}
+
+BOOST_AUTO_TEST_CASE(SimulationPacked)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeParameters(buffer)
+      .setLinkMask(Parameters::LinkMaskType{0})
+      .setDummyLinkBandwidth(SUPERPAGE_SIZE * 1000)
+      .setGeneratorDataSize(1000)
+      .setPackedPacketsEnabled(true));
+  channel.startDma();
+  BOOST_REQUIRE_EQUAL(pushAndFill(channel, std::chrono::seconds(2)), SUPERPAGES);
+  channel.stopDma();
+
+  size_t counter = 0;
+  uint32_t orbit = 0;
+  LinkIntegrityMonitor monitor(Cru::SuperpageView::DMA_PAGE_SIZE, true);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto superpage = channel.popSuperpage();
+    auto address = buffer.data() + superpage.getOffset();
+    BOOST_CHECK_EQUAL(monitor.checkSuperpage(address, superpage.getReceived()), 0);
+    size_t packets = 0;
+    const char* end = nullptr;
+    for (const auto& packet : Cru::SuperpageView(address, superpage.getReceived(), Cru::SuperpageView::DMA_PAGE_SIZE,
+        0, true, true)) {
+      BOOST_REQUIRE(packet.valid);
+      BOOST_CHECK_EQUAL(packet.rdh.memorySize, 1000);
+      auto words = packet.payloadSize / sizeof(uint32_t);
+      BOOST_CHECK_EQUAL(DataPattern::makeCruDdg(counter).findMismatch(packet.payload, 0, words), words);
+      counter += (words + 3) / 4;
+      // The orbits advance with the packets
+      BOOST_CHECK(packet.rdh.heartbeatOrbit == orbit || packet.rdh.heartbeatOrbit == orbit + 1);
+      orbit = packet.rdh.heartbeatOrbit;
+      end = packet.page + packet.rdh.offsetNextPacket;
+      packets++;
+    }
+    // 1000 bytes take 1024 with the padding to 256 bits, and the last packet covers the rest
+    BOOST_CHECK_EQUAL(packets, SUPERPAGE_SIZE / 1024);
+    BOOST_CHECK(end == address + SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK_EQUAL(monitor.getErrorCount(), 0);
+  BOOST_CHECK(orbit > 0);
+}
+
+} // Anonymous namespace
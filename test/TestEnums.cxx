@@ -4,8 +4,10 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "ReadoutCard/CardType.h"
+#include "ReadoutCard/ParameterTypes/LinkScheduling.h"
 #include "ReadoutCard/ParameterTypes/LoopbackMode.h"
 #include "ReadoutCard/ParameterTypes/ReadoutMode.h"
+#include "ReadoutCard/ParameterTypes/ReadyQueueOverflow.h"
 #include "ReadoutCard/ParameterTypes/ResetLevel.h"
 
 #define BOOST_TEST_MODULE RORC_TestEnums
@@ -28,7 +30,8 @@ void checkEnumConversion(const std::vector<typename E::type>& items)
 
 BOOST_AUTO_TEST_CASE(EnumCardTypeConversion)
 {
-  checkEnumConversion<CardType>({CardType::Crorc, CardType::Cru, CardType::Dummy, CardType::Unknown});
+  checkEnumConversion<CardType>({CardType::Crorc, CardType::Cru, CardType::Dummy, CardType::Simulated,
+      CardType::Unknown});
 }
 
 BOOST_AUTO_TEST_CASE(EnumLoopbackModeConversion)
@@ -46,3 +49,14 @@ BOOST_AUTO_TEST_CASE(EnumReadoutModeConversion)
 {
   checkEnumConversion<ReadoutMode>({ReadoutMode::Continuous});
 }
+
+BOOST_AUTO_TEST_CASE(EnumLinkSchedulingConversion)
+{
+  checkEnumConversion<LinkScheduling>({LinkScheduling::ShortestQueue, LinkScheduling::Throughput});
+}
+
+BOOST_AUTO_TEST_CASE(EnumReadyQueueOverflowConversion)
+{
+  checkEnumConversion<ReadyQueueOverflow>({ReadyQueueOverflow::Block, ReadyQueueOverflow::Grow,
+      ReadyQueueOverflow::DropOldest});
+}
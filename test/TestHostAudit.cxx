@@ -0,0 +1,132 @@
+/// \file TestHostAudit.cxx
+/// \brief Test of the HostAudit class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestHostAudit
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include "CommandLineUtilities/HostAudit.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/// Fake /sys and /proc of a host with a card on NUMA node 0 with local CPUs 0-1, set up for DMA
+struct FakeHost
+{
+    FakeHost()
+      : root(bfs::temp_directory_path() / bfs::unique_path()), pciAddress("42:00.0")
+    {
+      write("proc/mounts", "sysfs /sys sysfs rw 0 0\n"
+          "hugetlbfs /var/lib/hugetlbfs/global/pagesize-2MB hugetlbfs rw,pagesize=2M 0 0\n"
+          "hugetlbfs /var/lib/hugetlbfs/global/pagesize-1GB hugetlbfs rw,pagesize=1024M 0 0\n");
+      write("proc/cmdline", "BOOT_IMAGE=/vmlinuz ro iommu=pt intel_iommu=on\n");
+      write("sys/kernel/mm/hugepages/hugepages-2048kB/nr_hugepages", "128\n");
+      write("sys/devices/system/node/node0/hugepages/hugepages-2048kB/nr_hugepages", "128\n");
+      write("sys/devices/system/node/node0/hugepages/hugepages-2048kB/free_hugepages", "64\n");
+      write(device() + "local_cpulist", "0-1\n");
+      write(device() + "msi_irqs/120", "msix\n");
+      write("proc/irq/120/smp_affinity_list", "0-1\n");
+      for (int cpu = 0; cpu < 2; ++cpu) {
+        write(cpuDirectory(cpu) + "cpufreq/scaling_governor", "performance\n");
+        idleState(cpu, 0, "POLL", 0, false);
+        idleState(cpu, 1, "C6", 133, true);
+      }
+    }
+
+    ~FakeHost()
+    {
+      bfs::remove_all(root);
+    }
+
+    void write(const std::string& path, const std::string& content)
+    {
+      auto file = root / path;
+      bfs::create_directories(file.parent_path());
+      std::ofstream(file.string()) << content;
+    }
+
+    std::string device()
+    {
+      return "sys/bus/pci/devices/0000:" + pciAddress.toString() + "/";
+    }
+
+    std::string cpuDirectory(int cpu)
+    {
+      return "sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/";
+    }
+
+    void idleState(int cpu, int state, const std::string& name, int latency, bool disabled)
+    {
+      auto directory = cpuDirectory(cpu) + "cpuidle/state" + std::to_string(state) + "/";
+      write(directory + "name", name + "\n");
+      write(directory + "latency", std::to_string(latency) + "\n");
+      write(directory + "disable", disabled ? "1\n" : "0\n");
+    }
+
+    HostAudit audit()
+    {
+      return HostAudit(HostAudit::Paths{(root / "sys").string(), (root / "proc").string()});
+    }
+
+    bfs::path root;
+    PciAddress pciAddress;
+};
+
+BOOST_AUTO_TEST_CASE(Tuned)
+{
+  FakeHost host;
+  BOOST_CHECK(host.audit().auditHost(true).empty());
+  BOOST_CHECK(host.audit().auditCard(host.pciAddress, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(HostSettings)
+{
+  FakeHost host;
+  host.write("proc/mounts", "sysfs /sys sysfs rw 0 0\n");
+  host.write("proc/cmdline", "BOOT_IMAGE=/vmlinuz ro intel_iommu=on\n");
+  // The 2 MiB mount and the IOMMU. No 1 GiB pages are allocated, so their mount doesn't matter.
+  BOOST_CHECK_EQUAL(host.audit().auditHost(true).size(), 2);
+  BOOST_CHECK_EQUAL(host.audit().auditHost(false).size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Hugepages)
+{
+  FakeHost host;
+  // Every hugepage is in use
+  host.write("sys/devices/system/node/node0/hugepages/hugepages-2048kB/free_hugepages", "0\n");
+  BOOST_CHECK_EQUAL(host.audit().auditCard(host.pciAddress, 0).size(), 1);
+  // The card's node has none
+  BOOST_CHECK_EQUAL(host.audit().auditCard(host.pciAddress, 1).size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Cpus)
+{
+  FakeHost host;
+  host.write(host.cpuDirectory(1) + "cpufreq/scaling_governor", "powersave\n");
+  host.idleState(0, 1, "C6", 133, false);
+  host.idleState(1, 1, "C6", 133, false);
+  auto warnings = host.audit().auditCard(host.pciAddress, 0);
+  // One warning per governor and per idle state, listing the CPUs
+  BOOST_REQUIRE_EQUAL(warnings.size(), 2);
+  BOOST_CHECK(warnings[0].find("CPUs 1 use the 'powersave'") != std::string::npos);
+  BOOST_CHECK(warnings[1].find("CPUs 0-1 can enter the idle state C6") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Interrupts)
+{
+  FakeHost host;
+  host.write("proc/irq/120/smp_affinity_list", "0-3\n");
+  auto warnings = host.audit().auditCard(host.pciAddress, 0);
+  BOOST_REQUIRE_EQUAL(warnings.size(), 1);
+  BOOST_CHECK(warnings[0].find("Interrupt 120") != std::string::npos);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,92 @@
+/// \file TestHugepageMemfd.cxx
+/// \brief Test of the HugepageMemfd class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestHugepageMemfd
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/HugepageMemfd.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t SIZE = 2 * 1024 * 1024;
+
+/// Regular memfd, so the tests don't need hugepages
+int createMemfd()
+{
+  int fd = syscall(SYS_memfd_create, "TestHugepageMemfd", 0);
+  BOOST_REQUIRE(fd != -1);
+  BOOST_REQUIRE(ftruncate(fd, SIZE) == 0);
+  return fd;
+}
+
+BOOST_AUTO_TEST_CASE(MapFileDescriptor)
+{
+  int fd = createMemfd();
+  {
+    HugepageMemfd a(fd, SIZE);
+    HugepageMemfd b(fd, SIZE);
+    BOOST_CHECK_NE(a.getFileDescriptor(), fd);
+    BOOST_CHECK_EQUAL(a.getSize(), SIZE);
+    BOOST_CHECK_EQUAL(a.getBufferParameters().size, SIZE);
+
+    // Both map the same memory
+    std::memset(a.getAddress(), 0xAB, SIZE);
+    BOOST_CHECK_EQUAL(static_cast<unsigned char*>(b.getAddress())[SIZE - 1], 0xAB);
+  }
+  close(fd);
+}
+
+BOOST_AUTO_TEST_CASE(PassFileDescriptor)
+{
+  int sockets[2];
+  BOOST_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+  int fd = createMemfd();
+  HugepageMemfd sender(fd, SIZE);
+  static_cast<char*>(sender.getAddress())[0] = 42;
+
+  HugepageMemfd::sendFileDescriptor(sockets[0], sender.getFileDescriptor(), sender.getSize());
+  size_t size = 0;
+  int received = HugepageMemfd::receiveFileDescriptor(sockets[1], size);
+  BOOST_CHECK_EQUAL(size, SIZE);
+  {
+    HugepageMemfd receiver(received, size);
+    BOOST_CHECK_EQUAL(static_cast<char*>(receiver.getAddress())[0], 42);
+  }
+
+  close(received);
+  close(fd);
+  close(sockets[0]);
+  close(sockets[1]);
+}
+
+BOOST_AUTO_TEST_CASE(BadSize)
+{
+  BOOST_CHECK_THROW(HugepageMemfd(SIZE + 1, "TestHugepageMemfd"), MemoryMapException);
+}
+
+BOOST_AUTO_TEST_CASE(Hugepages)
+{
+  // Whether this succeeds depends on the free hugepages of the machine
+  try {
+    HugepageMemfd memfd(SIZE, "TestHugepageMemfd");
+    BOOST_CHECK_EQUAL(memfd.getSize(), SIZE);
+    BOOST_CHECK_EQUAL(memfd.getPageSize(), SIZE);
+    std::memset(memfd.getAddress(), 0, SIZE);
+  }
+  catch (const MemoryMapException&) {
+    BOOST_TEST_MESSAGE("No 2 MiB hugepages available, skipping");
+  }
+}
+
+} // Anonymous namespace
@@ -0,0 +1,90 @@
+/// \file TestHugepagePool.cxx
+/// \brief Test of the HugepagePool class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestHugepagePool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <stdlib.h>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/HugepagePool.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t SLICE = HugepagePool::SLICE_ALIGNMENT;
+constexpr size_t REGION_SIZE = 8 * SLICE;
+
+/// The pool doesn't need actual hugepages for its bookkeeping, so we give it regular aligned memory
+struct Region
+{
+    Region() : memory(::aligned_alloc(SLICE, REGION_SIZE), &std::free)
+    {
+    }
+
+    std::unique_ptr<void, decltype(&std::free)> memory;
+};
+
+BOOST_AUTO_TEST_CASE(AllocateAndRelease)
+{
+  Region region;
+  HugepagePool pool(region.memory.get(), REGION_SIZE);
+  auto base = reinterpret_cast<uintptr_t>(pool.getAddress());
+
+  auto a = pool.allocate(1);
+  auto b = pool.allocate(3 * SLICE);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(a.address), base);
+  BOOST_CHECK_EQUAL(a.size, SLICE);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(b.address), base + SLICE);
+  BOOST_CHECK_EQUAL(b.size, 3 * SLICE);
+  BOOST_CHECK_EQUAL(pool.getAvailable(), 4 * SLICE);
+  BOOST_CHECK(HugepagePool::isPoolMemory(b.address, b.size));
+
+  BOOST_CHECK_THROW(pool.allocate(5 * SLICE), Exception);
+
+  // Releasing both merges them with the rest, so the whole region can be handed out again
+  pool.release(a);
+  pool.release(b);
+  BOOST_CHECK_THROW(pool.release(b), Exception);
+  BOOST_CHECK_EQUAL(pool.getAvailable(), REGION_SIZE);
+  auto all = pool.allocate(REGION_SIZE);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(all.address), base);
+}
+
+BOOST_AUTO_TEST_CASE(ReopenSameSlice)
+{
+  // A channel that is closed and reopened in the same order gets the same slice, so its registration can be reused
+  Region region;
+  HugepagePool pool(region.memory.get(), REGION_SIZE);
+  auto a = pool.allocate(2 * SLICE);
+  auto b = pool.allocate(2 * SLICE);
+  pool.release(a);
+  auto c = pool.allocate(2 * SLICE);
+  BOOST_CHECK_EQUAL(c.address, a.address);
+  pool.release(b);
+  pool.release(c);
+}
+
+BOOST_AUTO_TEST_CASE(PoolMemory)
+{
+  Region region;
+  {
+    HugepagePool pool(region.memory.get(), REGION_SIZE);
+    BOOST_CHECK(HugepagePool::isPoolMemory(region.memory.get(), REGION_SIZE));
+    BOOST_CHECK(!HugepagePool::isPoolMemory(region.memory.get(), REGION_SIZE + 1));
+  }
+  BOOST_CHECK(!HugepagePool::isPoolMemory(region.memory.get(), REGION_SIZE));
+}
+
+BOOST_AUTO_TEST_CASE(InvalidRegion)
+{
+  Region region;
+  BOOST_CHECK_THROW(HugepagePool(region.memory.get(), SLICE + 1), Exception);
+  BOOST_CHECK_THROW(HugepagePool(static_cast<char*>(region.memory.get()) + 1, SLICE), Exception);
+}
+
+} // Anonymous namespace
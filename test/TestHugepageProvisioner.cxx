@@ -0,0 +1,107 @@
+/// \file TestHugepageProvisioner.cxx
+/// \brief Test of the HugepageProvisioner class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestHugepageProvisioner
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include "CommandLineUtilities/HugepageProvisioner.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+namespace bfs = boost::filesystem;
+
+namespace {
+constexpr size_t MiB = 1024 * 1024;
+constexpr size_t GiB = 1024 * MiB;
+
+/// Fake sysfs with two NUMA nodes without hugepages
+struct FakeSysfs
+{
+    FakeSysfs()
+      : root(bfs::temp_directory_path() / bfs::unique_path())
+    {
+      for (int node = 0; node < 2; ++node) {
+        write(node, "hugepages-2048kB", 0);
+        write(node, "hugepages-1048576kB", 0);
+      }
+    }
+
+    ~FakeSysfs()
+    {
+      bfs::remove_all(root);
+    }
+
+    bfs::path file(int node, const std::string& size)
+    {
+      return root / ("devices/system/node/node" + std::to_string(node)) / "hugepages" / size / "nr_hugepages";
+    }
+
+    void write(int node, const std::string& size, size_t pages)
+    {
+      bfs::create_directories(file(node, size).parent_path());
+      std::ofstream(file(node, size).string()) << pages << '\n';
+    }
+
+    bfs::path root;
+};
+
+BOOST_AUTO_TEST_CASE(Plan)
+{
+  // Two cards on node 0, one on node 1
+  auto plan = HugepageProvisioner::makePlan({0, 0, 1}, 2, 4 * GiB);
+  BOOST_REQUIRE_EQUAL(plan.size(), 2);
+  BOOST_CHECK_EQUAL(plan[0].pages1GiB, 16);
+  BOOST_CHECK_EQUAL(plan[0].pages2MiB, 0);
+  BOOST_CHECK_EQUAL(plan[1].pages1GiB, 8);
+
+  // Buffers that are not a multiple of 1 GiB use 2 MiB pages
+  plan = HugepageProvisioner::makePlan({0}, 1, 512 * MiB);
+  BOOST_CHECK_EQUAL(plan[0].pages2MiB, 256);
+  BOOST_CHECK_EQUAL(plan[0].pages1GiB, 0);
+
+  BOOST_CHECK_THROW(HugepageProvisioner::makePlan({0}, 1, 3 * MiB), InvalidOptionValueException);
+}
+
+BOOST_AUTO_TEST_CASE(AllocateAndVerify)
+{
+  FakeSysfs sysfs;
+  HugepageProvisioner provisioner(sysfs.root.string());
+  auto plan = HugepageProvisioner::makePlan({0, 1}, 1, 2 * GiB);
+  BOOST_CHECK_EQUAL(provisioner.verify(plan).size(), 2);
+
+  provisioner.allocate(plan);
+  BOOST_CHECK_EQUAL(provisioner.getAllocated(0).pages1GiB, 2);
+  BOOST_CHECK_EQUAL(provisioner.getAllocated(1).pages1GiB, 2);
+  BOOST_CHECK(provisioner.verify(plan).empty());
+
+  // The kernel allocated fewer pages than asked for
+  sysfs.write(1, "hugepages-1048576kB", 1);
+  BOOST_CHECK_EQUAL(provisioner.verify(plan).size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(NeverLowered)
+{
+  FakeSysfs sysfs;
+  sysfs.write(0, "hugepages-2048kB", 1000);
+  HugepageProvisioner provisioner(sysfs.root.string());
+  provisioner.allocate(HugepageProvisioner::makePlan({0}, 1, 64 * MiB));
+  BOOST_CHECK_EQUAL(provisioner.getAllocated(0).pages2MiB, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(No1GiBPages)
+{
+  // CPUs without 1 GiB pages have no sysfs directory for them
+  FakeSysfs sysfs;
+  bfs::remove_all(sysfs.file(0, "hugepages-1048576kB").parent_path());
+  HugepageProvisioner provisioner(sysfs.root.string());
+  BOOST_CHECK_EQUAL(provisioner.getAllocated(0).pages1GiB, 0);
+}
+
+} // Anonymous namespace
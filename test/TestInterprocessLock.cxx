@@ -3,114 +3,114 @@
 ///
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
-//TODO: Update this for the socket lock
-#define BOOST_TEST_MODULE RORC_TestFileSharedObject
+#define BOOST_TEST_MODULE RORC_TestInterprocessLock
 #define BOOST_TEST_MAIN
 #define BOOST_TEST_DYN_LINK
-#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <string>
 #include <thread>
-#include <iostream>
-#include <future>
-#include <atomic>
-#include <condition_variable>
-#include <iostream>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include <boost/test/unit_test.hpp>
-#include <boost/filesystem.hpp>
-#include <boost/exception/all.hpp>
 #include "InterprocessLock.h"
-
 #include "ReadoutCard/Exception.h"
 
 namespace {
 
 using namespace ::AliceO2::roc;
-namespace b = boost;
-namespace bip = boost::interprocess;
-namespace bfs = boost::filesystem;
-
-struct TestObject
-{
-    TestObject(const std::string& s, int i) : string(s), integer(i) {}
-    std::string string;
-    int integer;
-};
 
-const std::string namedMutexName("AliceO2_InterprocessMutex_Test");
-const bfs::path lockFilePath("/tmp/AliceO2_InterprocessMutex_Test.lock");
+const std::string lockName("AliceO2_InterprocessLock_Test");
 
-void cleanupFiles()
+/// CPU time used by the calling thread
+std::chrono::nanoseconds getThreadCpuTime()
 {
-  bip::named_mutex::remove(namedMutexName.c_str());
-  bfs::remove(lockFilePath);
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
 }
 
-#define CONSTRUCT_LOCK() Interprocess::Lock _test_lock {lockFilePath, namedMutexName}
-
-void doLock()
+// Test the intraprocess locking
+BOOST_AUTO_TEST_CASE(InterprocessLockTestIntraprocess)
 {
-  CONSTRUCT_LOCK();
+  std::atomic<bool> childAcquired(false);
+  std::atomic<bool> parentDone(false);
+
+  // Launch "child" thread that holds the lock until the parent is done
+  auto future = std::async(std::launch::async, [&](){
+    Interprocess::Lock lock(lockName);
+    childAcquired = true;
+    while (!parentDone) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  while (!childAcquired) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_CHECK_THROW(Interprocess::Lock(lockName, false), LockException);
+  parentDone = true;
+  future.get();
+
+  // Released, so it can be taken again
+  BOOST_CHECK_NO_THROW(Interprocess::Lock(lockName, false));
 }
 
-// Test the intraprocess locking
-BOOST_AUTO_TEST_CASE(InterprocessMutexTestIntraprocess)
+// Test that a waiting lock gets the lock when it is released, and sleeps instead of spinning while it waits
+BOOST_AUTO_TEST_CASE(InterprocessLockTestWait)
 {
-  cleanupFiles();
-
-  std::condition_variable conditionVariable;
+  constexpr auto holdTime = std::chrono::milliseconds(200);
   std::atomic<bool> childAcquired(false);
 
-  // Launch "child" thread that acquires the lock
   auto future = std::async(std::launch::async, [&](){
-    try {
-      CONSTRUCT_LOCK();
-      childAcquired = true;
-      conditionVariable.notify_all();
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    catch (const LockException& e) {
-      BOOST_FAIL("Child failed to acquire FileSharedObject");
-    }
+    Interprocess::Lock lock(lockName);
+    childAcquired = true;
+    std::this_thread::sleep_for(holdTime);
   });
 
-  // Parent tries to acquire the lock
-  std::mutex mutex;
-  std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
-  auto status = conditionVariable.wait_for(lock, std::chrono::milliseconds(100), [&]{return childAcquired.load();});
-  if (!status) {
-    BOOST_FAIL("Timed out or child failed to acquire lock");
+  while (!childAcquired) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
-  BOOST_CHECK_THROW(doLock(), NamedMutexLockException);
 
-  // Wait on child thread
+  auto wallStart = std::chrono::steady_clock::now();
+  auto cpuStart = getThreadCpuTime();
+  {
+    Interprocess::Lock lock(lockName, true);
+  }
+  auto cpu = getThreadCpuTime() - cpuStart;
+  auto wall = std::chrono::steady_clock::now() - wallStart;
   future.get();
-}
 
+  BOOST_CHECK(wall < std::chrono::seconds(LOCK_TIMEOUT));
+  // A spinning waiter would use about as much CPU time as it waited
+  BOOST_CHECK_LT(cpu.count(), (wall / 4).count());
+}
 
 // Test the interprocess locking. Probably not 100% reliable test, since we rely on sleeps to "synchronize"
 // The procedure is:
 // - The parent waits a bit
 // - The child locks immediately and holds the lock for a while
 // - The parent tries to acquire while the child has it -> it should fail
-BOOST_AUTO_TEST_CASE(InterprocessMutexTestInterprocess)
+BOOST_AUTO_TEST_CASE(InterprocessLockTestInterprocess)
 {
-  cleanupFiles();
-
   pid_t pid = fork();
 
   if (pid == 0) {
     // Child
     { // We add this scope so the lock destroys cleanly before exit() is called
-      CONSTRUCT_LOCK();
+      Interprocess::Lock lock(lockName);
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-    cleanupFiles();
-    exit(0);
+    _exit(0);
   }
   else if (pid > 0) {
     // Parent
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    BOOST_CHECK_THROW(doLock(), FileLockException);
+    BOOST_CHECK_THROW(Interprocess::Lock(lockName, false), LockException);
+    int status;
+    waitpid(pid, &status, 0);
   }
   else {
     BOOST_FAIL("Failed to fork");
@@ -0,0 +1,77 @@
+/// \file TestLatencyHistogram.cxx
+/// \brief Test of the LatencyHistogram class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestLatencyHistogram
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstdint>
+#include <limits>
+#include <boost/test/unit_test.hpp>
+#include "LatencyHistogram.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+  LatencyHistogram histogram;
+  BOOST_CHECK_EQUAL(histogram.getCount(), 0);
+  BOOST_CHECK_EQUAL(histogram.getMax(), 0);
+  BOOST_CHECK_EQUAL(histogram.getPercentile(50), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Buckets)
+{
+  // Every value falls within its bucket, buckets are contiguous
+  for (uint64_t value : {0ul, 1ul, 127ul, 128ul, 129ul, 255ul, 256ul, 1000ul, 123456789ul, 1ul << 40,
+      std::numeric_limits<uint64_t>::max()}) {
+    auto index = LatencyHistogram::getIndex(value);
+    BOOST_REQUIRE_LT(index, size_t(LatencyHistogram::BUCKETS));
+    BOOST_CHECK_LE(value, LatencyHistogram::getUpperBound(index));
+    if (index > 0) {
+      BOOST_CHECK_GT(value, LatencyHistogram::getUpperBound(index - 1));
+    }
+  }
+  BOOST_CHECK_EQUAL(LatencyHistogram::getIndex(std::numeric_limits<uint64_t>::max()), LatencyHistogram::BUCKETS - 1);
+}
+
+BOOST_AUTO_TEST_CASE(Percentiles)
+{
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 10000; ++i) {
+    histogram.record(i * 1000);
+  }
+  BOOST_CHECK_EQUAL(histogram.getCount(), 10000);
+  BOOST_CHECK_EQUAL(histogram.getMax(), 10000 * 1000);
+
+  // Within the relative precision of the buckets, and never below the real value
+  auto check = [&](double percentile, uint64_t expected) {
+    auto value = histogram.getPercentile(percentile);
+    BOOST_CHECK_GE(value, expected);
+    BOOST_CHECK_LE(value, expected + expected / LatencyHistogram::SUB_BUCKETS_HALF);
+  };
+  check(50, 5000 * 1000);
+  check(99, 9900 * 1000);
+  check(99.9, 9990 * 1000);
+  BOOST_CHECK_EQUAL(histogram.getPercentile(100), 10000 * 1000);
+}
+
+BOOST_AUTO_TEST_CASE(Merge)
+{
+  LatencyHistogram a;
+  LatencyHistogram b;
+  for (int i = 0; i < 99; ++i) {
+    a.record(10);
+  }
+  b.record(5000);
+  a.merge(b);
+  BOOST_CHECK_EQUAL(a.getCount(), 100);
+  BOOST_CHECK_EQUAL(a.getPercentile(99), 10);
+  BOOST_CHECK_EQUAL(a.getPercentile(99.9), 5000);
+  BOOST_CHECK_EQUAL(a.getMax(), 5000);
+}
+
+} // Anonymous namespace
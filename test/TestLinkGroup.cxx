@@ -0,0 +1,138 @@
+/// \file TestLinkGroup.cxx
+/// \brief Test of the LinkGroupMaster and LinkGroupChannel classes
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestLinkGroup
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "FakeDmaChannel.h"
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/LinkGroupChannel.h"
+#include "ReadoutCard/LinkGroupMaster.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+const std::string name("TestLinkGroup");
+const std::string bufferPath("/tmp/AliceO2_LinkGroup_Test");
+constexpr size_t BUFFER_SIZE = 1024 * 1024;
+constexpr size_t SUPERPAGE_SIZE = 64 * 1024;
+constexpr size_t RING_CAPACITY = 4;
+
+BOOST_AUTO_TEST_CASE(RoutesByLink)
+{
+  LinkGroupMaster master(name, bufferPath, BUFFER_SIZE, {{0, 1}, {5}}, RING_CAPACITY);
+  LinkGroupChannel first(name, 0);
+  LinkGroupChannel second(name, 1);
+  BOOST_CHECK_EQUAL(master.getGroupCount(), 2);
+  BOOST_CHECK_EQUAL(first.getSize(), BUFFER_SIZE);
+  BOOST_CHECK(first.getLinks() == std::vector<uint32_t>({0, 1}));
+  BOOST_CHECK(second.getLinks() == std::vector<uint32_t>({5}));
+
+  FakeDmaChannel channel;
+  channel.startDma();
+  BOOST_REQUIRE(first.tryPushSuperpage(Superpage(0, SUPERPAGE_SIZE), 1));
+  BOOST_REQUIRE(second.tryPushSuperpage(Superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE), 5));
+  BOOST_CHECK_EQUAL(master.poll(channel), 4);
+
+  Superpage superpage;
+  BOOST_REQUIRE(first.tryPopSuperpage(superpage));
+  BOOST_CHECK(superpage.isReady());
+  BOOST_CHECK_EQUAL(superpage.getOffset(), 0);
+  BOOST_CHECK_EQUAL(superpage.getLinkId(), 1);
+  BOOST_CHECK(!first.tryPopSuperpage(superpage));
+
+  BOOST_REQUIRE(second.tryPopSuperpage(superpage));
+  BOOST_CHECK_EQUAL(superpage.getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(superpage.getLinkId(), 5);
+  BOOST_CHECK(!second.tryPopSuperpage(superpage));
+}
+
+BOOST_AUTO_TEST_CASE(ForeignLink)
+{
+  LinkGroupMaster master(name, bufferPath, BUFFER_SIZE, {{0}, {1}}, RING_CAPACITY);
+  LinkGroupChannel first(name, 0);
+  BOOST_CHECK_THROW(first.tryPushSuperpage(Superpage(0, SUPERPAGE_SIZE), 1), InvalidLinkId);
+  BOOST_CHECK_THROW(LinkGroupChannel(name, 2), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(RejectedSuperpage)
+{
+  LinkGroupMaster master(name, bufferPath, BUFFER_SIZE, {{0}}, RING_CAPACITY);
+  LinkGroupChannel group(name, 0);
+  FakeDmaChannel channel;
+  channel.startDma();
+
+  // The channel rejects the empty superpage, which comes back without stopping the one behind it
+  BOOST_REQUIRE(group.tryPushSuperpage(Superpage(0, 0), 0));
+  BOOST_REQUIRE(group.tryPushSuperpage(Superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE), 0));
+  BOOST_CHECK_NO_THROW(master.poll(channel));
+
+  Superpage superpage;
+  BOOST_REQUIRE(group.tryPopSuperpage(superpage));
+  BOOST_CHECK(!superpage.isReady());
+  BOOST_CHECK_EQUAL(superpage.getReceived(), 0);
+  BOOST_REQUIRE(group.tryPopSuperpage(superpage));
+  BOOST_CHECK(superpage.isReady());
+  BOOST_CHECK_EQUAL(superpage.getOffset(), SUPERPAGE_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(UnroutedSuperpage)
+{
+  LinkGroupMaster master(name, bufferPath, BUFFER_SIZE, {{0}}, RING_CAPACITY);
+  LinkGroupChannel group(name, 0);
+  FakeDmaChannel channel;
+  channel.startDma();
+
+  // A superpage on a link without group does not keep the group's superpage from being handed out
+  BOOST_REQUIRE(channel.tryPushSuperpageToLink(Superpage(0, SUPERPAGE_SIZE), 3));
+  BOOST_REQUIRE(group.tryPushSuperpage(Superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE), 0));
+  BOOST_CHECK_THROW(master.poll(channel), InvalidLinkId);
+
+  Superpage superpage;
+  BOOST_REQUIRE(group.tryPopSuperpage(superpage));
+  BOOST_CHECK_EQUAL(superpage.getOffset(), SUPERPAGE_SIZE);
+  auto unrouted = master.takeUnroutedSuperpages();
+  BOOST_REQUIRE_EQUAL(unrouted.size(), 1);
+  BOOST_CHECK_EQUAL(unrouted[0].getLinkId(), 3);
+  BOOST_CHECK_NO_THROW(master.poll(channel));
+}
+
+BOOST_AUTO_TEST_CASE(InvalidGroups)
+{
+  BOOST_CHECK_THROW(LinkGroupMaster(name, bufferPath, BUFFER_SIZE, {{0, 1}, {1}}, RING_CAPACITY), InvalidLinkId);
+  BOOST_CHECK_THROW(LinkGroupMaster(name, bufferPath, BUFFER_SIZE, {{64}}, RING_CAPACITY), InvalidLinkId);
+  BOOST_CHECK_THROW(LinkGroupMaster(name, bufferPath, BUFFER_SIZE, {}, RING_CAPACITY), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(ReadyRingFull)
+{
+  LinkGroupMaster master(name, bufferPath, BUFFER_SIZE, {{0}}, RING_CAPACITY);
+  LinkGroupChannel group(name, 0);
+  FakeDmaChannel channel;
+  channel.startDma();
+
+  // Twice the ring's capacity arrives, the rest is held back until the group pops
+  for (size_t round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < RING_CAPACITY; ++i) {
+      BOOST_REQUIRE(group.tryPushSuperpage(Superpage((round * RING_CAPACITY + i) * SUPERPAGE_SIZE, SUPERPAGE_SIZE),
+          0));
+    }
+    master.poll(channel);
+  }
+
+  Superpage superpage;
+  for (size_t i = 0; i < 2 * RING_CAPACITY; ++i) {
+    if (i == RING_CAPACITY) {
+      master.poll(channel);
+    }
+    BOOST_REQUIRE(group.tryPopSuperpage(superpage));
+    BOOST_CHECK_EQUAL(superpage.getOffset(), i * SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK(!group.tryPopSuperpage(superpage));
+}
+
+} // Anonymous namespace
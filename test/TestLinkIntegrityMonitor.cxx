@@ -0,0 +1,135 @@
+/// \file TestLinkIntegrityMonitor.cxx
+/// \brief Tests for the LinkIntegrityMonitor class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestLinkIntegrityMonitor
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/LinkIntegrityMonitor.h"
+
+using namespace AliceO2::roc;
+
+namespace {
+
+constexpr size_t PAGE_SIZE = LinkIntegrityMonitor::DMA_PAGE_SIZE;
+
+/// Writes the RDH words the monitor decodes
+void setRdh(std::vector<uint32_t>& buffer, size_t page, uint32_t memorySize, uint32_t linkId, uint32_t packetCounter)
+{
+  auto rdh = &buffer[page * PAGE_SIZE / sizeof(uint32_t)];
+  rdh[2] = (memorySize << 16) | PAGE_SIZE;
+  rdh[3] = ((packetCounter & 0xff) << 8) | linkId;
+}
+
+BOOST_AUTO_TEST_CASE(ContinuousLinks)
+{
+  constexpr size_t pages = 8;
+  std::vector<uint32_t> buffer(pages * PAGE_SIZE / sizeof(uint32_t));
+  // Two interleaved links, with link 2's counter wrapping around
+  for (size_t i = 0; i < pages; ++i) {
+    setRdh(buffer, i, 0x1000, (i % 2) ? 2 : 1, (i % 2) ? 0xfe + i / 2 : i / 2);
+  }
+
+  LinkIntegrityMonitor monitor;
+  BOOST_CHECK_EQUAL(monitor.checkSuperpage(buffer.data(), pages * PAGE_SIZE), 0);
+  BOOST_CHECK_EQUAL(monitor.getErrorCount(), 0);
+  BOOST_CHECK_EQUAL(monitor.getLastPacketCounter(1), 3);
+  BOOST_CHECK_EQUAL(monitor.getLastPacketCounter(2), 1);
+  BOOST_CHECK_EQUAL(monitor.getLastPacketCounter(3), -1);
+
+  auto statistics = monitor.getStatistics();
+  BOOST_REQUIRE_EQUAL(statistics.size(), 2);
+  BOOST_CHECK_EQUAL(statistics[0].linkId, 1);
+  BOOST_CHECK_EQUAL(statistics[0].packets, 4);
+  BOOST_CHECK_EQUAL(statistics[0].bytes, 4 * 0x1000);
+  BOOST_CHECK_EQUAL(statistics[1].linkId, 2);
+}
+
+BOOST_AUTO_TEST_CASE(CounterGap)
+{
+  std::vector<uint32_t> buffer(4 * PAGE_SIZE / sizeof(uint32_t));
+  setRdh(buffer, 0, 0x100, 5, 0xfd);
+  setRdh(buffer, 1, 0x100, 5, 0x02); // 0xfe to 0x01 dropped
+  setRdh(buffer, 2, 0x100, 5, 0x03);
+  setRdh(buffer, 3, 0x100, 5, 0x03); // Repeated, 255 dropped as far as the counter can tell
+
+  LinkIntegrityMonitor monitor;
+  BOOST_CHECK(monitor.checkPage(&buffer[0]) == LinkIntegrityMonitor::Status::Ok);
+  BOOST_CHECK(monitor.checkPage(&buffer[PAGE_SIZE / 4]) == LinkIntegrityMonitor::Status::CounterGap);
+  BOOST_CHECK(monitor.checkPage(&buffer[2 * PAGE_SIZE / 4]) == LinkIntegrityMonitor::Status::Ok);
+  BOOST_CHECK(monitor.checkPage(&buffer[3 * PAGE_SIZE / 4]) == LinkIntegrityMonitor::Status::CounterGap);
+
+  auto statistics = monitor.getLinkStatistics(5);
+  BOOST_CHECK_EQUAL(statistics.packets, 4);
+  BOOST_CHECK_EQUAL(statistics.counterGaps, 2);
+  BOOST_CHECK_EQUAL(statistics.dropped, 4 + 255);
+  BOOST_CHECK_EQUAL(monitor.getErrorCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(SizeError)
+{
+  std::vector<uint32_t> buffer(3 * PAGE_SIZE / sizeof(uint32_t));
+  setRdh(buffer, 0, 0x20, 7, 0); // Smaller than the RDH
+  setRdh(buffer, 1, PAGE_SIZE + 1, 7, 1); // Larger than the page
+  setRdh(buffer, 2, PAGE_SIZE, 7, 9);
+
+  LinkIntegrityMonitor monitor;
+  BOOST_CHECK_EQUAL(monitor.checkSuperpage(buffer.data(), 3 * PAGE_SIZE), 2);
+
+  // The counters of pages with a bad size are not used, so the third page starts the sequence
+  auto statistics = monitor.getLinkStatistics(7);
+  BOOST_CHECK_EQUAL(statistics.sizeErrors, 2);
+  BOOST_CHECK_EQUAL(statistics.counterGaps, 0);
+  BOOST_CHECK_EQUAL(statistics.bytes, PAGE_SIZE);
+  BOOST_CHECK_EQUAL(monitor.getLastPacketCounter(7), 9);
+}
+
+BOOST_AUTO_TEST_CASE(Resync)
+{
+  std::vector<uint32_t> buffer(2 * PAGE_SIZE / sizeof(uint32_t));
+  setRdh(buffer, 0, 0x100, 0, 10);
+  setRdh(buffer, 1, 0x100, 0, 20);
+
+  LinkIntegrityMonitor monitor;
+  monitor.checkPage(&buffer[0]);
+  monitor.resync(0);
+  BOOST_CHECK_EQUAL(monitor.getLastPacketCounter(0), -1);
+  BOOST_CHECK(monitor.checkPage(&buffer[PAGE_SIZE / 4]) == LinkIntegrityMonitor::Status::Ok);
+
+  monitor.reset();
+  BOOST_CHECK(monitor.getStatistics().empty());
+}
+
+BOOST_AUTO_TEST_CASE(Packed)
+{
+  std::vector<uint32_t> buffer(PAGE_SIZE / sizeof(uint32_t));
+  auto setPacket = [&](size_t offset, uint32_t memorySize, uint32_t offsetNext, uint32_t packetCounter) {
+    auto rdh = &buffer[offset / sizeof(uint32_t)];
+    rdh[2] = (memorySize << 16) | offsetNext;
+    rdh[3] = (packetCounter << 8) | 1;
+  };
+  setPacket(0, 0x100, 0x100, 0);
+  setPacket(0x100, 0x80, 0x80, 1);
+  setPacket(0x180, 0x80, PAGE_SIZE - 0x180, 2);
+
+  LinkIntegrityMonitor monitor(PAGE_SIZE, true);
+  BOOST_CHECK_EQUAL(monitor.checkSuperpage(buffer.data(), PAGE_SIZE), 0);
+  BOOST_CHECK_EQUAL(monitor.getLinkStatistics(1).packets, 3);
+  BOOST_CHECK_EQUAL(monitor.getLinkStatistics(1).bytes, 0x200);
+
+  // The second packet is larger than its offset, which ends the walk
+  setPacket(0x100, 0x90, 0x80, 1);
+  monitor.reset();
+  BOOST_CHECK_EQUAL(monitor.checkSuperpage(buffer.data(), PAGE_SIZE), 1);
+  BOOST_CHECK_EQUAL(monitor.getLinkStatistics(1).packets, 2);
+  BOOST_CHECK_EQUAL(monitor.getLinkStatistics(1).sizeErrors, 1);
+
+  // An offset past the superpage is an error as well
+  setPacket(0x100, 0x80, PAGE_SIZE, 1);
+  BOOST_CHECK(monitor.checkPacket(&buffer[0x40], PAGE_SIZE - 0x100) == LinkIntegrityMonitor::Status::SizeError);
+}
+
+} // Anonymous namespace
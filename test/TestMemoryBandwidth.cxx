@@ -0,0 +1,100 @@
+/// \file TestMemoryBandwidth.cxx
+/// \brief Test of the memory bandwidth functions
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestMemoryBandwidth
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "CommandLineUtilities/MemoryBandwidth.h"
+#include "ReadoutCard/Exception.h"
+#include "Utilities/AlignedAllocator.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+namespace bfs = boost::filesystem;
+
+namespace {
+using Buffer = std::vector<uint32_t, Utilities::CacheAlignedAllocator<uint32_t>>;
+
+/// Fake sysfs with the given NUMA node directory files
+struct FakeSysfs
+{
+    FakeSysfs()
+      : root(bfs::temp_directory_path() / bfs::unique_path())
+    {
+    }
+
+    ~FakeSysfs()
+    {
+      bfs::remove_all(root);
+    }
+
+    void write(const std::string& file, const std::string& content)
+    {
+      auto path = root / "devices/system/node" / file;
+      bfs::create_directories(path.parent_path());
+      std::ofstream(path.string()) << content << '\n';
+    }
+
+    bfs::path root;
+};
+
+BOOST_AUTO_TEST_CASE(Kernels)
+{
+  Buffer source(1024 + 4);
+  std::iota(source.begin(), source.end(), 0);
+  std::vector<uint64_t> words(source.size() / 2);
+  std::memcpy(words.data(), source.data(), words.size() * sizeof(uint64_t));
+  BOOST_CHECK_EQUAL(MemoryBandwidth::read(source.data(), source.size() * sizeof(uint32_t)),
+      std::accumulate(words.begin(), words.end(), uint64_t(0)));
+
+  Buffer destination(source.size(), 0);
+  MemoryBandwidth::writeNonTemporal(destination.data(), destination.size() * sizeof(uint32_t), 0xabcd1234);
+  for (auto value : destination) {
+    BOOST_REQUIRE_EQUAL(value, 0xabcd1234);
+  }
+
+  MemoryBandwidth::copy(destination.data(), source.data(), source.size() * sizeof(uint32_t));
+  BOOST_CHECK(destination == source);
+}
+
+BOOST_AUTO_TEST_CASE(Measure)
+{
+  Buffer buffer(1024 * 1024);
+  for (auto operation : {MemoryBandwidth::Operation::Read, MemoryBandwidth::Operation::NonTemporalWrite,
+      MemoryBandwidth::Operation::Copy}) {
+    BOOST_CHECK_GT(MemoryBandwidth::measure(operation, buffer.data(), buffer.size() * sizeof(uint32_t), {},
+        std::chrono::milliseconds(20)), 0);
+  }
+  // Every thread needs at least a cache line
+  BOOST_CHECK_THROW(MemoryBandwidth::measure(MemoryBandwidth::Operation::Read, buffer.data(), 64,
+      std::vector<int>(2, 0), std::chrono::milliseconds(1)), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(NumaNodes)
+{
+  FakeSysfs sysfs;
+  BOOST_CHECK(MemoryBandwidth::getNumaNodeCpus(sysfs.root.string()).empty());
+
+  sysfs.write("online", "0-1,3");
+  sysfs.write("node0/cpulist", "0-3,8-11");
+  sysfs.write("node1/cpulist", "4-7,12-15");
+  sysfs.write("node3/cpulist", "");
+  auto nodes = MemoryBandwidth::getNumaNodeCpus(sysfs.root.string());
+  BOOST_REQUIRE_EQUAL(nodes.size(), 3);
+  BOOST_CHECK((nodes[0] == std::vector<int>{0, 1, 2, 3, 8, 9, 10, 11}));
+  BOOST_CHECK((nodes[1] == std::vector<int>{4, 5, 6, 7, 12, 13, 14, 15}));
+  BOOST_CHECK(nodes[3].empty());
+
+  sysfs.write("online", "0-2");
+  BOOST_CHECK_THROW(MemoryBandwidth::getNumaNodeCpus(sysfs.root.string()), Exception);
+}
+} // Anonymous namespace
@@ -53,6 +53,26 @@ BOOST_AUTO_TEST_CASE(MemoryMappedFileTest)
   }
 }
 
+BOOST_AUTO_TEST_CASE(MemoryMappedFilePrefaultAndLock)
+{
+  {
+    MemoryMappedFile mmf(filePath.c_str(), fileSize);
+    auto data = static_cast<char*>(mmf.getAddress());
+    for (size_t i = 0; i < mmf.getSize(); ++i) {
+      data[i] = char(i % 127);
+    }
+  }
+
+  // Prefaulting and locking must not modify the contents
+  MemoryMappedFile mmf(filePath.c_str(), fileSize);
+  BOOST_CHECK_NO_THROW(mmf.prefault());
+  BOOST_CHECK_NO_THROW(mmf.lock());
+  auto data = static_cast<char*>(mmf.getAddress());
+  for (size_t i = 0; i < mmf.getSize(); ++i) {
+    BOOST_REQUIRE_EQUAL(data[i], char(i % 127));
+  }
+}
+
 BOOST_AUTO_TEST_CASE(MemoryMappedFileTest2)
 {
   BOOST_CHECK_THROW(MemoryMappedFile(badFilePath.c_str(), fileSize), MemoryMapException);
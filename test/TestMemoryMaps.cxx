@@ -0,0 +1,80 @@
+/// \file TestMemoryMaps.cxx
+/// \brief Test of the memory mapping inspection functions
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestMemoryMaps
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "Utilities/MemoryMaps.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+const size_t basePageSize = sysconf(_SC_PAGESIZE);
+
+/// Gets the VmFlags line of the mapping containing the address from /proc/self/smaps
+std::string getVmFlags(const void* address)
+{
+  const auto target = reinterpret_cast<uintptr_t>(address);
+  std::ifstream stream("/proc/self/smaps");
+  std::string line;
+  bool inMapping = false;
+  while (std::getline(stream, line)) {
+    auto dash = line.find('-');
+    auto space = line.find(' ');
+    if (dash < space && space != std::string::npos && line.find(':') > space) {
+      inMapping = target >= std::stoul(line.substr(0, dash), nullptr, 16)
+          && target < std::stoul(line.substr(dash + 1, space - dash - 1), nullptr, 16);
+    } else if (inMapping && line.find("VmFlags:") == 0) {
+      return line + " ";
+    }
+  }
+  return {};
+}
+
+BOOST_AUTO_TEST_CASE(PageSizeAnonymous)
+{
+  std::vector<char> heap(1024 * 1024);
+  auto pageSize = Utilities::getPageSize(heap.data());
+  BOOST_REQUIRE(pageSize);
+  BOOST_CHECK_EQUAL(*pageSize, basePageSize);
+
+  // Cached the second time, must give the same result
+  BOOST_CHECK_EQUAL(Utilities::getPageSize(heap.data()).get_value_or(0), basePageSize);
+}
+
+BOOST_AUTO_TEST_CASE(PageSizeFile)
+{
+  MemoryMappedFile file("/tmp/AliceO2_MemoryMaps_Test", 64 * 1024, true);
+  // An address in the middle of the mapping must be found as well as its start
+  auto middle = static_cast<char*>(file.getAddress()) + 32 * 1024;
+  BOOST_CHECK_EQUAL(Utilities::getPageSize(file.getAddress()).get_value_or(0), basePageSize);
+  BOOST_CHECK_EQUAL(Utilities::getPageSize(middle).get_value_or(0), basePageSize);
+}
+
+BOOST_AUTO_TEST_CASE(PageSizeUnmapped)
+{
+  BOOST_CHECK(!Utilities::getPageSize(nullptr));
+}
+
+BOOST_AUTO_TEST_CASE(ExcludeFromDumpAndFork)
+{
+  MemoryMappedFile file("/tmp/AliceO2_MemoryMaps_Test", 64 * 1024, true);
+  BOOST_CHECK_EQUAL(getVmFlags(file.getAddress()).find(" dd "), std::string::npos);
+  // An unaligned range is extended to whole pages
+  BOOST_REQUIRE(Utilities::excludeFromDumpAndFork(static_cast<char*>(file.getAddress()) + 100, 64 * 1024 - 200));
+  auto flags = getVmFlags(file.getAddress());
+  BOOST_CHECK_NE(flags.find(" dd "), std::string::npos);
+  BOOST_CHECK_NE(flags.find(" dc "), std::string::npos);
+  BOOST_CHECK(Utilities::excludeFromDumpAndFork(file.getAddress(), 0));
+}
+
+} // Anonymous namespace
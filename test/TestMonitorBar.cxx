@@ -0,0 +1,113 @@
+/// \file TestMonitorBar.cxx
+/// \brief Test of the MonitorBar and PcieBudget classes
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestMonitorBar
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "Dummy/DummyBar.h"
+#include "MonitorBar.h"
+#include "PcieBudget.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+const std::string BUDGET_PATH = PcieBudget::getPath("TestMonitorBar");
+
+struct RemoveBudgetFile
+{
+    RemoveBudgetFile()
+    {
+      boost::filesystem::remove(BUDGET_PATH);
+    }
+
+    ~RemoveBudgetFile()
+    {
+      boost::filesystem::remove(BUDGET_PATH);
+    }
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+BOOST_AUTO_TEST_CASE(Whitelist)
+{
+  RemoveBudgetFile remove;
+  auto dummy = std::make_shared<DummyBar>(Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0));
+  dummy->writeRegister(3, 33);
+  dummy->writeRegister(4, 44);
+  dummy->writeRegister(8, 88);
+  MonitorBar bar(dummy, {3, 4, 8}, std::make_shared<PcieBudget>(BUDGET_PATH, 1024 * 1024, 1024 * 1024));
+
+  BOOST_CHECK_EQUAL(bar.readRegister(3), 33);
+  BOOST_CHECK_THROW(bar.readRegister(5), UnsafeReadAccess);
+  BOOST_CHECK_THROW(bar.writeRegister(3, 0), UnsafeWriteAccess);
+  BOOST_CHECK_EQUAL(dummy->readRegister(3), 33);
+
+  uint32_t values[3] = {};
+  bar.readRegisters(3, values, 2);
+  BOOST_CHECK_EQUAL(values[0], 33);
+  BOOST_CHECK_EQUAL(values[1], 44);
+  BOOST_CHECK_THROW(bar.readRegisters(3, values, 3), UnsafeReadAccess);
+
+  const int indexes[] = {3, 4, 8};
+  bar.readRegisterSet(indexes, values, 3);
+  BOOST_CHECK_EQUAL(values[0], 33);
+  BOOST_CHECK_EQUAL(values[1], 44);
+  BOOST_CHECK_EQUAL(values[2], 88);
+}
+
+BOOST_AUTO_TEST_CASE(Budget)
+{
+  RemoveBudgetFile remove;
+  // 20 reads per second, with a burst of 2
+  constexpr size_t READS_PER_SECOND = 20;
+  auto budget = std::make_shared<PcieBudget>(BUDGET_PATH, READS_PER_SECOND * MonitorBar::REGISTER_READ_COST,
+      2 * MonitorBar::REGISTER_READ_COST);
+  auto dummy = std::make_shared<DummyBar>(Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0));
+  MonitorBar bar(dummy, {0, 1}, budget);
+
+  // The first reads are within the burst, the rest is paced
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 12; ++i) {
+    bar.readRegister(i % 2);
+  }
+  auto seconds = secondsSince(start);
+  BOOST_CHECK_GE(seconds, 0.45);
+  BOOST_CHECK_LT(seconds, 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(SharedBudget)
+{
+  RemoveBudgetFile remove;
+  // Two budgets on the same file, as in two processes, pace each other
+  constexpr size_t BYTES_PER_SECOND = 1000;
+  PcieBudget a(BUDGET_PATH, BYTES_PER_SECOND, 0);
+  PcieBudget b(BUDGET_PATH, BYTES_PER_SECOND, 0);
+  BOOST_CHECK_EQUAL(a.reserve(100).count(), 100 * 1000 * 1000);
+  auto wait = b.reserve(100);
+  BOOST_CHECK_GT(wait.count(), 150 * 1000 * 1000);
+  BOOST_CHECK_LE(wait.count(), 200 * 1000 * 1000);
+}
+
+BOOST_AUTO_TEST_CASE(Factory)
+{
+  RemoveBudgetFile remove;
+  auto bar = ChannelFactory().getMonitorBar(Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0)
+      .setMonitorRegisters({2}));
+  BOOST_CHECK_NO_THROW(bar->readRegister(2));
+  BOOST_CHECK_THROW(bar->readRegister(1), UnsafeReadAccess);
+  BOOST_CHECK_THROW(bar->writeRegister(2, 1), UnsafeWriteAccess);
+  boost::filesystem::remove(PcieBudget::getPath("Dummy"));
+}
+
+} // Anonymous namespace
@@ -0,0 +1,89 @@
+/// \file TestPageChecksum.cxx
+/// \brief Tests for the PageChecksum class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestPageChecksum
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/LinkIntegrityMonitor.h"
+#include "ReadoutCard/PageChecksum.h"
+
+using namespace AliceO2::roc;
+
+namespace {
+
+/// Bit-by-bit CRC32C, to check the kernels against
+uint32_t referenceCrc(const uint8_t* data, size_t size)
+{
+  uint32_t crc = ~0u;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+std::vector<uint8_t> makeData(size_t size)
+{
+  std::mt19937 random(size);
+  std::vector<uint8_t> data(size);
+  for (auto& byte : data) {
+    byte = uint8_t(random());
+  }
+  return data;
+}
+
+BOOST_AUTO_TEST_CASE(KnownValue)
+{
+  const char data[] = "123456789";
+  BOOST_CHECK_EQUAL(PageChecksum::compute(data, 9), 0xe3069283);
+  BOOST_CHECK_EQUAL(PageChecksum::compute(data, 0), 0);
+  BOOST_TEST_MESSAGE("Implementation: " << PageChecksum::getImplementation());
+}
+
+BOOST_AUTO_TEST_CASE(MatchesReference)
+{
+  // Sizes and offsets around the interleaved blocks and the word alignment
+  const auto data = makeData(8 * 1024 + 16);
+  for (size_t size : {1, 7, 8, 767, 768, 769, 1536, 4000, 8192}) {
+    for (size_t offset : {0, 1, 3, 8}) {
+      BOOST_CHECK_EQUAL(PageChecksum::compute(&data[offset], size), referenceCrc(&data[offset], size));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(InPieces)
+{
+  const auto data = makeData(5000);
+  auto crc = PageChecksum::compute(&data[0], 1234);
+  crc = PageChecksum::compute(&data[1234], data.size() - 1234, crc);
+  BOOST_CHECK_EQUAL(crc, PageChecksum::compute(data.data(), data.size()));
+}
+
+BOOST_AUTO_TEST_CASE(Pages)
+{
+  constexpr size_t pageSize = LinkIntegrityMonitor::DMA_PAGE_SIZE;
+  auto data = makeData(4 * pageSize);
+  std::vector<uint32_t> checksums(4);
+  // The last page is incomplete, so it has no checksum
+  BOOST_CHECK_EQUAL(PageChecksum::computePages(data.data(), data.size() - 1, pageSize, checksums.data()), 3);
+  BOOST_CHECK_EQUAL(PageChecksum::findMismatch(data.data(), data.size() - 1, pageSize, checksums.data()), 3);
+
+  // The monitor computes the same checksums while checking the pages
+  std::vector<uint32_t> monitorChecksums(4);
+  LinkIntegrityMonitor monitor;
+  monitor.checkSuperpage(data.data(), data.size(), monitorChecksums.data());
+  BOOST_CHECK_EQUAL_COLLECTIONS(checksums.begin(), checksums.begin() + 3, monitorChecksums.begin(),
+      monitorChecksums.begin() + 3);
+
+  data[2 * pageSize + 100] ^= 0x10;
+  BOOST_CHECK_EQUAL(PageChecksum::findMismatch(data.data(), data.size(), pageSize, monitorChecksums.data()), 2);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,108 @@
+/// \file TestPciLink.cxx
+/// \brief Test of the PCIe link functions
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestPciLink
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "ReadoutCard/Exception.h"
+#include "Utilities/PciLink.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::Utilities;
+
+namespace {
+
+/// Makes a configuration space with a power management capability at 0x40, followed by the PCI Express capability
+/// at 0x60 with the given device capabilities and control registers
+std::vector<uint8_t> makeConfig(uint16_t deviceCapabilities, uint16_t deviceControl)
+{
+  std::vector<uint8_t> config(0x100, 0);
+  config[0x06] = 0x10;
+  config[0x34] = 0x40;
+  config[0x40] = 0x01;
+  config[0x41] = 0x60;
+  config[0x60] = 0x10;
+  config[0x64] = deviceCapabilities & 0xff;
+  config[0x65] = deviceCapabilities >> 8;
+  config[0x68] = deviceControl & 0xff;
+  config[0x69] = deviceControl >> 8;
+  return config;
+}
+
+PciLinkStatus makeStatus()
+{
+  // A CRU on a healthy gen3 x16 link
+  PciLinkStatus status;
+  status.currentSpeed = 8;
+  status.maxSpeed = 8;
+  status.currentWidth = 16;
+  status.maxWidth = 16;
+  status.maxPayloadSize = 256;
+  status.maxPayloadSizeSupported = 256;
+  status.maxReadRequestSize = 512;
+  return status;
+}
+
+BOOST_AUTO_TEST_CASE(ParseSpeed)
+{
+  BOOST_CHECK_EQUAL(parsePciLinkSpeed("8 GT/s"), 8.0);
+  BOOST_CHECK_EQUAL(parsePciLinkSpeed("8.0 GT/s PCIe"), 8.0);
+  BOOST_CHECK_EQUAL(parsePciLinkSpeed("2.5 GT/s"), 2.5);
+  BOOST_CHECK_EQUAL(parsePciLinkSpeed("Unknown"), 0.0);
+  BOOST_CHECK_EQUAL(parsePciLinkSpeed("8 Gb/s"), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(ParseCapability)
+{
+  // Supports 512 bytes payload, set to 256 bytes payload and 1024 bytes read requests
+  auto capability = parsePciExpressCapability(makeConfig(0x2, (0x1 << 5) | (0x3 << 12)));
+  BOOST_CHECK_EQUAL(capability.maxPayloadSizeSupported, 512);
+  BOOST_CHECK_EQUAL(capability.maxPayloadSize, 256);
+  BOOST_CHECK_EQUAL(capability.maxReadRequestSize, 1024);
+}
+
+BOOST_AUTO_TEST_CASE(ParseCapabilityMissing)
+{
+  auto config = makeConfig(0, 0);
+  config[0x60] = 0x05;
+  BOOST_CHECK_THROW(parsePciExpressCapability(config), Exception);
+
+  // A list pointing at itself must not loop forever
+  config[0x41] = 0x40;
+  BOOST_CHECK_THROW(parsePciExpressCapability(config), Exception);
+
+  BOOST_CHECK_THROW(parsePciExpressCapability(std::vector<uint8_t>(0x40, 0)), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(Bandwidth)
+{
+  // Gen1 and gen2 use 8b/10b, gen3 and up 128b/130b
+  BOOST_CHECK_CLOSE(getPciLinkBandwidth(2.5, 8), 16.0, 0.001);
+  BOOST_CHECK_CLOSE(getPciLinkBandwidth(5, 8), 32.0, 0.001);
+  BOOST_CHECK_CLOSE(getPciLinkBandwidth(8, 16), 128.0 * 128.0 / 130.0, 0.001);
+  BOOST_CHECK_CLOSE(getPciPayloadEfficiency(256), 256.0 / 280.0, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(AuditHealthy)
+{
+  // 24 GBT links at 4.8 Gb/s fit in a gen3 x16 link
+  BOOST_CHECK(auditPciLink(makeStatus(), 24 * 4.8).empty());
+  BOOST_CHECK(auditPciLink(makeStatus(), 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(AuditDegraded)
+{
+  auto status = makeStatus();
+  status.currentSpeed = 2.5;
+  status.currentWidth = 8;
+  status.maxPayloadSizeSupported = 512;
+  status.maxReadRequestSize = 128;
+  // Speed, width, payload size, read request size, and the links exceeding the 8x2.5 GT/s link
+  BOOST_CHECK_EQUAL(auditPciLink(status, 24 * 4.8).size(), 5);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,57 @@
+/// \file TestPdaBarStatistics.cxx
+/// \brief Test of the PdaBarStatistics class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestPdaBarStatistics
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include "Pda/PdaBarStatistics.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+RegisterAccessStatistics find(const BarStatistics& statistics, uintptr_t address)
+{
+  auto iter = std::find_if(statistics.begin(), statistics.end(),
+      [&](const RegisterAccessStatistics& s) { return s.address == address; });
+  BOOST_REQUIRE(iter != statistics.end());
+  return *iter;
+}
+
+BOOST_AUTO_TEST_CASE(CountAccesses)
+{
+  Pda::PdaBarStatistics counters(2);
+  BOOST_CHECK(counters.get().empty());
+
+  counters.addReads(0x10, 1, 100);
+  counters.addReads(0x10, 1, 100);
+  counters.addWrites(0x10, 1, 50);
+  counters.addReads(0x20, 4, 400);
+
+  auto statistics = counters.get();
+  BOOST_CHECK_EQUAL(statistics.size(), 5);
+
+  auto reg = find(statistics, 0x10 * 4);
+  BOOST_CHECK_EQUAL(reg.barIndex, 2);
+  BOOST_CHECK_EQUAL(reg.reads, 2);
+  BOOST_CHECK_EQUAL(reg.writes, 1);
+  BOOST_CHECK_EQUAL(reg.cycles, 250);
+
+  auto blockReg = find(statistics, 0x23 * 4);
+  BOOST_CHECK_EQUAL(blockReg.reads, 1);
+  BOOST_CHECK_EQUAL(blockReg.cycles, 100);
+}
+
+BOOST_AUTO_TEST_CASE(TableFull)
+{
+  Pda::PdaBarStatistics counters(0);
+  // More distinct registers than the table holds must not fail, the excess is just not counted
+  counters.addWrites(0, 10000, 0);
+  BOOST_CHECK_EQUAL(counters.get().size(), 4096);
+}
+
+} // Anonymous namespace
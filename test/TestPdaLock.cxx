@@ -0,0 +1,47 @@
+/// \file TestPdaLock.cxx
+/// \brief Test of the PdaLock class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestPdaLock
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstdlib>
+#include <boost/test/unit_test.hpp>
+#include "Pda/PdaLock.h"
+#include "ReadoutCard/Exception.h"
+
+namespace {
+
+using namespace ::AliceO2::roc;
+
+const PciAddress addressA("42:00.0");
+const PciAddress addressB("43:00.0");
+
+BOOST_AUTO_TEST_CASE(PerDevice)
+{
+  unsetenv("ALICEO2_READOUTCARD_PDA_GLOBAL_LOCK");
+  Pda::PdaLock lockA(addressA, false);
+  // Another device has its own lock
+  BOOST_CHECK_NO_THROW(Pda::PdaLock(addressB, false));
+  // The same device is locked
+  BOOST_CHECK_THROW(Pda::PdaLock(addressA, false), LockException);
+  // The global lock is separate
+  BOOST_CHECK_NO_THROW(Pda::PdaLock(false));
+}
+
+BOOST_AUTO_TEST_CASE(GlobalForced)
+{
+  setenv("ALICEO2_READOUTCARD_PDA_GLOBAL_LOCK", "1", 1);
+  BOOST_CHECK(Pda::PdaLock::isGlobalLockForced());
+  {
+    Pda::PdaLock lockA(addressA, false);
+    BOOST_CHECK_THROW(Pda::PdaLock(addressB, false), LockException);
+    BOOST_CHECK_THROW(Pda::PdaLock(false), LockException);
+  }
+  setenv("ALICEO2_READOUTCARD_PDA_GLOBAL_LOCK", "0", 1);
+  BOOST_CHECK(!Pda::PdaLock::isGlobalLockForced());
+  unsetenv("ALICEO2_READOUTCARD_PDA_GLOBAL_LOCK");
+}
+
+} // Anonymous namespace
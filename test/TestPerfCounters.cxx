@@ -0,0 +1,50 @@
+/// \file TestPerfCounters.cxx
+/// \brief Test of the PerfCounters class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestPerfCounters
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/PerfCounters.h"
+
+using namespace ::AliceO2::roc::CommandLineUtilities;
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(CountsThread)
+{
+  // Which events are counted depends on the machine, so only the ones that are can be checked
+  PerfCounters counters;
+  for (int i = 0; i < 3; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto counts = counters.read();
+  if (counts.contextSwitches) {
+    BOOST_CHECK_GE(*counts.contextSwitches, 3);
+  }
+  if (counts.cycles) {
+    BOOST_CHECK_GT(*counts.cycles, 0);
+  }
+
+  auto later = counters.read();
+  if (counts.instructions && later.instructions) {
+    BOOST_CHECK_GE(*later.instructions, *counts.instructions);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AddCounts)
+{
+  PerfCounters::Counts sum;
+  PerfCounters::Counts counts;
+  counts.cycles = 10;
+  sum += counts;
+  sum += counts;
+  BOOST_CHECK_EQUAL(sum.cycles.value_or(0), 20);
+  BOOST_CHECK(!sum.instructions);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,62 @@
+/// \file TestRegisterField.cxx
+/// \brief Test of the RegisterField struct
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestRegisterField
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Cru/Constants.h"
+#include "RegisterField.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr Register REGISTER(0x600);
+constexpr RegisterField LOW(REGISTER, 0, 4);
+constexpr RegisterField HIGH(REGISTER, 28, 4);
+constexpr RegisterField WHOLE(REGISTER, 0, 32);
+
+// The descriptors and combined values are folded by the compiler
+static_assert(LOW.mask() == 0xf, "");
+static_assert(HIGH.mask() == 0xf0000000, "");
+static_assert(WHOLE.mask() == 0xffffffff, "");
+static_assert(HIGH.get(0xa0000005) == 0xa, "");
+static_assert((LOW(0x3) | HIGH(0xc)).mask == 0xf000000f, "");
+static_assert((LOW(0x3) | HIGH(0xc)).bits == 0xc0000003, "");
+static_assert((LOW(0x3) | HIGH(0xc)).apply(0x12345678) == 0xc2345673, "");
+
+BOOST_AUTO_TEST_CASE(GetSet)
+{
+  BOOST_CHECK_EQUAL(LOW.get(0x12345678), 0x8);
+  BOOST_CHECK_EQUAL(LOW.set(0x12345678, 0x1), 0x12345671);
+  // Bits that don't fit are dropped
+  BOOST_CHECK_EQUAL(LOW.set(0x12345678, 0x31), 0x12345671);
+  BOOST_CHECK_EQUAL(WHOLE.set(0x12345678, 0xdeadbeef), 0xdeadbeef);
+  BOOST_CHECK_EQUAL(HIGH.set(0, 0xf), 0xf0000000);
+}
+
+BOOST_AUTO_TEST_CASE(Combine)
+{
+  // A later value of the same field replaces an earlier one
+  auto values = LOW(0x1) | HIGH(0x2) | LOW(0x4);
+  BOOST_CHECK_EQUAL(values.reg.index, REGISTER.index);
+  BOOST_CHECK_EQUAL(values.apply(0xffffffff), 0x2ffffff4);
+
+  const RegisterField other(Register(0x604), 0, 1);
+  BOOST_CHECK_THROW(LOW(0x1) | other(0x1), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(CruDataGenerator)
+{
+  using namespace Cru::Registers;
+  // Enabled, incremental pattern, 8 KiB, random size
+  auto values = DATA_GENERATOR_ENABLE(1) | DATA_GENERATOR_PATTERN(DATA_GENERATOR_PATTERN_INCREMENTAL)
+      | DATA_GENERATOR_SIZE(255) | DATA_GENERATOR_RANDOM_SIZE(1);
+  BOOST_CHECK_EQUAL(values.reg.index, DATA_GENERATOR_CONTROL.index);
+  BOOST_CHECK_EQUAL(values.apply(0), 0x1ff03);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,111 @@
+/// \file TestRegisterScript.cxx
+/// \brief Test of the RegisterScript class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestRegisterScript
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/RegisterScript.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+
+namespace {
+
+/// Records the accesses, every block is one access
+class FakeBar : public RegisterReadWriteInterface
+{
+  public:
+    virtual uint32_t readRegister(int index) override
+    {
+      accesses.push_back({"read", index});
+      return registers[index];
+    }
+
+    virtual void writeRegister(int index, uint32_t value) override
+    {
+      accesses.push_back({"write", index});
+      registers[index] = value;
+    }
+
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count) override
+    {
+      accesses.push_back({"readBlock", startIndex});
+      for (size_t i = 0; i < count; ++i) {
+        values[i] = registers[startIndex + i];
+      }
+    }
+
+    virtual void writeRegisters(int startIndex, const uint32_t* values, size_t count) override
+    {
+      accesses.push_back({"writeBlock", startIndex});
+      for (size_t i = 0; i < count; ++i) {
+        registers[startIndex + i] = values[i];
+      }
+    }
+
+    std::map<int, uint32_t> registers;
+    std::vector<std::pair<std::string, int>> accesses;
+};
+
+RegisterScript parse(const std::string& string)
+{
+  std::istringstream stream(string);
+  return RegisterScript::parse(stream);
+}
+
+BOOST_AUTO_TEST_CASE(Execute)
+{
+  auto script = parse(
+      "# Configure\n"
+      "write 0x600 1\n"
+      "write 0x604 0x2   # Same block\n"
+      "write 0x608 3\n"
+      "\n"
+      "write 0x700 4\n"
+      "modify 0x600 0xf0 0xf0\n"
+      "wait 0\n"
+      "read 0x600 3\n"
+      "read 0x700\n");
+  BOOST_CHECK_EQUAL(script.getOperations().size(), 8);
+
+  FakeBar bar;
+  auto results = script.execute(bar);
+  std::vector<std::pair<std::string, int>> expected {{"writeBlock", 0x600 / 4}, {"writeBlock", 0x700 / 4},
+      {"read", 0x600 / 4}, {"write", 0x600 / 4}, {"readBlock", 0x600 / 4}, {"readBlock", 0x700 / 4}};
+  BOOST_CHECK(bar.accesses == expected);
+
+  BOOST_REQUIRE_EQUAL(results.size(), 2);
+  BOOST_CHECK_EQUAL(results[0].line, 9);
+  BOOST_CHECK_EQUAL(results[0].address, 0x600);
+  BOOST_CHECK(results[0].values == std::vector<uint32_t>({0xf1, 2, 3}));
+  BOOST_CHECK(results[1].values == std::vector<uint32_t>({4}));
+
+  std::ostringstream json;
+  RegisterScript::writeJson(json, results);
+  BOOST_CHECK_EQUAL(json.str(), "{\"line\":9,\"address\":1536,\"values\":[241,2,3]}\n"
+      "{\"line\":10,\"address\":1792,\"values\":[4]}\n");
+
+  std::ostringstream binary;
+  RegisterScript::writeBinary(binary, results);
+  BOOST_CHECK_EQUAL(binary.str().size(), 4 * sizeof(uint32_t));
+}
+
+BOOST_AUTO_TEST_CASE(ParseErrors)
+{
+  for (auto line : {"frobnicate 0x0", "read", "read 0x2", "read 0x0 0", "write 0x0", "write 0x0 0x1ffffffff",
+      "write 0x0 -1", "modify 0x0 1", "wait 10us"}) {
+    BOOST_CHECK_THROW(parse(std::string("write 0x0 1\n") + line), ParseException);
+  }
+  BOOST_CHECK_NO_THROW(parse("  read 0x4 2  \n\n# Only a comment\nwrite 0x4 0xFFFFFFFF\n"));
+}
+
+} // Anonymous namespace
@@ -0,0 +1,57 @@
+/// \file TestScatterGatherIndex.cxx
+/// \brief Test of the ScatterGatherIndex class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestScatterGatherIndex
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Pda/ScatterGatherIndex.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::Pda;
+
+namespace {
+
+constexpr uintptr_t USER = 0x7f0000000000;
+
+BOOST_AUTO_TEST_CASE(Uniform)
+{
+  // Entries out of order, the last one smaller
+  ScatterGatherVector list {
+    {0x1000, USER + 0x1000, 0x80000, 0},
+    {0x1000, USER, 0x20000, 0},
+    {0x800, USER + 0x2000, 0x50000, 0},
+  };
+  ScatterGatherIndex index(list);
+  BOOST_CHECK(index.isUniform());
+  BOOST_CHECK_EQUAL(index.getBusOffsetAddress(0), 0x20000);
+  BOOST_CHECK_EQUAL(index.getBusOffsetAddress(0xfff), 0x20fff);
+  BOOST_CHECK_EQUAL(index.getBusOffsetAddress(0x1000), 0x80000);
+  BOOST_CHECK_EQUAL(index.getBusOffsetAddress(0x27ff), 0x507ff);
+  BOOST_CHECK_THROW(index.getBusOffsetAddress(0x2800), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(NonUniform)
+{
+  ScatterGatherVector list {
+    {0x2000, USER + 0x1000, 0x80000, 0},
+    {0x1000, USER, 0x20000, 0},
+    {0x1000, USER + 0x3000, 0x50000, 0},
+  };
+  ScatterGatherIndex index(list);
+  BOOST_CHECK(!index.isUniform());
+  BOOST_CHECK_EQUAL(index.getBusOffsetAddress(0x800), 0x20800);
+  BOOST_CHECK_EQUAL(index.getBusOffsetAddress(0x2fff), 0x81fff);
+  BOOST_CHECK_EQUAL(index.getBusOffsetAddress(0x3000), 0x50000);
+  BOOST_CHECK_THROW(index.getBusOffsetAddress(0x4000), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+  ScatterGatherIndex index;
+  BOOST_CHECK_THROW(index.getBusOffsetAddress(0), std::exception);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,135 @@
+/// \file TestSharedMemoryBuffer.cxx
+/// \brief Test of the SharedMemoryBuffer class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSharedMemoryBuffer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SharedMemoryBuffer.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+const std::string name("TestSharedMemoryBuffer");
+const std::string bufferPath("/tmp/AliceO2_SharedMemoryBuffer_Test");
+constexpr size_t BUFFER_SIZE = 1024 * 1024;
+constexpr size_t SUPERPAGE_SIZE = 64 * 1024;
+constexpr size_t RING_CAPACITY = 4;
+
+BOOST_AUTO_TEST_CASE(PublishAndReturn)
+{
+  SharedMemoryBuffer driver(name, bufferPath, BUFFER_SIZE, RING_CAPACITY);
+  SharedMemoryBuffer consumer(name);
+  BOOST_CHECK_EQUAL(consumer.getSize(), BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(consumer.getRingCapacity(), RING_CAPACITY);
+  BOOST_CHECK_EQUAL(driver.getBufferParameters().address, driver.getAddress());
+
+  // Data written through the driver's mapping is visible through the consumer's, without a copy
+  std::strcpy(static_cast<char*>(driver.getAddress()) + SUPERPAGE_SIZE, "Hello");
+  Superpage arrived(SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+  arrived.setReceived(6);
+  arrived.setLinkId(3);
+  BOOST_REQUIRE(driver.pushReady(arrived));
+
+  Superpage superpage;
+  BOOST_REQUIRE(consumer.popReady(superpage));
+  BOOST_CHECK(superpage.isReady());
+  BOOST_CHECK_EQUAL(superpage.getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(superpage.getReceived(), 6);
+  BOOST_CHECK_EQUAL(superpage.getLinkId(), 3);
+  BOOST_CHECK_EQUAL(static_cast<const char*>(consumer.getAddress()) + superpage.getOffset(), "Hello");
+  BOOST_CHECK(!consumer.popReady(superpage));
+
+  BOOST_REQUIRE(consumer.pushFree(superpage));
+  Superpage returned;
+  BOOST_REQUIRE(driver.popFree(returned));
+  BOOST_CHECK_EQUAL(returned.getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(returned.getSize(), SUPERPAGE_SIZE);
+  BOOST_CHECK(!driver.popFree(returned));
+}
+
+BOOST_AUTO_TEST_CASE(RingFull)
+{
+  SharedMemoryBuffer driver(name, bufferPath, BUFFER_SIZE, RING_CAPACITY);
+  SharedMemoryBuffer consumer(name);
+
+  // Wrap around the ring a few times
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < RING_CAPACITY; ++i) {
+      BOOST_REQUIRE(driver.pushReady(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE)));
+    }
+    BOOST_CHECK(!driver.pushReady(Superpage(0, SUPERPAGE_SIZE)));
+    for (size_t i = 0; i < RING_CAPACITY; ++i) {
+      Superpage superpage;
+      BOOST_REQUIRE(consumer.popReady(superpage));
+      BOOST_CHECK_EQUAL(superpage.getOffset(), i * SUPERPAGE_SIZE);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Attach)
+{
+  SharedMemoryBuffer driver(name, bufferPath, BUFFER_SIZE, RING_CAPACITY);
+  BOOST_CHECK(!driver.acceptAttach());
+
+  // The first consumer takes one superpage and leaves another in the ready ring, then goes away
+  {
+    SharedMemoryBuffer consumer(name);
+    BOOST_REQUIRE(driver.pushReady(Superpage(0, SUPERPAGE_SIZE)));
+    BOOST_REQUIRE(driver.pushReady(Superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE)));
+    Superpage superpage;
+    BOOST_REQUIRE(consumer.popReady(superpage));
+  }
+
+  // Nobody accepts, so the request times out
+  SharedMemoryBuffer consumer(name);
+  BOOST_CHECK(!consumer.attach(std::chrono::milliseconds(1)));
+
+  // The driver accepts the next one from its loop, which empties the rings
+  std::atomic<bool> accepted(false);
+  std::thread driverThread([&]{
+    auto start = std::chrono::steady_clock::now();
+    while (!accepted && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+      accepted = driver.acceptAttach();
+    }
+  });
+  BOOST_CHECK(consumer.attach(std::chrono::seconds(5)));
+  driverThread.join();
+  BOOST_CHECK(accepted);
+  BOOST_CHECK(!driver.acceptAttach());
+
+  Superpage superpage;
+  BOOST_CHECK(!consumer.popReady(superpage));
+  BOOST_CHECK(!driver.popFree(superpage));
+
+  // The rings work as before
+  BOOST_REQUIRE(driver.pushReady(Superpage(2 * SUPERPAGE_SIZE, SUPERPAGE_SIZE)));
+  BOOST_REQUIRE(consumer.popReady(superpage));
+  BOOST_CHECK_EQUAL(superpage.getOffset(), 2 * SUPERPAGE_SIZE);
+  BOOST_REQUIRE(consumer.pushFree(superpage));
+  BOOST_REQUIRE(driver.popFree(superpage));
+  BOOST_CHECK_EQUAL(superpage.getOffset(), 2 * SUPERPAGE_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(AttachMissing)
+{
+  BOOST_CHECK_THROW(SharedMemoryBuffer("TestSharedMemoryBufferMissing"), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(FilesRemoved)
+{
+  {
+    SharedMemoryBuffer driver(name, bufferPath, BUFFER_SIZE, RING_CAPACITY);
+  }
+  BOOST_CHECK_THROW(SharedMemoryBuffer{name}, Exception);
+}
+
+} // Anonymous namespace
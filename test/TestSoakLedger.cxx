@@ -0,0 +1,73 @@
+/// \file TestSoakLedger.cxx
+/// \brief Test of the SoakLedger class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSoakLedger
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/SoakLedger.h"
+
+using namespace ::AliceO2::roc::CommandLineUtilities;
+
+namespace {
+
+constexpr size_t SIZE = 1024;
+
+BOOST_AUTO_TEST_CASE(Cycle)
+{
+  SoakLedger ledger(4, SIZE);
+  BOOST_CHECK(ledger.pushed(0));
+  BOOST_CHECK(ledger.pushed(SIZE));
+  BOOST_CHECK_EQUAL(ledger.getOnCard(), 2);
+  BOOST_CHECK(ledger.arrived(SIZE));
+  BOOST_CHECK_EQUAL(ledger.getOnCard(), 1);
+  ledger.returned(SIZE);
+  BOOST_CHECK(ledger.pushed(SIZE));
+  BOOST_CHECK_EQUAL(ledger.getDuplicated(), 0);
+  BOOST_CHECK_EQUAL(ledger.getBadPushes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Duplicate)
+{
+  SoakLedger ledger(4, SIZE);
+  ledger.pushed(0);
+  BOOST_CHECK(ledger.arrived(0));
+  BOOST_CHECK(!ledger.arrived(0));
+  // Never pushed, and not a superpage of the buffer
+  BOOST_CHECK(!ledger.arrived(2 * SIZE));
+  BOOST_CHECK(!ledger.arrived(SIZE / 2));
+  BOOST_CHECK(!ledger.arrived(4 * SIZE));
+  BOOST_CHECK_EQUAL(ledger.getDuplicated(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(BadPush)
+{
+  SoakLedger ledger(4, SIZE);
+  ledger.pushed(0);
+  BOOST_CHECK(!ledger.pushed(0));
+  ledger.arrived(0);
+  // Not returned by the consumer yet
+  BOOST_CHECK(!ledger.pushed(0));
+  BOOST_CHECK_EQUAL(ledger.getBadPushes(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Reconcile)
+{
+  SoakLedger ledger(4, SIZE);
+  ledger.pushed(0);
+  ledger.pushed(SIZE);
+  ledger.pushed(3 * SIZE);
+  ledger.arrived(SIZE);
+  auto lost = ledger.reconcile();
+  BOOST_CHECK((lost == std::vector<size_t>{0, 3 * SIZE}));
+  BOOST_CHECK_EQUAL(ledger.getLost(), 2);
+  BOOST_CHECK_EQUAL(ledger.getOnCard(), 0);
+  // The lost superpages are free again
+  BOOST_CHECK(ledger.pushed(0));
+  BOOST_CHECK(ledger.reconcile().size() == 1);
+  BOOST_CHECK_EQUAL(ledger.getLost(), 3);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,170 @@
+/// \file TestSteadyStateAllocations.cxx
+/// \brief Test that the steady state of the push, fill and pop loop does not allocate
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSteadyStateAllocations
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define ALICEO2_READOUTCARD_ALLOCATION_HOOK
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "Cru/LinkScheduler.h"
+#include "DriverThreadDmaChannel.h"
+#include "Dummy/DummyDmaChannel.h"
+#include "FakeDmaChannel.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "SuperpageQueue.h"
+#include "Utilities/AllocationCounter.h"
+
+using namespace ::AliceO2::roc;
+using Utilities::AllocationCounter;
+using Utilities::AllocationScope;
+
+namespace {
+
+constexpr size_t SUPERPAGE_SIZE = 32 * 1024;
+constexpr size_t SUPERPAGES = 8;
+/// Cycles run before counting, so queues and lazily initialized state reach their steady size
+constexpr int WARM_UP_CYCLES = 4;
+constexpr int CYCLES = 1000;
+
+BOOST_AUTO_TEST_CASE(Hook)
+{
+  BOOST_REQUIRE(AllocationCounter::isEnabled());
+  AllocationScope scope;
+  auto value = std::make_unique<int>(1);
+  std::vector<char> vector(100);
+  BOOST_CHECK_EQUAL(scope.get(), 2);
+
+  // Counted per thread
+  std::thread([]{ std::make_unique<int>(1); }).join();
+  BOOST_CHECK_LE(scope.get(), 3);
+}
+
+/// The queue of the C-RORC channel
+BOOST_AUTO_TEST_CASE(SuperpageQueueCycle)
+{
+  SuperpageQueue queue(SUPERPAGES);
+  auto cycle = [&]{
+    for (size_t i = 0; i < SUPERPAGES; ++i) {
+      SuperpageQueue::SuperpageQueueEntry entry;
+      entry.maxPages = 1;
+      entry.superpage = Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+      queue.addToQueue(entry);
+    }
+    while (!queue.getPushing().empty()) {
+      queue.getPushingFrontEntry().pushedPages = 1;
+      queue.removeFromPushingQueue();
+      queue.getArrivalsFrontEntry().superpage.setReady(true);
+      queue.moveFromArrivalsToFilledQueue();
+    }
+    while (!queue.getFilled().empty()) {
+      queue.removeFromFilledQueue();
+    }
+  };
+
+  for (int i = 0; i < WARM_UP_CYCLES; ++i) {
+    cycle();
+  }
+  AllocationScope scope;
+  for (int i = 0; i < CYCLES; ++i) {
+    cycle();
+  }
+  BOOST_CHECK_EQUAL(scope.get(), 0);
+}
+
+/// The link scheduling of the CRU channel
+BOOST_AUTO_TEST_CASE(LinkSchedulerCycle)
+{
+  for (auto policy : {LinkScheduling::ShortestQueue, LinkScheduling::Throughput}) {
+    Cru::LinkScheduler scheduler(policy, 4, SUPERPAGES);
+    std::vector<Cru::LinkScheduler::LinkIndex> pushed;
+    pushed.reserve(SUPERPAGES);
+    auto cycle = [&]{
+      for (size_t i = 0; i < SUPERPAGES; ++i) {
+        pushed.push_back(scheduler.getNextLinkIndex());
+        scheduler.pushed(pushed.back());
+      }
+      for (auto link : pushed) {
+        scheduler.arrived(link);
+      }
+      pushed.clear();
+    };
+
+    for (int i = 0; i < WARM_UP_CYCLES; ++i) {
+      cycle();
+    }
+    AllocationScope scope;
+    for (int i = 0; i < CYCLES; ++i) {
+      cycle();
+    }
+    BOOST_CHECK_EQUAL(scope.get(), 0);
+  }
+}
+
+/// Pushes, fills and pops the superpages of the buffer until they all came back, the way the DMA loop of a readout
+/// process does
+void cycle(DmaChannelInterface& channel, std::vector<Superpage>& superpages)
+{
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    superpages[i] = Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+  }
+  channel.pushSuperpages(superpages.data(), SUPERPAGES);
+  size_t popped = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (popped < SUPERPAGES) {
+    channel.fillSuperpages();
+    popped += channel.popSuperpages(superpages.data() + popped, SUPERPAGES - popped);
+    if ((std::chrono::steady_clock::now() - start) > std::chrono::seconds(5)) {
+      BOOST_FAIL("Superpages did not arrive");
+    }
+  }
+}
+
+void checkChannel(DmaChannelInterface& channel)
+{
+  std::vector<Superpage> superpages(SUPERPAGES);
+  channel.startDma();
+  for (int i = 0; i < WARM_UP_CYCLES; ++i) {
+    cycle(channel, superpages);
+  }
+  AllocationScope scope;
+  for (int i = 0; i < CYCLES; ++i) {
+    cycle(channel, superpages);
+  }
+  BOOST_CHECK_EQUAL(scope.get(), 0);
+  channel.stopDma();
+}
+
+Parameters makeDummyParameters(std::vector<char>& buffer)
+{
+  return Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0)
+      .setBufferParameters(buffer_parameters::Memory{buffer.data(), buffer.size()});
+}
+
+BOOST_AUTO_TEST_CASE(DummyChannel)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeDummyParameters(buffer));
+  checkChannel(channel);
+}
+
+BOOST_AUTO_TEST_CASE(SimulatedDummyChannel)
+{
+  // Only the calling thread is counted, the simulation thread writing the data is not
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(makeDummyParameters(buffer).setDummyLinkBandwidth(size_t(100) * 1024 * 1024 * 1024));
+  checkChannel(channel);
+}
+
+BOOST_AUTO_TEST_CASE(DriverThreadChannel)
+{
+  DriverThreadDmaChannel channel(std::make_shared<FakeDmaChannel>(), Parameters().setDriverThreadEnabled(true));
+  checkChannel(channel);
+}
+
+} // Anonymous namespace
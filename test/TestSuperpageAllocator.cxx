@@ -0,0 +1,86 @@
+/// \file TestSuperpageAllocator.cxx
+/// \brief Test of the SuperpageAllocator class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageAllocator
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SuperpageAllocator.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t KIB = 1024;
+constexpr size_t HUGEPAGE_SIZE = 2 * 1024 * KIB;
+
+BOOST_AUTO_TEST_CASE(MixedSizes)
+{
+  SuperpageAllocator allocator(0, 2 * HUGEPAGE_SIZE, HUGEPAGE_SIZE, 3);
+  BOOST_CHECK_EQUAL(allocator.getAvailable(), 2 * HUGEPAGE_SIZE);
+
+  Superpage small;
+  BOOST_REQUIRE(allocator.tryAllocate(20 * KIB, small));
+  BOOST_CHECK_EQUAL(small.getOffset(), 0);
+  BOOST_CHECK_EQUAL(small.getSize(), 32 * KIB);
+  BOOST_CHECK_EQUAL(small.getBufferId(), 3);
+
+  Superpage large;
+  BOOST_REQUIRE(allocator.tryAllocate(HUGEPAGE_SIZE, large));
+  BOOST_CHECK_EQUAL(large.getOffset(), HUGEPAGE_SIZE);
+
+  Superpage medium;
+  BOOST_REQUIRE(allocator.tryAllocate(100 * KIB, medium));
+  BOOST_CHECK_EQUAL(medium.getSize(), 128 * KIB);
+  BOOST_CHECK_EQUAL(medium.getOffset(), 128 * KIB);
+
+  // No hugepage is left whole
+  Superpage superpage;
+  BOOST_CHECK(!allocator.tryAllocate(HUGEPAGE_SIZE, superpage));
+  BOOST_CHECK_EQUAL(allocator.getLargestAvailable(), HUGEPAGE_SIZE / 2);
+
+  // Freed blocks merge back into a whole hugepage
+  allocator.release(small);
+  allocator.release(medium);
+  BOOST_CHECK_EQUAL(allocator.getLargestAvailable(), HUGEPAGE_SIZE);
+  BOOST_CHECK_THROW(allocator.release(small), Exception);
+  allocator.release(large);
+  BOOST_CHECK_EQUAL(allocator.getAvailable(), 2 * HUGEPAGE_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(HugepageBoundaries)
+{
+  // A region that starts and ends off a hugepage boundary
+  const size_t offset = HUGEPAGE_SIZE - 64 * KIB;
+  SuperpageAllocator allocator(offset, 2 * HUGEPAGE_SIZE, HUGEPAGE_SIZE);
+  BOOST_CHECK_EQUAL(allocator.getAvailable(), 2 * HUGEPAGE_SIZE);
+
+  std::vector<Superpage> superpages;
+  Superpage superpage;
+  while (allocator.tryAllocate(256 * KIB, superpage)) {
+    superpages.push_back(superpage);
+  }
+  BOOST_CHECK_EQUAL(allocator.getAvailable(), 64 * KIB + (HUGEPAGE_SIZE - 64 * KIB) % (256 * KIB));
+  for (const auto& allocated : superpages) {
+    BOOST_CHECK_GE(allocated.getOffset(), offset);
+    BOOST_CHECK_LE(allocated.getOffset() + allocated.getSize(), offset + 2 * HUGEPAGE_SIZE);
+    BOOST_CHECK_EQUAL(allocated.getOffset() / HUGEPAGE_SIZE,
+        (allocated.getOffset() + allocated.getSize() - 1) / HUGEPAGE_SIZE);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSizes)
+{
+  BOOST_CHECK_THROW(SuperpageAllocator(0, HUGEPAGE_SIZE, 96 * KIB), ParameterException);
+  BOOST_CHECK_THROW(SuperpageAllocator(0, 16 * KIB, HUGEPAGE_SIZE), ParameterException);
+  SuperpageAllocator allocator(0, HUGEPAGE_SIZE, HUGEPAGE_SIZE);
+  Superpage superpage;
+  BOOST_CHECK_THROW(allocator.tryAllocate(0, superpage), ParameterException);
+  BOOST_CHECK_THROW(allocator.tryAllocate(HUGEPAGE_SIZE + 1, superpage), ParameterException);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,118 @@
+/// \file TestSuperpageAutopilot.cxx
+/// \brief Test of the SuperpageAutopilot class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageAutopilot
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <set>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SuperpageAutopilot.h"
+#include "FakeDmaChannel.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t TRANSFER_QUEUE_SIZE = FakeDmaChannel::TRANSFER_QUEUE_SIZE;
+constexpr size_t SUPERPAGE_SIZE = 1024 * 1024;
+constexpr size_t REGION_OFFSET = 4 * SUPERPAGE_SIZE;
+
+BOOST_AUTO_TEST_CASE(KeepsQueueFull)
+{
+  auto fake = std::make_shared<FakeDmaChannel>();
+  const size_t count = 2 * TRANSFER_QUEUE_SIZE;
+  SuperpageAutopilot autopilot(fake, REGION_OFFSET, count * SUPERPAGE_SIZE + 1, SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(autopilot.getSuperpageCount(), count);
+
+  // The first poll fills the transfer queue, which the fake channel completes right away
+  std::vector<Superpage> consumed;
+  autopilot.poll([&](const Superpage& superpage){ consumed.push_back(superpage); });
+  BOOST_CHECK_EQUAL(consumed.size(), TRANSFER_QUEUE_SIZE);
+  BOOST_CHECK_EQUAL(autopilot.getFreeCount(), count - TRANSFER_QUEUE_SIZE);
+  BOOST_CHECK_EQUAL(consumed.front().getOffset(), REGION_OFFSET);
+
+  // The next poll pushes the rest of the region
+  autopilot.poll([&](const Superpage& superpage){ consumed.push_back(superpage); });
+  BOOST_CHECK_EQUAL(consumed.size(), count);
+  BOOST_CHECK_EQUAL(autopilot.getFreeCount(), 0);
+
+  std::set<size_t> offsets;
+  for (const auto& superpage : consumed) {
+    BOOST_CHECK(superpage.isReady());
+    offsets.insert(superpage.getOffset());
+  }
+  BOOST_CHECK_EQUAL(offsets.size(), count);
+  BOOST_CHECK_EQUAL(*offsets.rbegin(), REGION_OFFSET + (count - 1) * SUPERPAGE_SIZE);
+
+  // Released superpages go back to the card
+  for (const auto& superpage : consumed) {
+    autopilot.release(superpage);
+  }
+  BOOST_CHECK_EQUAL(fake->getReleasedCount(), TRANSFER_QUEUE_SIZE);
+  BOOST_CHECK_EQUAL(autopilot.getFreeCount(), count - TRANSFER_QUEUE_SIZE);
+
+  Superpage superpage;
+  BOOST_CHECK(autopilot.tryGetSuperpage(superpage));
+  BOOST_CHECK(superpage.isReady());
+}
+
+BOOST_AUTO_TEST_CASE(LinkAffine)
+{
+  auto fake = std::make_shared<FakeDmaChannel>();
+  SuperpageAutopilot autopilot(fake, REGION_OFFSET, 10 * SUPERPAGE_SIZE, SUPERPAGE_SIZE, {{4, 3.0}, {7, 1.0}});
+
+  // One superpage each, and the other eight shared 3:1
+  auto arenas = autopilot.getArenas();
+  BOOST_REQUIRE_EQUAL(arenas.size(), 2);
+  BOOST_CHECK_EQUAL(arenas[0].linkId, 4);
+  BOOST_CHECK_EQUAL(arenas[0].offset, REGION_OFFSET);
+  BOOST_CHECK_EQUAL(arenas[0].superpageCount, 7);
+  BOOST_CHECK_EQUAL(arenas[1].linkId, 7);
+  BOOST_CHECK_EQUAL(arenas[1].offset, REGION_OFFSET + 7 * SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(arenas[1].superpageCount, 3);
+
+  auto inArena = [&](const Superpage& superpage) {
+    for (const auto& arena : arenas) {
+      if (arena.linkId == superpage.getLinkId()) {
+        return superpage.getOffset() >= arena.offset
+            && superpage.getOffset() < arena.offset + arena.superpageCount * SUPERPAGE_SIZE;
+      }
+    }
+    return false;
+  };
+
+  std::vector<Superpage> consumed;
+  autopilot.poll([&](const Superpage& superpage){ consumed.push_back(superpage); });
+  BOOST_CHECK_EQUAL(consumed.size(), TRANSFER_QUEUE_SIZE);
+  BOOST_CHECK_EQUAL(autopilot.getLinkFreeCount(4), 0);
+  BOOST_CHECK_EQUAL(autopilot.getLinkFreeCount(7), 2);
+
+  // Superpages keep going back to the link of their arena
+  for (int round = 0; round < 3; ++round) {
+    for (const auto& superpage : consumed) {
+      BOOST_CHECK(inArena(superpage));
+      autopilot.release(superpage);
+    }
+    consumed.clear();
+    autopilot.poll([&](const Superpage& superpage){ consumed.push_back(superpage); });
+    BOOST_CHECK_EQUAL(consumed.size(), TRANSFER_QUEUE_SIZE);
+  }
+
+  Superpage foreign(0, SUPERPAGE_SIZE);
+  BOOST_CHECK_THROW(autopilot.release(foreign), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(RegionTooSmall)
+{
+  BOOST_CHECK_THROW(SuperpageAutopilot(std::make_shared<FakeDmaChannel>(), 0, SUPERPAGE_SIZE - 1, SUPERPAGE_SIZE),
+      ParameterException);
+  BOOST_CHECK_THROW(SuperpageAutopilot(std::make_shared<FakeDmaChannel>(), 0, SUPERPAGE_SIZE, 0), ParameterException);
+  BOOST_CHECK_THROW(SuperpageAutopilot(std::make_shared<FakeDmaChannel>(), 0, SUPERPAGE_SIZE, SUPERPAGE_SIZE,
+      {{0, 1.0}, {1, 1.0}}), ParameterException);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,91 @@
+/// \file TestSuperpageContexts.cxx
+/// \brief Test of the SuperpageContexts class template
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageContexts
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <set>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "Dummy/DummyDmaChannel.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/SuperpageContexts.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t SUPERPAGE_SIZE = 32 * 1024;
+constexpr size_t SUPERPAGES = 8;
+
+struct Context
+{
+    size_t offset = 0;
+    int generation = 0;
+};
+
+BOOST_AUTO_TEST_CASE(AcquireRelease)
+{
+  SuperpageContexts<Context> contexts(4);
+  BOOST_CHECK_EQUAL(contexts.getCapacity(), 4);
+
+  // Dense indexes, from the lowest
+  std::set<uint32_t> indexes;
+  uint32_t index;
+  for (int i = 0; i < 4; ++i) {
+    BOOST_REQUIRE(contexts.acquire(index));
+    indexes.insert(index);
+  }
+  BOOST_CHECK(indexes == std::set<uint32_t>({0, 1, 2, 3}));
+  BOOST_CHECK_EQUAL(contexts.getAvailable(), 0);
+  BOOST_CHECK(!contexts.acquire(index));
+
+  Superpage superpage;
+  BOOST_CHECK(contexts.attach(superpage) == nullptr);
+
+  contexts.release(2);
+  auto context = contexts.attach(superpage);
+  BOOST_REQUIRE(context != nullptr);
+  BOOST_CHECK_EQUAL(superpage.getContextIndex(), 2);
+  BOOST_CHECK_EQUAL(&contexts.get(superpage), context);
+  BOOST_CHECK_EQUAL(&contexts[2], context);
+}
+
+BOOST_AUTO_TEST_CASE(ThroughChannel)
+{
+  std::vector<char> buffer(SUPERPAGES * SUPERPAGE_SIZE);
+  DummyDmaChannel channel(Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0)
+      .setBufferParameters(buffer_parameters::Memory{buffer.data(), buffer.size()}));
+  SuperpageContexts<Context> contexts(SUPERPAGES);
+  channel.startDma();
+
+  for (int generation = 1; generation <= 3; ++generation) {
+    for (size_t i = 0; i < SUPERPAGES; ++i) {
+      Superpage superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+      auto context = contexts.attach(superpage);
+      BOOST_REQUIRE(context != nullptr);
+      context->offset = superpage.getOffset();
+      context->generation = generation;
+      channel.pushSuperpage(superpage);
+    }
+
+    size_t popped = 0;
+    while (popped < SUPERPAGES) {
+      channel.fillSuperpages();
+      Superpage superpage;
+      while (channel.tryPopSuperpage(superpage)) {
+        const auto& context = contexts.get(superpage);
+        BOOST_CHECK_EQUAL(context.offset, superpage.getOffset());
+        BOOST_CHECK_EQUAL(context.generation, generation);
+        contexts.release(superpage);
+        popped++;
+      }
+    }
+    BOOST_CHECK_EQUAL(contexts.getAvailable(), SUPERPAGES);
+  }
+  channel.stopDma();
+}
+
+} // Anonymous namespace
@@ -0,0 +1,60 @@
+/// \file TestSuperpageFlushWatch.cxx
+/// \brief Test of the SuperpageFlushWatch class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageFlushWatch
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <boost/test/unit_test.hpp>
+#include "SuperpageFlushWatch.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::chrono_literals;
+
+namespace {
+
+const auto start = SuperpageFlushWatch::Clock::now();
+constexpr auto timeout = 10ms;
+
+BOOST_AUTO_TEST_CASE(IdleAfterTimeout)
+{
+  SuperpageFlushWatch watch;
+  BOOST_CHECK(!watch.isIdle(0x1000, 8192, timeout, start));
+  BOOST_CHECK(!watch.isIdle(0x1000, 8192, timeout, start + 9ms));
+  BOOST_CHECK(watch.isIdle(0x1000, 8192, timeout, start + 10ms));
+  BOOST_CHECK(watch.isIdle(0x1000, 8192, timeout, start + 1s));
+}
+
+BOOST_AUTO_TEST_CASE(ProgressRestartsTimeout)
+{
+  SuperpageFlushWatch watch;
+  watch.isIdle(0x1000, 8192, timeout, start);
+  BOOST_CHECK(!watch.isIdle(0x1000, 16384, timeout, start + 9ms));
+  BOOST_CHECK(!watch.isIdle(0x1000, 16384, timeout, start + 18ms));
+  BOOST_CHECK(watch.isIdle(0x1000, 16384, timeout, start + 19ms));
+
+  // Another superpage, or the rest of a flushed one, starts over
+  BOOST_CHECK(!watch.isIdle(0x5000, 16384, timeout, start + 20ms));
+  BOOST_CHECK(!watch.isIdle(0x5000, 16384, timeout, start + 29ms));
+  BOOST_CHECK(watch.isIdle(0x5000, 16384, timeout, start + 30ms));
+}
+
+BOOST_AUTO_TEST_CASE(EmptyNeverIdle)
+{
+  SuperpageFlushWatch watch;
+  BOOST_CHECK(!watch.isIdle(0x1000, 0, timeout, start));
+  BOOST_CHECK(!watch.isIdle(0x1000, 0, timeout, start + 1s));
+}
+
+BOOST_AUTO_TEST_CASE(Reset)
+{
+  SuperpageFlushWatch watch;
+  watch.isIdle(0x1000, 8192, timeout, start);
+  watch.reset();
+  BOOST_CHECK(!watch.isIdle(0x1000, 8192, timeout, start + 1s));
+  BOOST_CHECK(watch.isIdle(0x1000, 8192, timeout, start + 2s));
+}
+
+} // Anonymous namespace
@@ -21,13 +21,13 @@ using namespace ::AliceO2::roc;
 namespace {
 
 constexpr size_t MAX_SUPERPAGES = 4;
-using Queue = SuperpageQueue<MAX_SUPERPAGES>;
+using Queue = SuperpageQueue;
 using Id = Queue::Id;
 using Entry = Queue::SuperpageQueueEntry;
 
 BOOST_AUTO_TEST_CASE(Capacity)
 {
-  Queue queue;
+  Queue queue(MAX_SUPERPAGES);
 
   for (size_t i = 0; i < MAX_SUPERPAGES; ++i) {
     queue.addToQueue(Entry());
@@ -38,7 +38,7 @@ BOOST_AUTO_TEST_CASE(Capacity)
 
 BOOST_AUTO_TEST_CASE(Lifecycle)
 {
-  Queue queue;
+  Queue queue(MAX_SUPERPAGES);
   std::array<Id, MAX_SUPERPAGES> ids;
 
   for (size_t i = 0; i < MAX_SUPERPAGES; ++i) {
@@ -66,4 +66,128 @@ BOOST_AUTO_TEST_CASE(Lifecycle)
   BOOST_CHECK_THROW(queue.removeFromFilledQueue(), std::exception);
 }
 
+BOOST_AUTO_TEST_CASE(LargeCapacity)
+{
+  // More superpages than the old 8-bit IDs could address, cycled through more than once so the rings wrap around
+  constexpr size_t capacity = 1000;
+  Queue queue(capacity);
+  BOOST_CHECK_EQUAL(queue.getQueueCapacity(), capacity);
+
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < capacity; ++i) {
+      Entry entry;
+      entry.busAddress = i;
+      entry.pushedPages = 1;
+      entry.maxPages = 1;
+      queue.addToQueue(entry);
+    }
+    BOOST_CHECK(queue.isFull());
+
+    for (size_t i = 0; i < capacity; ++i) {
+      queue.removeFromPushingQueue();
+      queue.getArrivalsFrontEntry().superpage.setReady(true);
+      queue.moveFromArrivalsToFilledQueue();
+      BOOST_CHECK_EQUAL(queue.removeFromFilledQueue().busAddress, i);
+    }
+    BOOST_CHECK(queue.isEmpty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ReclaimArrivals)
+{
+  constexpr size_t pageSize = 8 * 1024;
+  Queue queue(MAX_SUPERPAGES);
+  for (size_t i = 0; i < 3; ++i) {
+    Entry entry;
+    entry.busAddress = 0;
+    entry.pushedPages = 0;
+    entry.maxPages = 4;
+    entry.superpage = Superpage(i * 4 * pageSize, 4 * pageSize);
+    queue.addToQueue(entry);
+  }
+
+  // The first one is filled, the second one partially, the third one not at all
+  auto& first = queue.getArrivalsFrontEntry();
+  first.pushedPages = 4;
+  first.superpage.setReceived(4 * pageSize);
+  first.superpage.setReady(true);
+  queue.removeFromPushingQueue();
+  queue.moveFromArrivalsToFilledQueue();
+  auto& second = queue.getArrivalsFrontEntry();
+  second.pushedPages = 3;
+  second.superpage.setReceived(pageSize);
+
+  BOOST_CHECK_EQUAL(queue.reclaimArrivals(), 2);
+  BOOST_CHECK(queue.getArrivals().empty());
+  BOOST_CHECK(queue.getPushing().empty());
+  BOOST_CHECK_EQUAL(queue.getFilled().size(), 3);
+  BOOST_CHECK_EQUAL(queue.getQueueCount(), 3);
+  size_t received[] = {4 * pageSize, pageSize, 0};
+  for (size_t i = 0; i < 3; ++i) {
+    auto superpage = queue.removeFromFilledQueue().superpage;
+    BOOST_CHECK(superpage.isReady());
+    BOOST_CHECK_EQUAL(superpage.getOffset(), i * 4 * pageSize);
+    BOOST_CHECK_EQUAL(superpage.getReceived(), received[i]);
+  }
+  BOOST_CHECK(queue.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(Split)
+{
+  constexpr size_t pageSize = 8 * 1024;
+  constexpr int pages = 16;
+  Queue queue(MAX_SUPERPAGES);
+  std::array<uint32_t, pages> pageLengths;
+
+  Entry entry;
+  entry.busAddress = 0x100000;
+  entry.pushedPages = 0;
+  entry.maxPages = pages;
+  entry.superpage = Superpage(0x40000, pages * pageSize);
+  entry.superpage.setPageLengths(pageLengths.data());
+  queue.addToQueue(entry);
+
+  // Nothing received yet, so nothing to split off
+  BOOST_CHECK_THROW(queue.splitArrivalsFront(pageSize), std::exception);
+
+  // Half the pages pushed, a quarter arrived
+  auto& front = queue.getArrivalsFrontEntry();
+  front.pushedPages = pages / 2;
+  front.superpage.setReceived(pages / 4 * pageSize);
+
+  auto id = queue.splitArrivalsFront(pageSize);
+  BOOST_CHECK_EQUAL(queue.getFilled().size(), 1);
+  BOOST_CHECK_EQUAL(queue.getQueueCount(), 2);
+  const auto& split = queue.getEntry(id);
+  BOOST_CHECK(split.superpage.isReady());
+  BOOST_CHECK(split.superpage.isFilled());
+  BOOST_CHECK_EQUAL(split.superpage.getOffset(), 0x40000);
+  BOOST_CHECK_EQUAL(split.superpage.getSize(), pages / 4 * pageSize);
+  BOOST_CHECK_EQUAL(split.superpage.getPageLengths(), pageLengths.data());
+
+  // The rest stays in flight, with the pages that were pushed but did not arrive
+  BOOST_CHECK(!front.superpage.isReady());
+  BOOST_CHECK_EQUAL(front.superpage.getOffset(), 0x40000 + pages / 4 * pageSize);
+  BOOST_CHECK_EQUAL(front.superpage.getSize(), 3 * pages / 4 * pageSize);
+  BOOST_CHECK_EQUAL(front.superpage.getReceived(), 0);
+  BOOST_CHECK_EQUAL(front.superpage.getPageLengths(), pageLengths.data() + pages / 4);
+  BOOST_CHECK_EQUAL(front.busAddress, 0x100000 + pages / 4 * pageSize);
+  BOOST_CHECK_EQUAL(front.pushedPages, pages / 4);
+  BOOST_CHECK_EQUAL(front.getUnpushedPages(), pages / 2);
+
+  // The split off part is popped first, and its slot can be reused while the rest is still in flight
+  BOOST_CHECK_EQUAL(queue.getFrontSuperpage().getOffset(), 0x40000);
+  BOOST_CHECK_EQUAL(queue.removeFromFilledQueue().superpage.getSize(), pages / 4 * pageSize);
+  for (size_t i = 1; i < MAX_SUPERPAGES; ++i) {
+    queue.addToQueue(Entry());
+  }
+  BOOST_CHECK(queue.isFull());
+  BOOST_CHECK_EQUAL(queue.getArrivalsFrontEntry().superpage.getOffset(), 0x40000 + pages / 4 * pageSize);
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCapacity)
+{
+  BOOST_CHECK_THROW(Queue(0), std::exception);
+}
+
 } // Anonymous namespace
@@ -0,0 +1,207 @@
+/// \file TestSuperpageRecorder.cxx
+/// \brief Test of the SuperpageRecorder and SuperpageRecording classes
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageRecorder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SuperpageRecorder.h"
+
+using namespace ::AliceO2::roc;
+namespace bfs = boost::filesystem;
+
+namespace {
+
+constexpr size_t SUPERPAGE_SIZE = 64 * 1024;
+constexpr size_t SUPERPAGES = 8;
+constexpr size_t QUEUE_DEPTH = 3;
+
+/// A buffer aligned for O_DIRECT, filled with the index of its superpage
+std::unique_ptr<char, void(*)(void*)> makeBuffer()
+{
+  void* memory = nullptr;
+  BOOST_REQUIRE(posix_memalign(&memory, SuperpageRecorder::DIRECT_ALIGNMENT, SUPERPAGES * SUPERPAGE_SIZE) == 0);
+  auto buffer = static_cast<char*>(memory);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    std::fill_n(buffer + i * SUPERPAGE_SIZE, SUPERPAGE_SIZE, char('a' + i));
+  }
+  return {buffer, std::free};
+}
+
+/// Directory for the stripes and the index, removed at the end of the test
+struct TemporaryDirectory
+{
+    TemporaryDirectory()
+      : path(bfs::temp_directory_path() / bfs::unique_path())
+    {
+      bfs::create_directories(path);
+    }
+
+    ~TemporaryDirectory()
+    {
+      bfs::remove_all(path);
+    }
+
+    std::vector<std::string> stripes(size_t count)
+    {
+      std::vector<std::string> paths;
+      for (size_t i = 0; i < count; ++i) {
+        paths.push_back((path / ("stripe" + std::to_string(i))).string());
+      }
+      return paths;
+    }
+
+    bfs::path path;
+};
+
+/// Records the superpages of the buffer, each with the given size, and returns them in the order they were reaped
+std::vector<Superpage> record(SuperpageRecorder& recorder, const char* buffer, size_t size)
+{
+  size_t written = 0;
+  std::vector<Superpage> completed(SUPERPAGES);
+  size_t reaped = 0;
+  while (reaped < SUPERPAGES) {
+    while (written < SUPERPAGES && recorder.write(Superpage(written * SUPERPAGE_SIZE, SUPERPAGE_SIZE),
+        buffer + written * SUPERPAGE_SIZE, size)) {
+      written++;
+    }
+    BOOST_CHECK_LE(recorder.getInFlight(), QUEUE_DEPTH);
+    auto count = recorder.reap(completed.data() + reaped, completed.size() - reaped, true);
+    BOOST_CHECK_GT(count, 0);
+    reaped += count;
+  }
+  BOOST_CHECK_EQUAL(recorder.getInFlight(), 0);
+  BOOST_CHECK_EQUAL(recorder.reap(completed.data(), completed.size(), true), 0);
+  return completed;
+}
+
+/// Checks that the recording replays the superpages of the buffer, each with the given size
+void checkReplay(const std::string& indexPath, const char* buffer, size_t size)
+{
+  SuperpageRecording recording(indexPath);
+  BOOST_REQUIRE_EQUAL(recording.getEntries().size(), SUPERPAGES);
+  std::vector<char> data(SUPERPAGE_SIZE);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    BOOST_REQUIRE_EQUAL(recording.read(i, data.data(), data.size()), size);
+    BOOST_CHECK(std::equal(data.begin(), data.begin() + size, buffer + i * SUPERPAGE_SIZE));
+  }
+  BOOST_CHECK_THROW(recording.read(0, data.data(), size - 1), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(SingleStripe)
+{
+  auto buffer = makeBuffer();
+  TemporaryDirectory directory;
+  SuperpageRecorder::Options options;
+  options.stripePaths = directory.stripes(1);
+  options.queueDepth = QUEUE_DEPTH;
+  {
+    SuperpageRecorder recorder(options);
+    BOOST_TEST_MESSAGE("O_DIRECT: " << recorder.isDirect());
+    auto completed = record(recorder, buffer.get(), SUPERPAGE_SIZE);
+    for (size_t i = 0; i < SUPERPAGES; ++i) {
+      BOOST_CHECK_EQUAL(completed[i].getOffset(), i * SUPERPAGE_SIZE);
+    }
+    BOOST_CHECK_EQUAL(recorder.getBytesRecorded(), SUPERPAGES * SUPERPAGE_SIZE);
+    BOOST_CHECK_EQUAL(recorder.getIndexPath(), options.stripePaths[0] + ".index");
+  }
+
+  // Like a plain recording, the stripe holds the superpages back to back
+  std::ifstream file(options.stripePaths[0], std::ios::binary);
+  std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  BOOST_REQUIRE_EQUAL(contents.size(), SUPERPAGES * SUPERPAGE_SIZE);
+  BOOST_CHECK(std::equal(contents.begin(), contents.end(), buffer.get()));
+  checkReplay(options.stripePaths[0] + ".index", buffer.get(), SUPERPAGE_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(Striped)
+{
+  auto buffer = makeBuffer();
+  TemporaryDirectory directory;
+  SuperpageRecorder::Options options;
+  options.stripePaths = directory.stripes(3);
+  options.indexPath = (directory.path / "index").string();
+  options.queueDepth = QUEUE_DEPTH;
+  // Sizes that are not aligned for O_DIRECT are padded in the stripes
+  const size_t size = SUPERPAGE_SIZE - 100;
+  {
+    SuperpageRecorder recorder(options);
+    record(recorder, buffer.get(), size);
+    BOOST_CHECK_EQUAL(recorder.getBytesStored(), SUPERPAGES * size);
+  }
+
+  SuperpageRecording recording(options.indexPath);
+  BOOST_CHECK(recording.getStripePaths() == options.stripePaths);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    BOOST_CHECK_EQUAL(recording.getEntries()[i].stripe, i % 3);
+  }
+  checkReplay(options.indexPath, buffer.get(), size);
+}
+
+BOOST_AUTO_TEST_CASE(Compressed)
+{
+  for (auto compression : {SuperpageRecorder::Compression::Lz4, SuperpageRecorder::Compression::Zstd}) {
+    auto buffer = makeBuffer();
+    TemporaryDirectory directory;
+    SuperpageRecorder::Options options;
+    options.stripePaths = directory.stripes(2);
+    options.compression = compression;
+    options.compressionThreads = 2;
+    options.queueDepth = QUEUE_DEPTH;
+    if (!SuperpageRecorder::isCompressionAvailable(compression)) {
+      BOOST_CHECK_THROW(SuperpageRecorder recorder(options), Exception);
+      continue;
+    }
+    {
+      SuperpageRecorder recorder(options);
+      record(recorder, buffer.get(), SUPERPAGE_SIZE);
+      // Every superpage is a single repeated byte
+      BOOST_CHECK_LT(recorder.getBytesStored(), recorder.getBytesRecorded() / 10);
+    }
+    checkReplay(options.stripePaths[0] + ".index", buffer.get(), SUPERPAGE_SIZE);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DestructorWaits)
+{
+  auto buffer = makeBuffer();
+  TemporaryDirectory directory;
+  SuperpageRecorder::Options options;
+  options.stripePaths = directory.stripes(1);
+  options.queueDepth = QUEUE_DEPTH;
+  {
+    SuperpageRecorder recorder(options);
+    for (size_t i = 0; i < QUEUE_DEPTH; ++i) {
+      BOOST_CHECK(recorder.write(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE), buffer.get() + i * SUPERPAGE_SIZE,
+          SUPERPAGE_SIZE));
+    }
+    BOOST_CHECK(!recorder.write(Superpage(0, SUPERPAGE_SIZE), buffer.get(), SUPERPAGE_SIZE));
+  }
+  BOOST_CHECK_EQUAL(bfs::file_size(options.stripePaths[0]), QUEUE_DEPTH * SUPERPAGE_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  TemporaryDirectory directory;
+  SuperpageRecorder::Options options;
+  BOOST_CHECK_THROW(SuperpageRecorder recorder(options), Exception);
+  options.stripePaths = directory.stripes(1);
+  options.queueDepth = 0;
+  BOOST_CHECK_THROW(SuperpageRecorder recorder(options), Exception);
+  BOOST_CHECK_THROW(SuperpageRecording((directory.path / "missing").string()), Exception);
+
+  BOOST_CHECK(SuperpageRecorder::compressionFromString("ZSTD") == SuperpageRecorder::Compression::Zstd);
+  BOOST_CHECK(SuperpageRecorder::compressionFromString("none") == SuperpageRecorder::Compression::None);
+  BOOST_CHECK_THROW(SuperpageRecorder::compressionFromString("gzip"), Exception);
+}
+
+} // Anonymous namespace
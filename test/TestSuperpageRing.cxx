@@ -0,0 +1,119 @@
+/// \file TestSuperpageRing.cxx
+/// \brief Test of the SuperpageRing class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageRing
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SuperpageRing.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t CAPACITY = 8;
+constexpr size_t SUPERPAGE_SIZE = 1024 * 1024;
+
+BOOST_AUTO_TEST_CASE(Metadata)
+{
+  SuperpageRing ring(CAPACITY);
+  int userData = 0;
+  uint32_t pageLengths[4];
+
+  Superpage superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE, &userData);
+  superpage.setReceived(123);
+  superpage.setLinkId(7);
+  superpage.setTimestamp(456);
+  superpage.setPushTimestamp(345);
+  superpage.setPageLengths(pageLengths);
+  superpage.setReady(true);
+  BOOST_REQUIRE(ring.write(superpage));
+  BOOST_CHECK_EQUAL(ring.sizeGuess(), 1);
+
+  Superpage read;
+  BOOST_REQUIRE(ring.read(read));
+  BOOST_CHECK_EQUAL(read.getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(read.getSize(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(read.getReceived(), 123);
+  BOOST_CHECK_EQUAL(read.getLinkId(), 7);
+  BOOST_CHECK_EQUAL(read.getTimestamp(), 456);
+  BOOST_CHECK_EQUAL(read.getPushTimestamp(), 345);
+  BOOST_CHECK_EQUAL(read.getUserData(), &userData);
+  BOOST_CHECK_EQUAL(read.getPageLengths(), pageLengths);
+  BOOST_CHECK(read.isReady());
+  BOOST_CHECK(!ring.read(read));
+}
+
+BOOST_AUTO_TEST_CASE(Batch)
+{
+  SuperpageRing ring(CAPACITY);
+  std::vector<Superpage> superpages;
+  for (size_t i = 0; i < CAPACITY + 3; ++i) {
+    superpages.emplace_back(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE);
+  }
+
+  // Only as many as fit are written
+  BOOST_CHECK_EQUAL(ring.write(superpages.data(), superpages.size()), CAPACITY);
+  BOOST_CHECK(!ring.write(superpages[0]));
+
+  std::vector<Superpage> read(CAPACITY + 3);
+  BOOST_CHECK_EQUAL(ring.read(read.data(), 3), 3);
+  BOOST_CHECK_EQUAL(ring.write(superpages.data() + CAPACITY, 3), 3);
+  BOOST_CHECK_EQUAL(ring.read(read.data() + 3, read.size() - 3), CAPACITY);
+  for (size_t i = 0; i < read.size(); ++i) {
+    BOOST_CHECK_EQUAL(read[i].getOffset(), i * SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK_EQUAL(ring.sizeGuess(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ExternalMemory)
+{
+  auto memory = ::aligned_alloc(SuperpageRing::CACHE_LINE_SIZE, SuperpageRing::getRequiredSize(CAPACITY));
+  {
+    SuperpageRing producer(memory, CAPACITY, true);
+    SuperpageRing consumer(memory, CAPACITY, false);
+    BOOST_REQUIRE(producer.write(Superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE)));
+    Superpage read;
+    BOOST_REQUIRE(consumer.read(read));
+    BOOST_CHECK_EQUAL(read.getOffset(), SUPERPAGE_SIZE);
+  }
+  BOOST_CHECK_THROW(SuperpageRing(static_cast<char*>(memory) + 1, CAPACITY, true), Exception);
+  BOOST_CHECK_THROW(SuperpageRing(0), Exception);
+  ::free(memory);
+}
+
+BOOST_AUTO_TEST_CASE(Threads)
+{
+  constexpr size_t COUNT = 100000;
+  SuperpageRing ring(CAPACITY);
+
+  std::thread producer([&]{
+    size_t i = 0;
+    while (i < COUNT) {
+      if (ring.write(Superpage(i, SUPERPAGE_SIZE))) {
+        ++i;
+      }
+    }
+  });
+
+  bool inOrder = true;
+  size_t expected = 0;
+  std::vector<Superpage> read(CAPACITY);
+  while (expected < COUNT) {
+    auto count = ring.read(read.data(), read.size());
+    for (size_t i = 0; i < count; ++i) {
+      inOrder = inOrder && (read[i].getOffset() == expected);
+      ++expected;
+    }
+  }
+  producer.join();
+  BOOST_CHECK(inOrder);
+}
+
+} // Anonymous namespace
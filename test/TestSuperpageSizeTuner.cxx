@@ -0,0 +1,74 @@
+/// \file TestSuperpageSizeTuner.cxx
+/// \brief Test of the SuperpageSizeTuner class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageSizeTuner
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SuperpageSizeTuner.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr size_t KIBI = 1024;
+constexpr size_t MEBI = 1024 * KIBI;
+
+const auto start = SuperpageSizeTuner::Clock::now();
+
+ChannelStatistics makeStatistics(uint32_t linkId, uint64_t bytes)
+{
+  ChannelStatistics statistics = ChannelStatistics();
+  statistics.links.push_back(LinkStatistics{linkId, 0, bytes});
+  return statistics;
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSizes)
+{
+  BOOST_CHECK_THROW(SuperpageSizeTuner({}, 1ms), ParameterException);
+  BOOST_CHECK_THROW(SuperpageSizeTuner({32 * KIBI, 0}, 1ms), ParameterException);
+}
+
+BOOST_AUTO_TEST_CASE(UnknownLinkGetsSmallest)
+{
+  SuperpageSizeTuner tuner({1 * MEBI, 32 * KIBI, 256 * KIBI}, 10ms);
+  BOOST_CHECK_EQUAL(tuner.getSizes().front(), 32 * KIBI);
+  BOOST_CHECK_EQUAL(tuner.getSuperpageSize(0), 32 * KIBI);
+
+  // A single update gives no rate yet
+  tuner.update(makeStatistics(0, 100 * MEBI), start);
+  BOOST_CHECK_EQUAL(tuner.getRate(0), 0);
+  BOOST_CHECK_EQUAL(tuner.getSuperpageSize(0), 32 * KIBI);
+}
+
+BOOST_AUTO_TEST_CASE(SizeFollowsRate)
+{
+  SuperpageSizeTuner tuner({32 * KIBI, 256 * KIBI, 1 * MEBI}, 10ms);
+
+  // 100 MiB/s fills 1 MiB in 10 ms
+  tuner.update(makeStatistics(3, 0), start);
+  tuner.update(makeStatistics(3, 100 * MEBI), start + 1s);
+  BOOST_CHECK_CLOSE(tuner.getRate(3), 100.0 * MEBI, 0.01);
+  BOOST_CHECK_EQUAL(tuner.getSuperpageSize(3), 1 * MEBI);
+
+  // 10 MiB/s fills 100 KiB in 10 ms. The average follows gradually.
+  uint64_t bytes = 100 * MEBI;
+  for (int i = 2; i < 40; ++i) {
+    bytes += 10 * MEBI;
+    tuner.update(makeStatistics(3, bytes), start + i * 1s);
+  }
+  BOOST_CHECK_CLOSE(tuner.getRate(3), 10.0 * MEBI, 1);
+  BOOST_CHECK_EQUAL(tuner.getSuperpageSize(3), 32 * KIBI);
+
+  // Too slow for even the smallest size, which is still used
+  for (int i = 40; i < 80; ++i) {
+    tuner.update(makeStatistics(3, bytes), start + i * 1s);
+  }
+  BOOST_CHECK_EQUAL(tuner.getSuperpageSize(3), 32 * KIBI);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,175 @@
+/// \file TestSuperpageTap.cxx
+/// \brief Test of the SuperpageTap class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageTap
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SuperpageTap.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+/// Client connected to a tap on the loopback device
+class Client
+{
+  public:
+    explicit Client(SuperpageTap& tap)
+    {
+      mSocket = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in address = {};
+      address.sin_family = AF_INET;
+      address.sin_port = htons(tap.getPort());
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      BOOST_REQUIRE(connect(mSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+      for (int i = 0; i < 200 && !tap.isClientConnected(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      BOOST_REQUIRE(tap.isClientConnected());
+    }
+
+    ~Client()
+    {
+      close(mSocket);
+    }
+
+    void read(void* data, size_t size)
+    {
+      size_t done = 0;
+      while (done < size) {
+        auto result = recv(mSocket, static_cast<char*>(data) + done, size - done, 0);
+        BOOST_REQUIRE(result > 0);
+        done += size_t(result);
+      }
+    }
+
+    /// Reads a sample and returns its data
+    std::vector<char> readSample(SuperpageTap::SampleHeader& header)
+    {
+      read(&header, sizeof(header));
+      BOOST_REQUIRE_EQUAL(header.magic, SuperpageTap::SAMPLE_MAGIC);
+      std::vector<char> data(header.size);
+      read(data.data(), data.size());
+      return data;
+    }
+
+  private:
+    int mSocket;
+};
+
+Superpage makeSuperpage(uint32_t linkId)
+{
+  Superpage superpage;
+  superpage.setLinkId(linkId);
+  return superpage;
+}
+
+BOOST_AUTO_TEST_CASE(OneInN)
+{
+  SuperpageTap::Options options;
+  options.address = "127.0.0.1";
+  options.sampleEvery = 3;
+  SuperpageTap tap(options);
+  Client client(tap);
+
+  std::vector<char> data(1000);
+  for (int i = 0; i < 9; ++i) {
+    std::fill(data.begin(), data.end(), char(i));
+    BOOST_CHECK_EQUAL(tap.offer(makeSuperpage(0), data.data(), data.size()), i % 3 == 0);
+  }
+  BOOST_CHECK_EQUAL(tap.getOfferedCount(), 9);
+  BOOST_CHECK_EQUAL(tap.getSampledCount(), 3);
+
+  for (uint64_t sequence : {0, 3, 6}) {
+    SuperpageTap::SampleHeader header;
+    auto sample = client.readSample(header);
+    BOOST_CHECK_EQUAL(header.sequence, sequence);
+    BOOST_CHECK_EQUAL(header.received, data.size());
+    BOOST_REQUIRE_EQUAL(sample.size(), data.size());
+    BOOST_CHECK(std::all_of(sample.begin(), sample.end(), [&](char c) { return c == char(sequence); }));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LinkFilterAndTruncation)
+{
+  SuperpageTap::Options options;
+  options.address = "127.0.0.1";
+  options.sampleEvery = 1;
+  options.links = {2};
+  options.maxSampleSize = 100;
+  SuperpageTap tap(options);
+  Client client(tap);
+
+  std::vector<char> data(1000, 'x');
+  for (uint32_t link : {1, 2, 3, 2}) {
+    BOOST_CHECK_EQUAL(tap.offer(makeSuperpage(link), data.data(), data.size()), link == 2);
+  }
+  for (uint64_t sequence : {1, 3}) {
+    SuperpageTap::SampleHeader header;
+    auto sample = client.readSample(header);
+    BOOST_CHECK_EQUAL(header.sequence, sequence);
+    BOOST_CHECK_EQUAL(header.linkId, 2);
+    BOOST_CHECK_EQUAL(header.received, data.size());
+    BOOST_CHECK_EQUAL(sample.size(), options.maxSampleSize);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NoClient)
+{
+  SuperpageTap::Options options;
+  options.address = "127.0.0.1";
+  options.sampleEvery = 1;
+  SuperpageTap tap(options);
+  char data[64] = {};
+  BOOST_CHECK(!tap.offer(makeSuperpage(0), data, sizeof(data)));
+  BOOST_CHECK_EQUAL(tap.getSampledCount(), 0);
+  BOOST_CHECK_EQUAL(tap.getDroppedCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SlowClient)
+{
+  // The client doesn't read, so the socket fills up and the samples are dropped instead of blocking
+  SuperpageTap::Options options;
+  options.address = "127.0.0.1";
+  options.sampleEvery = 1;
+  options.slots = 2;
+  SuperpageTap tap(options);
+  Client client(tap);
+
+  std::vector<char> data(options.maxSampleSize);
+  constexpr int OFFERS = 200;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < OFFERS; ++i) {
+    tap.offer(makeSuperpage(0), data.data(), data.size());
+  }
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+  BOOST_CHECK_GT(tap.getDroppedCount(), 0);
+  BOOST_CHECK_EQUAL(tap.getSampledCount() + tap.getDroppedCount(), OFFERS);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  SuperpageTap::Options options;
+  options.sampleEvery = 0;
+  BOOST_CHECK_THROW(SuperpageTap tap(options), Exception);
+  options.sampleEvery = 1;
+  options.links = {64};
+  BOOST_CHECK_THROW(SuperpageTap tap(options), Exception);
+  options.links = {};
+  options.address = "not an address";
+  BOOST_CHECK_THROW(SuperpageTap tap(options), Exception);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,181 @@
+/// \file TestSwt.cxx
+/// \brief Test of the Swt class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestSwt
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
+#include <boost/test/unit_test.hpp>
+#include "Swt/Swt.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr int SWT_BASE_INDEX = 0x0f00000 / 4;
+constexpr int WR_WORD_L = SWT_BASE_INDEX + 0x40 / 4;
+constexpr int CMD = SWT_BASE_INDEX + 0x4c / 4;
+constexpr int RD_WORD_L = SWT_BASE_INDEX + 0x50 / 4;
+constexpr int MON = SWT_BASE_INDEX + 0x5c / 4;
+constexpr int SET_CHANNEL = SWT_BASE_INDEX + 0x60 / 4;
+
+/// Records the register accesses. Commands on the command register are acted on like the firmware would: a write
+/// command queues the word, a read command puts the oldest queued word in the read registers. Every GBT channel has its
+/// own queue.
+class FakeBar : public RegisterReadWriteInterface
+{
+  public:
+    virtual uint32_t readRegister(int index) override
+    {
+      reads++;
+      return registers[index];
+    }
+
+    virtual void writeRegister(int index, uint32_t value) override
+    {
+      if (index == SET_CHANNEL && failingChannel && int(value) == *failingChannel) {
+        throw std::runtime_error("failing channel");
+      }
+      writes++;
+      registers[index] = value;
+      auto& fifo = fifos[registers[SET_CHANNEL]];
+      if (index == CMD && value == 0x1) {
+        fifo.push_back({registers[WR_WORD_L], registers[WR_WORD_L + 1], registers[WR_WORD_L + 2]});
+        registers[MON] = fifo.size();
+      } else if (index == CMD && value == 0x2 && !fifo.empty()) {
+        registers[RD_WORD_L] = fifo.front()[0];
+        registers[RD_WORD_L + 1] = fifo.front()[1];
+        registers[RD_WORD_L + 2] = fifo.front()[2];
+        fifo.erase(fifo.begin());
+        registers[MON] = fifo.size();
+      } else if (index == SET_CHANNEL) {
+        registers[MON] = fifo.size();
+        channelSwitches++;
+      }
+    }
+
+    virtual void readRegisters(int startIndex, uint32_t* values, size_t count) override
+    {
+      blockReads++;
+      for (size_t i = 0; i < count; ++i) {
+        values[i] = registers[startIndex + i];
+      }
+    }
+
+    std::map<int, uint32_t> registers;
+    std::map<uint32_t, std::vector<std::vector<uint32_t>>> fifos;
+    boost::optional<int> failingChannel;
+    int reads = 0;
+    int writes = 0;
+    int blockReads = 0;
+    int channelSwitches = 0;
+};
+
+BOOST_AUTO_TEST_CASE(Sequence)
+{
+  FakeBar bar;
+  Swt swt(bar, 3);
+
+  std::vector<SwtWord> written;
+  for (uint32_t i = 0; i < 10; ++i) {
+    written.push_back(SwtWord(0x1000 + i, 0x2000 + i, 0x30 + i));
+  }
+
+  bar.reads = 0;
+  BOOST_CHECK_EQUAL(swt.writeSequence(written), 10);
+  // One round trip for the whole sequence
+  BOOST_CHECK_EQUAL(bar.reads, 1);
+
+  std::vector<SwtWord> read(written.size());
+  bar.reads = 0;
+  BOOST_CHECK_EQUAL(swt.readSequence(read), 0);
+  BOOST_CHECK_EQUAL(bar.reads, 0);
+  BOOST_CHECK_EQUAL(bar.blockReads, 10);
+  for (size_t i = 0; i < written.size(); ++i) {
+    BOOST_CHECK(read[i] == written[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SequenceMatchesSingleWords)
+{
+  FakeBar sequenceBar;
+  FakeBar singleBar;
+  Swt sequenceSwt(sequenceBar, 0);
+  Swt singleSwt(singleBar, 0);
+
+  std::vector<SwtWord> words {SwtWord(1, 2, 3), SwtWord(4, 5, 6)};
+  sequenceSwt.writeSequence(words);
+  for (auto& word : words) {
+    singleSwt.write(word);
+  }
+  BOOST_CHECK(sequenceBar.fifos == singleBar.fifos);
+  BOOST_CHECK(sequenceBar.registers == singleBar.registers);
+}
+
+std::vector<SwtWord> makeWords(uint32_t channel, uint32_t count)
+{
+  std::vector<SwtWord> words;
+  for (uint32_t i = 0; i < count; ++i) {
+    words.push_back(SwtWord(channel, i, 0x40 + i));
+  }
+  return words;
+}
+
+BOOST_AUTO_TEST_CASE(MultiChannelSequences)
+{
+  FakeBar bar;
+  std::map<int, Swt::Sequence> sequences;
+  sequences[0].writes = makeWords(0, 10);
+  sequences[0].readCount = 10;
+  sequences[5].writes = makeWords(5, 3);
+  sequences[5].readCount = 2;
+  sequences[7].readCount = 0;
+
+  auto results = Swt::executeSequences(bar, sequences, 4);
+  BOOST_REQUIRE_EQUAL(results.size(), 3);
+  for (const auto& sequence : sequences) {
+    const auto& result = results.at(sequence.first);
+    BOOST_CHECK(!result.error);
+    BOOST_CHECK_EQUAL(result.written, sequence.second.writes.size());
+    BOOST_REQUIRE_EQUAL(result.reads.size(), sequence.second.readCount);
+    for (size_t i = 0; i < result.reads.size(); ++i) {
+      auto read = result.reads[i];
+      BOOST_CHECK(read == sequence.second.writes[i]);
+    }
+    BOOST_CHECK_EQUAL(result.monitor, sequence.second.writes.size() - sequence.second.readCount);
+  }
+  // Channel 0 has three batches of 4 and channel 5 one, interleaved over three rounds, then one switch per channel to
+  // read the replies
+  BOOST_CHECK_EQUAL(bar.channelSwitches, 1 + 4 + 3);
+  // One monitor read per round, and one for the channel without replies
+  BOOST_CHECK_EQUAL(bar.reads, 3 + 1);
+}
+
+BOOST_AUTO_TEST_CASE(MultiChannelSequencesError)
+{
+  FakeBar bar;
+  std::map<int, Swt::Sequence> sequences;
+  sequences[1].writes = makeWords(1, 5);
+  sequences[1].readCount = 5;
+  sequences[2].writes = makeWords(2, 5);
+  bar.failingChannel = 2;
+
+  auto results = Swt::executeSequences(bar, sequences, 2);
+  BOOST_CHECK(results.at(2).error);
+  BOOST_CHECK_EQUAL(results.at(2).written, 0);
+  // The other channel completes
+  BOOST_CHECK(!results.at(1).error);
+  BOOST_CHECK_EQUAL(results.at(1).written, 5);
+  BOOST_REQUIRE_EQUAL(results.at(1).reads.size(), 5);
+  for (size_t i = 0; i < 5; ++i) {
+    BOOST_CHECK(results.at(1).reads[i] == sequences[1].writes[i]);
+  }
+}
+
+} // Anonymous namespace
@@ -0,0 +1,118 @@
+/// \file TestTimeFrameIndexer.cxx
+/// \brief Tests for the TimeFrameIndexer class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestTimeFrameIndexer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/TimeFrameIndexer.h"
+
+using namespace AliceO2::roc;
+
+namespace {
+
+constexpr size_t PAGE_SIZE = TimeFrameIndexer::DMA_PAGE_SIZE;
+
+/// Writes the RDH words the indexer decodes
+void setRdh(std::vector<uint32_t>& buffer, size_t offset, uint32_t memorySize, uint32_t offsetNext, uint32_t orbit)
+{
+  auto rdh = &buffer[offset / sizeof(uint32_t)];
+  rdh[2] = (memorySize << 16) | offsetNext;
+  rdh[3] = 4; // Link ID
+  rdh[4] = orbit;
+  rdh[5] = orbit;
+}
+
+BOOST_AUTO_TEST_CASE(Straddling)
+{
+  constexpr size_t pages = 8;
+  std::vector<uint32_t> buffer(pages * PAGE_SIZE / sizeof(uint32_t));
+  // Time frames of 4 orbits, with the boundary at orbit 12 after the third page
+  const uint32_t orbits[pages] = {9, 10, 11, 12, 12, 13, 14, 15};
+  for (size_t i = 0; i < pages; ++i) {
+    setRdh(buffer, i * PAGE_SIZE, 0x100, PAGE_SIZE, orbits[i]);
+  }
+
+  TimeFrameIndexer indexer(4);
+  std::vector<TimeFrameSlice> slices;
+  BOOST_REQUIRE_EQUAL(indexer.indexSuperpage(buffer.data(), pages * PAGE_SIZE, slices), 2);
+  BOOST_CHECK_EQUAL(slices[0].timeFrame, 2);
+  BOOST_CHECK_EQUAL(slices[0].firstOrbit, 9);
+  BOOST_CHECK_EQUAL(slices[0].lastOrbit, 11);
+  BOOST_CHECK_EQUAL(slices[0].linkId, 4);
+  BOOST_CHECK_EQUAL(slices[0].firstPacket, 0);
+  BOOST_CHECK_EQUAL(slices[0].packets, 3);
+  BOOST_CHECK_EQUAL(slices[0].offset, 0);
+  BOOST_CHECK_EQUAL(slices[0].size, 3 * PAGE_SIZE);
+  BOOST_CHECK(!slices[0].continued);
+  BOOST_CHECK_EQUAL(slices[1].timeFrame, 3);
+  BOOST_CHECK_EQUAL(slices[1].firstOrbit, 12);
+  BOOST_CHECK_EQUAL(slices[1].lastOrbit, 15);
+  BOOST_CHECK_EQUAL(slices[1].firstPacket, 3);
+  BOOST_CHECK_EQUAL(slices[1].packets, 5);
+  BOOST_CHECK_EQUAL(slices[1].offset, 3 * PAGE_SIZE);
+  BOOST_CHECK_EQUAL(slices[1].size, 5 * PAGE_SIZE);
+
+  // The next superpage of the link continues time frame 3
+  for (size_t i = 0; i < pages; ++i) {
+    setRdh(buffer, i * PAGE_SIZE, 0x100, PAGE_SIZE, 15);
+  }
+  BOOST_REQUIRE_EQUAL(indexer.indexSuperpage(buffer.data(), pages * PAGE_SIZE, slices), 1);
+  BOOST_CHECK(slices[0].continued);
+  indexer.reset();
+  indexer.indexSuperpage(buffer.data(), pages * PAGE_SIZE, slices);
+  BOOST_CHECK(!slices[0].continued);
+
+  BOOST_CHECK_THROW(TimeFrameIndexer(0), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidPacket)
+{
+  constexpr size_t pages = 3;
+  std::vector<uint32_t> buffer(pages * PAGE_SIZE / sizeof(uint32_t));
+  setRdh(buffer, 0, 0x100, PAGE_SIZE, 1);
+  setRdh(buffer, PAGE_SIZE, PAGE_SIZE + 1, PAGE_SIZE, 1000); // Larger than the page, its orbit is not used
+  setRdh(buffer, 2 * PAGE_SIZE, 0x100, PAGE_SIZE, 2);
+
+  TimeFrameIndexer indexer(256);
+  std::vector<TimeFrameSlice> slices;
+  BOOST_REQUIRE_EQUAL(indexer.indexSuperpage(buffer.data(), pages * PAGE_SIZE, slices), 1);
+  BOOST_CHECK_EQUAL(slices[0].packets, 3);
+  BOOST_CHECK_EQUAL(slices[0].lastOrbit, 2);
+}
+
+BOOST_AUTO_TEST_CASE(PackedSplit)
+{
+  std::vector<uint32_t> buffer(PAGE_SIZE / sizeof(uint32_t));
+  setRdh(buffer, 0, 0x100, 0x100, 7);
+  setRdh(buffer, 0x100, 0x80, 0x80, 8); // Starts time frame 1 with a length of 8
+  setRdh(buffer, 0x180, 0x80, PAGE_SIZE - 0x180, 9);
+
+  TimeFrameIndexer indexer(8, PAGE_SIZE, true);
+  std::vector<TimeFrameSlice> slices;
+  BOOST_REQUIRE_EQUAL(indexer.indexSuperpage(buffer.data(), PAGE_SIZE, slices), 2);
+  BOOST_CHECK_EQUAL(slices[0].packets, 1);
+  BOOST_CHECK_EQUAL(slices[0].size, 0x100);
+  BOOST_CHECK_EQUAL(slices[1].firstPacket, 1);
+  BOOST_CHECK_EQUAL(slices[1].packets, 2);
+  BOOST_CHECK_EQUAL(slices[1].offset, 0x100);
+  BOOST_CHECK_EQUAL(slices[1].size, PAGE_SIZE - 0x100);
+
+  Superpage superpage(0x10000, PAGE_SIZE);
+  superpage.setReceived(PAGE_SIZE);
+  superpage.setLinkId(4);
+  auto pieces = TimeFrameIndexer::split(superpage, slices);
+  BOOST_REQUIRE_EQUAL(pieces.size(), 2);
+  BOOST_CHECK_EQUAL(pieces[0].getOffset(), 0x10000);
+  BOOST_CHECK_EQUAL(pieces[0].getSize(), 0x100);
+  BOOST_CHECK_EQUAL(pieces[1].getOffset(), 0x10100);
+  BOOST_CHECK_EQUAL(pieces[1].getReceived(), PAGE_SIZE - 0x100);
+  BOOST_CHECK_EQUAL(pieces[1].getLinkId(), 4);
+  BOOST_CHECK(pieces[1].isReady() && pieces[1].isFilled());
+}
+
+} // Anonymous namespace
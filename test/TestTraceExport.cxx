@@ -0,0 +1,101 @@
+/// \file TestTraceExport.cxx
+/// \brief Test of the trace export functions
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestTraceExport
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <set>
+#include <sstream>
+#include <string>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/TraceExport.h"
+#include "TraceRing.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+namespace pt = boost::property_tree;
+
+namespace {
+
+std::vector<TraceExport::Entry> parse(const TraceRing& ring)
+{
+  std::stringstream stream;
+  stream << "Log message before the trace\n";
+  ring.dump(stream);
+  return TraceExport::parseDump(stream);
+}
+
+BOOST_AUTO_TEST_CASE(ParseDump)
+{
+  TraceRing ring;
+  ring.record(TraceRing::Event::StartDma);
+  ring.record(TraceRing::Event::Pushed, 5, 0x100000);
+  ring.record(TraceRing::Event::Arrived, 5, 0x2000);
+  ring.record(TraceRing::Event::Popped, 5, 0x100000);
+
+  auto entries = parse(ring);
+  BOOST_REQUIRE_EQUAL(entries.size(), 4);
+  BOOST_CHECK(entries[0].event == TraceRing::Event::StartDma);
+  BOOST_CHECK(entries[1].event == TraceRing::Event::Pushed);
+  BOOST_CHECK_EQUAL(entries[1].link, 5);
+  BOOST_CHECK_EQUAL(entries[1].value, 0x100000);
+  BOOST_CHECK_EQUAL(entries[2].value, 0x2000);
+  BOOST_CHECK_LE(entries[0].ticks, entries[3].ticks);
+  BOOST_CHECK_EQUAL(entries[3].ticks, 0);
+
+  std::istringstream empty("Trace empty\n");
+  BOOST_CHECK(TraceExport::parseDump(empty).empty());
+}
+
+BOOST_AUTO_TEST_CASE(ChromeTrace)
+{
+  TraceRing ring;
+  ring.record(TraceRing::Event::StartDma);
+  ring.record(TraceRing::Event::Pushed, 0, 0x0);
+  ring.record(TraceRing::Event::Pushed, 0, 0x1000);
+  ring.record(TraceRing::Event::Pushed, 1, 0x2000);
+  ring.record(TraceRing::Event::Arrived, 0, 0x1000);
+  ring.record(TraceRing::Event::Popped, 0, 0x0);
+  ring.record(TraceRing::Event::Reset);
+
+  std::stringstream json;
+  TraceExport::writeChromeTrace(json, parse(ring), 1000.0);
+  pt::ptree tree;
+  BOOST_REQUIRE_NO_THROW(pt::read_json(json, tree));
+
+  int instants = 0;
+  int globalInstants = 0;
+  std::set<std::string> threadNames;
+  std::string lastCounter;
+  for (const auto& item : tree.get_child("traceEvents")) {
+    const auto& event = item.second;
+    auto phase = event.get<std::string>("ph");
+    if (phase == "M" && event.get<std::string>("name") == "thread_name") {
+      threadNames.insert(event.get<std::string>("args.name"));
+    } else if (phase == "i") {
+      (event.get<std::string>("s") == "g" ? globalInstants : instants)++;
+      BOOST_CHECK_GE(event.get<double>("ts"), 0);
+    } else if (phase == "C" && event.get<std::string>("name") == "Link 0 superpages") {
+      lastCounter = std::to_string(event.get<int>("args.card")) + "/" + std::to_string(event.get<int>("args.ready"));
+    }
+  }
+  BOOST_CHECK_EQUAL(instants, 5);
+  BOOST_CHECK_EQUAL(globalInstants, 2);
+  BOOST_CHECK(threadNames == std::set<std::string>({"Channel", "Link 0", "Link 1"}));
+  // Link 0 has one superpage left on the card, and its arrived one was popped
+  BOOST_CHECK_EQUAL(lastCounter, "1/0");
+}
+
+BOOST_AUTO_TEST_CASE(EmptyTrace)
+{
+  std::stringstream json;
+  TraceExport::writeChromeTrace(json, {}, 1000.0);
+  pt::ptree tree;
+  BOOST_REQUIRE_NO_THROW(pt::read_json(json, tree));
+}
+
+} // Anonymous namespace
@@ -0,0 +1,67 @@
+/// \file TestTraceRing.cxx
+/// \brief Test of the TraceRing class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestTraceRing
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include "TraceRing.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+size_t countLines(const std::string& string)
+{
+  return std::count(string.begin(), string.end(), '\n');
+}
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+  TraceRing ring;
+  std::ostringstream stream;
+  ring.dump(stream);
+  BOOST_CHECK_EQUAL(stream.str(), "Trace empty\n");
+}
+
+BOOST_AUTO_TEST_CASE(Record)
+{
+  TraceRing ring;
+  ring.record(TraceRing::Event::StartDma);
+  ring.record(TraceRing::Event::Pushed, 5, 0x100000);
+  ring.record(TraceRing::Event::Arrived, 5, 0x2000);
+
+  std::ostringstream stream;
+  ring.dump(stream);
+  auto dump = stream.str();
+  // Header plus one line per event
+  BOOST_CHECK_EQUAL(countLines(dump), 4);
+  BOOST_CHECK(dump.find("START_DMA") < dump.find("PUSHED"));
+  BOOST_CHECK(dump.find("PUSHED") < dump.find("ARRIVED"));
+  BOOST_CHECK(dump.find("0x100000") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Wrap)
+{
+  TraceRing ring;
+  const size_t capacity = TraceRing::CAPACITY;
+  for (size_t i = 0; i < capacity + 10; ++i) {
+    ring.record(TraceRing::Event::Popped, 0, i);
+  }
+
+  std::ostringstream stream;
+  ring.dump(stream);
+  auto dump = stream.str();
+  // Only the most recent events are kept
+  BOOST_CHECK_EQUAL(countLines(dump), capacity + 1);
+  BOOST_CHECK(dump.find((boost::format(" 0x%x\n") % 9).str()) == std::string::npos);
+  BOOST_CHECK(dump.find((boost::format(" 0x%x\n") % 10).str()) != std::string::npos);
+  BOOST_CHECK(dump.find((boost::format(" 0x%x\n") % (capacity + 9)).str()) != std::string::npos);
+}
+
+} // Anonymous namespace
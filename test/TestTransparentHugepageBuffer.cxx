@@ -0,0 +1,56 @@
+/// \file TestTransparentHugepageBuffer.cxx
+/// \brief Test of the TransparentHugepageBuffer class
+///
+/// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
+
+#define BOOST_TEST_MODULE RORC_TestTransparentHugepageBuffer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/TransparentHugepageBuffer.h"
+
+using namespace ::AliceO2::roc;
+
+namespace {
+
+constexpr size_t SIZE_2MiB = 2 * 1024 * 1024;
+
+bool isThpEnabled()
+{
+  std::ifstream stream("/sys/kernel/mm/transparent_hugepage/enabled");
+  std::string modes;
+  std::getline(stream, modes);
+  return !modes.empty() && modes.find("[never]") == std::string::npos;
+}
+
+BOOST_AUTO_TEST_CASE(Allocate)
+{
+  if (!isThpEnabled()) {
+    BOOST_CHECK_THROW(TransparentHugepageBuffer(4 * SIZE_2MiB), MemoryMapException);
+    return;
+  }
+
+  TransparentHugepageBuffer buffer(4 * SIZE_2MiB);
+  BOOST_CHECK_EQUAL(buffer.getSize(), 4 * SIZE_2MiB);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(buffer.getAddress()) % SIZE_2MiB, 0);
+  BOOST_CHECK_EQUAL(buffer.getBufferParameters().address, buffer.getAddress());
+  std::memset(buffer.getAddress(), 0xAB, buffer.getSize());
+
+  // The kernel may fall back to 4 KiB pages, but never reports more than the buffer
+  BOOST_CHECK_LE(buffer.getHugepageBytes(), buffer.getSize());
+  BOOST_CHECK(buffer.getPageSize() == SIZE_2MiB || buffer.getPageSize() == 4096);
+  BOOST_CHECK_EQUAL(buffer.getPageSize() == SIZE_2MiB, buffer.getHugepageBytes() == buffer.getSize());
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSize)
+{
+  BOOST_CHECK_THROW(TransparentHugepageBuffer(SIZE_2MiB + 4096), MemoryMapException);
+  BOOST_CHECK_THROW(TransparentHugepageBuffer(0), MemoryMapException);
+}
+
+} // Anonymous namespace